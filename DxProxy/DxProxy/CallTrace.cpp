@@ -0,0 +1,376 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <CallTrace.cpp> and
+Class <CallTrace> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "CallTrace.h"
+
+/**
+* Write buffer size that triggers a flush to the trace file.
+***/
+static const size_t FLUSH_SIZE = 1 << 20;
+
+/**
+* Constructor.
+* Not capturing.
+***/
+CallTrace::CallTrace() :
+	m_pFile(NULL),
+	m_lastRecord(0),
+	m_nextObjectId(1)
+{
+}
+
+/**
+* Destructor.
+* Closes a running trace.
+***/
+CallTrace::~CallTrace()
+{
+	Stop();
+}
+
+/**
+* Starts a new trace, a running trace is closed first.
+* @param fileName The trace file to write.
+* @return False if the file could not be opened.
+***/
+bool CallTrace::Start(const char* fileName)
+{
+	Stop();
+
+	if (fopen_s(&m_pFile, fileName, "wb") != 0 || !m_pFile) {
+		OutputDebugString("CallTrace: Failed to open trace file ");
+		OutputDebugString(fileName);
+		OutputDebugString("\n");
+		m_pFile = NULL;
+		return false;
+	}
+
+	Header header;
+	header.magic = TRACE_MAGIC;
+	header.version = TRACE_VERSION;
+	fwrite(&header, sizeof(Header), 1, m_pFile);
+
+	m_buffer.reserve(FLUSH_SIZE + (FLUSH_SIZE >> 2));
+	m_objectIds.clear();
+	m_nextObjectId = 1;
+
+	return true;
+}
+
+/**
+* Writes the remaining records and closes the trace file.
+***/
+void CallTrace::Stop()
+{
+	if (!m_pFile)
+		return;
+
+	Flush();
+	fclose(m_pFile);
+	m_pFile = NULL;
+
+	m_objectIds.clear();
+	std::vector<BYTE>().swap(m_buffer);
+}
+
+/**
+* Records a call.
+* @param call The call type.
+* @param arg0 - arg3 Call arguments, meaning depends on the call type.
+* @param pData Payload, may be NULL.
+* @param dataSize Payload size in bytes.
+***/
+void CallTrace::Record(CallIds call, DWORD arg0, DWORD arg1, DWORD arg2, DWORD arg3, const void* pData, UINT dataSize)
+{
+	DWORD args[4] = {arg0, arg1, arg2, arg3};
+	RecordArgs(call, args, 4, pData, dataSize);
+}
+
+/**
+* Appends payload to the last record.
+* @param pData Payload.
+* @param dataSize Payload size in bytes.
+***/
+void CallTrace::AppendData(const void* pData, UINT dataSize)
+{
+	if (!m_pFile || !pData || !dataSize || m_buffer.empty())
+		return;
+
+	RecordHeader* pHeader = (RecordHeader*)&m_buffer[m_lastRecord];
+	pHeader->dataSize += dataSize;
+
+	const BYTE* pBytes = (const BYTE*)pData;
+	m_buffer.insert(m_buffer.end(), pBytes, pBytes + dataSize);
+}
+
+/**
+* Removes an object from the ID map.
+* Call for newly created objects, a new object may reuse the address of a released one.
+***/
+void CallTrace::ForgetObject(IUnknown* pObject)
+{
+	m_objectIds.erase(pObject);
+}
+
+/**
+* Returns the ID of a texture, defines the texture on first reference.
+***/
+DWORD CallTrace::ObjectId(IDirect3DBaseTexture9* pTexture)
+{
+	DWORD id;
+	if (!NewObjectId(pTexture, &id))
+		return id;
+
+	switch (pTexture->GetType())
+	{
+	case D3DRTYPE_TEXTURE:
+		{
+			D3DSURFACE_DESC desc;
+			static_cast<IDirect3DTexture9*>(pTexture)->GetLevelDesc(0, &desc);
+			DWORD args[] = {id, desc.Width, desc.Height, pTexture->GetLevelCount(), desc.Usage, desc.Format, desc.Pool};
+			RecordArgs(Call_DefineTexture, args, sizeof(args) / sizeof(DWORD), NULL, 0);
+		}
+		break;
+	case D3DRTYPE_CUBETEXTURE:
+		{
+			D3DSURFACE_DESC desc;
+			static_cast<IDirect3DCubeTexture9*>(pTexture)->GetLevelDesc(0, &desc);
+			DWORD args[] = {id, desc.Width, pTexture->GetLevelCount(), desc.Usage, desc.Format, desc.Pool};
+			RecordArgs(Call_DefineCubeTexture, args, sizeof(args) / sizeof(DWORD), NULL, 0);
+		}
+		break;
+	case D3DRTYPE_VOLUMETEXTURE:
+		{
+			D3DVOLUME_DESC desc;
+			static_cast<IDirect3DVolumeTexture9*>(pTexture)->GetLevelDesc(0, &desc);
+			DWORD args[] = {id, desc.Width, desc.Height, desc.Depth, pTexture->GetLevelCount(), desc.Usage, desc.Format, desc.Pool};
+			RecordArgs(Call_DefineVolumeTexture, args, sizeof(args) / sizeof(DWORD), NULL, 0);
+		}
+		break;
+	default:
+		OutputDebugString("CallTrace: Unknown texture type.\n");
+		break;
+	}
+
+	return id;
+}
+
+/**
+* Returns the ID of a surface, defines the surface on first reference.
+***/
+DWORD CallTrace::ObjectId(IDirect3DSurface9* pSurface)
+{
+	DWORD id;
+	if (!NewObjectId(pSurface, &id))
+		return id;
+
+	D3DSURFACE_DESC desc;
+	pSurface->GetDesc(&desc);
+	DWORD args[] = {id, desc.Width, desc.Height, desc.Format, desc.Usage, desc.Pool, desc.MultiSampleType, desc.MultiSampleQuality};
+	RecordArgs(Call_DefineSurface, args, sizeof(args) / sizeof(DWORD), NULL, 0);
+
+	return id;
+}
+
+/**
+* Returns the ID of a vertex buffer, defines the buffer on first reference.
+***/
+DWORD CallTrace::ObjectId(IDirect3DVertexBuffer9* pVertexBuffer)
+{
+	DWORD id;
+	if (!NewObjectId(pVertexBuffer, &id))
+		return id;
+
+	D3DVERTEXBUFFER_DESC desc;
+	pVertexBuffer->GetDesc(&desc);
+	DWORD args[] = {id, desc.Size, desc.Usage, desc.FVF, desc.Pool};
+	RecordArgs(Call_DefineVertexBuffer, args, sizeof(args) / sizeof(DWORD), NULL, 0);
+
+	return id;
+}
+
+/**
+* Returns the ID of an index buffer, defines the buffer on first reference.
+***/
+DWORD CallTrace::ObjectId(IDirect3DIndexBuffer9* pIndexBuffer)
+{
+	DWORD id;
+	if (!NewObjectId(pIndexBuffer, &id))
+		return id;
+
+	D3DINDEXBUFFER_DESC desc;
+	pIndexBuffer->GetDesc(&desc);
+	DWORD args[] = {id, desc.Size, desc.Usage, desc.Format, desc.Pool};
+	RecordArgs(Call_DefineIndexBuffer, args, sizeof(args) / sizeof(DWORD), NULL, 0);
+
+	return id;
+}
+
+/**
+* Returns the ID of a vertex shader, defines the shader (with bytecode) on first reference.
+***/
+DWORD CallTrace::ObjectId(IDirect3DVertexShader9* pShader)
+{
+	DWORD id;
+	if (!NewObjectId(pShader, &id))
+		return id;
+
+	UINT size = 0;
+	pShader->GetFunction(NULL, &size);
+	std::vector<BYTE> function(size);
+	if (size > 0)
+		pShader->GetFunction(&function[0], &size);
+	RecordArgs(Call_DefineVertexShader, &id, 1, size ? &function[0] : NULL, size);
+
+	return id;
+}
+
+/**
+* Returns the ID of a pixel shader, defines the shader (with bytecode) on first reference.
+***/
+DWORD CallTrace::ObjectId(IDirect3DPixelShader9* pShader)
+{
+	DWORD id;
+	if (!NewObjectId(pShader, &id))
+		return id;
+
+	UINT size = 0;
+	pShader->GetFunction(NULL, &size);
+	std::vector<BYTE> function(size);
+	if (size > 0)
+		pShader->GetFunction(&function[0], &size);
+	RecordArgs(Call_DefinePixelShader, &id, 1, size ? &function[0] : NULL, size);
+
+	return id;
+}
+
+/**
+* Returns the ID of a vertex declaration, defines the declaration (with elements) on first reference.
+***/
+DWORD CallTrace::ObjectId(IDirect3DVertexDeclaration9* pDecl)
+{
+	DWORD id;
+	if (!NewObjectId(pDecl, &id))
+		return id;
+
+	UINT elementCount = 0;
+	pDecl->GetDeclaration(NULL, &elementCount);
+	std::vector<D3DVERTEXELEMENT9> elements(elementCount);
+	if (elementCount > 0)
+		pDecl->GetDeclaration(&elements[0], &elementCount);
+	RecordArgs(Call_DefineVertexDeclaration, &id, 1, elementCount ? &elements[0] : NULL, elementCount * sizeof(D3DVERTEXELEMENT9));
+
+	return id;
+}
+
+/**
+* Float argument as stored DWORD (bitwise).
+***/
+DWORD CallTrace::FloatArg(float value)
+{
+	return *reinterpret_cast<DWORD*>(&value);
+}
+
+/**
+* Records a call with more than four arguments.
+* Trailing zero arguments are not stored.
+* @param call The call type.
+* @param pArgs Call arguments, meaning depends on the call type.
+* @param argCount Number of arguments.
+* @param pData Payload, may be NULL.
+* @param dataSize Payload size in bytes.
+***/
+void CallTrace::RecordArgs(CallIds call, const DWORD* pArgs, UINT argCount, const void* pData, UINT dataSize)
+{
+	if (!m_pFile)
+		return;
+
+	while ((argCount > 0) && (pArgs[argCount - 1] == 0))
+		argCount--;
+	if (!pData)
+		dataSize = 0;
+
+	RecordHeader header;
+	header.call = (WORD)call;
+	header.argCount = (WORD)argCount;
+	header.dataSize = dataSize;
+
+	m_lastRecord = m_buffer.size();
+	const BYTE* pBytes = (const BYTE*)&header;
+	m_buffer.insert(m_buffer.end(), pBytes, pBytes + sizeof(RecordHeader));
+	pBytes = (const BYTE*)pArgs;
+	m_buffer.insert(m_buffer.end(), pBytes, pBytes + argCount * sizeof(DWORD));
+	if (dataSize > 0) {
+		pBytes = (const BYTE*)pData;
+		m_buffer.insert(m_buffer.end(), pBytes, pBytes + dataSize);
+	}
+
+	// flush on frame boundaries only, so AppendData() never misses its record
+	if ((call == Call_Present) && (m_buffer.size() >= FLUSH_SIZE))
+		Flush();
+}
+
+/**
+* Assigns an ID to an object on first reference.
+* @param pObject The object, may be NULL (ID 0).
+* @param pId [out] The object ID.
+* @return True if the object was not referenced before and has to be defined.
+***/
+bool CallTrace::NewObjectId(IUnknown* pObject, DWORD* pId)
+{
+	if (!pObject) {
+		*pId = 0;
+		return false;
+	}
+
+	std::unordered_map<IUnknown*, DWORD>::iterator it = m_objectIds.find(pObject);
+	if (it != m_objectIds.end()) {
+		*pId = it->second;
+		return false;
+	}
+
+	*pId = m_nextObjectId++;
+	m_objectIds.insert(std::pair<IUnknown*, DWORD>(pObject, *pId));
+	return true;
+}
+
+/**
+* Writes the buffered records to the trace file.
+***/
+void CallTrace::Flush()
+{
+	if (!m_pFile || m_buffer.empty())
+		return;
+
+	if (fwrite(&m_buffer[0], 1, m_buffer.size(), m_pFile) != m_buffer.size())
+		OutputDebugString("CallTrace: Failed to write trace file.\n");
+
+	m_buffer.clear();
+	m_lastRecord = 0;
+}
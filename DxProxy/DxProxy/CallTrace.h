@@ -0,0 +1,100 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <CallTrace.h> and
+Class <CallTrace> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef CALLTRACE_H_INCLUDED
+#define CALLTRACE_H_INCLUDED
+
+#include <d3d9.h>
+#include <stdio.h>
+#include <vector>
+#include <unordered_map>
+#include "CallTraceFormat.h"
+
+/**
+* Call stream capture.
+* Serializes the device calls reaching the proxy device into a compact binary trace, to measure and
+* compare the proxy overhead with the call pattern of a real game. The file format is described by
+* CallTraceFormat, TraceTool reads and checks traces.
+* @see D3DProxyDevice
+*/
+class CallTrace : public CallTraceFormat
+{
+public:
+	CallTrace();
+	virtual ~CallTrace();
+
+	/*** CallTrace public methods ***/
+	bool         Start(const char* fileName);
+	void         Stop();
+	void         Record(CallIds call, DWORD arg0 = 0, DWORD arg1 = 0, DWORD arg2 = 0, DWORD arg3 = 0, const void* pData = NULL, UINT dataSize = 0);
+	void         RecordArgs(CallIds call, const DWORD* pArgs, UINT argCount, const void* pData = NULL, UINT dataSize = 0);
+	void         AppendData(const void* pData, UINT dataSize);
+	void         ForgetObject(IUnknown* pObject);
+	DWORD        ObjectId(IDirect3DBaseTexture9* pTexture);
+	DWORD        ObjectId(IDirect3DSurface9* pSurface);
+	DWORD        ObjectId(IDirect3DVertexBuffer9* pVertexBuffer);
+	DWORD        ObjectId(IDirect3DIndexBuffer9* pIndexBuffer);
+	DWORD        ObjectId(IDirect3DVertexShader9* pShader);
+	DWORD        ObjectId(IDirect3DPixelShader9* pShader);
+	DWORD        ObjectId(IDirect3DVertexDeclaration9* pDecl);
+	static DWORD FloatArg(float value);
+
+	/**
+	* True while a trace is written. Inline, checked on every device call.
+	***/
+	bool IsCapturing() { return m_pFile != NULL; }
+
+private:
+	/*** CallTrace private methods ***/
+	bool  NewObjectId(IUnknown* pObject, DWORD* pId);
+	void  Flush();
+
+	/**
+	* Trace file, NULL if not capturing.
+	***/
+	FILE* m_pFile;
+	/**
+	* Write buffer, flushed to the file when it exceeds FLUSH_SIZE.
+	***/
+	std::vector<BYTE> m_buffer;
+	/**
+	* Offset of the last record header in the write buffer (for AppendData()).
+	***/
+	size_t m_lastRecord;
+	/**
+	* IDs of all objects referenced by the trace.
+	* <object, ID>
+	***/
+	std::unordered_map<IUnknown*, DWORD> m_objectIds;
+	/**
+	* Next object ID to be assigned.
+	***/
+	DWORD m_nextObjectId;
+};
+#endif
@@ -0,0 +1,137 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <CallTraceFormat.h> and
+Class <CallTraceFormat> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef CALLTRACEFORMAT_H_INCLUDED
+#define CALLTRACEFORMAT_H_INCLUDED
+
+#include <stdint.h>
+
+/**
+* Call trace file format, shared by the writer and the readers.
+* Depends on the C++ standard library only, so traces can be read anywhere.
+*
+* File layout : one Header, followed by records. Each record is one RecordHeader, argCount DWORD
+* arguments (trailing zero arguments are not stored, read them as zero) and dataSize bytes payload.
+* Objects are referenced by IDs (0 is NULL). The first reference of an object writes a Call_Define...
+* record with its descriptor (and shader bytecode or vertex elements), so a trace started in the middle
+* of a game is self-contained. IDs are never reused. Resource contents (locked data) are not captured.
+* @see CallTrace
+* @see CallTraceReader
+*/
+class CallTraceFormat
+{
+public:
+	/**
+	* Recorded call types.
+	* Append new types at the end, the values are stored in trace files.
+	***/
+	enum CallIds
+	{
+		Call_Present,                  /**< - */
+		Call_Reset,                    /**< data : D3DPRESENT_PARAMETERS */
+		Call_BeginScene,               /**< - */
+		Call_EndScene,                 /**< - */
+		Call_Clear,                    /**< Count, Flags, Color, Z (float bits), Stencil; data : D3DRECT[Count] */
+		Call_DrawPrimitive,            /**< PrimitiveType, StartVertex, PrimitiveCount */
+		Call_DrawIndexedPrimitive,     /**< PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, startIndex, primCount */
+		Call_DrawPrimitiveUP,          /**< PrimitiveType, PrimitiveCount, VertexStreamZeroStride; data : vertices */
+		Call_DrawIndexedPrimitiveUP,   /**< PrimitiveType, MinVertexIndex, NumVertices, PrimitiveCount, IndexDataFormat, VertexStreamZeroStride; data : vertices, indices */
+		Call_SetRenderState,           /**< State, Value */
+		Call_SetSamplerState,          /**< Sampler, Type, Value */
+		Call_SetTextureStageState,     /**< Stage, Type, Value */
+		Call_SetTexture,               /**< Stage, texture ID */
+		Call_SetStreamSource,          /**< StreamNumber, vertex buffer ID, OffsetInBytes, Stride */
+		Call_SetStreamSourceFreq,      /**< StreamNumber, Setting */
+		Call_SetIndices,               /**< index buffer ID */
+		Call_SetVertexDeclaration,     /**< vertex declaration ID */
+		Call_SetFVF,                   /**< FVF */
+		Call_SetVertexShader,          /**< vertex shader ID */
+		Call_SetPixelShader,           /**< pixel shader ID */
+		Call_SetVertexShaderConstantF, /**< StartRegister, Vector4fCount; data : float[4 * Vector4fCount] */
+		Call_SetVertexShaderConstantI, /**< StartRegister, Vector4iCount; data : int[4 * Vector4iCount] */
+		Call_SetVertexShaderConstantB, /**< StartRegister, BoolCount; data : BOOL[BoolCount] */
+		Call_SetPixelShaderConstantF,  /**< StartRegister, Vector4fCount; data : float[4 * Vector4fCount] */
+		Call_SetPixelShaderConstantI,  /**< StartRegister, Vector4iCount; data : int[4 * Vector4iCount] */
+		Call_SetPixelShaderConstantB,  /**< StartRegister, BoolCount; data : BOOL[BoolCount] */
+		Call_SetTransform,             /**< State; data : D3DMATRIX */
+		Call_MultiplyTransform,        /**< State; data : D3DMATRIX */
+		Call_SetViewport,              /**< data : D3DVIEWPORT9 */
+		Call_SetScissorRect,           /**< data : RECT */
+		Call_SetRenderTarget,          /**< RenderTargetIndex, surface ID */
+		Call_SetDepthStencilSurface,   /**< surface ID */
+		Call_StretchRect,              /**< source surface ID, destination surface ID, Filter, rect flags (1 source, 2 destination); data : given RECTs */
+		Call_ColorFill,                /**< surface ID, color, rect flag; data : RECT */
+		Call_BeginStateBlock,          /**< - */
+		Call_EndStateBlock,            /**< - */
+		Call_CreateStateBlock,         /**< Type */
+		Call_DefineTexture,            /**< ID, Width, Height, Levels, Usage, Format, Pool */
+		Call_DefineCubeTexture,        /**< ID, EdgeLength, Levels, Usage, Format, Pool */
+		Call_DefineVolumeTexture,      /**< ID, Width, Height, Depth, Levels, Usage, Format, Pool */
+		Call_DefineSurface,            /**< ID, Width, Height, Format, Usage, Pool, MultiSampleType, MultiSampleQuality */
+		Call_DefineVertexBuffer,       /**< ID, Length, Usage, FVF, Pool */
+		Call_DefineIndexBuffer,        /**< ID, Length, Usage, Format, Pool */
+		Call_DefineVertexShader,       /**< ID; data : bytecode */
+		Call_DefinePixelShader,        /**< ID; data : bytecode */
+		Call_DefineVertexDeclaration,  /**< ID; data : D3DVERTEXELEMENT9[] including D3DDECL_END */
+		Call_Count                     /**< Number of call types, not stored. */
+	};
+
+	/**
+	* Trace file header.
+	***/
+	struct Header
+	{
+		uint32_t magic;   /**< TRACE_MAGIC */
+		uint32_t version; /**< TRACE_VERSION */
+	};
+
+	/**
+	* Record header, followed by the arguments and the payload.
+	***/
+	struct RecordHeader
+	{
+		uint16_t call;     /**< CallIds */
+		uint16_t argCount; /**< Number of stored DWORD arguments. */
+		uint32_t dataSize; /**< Payload size in bytes. */
+	};
+
+	/**
+	* "VCTR"
+	***/
+	static const uint32_t TRACE_MAGIC = 0x52544356;
+	/**
+	* Trace file version.
+	***/
+	static const uint32_t TRACE_VERSION = 1;
+	/**
+	* Maximum number of arguments of a record.
+	***/
+	static const uint32_t MAX_ARGS = 8;
+};
+#endif
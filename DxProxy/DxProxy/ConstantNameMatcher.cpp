@@ -0,0 +1,221 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ConstantNameMatcher.cpp> and
+Class <ConstantNameMatcher> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ConstantNameMatcher.h"
+
+/**
+* No state (missing trie transition).
+***/
+#define NO_STATE UINT_MAX
+
+/**
+* Constructor.
+* Creates an empty matcher, matching nothing.
+***/
+ConstantNameMatcher::ConstantNameMatcher() :
+	m_patterns(),
+	m_classCount(0),
+	m_next(),
+	m_depth(),
+	m_partialMatches(),
+	m_exactMatches(),
+	m_maskWords(0)
+{
+	ZeroMemory(m_charClass, sizeof(m_charClass));
+}
+
+/**
+* Destructor.
+***/
+ConstantNameMatcher::~ConstantNameMatcher()
+{
+}
+
+/**
+* Removes all patterns, the matcher matches nothing until compiled again.
+***/
+void ConstantNameMatcher::Clear()
+{
+	m_patterns.clear();
+	m_classCount = 0;
+	m_next.clear();
+	m_depth.clear();
+	m_partialMatches.clear();
+	m_exactMatches.clear();
+	m_maskWords = 0;
+	ZeroMemory(m_charClass, sizeof(m_charClass));
+}
+
+/**
+* Adds a pattern, takes effect on Compile().
+* @param pattern The name or name part.
+* @param partial True if the pattern may be found anywhere in a name (strstr), false if the name has to match completely.
+* @param id Pattern id, the bit set in match masks. Several patterns may share an id.
+***/
+void ConstantNameMatcher::AddPattern(const std::string& pattern, bool partial, UINT id)
+{
+	Pattern newPattern;
+	newPattern.text = pattern;
+	newPattern.partial = partial;
+	newPattern.id = id;
+	m_patterns.push_back(newPattern);
+}
+
+/**
+* Builds the automaton from the added patterns.
+***/
+void ConstantNameMatcher::Compile()
+{
+	// character classes
+	ZeroMemory(m_charClass, sizeof(m_charClass));
+	m_classCount = 1;
+	m_maskWords = 0;
+	for (auto itPattern = m_patterns.begin(); itPattern != m_patterns.end(); ++itPattern) {
+		for (auto itChar = itPattern->text.begin(); itChar != itPattern->text.end(); ++itChar) {
+			BYTE character = (BYTE)*itChar;
+			if (!m_charClass[character])
+				m_charClass[character] = (BYTE)m_classCount++;
+		}
+		m_maskWords = max(m_maskWords, itPattern->id / 32 + 1);
+	}
+
+	// trie
+	m_next.assign(m_classCount, NO_STATE);
+	m_depth.assign(1, 0);
+	m_partialMatches.assign(1, std::vector<UINT>());
+	m_exactMatches.assign(1, std::vector<UINT>());
+	for (auto itPattern = m_patterns.begin(); itPattern != m_patterns.end(); ++itPattern) {
+		UINT state = 0;
+		for (auto itChar = itPattern->text.begin(); itChar != itPattern->text.end(); ++itChar) {
+			UINT index = state * m_classCount + m_charClass[(BYTE)*itChar];
+			if (m_next[index] == NO_STATE) {
+				m_next[index] = (UINT)m_depth.size();
+				m_next.resize(m_next.size() + m_classCount, NO_STATE);
+				m_depth.push_back(m_depth[state] + 1);
+				m_partialMatches.push_back(std::vector<UINT>());
+				m_exactMatches.push_back(std::vector<UINT>());
+			}
+			state = m_next[index];
+		}
+
+		if (itPattern->partial)
+			m_partialMatches[state].push_back(itPattern->id);
+		else
+			m_exactMatches[state].push_back(itPattern->id);
+	}
+
+	// failure links, breadth first : missing transitions continue from the longest suffix state
+	std::vector<UINT> fail(m_depth.size(), 0);
+	std::vector<UINT> queue;
+	for (UINT c = 0; c < m_classCount; c++) {
+		if (m_next[c] == NO_STATE)
+			m_next[c] = 0;
+		else
+			queue.push_back(m_next[c]);
+	}
+
+	for (UINT head = 0; head < queue.size(); head++) {
+		UINT state = queue[head];
+
+		// partial patterns found at the suffix state are found here as well
+		m_partialMatches[state].insert(m_partialMatches[state].end(), m_partialMatches[fail[state]].begin(), m_partialMatches[fail[state]].end());
+
+		for (UINT c = 0; c < m_classCount; c++) {
+			UINT index = state * m_classCount + c;
+			UINT suffixNext = m_next[fail[state] * m_classCount + c];
+			if (m_next[index] == NO_STATE) {
+				m_next[index] = suffixNext;
+			}
+			else {
+				fail[m_next[index]] = suffixNext;
+				queue.push_back(m_next[index]);
+			}
+		}
+	}
+}
+
+/**
+* Finds all patterns matching a name in one pass.
+* @param name The constant name.
+* @param pMatches [out] Match mask, bit n is set if a pattern with id n matches.
+***/
+void ConstantNameMatcher::Match(const char* name, std::vector<DWORD>* pMatches)
+{
+	pMatches->assign(m_maskWords, 0);
+	if (m_next.empty())
+		return;
+
+	UINT state = 0;
+	UINT length = 0;
+	for (auto itId = m_partialMatches[0].begin(); itId != m_partialMatches[0].end(); ++itId)
+		SetBit(pMatches, *itId);
+
+	for (const BYTE* pChar = (const BYTE*)name; *pChar; pChar++, length++) {
+		state = m_next[state * m_classCount + m_charClass[*pChar]];
+		for (auto itId = m_partialMatches[state].begin(); itId != m_partialMatches[state].end(); ++itId)
+			SetBit(pMatches, *itId);
+	}
+
+	// the whole name is the path to the final state
+	if (m_depth[state] == length) {
+		for (auto itId = m_exactMatches[state].begin(); itId != m_exactMatches[state].end(); ++itId)
+			SetBit(pMatches, *itId);
+	}
+}
+
+/**
+* True if any pattern matches a name, stops at the first match.
+* @param name The constant name.
+***/
+bool ConstantNameMatcher::MatchesAny(const char* name)
+{
+	if (m_next.empty())
+		return false;
+
+	UINT state = 0;
+	UINT length = 0;
+	if (!m_partialMatches[0].empty())
+		return true;
+
+	for (const BYTE* pChar = (const BYTE*)name; *pChar; pChar++, length++) {
+		state = m_next[state * m_classCount + m_charClass[*pChar]];
+		if (!m_partialMatches[state].empty())
+			return true;
+	}
+
+	return (m_depth[state] == length) && !m_exactMatches[state].empty();
+}
+
+/**
+* Sets a bit of a mask.
+***/
+void ConstantNameMatcher::SetBit(std::vector<DWORD>* pMask, UINT bit)
+{
+	(*pMask)[bit / 32] |= 1UL << (bit % 32);
+}
@@ -0,0 +1,106 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ConstantNameMatcher.h> and
+Class <ConstantNameMatcher> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef CONSTANTNAMEMATCHER_H_INCLUDED
+#define CONSTANTNAMEMATCHER_H_INCLUDED
+
+#include <d3d9.h>
+#include <string>
+#include <vector>
+
+/**
+* Multi pattern shader constant name matcher.
+* Partial (substring) and exact name patterns are compiled into one Aho-Corasick automaton, a single
+* pass over a constant name finds all matching patterns. Exact patterns match if the whole name is
+* the path to their trie node, so they need no separate lookup.
+* Characters not used by any pattern share one character class, the transition table only has one
+* column per character used.
+* @see ShaderModificationRepository
+*/
+class ConstantNameMatcher
+{
+public:
+	ConstantNameMatcher();
+	virtual ~ConstantNameMatcher();
+
+	/*** ConstantNameMatcher public methods ***/
+	void Clear();
+	void AddPattern(const std::string& pattern, bool partial, UINT id);
+	void Compile();
+	void Match(const char* name, std::vector<DWORD>* pMatches);
+	bool MatchesAny(const char* name);
+
+private:
+	/**
+	* One pattern as added.
+	***/
+	struct Pattern
+	{
+		std::string text;    /**< The pattern. */
+		bool        partial; /**< True for substring matches, false for exact matches. */
+		UINT        id;      /**< Caller defined pattern id. */
+	};
+
+	/*** ConstantNameMatcher private methods ***/
+	static void SetBit(std::vector<DWORD>* pMask, UINT bit);
+
+	/**
+	* Added patterns.
+	***/
+	std::vector<Pattern> m_patterns;
+	/**
+	* Character class of every character, 0 for characters not used by any pattern.
+	***/
+	BYTE m_charClass[256];
+	/**
+	* Number of character classes.
+	***/
+	UINT m_classCount;
+	/**
+	* Transitions, m_classCount per state, state 0 is the root.
+	***/
+	std::vector<UINT> m_next;
+	/**
+	* Trie depth of every state.
+	***/
+	std::vector<UINT> m_depth;
+	/**
+	* Ids of the partial patterns found when reaching a state (including those of its suffix states).
+	***/
+	std::vector<std::vector<UINT>> m_partialMatches;
+	/**
+	* Ids of the exact patterns ending at a state.
+	***/
+	std::vector<std::vector<UINT>> m_exactMatches;
+	/**
+	* Size of a match mask in words (largest id / 32 + 1).
+	***/
+	UINT m_maskWords;
+};
+#endif
@@ -230,9 +230,14 @@ HRESULT WINAPI D3D9ProxyCubeTexture::GetCubeMapSurface(D3DCUBEMAP_FACES FaceType
 
 /**
 * Locks rectangle on both (left/right) textures.
+* Executes pending device commands first.
+* @see BaseDirect3DDevice9::FlushPendingCommands()
 ***/
 HRESULT WINAPI D3D9ProxyCubeTexture::LockRect(D3DCUBEMAP_FACES FaceType, UINT Level, D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags)
 {
+	if (m_pOwningDevice)
+		m_pOwningDevice->FlushPendingCommands();
+
 	if (IsStereo())
 		m_pActualTextureRight->LockRect(FaceType, Level, pLockedRect, pRect, Flags);
 
@@ -28,30 +28,90 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ********************************************************************/
 
 #include "D3D9ProxyPixelShader.h"
+#include "D3DProxyDevice.h"
+#include "ShaderModificationRepository.h"
+#include "StereoShaderPatcher.h"
 
 /**
 * Constructor.
+* Queues the analysis of the shader, the game does not wait for it.
 * @param pModLoader Can be NULL (no modifications in this game profile).
 ***/
 D3D9ProxyPixelShader::D3D9ProxyPixelShader(IDirect3DPixelShader9* pActualPixelShader, D3DProxyDevice *pOwningDevice, ShaderModificationRepository* pModLoader) :
 	BaseDirect3DPixelShader9(pActualPixelShader, pOwningDevice),
 	m_pActualDevice(pOwningDevice->getActual()),
-	m_modifiedConstants()
+	m_modifiedConstants(),
+	m_spAnalysis(),
+	m_analysisTaken(false),
+	m_pInstancedStereoShader(NULL)
 {
 	if (pModLoader)
-		m_modifiedConstants = pModLoader->GetModifiedConstantsF(pActualPixelShader);
+		m_spAnalysis = pModLoader->QueueModifiedConstantsF(pActualPixelShader);
 }
 
 /**
-* Empty destructor.
+* Destructor, releases the instanced stereo copy.
 ***/
 D3D9ProxyPixelShader::~D3D9ProxyPixelShader()
-{}
+{
+	if (m_pInstancedStereoShader)
+		m_pInstancedStereoShader->Release();
+}
 
 /**
 * Returns modified constants pointer.
+* Picks up the result of the analysis on first use, waits for the analysis if it is still running.
+* (the queue finishes all analyses before it is destroyed, a finished analysis does not touch it)
 ***/
-std::map<UINT, StereoShaderConstant<float>>* D3D9ProxyPixelShader::ModifiedConstants()
+StereoConstantTable* D3D9ProxyPixelShader::ModifiedConstants()
 {
+	if (m_spAnalysis && !m_analysisTaken) {
+		ShaderAnalysisQueue::Finish(m_spAnalysis.get());
+
+		// shares the layout, copies the constant data
+		m_modifiedConstants = m_spAnalysis->result;
+		m_analysisTaken = true;
+	}
+
 	return &m_modifiedConstants;
-}
\ No newline at end of file
+}
+
+/**
+* Creates the copy patched for single-pass instanced stereo, called on shader creation in instanced
+* stereo mode.
+* @return False if the shader can not be patched, draws using it are drawn per side then.
+* @see StereoShaderPatcher::PatchPixelShader()
+***/
+bool D3D9ProxyPixelShader::CreateInstancedStereoShader()
+{
+	UINT sizeOfData = 0;
+	getActual()->GetFunction(NULL, &sizeOfData);
+	std::vector<BYTE> function(sizeOfData);
+	if ((sizeOfData == 0) || FAILED(getActual()->GetFunction(&function[0], &sizeOfData)))
+		return false;
+
+	StereoShaderPatcher patcher;
+	if (!patcher.PatchPixelShader(&function[0], sizeOfData)) {
+		OutputDebugString("Instanced stereo: pixel shader drawn per side, ");
+		OutputDebugString(patcher.Error());
+		OutputDebugString("\n");
+		return false;
+	}
+
+	if (FAILED(m_pActualDevice->CreatePixelShader(reinterpret_cast<const DWORD*>(&patcher.Function()[0]), &m_pInstancedStereoShader))) {
+		OutputDebugString("Instanced stereo: Failed to create the patched pixel shader.\n");
+		m_pInstancedStereoShader = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+* Returns the copy patched for single-pass instanced stereo, NULL if none was created.
+* @see CreateInstancedStereoShader()
+***/
+IDirect3DPixelShader9* D3D9ProxyPixelShader::InstancedStereoShader()
+{
+	return m_pInstancedStereoShader;
+}
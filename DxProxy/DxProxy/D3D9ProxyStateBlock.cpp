@@ -57,7 +57,15 @@ D3D9ProxyStateBlock::D3D9ProxyStateBlock(IDirect3DStateBlock9* pActualStateBlock
 	m_selectedPixelConstantRegistersF(),
 	m_storedSelectedVSRegistersF(),
 	m_storedAllVSRegistersF(),
-	m_selectedVertexConstantRegistersF()
+	m_selectedVertexConstantRegistersF(),
+	m_storedVSRegistersI(),
+	m_storedVSRegistersB(),
+	m_storedPSRegistersI(),
+	m_storedPSRegistersB(),
+	m_selectedVertexConstantRegistersI(),
+	m_selectedVertexConstantRegistersB(),
+	m_selectedPixelConstantRegistersI(),
+	m_selectedPixelConstantRegistersB()
 {
 	assert (pOwningDevice != NULL);
 
@@ -130,17 +138,28 @@ D3D9ProxyStateBlock::~D3D9ProxyStateBlock()
 	m_selectedVertexStreams.clear();
 	m_selectedPixelConstantRegistersF.clear();
 	m_selectedVertexConstantRegistersF.clear();
+	m_selectedVertexConstantRegistersI.clear();
+	m_selectedVertexConstantRegistersB.clear();
+	m_selectedPixelConstantRegistersI.clear();
+	m_selectedPixelConstantRegistersB.clear();
 
 	m_pWrappedDevice->Release();
 }
 
 /**
 * Calls super method and then CaptureSelectedFromProxyDevice().
+* Float registers the proxy device has not uploaded yet (not read by the active shaders) are applied
+* first, the super method captures the actual device (with the game states of a side-by-side pass).
 * @see CaptureSelectedFromProxyDevice()
+* @see D3DProxyDevice::prepareActualStateBlock()
 ***/
 HRESULT WINAPI D3D9ProxyStateBlock::Capture()
 {
+	m_pWrappedDevice->m_spManagedShaderRegisters->ApplyAllDeferred(m_pWrappedDevice->m_currentRenderingSide);
+
+	m_pWrappedDevice->prepareActualStateBlock();
 	HRESULT result = BaseDirect3DStateBlock9::Capture();
+	m_pWrappedDevice->finishActualStateBlock();
 
 	if (SUCCEEDED(result)) {
 		CaptureSelectedFromProxyDevice();
@@ -152,6 +171,8 @@ HRESULT WINAPI D3D9ProxyStateBlock::Capture()
 /**
 * Applies basic state block states and stored ones.
 *
+* Executes pending (deferred) device commands first.
+*
 * Calls private Apply() to apply non-indexed states. Note that this private method needs to know
 * wether the states were captured while the device side was set to the same side. (set in 
 * updateCaptureSideTracking() )
@@ -164,6 +185,8 @@ HRESULT WINAPI D3D9ProxyStateBlock::Capture()
 * If states were not captured while the device side was set to the same side it applies the 
 * stored texture stages to the actual device else it applies the stored texture stages to the 
 * wrapped device without applying to the actual device.
+*
+* The side-by-side viewport and scissor rectangle of an instanced stereo pass are reapplied last.
 * @see updateCaptureSideTracking()
 * @see Apply(CaptureableState toApply, bool reApplyStereo)
 * @see ShaderRegisters
@@ -175,6 +198,8 @@ HRESULT WINAPI D3D9ProxyStateBlock::Apply()
 	// (probably an error in D3D but haven't tested to check)
 	assert (!m_pWrappedDevice->m_bInBeginEndStateBlock);
 
+	// commands recorded for the other eye expect the states from before this state block
+	m_pWrappedDevice->FlushPendingCommands();
 
 	// If all stereo states recorded on the same side then switch the proxy device to that side
 	if (m_eSidesAre == SidesAllLeft) {
@@ -184,9 +209,12 @@ HRESULT WINAPI D3D9ProxyStateBlock::Apply()
 		m_pWrappedDevice->setDrawingSide(vireio::Right);
 	}
 
-
+	m_pWrappedDevice->prepareActualStateBlock();
 	HRESULT result = BaseDirect3DStateBlock9::Apply();
 
+	// the actual state block changed the actual device states behind the back of the shadow state
+	m_pWrappedDevice->InvalidateShadowState();
+
 	if (SUCCEEDED(result)) {
 
 		// If mixed sides then manually apply all state from stereo components based on the current proxy device side to the actual device
@@ -209,21 +237,9 @@ HRESULT WINAPI D3D9ProxyStateBlock::Apply()
 		auto itVertexBuffer = m_storedVertexBuffers.begin();
 		while (itVertexBuffer != m_storedVertexBuffers.end()) {
 
-			// Remove and Release existing buffer in proxy device
-			if (m_pWrappedDevice->m_activeVertexBuffers.count(itVertexBuffer->first) == 1) {
-
-				auto removing = m_pWrappedDevice->m_activeVertexBuffers[itVertexBuffer->first];
-				if (removing != NULL) {
-					removing->Release();
-				}
-				m_pWrappedDevice->m_activeVertexBuffers.erase(itVertexBuffer->first);
-			}
-
-			auto inserted = m_pWrappedDevice->m_activeVertexBuffers.insert(std::pair<UINT, BaseDirect3DVertexBuffer9*>(itVertexBuffer->first, itVertexBuffer->second));
-			// insert success and buffer not NULL
-			if (inserted.second && inserted.first->second) {
-				inserted.first->second->AddRef();
-			}
+			// Replace (Release existing, AddRef stored) buffer in proxy device
+			if (itVertexBuffer->first < STREAM_COUNT)
+				m_pWrappedDevice->storeActiveVertexBuffer(itVertexBuffer->first, itVertexBuffer->second);
 
 			++itVertexBuffer;
 		}
@@ -261,6 +277,10 @@ HRESULT WINAPI D3D9ProxyStateBlock::Apply()
 			break;
 		}
 
+		// Integer and boolean constants (only the captured registers are stored)
+		m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockData(&m_storedVSRegistersI, &m_storedVSRegistersB, true);
+		m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockData(&m_storedPSRegistersI, &m_storedPSRegistersB, false);
+
 
 
 		// Apply stereo indexed states
@@ -282,27 +302,17 @@ HRESULT WINAPI D3D9ProxyStateBlock::Apply()
 			auto itTextures = m_storedTextureStages.begin();
 			while (itTextures != m_storedTextureStages.end()) {
 
-				// Remove and Release existing active texture in proxy device
-				if (m_pWrappedDevice->m_activeTextureStages.count(itTextures->first) == 1) {
-
-					auto removing = m_pWrappedDevice->m_activeTextureStages[itTextures->first];
-					if (removing != NULL) {
-						removing->Release();
-					}
-					m_pWrappedDevice->m_activeTextureStages.erase(itTextures->first);
-				}
-
-				auto inserted = m_pWrappedDevice->m_activeTextureStages.insert(std::pair<DWORD, IDirect3DBaseTexture9*>(itTextures->first, itTextures->second));
-				// insert success and texture not NULL
-				if (inserted.second && inserted.first->second) {
-					inserted.first->second->AddRef();
-				}
+				// Replace (Release existing, AddRef stored) active texture in proxy device
+				int samplerIndex = vireio::SamplerIndex(itTextures->first);
+				if (samplerIndex >= 0)
+					m_pWrappedDevice->storeActiveTexture(samplerIndex, itTextures->second);
 
 				++itTextures;
 			}
 		}
 	}
 
+	m_pWrappedDevice->finishActualStateBlock();
 
 	return result;
 }
@@ -586,6 +596,95 @@ HRESULT WINAPI D3D9ProxyStateBlock::SelectAndCaptureStatePSConst(UINT StartRegis
 	return result;
 }
 
+/** 
+* Adds registers to selected integer vertex constant registers and captures the constant data.
+* The registers are set on the actual device directly (recorded by the actual state block), the
+* proxy registers do not change while a state block is recorded.
+* @see D3DProxyDevice::SetVertexShaderConstantI()
+***/
+HRESULT WINAPI D3D9ProxyStateBlock::SelectAndCaptureStateVSConstI(UINT StartRegister,CONST int* pConstantData,UINT Vector4iCount)
+{
+	assert(m_eCaptureMode == Cap_Type_Selected);
+	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
+
+	HRESULT result = m_pWrappedDevice->getActual()->SetVertexShaderConstantI(StartRegister, pConstantData, Vector4iCount);
+
+	if (SUCCEEDED(result)) {
+		for (UINT i = 0; i < Vector4iCount; i++) {
+			m_selectedVertexConstantRegistersI.insert(StartRegister + i);
+			memcpy(m_storedVSRegistersI[StartRegister + i].data, pConstantData + i * VECTOR_LENGTH, sizeof(IntRegister));
+		}
+	}
+
+	return result;
+}
+
+/** 
+* Adds registers to selected boolean vertex constant registers and captures the constant data.
+* @see SelectAndCaptureStateVSConstI()
+* @see D3DProxyDevice::SetVertexShaderConstantB()
+***/
+HRESULT WINAPI D3D9ProxyStateBlock::SelectAndCaptureStateVSConstB(UINT StartRegister,CONST BOOL* pConstantData,UINT BoolCount)
+{
+	assert(m_eCaptureMode == Cap_Type_Selected);
+	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
+
+	HRESULT result = m_pWrappedDevice->getActual()->SetVertexShaderConstantB(StartRegister, pConstantData, BoolCount);
+
+	if (SUCCEEDED(result)) {
+		for (UINT i = 0; i < BoolCount; i++) {
+			m_selectedVertexConstantRegistersB.insert(StartRegister + i);
+			m_storedVSRegistersB[StartRegister + i] = pConstantData[i];
+		}
+	}
+
+	return result;
+}
+
+/** 
+* Adds registers to selected integer pixel constant registers and captures the constant data.
+* @see SelectAndCaptureStateVSConstI()
+* @see D3DProxyDevice::SetPixelShaderConstantI()
+***/
+HRESULT WINAPI D3D9ProxyStateBlock::SelectAndCaptureStatePSConstI(UINT StartRegister,CONST int* pConstantData,UINT Vector4iCount)
+{
+	assert(m_eCaptureMode == Cap_Type_Selected);
+	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
+
+	HRESULT result = m_pWrappedDevice->getActual()->SetPixelShaderConstantI(StartRegister, pConstantData, Vector4iCount);
+
+	if (SUCCEEDED(result)) {
+		for (UINT i = 0; i < Vector4iCount; i++) {
+			m_selectedPixelConstantRegistersI.insert(StartRegister + i);
+			memcpy(m_storedPSRegistersI[StartRegister + i].data, pConstantData + i * VECTOR_LENGTH, sizeof(IntRegister));
+		}
+	}
+
+	return result;
+}
+
+/** 
+* Adds registers to selected boolean pixel constant registers and captures the constant data.
+* @see SelectAndCaptureStateVSConstI()
+* @see D3DProxyDevice::SetPixelShaderConstantB()
+***/
+HRESULT WINAPI D3D9ProxyStateBlock::SelectAndCaptureStatePSConstB(UINT StartRegister,CONST BOOL* pConstantData,UINT BoolCount)
+{
+	assert(m_eCaptureMode == Cap_Type_Selected);
+	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
+
+	HRESULT result = m_pWrappedDevice->getActual()->SetPixelShaderConstantB(StartRegister, pConstantData, BoolCount);
+
+	if (SUCCEEDED(result)) {
+		for (UINT i = 0; i < BoolCount; i++) {
+			m_selectedPixelConstantRegistersB.insert(StartRegister + i);
+			m_storedPSRegistersB[StartRegister + i] = pConstantData[i];
+		}
+	}
+
+	return result;
+}
+
 /**
 * If this ProxyStateBlock was created in a BeginStateBlock call then call this method in the 
 * EndStateBlock with the actual stateblock returned from EndStateBlock of the actual device. 
@@ -638,8 +737,10 @@ void D3D9ProxyStateBlock::CaptureSelectedFromProxyDevice()
 		{
 			// if full - copy all textures, vertex buffers and shader constants.
 
-			// Textures
-			m_storedTextureStages = m_pWrappedDevice->m_activeTextureStages;
+			// Textures (all stages, NULL entries unbind the texture when applied)
+			for (int samplerIndex = 0; samplerIndex < SAMPLER_COUNT; samplerIndex++) {
+				m_storedTextureStages[vireio::SamplerFromIndex(samplerIndex)] = m_pWrappedDevice->m_activeTextureStages[samplerIndex];
+			}
 
 			// TODO Do we need to copy Textures rather than just keeping reference. Textures could be changed (have new data stretched/copied into them) 
 			// TODO Check actual behaviour of state block. Is it saving a reference to the texture or a copy of the texture??
@@ -654,7 +755,9 @@ void D3D9ProxyStateBlock::CaptureSelectedFromProxyDevice()
 
 
 			// Vertex buffers
-			m_storedVertexBuffers = m_pWrappedDevice->m_activeVertexBuffers;
+			for (UINT streamNumber = 0; streamNumber < STREAM_COUNT; streamNumber++) {
+				m_storedVertexBuffers[streamNumber] = m_pWrappedDevice->m_activeVertexBuffers[streamNumber];
+			}
 
 			// TODO same question as for Textures above
 			// Need to increase ref count on all copied vbs
@@ -668,24 +771,30 @@ void D3D9ProxyStateBlock::CaptureSelectedFromProxyDevice()
 
 
 			// Vertex Shader constants
-			m_storedAllVSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->GetAllVSConstantRegistersF();
+			m_storedAllVSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->CaptureVSConstantRegistersF();
 			// Pixel Shader constants
-			m_storedAllPSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->GetAllPSConstantRegistersF();
+			m_storedAllPSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->CapturePSConstantRegistersF();
+
+			CaptureConstantsIB(true, false);
+			CaptureConstantsIB(false, false);
 			break;
 		}
 
 	case Cap_Type_Vertex:
 		{
 			// Vertex Shader constants
-			m_storedAllVSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->GetAllVSConstantRegistersF();
+			m_storedAllVSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->CaptureVSConstantRegistersF();
 
+			CaptureConstantsIB(true, false);
 			break;
 		}
 
 	case Cap_Type_Pixel:
 		{
 			// Pixel Shader constants
-			m_storedAllPSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->GetAllPSConstantRegistersF();
+			m_storedAllPSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->CapturePSConstantRegistersF();
+
+			CaptureConstantsIB(false, false);
 			break;
 		}
 
@@ -696,9 +805,10 @@ void D3D9ProxyStateBlock::CaptureSelectedFromProxyDevice()
 			auto itSelectedTextures = m_selectedTextureSamplers.begin();
 			while (itSelectedTextures != m_selectedTextureSamplers.end()) {
 
-				if (m_pWrappedDevice->m_activeTextureStages.count(*itSelectedTextures) == 1) {
+				int samplerIndex = vireio::SamplerIndex(*itSelectedTextures);
+				if (samplerIndex >= 0) {
 
-					auto inserted = m_storedTextureStages.insert(std::pair<DWORD, IDirect3DBaseTexture9*>(*itSelectedTextures, m_pWrappedDevice->m_activeTextureStages[*itSelectedTextures]));
+					auto inserted = m_storedTextureStages.insert(std::pair<DWORD, IDirect3DBaseTexture9*>(*itSelectedTextures, m_pWrappedDevice->m_activeTextureStages[samplerIndex]));
 					// insert success and texture is not NULL
 					if (inserted.second && inserted.first->second) {
 						inserted.first->second->AddRef();
@@ -716,7 +826,7 @@ void D3D9ProxyStateBlock::CaptureSelectedFromProxyDevice()
 			auto itSelectedVertexStreams = m_selectedVertexStreams.begin();
 			while (itSelectedVertexStreams != m_selectedVertexStreams.end()) {
 
-				if (m_pWrappedDevice->m_activeVertexBuffers.count(*itSelectedVertexStreams) == 1) {
+				if (*itSelectedVertexStreams < STREAM_COUNT) {
 
 					auto inserted = m_storedVertexBuffers.insert(std::pair<UINT, BaseDirect3DVertexBuffer9*>(*itSelectedVertexStreams, m_pWrappedDevice->m_activeVertexBuffers[*itSelectedVertexStreams]));
 					// insert success and buffer is not NULL
@@ -756,6 +866,10 @@ void D3D9ProxyStateBlock::CaptureSelectedFromProxyDevice()
 				++itSelectedPixelConstants;
 			}
 
+			// Integer and boolean constants
+			CaptureConstantsIB(true, true);
+			CaptureConstantsIB(false, true);
+
 			break;
 		}
 
@@ -778,6 +892,44 @@ void D3D9ProxyStateBlock::CaptureSelectedFromProxyDevice()
 	}
 }
 
+/**
+* Copies integer and boolean shader constant registers from the managed shader register class.
+* @param vertexShader True for vertex shader registers, false for pixel shader registers.
+* @param selectedOnly True to copy the selected registers only (Cap_Type_Selected), false for all registers.
+***/
+void D3D9ProxyStateBlock::CaptureConstantsIB(bool vertexShader, bool selectedOnly)
+{
+	std::shared_ptr<ShaderRegisters> spRegisters = m_pWrappedDevice->m_spManagedShaderRegisters;
+	std::map<UINT, IntRegister>& storedI = vertexShader ? m_storedVSRegistersI : m_storedPSRegistersI;
+	std::map<UINT, BOOL>& storedB = vertexShader ? m_storedVSRegistersB : m_storedPSRegistersB;
+	std::unordered_set<UINT>& selectedI = vertexShader ? m_selectedVertexConstantRegistersI : m_selectedPixelConstantRegistersI;
+	std::unordered_set<UINT>& selectedB = vertexShader ? m_selectedVertexConstantRegistersB : m_selectedPixelConstantRegistersB;
+
+	for (UINT i = 0; i < MAX_CONSTANT_REGISTERS_I; i++) {
+		if (selectedOnly && (selectedI.count(i) == 0))
+			continue;
+
+		IntRegister currentRegister;
+		if (vertexShader)
+			spRegisters->GetVertexShaderConstantI(i, currentRegister.data, 1);
+		else
+			spRegisters->GetPixelShaderConstantI(i, currentRegister.data, 1);
+		storedI[i] = currentRegister;
+	}
+
+	for (UINT i = 0; i < MAX_CONSTANT_REGISTERS_B; i++) {
+		if (selectedOnly && (selectedB.count(i) == 0))
+			continue;
+
+		BOOL currentRegister;
+		if (vertexShader)
+			spRegisters->GetVertexShaderConstantB(i, &currentRegister, 1);
+		else
+			spRegisters->GetPixelShaderConstantB(i, &currentRegister, 1);
+		storedB[i] = currentRegister;
+	}
+}
+
 /**
 * Stores data from wrapped device according to selection.
 * @param toCap The selection to be copied.
@@ -873,10 +1025,15 @@ void D3D9ProxyStateBlock::ClearCapturedData()
 	m_storedVertexBuffers.clear();
 
 	m_storedSelectedVSRegistersF.clear();
-	m_storedAllVSRegistersF.clear();
+	m_storedAllVSRegistersF.reset();
 
 	m_storedSelectedPSRegistersF.clear();
-	m_storedAllPSRegistersF.clear();
+	m_storedAllPSRegistersF.reset();
+
+	m_storedVSRegistersI.clear();
+	m_storedVSRegistersB.clear();
+	m_storedPSRegistersI.clear();
+	m_storedPSRegistersB.clear();
 
 	if (m_pStoredIndicies) {
 		m_pStoredIndicies->Release();
@@ -44,6 +44,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Direct3DPixelShader9.h"
 #include "Direct3DVertexDeclaration9.h"
 #include "StereoShaderConstant.h"
+#include "ShaderRegisters.h"
 
 class BaseDirect3DStateBlock9;
 class D3DProxyDevice;
@@ -149,12 +150,17 @@ public:
 	void           SelectAndCaptureState(UINT StreamNumber, BaseDirect3DVertexBuffer9* pWrappedStreamData);
 	HRESULT WINAPI SelectAndCaptureStateVSConst(UINT StartRegister,CONST float* pConstantData,UINT Vector4fCount);
 	HRESULT WINAPI SelectAndCaptureStatePSConst(UINT StartRegister,CONST float* pConstantData,UINT Vector4fCount);
+	HRESULT WINAPI SelectAndCaptureStateVSConstI(UINT StartRegister,CONST int* pConstantData,UINT Vector4iCount);
+	HRESULT WINAPI SelectAndCaptureStateVSConstB(UINT StartRegister,CONST BOOL* pConstantData,UINT BoolCount);
+	HRESULT WINAPI SelectAndCaptureStatePSConstI(UINT StartRegister,CONST int* pConstantData,UINT Vector4iCount);
+	HRESULT WINAPI SelectAndCaptureStatePSConstB(UINT StartRegister,CONST BOOL* pConstantData,UINT BoolCount);
 	void           EndStateBlock(IDirect3DStateBlock9* pActualStateBlock);
 	//void         ClearSelected(UINT StartRegister);
 
 private:
 	/*** D3D9ProxyStateBlock private methods ***/ 
 	void CaptureSelectedFromProxyDevice();
+	void CaptureConstantsIB(bool vertexShader, bool selectedOnly);
 	void Capture(CaptureableState toCap);
 	void ClearCapturedData();
 	void Apply(CaptureableState toApply, bool reApplyStereo);
@@ -203,6 +209,22 @@ private:
 	***/
 	std::unordered_set<UINT> m_selectedPixelConstantRegistersF;
 	/**
+	* Selected States to capture are only relevant if CaptureType is Cap_Type_Selected.
+	***/
+	std::unordered_set<UINT> m_selectedVertexConstantRegistersI;
+	/**
+	* Selected States to capture are only relevant if CaptureType is Cap_Type_Selected.
+	***/
+	std::unordered_set<UINT> m_selectedVertexConstantRegistersB;
+	/**
+	* Selected States to capture are only relevant if CaptureType is Cap_Type_Selected.
+	***/
+	std::unordered_set<UINT> m_selectedPixelConstantRegistersI;
+	/**
+	* Selected States to capture are only relevant if CaptureType is Cap_Type_Selected.
+	***/
+	std::unordered_set<UINT> m_selectedPixelConstantRegistersB;
+	/**
 	* General States - Textures in samplers (standard, vertex and displacement).
 	***/
 	std::unordered_map<DWORD, IDirect3DBaseTexture9*> m_storedTextureStages;
@@ -251,9 +273,17 @@ private:
 	std::map<UINT, D3DXVECTOR4> m_storedSelectedVSRegistersF;
 	/**
 	* Vertex Shader States -  Shader registers 
-	* Use this to copy everything when needed with other modes.
+	* Use this to capture everything when needed with other modes (page snapshot, unchanged pages shared with other state blocks).
+	**/
+	RegisterSnapshot m_storedAllVSRegistersF;
+	/**
+	* Vertex Shader States - Integer shader registers (all modes).
+	**/
+	std::map<UINT, IntRegister> m_storedVSRegistersI;
+	/**
+	* Vertex Shader States - Boolean shader registers (all modes).
 	**/
-	std::vector<float> m_storedAllVSRegistersF;
+	std::map<UINT, BOOL> m_storedVSRegistersB;
 	/**
 	* Pixel Shader State - Stored pixel shader.
 	***/
@@ -265,9 +295,17 @@ private:
 	std::map<UINT, D3DXVECTOR4> m_storedSelectedPSRegistersF;
 	/**
 	* Pixel Shader States -  Shader registers 
-	* Use this to copy everything when needed with other modes.
+	* Use this to capture everything when needed with other modes (page snapshot, unchanged pages shared with other state blocks).
+	**/
+	RegisterSnapshot m_storedAllPSRegistersF;
+	/**
+	* Pixel Shader States - Integer shader registers (all modes).
+	**/
+	std::map<UINT, IntRegister> m_storedPSRegistersI;
+	/**
+	* Pixel Shader States - Boolean shader registers (all modes).
 	**/
-	std::vector<float> m_storedAllPSRegistersF;
+	std::map<UINT, BOOL> m_storedPSRegistersB;
 	/**
 	* Pointer to wrapped device - quick solution (TODO) 
 	* Had issues when the type of the device in the base class was the wrapped type rather than the 
@@ -40,7 +40,12 @@ D3D9ProxySurface::D3D9ProxySurface(IDirect3DSurface9* pActualSurfaceLeft, IDirec
 	BaseDirect3DSurface9(pActualSurfaceLeft),
 	m_pActualSurfaceRight(pActualSurfaceRight),
 	m_pOwningDevice(pOwningDevice),
-	m_pWrappedContainer(pWrappedContainer)
+	m_pWrappedContainer(pWrappedContainer),
+	m_eStereoContent(Content_Unknown),
+	m_freshSide(vireio::Left),
+	m_bSideBySideResolved(true),
+	m_pActualSurfaceSideBySide(NULL),
+	m_bSideBySideFailed(false)
 {
 	assert (pOwningDevice != NULL);
 
@@ -67,6 +72,9 @@ D3D9ProxySurface::~D3D9ProxySurface()
 
 	if (m_pActualSurfaceRight)
 		m_pActualSurfaceRight->Release();
+
+	if (m_pActualSurfaceSideBySide)
+		m_pActualSurfaceSideBySide->Release();
 }
 
 /**
@@ -214,9 +222,16 @@ HRESULT WINAPI D3D9ProxySurface::GetContainer(REFIID riid, LPVOID* ppContainer)
 
 /**
 * Locks rectangle on both (left/right) surfaces.
+* Executes pending device commands first.
+* @see BaseDirect3DDevice9::FlushPendingCommands()
 ***/
 HRESULT WINAPI D3D9ProxySurface::LockRect(D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags)
 {
+	if (m_pOwningDevice)
+		m_pOwningDevice->FlushPendingCommands();
+
+	ResolveContent();
+
 	if (IsStereo())
 		m_pActualSurfaceRight->LockRect(pLockedRect, pRect, Flags);
 
@@ -275,4 +290,187 @@ IDirect3DSurface9* D3D9ProxySurface::getActualRight()
 bool D3D9ProxySurface::IsStereo()
 {
 	return m_pActualSurfaceRight != NULL;
-}
\ No newline at end of file
+}
+
+/**
+* Sides may differ, to be called after a stereo draw.
+***/
+void D3D9ProxySurface::MarkContentUnknown()
+{
+	m_eStereoContent = Content_Unknown;
+}
+
+/**
+* Both sides are equal, to be called after the whole surface is cleared for both sides.
+***/
+void D3D9ProxySurface::MarkContentEqual()
+{
+	m_eStereoContent = Content_Equal;
+}
+
+/**
+* A mono draw was done for one side only, the other side gets the content copied by ResolveContent().
+* Only call if CanDrawOneSide() returns true for that side.
+* @param side The side drawn.
+***/
+void D3D9ProxySurface::MarkContentDrawnOn(vireio::RenderPosition side)
+{
+	assert(CanDrawOneSide(side));
+
+	m_eStereoContent = Content_OneSide;
+	m_freshSide = side;
+}
+
+/**
+* True if a mono draw can be done for that side only : sides are equal or the
+* side already holds the current content.
+* @param side The side to draw.
+***/
+bool D3D9ProxySurface::CanDrawOneSide(vireio::RenderPosition side)
+{
+	return IsStereo() && ((m_eStereoContent == Content_Equal) || 
+		((m_eStereoContent == Content_OneSide) && (m_freshSide == side)));
+}
+
+/**
+* Copies the content of the side drawn by mono draws to the other side.
+* Must be called before the surface is read or both sides are drawn. Pending device 
+* commands are executed first (they may still draw on the other side).
+* Content drawn side-by-side is copied back to both sides, the side-by-side surface keeps
+* holding the current content (depth stencil content can not be copied back).
+* @return True if content was copied.
+***/
+bool D3D9ProxySurface::ResolveContent()
+{
+	if ((m_eStereoContent == Content_SideBySide) && !m_bSideBySideResolved) {
+		D3DSURFACE_DESC desc;
+		if (FAILED(m_pActualSurface->GetDesc(&desc)) || (desc.Usage & D3DUSAGE_DEPTHSTENCIL))
+			return false;
+
+		m_pOwningDevice->FlushPendingCommands();
+
+		RECT leftHalf;
+		RECT rightHalf;
+		SideBySideHalves(&leftHalf, &rightHalf);
+
+		if (FAILED(m_pOwningDevice->getActual()->StretchRect(m_pActualSurfaceSideBySide, &leftHalf, m_pActualSurface, NULL, D3DTEXF_NONE)) ||
+			FAILED(m_pOwningDevice->getActual()->StretchRect(m_pActualSurfaceSideBySide, &rightHalf, m_pActualSurfaceRight, NULL, D3DTEXF_NONE)))
+			OutputDebugString("ResolveContent: Failed to copy side-by-side drawn content to the sides.\n");
+
+		m_bSideBySideResolved = true;
+		return true;
+	}
+
+	if (m_eStereoContent != Content_OneSide)
+		return false;
+
+	m_pOwningDevice->FlushPendingCommands();
+
+	HRESULT hr;
+	if (m_freshSide == vireio::Left)
+		hr = m_pOwningDevice->getActual()->StretchRect(m_pActualSurface, NULL, m_pActualSurfaceRight, NULL, D3DTEXF_NONE);
+	else
+		hr = m_pOwningDevice->getActual()->StretchRect(m_pActualSurfaceRight, NULL, m_pActualSurface, NULL, D3DTEXF_NONE);
+
+	if (FAILED(hr))
+		OutputDebugString("ResolveContent: Failed to copy mono drawn content to the other side.\n");
+
+	m_eStereoContent = Content_Equal;
+	return true;
+}
+
+/**
+* Returns the side-by-side surface, creates it on first use.
+* The surface is twice as wide as the sides and not multisampled, multisampled surfaces have none.
+* @return NULL if the surface can not be created.
+***/
+IDirect3DSurface9* D3D9ProxySurface::getActualSideBySide()
+{
+	if (m_pActualSurfaceSideBySide || m_bSideBySideFailed)
+		return m_pActualSurfaceSideBySide;
+
+	HRESULT hr = D3DERR_INVALIDCALL;
+	D3DSURFACE_DESC desc;
+	if (SUCCEEDED(m_pActualSurface->GetDesc(&desc)) && (desc.MultiSampleType == D3DMULTISAMPLE_NONE)) {
+		if (desc.Usage & D3DUSAGE_DEPTHSTENCIL)
+			hr = m_pOwningDevice->getActual()->CreateDepthStencilSurface(desc.Width * 2, desc.Height, desc.Format, D3DMULTISAMPLE_NONE, 0, FALSE, &m_pActualSurfaceSideBySide, NULL);
+		else if (desc.Usage & D3DUSAGE_RENDERTARGET)
+			hr = m_pOwningDevice->getActual()->CreateRenderTarget(desc.Width * 2, desc.Height, desc.Format, D3DMULTISAMPLE_NONE, 0, FALSE, &m_pActualSurfaceSideBySide, NULL);
+	}
+
+	if (FAILED(hr)) {
+		OutputDebugString("getActualSideBySide: No side-by-side surface, both sides are drawn separately.\n");
+		m_pActualSurfaceSideBySide = NULL;
+		m_bSideBySideFailed = true;
+	}
+
+	return m_pActualSurfaceSideBySide;
+}
+
+/**
+* True if the side-by-side surface holds the current content.
+***/
+bool D3D9ProxySurface::IsSideBySide()
+{
+	return m_eStereoContent == Content_SideBySide;
+}
+
+/**
+* The side-by-side surface was drawn (or cleared as a whole), to be called after each draw in the side-by-side pass.
+***/
+void D3D9ProxySurface::MarkContentSideBySide()
+{
+	m_eStereoContent = Content_SideBySide;
+	m_bSideBySideResolved = false;
+}
+
+/**
+* Copies both sides into the halves of the side-by-side surface, mono drawn content is resolved first.
+* Only for render targets, depth stencil content can not be copied into the halves.
+* @return True if content was copied.
+***/
+bool D3D9ProxySurface::EnterSideBySide()
+{
+	if (m_eStereoContent == Content_SideBySide)
+		return false;
+
+	ResolveContent();
+
+	RECT leftHalf;
+	RECT rightHalf;
+	SideBySideHalves(&leftHalf, &rightHalf);
+
+	if (FAILED(m_pOwningDevice->getActual()->StretchRect(m_pActualSurface, NULL, m_pActualSurfaceSideBySide, &leftHalf, D3DTEXF_NONE)) ||
+		FAILED(m_pOwningDevice->getActual()->StretchRect(m_pActualSurfaceRight, NULL, m_pActualSurfaceSideBySide, &rightHalf, D3DTEXF_NONE)))
+		OutputDebugString("EnterSideBySide: Failed to copy the sides to the side-by-side surface.\n");
+
+	m_eStereoContent = Content_SideBySide;
+	m_bSideBySideResolved = true;
+	return true;
+}
+
+/**
+* Copies the side-by-side content back to both sides, the sides hold the current content afterwards.
+* @return True if content was copied.
+***/
+bool D3D9ProxySurface::LeaveSideBySide()
+{
+	if (m_eStereoContent != Content_SideBySide)
+		return false;
+
+	bool copied = ResolveContent();
+	m_eStereoContent = Content_Unknown;
+	return copied;
+}
+
+/**
+* Returns the left and right half of the side-by-side surface.
+***/
+void D3D9ProxySurface::SideBySideHalves(RECT* pLeftHalf, RECT* pRightHalf)
+{
+	D3DSURFACE_DESC desc;
+	m_pActualSurface->GetDesc(&desc);
+
+	SetRect(pLeftHalf, 0, 0, (LONG)desc.Width, (LONG)desc.Height);
+	SetRect(pRightHalf, (LONG)desc.Width, 0, (LONG)desc.Width * 2, (LONG)desc.Height);
+}
@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Direct3DSurface9.h"
 #include "Direct3DDevice9.h"
 #include "IStereoCapableWrapper.h"
+#include "Vireio.h"
 #include <stdio.h>
 
 
@@ -67,8 +68,45 @@ public:
 	virtual IDirect3DSurface9* getActualLeft();
 	virtual IDirect3DSurface9* getActualRight();
 	virtual bool               IsStereo();
+	void                       MarkContentUnknown();
+	void                       MarkContentEqual();
+	void                       MarkContentDrawnOn(vireio::RenderPosition side);
+	bool                       CanDrawOneSide(vireio::RenderPosition side);
+	bool                       ResolveContent();
+	IDirect3DSurface9*         getActualSideBySide();
+	bool                       IsSideBySide();
+	void                       MarkContentSideBySide();
+	bool                       EnterSideBySide();
+	bool                       LeaveSideBySide();
 
 protected:
+	/*** D3D9ProxySurface protected methods ***/
+	void SideBySideHalves(RECT* pLeftHalf, RECT* pRightHalf);
+
+	/**
+	* Stereo content state, used to skip the second side of mono draws.
+	***/
+	enum StereoContent
+	{
+		Content_Unknown,    /**< Sides may differ. */
+		Content_Equal,      /**< Both sides are equal (after all pending commands are executed). */
+		Content_OneSide,    /**< Sides were equal, then mono draws were done on m_freshSide only. */
+		Content_SideBySide  /**< The side-by-side surface holds the current content of both sides (instanced stereo). */
+	};
+
+	/**
+	* Stereo content state of a stereo surface.
+	***/
+	StereoContent m_eStereoContent;
+	/**
+	* The side holding the current content if m_eStereoContent is Content_OneSide.
+	***/
+	vireio::RenderPosition m_freshSide;
+	/**
+	* True if the left and right surfaces hold the content of the side-by-side surface, while
+	* m_eStereoContent is Content_SideBySide.
+	***/
+	bool m_bSideBySideResolved;
 	/**
 	* Container this surface is part of. Texture, CubeTexture, SwapChain, (other?) NULL if standalone surface.
 	*
@@ -98,5 +136,15 @@ protected:
 	* NULL for surfaces that aren't being duplicated.
 	***/
 	IDirect3DSurface9* const m_pActualSurfaceRight;
+	/**
+	* Double width surface, left side in the left half and right side in the right half.
+	* Created on first use by getActualSideBySide(), NULL if not created (yet).
+	* @see D3DProxyDevice::beginSideBySidePass()
+	***/
+	IDirect3DSurface9* m_pActualSurfaceSideBySide;
+	/**
+	* True if the side-by-side surface can not be created (multisampled or too large).
+	***/
+	bool m_bSideBySideFailed;
 };
 #endif
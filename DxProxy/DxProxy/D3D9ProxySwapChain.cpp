@@ -108,6 +108,9 @@ HRESULT WINAPI D3D9ProxySwapChain::Present(CONST RECT* pSourceRect, CONST RECT*
 	OutputDebugString("\n");
 #endif;
 
+	// commands deferred for the second eye have to be drawn before the stereo view is composed
+	m_pOwningDevice->FlushPendingCommands();
+
 	// Test only, StereoView needs to be properly integrated as part of SwapChain.
 	// This test allowed deus ex menus and videos to work correctly. Lots of model rendering issues in game though
 	D3DProxyDevice* pD3DProxyDev = static_cast<D3DProxyDevice*>(m_pOwningDevice);
@@ -117,9 +120,16 @@ HRESULT WINAPI D3D9ProxySwapChain::Present(CONST RECT* pSourceRect, CONST RECT*
 	try {
 		GetBackBuffer(0, D3DBACKBUFFER_TYPE_MONO, &pWrappedBackBuffer);
 
-		if (pD3DProxyDev->stereoView->initialized)
+		if (pD3DProxyDev->stereoView->initialized) {
+			// mono draws may have been done for one side only
+			static_cast<D3D9ProxySurface*>(pWrappedBackBuffer)->ResolveContent();
+
 			pD3DProxyDev->stereoView->Draw(static_cast<D3D9ProxySurface*>(pWrappedBackBuffer));
 
+			// stereo view sets states directly on the actual device
+			pD3DProxyDev->InvalidateShadowState();
+		}
+
 		pWrappedBackBuffer->Release();
 	}
 	catch (std::out_of_range) {
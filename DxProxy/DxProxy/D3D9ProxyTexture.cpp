@@ -258,9 +258,14 @@ HRESULT WINAPI D3D9ProxyTexture::GetSurfaceLevel(UINT Level, IDirect3DSurface9**
 
 /**
 * Locks rectangle on both (left/right) textures.
+* Executes pending device commands first.
+* @see BaseDirect3DDevice9::FlushPendingCommands()
 ***/
 HRESULT WINAPI D3D9ProxyTexture::LockRect(UINT Level, D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags)
 {
+	if (m_pOwningDevice)
+		m_pOwningDevice->FlushPendingCommands();
+
 	if (IsStereo())
 		m_pActualTextureRight->LockRect(Level, pLockedRect, pRect, Flags);
 
@@ -0,0 +1,102 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <D3D9ProxyVertexDeclaration.cpp> and
+Class <D3D9ProxyVertexDeclaration> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "D3D9ProxyVertexDeclaration.h"
+#include "StereoShaderPatcher.h"
+
+/**
+* Constructor.
+* @param pActualVertexDeclaration Imbed actual vertex declaration.
+* @param pOwningDevice Pointer to the device that owns the declaration.
+* @param pActualDevice The actual device.
+***/
+D3D9ProxyVertexDeclaration::D3D9ProxyVertexDeclaration(IDirect3DVertexDeclaration9* pActualVertexDeclaration, IDirect3DDevice9* pOwningDevice, IDirect3DDevice9* pActualDevice) :
+	BaseDirect3DVertexDeclaration9(pActualVertexDeclaration, pOwningDevice),
+	m_pActualDevice(pActualDevice),
+	m_pInstancedStereoDeclaration(NULL),
+	m_instancedStereoCreated(false),
+	m_streamMask(0)
+{}
+
+/**
+* Destructor, releases the instanced stereo declaration.
+***/
+D3D9ProxyVertexDeclaration::~D3D9ProxyVertexDeclaration()
+{
+	if (m_pInstancedStereoDeclaration)
+		m_pInstancedStereoDeclaration->Release();
+}
+
+/**
+* Returns the declaration for single-pass instanced stereo, creates it on first use.
+* The elements of the declaration are kept, a FLOAT4 TEXCOORD15 element on INSTANCED_STEREO_STREAM is added.
+* @return NULL if the declaration already uses that stream or input.
+***/
+IDirect3DVertexDeclaration9* D3D9ProxyVertexDeclaration::InstancedStereoDeclaration()
+{
+	if (m_instancedStereoCreated)
+		return m_pInstancedStereoDeclaration;
+	m_instancedStereoCreated = true;
+
+	// the element count includes the D3DDECL_END element
+	D3DVERTEXELEMENT9 elements[MAXD3DDECLLENGTH + 1];
+	UINT count = 0;
+	if (FAILED(m_pActualVertexDeclaration->GetDeclaration(NULL, &count)) || (count == 0) || (count > MAXD3DDECLLENGTH) ||
+		FAILED(m_pActualVertexDeclaration->GetDeclaration(elements, &count)))
+		return NULL;
+
+	UINT end = count - 1;
+	for (UINT i = 0; i < end; i++) {
+		if ((elements[i].Stream == INSTANCED_STEREO_STREAM) ||
+			((elements[i].Usage == D3DDECLUSAGE_TEXCOORD) && (elements[i].UsageIndex == StereoShaderPatcher::INSTANCE_USAGE_INDEX)))
+			return NULL;
+
+		m_streamMask |= 1 << elements[i].Stream;
+	}
+
+	D3DVERTEXELEMENT9 instanceElement = {INSTANCED_STEREO_STREAM, 0, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, StereoShaderPatcher::INSTANCE_USAGE_INDEX};
+	elements[end + 1] = elements[end];
+	elements[end] = instanceElement;
+
+	if (FAILED(m_pActualDevice->CreateVertexDeclaration(elements, &m_pInstancedStereoDeclaration))) {
+		OutputDebugString("Instanced stereo: Failed to create the instanced vertex declaration.\n");
+		m_pInstancedStereoDeclaration = NULL;
+	}
+
+	return m_pInstancedStereoDeclaration;
+}
+
+/**
+* Bitmask of the streams the declaration reads, bit n set for stream n.
+* Only valid if InstancedStereoDeclaration() returned a declaration.
+***/
+DWORD D3D9ProxyVertexDeclaration::StreamMask()
+{
+	return m_streamMask;
+}
@@ -0,0 +1,76 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <D3D9ProxyVertexDeclaration.h> and
+Class <D3D9ProxyVertexDeclaration> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef D3D9PROXYVERTEXDECLARATION_H_INCLUDED
+#define D3D9PROXYVERTEXDECLARATION_H_INCLUDED
+
+#include <d3d9.h>
+#include "Direct3DVertexDeclaration9.h"
+#include "Vireio.h"
+
+/**
+*  Direct 3D proxy vertex declaration class.
+*  Overwrites BaseDirect3DVertexDeclaration9 and holds the declaration used for single-pass instanced stereo.
+*/
+class D3D9ProxyVertexDeclaration : public BaseDirect3DVertexDeclaration9
+{
+public:
+	D3D9ProxyVertexDeclaration(IDirect3DVertexDeclaration9* pActualVertexDeclaration, IDirect3DDevice9* pOwningDevice, IDirect3DDevice9* pActualDevice);
+	virtual ~D3D9ProxyVertexDeclaration();
+
+	/**
+	* Stream of the per instance (eye) data in the instanced stereo declaration.
+	***/
+	static const UINT INSTANCED_STEREO_STREAM = STREAM_COUNT - 1;
+
+	/*** D3D9ProxyVertexDeclaration public methods ***/
+	IDirect3DVertexDeclaration9* InstancedStereoDeclaration();
+	DWORD                        StreamMask();
+
+protected:
+	/**
+	* Actual owning device, creates the instanced stereo declaration.
+	***/
+	IDirect3DDevice9* m_pActualDevice;
+	/**
+	* The declaration extended by the per instance TEXCOORD15 input on INSTANCED_STEREO_STREAM, created on first use.
+	* NULL if the declaration already uses that stream or input.
+	* @see StereoShaderPatcher::INSTANCE_USAGE_INDEX
+	***/
+	IDirect3DVertexDeclaration9* m_pInstancedStereoDeclaration;
+	/**
+	* True once the instanced stereo declaration was created (or creation failed).
+	***/
+	bool m_instancedStereoCreated;
+	/**
+	* Bitmask of the streams the declaration reads, bit n set for stream n. Set with the instanced stereo declaration.
+	***/
+	DWORD m_streamMask;
+};
+#endif
@@ -28,30 +28,109 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ********************************************************************/
 
 #include "D3D9ProxyVertexShader.h"
+#include "D3DProxyDevice.h"
+#include "ShaderModificationRepository.h"
+#include "StereoShaderPatcher.h"
 
 /**
 * Constructor.
+* Queues the analysis of the shader, the game does not wait for it.
 * @param pModLoader Can be NULL (no modifications in this game profile).
 ***/
 D3D9ProxyVertexShader::D3D9ProxyVertexShader(IDirect3DVertexShader9* pActualVertexShader, D3DProxyDevice *pOwningDevice, ShaderModificationRepository* pModLoader) :
 	BaseDirect3DVertexShader9(pActualVertexShader, pOwningDevice),
 	m_pActualDevice(pOwningDevice->getActual()),
-	m_modifiedConstants()
+	m_modifiedConstants(),
+	m_spAnalysis(),
+	m_analysisTaken(false),
+	m_pInstancedStereoShader(NULL),
+	m_instancedStereoRightRegisters()
 {
 	if (pModLoader)
-		m_modifiedConstants = pModLoader->GetModifiedConstantsF(pActualVertexShader);
+		m_spAnalysis = pModLoader->QueueModifiedConstantsF(pActualVertexShader);
 }
 
 /**
-* Empty destructor.
+* Destructor, releases the instanced stereo copy.
 ***/
 D3D9ProxyVertexShader::~D3D9ProxyVertexShader()
-{}
+{
+	if (m_pInstancedStereoShader)
+		m_pInstancedStereoShader->Release();
+}
 
 /**
 * Returns modified constants pointer.
+* Picks up the result of the analysis on first use, waits for the analysis if it is still running.
+* (the queue finishes all analyses before it is destroyed, a finished analysis does not touch it)
 ***/
-std::map<UINT, StereoShaderConstant<float>>* D3D9ProxyVertexShader::ModifiedConstants()
+StereoConstantTable* D3D9ProxyVertexShader::ModifiedConstants()
 {
+	if (m_spAnalysis && !m_analysisTaken) {
+		ShaderAnalysisQueue::Finish(m_spAnalysis.get());
+
+		// shares the layout, copies the constant data
+		m_modifiedConstants = m_spAnalysis->result;
+		m_analysisTaken = true;
+	}
+
 	return &m_modifiedConstants;
-}
\ No newline at end of file
+}
+
+/**
+* Creates the copy patched for single-pass instanced stereo, called on shader creation in instanced
+* stereo mode. Patching needs the modified constants, so the analysis is finished here.
+* @param floatRegisterCount Float registers of the device, the right constants go to free registers below.
+* @return False if the shader can not be patched, it is drawn per side then.
+* @see StereoShaderPatcher::PatchVertexShader()
+***/
+bool D3D9ProxyVertexShader::CreateInstancedStereoShader(UINT floatRegisterCount)
+{
+	StereoConstantTable* pConstants = ModifiedConstants();
+	std::vector<StereoShaderPatcher::StereoConstant> stereoConstants(pConstants->Size());
+	for (UINT i = 0; i < pConstants->Size(); i++) {
+		stereoConstants[i].startRegister = pConstants->StartRegister(i);
+		stereoConstants[i].count = pConstants->Count(i);
+	}
+
+	UINT sizeOfData = 0;
+	getActual()->GetFunction(NULL, &sizeOfData);
+	std::vector<BYTE> function(sizeOfData);
+	if ((sizeOfData == 0) || FAILED(getActual()->GetFunction(&function[0], &sizeOfData)))
+		return false;
+
+	StereoShaderPatcher patcher;
+	if (!patcher.PatchVertexShader(&function[0], sizeOfData, stereoConstants, floatRegisterCount)) {
+		OutputDebugString("Instanced stereo: vertex shader drawn per side, ");
+		OutputDebugString(patcher.Error());
+		OutputDebugString("\n");
+		return false;
+	}
+
+	if (FAILED(m_pActualDevice->CreateVertexShader(reinterpret_cast<const DWORD*>(&patcher.Function()[0]), &m_pInstancedStereoShader))) {
+		OutputDebugString("Instanced stereo: Failed to create the patched vertex shader.\n");
+		m_pInstancedStereoShader = NULL;
+		return false;
+	}
+
+	m_instancedStereoRightRegisters = patcher.RightRegisters();
+	return true;
+}
+
+/**
+* Returns the copy patched for single-pass instanced stereo, NULL if none was created.
+* @see CreateInstancedStereoShader()
+***/
+IDirect3DVertexShader9* D3D9ProxyVertexShader::InstancedStereoShader()
+{
+	return m_pInstancedStereoShader;
+}
+
+/**
+* Right start register of each modified constant in the instanced stereo copy, in the order of the
+* modified constants. Only valid if CreateInstancedStereoShader() succeeded.
+***/
+const std::vector<uint32_t>& D3D9ProxyVertexShader::InstancedStereoRightRegisters()
+{
+	return m_instancedStereoRightRegisters;
+}
@@ -36,10 +36,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <vector>
 #include <algorithm>
 #include "Direct3DVertexShader9.h"
-#include "Direct3DDevice9.h"
-#include "ShaderRegisters.h"
-#include "D3DProxyDevice.h"
-#include "ShaderModificationRepository.h"
+#include "StereoConstantTable.h"
+#include "ShaderAnalysisQueue.h"
 
 
 class D3DProxyDevice;
@@ -56,17 +54,41 @@ public:
 	virtual ~D3D9ProxyVertexShader();
 
 	/*** D3D9ProxyVertexShader public methods ***/
-	std::map<UINT, StereoShaderConstant<>>* ModifiedConstants();
+	StereoConstantTable*         ModifiedConstants();
+	bool                         CreateInstancedStereoShader(UINT floatRegisterCount);
+	IDirect3DVertexShader9*      InstancedStereoShader();
+	const std::vector<uint32_t>& InstancedStereoRightRegisters();
 protected:
 	/**
-	* Currently not used actual owning device.
+	* Actual owning device, creates the instanced stereo copy.
 	***/
 	IDirect3DDevice9* m_pActualDevice;
 	/**
-	* Modified shader constants.
-	* <StartRegister, StereoShaderConstant<>>
-	* @see StereoShaderConstant
+	* Modified shader constants, sorted by start register.
+	* Only valid after ModifiedConstants() was called (the analysis may still be pending before).
+	* The table layout is shared with all shaders of the same function, only the constant data is per shader.
+	* @see StereoConstantTable
 	***/
-	std::map<UINT, StereoShaderConstant<>> m_modifiedConstants;
+	StereoConstantTable m_modifiedConstants;
+	/**
+	* Analysis of the shader function, shared by all shaders of the same function.
+	* The modified constants are taken from it on first use, it is held to keep the function interned.
+	***/
+	std::shared_ptr<ShaderAnalysisQueue::Job> m_spAnalysis;
+	/**
+	* True once the modified constants were taken from the analysis.
+	***/
+	bool m_analysisTaken;
+	/**
+	* Copy patched for single-pass instanced stereo, created with the shader in instanced stereo mode.
+	* NULL if the shader can not be patched (or instanced stereo is off).
+	* @see StereoShaderPatcher
+	***/
+	IDirect3DVertexShader9* m_pInstancedStereoShader;
+	/**
+	* Right start register of each modified constant in the patched copy (StereoShaderPatcher::NO_REGISTER
+	* for constants the shader does not read).
+	***/
+	std::vector<uint32_t> m_instancedStereoRightRegisters;
 };
 #endif
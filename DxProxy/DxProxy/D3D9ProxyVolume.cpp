@@ -164,6 +164,18 @@ HRESULT WINAPI D3D9ProxyVolume::GetContainer(REFIID riid, LPVOID* ppContainer)
 	}
 }
 
+/**
+* Locks box, executes pending device commands first.
+* @see BaseDirect3DDevice9::FlushPendingCommands()
+***/
+HRESULT WINAPI D3D9ProxyVolume::LockBox(D3DLOCKED_BOX* pLockedVolume, CONST D3DBOX* pBox, DWORD Flags)
+{
+	if (m_pOwningDevice)
+		m_pOwningDevice->FlushPendingCommands();
+
+	return BaseDirect3DVolume9::LockBox(pLockedVolume, pBox, Flags);
+}
+
 /**
 * Gets the actual (parent) volume.
 ***/
@@ -56,6 +56,7 @@ public:
 	/*** IDirect3DVolume9 methods ***/
 	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice);
 	virtual HRESULT WINAPI GetContainer(REFIID riid, LPVOID* ppContainer);
+	virtual HRESULT WINAPI LockBox(D3DLOCKED_BOX* pLockedVolume, CONST D3DBOX* pBox, DWORD Flags);
 
 	/*** D3D9ProxyVolume public methods ***/
 	IDirect3DVolume9* getActualVolume();
@@ -143,6 +143,18 @@ HRESULT WINAPI D3D9ProxyVolumeTexture::GetVolumeLevel(UINT Level, IDirect3DVolum
 	return finalResult;
 }
 
+/**
+* Locks box, executes pending device commands first.
+* @see BaseDirect3DDevice9::FlushPendingCommands()
+***/
+HRESULT WINAPI D3D9ProxyVolumeTexture::LockBox(UINT Level, D3DLOCKED_BOX* pLockedVolume, CONST D3DBOX* pBox, DWORD Flags)
+{
+	if (m_pOwningDevice)
+		m_pOwningDevice->FlushPendingCommands();
+
+	return BaseDirect3DVolumeTexture9::LockBox(Level, pLockedVolume, pBox, Flags);
+}
+
 /**
 * Returns the actual volume texture.
 ***/
@@ -48,6 +48,7 @@ public:
 	/*** IDirect3DBaseTexture9 methods ***/
 	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice);
 	virtual HRESULT WINAPI GetVolumeLevel(UINT Level, IDirect3DVolume9** ppVolumeLevel);
+	virtual HRESULT WINAPI LockBox(UINT Level, D3DLOCKED_BOX* pLockedVolume, CONST D3DBOX* pBox, DWORD Flags);
 
 	/*** IDirect3DVolumeTexture9 public methods ***/
 	IDirect3DVolumeTexture9* getActual();	
@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "D3D9ProxySurface.h"
 #include "StereoViewFactory.h"
 #include "MotionTrackerFactory.h"
+#include "StereoShaderPatcher.h"
 #include <typeinfo>
 #include <assert.h>
 #include <comdef.h>
@@ -58,6 +59,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MAX_PIXEL_SHADER_CONST_2_X 32
 #define MAX_PIXEL_SHADER_CONST_3_0 224
 
+// sequential indices for instanced stereo DrawPrimitive() calls, larger draws are drawn per side
+#define SEQUENTIAL_INDEX_COUNT 65536
+
 /**
 * Returns the mouse wheel scroll lines.
 ***/
@@ -90,12 +94,14 @@ UINT GetMouseScrollLines()
 ***/
 D3DProxyDevice::D3DProxyDevice(IDirect3DDevice9* pDevice, BaseDirect3D9* pCreatedBy):BaseDirect3DDevice9(pDevice, pCreatedBy),
 	m_activeRenderTargets (1, NULL),
-	m_activeTextureStages(),
-	m_activeVertexBuffers(),
+	m_stereoTextureStages(0),
 	m_activeSwapChains()
 {
 	OutputDebugString("D3D ProxyDev Created\n");
 
+	ZeroMemory(m_activeTextureStages, sizeof(m_activeTextureStages));
+	ZeroMemory(m_activeVertexBuffers, sizeof(m_activeVertexBuffers));
+
 	HMDisplayInfo defaultInfo; // rift info
 	m_spShaderViewAdjustment = std::make_shared<ViewAdjustment>(defaultInfo, 1.0f, false);
 
@@ -124,7 +130,7 @@ D3DProxyDevice::D3DProxyDevice(IDirect3DDevice9* pDevice, BaseDirect3D9* pCreate
 	if ((major_ps>=2) && (minor_ps>0)) MaxPixelShaderConst = MAX_PIXEL_SHADER_CONST_2_X;
 	if ((major_ps>=3) && (minor_ps>=0)) MaxPixelShaderConst = MAX_PIXEL_SHADER_CONST_3_0;
 
-	m_spManagedShaderRegisters = std::make_shared<ShaderRegisters>(MaxPixelShaderConst, capabilities.MaxVertexShaderConst, pDevice);
+	m_spManagedShaderRegisters = std::make_shared<ShaderRegisters>(MaxPixelShaderConst, capabilities.MaxVertexShaderConst, pDevice, &m_counters.Frame(), m_spShaderViewAdjustment);
 
 	m_pActiveStereoDepthStencil = NULL;
 	m_pActiveIndicies = NULL;
@@ -141,6 +147,18 @@ D3DProxyDevice::D3DProxyDevice(IDirect3DDevice9* pDevice, BaseDirect3D9* pCreate
 	m_pCapturingStateTo = NULL;
 
 	m_isFirstBeginSceneOfFrame = true;
+	m_bDeferredRightEye = false;
+	m_bReplayingStereoCommands = false;
+	m_bMonoDrawElision = false;
+	m_bInstancedStereo = false;
+	m_maxVertexShaderConst = capabilities.MaxVertexShaderConst;
+	m_pInstancedStereoBuffer = NULL;
+	m_pSequentialIndices = NULL;
+	m_bSideBySidePass = false;
+	m_bInstancedStereoBound = false;
+	m_sideBySideWidth = 0;
+	m_sideBySideHeight = 0;
+	SetRect(&m_LastScissorRect, 0, 0, 0, 0);
 
 	yaw_mode = 0;
 	pitch_mode = 0;
@@ -422,6 +440,10 @@ HRESULT WINAPI D3DProxyDevice::GetSwapChain(UINT iSwapChain,IDirect3DSwapChain9*
 ***/
 HRESULT WINAPI D3DProxyDevice::Reset(D3DPRESENT_PARAMETERS* pPresentationParameters)
 {
+	PROXY_PROFILE_SCOPE("Reset");
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_Reset, 0, 0, 0, 0, pPresentationParameters, pPresentationParameters ? sizeof(D3DPRESENT_PARAMETERS) : 0);
+
 	if(stereoView)
 		stereoView->ReleaseEverything();
 
@@ -467,14 +489,32 @@ HRESULT WINAPI D3DProxyDevice::Reset(D3DPRESENT_PARAMETERS* pPresentationParamet
 ***/
 HRESULT WINAPI D3DProxyDevice::Present(CONST RECT* pSourceRect,CONST RECT* pDestRect,HWND hDestWindowOverride,CONST RGNDATA* pDirtyRegion)
 {
+	ProxyProfiler::MarkFrame();
+	PROXY_PROFILE_SCOPE("Present");
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_Present);
+
+	// commands deferred for the second eye have to be drawn before the stereo view is composed
+	FlushPendingCommands();
+
+	// the stereo view and BRASSA draw on the sides, the pass resumes with the next render target or depth stencil change
+	endSideBySidePass();
+
 	IDirect3DSurface9* pWrappedBackBuffer;
 
 	try {
 		m_activeSwapChains.at(0)->GetBackBuffer(0, D3DBACKBUFFER_TYPE_MONO, &pWrappedBackBuffer);
 
-		if (stereoView->initialized)
+		if (stereoView->initialized) {
+			// mono draws on the back buffer (or any bound render target) need both sides now
+			resolveRenderTargets();
+
 			stereoView->Draw(static_cast<D3D9ProxySurface*>(pWrappedBackBuffer));
 
+			// stereo view sets states directly on the actual device
+			InvalidateShadowState();
+		}
+
 		pWrappedBackBuffer->Release();
 	}
 	catch (std::out_of_range) {
@@ -505,6 +545,21 @@ HRESULT WINAPI D3DProxyDevice::Present(CONST RECT* pSourceRect,CONST RECT* pDest
 			menuVelocity.y+=10.0f;
 		borderTopHeight += menuVelocity.y*fScaleY;
 	}
+
+	// BRASSA draws may be deferred as well
+	FlushPendingCommands();
+
+	// publish the counters of this frame, the shadow state starts its new frame in the base Present
+	m_counters.Frame().drawsDeferred = m_stereoCommands.FrameStatistics().drawsDeferred;
+	m_counters.Frame().filteredCalls = getShadowState()->FrameFilteredCalls();
+	ShaderModificationRepository* pModLoader = m_pGameHandler->GetShaderModificationRepository();
+	if (pModLoader) {
+		m_counters.Frame().shaderAnalysisQueueDepth = pModLoader->AnalysisQueue()->Depth();
+		pModLoader->AnalysisQueue()->TakeStalls(&m_counters.Frame().shaderAnalysisStalls, &m_counters.Frame().shaderAnalysisStallTime);
+	}
+	m_counters.Publish();
+	m_stereoCommands.NewFrame();
+
 	return BaseDirect3DDevice9::Present(pSourceRect, pDestRect, hDestWindowOverride, pDirtyRegion);
 }
 
@@ -557,6 +612,9 @@ HRESULT WINAPI D3DProxyDevice::CreateTexture(UINT Width,UINT Height,UINT Levels,
 	if (SUCCEEDED(creationResult))
 		*ppTexture = new D3D9ProxyTexture(pLeftTexture, pRightTexture, this);
 
+	if (SUCCEEDED(creationResult) && m_callTrace.IsCapturing())
+		m_callTrace.ForgetObject(*ppTexture);
+
 	return creationResult;
 }
 
@@ -573,6 +631,9 @@ HRESULT WINAPI D3DProxyDevice::CreateVolumeTexture(UINT Width,UINT Height,UINT D
 	if (SUCCEEDED(creationResult))
 		*ppVolumeTexture = new D3D9ProxyVolumeTexture(pActualTexture, this);
 
+	if (SUCCEEDED(creationResult) && m_callTrace.IsCapturing())
+		m_callTrace.ForgetObject(*ppVolumeTexture);
+
 	return creationResult;
 }
 
@@ -607,6 +668,9 @@ HRESULT WINAPI D3DProxyDevice::CreateCubeTexture(UINT EdgeLength, UINT Levels, D
 	if (SUCCEEDED(creationResult))
 		*ppCubeTexture = new D3D9ProxyCubeTexture(pLeftCubeTexture, pRightCubeTexture, this);
 
+	if (SUCCEEDED(creationResult) && m_callTrace.IsCapturing())
+		m_callTrace.ForgetObject(*ppCubeTexture);
+
 	return creationResult;
 }
 
@@ -622,6 +686,9 @@ HRESULT WINAPI D3DProxyDevice::CreateVertexBuffer(UINT Length, DWORD Usage, DWOR
 	if (SUCCEEDED(creationResult))
 		*ppVertexBuffer = new BaseDirect3DVertexBuffer9(pActualBuffer, this);
 
+	if (SUCCEEDED(creationResult) && m_callTrace.IsCapturing())
+		m_callTrace.ForgetObject(*ppVertexBuffer);
+
 	return creationResult;
 }
 
@@ -637,6 +704,9 @@ HRESULT WINAPI D3DProxyDevice::CreateIndexBuffer(UINT Length,DWORD Usage,D3DFORM
 	if (SUCCEEDED(creationResult))
 		*ppIndexBuffer = new BaseDirect3DIndexBuffer9(pActualBuffer, this);
 
+	if (SUCCEEDED(creationResult) && m_callTrace.IsCapturing())
+		m_callTrace.ForgetObject(*ppIndexBuffer);
+
 	return creationResult;
 }
 
@@ -683,18 +753,29 @@ HRESULT WINAPI D3DProxyDevice::CreateDepthStencilSurface(UINT Width,UINT Height,
 	if (SUCCEEDED(creationResult))
 		*ppSurface = new D3D9ProxySurface(pDepthStencilSurfaceLeft, pDepthStencilSurfaceRight, this, NULL);
 
+	if (SUCCEEDED(creationResult) && m_callTrace.IsCapturing())
+		m_callTrace.ForgetObject(*ppSurface);
+
 	return creationResult;
 }
 
 /**
 * Copies rectangular subsets of pixels from one proxy (wrapped) surface to another.
+* Executes pending (deferred) commands and resolves mono drawn render targets first, a side-by-side pass
+* writing the destination is left.
 * @see D3D9ProxySurface
+* @see leaveSideBySidePassFor()
 ***/
 HRESULT WINAPI D3DProxyDevice::UpdateSurface(IDirect3DSurface9* pSourceSurface,CONST RECT* pSourceRect,IDirect3DSurface9* pDestinationSurface,CONST POINT* pDestPoint)
 {
+	FlushPendingCommands();
+	resolveRenderTargets();
+
 	if (!pSourceSurface || !pDestinationSurface)
 		return D3DERR_INVALIDCALL;
 
+	leaveSideBySidePassFor(pDestinationSurface);
+
 	IDirect3DSurface9* pSourceSurfaceLeft = static_cast<D3D9ProxySurface*>(pSourceSurface)->getActualLeft();
 	IDirect3DSurface9* pSourceSurfaceRight = static_cast<D3D9ProxySurface*>(pSourceSurface)->getActualRight();
 	IDirect3DSurface9* pDestSurfaceLeft = static_cast<D3D9ProxySurface*>(pDestinationSurface)->getActualLeft();
@@ -720,16 +801,22 @@ HRESULT WINAPI D3DProxyDevice::UpdateSurface(IDirect3DSurface9* pSourceSurface,C
 		}
 	}
 
+	updateSideBySidePass();
+
 	return result;
 }
 
 /**
 * Calls a helper function to unwrap the textures and calls the super method for both sides.
 * The super method updates the dirty portions of a texture.
+* Executes pending (deferred) commands and resolves mono drawn render targets first.
 * @see vireio::UnWrapTexture()
 ***/
 HRESULT WINAPI D3DProxyDevice::UpdateTexture(IDirect3DBaseTexture9* pSourceTexture,IDirect3DBaseTexture9* pDestinationTexture)
 {
+	FlushPendingCommands();
+	resolveRenderTargets();
+
 	if (!pSourceTexture || !pDestinationTexture)
 		return D3DERR_INVALIDCALL;
 
@@ -767,9 +854,13 @@ HRESULT WINAPI D3DProxyDevice::UpdateTexture(IDirect3DBaseTexture9* pSourceTextu
 
 /**
 * Copies the render-target data from proxy (wrapped) source surface to proxy (wrapped) destination surface.
+* Executes pending (deferred) commands and resolves mono drawn render targets first.
 ***/
 HRESULT WINAPI D3DProxyDevice::GetRenderTargetData(IDirect3DSurface9* pRenderTarget,IDirect3DSurface9* pDestSurface)
 {
+	FlushPendingCommands();
+	resolveRenderTargets();
+
 	if ((pDestSurface == NULL) || (pRenderTarget == NULL))
 		return D3DERR_INVALIDCALL;
 
@@ -806,10 +897,13 @@ HRESULT WINAPI D3DProxyDevice::GetRenderTargetData(IDirect3DSurface9* pRenderTar
 
 /**
 * Gets the front buffer data from the internal stored active proxy (or wrapped) swap chain.
+* Executes pending (deferred) commands first.
 * @see D3D9ProxySwapChain
 ***/
 HRESULT WINAPI D3DProxyDevice::GetFrontBufferData(UINT iSwapChain, IDirect3DSurface9* pDestSurface)
 {
+	FlushPendingCommands();
+
 	HRESULT result;
 	try {
 		result = m_activeSwapChains.at(iSwapChain)->GetFrontBufferData(pDestSurface);
@@ -824,13 +918,27 @@ HRESULT WINAPI D3DProxyDevice::GetFrontBufferData(UINT iSwapChain, IDirect3DSurf
 
 /**
 * Copy the contents of the source proxy (wrapped) surface rectangles to the destination proxy (wrapped) surface rectangles.
+* Executes pending (deferred) commands and resolves mono drawn render targets first, a side-by-side pass
+* writing the destination is left.
 * @see D3D9ProxySurface
+* @see leaveSideBySidePassFor()
 ***/
 HRESULT WINAPI D3DProxyDevice::StretchRect(IDirect3DSurface9* pSourceSurface,CONST RECT* pSourceRect,IDirect3DSurface9* pDestSurface,CONST RECT* pDestRect,D3DTEXTUREFILTERTYPE Filter)
 {
+	if (isTracingCalls()) {
+		DWORD rectFlags = (pSourceRect ? 1 : 0) | (pDestRect ? 2 : 0);
+		m_callTrace.Record(CallTrace::Call_StretchRect, m_callTrace.ObjectId(pSourceSurface), m_callTrace.ObjectId(pDestSurface), Filter, rectFlags, pSourceRect, pSourceRect ? sizeof(RECT) : 0);
+		m_callTrace.AppendData(pDestRect, pDestRect ? sizeof(RECT) : 0);
+	}
+
+	FlushPendingCommands();
+	resolveRenderTargets();
+
 	if (!pSourceSurface || !pDestSurface)
 		return D3DERR_INVALIDCALL;
 
+	leaveSideBySidePassFor(pDestSurface);
+
 	D3D9ProxySurface* pWrappedSource = static_cast<D3D9ProxySurface*>(pSourceSurface);
 	D3D9ProxySurface* pWrappedDest = static_cast<D3D9ProxySurface*>(pDestSurface);
 
@@ -840,11 +948,13 @@ HRESULT WINAPI D3DProxyDevice::StretchRect(IDirect3DSurface9* pSourceSurface,CON
 	IDirect3DSurface9* pDestSurfaceRight = pWrappedDest->getActualRight();
 
 	HRESULT result = BaseDirect3DDevice9::StretchRect(pSourceSurfaceLeft, pSourceRect, pDestSurfaceLeft, pDestRect, Filter);
+	m_counters.Frame().stretchRectCopies++;
 
 	if (SUCCEEDED(result)) {
 		if (!pSourceSurfaceRight && pDestSurfaceRight) {
 			//OutputDebugString("INFO: StretchRect - Source is not stereo, destination is stereo. Copying source to both sides of destination.\n");
 
+			m_counters.Frame().stretchRectCopies++;
 			if (FAILED(BaseDirect3DDevice9::StretchRect(pSourceSurfaceLeft, pSourceRect, pDestSurfaceRight, pDestRect, Filter))) {
 				OutputDebugString("ERROR: StretchRect - Failed to copy source left to destination right.\n");
 			}
@@ -853,27 +963,42 @@ HRESULT WINAPI D3DProxyDevice::StretchRect(IDirect3DSurface9* pSourceSurface,CON
 			//OutputDebugString("INFO: StretchRect - Source is stereo, destination is not stereo. Copied Left side only.\n");
 		}
 		else if (pSourceSurfaceRight && pDestSurfaceRight)	{
+			m_counters.Frame().stretchRectCopies++;
 			if (FAILED(BaseDirect3DDevice9::StretchRect(pSourceSurfaceRight, pSourceRect, pDestSurfaceRight, pDestRect, Filter))) {
 				OutputDebugString("ERROR: StretchRect - Failed to copy source right to destination right.\n");
 			}
 		}
 	}
 
+	updateSideBySidePass();
+
 	return result;
 }
 
 /**
 * Fills the rectangle for both stereo sides if switchDrawingSide() agrees and sets the render target accordingly.
+* Executes pending (deferred) commands and resolves mono drawn render targets first, they may use the surface.
+* A side-by-side pass filling the surface is left.
 * @see switchDrawingSide()
+* @see leaveSideBySidePassFor()
 ***/
 HRESULT WINAPI D3DProxyDevice::ColorFill(IDirect3DSurface9* pSurface,CONST RECT* pRect,D3DCOLOR color)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_ColorFill, m_callTrace.ObjectId(pSurface), color, pRect ? 1 : 0, 0, pRect, pRect ? sizeof(RECT) : 0);
+
+	FlushPendingCommands();
+	resolveRenderTargets();
+	leaveSideBySidePassFor(pSurface);
+
 	HRESULT result;
 	if (SUCCEEDED(result = BaseDirect3DDevice9::ColorFill(pSurface, pRect, color))) {
 		if (switchDrawingSide())
 			BaseDirect3DDevice9::ColorFill(pSurface, pRect, color);
 	}
 
+	updateSideBySidePass();
+
 	return result;
 }
 
@@ -894,17 +1019,38 @@ HRESULT WINAPI D3DProxyDevice::CreateOffscreenPlainSurface(UINT Width,UINT Heigh
 	if (SUCCEEDED(creationResult))
 		*ppSurface = new D3D9ProxySurface(pActualSurface, NULL, this, NULL);
 
+	if (SUCCEEDED(creationResult) && m_callTrace.IsCapturing())
+		m_callTrace.ForgetObject(*ppSurface);
+
 	return creationResult;
 }
 
 /**
 * Updates render target accordingly to current render side.
 * Updates proxy collection of stereo render targets to reflect new actual render target.
+* Commands deferred for the old render target are executed first, mono drawn render targets get both sides.
+* A side-by-side pass ends with a new primary render target or an additional render target and
+* resumes if the new targets still qualify.
+* @see FlushPendingCommands()
+* @see resolveRenderTargets()
+* @see updateSideBySidePass()
 ***/
 HRESULT WINAPI D3DProxyDevice::SetRenderTarget(DWORD RenderTargetIndex, IDirect3DSurface9* pRenderTarget)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetRenderTarget, RenderTargetIndex, m_callTrace.ObjectId(pRenderTarget));
+
+	FlushPendingCommands();
+
 	D3D9ProxySurface* newRenderTarget = static_cast<D3D9ProxySurface*>(pRenderTarget);
 
+	// the side surfaces are bound again before any target changes
+	if (m_bSideBySidePass && (RenderTargetIndex == 0 ? (newRenderTarget != m_activeRenderTargets[0]) : (newRenderTarget != NULL)))
+		endSideBySidePass();
+
+	if (!m_bSideBySidePass)
+		resolveRenderTargets();
+
 #ifdef _DEBUG
 	if (newRenderTarget && !newRenderTarget->getActualLeft() && !newRenderTarget->getActualRight()) {
 		OutputDebugString("RenderTarget is not a valid (D3D9ProxySurface) stereo capable surface\n"); 
@@ -947,6 +1093,15 @@ HRESULT WINAPI D3DProxyDevice::SetRenderTarget(DWORD RenderTargetIndex, IDirect3
 		m_activeRenderTargets[RenderTargetIndex] = newRenderTarget;
 		if (m_activeRenderTargets[RenderTargetIndex] != NULL)
 			m_activeRenderTargets[RenderTargetIndex]->AddRef();
+
+		// changing the primary render target resets the scissor rectangle to fullsurface as well
+		if ((RenderTargetIndex == 0) && m_bInstancedStereo) {
+			D3DSURFACE_DESC desc;
+			if (SUCCEEDED(newRenderTarget->GetDesc(&desc)))
+				SetRect(&m_LastScissorRect, 0, 0, desc.Width, desc.Height);
+		}
+
+		updateSideBySidePass();
 	}
 
 	return result;
@@ -974,9 +1129,19 @@ HRESULT WINAPI D3DProxyDevice::GetRenderTarget(DWORD RenderTargetIndex,IDirect3D
 /**
 * Updates depth stencil accordingly to current render side.
 * Updates stored proxy (or wrapped) depth stencil.
+* Commands deferred for the old depth stencil are executed first.
+* A side-by-side pass continues with the side-by-side surface of a depth stencil cleared in instanced
+* stereo mode, otherwise it ends.
+* @see FlushPendingCommands()
+* @see updateSideBySidePass()
 ***/
 HRESULT WINAPI D3DProxyDevice::SetDepthStencilSurface(IDirect3DSurface9* pNewZStencil)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetDepthStencilSurface, m_callTrace.ObjectId(pNewZStencil));
+
+	FlushPendingCommands();
+
 	D3D9ProxySurface* pNewDepthStencil = static_cast<D3D9ProxySurface*>(pNewZStencil);
 
 	IDirect3DSurface9* pActualStencilForCurrentSide = NULL;
@@ -1000,6 +1165,8 @@ HRESULT WINAPI D3DProxyDevice::SetDepthStencilSurface(IDirect3DSurface9* pNewZSt
 		if (m_pActiveStereoDepthStencil) {
 			m_pActiveStereoDepthStencil->AddRef();
 		}
+
+		updateSideBySidePass();
 	}
 
 	return result;
@@ -1027,7 +1194,11 @@ HRESULT WINAPI D3DProxyDevice::GetDepthStencilSurface(IDirect3DSurface9** ppZSte
 ***/
 HRESULT WINAPI D3DProxyDevice::BeginScene()
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_BeginScene);
+
 	if (m_isFirstBeginSceneOfFrame) {
+		PROXY_PROFILE_SCOPE("BeginScene tracking");
 
 		// save screenshot before first clear() is called
 		if (screenshot>0)
@@ -1063,23 +1234,66 @@ HRESULT WINAPI D3DProxyDevice::BeginScene()
 ***/
 HRESULT WINAPI D3DProxyDevice::EndScene()
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_EndScene);
+
 	if((stereoView->game_type == D3DProxyDevice::SOURCE_L4D) || (stereoView->game_type != D3DProxyDevice::DATA_GATHERER_SOURCE) || (stereoView->game_type == D3DProxyDevice::ADVANCED_SKYRIM))
 	{
 		if ((BRASSA_mode>=BRASSA_Modes::MAINMENU) && (BRASSA_mode<BRASSA_Modes::BRASSA_ENUM_RANGE))
 			BRASSA();
 	}
+
+	// deferred commands have to be drawn within the scene
+	FlushPendingCommands();
+
 	return BaseDirect3DDevice9::EndScene();
 }
 
 /**
 * Clears both stereo sides if switchDrawingSide() agrees.
+* In deferred mode the clear is recorded for the other side instead.
+* A full target clear marks the primary render target equal for both sides (mono draws may elide a side
+* afterwards), a partial target clear needs both sides of mono drawn render targets.
+* In instanced stereo mode a full depth clear starts the side-by-side pass, clears within it are done
+* on the side-by-side surfaces.
+* @see FlushPendingCommands()
+* @see prepareStereoDraw()
+* @see startSideBySidePass()
 ***/
 HRESULT WINAPI D3DProxyDevice::Clear(DWORD Count,CONST D3DRECT* pRects,DWORD Flags,D3DCOLOR Color,float Z,DWORD Stencil)
 {
+	if (isTracingCalls()) {
+		DWORD args[] = {Count, Flags, Color, CallTrace::FloatArg(Z), Stencil};
+		m_callTrace.RecordArgs(CallTrace::Call_Clear, args, 5, pRects, pRects ? Count * sizeof(D3DRECT) : 0);
+	}
+
+	m_counters.Frame().drawsIssued++;
+
+	if (m_bInstancedStereo && !m_bSideBySidePass && !m_bInBeginEndStateBlock)
+		startSideBySidePass(Count, pRects, Flags);
+	if (m_bSideBySidePass)
+		return clearSideBySide(Count, pRects, Flags, Color, Z, Stencil);
+
+	bool fullTargetClear = false;
+	if (m_bMonoDrawElision && (Flags & D3DCLEAR_TARGET)) {
+		DWORD scissorTestEnable = TRUE;
+		fullTargetClear = ((Count == 0) || (pRects == NULL)) && m_bActiveViewportIsDefault &&
+			SUCCEEDED(BaseDirect3DDevice9::GetRenderState(D3DRS_SCISSORTESTENABLE, &scissorTestEnable)) && !scissorTestEnable;
+
+		// the primary render target is overwritten by a full clear, no need to copy its content
+		if (fullTargetClear && m_activeRenderTargets[0] && m_activeRenderTargets[0]->IsStereo())
+			m_activeRenderTargets[0]->MarkContentEqual();
+		resolveRenderTargets();
+	}
 
 	HRESULT result;
 	if (SUCCEEDED(result = BaseDirect3DDevice9::Clear(Count, pRects, Flags, Color, Z, Stencil))) {
-		if (switchDrawingSide()) {
+		if (isRecordingStereoCommands()) {
+			StereoCommandList::Command* pCommand = m_stereoCommands.Record(StereoCommandList::Cmd_Type_Clear, Count, Flags, Color, Stencil, NULL, pRects, pRects ? Count * sizeof(D3DRECT) : 0);
+			pCommand->args[4] = *(DWORD*)&Z;
+		}
+		else if (switchDrawingSide()) {
+			m_counters.Frame().drawsDoubled++;
 
 			HRESULT hr;
 			if (FAILED(hr = BaseDirect3DDevice9::Clear(Count, pRects, Flags, Color, Z, Stencil))) {
@@ -1097,6 +1311,10 @@ HRESULT WINAPI D3DProxyDevice::Clear(DWORD Count,CONST D3DRECT* pRects,DWORD Fla
 
 			}
 		}
+
+		// both sides cleared, mono draws can start on one side
+		if (fullTargetClear && m_activeRenderTargets[0] && m_activeRenderTargets[0]->IsStereo())
+			m_activeRenderTargets[0]->MarkContentEqual();
 	}
 
 	return result;
@@ -1108,6 +1326,14 @@ HRESULT WINAPI D3DProxyDevice::Clear(DWORD Count,CONST D3DRECT* pRects,DWORD Fla
 ***/
 HRESULT WINAPI D3DProxyDevice::SetTransform(D3DTRANSFORMSTATETYPE State, CONST D3DMATRIX* pMatrix)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetTransform, State, 0, 0, 0, pMatrix, pMatrix ? sizeof(D3DMATRIX) : 0);
+
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_Transform, State);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_Transform, State, 0, 0, 0, NULL, pMatrix, pMatrix ? sizeof(D3DMATRIX) : 0);
+	}
+
 	if(State == D3DTS_VIEW)
 	{
 		D3DXMATRIX tempLeft;
@@ -1236,9 +1462,15 @@ HRESULT WINAPI D3DProxyDevice::SetTransform(D3DTRANSFORMSTATETYPE State, CONST D
 
 /**
 * Not implemented now - fix in case it needs fixing, calls super method.
+* Not recorded, executes pending (deferred) commands first.
 ***/
 HRESULT WINAPI D3DProxyDevice::MultiplyTransform(D3DTRANSFORMSTATETYPE State,CONST D3DMATRIX* pMatrix)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_MultiplyTransform, State, 0, 0, 0, pMatrix, pMatrix ? sizeof(D3DMATRIX) : 0);
+
+	FlushPendingCommands();
+
 	OutputDebugString(__FUNCTION__); 
 	OutputDebugString("\n"); 
 	OutputDebugString("Not implemented - Fix Me! (if i need fixing)\n"); 
@@ -1251,11 +1483,20 @@ HRESULT WINAPI D3DProxyDevice::MultiplyTransform(D3DTRANSFORMSTATETYPE State,CON
 * Also, it captures the viewport state in stored proxy state block.
 * If viewport width and height match primary render target size and zmin is 0 and zmax 1 set 
 * m_bActiveViewportIsDefault flag true.
+* In a side-by-side pass the viewport is moved to the half of the current side.
 * @see D3D9ProxyStateBlock::SelectAndCaptureState()
 * @see m_bActiveViewportIsDefault
 ***/
 HRESULT WINAPI D3DProxyDevice::SetViewport(CONST D3DVIEWPORT9* pViewport)
 {	
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetViewport, 0, 0, 0, 0, pViewport, pViewport ? sizeof(D3DVIEWPORT9) : 0);
+
+	if (isRecordingStereoCommands() && pViewport) {
+		captureRestoreState(StereoCommandList::Cmd_Type_Viewport, 0);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_Viewport, 0, 0, 0, 0, NULL, pViewport, sizeof(D3DVIEWPORT9));
+	}
+
 	HRESULT result = BaseDirect3DDevice9::SetViewport(pViewport);
 
 	if (SUCCEEDED(result)) {
@@ -1267,22 +1508,113 @@ HRESULT WINAPI D3DProxyDevice::SetViewport(CONST D3DVIEWPORT9* pViewport)
 		else {
 			m_bActiveViewportIsDefault = isViewportDefaultForMainRT(pViewport);
 			m_LastViewportSet = *pViewport;
+
+			if (m_bSideBySidePass)
+				applySideBySideViewport(m_currentRenderingSide);
 		}
 	}
 
 	return result;
 }
 
+/**
+* Provides the viewport set by the game, the actual viewport is moved in a side-by-side pass.
+***/
+HRESULT WINAPI D3DProxyDevice::GetViewport(D3DVIEWPORT9* pViewport)
+{
+	if (!m_bSideBySidePass)
+		return BaseDirect3DDevice9::GetViewport(pViewport);
+
+	if (!pViewport)
+		return D3DERR_INVALIDCALL;
+
+	if (m_bActiveViewportIsDefault) {
+		D3DVIEWPORT9 fullSurface = {0, 0, m_sideBySideWidth, m_sideBySideHeight, 0.0f, 1.0f};
+		*pViewport = fullSurface;
+	}
+	else
+		*pViewport = m_LastViewportSet;
+
+	return D3D_OK;
+}
+
+/**
+* Sets material. Not recorded, executes pending (deferred) commands first.
+***/
+HRESULT WINAPI D3DProxyDevice::SetMaterial(CONST D3DMATERIAL9* pMaterial)
+{
+	FlushPendingCommands();
+
+	return BaseDirect3DDevice9::SetMaterial(pMaterial);
+}
+
+/**
+* Sets light. Not recorded, executes pending (deferred) commands first.
+***/
+HRESULT WINAPI D3DProxyDevice::SetLight(DWORD Index,CONST D3DLIGHT9* pLight)
+{
+	FlushPendingCommands();
+
+	return BaseDirect3DDevice9::SetLight(Index, pLight);
+}
+
+/**
+* Enables light. Not recorded, executes pending (deferred) commands first.
+***/
+HRESULT WINAPI D3DProxyDevice::LightEnable(DWORD Index,BOOL Enable)
+{
+	FlushPendingCommands();
+
+	return BaseDirect3DDevice9::LightEnable(Index, Enable);
+}
+
+/**
+* Sets clip plane. Not recorded, executes pending (deferred) commands first.
+***/
+HRESULT WINAPI D3DProxyDevice::SetClipPlane(DWORD Index,CONST float* pPlane)
+{
+	FlushPendingCommands();
+
+	return BaseDirect3DDevice9::SetClipPlane(Index, pPlane);
+}
+
+/**
+* Sets render state, records it in deferred mode.
+* @see FlushPendingCommands()
+***/
+HRESULT WINAPI D3DProxyDevice::SetRenderState(D3DRENDERSTATETYPE State,DWORD Value)
+{
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetRenderState, State, Value);
+
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_RenderState, State);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_RenderState, State, Value);
+	}
+
+	return BaseDirect3DDevice9::SetRenderState(State, Value);
+}
+
 /**
 * Creates proxy state block.
 * Also, selects capture type option according to state block type.
+* Float registers not yet uploaded (not read by the active shaders) are applied first, so the actual
+* state block captures them. In a side-by-side pass the actual state block captures the game states.
 * @param ppSB [in, out] The proxy (or wrapped) state block returned.
 * @see D3DProxyStateBlock
+* @see prepareActualStateBlock()
 ***/
 HRESULT WINAPI D3DProxyDevice::CreateStateBlock(D3DSTATEBLOCKTYPE Type,IDirect3DStateBlock9** ppSB)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_CreateStateBlock, Type);
+
+	m_spManagedShaderRegisters->ApplyAllDeferred(m_currentRenderingSide);
+
 	IDirect3DStateBlock9* pActualStateBlock = NULL;
+	prepareActualStateBlock();
 	HRESULT creationResult = BaseDirect3DDevice9::CreateStateBlock(Type, &pActualStateBlock);
+	finishActualStateBlock();
 
 	if (SUCCEEDED(creationResult)) {
 
@@ -1315,6 +1647,7 @@ HRESULT WINAPI D3DProxyDevice::CreateStateBlock(D3DSTATEBLOCKTYPE Type,IDirect3D
 		}
 
 		*ppSB = new D3D9ProxyStateBlock(pActualStateBlock, this, capType, m_currentRenderingSide == vireio::Left);
+		m_counters.Frame().stateBlockCreations++;
 	}
 
 	return creationResult;
@@ -1322,10 +1655,18 @@ HRESULT WINAPI D3DProxyDevice::CreateStateBlock(D3DSTATEBLOCKTYPE Type,IDirect3D
 
 /**
 * Creates and stores proxy state block.
+* Executes pending (deferred) commands first, states set until EndStateBlock() are not recorded.
+* A side-by-side pass is left, the recorded states have to be the ones of the game.
 * @see D3DProxyStateBlock
 ***/
 HRESULT WINAPI D3DProxyDevice::BeginStateBlock()
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_BeginStateBlock);
+
+	FlushPendingCommands();
+	endSideBySidePass();
+
 	HRESULT result;
 	if (SUCCEEDED(result = BaseDirect3DDevice9::BeginStateBlock())) {
 		m_bInBeginEndStateBlock = true;
@@ -1337,17 +1678,22 @@ HRESULT WINAPI D3DProxyDevice::BeginStateBlock()
 
 /**
 * Calls both super method and method from stored proxy state block.
+* A side-by-side pass left by BeginStateBlock() is resumed.
 * @param [in, out] The returned proxy (or wrapped) state block.
 * @see D3D9ProxyStateBlock::EndStateBlock()
 ***/
 HRESULT WINAPI D3DProxyDevice::EndStateBlock(IDirect3DStateBlock9** ppSB)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_EndStateBlock);
+
 	IDirect3DStateBlock9* pActualStateBlock = NULL;
 	HRESULT creationResult = BaseDirect3DDevice9::EndStateBlock(&pActualStateBlock);
 
 	if (SUCCEEDED(creationResult)) {
 		m_pCapturingStateTo->EndStateBlock(pActualStateBlock);
 		*ppSB = m_pCapturingStateTo;
+		m_counters.Frame().stateBlockCreations++;
 	}
 	else {
 		m_pCapturingStateTo->Release();
@@ -1356,19 +1702,32 @@ HRESULT WINAPI D3DProxyDevice::EndStateBlock(IDirect3DStateBlock9** ppSB)
 	m_pCapturingStateTo = NULL;
 	m_bInBeginEndStateBlock = false;
 
+	updateSideBySidePass();
+
 	return creationResult;
 }
 
+/**
+* Sets clip status. Not recorded, executes pending (deferred) commands first.
+***/
+HRESULT WINAPI D3DProxyDevice::SetClipStatus(CONST D3DCLIPSTATUS9* pClipStatus)
+{
+	FlushPendingCommands();
+
+	return BaseDirect3DDevice9::SetClipStatus(pClipStatus);
+}
+
 /**
 * Provides texture from stored active (mono) texture stages.
 * @see D3D9ProxyTexture
 ***/
 HRESULT WINAPI D3DProxyDevice::GetTexture(DWORD Stage,IDirect3DBaseTexture9** ppTexture)
 {
-	if (m_activeTextureStages.count(Stage) != 1)
+	int samplerIndex = vireio::SamplerIndex(Stage);
+	if (samplerIndex < 0)
 		return D3DERR_INVALIDCALL;
 	else {
-		*ppTexture = m_activeTextureStages[Stage];
+		*ppTexture = m_activeTextureStages[samplerIndex];
 		if ((*ppTexture))
 			(*ppTexture)->AddRef();
 		return D3D_OK;
@@ -1383,6 +1742,14 @@ HRESULT WINAPI D3DProxyDevice::GetTexture(DWORD Stage,IDirect3DBaseTexture9** pp
 ***/
 HRESULT WINAPI D3DProxyDevice::SetTexture(DWORD Stage,IDirect3DBaseTexture9* pTexture)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetTexture, Stage, m_callTrace.ObjectId(pTexture));
+
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_Texture, Stage);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_Texture, Stage, 0, 0, 0, pTexture);
+	}
+
 	HRESULT result;
 	if (pTexture) {
 
@@ -1411,21 +1778,9 @@ HRESULT WINAPI D3DProxyDevice::SetTexture(DWORD Stage,IDirect3DBaseTexture9* pTe
 		}
 		else {
 
-			// remove existing texture that was active at Stage if there is one
-			if (m_activeTextureStages.count(Stage) == 1) { 
-
-				IDirect3DBaseTexture9* pOldTexture = m_activeTextureStages.at(Stage);
-				if (pOldTexture)
-					pOldTexture->Release();
-
-				m_activeTextureStages.erase(Stage);
-			}
-
-			// insert new texture (can be a NULL pointer, this is important for StateBlock tracking)
-			if(m_activeTextureStages.insert(std::pair<DWORD, IDirect3DBaseTexture9*>(Stage, pTexture)).second) {
-				//success
-				if (pTexture)
-					pTexture->AddRef();
+			int samplerIndex = vireio::SamplerIndex(Stage);
+			if (samplerIndex >= 0) {
+				storeActiveTexture(samplerIndex, pTexture);
 			}
 			else {
 				OutputDebugString(__FUNCTION__);
@@ -1433,8 +1788,6 @@ HRESULT WINAPI D3DProxyDevice::SetTexture(DWORD Stage,IDirect3DBaseTexture9* pTe
 				OutputDebugString("Unable to store active Texture Stage.\n");
 				assert(false);
 
-				//If we get here the state of the texture tracking is fubared and an implosion is imminent.
-
 				result = D3DERR_INVALIDCALL;
 			}
 		}
@@ -1443,18 +1796,157 @@ HRESULT WINAPI D3DProxyDevice::SetTexture(DWORD Stage,IDirect3DBaseTexture9* pTe
 	return result;
 }
 
+/**
+* Sets texture stage state, records it in deferred mode.
+* @see FlushPendingCommands()
+***/
+HRESULT WINAPI D3DProxyDevice::SetTextureStageState(DWORD Stage,D3DTEXTURESTAGESTATETYPE Type,DWORD Value)
+{
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetTextureStageState, Stage, Type, Value);
+
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_TextureStageState, MAKELONG(Type, Stage));
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_TextureStageState, Stage, Type, Value);
+	}
+
+	return BaseDirect3DDevice9::SetTextureStageState(Stage, Type, Value);
+}
+
+/**
+* Sets sampler state, records it in deferred mode.
+* @see FlushPendingCommands()
+***/
+HRESULT WINAPI D3DProxyDevice::SetSamplerState(DWORD Sampler,D3DSAMPLERSTATETYPE Type,DWORD Value)
+{
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetSamplerState, Sampler, Type, Value);
+
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_SamplerState, MAKELONG(Type, Sampler));
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_SamplerState, Sampler, Type, Value);
+	}
+
+	return BaseDirect3DDevice9::SetSamplerState(Sampler, Type, Value);
+}
+
+/**
+* Sets palette entries. Not recorded, executes pending (deferred) commands first.
+***/
+HRESULT WINAPI D3DProxyDevice::SetPaletteEntries(UINT PaletteNumber,CONST PALETTEENTRY* pEntries)
+{
+	FlushPendingCommands();
+
+	return BaseDirect3DDevice9::SetPaletteEntries(PaletteNumber, pEntries);
+}
+
+/**
+* Sets current texture palette. Not recorded, executes pending (deferred) commands first.
+***/
+HRESULT WINAPI D3DProxyDevice::SetCurrentTexturePalette(UINT PaletteNumber)
+{
+	FlushPendingCommands();
+
+	return BaseDirect3DDevice9::SetCurrentTexturePalette(PaletteNumber);
+}
+
+/**
+* Sets scissor rectangle, records it in deferred mode.
+* In instanced stereo mode the rectangle is stored, in a side-by-side pass it is moved to the half of
+* the current side.
+* @see FlushPendingCommands()
+* @see applySideBySideViewport()
+***/
+HRESULT WINAPI D3DProxyDevice::SetScissorRect(CONST RECT* pRect)
+{
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetScissorRect, 0, 0, 0, 0, pRect, pRect ? sizeof(RECT) : 0);
+
+	if (isRecordingStereoCommands() && pRect) {
+		captureRestoreState(StereoCommandList::Cmd_Type_ScissorRect, 0);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_ScissorRect, 0, 0, 0, 0, NULL, pRect, sizeof(RECT));
+	}
+
+	HRESULT result = BaseDirect3DDevice9::SetScissorRect(pRect);
+
+	if (SUCCEEDED(result) && pRect && m_bInstancedStereo && !m_pCapturingStateTo) {
+		m_LastScissorRect = *pRect;
+
+		if (m_bSideBySidePass)
+			applySideBySideViewport(m_currentRenderingSide);
+	}
+
+	return result;
+}
+
+/**
+* Provides the scissor rectangle set by the game, the actual rectangle is moved in a side-by-side pass.
+***/
+HRESULT WINAPI D3DProxyDevice::GetScissorRect(RECT* pRect)
+{
+	if (!m_bSideBySidePass)
+		return BaseDirect3DDevice9::GetScissorRect(pRect);
+
+	if (!pRect)
+		return D3DERR_INVALIDCALL;
+
+	*pRect = m_LastScissorRect;
+	return D3D_OK;
+}
+
+/**
+* Sets software vertex processing. Not recorded, executes pending (deferred) commands first.
+***/
+HRESULT WINAPI D3DProxyDevice::SetSoftwareVertexProcessing(BOOL bSoftware)
+{
+	FlushPendingCommands();
+
+	return BaseDirect3DDevice9::SetSoftwareVertexProcessing(bSoftware);
+}
+
+/**
+* Sets N-patch mode. Not recorded, executes pending (deferred) commands first.
+***/
+HRESULT WINAPI D3DProxyDevice::SetNPatchMode(float nSegments)
+{
+	FlushPendingCommands();
+
+	return BaseDirect3DDevice9::SetNPatchMode(nSegments);
+}
+
 /**
 * Applies all dirty shader registers, draws both stereo sides if switchDrawingSide() agrees.
+* In deferred mode the draw is recorded for the other side instead, mono draws may be drawn for one side only.
+* In a side-by-side pass both sides are drawn by one instanced draw through sequential indices where possible.
 * @see switchDrawingSide()
+* @see FlushPendingCommands()
+* @see prepareStereoDraw()
+* @see drawInstancedStereo()
 ***/
 HRESULT WINAPI D3DProxyDevice::DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType,UINT StartVertex,UINT PrimitiveCount)
 {
-	m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_DrawPrimitive, PrimitiveType, StartVertex, PrimitiveCount);
+
+	m_counters.Frame().drawsIssued++;
 
 	HRESULT result;
-	if (SUCCEEDED(result = BaseDirect3DDevice9::DrawPrimitive(PrimitiveType, StartVertex, PrimitiveCount))) {
-		if (switchDrawingSide())
+	if (m_bSideBySidePass) {
+		if (drawInstancedStereo(PrimitiveType, (INT)StartVertex, 0, vireio::VertexCount(PrimitiveType, PrimitiveCount), 0, PrimitiveCount, true, &result))
+			return result;
+		m_counters.Frame().drawsPerSide++;
+	}
+
+	bool oneSide = prepareStereoDraw();
+	m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
+
+	if (SUCCEEDED(result = BaseDirect3DDevice9::DrawPrimitive(PrimitiveType, StartVertex, PrimitiveCount)) && !oneSide) {
+		if (isRecordingStereoCommands())
+			m_stereoCommands.Record(StereoCommandList::Cmd_Type_DrawPrimitive, PrimitiveType, StartVertex, PrimitiveCount);
+		else if (switchDrawingSide()) {
 			BaseDirect3DDevice9::DrawPrimitive(PrimitiveType, StartVertex, PrimitiveCount);
+			m_counters.Frame().drawsDoubled++;
+		}
 	}
 
 	return result;
@@ -1462,18 +1954,43 @@ HRESULT WINAPI D3DProxyDevice::DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType,UINT
 
 /**
 * Applies all dirty shader registers, draws both stereo sides if switchDrawingSide() agrees.
+* In deferred mode the draw is recorded for the other side instead, mono draws may be drawn for one side only.
+* In a side-by-side pass both sides are drawn by one instanced draw where possible.
 * @see switchDrawingSide()
+* @see FlushPendingCommands()
+* @see prepareStereoDraw()
+* @see drawInstancedStereo()
 ***/
 HRESULT WINAPI D3DProxyDevice::DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType,INT BaseVertexIndex,UINT MinVertexIndex,UINT NumVertices,UINT startIndex,UINT primCount)
 {
-	m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
+	if (isTracingCalls()) {
+		DWORD args[] = {PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, startIndex, primCount};
+		m_callTrace.RecordArgs(CallTrace::Call_DrawIndexedPrimitive, args, 6);
+	}
+
+	m_counters.Frame().drawsIssued++;
 
 	HRESULT result;
-	if (SUCCEEDED(result = BaseDirect3DDevice9::DrawIndexedPrimitive(PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, startIndex, primCount))) {
-		if (switchDrawingSide()) {
+	if (m_bSideBySidePass) {
+		if (drawInstancedStereo(PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, startIndex, primCount, false, &result))
+			return result;
+		m_counters.Frame().drawsPerSide++;
+	}
+
+	bool oneSide = prepareStereoDraw();
+	m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
+
+	if (SUCCEEDED(result = BaseDirect3DDevice9::DrawIndexedPrimitive(PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, startIndex, primCount)) && !oneSide) {
+		if (isRecordingStereoCommands()) {
+			StereoCommandList::Command* pCommand = m_stereoCommands.Record(StereoCommandList::Cmd_Type_DrawIndexedPrimitive, PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices);
+			pCommand->args[4] = startIndex;
+			pCommand->args[5] = primCount;
+		}
+		else if (switchDrawingSide()) {
 			HRESULT result2 = BaseDirect3DDevice9::DrawIndexedPrimitive(PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, startIndex, primCount);
 			if (result != result2)
 				OutputDebugString("moop\n");
+			m_counters.Frame().drawsDoubled++;
 		}
 	}
 
@@ -1482,16 +1999,38 @@ HRESULT WINAPI D3DProxyDevice::DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveTy
 
 /**
 * Applies all dirty shader registers, draws both stereo sides if switchDrawingSide() agrees.
+* In deferred mode the draw is recorded for the other side instead, mono draws may be drawn for one side only.
+* Never drawn instanced (user pointer draws can not be instanced), counted as per side draw in a side-by-side pass.
 * @see switchDrawingSide()
+* @see FlushPendingCommands()
+* @see prepareStereoDraw()
 ***/
 HRESULT WINAPI D3DProxyDevice::DrawPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType,UINT PrimitiveCount,CONST void* pVertexStreamZeroData,UINT VertexStreamZeroStride)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_DrawPrimitiveUP, PrimitiveType, PrimitiveCount, VertexStreamZeroStride, 0, pVertexStreamZeroData, 
+			vireio::VertexCount(PrimitiveType, PrimitiveCount) * VertexStreamZeroStride);
+
+	m_counters.Frame().drawsIssued++;
+	if (m_bSideBySidePass)
+		m_counters.Frame().drawsPerSide++;
+	bool oneSide = prepareStereoDraw();
 	m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
 
+	// the actual draw resets stream zero, save it before
+	bool recording = isRecordingStereoCommands();
+	if (recording)
+		captureRestoreState(StereoCommandList::Cmd_Type_StreamSource, 0);
+
 	HRESULT result;
-	if (SUCCEEDED(result = BaseDirect3DDevice9::DrawPrimitiveUP(PrimitiveType, PrimitiveCount, pVertexStreamZeroData, VertexStreamZeroStride))) {
-		if (switchDrawingSide())
+	if (SUCCEEDED(result = BaseDirect3DDevice9::DrawPrimitiveUP(PrimitiveType, PrimitiveCount, pVertexStreamZeroData, VertexStreamZeroStride)) && !oneSide) {
+		if (recording)
+			m_stereoCommands.Record(StereoCommandList::Cmd_Type_DrawPrimitiveUP, PrimitiveType, PrimitiveCount, VertexStreamZeroStride, 0, NULL, 
+				pVertexStreamZeroData, vireio::VertexCount(PrimitiveType, PrimitiveCount) * VertexStreamZeroStride);
+		else if (switchDrawingSide()) {
 			BaseDirect3DDevice9::DrawPrimitiveUP(PrimitiveType, PrimitiveCount, pVertexStreamZeroData, VertexStreamZeroStride);
+			m_counters.Frame().drawsDoubled++;
+		}
 	}
 
 	return result;
@@ -1499,16 +2038,49 @@ HRESULT WINAPI D3DProxyDevice::DrawPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType,UI
 
 /**
 * Applies all dirty shader registers, draws both stereo sides if switchDrawingSide() agrees.
+* In deferred mode the draw is recorded for the other side instead, mono draws may be drawn for one side only.
+* Never drawn instanced (user pointer draws can not be instanced), counted as per side draw in a side-by-side pass.
 * @see switchDrawingSide()
+* @see FlushPendingCommands()
+* @see prepareStereoDraw()
 ***/
 HRESULT WINAPI D3DProxyDevice::DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType,UINT MinVertexIndex,UINT NumVertices,UINT PrimitiveCount,CONST void* pIndexData,D3DFORMAT IndexDataFormat,CONST void* pVertexStreamZeroData,UINT VertexStreamZeroStride)
 {
+	if (isTracingCalls()) {
+		DWORD args[] = {PrimitiveType, MinVertexIndex, NumVertices, PrimitiveCount, IndexDataFormat, VertexStreamZeroStride};
+		UINT indexSize = (IndexDataFormat == D3DFMT_INDEX16) ? sizeof(WORD) : sizeof(DWORD);
+		m_callTrace.RecordArgs(CallTrace::Call_DrawIndexedPrimitiveUP, args, 6, pVertexStreamZeroData, (MinVertexIndex + NumVertices) * VertexStreamZeroStride);
+		m_callTrace.AppendData(pIndexData, vireio::VertexCount(PrimitiveType, PrimitiveCount) * indexSize);
+	}
+
+	m_counters.Frame().drawsIssued++;
+	if (m_bSideBySidePass)
+		m_counters.Frame().drawsPerSide++;
+	bool oneSide = prepareStereoDraw();
 	m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
 
+	// the actual draw resets stream zero and the indices, save them before
+	bool recording = isRecordingStereoCommands();
+	if (recording) {
+		captureRestoreState(StereoCommandList::Cmd_Type_StreamSource, 0);
+		captureRestoreState(StereoCommandList::Cmd_Type_Indices, 0);
+	}
+
 	HRESULT result;
-	if (SUCCEEDED(result = BaseDirect3DDevice9::DrawIndexedPrimitiveUP(PrimitiveType, MinVertexIndex, NumVertices, PrimitiveCount, pIndexData, IndexDataFormat, pVertexStreamZeroData, VertexStreamZeroStride))) {
-		if (switchDrawingSide())
+	if (SUCCEEDED(result = BaseDirect3DDevice9::DrawIndexedPrimitiveUP(PrimitiveType, MinVertexIndex, NumVertices, PrimitiveCount, pIndexData, IndexDataFormat, pVertexStreamZeroData, VertexStreamZeroStride)) && !oneSide) {
+		if (recording) {
+			// vertices first, indices appended
+			UINT indexSize = (IndexDataFormat == D3DFMT_INDEX16) ? sizeof(WORD) : sizeof(DWORD);
+			StereoCommandList::Command* pCommand = m_stereoCommands.Record(StereoCommandList::Cmd_Type_DrawIndexedPrimitiveUP, PrimitiveType, MinVertexIndex, NumVertices, PrimitiveCount, NULL, 
+				pVertexStreamZeroData, (MinVertexIndex + NumVertices) * VertexStreamZeroStride);
+			pCommand->args[4] = IndexDataFormat;
+			pCommand->args[5] = VertexStreamZeroStride;
+			m_stereoCommands.AppendData(pCommand, pIndexData, vireio::VertexCount(PrimitiveType, PrimitiveCount) * indexSize);
+		}
+		else if (switchDrawingSide()) {
 			BaseDirect3DDevice9::DrawIndexedPrimitiveUP(PrimitiveType, MinVertexIndex, NumVertices, PrimitiveCount, pIndexData, IndexDataFormat, pVertexStreamZeroData, VertexStreamZeroStride);
+			m_counters.Frame().drawsDoubled++;
+		}
 	}
 
 	return result;
@@ -1516,12 +2088,16 @@ HRESULT WINAPI D3DProxyDevice::DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE Primitive
 
 /**
 * Applies all dirty shader registers, processes vertices.
+* Executes pending (deferred) commands and rebinds the game shaders after an instanced stereo draw first.
 ***/
 HRESULT WINAPI D3DProxyDevice::ProcessVertices(UINT SrcStartIndex,UINT DestIndex,UINT VertexCount,IDirect3DVertexBuffer9* pDestBuffer,IDirect3DVertexDeclaration9* pVertexDecl,DWORD Flags)
 {
 	if (!pDestBuffer)
 		return D3DERR_INVALIDCALL;
 
+	FlushPendingCommands();
+	restoreInstancedStereoState();
+
 	m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
 
 	BaseDirect3DVertexBuffer9* pCastDestBuffer = static_cast<BaseDirect3DVertexBuffer9*>(pDestBuffer);
@@ -1540,7 +2116,7 @@ HRESULT WINAPI D3DProxyDevice::ProcessVertices(UINT SrcStartIndex,UINT DestIndex
 }
 
 /**
-* Creates base vertex declaration (BaseDirect3DVertexDeclaration9).
+* Creates proxy vertex declaration (D3D9ProxyVertexDeclaration).
 ***/
 HRESULT WINAPI D3DProxyDevice::CreateVertexDeclaration(CONST D3DVERTEXELEMENT9* pVertexElements,IDirect3DVertexDeclaration9** ppDecl)
 {
@@ -1548,7 +2124,10 @@ HRESULT WINAPI D3DProxyDevice::CreateVertexDeclaration(CONST D3DVERTEXELEMENT9*
 	HRESULT creationResult = BaseDirect3DDevice9::CreateVertexDeclaration(pVertexElements, &pActualVertexDeclaration );
 
 	if (SUCCEEDED(creationResult))
-		*ppDecl = new BaseDirect3DVertexDeclaration9(pActualVertexDeclaration, this);
+		*ppDecl = new D3D9ProxyVertexDeclaration(pActualVertexDeclaration, this, getActual());
+
+	if (SUCCEEDED(creationResult) && m_callTrace.IsCapturing())
+		m_callTrace.ForgetObject(*ppDecl);
 
 	return creationResult;
 }
@@ -1560,6 +2139,15 @@ HRESULT WINAPI D3DProxyDevice::CreateVertexDeclaration(CONST D3DVERTEXELEMENT9*
 ***/
 HRESULT WINAPI D3DProxyDevice::SetVertexDeclaration(IDirect3DVertexDeclaration9* pDecl)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetVertexDeclaration, m_callTrace.ObjectId(pDecl));
+
+	// vertex declaration and FVF share one restore state, see captureRestoreState()
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_VertexDeclaration, 0);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_VertexDeclaration, 0, 0, 0, 0, pDecl);
+	}
+
 	BaseDirect3DVertexDeclaration9* pWrappedVDeclarationData = static_cast<BaseDirect3DVertexDeclaration9*>(pDecl);
 
 	// Update actual Vertex Declaration
@@ -1605,6 +2193,24 @@ HRESULT WINAPI D3DProxyDevice::GetVertexDeclaration(IDirect3DVertexDeclaration9*
 	return D3D_OK;
 }
 
+/**
+* Sets FVF, records it in deferred mode.
+* @see FlushPendingCommands()
+***/
+HRESULT WINAPI D3DProxyDevice::SetFVF(DWORD FVF)
+{
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetFVF, FVF);
+
+	// vertex declaration and FVF share one restore state, see captureRestoreState()
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_VertexDeclaration, 0);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_FVF, FVF);
+	}
+
+	return BaseDirect3DDevice9::SetFVF(FVF);
+}
+
 /**
 * Creates proxy (wrapped) vertex shader.
 * @param ppShader [in, out] The created proxy vertex shader.
@@ -1612,13 +2218,21 @@ HRESULT WINAPI D3DProxyDevice::GetVertexDeclaration(IDirect3DVertexDeclaration9*
 ***/
 HRESULT WINAPI D3DProxyDevice::CreateVertexShader(CONST DWORD* pFunction,IDirect3DVertexShader9** ppShader)
 {
+	PROXY_PROFILE_SCOPE("CreateVertexShader");
+
 	IDirect3DVertexShader9* pActualVShader = NULL;
 	HRESULT creationResult = BaseDirect3DDevice9::CreateVertexShader(pFunction, &pActualVShader);
 
 	if (SUCCEEDED(creationResult)) {
-		*ppShader = new D3D9ProxyVertexShader(pActualVShader, this, m_pGameHandler->GetShaderModificationRepository());
+		D3D9ProxyVertexShader* pShader = new D3D9ProxyVertexShader(pActualVShader, this, m_pGameHandler->GetShaderModificationRepository());
+		if (m_bInstancedStereo)
+			pShader->CreateInstancedStereoShader(m_maxVertexShaderConst);
+		*ppShader = pShader;
 	}
 
+	if (SUCCEEDED(creationResult) && m_callTrace.IsCapturing())
+		m_callTrace.ForgetObject(*ppShader);
+
 	return creationResult;
 }
 
@@ -1628,6 +2242,14 @@ HRESULT WINAPI D3DProxyDevice::CreateVertexShader(CONST DWORD* pFunction,IDirect
 ***/
 HRESULT WINAPI D3DProxyDevice::SetVertexShader(IDirect3DVertexShader9* pShader)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetVertexShader, m_callTrace.ObjectId(pShader));
+
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_VertexShader, 0);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_VertexShader, 0, 0, 0, 0, pShader);
+	}
+
 	D3D9ProxyVertexShader* pWrappedVShaderData = static_cast<D3D9ProxyVertexShader*>(pShader);
 
 	// Update actual Vertex shader
@@ -1682,6 +2304,15 @@ HRESULT WINAPI D3DProxyDevice::GetVertexShader(IDirect3DVertexShader9** ppShader
 ***/
 HRESULT WINAPI D3DProxyDevice::SetVertexShaderConstantF(UINT StartRegister,CONST float* pConstantData,UINT Vector4fCount)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetVertexShaderConstantF, StartRegister, Vector4fCount, 0, 0, pConstantData, Vector4fCount * 4 * sizeof(float));
+
+	if (isRecordingStereoCommands()) {
+		for (UINT i = 0; i < Vector4fCount; i++)
+			captureRestoreState(StereoCommandList::Cmd_Type_VertexShaderConstantF, StartRegister + i);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_VertexShaderConstantF, StartRegister, Vector4fCount, 0, 0, NULL, pConstantData, Vector4fCount * 4 * sizeof(float));
+	}
+
 	HRESULT result = D3DERR_INVALIDCALL;
 
 	if (m_pCapturingStateTo) {
@@ -1705,57 +2336,102 @@ HRESULT WINAPI D3DProxyDevice::GetVertexShaderConstantF(UINT StartRegister,float
 }
 
 /**
-* Sets stream source and updates stored vertex buffers.
-* Also, it calls proxy state block to capture states.
-* @see D3D9ProxyStateBlock::SelectAndCaptureState()
+* Sets integer vertex shader constants in the managed shader registers (applied on the next draw).
+* Not recorded, executes pending (deferred) commands first.
+* @see ShaderRegisters::SetVertexShaderConstantI()
 ***/
-HRESULT WINAPI D3DProxyDevice::SetStreamSource(UINT StreamNumber, IDirect3DVertexBuffer9* pStreamData, UINT OffsetInBytes, UINT Stride)
-{	
-	BaseDirect3DVertexBuffer9* pCastStreamData = static_cast<BaseDirect3DVertexBuffer9*>(pStreamData);
-	HRESULT result;
-	if (pStreamData) {		
-		result = BaseDirect3DDevice9::SetStreamSource(StreamNumber, pCastStreamData->getActual(), OffsetInBytes, Stride);
-	}
-	else {
-		result = BaseDirect3DDevice9::SetStreamSource(StreamNumber, NULL, OffsetInBytes, Stride);
-	}
+HRESULT WINAPI D3DProxyDevice::SetVertexShaderConstantI(UINT StartRegister,CONST int* pConstantData,UINT Vector4iCount)
+{
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetVertexShaderConstantI, StartRegister, Vector4iCount, 0, 0, pConstantData, Vector4iCount * 4 * sizeof(int));
 
+	FlushPendingCommands();
 
-	// Update m_activeVertexBuffers if new vertex buffer was successfully set
-	if (SUCCEEDED(result)) {
+	if (m_pCapturingStateTo)
+		return m_pCapturingStateTo->SelectAndCaptureStateVSConstI(StartRegister, pConstantData, Vector4iCount);
+
+	return m_spManagedShaderRegisters->SetVertexShaderConstantI(StartRegister, pConstantData, Vector4iCount);
+}
+
+/**
+* Provides integer constant registers from managed shader register class.
+* @see ShaderRegisters::GetVertexShaderConstantI()
+***/
+HRESULT WINAPI D3DProxyDevice::GetVertexShaderConstantI(UINT StartRegister,int* pConstantData,UINT Vector4iCount)
+{
+	return m_spManagedShaderRegisters->GetVertexShaderConstantI(StartRegister, pConstantData, Vector4iCount);
+}
+
+/**
+* Sets boolean vertex shader constants in the managed shader registers (applied on the next draw).
+* Not recorded, executes pending (deferred) commands first.
+* @see ShaderRegisters::SetVertexShaderConstantB()
+***/
+HRESULT WINAPI D3DProxyDevice::SetVertexShaderConstantB(UINT StartRegister,CONST BOOL* pConstantData,UINT  BoolCount)
+{
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetVertexShaderConstantB, StartRegister, BoolCount, 0, 0, pConstantData, BoolCount * sizeof(BOOL));
+
+	FlushPendingCommands();
+
+	if (m_pCapturingStateTo)
+		return m_pCapturingStateTo->SelectAndCaptureStateVSConstB(StartRegister, pConstantData, BoolCount);
+
+	return m_spManagedShaderRegisters->SetVertexShaderConstantB(StartRegister, pConstantData, BoolCount);
+}
+
+/**
+* Provides boolean constant registers from managed shader register class.
+* @see ShaderRegisters::GetVertexShaderConstantB()
+***/
+HRESULT WINAPI D3DProxyDevice::GetVertexShaderConstantB(UINT StartRegister,BOOL* pConstantData,UINT BoolCount)
+{
+	return m_spManagedShaderRegisters->GetVertexShaderConstantB(StartRegister, pConstantData, BoolCount);
+}
+
+/**
+* Sets stream source and updates stored vertex buffers.
+* Also, it calls proxy state block to capture states.
+* @see D3D9ProxyStateBlock::SelectAndCaptureState()
+***/
+HRESULT WINAPI D3DProxyDevice::SetStreamSource(UINT StreamNumber, IDirect3DVertexBuffer9* pStreamData, UINT OffsetInBytes, UINT Stride)
+{	
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetStreamSource, StreamNumber, m_callTrace.ObjectId(pStreamData), OffsetInBytes, Stride);
+
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_StreamSource, StreamNumber);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_StreamSource, StreamNumber, OffsetInBytes, Stride, 0, pStreamData);
+	}
+
+	BaseDirect3DVertexBuffer9* pCastStreamData = static_cast<BaseDirect3DVertexBuffer9*>(pStreamData);
+	HRESULT result;
+	if (pStreamData) {		
+		result = BaseDirect3DDevice9::SetStreamSource(StreamNumber, pCastStreamData->getActual(), OffsetInBytes, Stride);
+	}
+	else {
+		result = BaseDirect3DDevice9::SetStreamSource(StreamNumber, NULL, OffsetInBytes, Stride);
+	}
+
+
+	// Update m_activeVertexBuffers if new vertex buffer was successfully set
+	if (SUCCEEDED(result)) {
 
 		// If in a Begin-End StateBlock pair update the block state rather than the current proxy device state
 		if (m_pCapturingStateTo) {
 			m_pCapturingStateTo->SelectAndCaptureState(StreamNumber, pCastStreamData);
 		}
 		else {
-			// remove existing vertex buffer that was active at StreamNumber if there is one
-			if (m_activeVertexBuffers.count(StreamNumber) == 1) { 
-
-				IDirect3DVertexBuffer9* pOldBuffer = m_activeVertexBuffers.at(StreamNumber);
-				if (pOldBuffer == pStreamData)
-					return result;
 
-				if (pOldBuffer)
-					pOldBuffer->Release();
-
-				m_activeVertexBuffers.erase(StreamNumber);
-			}
-
-			// insert new vertex buffer
-			if(m_activeVertexBuffers.insert(std::pair<UINT, BaseDirect3DVertexBuffer9*>(StreamNumber, pCastStreamData)).second) {
-				//success
-				if (pStreamData)
-					pStreamData->AddRef();
+			if (StreamNumber < STREAM_COUNT) {
+				storeActiveVertexBuffer(StreamNumber, pCastStreamData);
 			}
 			else {
 				OutputDebugString(__FUNCTION__);
 				OutputDebugString("\n");
-				OutputDebugString("Unable to store active Texture Stage.\n");
+				OutputDebugString("Unable to store active vertex buffer.\n");
 				assert(false);
 
-				//If we get here the state of the texture tracking is fubared and an implosion is imminent.
-
 				result = D3DERR_INVALIDCALL;
 			}
 		}
@@ -1774,7 +2450,7 @@ HRESULT WINAPI D3DProxyDevice::GetStreamSource(UINT StreamNumber, IDirect3DVerte
 	// This whole methods implementation is highly questionable. Not sure exactly how GetStreamSource works
 	HRESULT result = D3DERR_INVALIDCALL;
 
-	if (m_activeVertexBuffers.count(StreamNumber) == 1) {
+	if (StreamNumber < STREAM_COUNT) {
 
 		//IDirect3DVertexBuffer9* pCurrentActual = m_activeVertexBuffers[StreamNumber]->getActual();
 
@@ -1790,12 +2466,38 @@ HRESULT WINAPI D3DProxyDevice::GetStreamSource(UINT StreamNumber, IDirect3DVerte
 	return result;
 }
 
+/**
+* Sets stream source frequency, records it in deferred mode.
+* Instanced draws stay in the list this way, both eyes of an instanced batch are replayed once per render target.
+* @see FlushPendingCommands()
+***/
+HRESULT WINAPI D3DProxyDevice::SetStreamSourceFreq(UINT StreamNumber,UINT Setting)
+{
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetStreamSourceFreq, StreamNumber, Setting);
+
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_StreamSourceFreq, StreamNumber);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_StreamSourceFreq, StreamNumber, Setting);
+	}
+
+	return BaseDirect3DDevice9::SetStreamSourceFreq(StreamNumber, Setting);
+}
+
 /**
 * Sets indices and calls proxy state block to capture states.
 * @see D3D9ProxyStateBlock::SelectAndCaptureState()
 ***/
 HRESULT WINAPI D3DProxyDevice::SetIndices(IDirect3DIndexBuffer9* pIndexData)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetIndices, m_callTrace.ObjectId(pIndexData));
+
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_Indices, 0);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_Indices, 0, 0, 0, 0, pIndexData);
+	}
+
 	BaseDirect3DIndexBuffer9* pWrappedNewIndexData = static_cast<BaseDirect3DIndexBuffer9*>(pIndexData);
 
 	// Update actual index buffer
@@ -1846,13 +2548,21 @@ HRESULT WINAPI D3DProxyDevice::GetIndices(IDirect3DIndexBuffer9** ppIndexData)
 ***/
 HRESULT WINAPI D3DProxyDevice::CreatePixelShader(CONST DWORD* pFunction,IDirect3DPixelShader9** ppShader)
 {
+	PROXY_PROFILE_SCOPE("CreatePixelShader");
+
 	IDirect3DPixelShader9* pActualPShader = NULL;
 	HRESULT creationResult = BaseDirect3DDevice9::CreatePixelShader(pFunction, &pActualPShader);
 
 	if (SUCCEEDED(creationResult)) {
-		*ppShader = new D3D9ProxyPixelShader(pActualPShader, this, m_pGameHandler->GetShaderModificationRepository());
+		D3D9ProxyPixelShader* pShader = new D3D9ProxyPixelShader(pActualPShader, this, m_pGameHandler->GetShaderModificationRepository());
+		if (m_bInstancedStereo)
+			pShader->CreateInstancedStereoShader();
+		*ppShader = pShader;
 	}
 
+	if (SUCCEEDED(creationResult) && m_callTrace.IsCapturing())
+		m_callTrace.ForgetObject(*ppShader);
+
 	return creationResult;
 }
 
@@ -1862,6 +2572,14 @@ HRESULT WINAPI D3DProxyDevice::CreatePixelShader(CONST DWORD* pFunction,IDirect3
 ***/
 HRESULT WINAPI D3DProxyDevice::SetPixelShader(IDirect3DPixelShader9* pShader)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetPixelShader, m_callTrace.ObjectId(pShader));
+
+	if (isRecordingStereoCommands()) {
+		captureRestoreState(StereoCommandList::Cmd_Type_PixelShader, 0);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_PixelShader, 0, 0, 0, 0, pShader);
+	}
+
 	D3D9ProxyPixelShader* pWrappedPShaderData = static_cast<D3D9ProxyPixelShader*>(pShader);
 
 	// Update actual pixel shader
@@ -1916,6 +2634,15 @@ HRESULT WINAPI D3DProxyDevice::GetPixelShader(IDirect3DPixelShader9** ppShader)
 ***/
 HRESULT WINAPI D3DProxyDevice::SetPixelShaderConstantF(UINT StartRegister,CONST float* pConstantData,UINT Vector4fCount)
 {
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetPixelShaderConstantF, StartRegister, Vector4fCount, 0, 0, pConstantData, Vector4fCount * 4 * sizeof(float));
+
+	if (isRecordingStereoCommands()) {
+		for (UINT i = 0; i < Vector4fCount; i++)
+			captureRestoreState(StereoCommandList::Cmd_Type_PixelShaderConstantF, StartRegister + i);
+		m_stereoCommands.Record(StereoCommandList::Cmd_Type_PixelShaderConstantF, StartRegister, Vector4fCount, 0, 0, NULL, pConstantData, Vector4fCount * 4 * sizeof(float));
+	}
+
 	HRESULT result = D3DERR_INVALIDCALL;
 
 	if (m_pCapturingStateTo) {
@@ -1938,6 +2665,60 @@ HRESULT WINAPI D3DProxyDevice::GetPixelShaderConstantF(UINT StartRegister,float*
 	return m_spManagedShaderRegisters->GetPixelShaderConstantF(StartRegister, pData, Vector4fCount);
 }
 
+/**
+* Sets integer pixel shader constants in the managed shader registers (applied on the next draw).
+* Not recorded, executes pending (deferred) commands first.
+* @see ShaderRegisters::SetPixelShaderConstantI()
+***/
+HRESULT WINAPI D3DProxyDevice::SetPixelShaderConstantI(UINT StartRegister,CONST int* pConstantData,UINT Vector4iCount)
+{
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetPixelShaderConstantI, StartRegister, Vector4iCount, 0, 0, pConstantData, Vector4iCount * 4 * sizeof(int));
+
+	FlushPendingCommands();
+
+	if (m_pCapturingStateTo)
+		return m_pCapturingStateTo->SelectAndCaptureStatePSConstI(StartRegister, pConstantData, Vector4iCount);
+
+	return m_spManagedShaderRegisters->SetPixelShaderConstantI(StartRegister, pConstantData, Vector4iCount);
+}
+
+/**
+* Provides integer constant registers from managed shader register class.
+* @see ShaderRegisters::GetPixelShaderConstantI()
+***/
+HRESULT WINAPI D3DProxyDevice::GetPixelShaderConstantI(UINT StartRegister,int* pConstantData,UINT Vector4iCount)
+{
+	return m_spManagedShaderRegisters->GetPixelShaderConstantI(StartRegister, pConstantData, Vector4iCount);
+}
+
+/**
+* Sets boolean pixel shader constants in the managed shader registers (applied on the next draw).
+* Not recorded, executes pending (deferred) commands first.
+* @see ShaderRegisters::SetPixelShaderConstantB()
+***/
+HRESULT WINAPI D3DProxyDevice::SetPixelShaderConstantB(UINT StartRegister,CONST BOOL* pConstantData,UINT  BoolCount)
+{
+	if (isTracingCalls())
+		m_callTrace.Record(CallTrace::Call_SetPixelShaderConstantB, StartRegister, BoolCount, 0, 0, pConstantData, BoolCount * sizeof(BOOL));
+
+	FlushPendingCommands();
+
+	if (m_pCapturingStateTo)
+		return m_pCapturingStateTo->SelectAndCaptureStatePSConstB(StartRegister, pConstantData, BoolCount);
+
+	return m_spManagedShaderRegisters->SetPixelShaderConstantB(StartRegister, pConstantData, BoolCount);
+}
+
+/**
+* Provides boolean constant registers from managed shader register class.
+* @see ShaderRegisters::GetPixelShaderConstantB()
+***/
+HRESULT WINAPI D3DProxyDevice::GetPixelShaderConstantB(UINT StartRegister,BOOL* pConstantData,UINT BoolCount)
+{
+	return m_spManagedShaderRegisters->GetPixelShaderConstantB(StartRegister, pConstantData, BoolCount);
+}
+
 /**
 * Applies all dirty registers, draws both stereo sides if switchDrawingSide() agrees.
 * @see switchDrawingSide()
@@ -1972,6 +2753,16 @@ HRESULT WINAPI D3DProxyDevice::DrawTriPatch(UINT Handle,CONST float* pNumSegs,CO
 	return result;
 }
 
+/**
+* Deletes patch. Executes pending (deferred) commands first, they may draw the patch.
+***/
+HRESULT WINAPI D3DProxyDevice::DeletePatch(UINT Handle)
+{
+	FlushPendingCommands();
+
+	return BaseDirect3DDevice9::DeletePatch(Handle);
+}
+
 /**
 * Base CreateQuery functionality.
 ***/
@@ -1991,6 +2782,61 @@ HRESULT WINAPI D3DProxyDevice::CreateQuery(D3DQUERYTYPE Type,IDirect3DQuery9** p
 	return creationResult;
 }
 
+/**
+* Replays the commands recorded since the last flush for the other side.
+* First the restore commands bring the device back to the states from the beginning of the list, 
+* then the drawing side is switched once and all recorded commands are replayed. The device stays on
+* the other side, like it does after an immediate stereo draw (switchDrawingSide()). 
+*
+* Called before the render target changes, before anything reads or writes resources the recorded 
+* draws may use (locks, queries, copies), before states that are not recorded are set and at the end
+* of the scene. Does nothing if no command is pending or if called while replaying.
+* @see StereoCommandList
+***/
+void D3DProxyDevice::FlushPendingCommands()
+{
+	if (m_bReplayingStereoCommands || m_stereoCommands.IsEmpty())
+		return;
+
+	// nothing drawn, the current side already has the final states
+	if (m_stereoCommands.DrawCount() == 0) {
+		m_stereoCommands.Clear();
+		return;
+	}
+
+	m_bReplayingStereoCommands = true;
+	StereoCommandList::Statistics& statistics = m_stereoCommands.FrameStatistics();
+
+	// restore states on the recording side
+	const std::vector<StereoCommandList::Command>& restoreCommands = m_stereoCommands.RestoreCommands();
+	for (auto it = restoreCommands.begin(); it != restoreCommands.end(); ++it) {
+		replayStereoCommand(*it);
+		statistics.commandsRestored++;
+	}
+
+	// switch once, then replay (states only if switching fails, to end up with the final states)
+	bool switched = switchDrawingSide();
+	if (!switched)
+		OutputDebugString("FlushPendingCommands: Failed to switch drawing side, recorded draws dropped.\n");
+
+	const std::vector<StereoCommandList::Command>& commands = m_stereoCommands.Commands();
+	for (auto it = commands.begin(); it != commands.end(); ++it) {
+		if (!switched && StereoCommandList::IsDraw(it->type))
+			continue;
+
+		replayStereoCommand(*it);
+		statistics.commandsReplayed++;
+		if (StereoCommandList::IsDraw(it->type))
+			m_counters.Frame().drawsDoubled++;
+	}
+
+	if (switched)
+		statistics.listsReplayed++;
+
+	m_stereoCommands.Clear();
+	m_bReplayingStereoCommands = false;
+}
+
 /**
 * Creates proxy (wrapped) render target, if swapchain buffer returns StereoBackBuffer, otherwise D3D9ProxySurface.
 * Duplicates render target if game handler agrees.
@@ -2031,6 +2877,9 @@ HRESULT WINAPI D3DProxyDevice::CreateRenderTarget(UINT Width, UINT Height, D3DFO
 			*ppSurface = new StereoBackBuffer(pLeftRenderTarget, pRightRenderTarget, this);
 	}
 
+	if (SUCCEEDED(creationResult) && m_callTrace.IsCapturing())
+		m_callTrace.ForgetObject(*ppSurface);
+
 	return creationResult;
 }
 
@@ -2080,6 +2929,43 @@ void D3DProxyDevice::Init(ProxyHelper::ProxyConfig& cfg)
 	guiHotkeys[4] = config.guiHotkeys[4];
 	ChangeGUI3DDepthMode((GUI_3D_Depth_Modes)config.gui3DDepthMode);
 
+	// deferred right eye, restoring recorded states needs the Get methods of the actual device
+	m_bDeferredRightEye = config.deferredRightEye;
+	if (m_bDeferredRightEye) {
+		D3DDEVICE_CREATION_PARAMETERS creationParameters;
+		if (SUCCEEDED(BaseDirect3DDevice9::GetCreationParameters(&creationParameters)) && (creationParameters.BehaviorFlags & D3DCREATE_PUREDEVICE)) {
+			OutputDebugString("Deferred right eye not available for pure devices, drawing both eyes immediately.\n");
+			m_bDeferredRightEye = false;
+		}
+	}
+
+	// mono draw elision, off by default since classification relies on the shader rules being complete
+	m_bMonoDrawElision = config.monoDrawElision;
+
+	// instanced stereo, needs hardware instancing (shader model 3) and reads states back from the actual device
+	m_bInstancedStereo = config.instancedStereo;
+	if (m_bInstancedStereo) {
+		D3DCAPS9 capabilities;
+		D3DDEVICE_CREATION_PARAMETERS creationParameters;
+		BaseDirect3DDevice9::GetDeviceCaps(&capabilities);
+		if (m_bDeferredRightEye) {
+			OutputDebugString("Instanced stereo not available with deferred right eye, drawing both eyes separately.\n");
+			m_bInstancedStereo = false;
+		}
+		else if (D3DSHADER_VERSION_MAJOR(capabilities.VertexShaderVersion) < 3) {
+			OutputDebugString("Instanced stereo needs shader model 3 hardware, drawing both eyes separately.\n");
+			m_bInstancedStereo = false;
+		}
+		else if (SUCCEEDED(BaseDirect3DDevice9::GetCreationParameters(&creationParameters)) && 
+			(creationParameters.BehaviorFlags & (D3DCREATE_PUREDEVICE | D3DCREATE_SOFTWARE_VERTEXPROCESSING))) {
+			OutputDebugString("Instanced stereo not available for pure or software vertex processing devices, drawing both eyes separately.\n");
+			m_bInstancedStereo = false;
+		}
+	}
+
+	// clean registers bridged between dirty constant register runs
+	m_spManagedShaderRegisters->SetUploadGapThreshold((config.constantUploadGap > 0) ? (UINT)config.constantUploadGap : 0);
+
 	OnCreateOrRestore();
 }
 
@@ -2178,6 +3064,50 @@ void D3DProxyDevice::HandleControls()
 	if (hotkeyPressed)
 		menuVelocity.x+=10.0f;
 
+	// dump profiler trace of the last frames - <CTRL>+<F11>
+	if(KEY_DOWN(VK_F11) && KEY_DOWN(VK_CONTROL) && (menuVelocity == D3DXVECTOR2(0.0f, 0.0f)))
+	{
+		static int traceCount = 0;
+		++traceCount;
+
+		char fileName[32];
+		wsprintf(fileName, "%d_trace.json", traceCount);
+		if (ProxyProfiler::Dump(fileName, 120))
+		{
+			OutputDebugString("Profiler trace written to ");
+			OutputDebugString(fileName);
+			OutputDebugString("\n");
+		}
+
+		menuVelocity.x+=10.0f;
+	}
+
+	// start/stop call trace capture - <CTRL>+<F10>
+	if(KEY_DOWN(VK_F10) && KEY_DOWN(VK_CONTROL) && (menuVelocity == D3DXVECTOR2(0.0f, 0.0f)))
+	{
+		if (m_callTrace.IsCapturing())
+		{
+			m_callTrace.Stop();
+			OutputDebugString("Call trace stopped\n");
+		}
+		else
+		{
+			static int callTraceCount = 0;
+			++callTraceCount;
+
+			char fileName[32];
+			wsprintf(fileName, "%d_calls.vct", callTraceCount);
+			if (m_callTrace.Start(fileName))
+			{
+				OutputDebugString("Call trace started : ");
+				OutputDebugString(fileName);
+				OutputDebugString("\n");
+			}
+		}
+
+		menuVelocity.x+=10.0f;
+	}
+
 	// open BRASSA - <CTRL>+<T>
 	if(KEY_DOWN(0x54) && KEY_DOWN(VK_CONTROL) && (menuVelocity == D3DXVECTOR2(0.0f, 0.0f)))
 	{
@@ -2295,6 +3225,34 @@ void D3DProxyDevice::OnCreateOrRestore()
 
 	BaseDirect3DDevice9::GetViewport(&m_LastViewportSet);
 
+	// per instance (eye) data of instanced stereo draws
+	if (m_bInstancedStereo) {
+		BaseDirect3DDevice9::GetScissorRect(&m_LastScissorRect);
+
+		void* pData = NULL;
+		if (SUCCEEDED(BaseDirect3DDevice9::CreateVertexBuffer(8 * sizeof(float), D3DUSAGE_WRITEONLY, 0, D3DPOOL_DEFAULT, &m_pInstancedStereoBuffer, NULL)) &&
+			SUCCEEDED(m_pInstancedStereoBuffer->Lock(0, 0, &pData, 0))) {
+			StereoShaderPatcher::InstanceData(0, (float*)pData);
+			StereoShaderPatcher::InstanceData(1, (float*)pData + 4);
+			m_pInstancedStereoBuffer->Unlock();
+		}
+		else {
+			OutputDebugString("Instanced stereo: Failed to create the instance buffer, drawing both eyes separately.\n");
+			_SAFE_RELEASE(m_pInstancedStereoBuffer);
+		}
+
+		if (SUCCEEDED(BaseDirect3DDevice9::CreateIndexBuffer(SEQUENTIAL_INDEX_COUNT * sizeof(WORD), D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_DEFAULT, &m_pSequentialIndices, NULL)) &&
+			SUCCEEDED(m_pSequentialIndices->Lock(0, 0, &pData, 0))) {
+			for (UINT i = 0; i < SEQUENTIAL_INDEX_COUNT; i++)
+				((WORD*)pData)[i] = (WORD)i;
+			m_pSequentialIndices->Unlock();
+		}
+		else {
+			OutputDebugString("Instanced stereo: Failed to create the sequential indices, non indexed draws are drawn per side.\n");
+			_SAFE_RELEASE(m_pSequentialIndices);
+		}
+	}
+
 	// If there is an initial depth stencil
 	IDirect3DSurface9* pDepthStencil;
 	if (SUCCEEDED(BaseDirect3DDevice9::GetDepthStencilSurface(&pDepthStencil))) { 
@@ -2312,7 +3270,7 @@ void D3DProxyDevice::OnCreateOrRestore()
 
 	SetupHUD();
 
-	stereoView->Init(getActual());
+	stereoView->Init(getActual(), &m_counters.Frame());
 
 	m_spShaderViewAdjustment->UpdateProjectionMatrices((float)stereoView->viewport.Width/(float)stereoView->viewport.Height);
 	m_spShaderViewAdjustment->ComputeViewTransforms();
@@ -2328,6 +3286,7 @@ void D3DProxyDevice::OnCreateOrRestore()
 * @return True if change succeeded, false if it fails. The switch will fail if you attempt to setDrawingSide(Right)
 * when the current primary active render target (target 0  in m_activeRenderTargets) is not stereo.
 * Attempting to switch to a side when that side is already the active side will return true without making any changes.
+* In a side-by-side pass the side-by-side surfaces stay bound, the viewport selects the half of the side.
 ***/
 bool D3DProxyDevice::setDrawingSide(vireio::RenderPosition side)
 {
@@ -2336,73 +3295,88 @@ bool D3DProxyDevice::setDrawingSide(vireio::RenderPosition side)
 		return true;
 	}
 
+	PROXY_PROFILE_SCOPE("setDrawingSide");
+
 	// should never try and render for the right eye if there is no render target for the main render targets right side
 	if (!m_activeRenderTargets[0]->IsStereo() && (side == vireio::Right)) {
 		return false;
 	}
 
+	// commands recorded on the current side are replayed before the side changes (the replay ends on the new side)
+	if (!m_bReplayingStereoCommands && !m_stereoCommands.IsEmpty()) {
+		FlushPendingCommands();
+
+		if (side == m_currentRenderingSide)
+			return true;
+	}
+
 	// Everything hasn't changed yet but we set this first so we don't accidentally use the member instead of the local and break
 	// things, as I have already managed twice.
 	m_currentRenderingSide = side;
+	m_counters.Frame().eyeSwitches++;
 
-	// switch render targets to new side
-	bool renderTargetChanged = false;
 	HRESULT result;
-	D3D9ProxySurface* pCurrentRT;
-	for(std::vector<D3D9ProxySurface*>::size_type i = 0; i != m_activeRenderTargets.size(); i++) 
-	{
-		if ((pCurrentRT = m_activeRenderTargets[i]) != NULL) {
+	if (m_bSideBySidePass) {
+		// the side-by-side surfaces stay bound, the side is selected by the viewport
+		applySideBySideViewport(side);
+	}
+	else {
+		// switch render targets to new side
+		bool renderTargetChanged = false;
+		D3D9ProxySurface* pCurrentRT;
+		for(std::vector<D3D9ProxySurface*>::size_type i = 0; i != m_activeRenderTargets.size(); i++) 
+		{
+			if ((pCurrentRT = m_activeRenderTargets[i]) != NULL) {
 
-			if (side == vireio::Left) 
-				result = BaseDirect3DDevice9::SetRenderTarget(i, pCurrentRT->getActualLeft()); 
-			else 
-				result = BaseDirect3DDevice9::SetRenderTarget(i, pCurrentRT->getActualRight());
+				if (side == vireio::Left) 
+					result = BaseDirect3DDevice9::SetRenderTarget(i, pCurrentRT->getActualLeft()); 
+				else 
+					result = BaseDirect3DDevice9::SetRenderTarget(i, pCurrentRT->getActualRight());
 
-			if (result != D3D_OK) {
-				OutputDebugString("Error trying to set one of the Render Targets while switching between active eyes for drawing.\n");
-			}
-			else {
-				renderTargetChanged = true;
+				if (result != D3D_OK) {
+					OutputDebugString("Error trying to set one of the Render Targets while switching between active eyes for drawing.\n");
+				}
+				else {
+					renderTargetChanged = true;
+				}
 			}
 		}
-	}
 
-	// if a non-fullsurface viewport is active and a rendertarget changed we need to reapply the viewport
-	if (renderTargetChanged && !m_bActiveViewportIsDefault) {
-		BaseDirect3DDevice9::SetViewport(&m_LastViewportSet);
-	}
+		// if a non-fullsurface viewport is active and a rendertarget changed we need to reapply the viewport
+		if (renderTargetChanged && !m_bActiveViewportIsDefault) {
+			BaseDirect3DDevice9::SetViewport(&m_LastViewportSet);
+		}
 
-	// switch depth stencil to new side
-	if (m_pActiveStereoDepthStencil != NULL) { 
-		if (side == vireio::Left) 
-			result = BaseDirect3DDevice9::SetDepthStencilSurface(m_pActiveStereoDepthStencil->getActualLeft()); 
-		else 
-			result = BaseDirect3DDevice9::SetDepthStencilSurface(m_pActiveStereoDepthStencil->getActualRight());
+		// switch depth stencil to new side
+		if (m_pActiveStereoDepthStencil != NULL) { 
+			if (side == vireio::Left) 
+				result = BaseDirect3DDevice9::SetDepthStencilSurface(m_pActiveStereoDepthStencil->getActualLeft()); 
+			else 
+				result = BaseDirect3DDevice9::SetDepthStencilSurface(m_pActiveStereoDepthStencil->getActualRight());
+		}
 	}
 
-	// switch textures to new side
+	// switch textures to new side (stereo stages only, mono textures are always set initially and then won't need changing)
 	IDirect3DBaseTexture9* pActualLeftTexture = NULL;
 	IDirect3DBaseTexture9* pActualRightTexture = NULL;
 
-	for(auto it = m_activeTextureStages.begin(); it != m_activeTextureStages.end(); ++it )
+	DWORD stereoStages = m_stereoTextureStages;
+	for (int samplerIndex = 0; stereoStages != 0; ++samplerIndex, stereoStages >>= 1)
 	{
-		if (it->second) {
-			pActualLeftTexture = NULL;
-			pActualRightTexture = NULL;
-			vireio::UnWrapTexture(it->second, &pActualLeftTexture, &pActualRightTexture);
+		if ((stereoStages & 1) == 0)
+			continue;
 
-			// if stereo texture
-			if (pActualRightTexture != NULL) { 
-				if (side == vireio::Left) 
-					result = BaseDirect3DDevice9::SetTexture(it->first, pActualLeftTexture); 
-				else 
-					result = BaseDirect3DDevice9::SetTexture(it->first, pActualRightTexture);
-			}
-			// else the texture is mono and doesn't need changing. It will always be set initially and then won't need changing
+		vireio::UnWrapTexture(m_activeTextureStages[samplerIndex], &pActualLeftTexture, &pActualRightTexture);
 
-			if (result != D3D_OK)
-				OutputDebugString("Error trying to set one of the textures while switching between active eyes for drawing.\n");
-		}
+		if (side == vireio::Left) 
+			result = BaseDirect3DDevice9::SetTexture(vireio::SamplerFromIndex(samplerIndex), pActualLeftTexture); 
+		else 
+			result = BaseDirect3DDevice9::SetTexture(vireio::SamplerFromIndex(samplerIndex), pActualRightTexture);
+
+		if (result != D3D_OK)
+			OutputDebugString("Error trying to set one of the textures while switching between active eyes for drawing.\n");
+		else
+			m_counters.Frame().textureRebinds++;
 	}
 
 	// update view transform for new side 
@@ -2658,6 +3632,9 @@ void D3DProxyDevice::BRASSA()
 	case D3DProxyDevice::OVERALL_SETTINGS:
 		BRASSA_Settings();
 		break;
+	case D3DProxyDevice::PROXY_STATISTICS:
+		BRASSA_Statistics();
+		break;
 	}
 }
 
@@ -2670,7 +3647,7 @@ void D3DProxyDevice::BRASSA_MainMenu()
 	int height = stereoView->viewport.Height;
 	float menuTop = height*0.32f;
 	float menuEntryHeight = height*0.037f;
-	UINT menuEntryCount = 8;
+	UINT menuEntryCount = 9;
 	if ((config.game_type == 11) || (config.game_type == 12)) menuEntryCount++;
 
 	RECT rect1;
@@ -2749,8 +3726,14 @@ void D3DProxyDevice::BRASSA_MainMenu()
 			BRASSA_mode = BRASSA_Modes::OVERALL_SETTINGS;
 			menuVelocity.x+=10.0f;
 		}	
-		// back to game
+		// proxy statistics
 		if (entryID == 8)
+		{
+			BRASSA_mode = BRASSA_Modes::PROXY_STATISTICS;
+			menuVelocity.x+=10.0f;
+		}
+		// back to game
+		if (entryID == 9)
 		{
 			BRASSA_mode = BRASSA_Modes::INACTIVE;
 			ProxyHelper* helper = new ProxyHelper();
@@ -2846,6 +3829,8 @@ void D3DProxyDevice::BRASSA_MainMenu()
 		rect1.top += 40;
 		DrawTextShadowed(hudFont, hudMainMenu, "Overall Settings\n", -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
 		rect1.top += 40;
+		DrawTextShadowed(hudFont, hudMainMenu, "Proxy Statistics\n", -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
 		DrawTextShadowed(hudFont, hudMainMenu, "Back to Game\n", -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
 
 		// draw HUD quick setting rectangles
@@ -4099,55 +5084,217 @@ void D3DProxyDevice::BRASSA_Settings()
 }
 
 /**
-* Releases HUD font, shader registers, render targets, texture stages, vertex buffers, depth stencils, indices, shaders, declarations.
+* BRASSA Proxy Statistics.
+* Shows the proxy overhead counters of the last published frame.
+* @see ProxyCounters
 ***/
-void D3DProxyDevice::ReleaseEverything()
+void D3DProxyDevice::BRASSA_Statistics()
 {
-	// Fonts and any other D3DX interfaces should be released first.
-	// They frequently hold stateblocks which are holding further references to other resources.
-	if(hudFont) {
-		hudFont->Release();
-		hudFont = NULL;
-	}
-
+	int width = stereoView->viewport.Width;
+	int height = stereoView->viewport.Height;
+	float menuTop = height*0.875f; // the two entries below the 15 counter lines
+	float menuEntryHeight = height*0.037f;
+	UINT menuEntryCount = 2;
 
-	m_spManagedShaderRegisters->ReleaseResources();
+	RECT rect1;
+	rect1.left = 0;
+	rect1.right = 1920;
+	rect1.top = 0;
+	rect1.bottom = 1080;
 
-	if (m_pCapturingStateTo) {
-		m_pCapturingStateTo->Release();
-		m_pCapturingStateTo = NULL;
-	}
+	float fScaleX = ((float)stereoView->viewport.Width / (float)rect1.right);
+	float fScaleY = ((float)stereoView->viewport.Height / (float)rect1.bottom);
 
-	// one of these will still have a count of 1 until the backbuffer is released
-	for(std::vector<D3D9ProxySurface*>::size_type i = 0; i != m_activeRenderTargets.size(); i++) 
+	// handle border height
+	if (borderTopHeight<menuTop)
 	{
-		if (m_activeRenderTargets[i] != NULL) {
-			m_activeRenderTargets[i]->Release();
-			m_activeRenderTargets[i] = NULL;
-		}
-	} 
-
-
-	auto it = m_activeTextureStages.begin();
-	while (it != m_activeTextureStages.end()) {
-		if (it->second)
-			it->second->Release();
-
-		it = m_activeTextureStages.erase(it);
+		borderTopHeight = menuTop;
+		menuVelocity.y=0.0f;
 	}
-
-
-	auto itVB = m_activeVertexBuffers.begin();
-	while (itVB != m_activeVertexBuffers.end()) {
-		if (itVB->second)
-			itVB->second->Release();
-
-		itVB = m_activeVertexBuffers.erase(itVB);
+	if (borderTopHeight>(menuTop+(menuEntryHeight*(float)(menuEntryCount-1))))
+	{
+		borderTopHeight = menuTop+menuEntryHeight*(float)(menuEntryCount-1);
+		menuVelocity.y=0.0f;
 	}
 
+	// get menu entry id
+	float entry = (borderTopHeight-menuTop+(menuEntryHeight/3.0f))/menuEntryHeight;
+	UINT entryID = (UINT)entry;
+	if (entryID >= menuEntryCount)
+		OutputDebugString("Error in BRASSA menu programming !");
+
+	/**
+	* ESCAPE : Set BRASSA inactive and save the configuration.
+	***/
+	if (KEY_DOWN(VK_ESCAPE))
+	{
+		BRASSA_mode = BRASSA_Modes::INACTIVE;
+		ProxyHelper* helper = new ProxyHelper();
+		config.roll_multiplier = tracker->multiplierRoll;
+		config.yaw_multiplier = tracker->multiplierYaw;
+		config.pitch_multiplier = tracker->multiplierPitch;
+		config.swap_eyes = stereoView->swapEyes;
+		m_spShaderViewAdjustment->Save(config);
+		helper->SaveConfig(config);
+	}
+
+	if ((KEY_DOWN(VK_RETURN)) && (menuVelocity == D3DXVECTOR2(0.0f, 0.0f)))
+	{
+		// back to main menu
+		if (entryID == 0)
+		{
+			BRASSA_mode = BRASSA_Modes::MAINMENU;
+			menuVelocity.x+=10.0f;
+		}
+		// back to game
+		if (entryID == 1)
+		{
+			BRASSA_mode = BRASSA_Modes::INACTIVE;
+			ProxyHelper* helper = new ProxyHelper();
+			config.roll_multiplier = tracker->multiplierRoll;
+			config.yaw_multiplier = tracker->multiplierYaw;
+			config.pitch_multiplier = tracker->multiplierPitch;
+			config.swap_eyes = stereoView->swapEyes;
+			m_spShaderViewAdjustment->Save(config);
+			helper->SaveConfig(config);
+		}
+	}
+
+	// output menu
+	if (hudFont)
+	{
+		ProxyCounterValues counters;
+		if (!m_counters.Snapshot(&counters))
+			ZeroMemory(&counters, sizeof(ProxyCounterValues));
+
+		// draw border - total width due to shift correction
+		D3DRECT rect;
+		rect.x1 = (int)0; rect.x2 = (int)width; rect.y1 = (int)borderTopHeight; rect.y2 = (int)(borderTopHeight+height*0.04f);
+		ClearEmptyRect(vireio::RenderPosition::Left, rect, D3DCOLOR_ARGB(255,255,128,128), 2);
+		ClearEmptyRect(vireio::RenderPosition::Right, rect, D3DCOLOR_ARGB(255,255,128,128), 2);
+
+		hudMainMenu->Begin(D3DXSPRITE_ALPHABLEND);
+
+		D3DXMATRIX matScale;
+		D3DXMatrixScaling(&matScale, fScaleX, fScaleY, 1.0f);
+		hudMainMenu->SetTransform(&matScale);
+
+		rect1.left = 550;
+		rect1.top = 300;
+		DrawTextShadowed(hudFont, hudMainMenu, "Brown Reischl and Schneider Settings Analyzer (B.R.A.S.S.A.).\n", -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect.x1 = 0; rect.x2 = width; rect.y1 = (int)(335*fScaleY); rect.y2 = (int)(340*fScaleY);
+		Clear(1, &rect, D3DCLEAR_TARGET, D3DCOLOR_ARGB(255,255,128,128), 0, 0);
+
+		rect1.top += 50;  rect1.left += 250;
+		char vcString[128];
+		sprintf_s(vcString, "Draws issued : %u (frame %u)", counters.drawsIssued, counters.frame);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "Draws doubled : %u (instanced %u, per side %u)", counters.drawsDoubled, counters.drawsInstanced, counters.drawsPerSide);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "Draws deferred : %u", counters.drawsDeferred);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "Mono draws : %u (one side %u)", counters.drawsMono, counters.drawsElided);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "Eye switches : %u", counters.eyeSwitches);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "Texture rebinds : %u", counters.textureRebinds);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "VS constant uploads : %u (%u floats, %u registers unchanged)", counters.vsConstantUploads, counters.vsConstantFloats, counters.vsConstantsUnchanged);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "PS constant uploads : %u (%u floats, %u registers unchanged)", counters.psConstantUploads, counters.psConstantFloats, counters.psConstantsUnchanged);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "Int/bool constant uploads : %u (%u registers unchanged)", counters.intBoolConstantUploads, counters.intBoolConstantsUnchanged);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "Stereo constant updates : %u (%u side change uploads skipped)", counters.stereoConstantUpdates, counters.stereoUploadsSkipped);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "StretchRect copies : %u", counters.stretchRectCopies);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "Mono side copies : %u", counters.sidesCopied);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "State block creations : %u", counters.stateBlockCreations);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "Filtered redundant calls : %u", counters.filteredCalls);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		sprintf_s(vcString, "Shader analysis queue : %u (%u stalls, %u us)", counters.shaderAnalysisQueueDepth, counters.shaderAnalysisStalls, counters.shaderAnalysisStallTime);
+		DrawTextShadowed(hudFont, hudMainMenu, vcString, -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		DrawTextShadowed(hudFont, hudMainMenu, "Back to BRASSA Menu", -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+		rect1.top += 40;
+		DrawTextShadowed(hudFont, hudMainMenu, "Back to Game", -1, &rect1, 0, D3DCOLOR_ARGB(255, 255, 255, 255));
+
+		rect1.left = 0;
+		rect1.right = 1920;
+		rect1.top = 0;
+		rect1.bottom = 1080;
+		D3DXVECTOR3 vPos( 0.0f, 0.0f, 0.0f);
+		hudMainMenu->Draw(NULL, &rect1, NULL, &vPos, D3DCOLOR_ARGB(255, 255, 255, 255));
+		hudMainMenu->End();
+	}
+}
+
+/**
+* Releases HUD font, shader registers, render targets, texture stages, vertex buffers, depth stencils, indices, shaders, declarations.
+***/
+void D3DProxyDevice::ReleaseEverything()
+{
+	// Fonts and any other D3DX interfaces should be released first.
+	// They frequently hold stateblocks which are holding further references to other resources.
+	if(hudFont) {
+		hudFont->Release();
+		hudFont = NULL;
+	}
+
+
+	m_spManagedShaderRegisters->ReleaseResources();
+
+	// the side-by-side surfaces are released with the proxy surfaces
+	m_bSideBySidePass = false;
+	m_bInstancedStereoBound = false;
+	_SAFE_RELEASE(m_pInstancedStereoBuffer);
+	_SAFE_RELEASE(m_pSequentialIndices);
+
+	// pending commands are dropped, they hold references to the recorded resources
+	m_stereoCommands.Clear();
+
+	if (m_pCapturingStateTo) {
+		m_pCapturingStateTo->Release();
+		m_pCapturingStateTo = NULL;
+	}
+
+	// one of these will still have a count of 1 until the backbuffer is released
+	for(std::vector<D3D9ProxySurface*>::size_type i = 0; i != m_activeRenderTargets.size(); i++) 
+	{
+		if (m_activeRenderTargets[i] != NULL) {
+			m_activeRenderTargets[i]->Release();
+			m_activeRenderTargets[i] = NULL;
+		}
+	} 
+
+
+	for (int samplerIndex = 0; samplerIndex < SAMPLER_COUNT; samplerIndex++)
+		storeActiveTexture(samplerIndex, NULL);
+
+
+	for (UINT streamNumber = 0; streamNumber < STREAM_COUNT; streamNumber++)
+		storeActiveVertexBuffer(streamNumber, NULL);
+
+
+
 
-
-
 	if (m_pActiveStereoDepthStencil) {
 		m_pActiveStereoDepthStencil->Release();
 		m_pActiveStereoDepthStencil = NULL;
@@ -4250,4 +5397,766 @@ HRESULT D3DProxyDevice::SetStereoProjectionTransform(D3DXMATRIX pLeftMatrix, D3D
 		return BaseDirect3DDevice9::SetTransform(D3DTS_PROJECTION, m_pCurrentProjection);
 	else
 		return D3D_OK;
+}
+
+/**
+* Stores the texture active at a stage and updates the stereo stage bitmask.
+* Releases the texture previously stored at that stage, AddRefs the new one.
+* Does not set anything on the actual device.
+* @param samplerIndex The stage as returned by vireio::SamplerIndex().
+* @param pTexture The wrapped texture, can be NULL.
+***/
+void D3DProxyDevice::storeActiveTexture(int samplerIndex, IDirect3DBaseTexture9* pTexture)
+{
+	IDirect3DBaseTexture9* pOldTexture = m_activeTextureStages[samplerIndex];
+	if (pOldTexture == pTexture)
+		return;
+
+	if (pTexture)
+		pTexture->AddRef();
+	if (pOldTexture)
+		pOldTexture->Release();
+
+	m_activeTextureStages[samplerIndex] = pTexture;
+
+	// stereo if unwrapping returns a right texture
+	IDirect3DBaseTexture9* pActualLeftTexture = NULL;
+	IDirect3DBaseTexture9* pActualRightTexture = NULL;
+	if (pTexture)
+		vireio::UnWrapTexture(pTexture, &pActualLeftTexture, &pActualRightTexture);
+
+	if (pActualRightTexture)
+		m_stereoTextureStages |= (1 << samplerIndex);
+	else
+		m_stereoTextureStages &= ~(1 << samplerIndex);
+}
+
+/**
+* Stores the vertex buffer active at a stream.
+* Releases the buffer previously stored at that stream, AddRefs the new one.
+* Does not set anything on the actual device.
+* @param streamNumber The stream number, smaller than STREAM_COUNT.
+* @param pVertexBuffer The wrapped vertex buffer, can be NULL.
+***/
+void D3DProxyDevice::storeActiveVertexBuffer(UINT streamNumber, BaseDirect3DVertexBuffer9* pVertexBuffer)
+{
+	BaseDirect3DVertexBuffer9* pOldBuffer = m_activeVertexBuffers[streamNumber];
+	if (pOldBuffer == pVertexBuffer)
+		return;
+
+	if (pVertexBuffer)
+		pVertexBuffer->AddRef();
+	if (pOldBuffer)
+		pOldBuffer->Release();
+
+	m_activeVertexBuffers[streamNumber] = pVertexBuffer;
+}
+
+/**
+* True if draws and states are recorded for the other side.
+* Only in deferred mode, not while replaying, not while capturing a state block and only for a stereo
+* primary render target (mono render targets are drawn once anyway).
+***/
+bool D3DProxyDevice::isRecordingStereoCommands()
+{
+	return m_bDeferredRightEye && !m_bReplayingStereoCommands && !m_pCapturingStateTo && 
+		(m_activeRenderTargets[0] != NULL) && m_activeRenderTargets[0]->IsStereo();
+}
+
+/**
+* True if calls reaching the proxy device are written to the call trace.
+* Replayed stereo commands are not game calls and not traced.
+***/
+bool D3DProxyDevice::isTracingCalls()
+{
+	return m_callTrace.IsCapturing() && !m_bReplayingStereoCommands;
+}
+
+/**
+* True if the next draw renders the same image for both sides.
+* That is if no stereo texture is bound and no stereo constant modification is active for the bound
+* shaders (or, for fixed function vertex processing, no stereo view or projection transform is set).
+***/
+bool D3DProxyDevice::isDrawMono()
+{
+	if (m_stereoTextureStages != 0)
+		return false;
+
+	if (m_pActiveVertexShader) {
+		if (!m_pActiveVertexShader->ModifiedConstants()->Empty())
+			return false;
+	}
+	else if (m_bViewTransformSet || m_bProjectionTransformSet)
+		return false;
+
+	if (m_pActivePixelShader && !m_pActivePixelShader->ModifiedConstants()->Empty())
+		return false;
+
+	return true;
+}
+
+/**
+* Classifies the next draw and updates the stereo content state of the bound render targets.
+* A mono draw is drawn for the current side only if every bound stereo render target holds equal
+* sides (or the current side already holds the only up to date content) and no stereo depth stencil
+* is bound. Otherwise the render targets are resolved before both sides are drawn.
+* In a side-by-side pass the draw is done for both sides into the halves.
+* @return True if the draw is to be done for the current side only.
+* @see D3D9ProxySurface::ResolveContent()
+***/
+bool D3DProxyDevice::prepareStereoDraw()
+{
+	// the sides are drawn separately into the halves of the side-by-side surfaces
+	if (m_bSideBySidePass) {
+		restoreInstancedStereoState();
+		m_activeRenderTargets[0]->MarkContentSideBySide();
+		return false;
+	}
+
+	// the depth stencil content of a side-by-side pass is not copied back to the sides
+	if (m_pActiveStereoDepthStencil && m_pActiveStereoDepthStencil->IsSideBySide()) {
+		DWORD zEnable = FALSE;
+		DWORD stencilEnable = FALSE;
+		BaseDirect3DDevice9::GetRenderState(D3DRS_ZENABLE, &zEnable);
+		BaseDirect3DDevice9::GetRenderState(D3DRS_STENCILENABLE, &stencilEnable);
+		if (zEnable || stencilEnable) {
+			OutputDebugString("prepareStereoDraw: Depth stencil drawn side-by-side used outside of the side-by-side pass, depth is lost.\n");
+			m_pActiveStereoDepthStencil->MarkContentUnknown();
+		}
+	}
+
+	if (!m_bMonoDrawElision || (m_activeRenderTargets[0] == NULL) || !m_activeRenderTargets[0]->IsStereo())
+		return false;
+
+	// a stereo depth stencil gives different depth tests for both sides
+	bool mono = isDrawMono() && !(m_pActiveStereoDepthStencil && m_pActiveStereoDepthStencil->IsStereo());
+	if (mono)
+		m_counters.Frame().drawsMono++;
+
+	bool oneSide = mono;
+	for (std::vector<D3D9ProxySurface*>::size_type i = 0; oneSide && (i < m_activeRenderTargets.size()); i++) {
+		if (m_activeRenderTargets[i] && m_activeRenderTargets[i]->IsStereo() && !m_activeRenderTargets[i]->CanDrawOneSide(m_currentRenderingSide))
+			oneSide = false;
+	}
+
+	for (std::vector<D3D9ProxySurface*>::size_type i = 0; i < m_activeRenderTargets.size(); i++) {
+		D3D9ProxySurface* pRenderTarget = m_activeRenderTargets[i];
+		if (!pRenderTarget || !pRenderTarget->IsStereo())
+			continue;
+
+		if (oneSide)
+			pRenderTarget->MarkContentDrawnOn(m_currentRenderingSide);
+		else {
+			if (pRenderTarget->ResolveContent()) {
+				m_counters.Frame().sidesCopied++;
+				m_counters.Frame().stretchRectCopies++;
+			}
+			if (!mono)
+				pRenderTarget->MarkContentUnknown();
+		}
+	}
+
+	if (oneSide)
+		m_counters.Frame().drawsElided++;
+
+	return oneSide;
+}
+
+/**
+* Copies mono drawn content to the other side for all bound render targets.
+* To be called before render targets are read, partially cleared or unbound.
+* @see D3D9ProxySurface::ResolveContent()
+***/
+void D3DProxyDevice::resolveRenderTargets()
+{
+	for (std::vector<D3D9ProxySurface*>::size_type i = 0; i < m_activeRenderTargets.size(); i++) {
+		if (m_activeRenderTargets[i] && m_activeRenderTargets[i]->ResolveContent()) {
+			m_counters.Frame().sidesCopied++;
+			m_counters.Frame().stretchRectCopies++;
+		}
+	}
+}
+
+/**
+* Draws both sides with one instanced draw into the side-by-side surfaces.
+* The patched vertex shader reads the right stereo constants from free registers for the second instance
+* and moves the vertices into the half of its side, the patched pixel shader discards pixels drawn past
+* the half. Draws using stereo textures, pixel shader stereo constants, a clipped viewport or scissor
+* rectangle or game instancing are drawn per side (counted in drawsPerSide).
+* Non indexed draws are drawn through the sequential indices, BaseVertexIndex is the start vertex then.
+* @param sequentialIndices True to draw with the sequential indices instead of the game indices.
+* @param pResult [out] The draw result, only set if the draw was done.
+* @return True if both sides were drawn.
+* @see StereoShaderPatcher
+***/
+bool D3DProxyDevice::drawInstancedStereo(D3DPRIMITIVETYPE PrimitiveType, INT BaseVertexIndex, UINT MinVertexIndex, UINT NumVertices, UINT startIndex, UINT primCount, bool sequentialIndices, HRESULT* pResult)
+{
+	if (!m_pInstancedStereoBuffer || !m_pActiveVertexShader || !m_pActivePixelShader || !m_pActiveVertexDeclaration)
+		return false;
+
+	if (sequentialIndices && (!m_pSequentialIndices || (NumVertices > SEQUENTIAL_INDEX_COUNT)))
+		return false;
+
+	if ((m_stereoTextureStages != 0) || !m_bActiveViewportIsDefault || !m_pActivePixelShader->ModifiedConstants()->Empty() ||
+		m_activeVertexBuffers[D3D9ProxyVertexDeclaration::INSTANCED_STEREO_STREAM])
+		return false;
+
+	DWORD scissorTestEnable = TRUE;
+	UINT frequency = 0;
+	if (FAILED(BaseDirect3DDevice9::GetRenderState(D3DRS_SCISSORTESTENABLE, &scissorTestEnable)) || scissorTestEnable ||
+		FAILED(BaseDirect3DDevice9::GetStreamSourceFreq(0, &frequency)) || (frequency != 1))
+		return false;
+
+	// a FVF set after the declaration replaces it on the actual device
+	D3D9ProxyVertexDeclaration* pDeclaration = static_cast<D3D9ProxyVertexDeclaration*>(m_pActiveVertexDeclaration);
+	IDirect3DVertexDeclaration9* pActualDeclaration = NULL;
+	if (FAILED(BaseDirect3DDevice9::GetVertexDeclaration(&pActualDeclaration)) || !pActualDeclaration)
+		return false;
+	pActualDeclaration->Release();
+
+	IDirect3DVertexDeclaration9* pInstancedDeclaration = pDeclaration->InstancedStereoDeclaration();
+	if ((pActualDeclaration != pDeclaration->getActual()) && (pActualDeclaration != pInstancedDeclaration))
+		return false;
+
+	IDirect3DVertexShader9* pVertexShader = m_pActiveVertexShader->InstancedStereoShader();
+	IDirect3DPixelShader9* pPixelShader = m_pActivePixelShader->InstancedStereoShader();
+	DWORD streamMask = pDeclaration->StreamMask();
+	if (!pVertexShader || !pPixelShader || !pInstancedDeclaration || !(streamMask & 1))
+		return false;
+
+	// left constants in the registers of the game shader, right constants in the registers read by the second instance
+	setDrawingSide(vireio::Left);
+	m_spManagedShaderRegisters->ApplyAllDirty(vireio::Left);
+	m_spManagedShaderRegisters->ApplyInstancedStereoConstants(m_pActiveVertexShader->InstancedStereoRightRegisters());
+
+	D3DVIEWPORT9 sideBySide = {0, 0, m_sideBySideWidth * 2, m_sideBySideHeight, 0.0f, 1.0f};
+	BaseDirect3DDevice9::SetVertexShader(pVertexShader);
+	BaseDirect3DDevice9::SetPixelShader(pPixelShader);
+	BaseDirect3DDevice9::SetVertexDeclaration(pInstancedDeclaration);
+	BaseDirect3DDevice9::SetStreamSource(D3D9ProxyVertexDeclaration::INSTANCED_STEREO_STREAM, m_pInstancedStereoBuffer, 0, 4 * sizeof(float));
+	BaseDirect3DDevice9::SetViewport(&sideBySide);
+	m_bInstancedStereoBound = true;
+
+	for (UINT stream = 0; stream < D3D9ProxyVertexDeclaration::INSTANCED_STEREO_STREAM; stream++) {
+		if (streamMask & (1 << stream))
+			BaseDirect3DDevice9::SetStreamSourceFreq(stream, D3DSTREAMSOURCE_INDEXEDDATA | 2);
+	}
+	BaseDirect3DDevice9::SetStreamSourceFreq(D3D9ProxyVertexDeclaration::INSTANCED_STEREO_STREAM, D3DSTREAMSOURCE_INSTANCEDATA | 1);
+
+	if (sequentialIndices) {
+		BaseDirect3DDevice9::SetIndices(m_pSequentialIndices);
+		*pResult = BaseDirect3DDevice9::DrawIndexedPrimitive(PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, startIndex, primCount);
+		BaseDirect3DDevice9::SetIndices(m_pActiveIndicies ? m_pActiveIndicies->getActual() : NULL);
+	}
+	else
+		*pResult = BaseDirect3DDevice9::DrawIndexedPrimitive(PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, startIndex, primCount);
+
+	// instancing is off again for the next (possibly not instanced) draw
+	for (UINT stream = 0; stream <= D3D9ProxyVertexDeclaration::INSTANCED_STEREO_STREAM; stream++) {
+		if ((streamMask & (1 << stream)) || (stream == D3D9ProxyVertexDeclaration::INSTANCED_STEREO_STREAM))
+			BaseDirect3DDevice9::SetStreamSourceFreq(stream, 1);
+	}
+
+	m_activeRenderTargets[0]->MarkContentSideBySide();
+	m_counters.Frame().drawsInstanced++;
+
+	return true;
+}
+
+/**
+* Binds the game shaders, declaration, instance stream and side viewport again after an instanced stereo draw.
+* States the game changed since the draw are left as they are.
+***/
+void D3DProxyDevice::restoreInstancedStereoState()
+{
+	if (!m_bInstancedStereoBound)
+		return;
+
+	m_bInstancedStereoBound = false;
+
+	BaseDirect3DDevice9::SetVertexShader(m_pActiveVertexShader ? m_pActiveVertexShader->getActual() : NULL);
+	BaseDirect3DDevice9::SetPixelShader(m_pActivePixelShader ? m_pActivePixelShader->getActual() : NULL);
+
+	IDirect3DVertexDeclaration9* pActualDeclaration = NULL;
+	if (m_pActiveVertexDeclaration && SUCCEEDED(BaseDirect3DDevice9::GetVertexDeclaration(&pActualDeclaration)) && pActualDeclaration) {
+		pActualDeclaration->Release();
+
+		if (pActualDeclaration == static_cast<D3D9ProxyVertexDeclaration*>(m_pActiveVertexDeclaration)->InstancedStereoDeclaration())
+			BaseDirect3DDevice9::SetVertexDeclaration(m_pActiveVertexDeclaration->getActual());
+	}
+
+	if (!m_activeVertexBuffers[D3D9ProxyVertexDeclaration::INSTANCED_STEREO_STREAM])
+		BaseDirect3DDevice9::SetStreamSource(D3D9ProxyVertexDeclaration::INSTANCED_STEREO_STREAM, NULL, 0, 0);
+
+	if (m_bSideBySidePass)
+		applySideBySideViewport(m_currentRenderingSide);
+}
+
+/**
+* True if the bound targets can be drawn side-by-side: a single stereo (not multisampled) render target
+* and a depth stencil of the same size, both with a side-by-side surface.
+***/
+bool D3DProxyDevice::canUseSideBySide()
+{
+	D3D9ProxySurface* pRenderTarget = m_activeRenderTargets[0];
+	D3DSURFACE_DESC renderTargetDesc;
+	if (!pRenderTarget || !pRenderTarget->IsStereo() || FAILED(pRenderTarget->GetDesc(&renderTargetDesc)) ||
+		(renderTargetDesc.MultiSampleType != D3DMULTISAMPLE_NONE) || !pRenderTarget->getActualSideBySide())
+		return false;
+
+	for (std::vector<D3D9ProxySurface*>::size_type i = 1; i < m_activeRenderTargets.size(); i++) {
+		if (m_activeRenderTargets[i])
+			return false;
+	}
+
+	if (m_pActiveStereoDepthStencil) {
+		D3DSURFACE_DESC depthStencilDesc;
+		if (FAILED(m_pActiveStereoDepthStencil->GetDesc(&depthStencilDesc)) || (depthStencilDesc.Width != renderTargetDesc.Width) ||
+			(depthStencilDesc.Height != renderTargetDesc.Height) || !m_pActiveStereoDepthStencil->getActualSideBySide())
+			return false;
+	}
+
+	return true;
+}
+
+/**
+* Starts the side-by-side pass on a full clear of the depth stencil (or of the render target without
+* depth stencil), depth stencil content can not be copied into the side-by-side surface.
+* @return True if the pass started.
+***/
+bool D3DProxyDevice::startSideBySidePass(DWORD Count, CONST D3DRECT* pRects, DWORD Flags)
+{
+	DWORD scissorTestEnable = TRUE;
+	if (((Count != 0) && (pRects != NULL)) || !m_bActiveViewportIsDefault ||
+		FAILED(BaseDirect3DDevice9::GetRenderState(D3DRS_SCISSORTESTENABLE, &scissorTestEnable)) || scissorTestEnable)
+		return false;
+
+	if (m_pActiveStereoDepthStencil) {
+		D3DSURFACE_DESC desc;
+		if (!(Flags & D3DCLEAR_ZBUFFER) || FAILED(m_pActiveStereoDepthStencil->GetDesc(&desc)))
+			return false;
+
+		bool hasStencil = (desc.Format == D3DFMT_D24S8) || (desc.Format == D3DFMT_D24X4S4) || 
+			(desc.Format == D3DFMT_D15S1) || (desc.Format == D3DFMT_D24FS8);
+		if (hasStencil && !(Flags & D3DCLEAR_STENCIL))
+			return false;
+	}
+	else if (!(Flags & D3DCLEAR_TARGET))
+		return false;
+
+	if (!canUseSideBySide())
+		return false;
+
+	// cleared content needs no copy into the side-by-side surface
+	if (Flags & D3DCLEAR_TARGET)
+		m_activeRenderTargets[0]->MarkContentSideBySide();
+	if (m_pActiveStereoDepthStencil)
+		m_pActiveStereoDepthStencil->MarkContentSideBySide();
+
+	beginSideBySidePass();
+	return true;
+}
+
+/**
+* Binds the side-by-side surfaces of the primary render target and depth stencil on the actual device.
+* The render target content is copied into the halves first if needed.
+***/
+void D3DProxyDevice::beginSideBySidePass()
+{
+	D3D9ProxySurface* pRenderTarget = m_activeRenderTargets[0];
+	if (pRenderTarget->EnterSideBySide())
+		m_counters.Frame().stretchRectCopies += 2;
+
+	D3DSURFACE_DESC desc;
+	pRenderTarget->GetDesc(&desc);
+	m_sideBySideWidth = desc.Width;
+	m_sideBySideHeight = desc.Height;
+	m_bSideBySidePass = true;
+
+	BaseDirect3DDevice9::SetRenderTarget(0, pRenderTarget->getActualSideBySide());
+	BaseDirect3DDevice9::SetDepthStencilSurface(m_pActiveStereoDepthStencil ? m_pActiveStereoDepthStencil->getActualSideBySide() : NULL);
+
+	// setting the render target reset viewport and scissor rectangle
+	applySideBySideViewport(m_currentRenderingSide);
+}
+
+/**
+* Copies the side-by-side render target content back to the sides and binds the side surfaces again.
+* The depth stencil keeps its side-by-side content for a later pass.
+***/
+void D3DProxyDevice::endSideBySidePass()
+{
+	if (!m_bSideBySidePass)
+		return;
+
+	m_bSideBySidePass = false;
+	restoreInstancedStereoState();
+
+	D3D9ProxySurface* pRenderTarget = m_activeRenderTargets[0];
+	if (pRenderTarget->LeaveSideBySide())
+		m_counters.Frame().stretchRectCopies += 2;
+
+	bool left = (m_currentRenderingSide == vireio::Left);
+	BaseDirect3DDevice9::SetRenderTarget(0, left ? pRenderTarget->getActualLeft() : pRenderTarget->getActualRight());
+	if (m_pActiveStereoDepthStencil)
+		BaseDirect3DDevice9::SetDepthStencilSurface(left ? m_pActiveStereoDepthStencil->getActualLeft() : m_pActiveStereoDepthStencil->getActualRight());
+	else
+		BaseDirect3DDevice9::SetDepthStencilSurface(NULL);
+
+	if (!m_bActiveViewportIsDefault)
+		BaseDirect3DDevice9::SetViewport(&m_LastViewportSet);
+	BaseDirect3DDevice9::SetScissorRect(&m_LastScissorRect);
+}
+
+/**
+* Continues the side-by-side pass after a target change if the depth stencil (or, without depth stencil,
+* the running pass) still holds side-by-side content and the new targets qualify, ends it otherwise.
+***/
+void D3DProxyDevice::updateSideBySidePass()
+{
+	if (!m_bInstancedStereo || m_bInBeginEndStateBlock)
+		return;
+
+	bool sideBySide = m_pActiveStereoDepthStencil ? m_pActiveStereoDepthStencil->IsSideBySide() : m_bSideBySidePass;
+	if (sideBySide && canUseSideBySide())
+		beginSideBySidePass();
+	else
+		endSideBySidePass();
+}
+
+/**
+* Ends the side-by-side pass before the primary render target is written by a copy or fill.
+* A written depth stencil loses its side-by-side content.
+***/
+void D3DProxyDevice::leaveSideBySidePassFor(IDirect3DSurface9* pSurface)
+{
+	if (!m_bInstancedStereo || !pSurface)
+		return;
+
+	D3D9ProxySurface* pWrappedSurface = static_cast<D3D9ProxySurface*>(pSurface);
+	if (pWrappedSurface == m_activeRenderTargets[0])
+		endSideBySidePass();
+	else if (pWrappedSurface->IsSideBySide())
+		pWrappedSurface->MarkContentUnknown();
+}
+
+/**
+* Moves the viewport and scissor rectangle set by the game into the half of the side.
+***/
+void D3DProxyDevice::applySideBySideViewport(vireio::RenderPosition side)
+{
+	D3DVIEWPORT9 viewport = m_LastViewportSet;
+	if (m_bActiveViewportIsDefault) {
+		D3DVIEWPORT9 fullSurface = {0, 0, m_sideBySideWidth, m_sideBySideHeight, 0.0f, 1.0f};
+		viewport = fullSurface;
+	}
+
+	RECT sideRect;
+	RECT scissorRect;
+	SetRect(&sideRect, 0, 0, (LONG)m_sideBySideWidth, (LONG)m_sideBySideHeight);
+	IntersectRect(&scissorRect, &m_LastScissorRect, &sideRect);
+
+	if (side == vireio::Right) {
+		viewport.X += m_sideBySideWidth;
+		OffsetRect(&scissorRect, (int)m_sideBySideWidth, 0);
+	}
+
+	BaseDirect3DDevice9::SetViewport(&viewport);
+	BaseDirect3DDevice9::SetScissorRect(&scissorRect);
+}
+
+/**
+* Clears in the side-by-side pass. A full clear clears both halves at once, otherwise the halves are
+* cleared per side with the rectangles moved to the right half for the right side.
+***/
+HRESULT D3DProxyDevice::clearSideBySide(DWORD Count, CONST D3DRECT* pRects, DWORD Flags, D3DCOLOR Color, float Z, DWORD Stencil)
+{
+	restoreInstancedStereoState();
+
+	if (Flags & D3DCLEAR_TARGET)
+		m_activeRenderTargets[0]->MarkContentSideBySide();
+
+	HRESULT result;
+	DWORD scissorTestEnable = TRUE;
+	if (((Count == 0) || (pRects == NULL)) && m_bActiveViewportIsDefault &&
+		SUCCEEDED(BaseDirect3DDevice9::GetRenderState(D3DRS_SCISSORTESTENABLE, &scissorTestEnable)) && !scissorTestEnable) {
+
+		D3DVIEWPORT9 sideBySide = {0, 0, m_sideBySideWidth * 2, m_sideBySideHeight, 0.0f, 1.0f};
+		BaseDirect3DDevice9::SetViewport(&sideBySide);
+		result = BaseDirect3DDevice9::Clear(0, NULL, Flags, Color, Z, Stencil);
+		applySideBySideViewport(m_currentRenderingSide);
+
+		return result;
+	}
+
+	// rectangles are clipped to the viewport of the side
+	CONST D3DRECT* pRightRects = pRects;
+	if ((Count != 0) && (pRects != NULL)) {
+		m_sideBySideRects.assign(pRects, pRects + Count);
+		for (std::vector<D3DRECT>::iterator it = m_sideBySideRects.begin(); it != m_sideBySideRects.end(); ++it) {
+			it->x1 += (LONG)m_sideBySideWidth;
+			it->x2 += (LONG)m_sideBySideWidth;
+		}
+		pRightRects = &m_sideBySideRects[0];
+	}
+
+	if (SUCCEEDED(result = BaseDirect3DDevice9::Clear(Count, (m_currentRenderingSide == vireio::Right) ? pRightRects : pRects, Flags, Color, Z, Stencil))) {
+		if (switchDrawingSide()) {
+			m_counters.Frame().drawsDoubled++;
+			BaseDirect3DDevice9::Clear(Count, (m_currentRenderingSide == vireio::Right) ? pRightRects : pRects, Flags, Color, Z, Stencil);
+		}
+	}
+
+	return result;
+}
+
+/**
+* Binds the game states before an actual state block captures or applies them in a side-by-side pass.
+* @see finishActualStateBlock()
+***/
+void D3DProxyDevice::prepareActualStateBlock()
+{
+	if (!m_bSideBySidePass)
+		return;
+
+	restoreInstancedStereoState();
+
+	D3DVIEWPORT9 viewport;
+	GetViewport(&viewport);
+	BaseDirect3DDevice9::SetViewport(&viewport);
+	BaseDirect3DDevice9::SetScissorRect(&m_LastScissorRect);
+}
+
+/**
+* Takes the scissor rectangle of an applied actual state block and moves viewport and scissor rectangle
+* into the half of the current side again.
+* @see prepareActualStateBlock()
+***/
+void D3DProxyDevice::finishActualStateBlock()
+{
+	if (!m_bInstancedStereo)
+		return;
+
+	BaseDirect3DDevice9::GetScissorRect(&m_LastScissorRect);
+
+	if (m_bSideBySidePass)
+		applySideBySideViewport(m_currentRenderingSide);
+}
+
+/**
+* Adds the restore command(s) for a state, if the state is touched the first time since the last flush.
+* Must be called before the state changes. The restore values are read from the proxy device (stereo states,
+* proxy objects) or from the actual device (plain states).
+* Vertex declaration and FVF replace each other on the actual device, both are restored for 
+* Cmd_Type_VertexDeclaration.
+* @param type The command type setting the state.
+* @param index The state index (render state type, stage, stream, register, MAKELONG(type, sampler)).
+***/
+void D3DProxyDevice::captureRestoreState(StereoCommandList::CommandTypes type, DWORD index)
+{
+	if (!m_stereoCommands.FirstTouch(type, index))
+		return;
+
+	switch (type)
+	{
+	case StereoCommandList::Cmd_Type_RenderState:
+		{
+			DWORD value = 0;
+			BaseDirect3DDevice9::GetRenderState((D3DRENDERSTATETYPE)index, &value);
+			m_stereoCommands.Restore(type, index, value);
+			break;
+		}
+	case StereoCommandList::Cmd_Type_SamplerState:
+		{
+			DWORD value = 0;
+			BaseDirect3DDevice9::GetSamplerState(HIWORD(index), (D3DSAMPLERSTATETYPE)LOWORD(index), &value);
+			m_stereoCommands.Restore(type, HIWORD(index), LOWORD(index), value);
+			break;
+		}
+	case StereoCommandList::Cmd_Type_TextureStageState:
+		{
+			DWORD value = 0;
+			BaseDirect3DDevice9::GetTextureStageState(HIWORD(index), (D3DTEXTURESTAGESTATETYPE)LOWORD(index), &value);
+			m_stereoCommands.Restore(type, HIWORD(index), LOWORD(index), value);
+			break;
+		}
+	case StereoCommandList::Cmd_Type_ScissorRect:
+		{
+			RECT rect;
+			BaseDirect3DDevice9::GetScissorRect(&rect);
+			m_stereoCommands.Restore(type, 0, 0, 0, 0, NULL, &rect, sizeof(RECT));
+			break;
+		}
+	case StereoCommandList::Cmd_Type_FVF:
+	case StereoCommandList::Cmd_Type_VertexDeclaration:
+		{
+			DWORD fvf = 0;
+			BaseDirect3DDevice9::GetFVF(&fvf);
+			m_stereoCommands.Restore(StereoCommandList::Cmd_Type_VertexDeclaration, 0, 0, 0, 0, m_pActiveVertexDeclaration);
+			if (fvf != 0)
+				m_stereoCommands.Restore(StereoCommandList::Cmd_Type_FVF, fvf);
+			break;
+		}
+	case StereoCommandList::Cmd_Type_Transform:
+		{
+			if (index == D3DTS_VIEW) {
+				D3DXMATRIX views[2] = { m_leftView, m_rightView };
+				m_stereoCommands.Restore(StereoCommandList::Cmd_Type_StereoView, 0, 0, 0, 0, NULL, views, sizeof(views));
+			}
+			else if (index == D3DTS_PROJECTION) {
+				D3DXMATRIX projections[2] = { m_leftProjection, m_rightProjection };
+				m_stereoCommands.Restore(StereoCommandList::Cmd_Type_StereoProjection, 0, 0, 0, 0, NULL, projections, sizeof(projections));
+			}
+			else {
+				D3DMATRIX matrix;
+				BaseDirect3DDevice9::GetTransform((D3DTRANSFORMSTATETYPE)index, &matrix);
+				m_stereoCommands.Restore(type, index, 0, 0, 0, NULL, &matrix, sizeof(D3DMATRIX));
+			}
+			break;
+		}
+	case StereoCommandList::Cmd_Type_Viewport:
+		{
+			D3DVIEWPORT9 viewport;
+			BaseDirect3DDevice9::GetViewport(&viewport);
+			m_stereoCommands.Restore(type, 0, 0, 0, 0, NULL, &viewport, sizeof(D3DVIEWPORT9));
+			break;
+		}
+	case StereoCommandList::Cmd_Type_Texture:
+		{
+			IDirect3DBaseTexture9* pTexture = NULL;
+			int samplerIndex = vireio::SamplerIndex(index);
+			if (samplerIndex >= 0)
+				pTexture = m_activeTextureStages[samplerIndex];
+			m_stereoCommands.Restore(type, index, 0, 0, 0, pTexture);
+			break;
+		}
+	case StereoCommandList::Cmd_Type_StreamSource:
+		{
+			BaseDirect3DVertexBuffer9* pVertexBuffer = NULL;
+			if (index < STREAM_COUNT)
+				pVertexBuffer = m_activeVertexBuffers[index];
+
+			// offset and stride are not stored by the proxy
+			IDirect3DVertexBuffer9* pActualVertexBuffer = NULL;
+			UINT offset = 0;
+			UINT stride = 0;
+			BaseDirect3DDevice9::GetStreamSource(index, &pActualVertexBuffer, &offset, &stride);
+			if (pActualVertexBuffer)
+				pActualVertexBuffer->Release();
+
+			m_stereoCommands.Restore(type, index, offset, stride, 0, pVertexBuffer);
+			break;
+		}
+	case StereoCommandList::Cmd_Type_StreamSourceFreq:
+		{
+			UINT setting = 1;
+			BaseDirect3DDevice9::GetStreamSourceFreq(index, &setting);
+			m_stereoCommands.Restore(type, index, setting);
+			break;
+		}
+	case StereoCommandList::Cmd_Type_Indices:
+		m_stereoCommands.Restore(type, 0, 0, 0, 0, m_pActiveIndicies);
+		break;
+	case StereoCommandList::Cmd_Type_VertexShader:
+		m_stereoCommands.Restore(type, 0, 0, 0, 0, m_pActiveVertexShader);
+		break;
+	case StereoCommandList::Cmd_Type_PixelShader:
+		m_stereoCommands.Restore(type, 0, 0, 0, 0, m_pActivePixelShader);
+		break;
+	case StereoCommandList::Cmd_Type_VertexShaderConstantF:
+		{
+			float data[VECTOR_LENGTH] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			m_spManagedShaderRegisters->GetVertexShaderConstantF(index, data, 1);
+			m_stereoCommands.Restore(type, index, 1, 0, 0, NULL, data, sizeof(data));
+			break;
+		}
+	case StereoCommandList::Cmd_Type_PixelShaderConstantF:
+		{
+			float data[VECTOR_LENGTH] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			m_spManagedShaderRegisters->GetPixelShaderConstantF(index, data, 1);
+			m_stereoCommands.Restore(type, index, 1, 0, 0, NULL, data, sizeof(data));
+			break;
+		}
+	default:
+		OutputDebugString("captureRestoreState: Unhandled command type.\n");
+		break;
+	}
+}
+
+/**
+* Executes a recorded (or restore) command for the current side.
+* Proxy states are set using the proxy methods (to update the proxy states and to select the side),
+* all other states and the draws are directly passed to the actual device.
+* @param command The command to execute.
+***/
+HRESULT D3DProxyDevice::replayStereoCommand(const StereoCommandList::Command& command)
+{
+	const DWORD* args = command.args;
+	const void* pData = m_stereoCommands.Data(command);
+
+	switch (command.type)
+	{
+	case StereoCommandList::Cmd_Type_DrawPrimitive:
+		m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
+		return BaseDirect3DDevice9::DrawPrimitive((D3DPRIMITIVETYPE)args[0], args[1], args[2]);
+	case StereoCommandList::Cmd_Type_DrawIndexedPrimitive:
+		m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
+		return BaseDirect3DDevice9::DrawIndexedPrimitive((D3DPRIMITIVETYPE)args[0], (INT)args[1], args[2], args[3], args[4], args[5]);
+	case StereoCommandList::Cmd_Type_DrawPrimitiveUP:
+		m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
+		return BaseDirect3DDevice9::DrawPrimitiveUP((D3DPRIMITIVETYPE)args[0], args[1], pData, args[2]);
+	case StereoCommandList::Cmd_Type_DrawIndexedPrimitiveUP:
+		{
+			m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
+			const BYTE* pIndexData = (const BYTE*)pData + ((args[1] + args[2]) * args[5]);
+			return BaseDirect3DDevice9::DrawIndexedPrimitiveUP((D3DPRIMITIVETYPE)args[0], args[1], args[2], args[3], pIndexData, (D3DFORMAT)args[4], pData, args[5]);
+		}
+	case StereoCommandList::Cmd_Type_Clear:
+		return BaseDirect3DDevice9::Clear(args[0], (const D3DRECT*)pData, args[1], (D3DCOLOR)args[2], *(const float*)&args[4], args[3]);
+	case StereoCommandList::Cmd_Type_RenderState:
+		return BaseDirect3DDevice9::SetRenderState((D3DRENDERSTATETYPE)args[0], args[1]);
+	case StereoCommandList::Cmd_Type_SamplerState:
+		return BaseDirect3DDevice9::SetSamplerState(args[0], (D3DSAMPLERSTATETYPE)args[1], args[2]);
+	case StereoCommandList::Cmd_Type_TextureStageState:
+		return BaseDirect3DDevice9::SetTextureStageState(args[0], (D3DTEXTURESTAGESTATETYPE)args[1], args[2]);
+	case StereoCommandList::Cmd_Type_ScissorRect:
+		return BaseDirect3DDevice9::SetScissorRect((const RECT*)pData);
+	case StereoCommandList::Cmd_Type_FVF:
+		return BaseDirect3DDevice9::SetFVF(args[0]);
+	case StereoCommandList::Cmd_Type_Transform:
+		return D3DProxyDevice::SetTransform((D3DTRANSFORMSTATETYPE)args[0], (const D3DMATRIX*)pData);
+	case StereoCommandList::Cmd_Type_StereoView:
+		{
+			const D3DXMATRIX* pMatrices = (const D3DXMATRIX*)pData;
+			return SetStereoViewTransform(pMatrices[0], pMatrices[1], true);
+		}
+	case StereoCommandList::Cmd_Type_StereoProjection:
+		{
+			const D3DXMATRIX* pMatrices = (const D3DXMATRIX*)pData;
+			return SetStereoProjectionTransform(pMatrices[0], pMatrices[1], true);
+		}
+	case StereoCommandList::Cmd_Type_Viewport:
+		return D3DProxyDevice::SetViewport((const D3DVIEWPORT9*)pData);
+	case StereoCommandList::Cmd_Type_Texture:
+		return D3DProxyDevice::SetTexture(args[0], static_cast<IDirect3DBaseTexture9*>(command.pObject));
+	case StereoCommandList::Cmd_Type_StreamSource:
+		return D3DProxyDevice::SetStreamSource(args[0], static_cast<IDirect3DVertexBuffer9*>(command.pObject), args[1], args[2]);
+	case StereoCommandList::Cmd_Type_StreamSourceFreq:
+		return BaseDirect3DDevice9::SetStreamSourceFreq(args[0], args[1]);
+	case StereoCommandList::Cmd_Type_Indices:
+		return D3DProxyDevice::SetIndices(static_cast<IDirect3DIndexBuffer9*>(command.pObject));
+	case StereoCommandList::Cmd_Type_VertexDeclaration:
+		return D3DProxyDevice::SetVertexDeclaration(static_cast<IDirect3DVertexDeclaration9*>(command.pObject));
+	case StereoCommandList::Cmd_Type_VertexShader:
+		return D3DProxyDevice::SetVertexShader(static_cast<IDirect3DVertexShader9*>(command.pObject));
+	case StereoCommandList::Cmd_Type_PixelShader:
+		return D3DProxyDevice::SetPixelShader(static_cast<IDirect3DPixelShader9*>(command.pObject));
+	case StereoCommandList::Cmd_Type_VertexShaderConstantF:
+		return D3DProxyDevice::SetVertexShaderConstantF(args[0], (const float*)pData, args[1]);
+	case StereoCommandList::Cmd_Type_PixelShaderConstantF:
+		return D3DProxyDevice::SetPixelShaderConstantF(args[0], (const float*)pData, args[1]);
+	}
+
+	OutputDebugString("replayStereoCommand: Unhandled command type.\n");
+	return D3DERR_INVALIDCALL;
 }
\ No newline at end of file
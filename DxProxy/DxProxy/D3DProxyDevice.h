@@ -47,6 +47,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Direct3DPixelShader9.h"
 #include "Direct3DVertexShader9.h"
 #include "Direct3DVertexDeclaration9.h"
+#include "D3D9ProxyVertexDeclaration.h"
 #include "Direct3DQuery9.h"
 
 #include "ProxyHelper.h"
@@ -65,11 +66,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "GameHandler.h"
 #include "ShaderRegisters.h"
 #include "ViewAdjustment.h"
+#include "StereoCommandList.h"
+#include "ProxyCounters.h"
+#include "ProxyProfiler.h"
+#include "CallTrace.h"
 
 #define _SAFE_RELEASE(x) if(x) { x->Release(); x = NULL; } 
 
 class StereoView;
 class D3D9ProxySwapChain;
+class D3D9ProxyStateBlock;
 class ShaderRegisters;
 class GameHandler;
 
@@ -120,11 +126,26 @@ public:
 	virtual HRESULT WINAPI SetTransform(D3DTRANSFORMSTATETYPE State,CONST D3DMATRIX* pMatrix);
 	virtual HRESULT WINAPI MultiplyTransform(D3DTRANSFORMSTATETYPE State,CONST D3DMATRIX* pMatrix);
 	virtual HRESULT WINAPI SetViewport(CONST D3DVIEWPORT9* pViewport);
+	virtual HRESULT WINAPI GetViewport(D3DVIEWPORT9* pViewport);
+	virtual HRESULT WINAPI SetMaterial(CONST D3DMATERIAL9* pMaterial);
+	virtual HRESULT WINAPI SetLight(DWORD Index,CONST D3DLIGHT9* pLight);
+	virtual HRESULT WINAPI LightEnable(DWORD Index,BOOL Enable);
+	virtual HRESULT WINAPI SetClipPlane(DWORD Index,CONST float* pPlane);
+	virtual HRESULT WINAPI SetRenderState(D3DRENDERSTATETYPE State,DWORD Value);
 	virtual HRESULT WINAPI CreateStateBlock(D3DSTATEBLOCKTYPE Type,IDirect3DStateBlock9** ppSB);
 	virtual HRESULT WINAPI BeginStateBlock();
 	virtual HRESULT WINAPI EndStateBlock(IDirect3DStateBlock9** ppSB);
+	virtual HRESULT WINAPI SetClipStatus(CONST D3DCLIPSTATUS9* pClipStatus);
 	virtual HRESULT WINAPI GetTexture(DWORD Stage,IDirect3DBaseTexture9** ppTexture);	
 	virtual HRESULT WINAPI SetTexture(DWORD Stage,IDirect3DBaseTexture9* pTexture);
+	virtual HRESULT WINAPI SetTextureStageState(DWORD Stage,D3DTEXTURESTAGESTATETYPE Type,DWORD Value);
+	virtual HRESULT WINAPI SetSamplerState(DWORD Sampler,D3DSAMPLERSTATETYPE Type,DWORD Value);
+	virtual HRESULT WINAPI SetPaletteEntries(UINT PaletteNumber,CONST PALETTEENTRY* pEntries);
+	virtual HRESULT WINAPI SetCurrentTexturePalette(UINT PaletteNumber);
+	virtual HRESULT WINAPI SetScissorRect(CONST RECT* pRect);
+	virtual HRESULT WINAPI GetScissorRect(RECT* pRect);
+	virtual HRESULT WINAPI SetSoftwareVertexProcessing(BOOL bSoftware);
+	virtual HRESULT WINAPI SetNPatchMode(float nSegments);
 	virtual HRESULT WINAPI DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType,UINT StartVertex,UINT PrimitiveCount);
 	virtual HRESULT WINAPI DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType,INT BaseVertexIndex,UINT MinVertexIndex,UINT NumVertices,UINT startIndex,UINT primCount);
 	virtual HRESULT WINAPI DrawPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType,UINT PrimitiveCount,CONST void* pVertexStreamZeroData,UINT VertexStreamZeroStride);
@@ -133,13 +154,19 @@ public:
 	virtual HRESULT WINAPI CreateVertexDeclaration(CONST D3DVERTEXELEMENT9* pVertexElements,IDirect3DVertexDeclaration9** ppDecl);
 	virtual HRESULT WINAPI SetVertexDeclaration(IDirect3DVertexDeclaration9* pDecl);
 	virtual HRESULT WINAPI GetVertexDeclaration(IDirect3DVertexDeclaration9** ppDecl);
+	virtual HRESULT WINAPI SetFVF(DWORD FVF);
 	virtual HRESULT WINAPI CreateVertexShader(CONST DWORD* pFunction,IDirect3DVertexShader9** ppShader);
 	virtual HRESULT WINAPI SetVertexShader(IDirect3DVertexShader9* pShader);
 	virtual HRESULT WINAPI GetVertexShader(IDirect3DVertexShader9** ppShader);
 	virtual HRESULT WINAPI SetVertexShaderConstantF(UINT StartRegister,CONST float* pConstantData,UINT Vector4fCount);
 	virtual HRESULT WINAPI GetVertexShaderConstantF(UINT StartRegister,float* pData, UINT Vector4fCount);
+	virtual HRESULT WINAPI SetVertexShaderConstantI(UINT StartRegister,CONST int* pConstantData,UINT Vector4iCount);
+	virtual HRESULT WINAPI GetVertexShaderConstantI(UINT StartRegister,int* pConstantData,UINT Vector4iCount);
+	virtual HRESULT WINAPI SetVertexShaderConstantB(UINT StartRegister,CONST BOOL* pConstantData,UINT  BoolCount);
+	virtual HRESULT WINAPI GetVertexShaderConstantB(UINT StartRegister,BOOL* pConstantData,UINT BoolCount);
 	virtual HRESULT WINAPI SetStreamSource(UINT StreamNumber,IDirect3DVertexBuffer9* pStreamData,UINT OffsetInBytes,UINT Stride);
 	virtual HRESULT WINAPI GetStreamSource(UINT StreamNumber,IDirect3DVertexBuffer9** ppStreamData,UINT* pOffsetInBytes,UINT* pStride);
+	virtual HRESULT WINAPI SetStreamSourceFreq(UINT StreamNumber,UINT Setting);
 	virtual HRESULT WINAPI SetIndices(IDirect3DIndexBuffer9* pIndexData);
 	virtual HRESULT WINAPI GetIndices(IDirect3DIndexBuffer9** ppIndexData);
 	virtual HRESULT WINAPI CreatePixelShader(CONST DWORD* pFunction,IDirect3DPixelShader9** ppShader);
@@ -147,10 +174,18 @@ public:
 	virtual HRESULT WINAPI GetPixelShader(IDirect3DPixelShader9** ppShader);
 	virtual HRESULT WINAPI SetPixelShaderConstantF(UINT StartRegister,CONST float* pConstantData,UINT Vector4fCount);
 	virtual HRESULT WINAPI GetPixelShaderConstantF(UINT StartRegister,float* pData, UINT Vector4fCount);
+	virtual HRESULT WINAPI SetPixelShaderConstantI(UINT StartRegister,CONST int* pConstantData,UINT Vector4iCount);
+	virtual HRESULT WINAPI GetPixelShaderConstantI(UINT StartRegister,int* pConstantData,UINT Vector4iCount);
+	virtual HRESULT WINAPI SetPixelShaderConstantB(UINT StartRegister,CONST BOOL* pConstantData,UINT  BoolCount);
+	virtual HRESULT WINAPI GetPixelShaderConstantB(UINT StartRegister,BOOL* pConstantData,UINT BoolCount);
 	virtual HRESULT WINAPI DrawRectPatch(UINT Handle,CONST float* pNumSegs,CONST D3DRECTPATCH_INFO* pRectPatchInfo);
 	virtual HRESULT WINAPI DrawTriPatch(UINT Handle,CONST float* pNumSegs,CONST D3DTRIPATCH_INFO* pTriPatchInfo);
+	virtual HRESULT WINAPI DeletePatch(UINT Handle);
 	virtual HRESULT WINAPI CreateQuery(D3DQUERYTYPE Type,IDirect3DQuery9** ppQuery);
 
+	/*** BaseDirect3DDevice9 methods ***/
+	virtual void FlushPendingCommands();
+
 	/*** D3DProxyDevice public methods ***/
 	HRESULT WINAPI CreateRenderTarget(UINT Width, UINT Height, D3DFORMAT Format, D3DMULTISAMPLE_TYPE MultiSample, DWORD MultisampleQuality,BOOL Lockable,IDirect3DSurface9** ppSurface,HANDLE* pSharedHandle, bool isBackBufferOfPrimarySwapChain);
 	virtual void   Init(ProxyHelper::ProxyConfig& cfg);
@@ -201,6 +236,7 @@ public:
 		HUD_CALIBRATION,
 		GUI_CALIBRATION,
 		OVERALL_SETTINGS,
+		PROXY_STATISTICS,
 		BRASSA_ENUM_RANGE
 	};
 	/**
@@ -345,10 +381,43 @@ private:
 	void    BRASSA_HUD();
 	void    BRASSA_GUI();
 	void    BRASSA_Settings();
+	void    BRASSA_Statistics();
 	bool    isViewportDefaultForMainRT(CONST D3DVIEWPORT9* pViewport);
 	HRESULT SetStereoViewTransform(D3DXMATRIX pLeftMatrix, D3DXMATRIX pRightMatrix, bool apply);
 	HRESULT SetStereoProjectionTransform(D3DXMATRIX pLeftMatrix, D3DXMATRIX pRightMatrix, bool apply);
+	void    storeActiveTexture(int samplerIndex, IDirect3DBaseTexture9* pTexture);
+	void    storeActiveVertexBuffer(UINT streamNumber, BaseDirect3DVertexBuffer9* pVertexBuffer);
+	bool    isRecordingStereoCommands();
+	bool    isTracingCalls();
+	void    captureRestoreState(StereoCommandList::CommandTypes type, DWORD index);
+	HRESULT replayStereoCommand(const StereoCommandList::Command& command);
+	bool    isDrawMono();
+	bool    prepareStereoDraw();
+	void    resolveRenderTargets();
+	bool    drawInstancedStereo(D3DPRIMITIVETYPE PrimitiveType, INT BaseVertexIndex, UINT MinVertexIndex, UINT NumVertices, UINT startIndex, UINT primCount, bool sequentialIndices, HRESULT* pResult);
+	void    restoreInstancedStereoState();
+	bool    canUseSideBySide();
+	bool    startSideBySidePass(DWORD Count, CONST D3DRECT* pRects, DWORD Flags);
+	void    beginSideBySidePass();
+	void    endSideBySidePass();
+	void    updateSideBySidePass();
+	void    leaveSideBySidePassFor(IDirect3DSurface9* pSurface);
+	void    applySideBySideViewport(vireio::RenderPosition side);
+	HRESULT clearSideBySide(DWORD Count, CONST D3DRECT* pRects, DWORD Flags, D3DCOLOR Color, float Z, DWORD Stencil);
+	void    prepareActualStateBlock();
+	void    finishActualStateBlock();
 
+	/**
+	* Proxy overhead counters, published once per Present.
+	* Declared before the shader registers, which count into the current frame (and are destroyed first).
+	* @see ProxyCounters
+	**/
+	ProxyCounters m_counters;
+	/**
+	* Call stream capture, toggled by hotkey.
+	* @see CallTrace
+	**/
+	CallTrace m_callTrace;
 	/**
 	* The game handler.
 	* @see GameHandler
@@ -402,18 +471,24 @@ private:
 	***/
 	std::vector<D3D9ProxySurface*> m_activeRenderTargets;	
 	/**
-	* Textures assigned to stages. 
-	* (NULL is a valid entry in these containers. It indicates that the application has specifically 
-	* cleared that stream/sampler. It is important that this information is available to the proxy 
-	* StateBlock)
+	* Textures assigned to stages, indexed by vireio::SamplerIndex(). 
+	* (NULL if no texture is set)
+	* Change using storeActiveTexture() only, to keep m_stereoTextureStages up to date.
 	* @see SetTexture()
 	* @see GetTexture()
 	**/
-	std::unordered_map<DWORD, IDirect3DBaseTexture9*> m_activeTextureStages;
+	IDirect3DBaseTexture9* m_activeTextureStages[SAMPLER_COUNT];
 	/**
-	* Active stored vertex buffers.
+	* Bitmask of the stages holding stereo textures, bit n set for vireio::SamplerIndex() n.
+	* Only these stages are changed when switching the drawing side.
+	* @see setDrawingSide()
 	**/
-	std::unordered_map<UINT, BaseDirect3DVertexBuffer9*> m_activeVertexBuffers;
+	DWORD m_stereoTextureStages;
+	/**
+	* Active stored vertex buffers, indexed by stream number.
+	* (NULL if no vertex buffer is set)
+	**/
+	BaseDirect3DVertexBuffer9* m_activeVertexBuffers[STREAM_COUNT];
 	/**
 	* True if BeginStateBlock() is called, false if EndStateBlock is called.
 	* @see BeginStateBlock()
@@ -455,6 +530,73 @@ private:
 	**/
 	D3DXMATRIX* m_pCurrentProjection;
 	/**
+	* Commands recorded for the other eye since the last render target change.
+	* @see FlushPendingCommands()
+	***/
+	StereoCommandList m_stereoCommands;
+	/**
+	* True if draws are recorded and replayed for the other eye (game profile "deferredRightEye").
+	* False to draw both eyes immediately on every draw call.
+	***/
+	bool m_bDeferredRightEye;
+	/**
+	* True while FlushPendingCommands() replays the recorded commands.
+	***/
+	bool m_bReplayingStereoCommands;
+	/**
+	* True if mono draws are only drawn for one side (game profile "monoDrawElision").
+	* @see prepareStereoDraw()
+	***/
+	bool m_bMonoDrawElision;
+	/**
+	* True if draws are drawn for both eyes at once into side-by-side render targets where possible
+	* (game profile "instancedStereo").
+	* @see drawInstancedStereo()
+	***/
+	bool m_bInstancedStereo;
+	/**
+	* Float vertex shader constant registers of the device, the instanced stereo shaders read the right
+	* stereo constants from free registers below.
+	***/
+	UINT m_maxVertexShaderConst;
+	/**
+	* Per instance (eye) data of instanced stereo draws, two FLOAT4 elements.
+	* @see StereoShaderPatcher::InstanceData()
+	***/
+	IDirect3DVertexBuffer9* m_pInstancedStereoBuffer;
+	/**
+	* Sequential 16 bit indices (0, 1, 2, ...), DrawPrimitive() is drawn instanced as an indexed draw
+	* through them (Direct3D 9 instancing needs indexed draws).
+	***/
+	IDirect3DIndexBuffer9* m_pSequentialIndices;
+	/**
+	* True while the side-by-side surfaces of the primary render target and depth stencil are bound
+	* on the actual device, the current side is drawn through the viewport of its half.
+	* @see beginSideBySidePass()
+	***/
+	bool m_bSideBySidePass;
+	/**
+	* True if the instanced stereo shaders, declaration and viewport are still bound on the actual device.
+	* @see restoreInstancedStereoState()
+	***/
+	bool m_bInstancedStereoBound;
+	/**
+	* Width of a side (half the width of the side-by-side surfaces) in the side-by-side pass.
+	***/
+	UINT m_sideBySideWidth;
+	/**
+	* Height of the side-by-side surfaces in the side-by-side pass.
+	***/
+	UINT m_sideBySideHeight;
+	/**
+	* Last scissor rectangle set by the game, untranslated (only tracked in instanced stereo mode).
+	***/
+	RECT m_LastScissorRect;
+	/**
+	* Clear rectangles moved to the right half, reused by clearSideBySide().
+	***/
+	std::vector<D3DRECT> m_sideBySideRects;
+	/**
 	* Main menu sprite.
 	***/
 	LPD3DXSPRITE hudMainMenu;
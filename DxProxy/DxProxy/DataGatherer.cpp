@@ -89,7 +89,9 @@ DataGatherer::DataGatherer(IDirect3DDevice9* pDevice, BaseDirect3D9* pCreatedBy)
 	m_recordedVShaders(),
 	m_recordedPShaders(),
 	m_startAnalyzingTool(false),
-	m_analyzingFrameCounter(0)
+	m_analyzingFrameCounter(0),
+	m_wvpMatrixNameMatcher(),
+	m_wvpMatrixAvoidedMatcher()
 {
 	m_shaderDumpFile.open("shaderDump.csv", std::ios::out);
 
@@ -100,6 +102,14 @@ DataGatherer::DataGatherer(IDirect3DDevice9* pDevice, BaseDirect3D9* pCreatedBy)
 	m_wvpMatrixConstantNames = names;
 	static std::string avoid[] = { "Inv", "inv" };
 	m_wvpMatrixAvoidedSubstrings = avoid;
+
+	// compile both name arrays, partial matches
+	for (int i = 0; i < MATRIX_NAMES; i++)
+		m_wvpMatrixNameMatcher.AddPattern(m_wvpMatrixConstantNames[i], true, 0);
+	m_wvpMatrixNameMatcher.Compile();
+	for (int i = 0; i < AVOID_SUBSTRINGS; i++)
+		m_wvpMatrixAvoidedMatcher.AddPattern(m_wvpMatrixAvoidedSubstrings[i], true, 0);
+	m_wvpMatrixAvoidedMatcher.Compile();
 }
 
 /**
@@ -229,8 +239,6 @@ HRESULT WINAPI DataGatherer::CreateVertexShader(CONST DWORD* pFunction,IDirect3D
 		if (m_recordedVShaders.insert(pActualShader).second && m_shaderDumpFile.is_open()) {
 
 			// insertion succeeded - record shader details.
-			LPD3DXCONSTANTTABLE pConstantTable = NULL;
-
 			BYTE* pData = NULL;
 			UINT pSizeOfData;
 			pActualShader->GetFunction(NULL, &pSizeOfData);
@@ -241,69 +249,55 @@ HRESULT WINAPI DataGatherer::CreateVertexShader(CONST DWORD* pFunction,IDirect3D
 			uint32_t hash = 0;
 			MurmurHash3_x86_32(pData, pSizeOfData, VIREIO_SEED, &hash); 
 
-			D3DXGetShaderConstantTable(reinterpret_cast<DWORD*>(pData), &pConstantTable);
-
-			if(pConstantTable == NULL) 
+			ShaderBytecode bytecode;
+			if (!bytecode.Parse(pData, pSizeOfData) || !bytecode.HasConstantTable()) {
+				delete[] pData;
 				return creationResult;
+			}
 
-			D3DXCONSTANTTABLE_DESC pDesc;
-			pConstantTable->GetDesc(&pDesc);
-
-			D3DXCONSTANT_DESC pConstantDesc[512];
-			UINT pConstantNum = 512;
+			// if data found, add to vertex shader call count map
+			bool dataFound = false;
 
-			for(UINT i = 0; i < pDesc.Constants; i++)
+			// loop through constants, output relevant data
+			const std::vector<ShaderBytecode::Constant>& constants = bytecode.Constants();
+			for (auto itConstant = constants.begin(); itConstant != constants.end(); ++itConstant)
 			{
-				D3DXHANDLE handle = pConstantTable->GetConstant(NULL,i);
-				if(handle == NULL) continue;
+				if ((itConstant->registerSet == ShaderBytecode::RegisterSet_Float4) &&
+					((itConstant->parameterClass == D3DXPC_VECTOR) || (itConstant->parameterClass == D3DXPC_MATRIX_ROWS) || (itConstant->parameterClass == D3DXPC_MATRIX_COLUMNS))  ) {
 
-				pConstantTable->GetConstantDesc(handle, pConstantDesc, &pConstantNum);
-				if (pConstantNum >= 512) {
-					OutputDebugString("Need larger constant description buffer");
-				}
+						m_shaderDumpFile << hash;
+						m_shaderDumpFile << "," << itConstant->name;
 
-				// if data found, add to vertex shader call count map
-				bool dataFound = false;
+						if (itConstant->parameterClass == D3DXPC_VECTOR) {
+							m_shaderDumpFile << ",Vector";
+						}
+						else if (itConstant->parameterClass == D3DXPC_MATRIX_ROWS) {
+							m_shaderDumpFile << ",MatrixR";
+						}
+						else if (itConstant->parameterClass == D3DXPC_MATRIX_COLUMNS) {
+							m_shaderDumpFile << ",MatrixC";
+						}
 
-				// loop through constants, output relevant data
-				for(UINT j = 0; j < pConstantNum; j++)
-				{
-					if ((pConstantDesc[j].RegisterSet == D3DXRS_FLOAT4) &&
-						((pConstantDesc[j].Class == D3DXPC_VECTOR) || (pConstantDesc[j].Class == D3DXPC_MATRIX_ROWS) || (pConstantDesc[j].Class == D3DXPC_MATRIX_COLUMNS))  ) {
-
-							m_shaderDumpFile << hash;
-							m_shaderDumpFile << "," << pConstantDesc[j].Name;
-
-							if (pConstantDesc[j].Class == D3DXPC_VECTOR) {
-								m_shaderDumpFile << ",Vector";
-							}
-							else if (pConstantDesc[j].Class == D3DXPC_MATRIX_ROWS) {
-								m_shaderDumpFile << ",MatrixR";
-							}
-							else if (pConstantDesc[j].Class == D3DXPC_MATRIX_COLUMNS) {
-								m_shaderDumpFile << ",MatrixC";
-							}
-
-							m_shaderDumpFile << "," << pConstantDesc[j].RegisterIndex;
-							m_shaderDumpFile << "," << pConstantDesc[j].RegisterCount << ",VS" << std::endl;
-
-							dataFound = true;
-
-							// add constant to relevant constant vector
-							ShaderConstant sc;
-							sc.hash = hash;
-							sc.desc = D3DXCONSTANT_DESC(pConstantDesc[j]);
-							sc.name = std::string(pConstantDesc[j].Name);
-							sc.transposed = false;
-							m_relevantVSConstants.push_back(sc);
-					}
-				}
+						m_shaderDumpFile << "," << itConstant->registerIndex;
+						m_shaderDumpFile << "," << itConstant->registerCount << ",VS" << std::endl;
+
+						dataFound = true;
 
-				// shader contains relevant data, so add to call count map
-				if (dataFound)
-					m_vertexShaderCallCount.insert(std::pair<UINT, UINT>(hash, 0));
+						// add constant to relevant constant vector
+						ShaderConstant sc;
+						sc.hash = hash;
+						sc.desc = *itConstant;
+						sc.desc.name = NULL;
+						sc.name = std::string(itConstant->name);
+						sc.transposed = false;
+						m_relevantVSConstants.push_back(sc);
+				}
 			}
 
+			// shader contains relevant data, so add to call count map
+			if (dataFound)
+				m_vertexShaderCallCount.insert(std::pair<UINT, UINT>(hash, 0));
+
 #ifdef _DEBUG
 			// optionally, output shader code to "VS(hash).txt"
 			char buf[32]; ZeroMemory(&buf[0],32);
@@ -316,13 +310,12 @@ HRESULT WINAPI DataGatherer::CreateVertexShader(CONST DWORD* pFunction,IDirect3D
 				D3DXDisassembleShader(reinterpret_cast<DWORD*>(pData),NULL,NULL,&bOut); 
 				oLogFile << static_cast<char*>(bOut->GetBufferPointer()) << std::endl;
 				oLogFile << std::endl << std::endl;
-				oLogFile << "// Shader Creator: " << pDesc.Creator << std::endl;
-				oLogFile << "// Shader Version: " << pDesc.Version << std::endl;
+				oLogFile << "// Shader Creator: " << bytecode.Creator() << std::endl;
+				oLogFile << "// Shader Version: " << bytecode.Version() << std::endl;
 				oLogFile << "// Shader Hash   : " << hash << std::endl;
 			}
 #endif
 
-			_SAFE_RELEASE(pConstantTable);
 			if (pData) delete[] pData;
 		}
 		// else shader already recorded
@@ -368,17 +361,17 @@ HRESULT WINAPI DataGatherer::SetVertexShaderConstantF(UINT StartRegister,CONST f
 		// is a constant of current shader ?
 		// start register ? 
 		if ((itShaderConstants->hash == m_currentVertexShaderHash) &&
-			(itShaderConstants->desc.RegisterIndex < (StartRegister+Vector4fCount)) &&
-			(itShaderConstants->desc.RegisterIndex >= StartRegister))
+			(itShaderConstants->desc.registerIndex < (StartRegister+Vector4fCount)) &&
+			(itShaderConstants->desc.registerIndex >= StartRegister))
 		{	
 			// is a matrix ?
-			if (itShaderConstants->desc.Class == D3DXPARAMETER_CLASS::D3DXPC_MATRIX_ROWS)
+			if (itShaderConstants->desc.parameterClass == D3DXPARAMETER_CLASS::D3DXPC_MATRIX_ROWS)
 			{
 				// Perspective projection matrices have in the last column (0,0,1,0) if left-handed and 
 				// * (0,0,-1,0) if right-handed.
 				// Note that we DO NOT TEST here wether this is actually a projection matrix
 				// (we do that in the analyze() method)
-				D3DXMATRIX matrix = D3DXMATRIX(pConstantData+((itShaderConstants->desc.RegisterIndex-StartRegister)*4*sizeof(float)));
+				D3DXMATRIX matrix = D3DXMATRIX(pConstantData+((itShaderConstants->desc.registerIndex-StartRegister)*4*sizeof(float)));
 
 				// [14] for row matrix ??
 				if ((vireio::AlmostSame(matrix[14], 1.0f, 0.00001f)) || (vireio::AlmostSame(matrix[14], -1.0f, 0.00001f)))
@@ -387,13 +380,13 @@ HRESULT WINAPI DataGatherer::SetVertexShaderConstantF(UINT StartRegister,CONST f
 					itShaderConstants->transposed = true;
 
 			}
-			else if (itShaderConstants->desc.Class == D3DXPARAMETER_CLASS::D3DXPC_MATRIX_COLUMNS)
+			else if (itShaderConstants->desc.parameterClass == D3DXPARAMETER_CLASS::D3DXPC_MATRIX_COLUMNS)
 			{
 				// Perspective projection matrices have in the last column (0,0,1,0) if left-handed and 
 				// * (0,0,-1,0) if right-handed.
 				// Note that we DO NOT TEST here wether this is actually a projection matrix
 				// (we do that in the analyze() method)
-				D3DXMATRIX matrix = D3DXMATRIX(pConstantData+((itShaderConstants->desc.RegisterIndex-StartRegister)*4*sizeof(float)));
+				D3DXMATRIX matrix = D3DXMATRIX(pConstantData+((itShaderConstants->desc.registerIndex-StartRegister)*4*sizeof(float)));
 
 				// [12] for column matrix ??
 				if ((vireio::AlmostSame(matrix[12], 1.0f, 0.00001f)) || (vireio::AlmostSame(matrix[12], -1.0f, 0.00001f)))
@@ -426,8 +419,6 @@ HRESULT WINAPI DataGatherer::CreatePixelShader(CONST DWORD* pFunction,IDirect3DP
 		if (m_recordedPShaders.insert(pActualShader).second && m_shaderDumpFile.is_open()) {
 
 			// insertion succeeded - record shader details.
-			LPD3DXCONSTANTTABLE pConstantTable = NULL;
-
 			BYTE* pData = NULL;
 			UINT pSizeOfData;
 			pActualShader->GetFunction(NULL, &pSizeOfData);
@@ -438,69 +429,55 @@ HRESULT WINAPI DataGatherer::CreatePixelShader(CONST DWORD* pFunction,IDirect3DP
 			uint32_t hash = 0;
 			MurmurHash3_x86_32(pData, pSizeOfData, VIREIO_SEED, &hash); 
 
-			D3DXGetShaderConstantTable(reinterpret_cast<DWORD*>(pData), &pConstantTable);
-
-			if(pConstantTable == NULL) 
+			ShaderBytecode bytecode;
+			if (!bytecode.Parse(pData, pSizeOfData) || !bytecode.HasConstantTable()) {
+				delete[] pData;
 				return creationResult;
+			}
 
-			D3DXCONSTANTTABLE_DESC pDesc;
-			pConstantTable->GetDesc(&pDesc);
-
-			D3DXCONSTANT_DESC pConstantDesc[512];
-			UINT pConstantNum = 512;
+			// if data found, add to vertex shader call count map
+			bool dataFound = false;
 
-			for(UINT i = 0; i < pDesc.Constants; i++)
+			// loop through constants, output relevant data
+			const std::vector<ShaderBytecode::Constant>& constants = bytecode.Constants();
+			for (auto itConstant = constants.begin(); itConstant != constants.end(); ++itConstant)
 			{
-				D3DXHANDLE handle = pConstantTable->GetConstant(NULL,i);
-				if(handle == NULL) continue;
+				if ((itConstant->registerSet == ShaderBytecode::RegisterSet_Float4) &&
+					((itConstant->parameterClass == D3DXPC_VECTOR) || (itConstant->parameterClass == D3DXPC_MATRIX_ROWS) || (itConstant->parameterClass == D3DXPC_MATRIX_COLUMNS))  ) {
 
-				pConstantTable->GetConstantDesc(handle, pConstantDesc, &pConstantNum);
-				if (pConstantNum >= 512) {
-					OutputDebugString("Need larger constant description buffer");
-				}
+						m_shaderDumpFile << hash;
+						m_shaderDumpFile << "," << itConstant->name;
 
-				// if data found, add to vertex shader call count map
-				bool dataFound = false;
+						if (itConstant->parameterClass == D3DXPC_VECTOR) {
+							m_shaderDumpFile << ",Vector";
+						}
+						else if (itConstant->parameterClass == D3DXPC_MATRIX_ROWS) {
+							m_shaderDumpFile << ",MatrixR";
+						}
+						else if (itConstant->parameterClass == D3DXPC_MATRIX_COLUMNS) {
+							m_shaderDumpFile << ",MatrixC";
+						}
 
-				// loop through constants, output relevant data
-				for(UINT j = 0; j < pConstantNum; j++)
-				{
-					if ((pConstantDesc[j].RegisterSet == D3DXRS_FLOAT4) &&
-						((pConstantDesc[j].Class == D3DXPC_VECTOR) || (pConstantDesc[j].Class == D3DXPC_MATRIX_ROWS) || (pConstantDesc[j].Class == D3DXPC_MATRIX_COLUMNS))  ) {
-
-							m_shaderDumpFile << hash;
-							m_shaderDumpFile << "," << pConstantDesc[j].Name;
-
-							if (pConstantDesc[j].Class == D3DXPC_VECTOR) {
-								m_shaderDumpFile << ",Vector";
-							}
-							else if (pConstantDesc[j].Class == D3DXPC_MATRIX_ROWS) {
-								m_shaderDumpFile << ",MatrixR";
-							}
-							else if (pConstantDesc[j].Class == D3DXPC_MATRIX_COLUMNS) {
-								m_shaderDumpFile << ",MatrixC";
-							}
-
-							m_shaderDumpFile << "," << pConstantDesc[j].RegisterIndex;
-							m_shaderDumpFile << "," << pConstantDesc[j].RegisterCount << ",PS" << std::endl;
-
-							dataFound = true;
-
-							// add constant to relevant constant vector
-							ShaderConstant sc;
-							sc.hash = hash;
-							sc.desc = D3DXCONSTANT_DESC(pConstantDesc[j]);
-							sc.name = std::string(pConstantDesc[j].Name);
-							sc.transposed = false;
-							m_relevantVSConstants.push_back(sc);
-					}
-				}
+						m_shaderDumpFile << "," << itConstant->registerIndex;
+						m_shaderDumpFile << "," << itConstant->registerCount << ",PS" << std::endl;
 
-				// shader contains relevant data, so add to call count map
-				if (dataFound)
-					m_vertexShaderCallCount.insert(std::pair<UINT, UINT>(hash, 0));
+						dataFound = true;
+
+						// add constant to relevant constant vector
+						ShaderConstant sc;
+						sc.hash = hash;
+						sc.desc = *itConstant;
+						sc.desc.name = NULL;
+						sc.name = std::string(itConstant->name);
+						sc.transposed = false;
+						m_relevantVSConstants.push_back(sc);
+				}
 			}
 
+			// shader contains relevant data, so add to call count map
+			if (dataFound)
+				m_vertexShaderCallCount.insert(std::pair<UINT, UINT>(hash, 0));
+
 #ifdef _DEBUG
 			// optionally, output shader code to "PS(hash).txt"
 			char buf[32]; ZeroMemory(&buf[0],32);
@@ -513,13 +490,12 @@ HRESULT WINAPI DataGatherer::CreatePixelShader(CONST DWORD* pFunction,IDirect3DP
 				D3DXDisassembleShader(reinterpret_cast<DWORD*>(pData),NULL,NULL,&bOut); 
 				oLogFile << static_cast<char*>(bOut->GetBufferPointer()) << std::endl;
 				oLogFile << std::endl << std::endl;
-				oLogFile << "// Shader Creator: " << pDesc.Creator << std::endl;
-				oLogFile << "// Shader Version: " << pDesc.Version << std::endl;
+				oLogFile << "// Shader Creator: " << bytecode.Creator() << std::endl;
+				oLogFile << "// Shader Version: " << bytecode.Version() << std::endl;
 				oLogFile << "// Shader Hash   : " << hash << std::endl;
 			}
 #endif
 
-			_SAFE_RELEASE(pConstantTable);
 			if (pData) delete[] pData;
 		}
 		// else shader already recorded
@@ -593,76 +569,54 @@ void DataGatherer::Analyze()
 	auto itShaderConstants = m_relevantVSConstants.begin();
 	while (itShaderConstants != m_relevantVSConstants.end())
 	{
-		// loop through matrix constant name assumptions
-		for (int i = 0; i < MATRIX_NAMES; i++)
+		// test if a matrix constant name assumption is found in the constant name, but no "to-be-avoided" assumption
+		if (m_wvpMatrixNameMatcher.MatchesAny(itShaderConstants->name.c_str()))
 		{
-			// test if assumption is found in constant name
-			if (strstr(itShaderConstants->name.c_str(), m_wvpMatrixConstantNames[i].c_str()) != 0)
+			if (!m_wvpMatrixAvoidedMatcher.MatchesAny(itShaderConstants->name.c_str()))
 			{
-				// test for "to-be-avoided" assumptions
-				for (int j = 0; j < AVOID_SUBSTRINGS; j++)
+				auto itRelevantShaders = m_vertexShaderCallCount.begin();
+				while (itRelevantShaders != m_vertexShaderCallCount.end())
 				{
-					if (strstr(itShaderConstants->name.c_str(), m_wvpMatrixAvoidedSubstrings[j].c_str()) != 0)
+					// was the shader used last frame ?
+					if ((itRelevantShaders->first == itShaderConstants->hash) && (itRelevantShaders->second > 0))
 					{
-						// break loop
-						i = MATRIX_NAMES;
-						break;
-					}
-				}
-
-				// still in loop ?
-				if (i < MATRIX_NAMES)
-				{
-					auto itRelevantShaders = m_vertexShaderCallCount.begin();
-					while (itRelevantShaders != m_vertexShaderCallCount.end())
-					{
-						// was the shader used last frame ?
-						if ((itRelevantShaders->first == itShaderConstants->hash) && (itRelevantShaders->second > 0))
+						// add this rule !!!!
+						if (addRule(itShaderConstants->name, true, itShaderConstants->desc.registerIndex, (D3DXPARAMETER_CLASS)itShaderConstants->desc.parameterClass, 2, itShaderConstants->transposed))
+							m_addedVSConstants.push_back(*itShaderConstants);
+
+						// output debug data
+						OutputDebugString("---Shader Rule");
+						// output constant name
+						OutputDebugString(itShaderConstants->name.c_str());
+						// output shader constant + index 
+						switch(itShaderConstants->desc.parameterClass)
 						{
-							// add this rule !!!!
-							if (addRule(itShaderConstants->name, true, itShaderConstants->desc.RegisterIndex, itShaderConstants->desc.Class, 2, itShaderConstants->transposed))
-								m_addedVSConstants.push_back(*itShaderConstants);
-
-							// output debug data
-							OutputDebugString("---Shader Rule");
-							// output constant name
-							OutputDebugString(itShaderConstants->desc.Name);
-							// output shader constant + index 
-							switch(itShaderConstants->desc.Class)
-							{
-							case D3DXPC_VECTOR:
-								OutputDebugString("D3DXPC_VECTOR");
-								break;
-							case D3DXPC_MATRIX_ROWS:
-								OutputDebugString("D3DXPC_MATRIX_ROWS");
-								break;
-							case D3DXPC_MATRIX_COLUMNS:
-								OutputDebugString("D3DXPC_MATRIX_COLUMNS");
-								break;
-							}
-							char buf[32];
-							sprintf_s(buf,"Register Index: %d", itShaderConstants->desc.RegisterIndex);
-							OutputDebugString(buf);
-							sprintf_s(buf,"Shader Hash: %u", itShaderConstants->hash);
-							OutputDebugString(buf);
-							sprintf_s(buf,"Transposed: %d", itShaderConstants->transposed);
-							OutputDebugString(buf);
+						case D3DXPC_VECTOR:
+							OutputDebugString("D3DXPC_VECTOR");
+							break;
+						case D3DXPC_MATRIX_ROWS:
+							OutputDebugString("D3DXPC_MATRIX_ROWS");
+							break;
+						case D3DXPC_MATRIX_COLUMNS:
+							OutputDebugString("D3DXPC_MATRIX_COLUMNS");
+							break;
 						}
-
-						++itRelevantShaders;
+						char buf[32];
+						sprintf_s(buf,"Register Index: %d", itShaderConstants->desc.registerIndex);
+						OutputDebugString(buf);
+						sprintf_s(buf,"Shader Hash: %u", itShaderConstants->hash);
+						OutputDebugString(buf);
+						sprintf_s(buf,"Transposed: %d", itShaderConstants->transposed);
+						OutputDebugString(buf);
 					}
 
-					// end loop
-					i = MATRIX_NAMES;
+					++itRelevantShaders;
 				}
 			}
-			else
-				if (itShaderConstants->desc.RegisterIndex == 128)
-				{
-					OutputDebugString(itShaderConstants->name.c_str());
-					OutputDebugString(m_wvpMatrixConstantNames[i].c_str());
-				}
 		}
+		else
+			if (itShaderConstants->desc.registerIndex == 128)
+				OutputDebugString(itShaderConstants->name.c_str());
 
 		++itShaderConstants;
 	}
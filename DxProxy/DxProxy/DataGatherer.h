@@ -35,6 +35,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ProxyHelper.h"
 #include "MurmurHash3.h"
 #include "Direct3DVertexShader9.h"
+#include "ConstantNameMatcher.h"
+#include "ShaderBytecode.h"
 
 /**
 * Data gatherer class, outputs relevant shader data to dump file (.csv format) .
@@ -75,9 +77,9 @@ private:
 	struct ShaderConstant
 	{
 		std::string name;
-		UINT hash;              /**< The shader hash. */
-		D3DXCONSTANT_DESC desc; /**< The constant description. */
-		bool transposed;        /**< True if this constant is a transposed matrix. */
+		UINT hash;                     /**< The shader hash. */
+		ShaderBytecode::Constant desc; /**< The constant description (desc.name is not kept, use name). */
+		bool transposed;               /**< True if this constant is a transposed matrix. */
 	};
 	/**
 	* Vector of all relevant vertex shader constants.
@@ -96,6 +98,14 @@ private:
 	***/
 	std::string* m_wvpMatrixAvoidedSubstrings;
 	/**
+	* Matcher compiled from the world-view-projection matrix constant names.
+	***/
+	ConstantNameMatcher m_wvpMatrixNameMatcher;
+	/**
+	* Matcher compiled from the matrix substring names to be avoided.
+	***/
+	ConstantNameMatcher m_wvpMatrixAvoidedMatcher;
+	/**
 	* True if analyzing tool is activated.
 	***/
 	bool m_startAnalyzingTool;
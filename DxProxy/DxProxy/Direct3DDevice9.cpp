@@ -266,6 +266,7 @@ UINT WINAPI BaseDirect3DDevice9::GetNumberOfSwapChains()
 
 /**
 * Base Reset functionality.
+* Invalidates the shadow state.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::Reset(D3DPRESENT_PARAMETERS* pPresentationParameters)
 {
@@ -273,11 +274,15 @@ HRESULT WINAPI BaseDirect3DDevice9::Reset(D3DPRESENT_PARAMETERS* pPresentationPa
 	m_logFile << "Reset" << std::endl;
 #endif
 
+	// all states are set to default (or unknown if the reset fails)
+	m_shadowState.Invalidate();
+
 	return m_pDevice->Reset(pPresentationParameters);
 }
 
 /**
 * Base Present functionality.
+* Starts counting filtered calls for the next frame.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::Present(CONST RECT* pSourceRect,CONST RECT* pDestRect,HWND hDestWindowOverride,CONST RGNDATA* pDirtyRegion)
 {
@@ -285,6 +290,8 @@ HRESULT WINAPI BaseDirect3DDevice9::Present(CONST RECT* pSourceRect,CONST RECT*
 	m_logFile << "Present" << std::endl;
 #endif
 
+	m_shadowState.NewFrame();
+
 	return m_pDevice->Present( pSourceRect, pDestRect, hDestWindowOverride, pDirtyRegion);
 }
 
@@ -518,6 +525,7 @@ HRESULT WINAPI BaseDirect3DDevice9::CreateOffscreenPlainSurface(UINT Width,UINT
 
 /**
 * Base SetRenderTarget functionality.
+* Dropped if the render target is already set (except render target 0).
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::SetRenderTarget(DWORD RenderTargetIndex,IDirect3DSurface9* pRenderTarget)
 {
@@ -525,7 +533,14 @@ HRESULT WINAPI BaseDirect3DDevice9::SetRenderTarget(DWORD RenderTargetIndex,IDir
 	m_logFile << "SetRenderTarget" << std::endl;
 #endif
 
-	return m_pDevice->SetRenderTarget(RenderTargetIndex, pRenderTarget);
+	if (m_shadowState.FilterRenderTarget(RenderTargetIndex, pRenderTarget))
+		return D3D_OK;
+
+	HRESULT result = m_pDevice->SetRenderTarget(RenderTargetIndex, pRenderTarget);
+	if (SUCCEEDED(result))
+		m_shadowState.StoreRenderTarget(RenderTargetIndex, pRenderTarget);
+
+	return result;
 }
 
 /**
@@ -542,6 +557,7 @@ HRESULT WINAPI BaseDirect3DDevice9::GetRenderTarget(DWORD RenderTargetIndex,IDir
 
 /**
 * Base SetDepthStencilSurface functionality.
+* Dropped if the depth stencil is already set.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::SetDepthStencilSurface(IDirect3DSurface9* pNewZStencil)
 {
@@ -549,7 +565,14 @@ HRESULT WINAPI BaseDirect3DDevice9::SetDepthStencilSurface(IDirect3DSurface9* pN
 	m_logFile << "SetDepthStencilSurface" << std::endl;
 #endif
 
-	return m_pDevice->SetDepthStencilSurface(pNewZStencil);
+	if (m_shadowState.FilterDepthStencilSurface(pNewZStencil))
+		return D3D_OK;
+
+	HRESULT result = m_pDevice->SetDepthStencilSurface(pNewZStencil);
+	if (SUCCEEDED(result))
+		m_shadowState.StoreDepthStencilSurface(pNewZStencil);
+
+	return result;
 }
 
 /**
@@ -602,6 +625,7 @@ HRESULT WINAPI BaseDirect3DDevice9::Clear(DWORD Count,CONST D3DRECT* pRects,DWOR
 
 /**
 * Base SetTransform functionality.
+* Dropped if the matrix is already set.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::SetTransform(D3DTRANSFORMSTATETYPE State,CONST D3DMATRIX* pMatrix)
 {
@@ -609,7 +633,14 @@ HRESULT WINAPI BaseDirect3DDevice9::SetTransform(D3DTRANSFORMSTATETYPE State,CON
 	m_logFile << "SetTransform" << std::endl;
 #endif
 
-	return m_pDevice->SetTransform(State, pMatrix);
+	if (m_shadowState.FilterTransform(State, pMatrix))
+		return D3D_OK;
+
+	HRESULT result = m_pDevice->SetTransform(State, pMatrix);
+	if (SUCCEEDED(result))
+		m_shadowState.StoreTransform(State, pMatrix);
+
+	return result;
 }
 
 /**
@@ -638,6 +669,7 @@ HRESULT WINAPI BaseDirect3DDevice9::MultiplyTransform(D3DTRANSFORMSTATETYPE Stat
 
 /**
 * Base SetViewport functionality.
+* Dropped if the viewport is already set.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::SetViewport(CONST D3DVIEWPORT9* pViewport)
 {
@@ -645,7 +677,14 @@ HRESULT WINAPI BaseDirect3DDevice9::SetViewport(CONST D3DVIEWPORT9* pViewport)
 	m_logFile << "SetViewport" << std::endl;
 #endif
 
-	return m_pDevice->SetViewport(pViewport);
+	if (m_shadowState.FilterViewport(pViewport))
+		return D3D_OK;
+
+	HRESULT result = m_pDevice->SetViewport(pViewport);
+	if (SUCCEEDED(result))
+		m_shadowState.StoreViewport(pViewport);
+
+	return result;
 }
 
 /**
@@ -758,6 +797,7 @@ HRESULT WINAPI BaseDirect3DDevice9::GetClipPlane(DWORD Index,float* pPlane)
 
 /**
 * Base SetRenderState functionality.
+* Dropped if the render state already has that value.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::SetRenderState(D3DRENDERSTATETYPE State,DWORD Value)
 {
@@ -765,7 +805,14 @@ HRESULT WINAPI BaseDirect3DDevice9::SetRenderState(D3DRENDERSTATETYPE State,DWOR
 	m_logFile << "SetRenderState" << std::endl;
 #endif
 
-	return m_pDevice->SetRenderState(State, Value);
+	if (m_shadowState.FilterRenderState(State, Value))
+		return D3D_OK;
+
+	HRESULT result = m_pDevice->SetRenderState(State, Value);
+	if (SUCCEEDED(result))
+		m_shadowState.StoreRenderState(State, Value);
+
+	return result;
 }
 
 /**
@@ -794,6 +841,7 @@ HRESULT WINAPI BaseDirect3DDevice9::CreateStateBlock(D3DSTATEBLOCKTYPE Type,IDir
 
 /**
 * Base BeginStateBlock functionality.
+* Nothing is filtered until EndStateBlock(), all calls have to be recorded.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::BeginStateBlock()
 {
@@ -801,7 +849,11 @@ HRESULT WINAPI BaseDirect3DDevice9::BeginStateBlock()
 	m_logFile << "BeginStateBlock" << std::endl;
 #endif
 
-	return m_pDevice->BeginStateBlock();
+	HRESULT result = m_pDevice->BeginStateBlock();
+	if (SUCCEEDED(result))
+		m_shadowState.SetRecordingStateBlock(true);
+
+	return result;
 }
 
 /**
@@ -813,6 +865,8 @@ HRESULT WINAPI BaseDirect3DDevice9::EndStateBlock(IDirect3DStateBlock9** ppSB)
 	m_logFile << "EndStateBlock" << std::endl;
 #endif
 
+	m_shadowState.SetRecordingStateBlock(false);
+
 	return m_pDevice->EndStateBlock(ppSB);
 }
 
@@ -854,6 +908,7 @@ HRESULT WINAPI BaseDirect3DDevice9::GetTexture(DWORD Stage,IDirect3DBaseTexture9
 
 /**
 * Base SetTexture functionality.
+* Dropped if the texture is already set.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::SetTexture(DWORD Stage,IDirect3DBaseTexture9* pTexture)
 {
@@ -861,7 +916,14 @@ HRESULT WINAPI BaseDirect3DDevice9::SetTexture(DWORD Stage,IDirect3DBaseTexture9
 	m_logFile << "SetTexture" << std::endl;
 #endif
 
-	return m_pDevice->SetTexture(Stage, pTexture);
+	if (m_shadowState.FilterTexture(Stage, pTexture))
+		return D3D_OK;
+
+	HRESULT result = m_pDevice->SetTexture(Stage, pTexture);
+	if (SUCCEEDED(result))
+		m_shadowState.StoreTexture(Stage, pTexture);
+
+	return result;
 }
 
 /**
@@ -902,6 +964,7 @@ HRESULT WINAPI BaseDirect3DDevice9::GetSamplerState(DWORD Sampler,D3DSAMPLERSTAT
 
 /**
 * Base SetSamplerState functionality.
+* Dropped if the sampler state already has that value.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::SetSamplerState(DWORD Sampler,D3DSAMPLERSTATETYPE Type,DWORD Value)
 {
@@ -909,7 +972,14 @@ HRESULT WINAPI BaseDirect3DDevice9::SetSamplerState(DWORD Sampler,D3DSAMPLERSTAT
 	m_logFile << "SetSamplerState" << std::endl;
 #endif
 
-	return m_pDevice->SetSamplerState(Sampler, Type, Value);
+	if (m_shadowState.FilterSamplerState(Sampler, Type, Value))
+		return D3D_OK;
+
+	HRESULT result = m_pDevice->SetSamplerState(Sampler, Type, Value);
+	if (SUCCEEDED(result))
+		m_shadowState.StoreSamplerState(Sampler, Type, Value);
+
+	return result;
 }
 
 /**
@@ -1077,7 +1147,12 @@ HRESULT WINAPI BaseDirect3DDevice9::DrawPrimitiveUP(D3DPRIMITIVETYPE PrimitiveTy
 	m_logFile << "DrawPrimitiveUP" << std::endl;
 #endif
 
-	return m_pDevice->DrawPrimitiveUP(PrimitiveType, PrimitiveCount, pVertexStreamZeroData, VertexStreamZeroStride);
+	HRESULT result = m_pDevice->DrawPrimitiveUP(PrimitiveType, PrimitiveCount, pVertexStreamZeroData, VertexStreamZeroStride);
+
+	// user pointer draws leave stream 0 unset
+	m_shadowState.StoreStreamSource(0, NULL, 0, 0);
+
+	return result;
 }
 
 /**
@@ -1089,7 +1164,12 @@ HRESULT WINAPI BaseDirect3DDevice9::DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE Prim
 	m_logFile << "DrawIndexedPrimitiveUP" << std::endl;
 #endif
 
-	return m_pDevice->DrawIndexedPrimitiveUP(PrimitiveType, MinVertexIndex, NumVertices, PrimitiveCount, pIndexData, IndexDataFormat, pVertexStreamZeroData, VertexStreamZeroStride);
+	HRESULT result = m_pDevice->DrawIndexedPrimitiveUP(PrimitiveType, MinVertexIndex, NumVertices, PrimitiveCount, pIndexData, IndexDataFormat, pVertexStreamZeroData, VertexStreamZeroStride);
+
+	// user pointer draws leave stream 0 unset
+	m_shadowState.StoreStreamSource(0, NULL, 0, 0);
+
+	return result;
 }
 
 /**
@@ -1178,6 +1258,7 @@ HRESULT WINAPI BaseDirect3DDevice9::CreateVertexShader(CONST DWORD* pFunction,ID
 
 /**
 * Base SetVertexShader functionality.
+* Dropped if the shader is already set.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::SetVertexShader(IDirect3DVertexShader9* pShader)
 {
@@ -1185,7 +1266,14 @@ HRESULT WINAPI BaseDirect3DDevice9::SetVertexShader(IDirect3DVertexShader9* pSha
 	m_logFile << "SetVertexShader" << std::endl;
 #endif
 
-	return m_pDevice->SetVertexShader(pShader);
+	if (m_shadowState.FilterVertexShader(pShader))
+		return D3D_OK;
+
+	HRESULT result = m_pDevice->SetVertexShader(pShader);
+	if (SUCCEEDED(result))
+		m_shadowState.StoreVertexShader(pShader);
+
+	return result;
 }
 
 /**
@@ -1274,6 +1362,7 @@ HRESULT WINAPI BaseDirect3DDevice9::GetVertexShaderConstantB(UINT StartRegister,
 
 /**
 * Base SetStreamSource functionality.
+* Dropped if buffer, offset and stride are already set.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::SetStreamSource(UINT StreamNumber,IDirect3DVertexBuffer9* pStreamData,UINT OffsetInBytes,UINT Stride)
 {
@@ -1281,7 +1370,14 @@ HRESULT WINAPI BaseDirect3DDevice9::SetStreamSource(UINT StreamNumber,IDirect3DV
 	m_logFile << "SetStreamSource" << std::endl;
 #endif
 
-	return m_pDevice->SetStreamSource(StreamNumber, pStreamData, OffsetInBytes, Stride);
+	if (m_shadowState.FilterStreamSource(StreamNumber, pStreamData, OffsetInBytes, Stride))
+		return D3D_OK;
+
+	HRESULT result = m_pDevice->SetStreamSource(StreamNumber, pStreamData, OffsetInBytes, Stride);
+	if (SUCCEEDED(result))
+		m_shadowState.StoreStreamSource(StreamNumber, pStreamData, OffsetInBytes, Stride);
+
+	return result;
 }
 
 /**
@@ -1358,6 +1454,7 @@ HRESULT WINAPI BaseDirect3DDevice9::CreatePixelShader(CONST DWORD* pFunction,IDi
 
 /**
 * Base SetPixelShader functionality.
+* Dropped if the shader is already set.
 ***/
 HRESULT WINAPI BaseDirect3DDevice9::SetPixelShader(IDirect3DPixelShader9* pShader)
 {
@@ -1365,7 +1462,14 @@ HRESULT WINAPI BaseDirect3DDevice9::SetPixelShader(IDirect3DPixelShader9* pShade
 	m_logFile << "SetPixelShader" << std::endl;
 #endif
 
-	return m_pDevice->SetPixelShader(pShader);
+	if (m_shadowState.FilterPixelShader(pShader))
+		return D3D_OK;
+
+	HRESULT result = m_pDevice->SetPixelShader(pShader);
+	if (SUCCEEDED(result))
+		m_shadowState.StorePixelShader(pShader);
+
+	return result;
 }
 
 /**
@@ -1506,4 +1610,33 @@ HRESULT WINAPI BaseDirect3DDevice9::CreateQuery(D3DQUERYTYPE Type,IDirect3DQuery
 IDirect3DDevice9* BaseDirect3DDevice9::getActual()
 {
 	return m_pDevice;
+}
+
+/**
+* Executes any commands the device holds back, so the actual device state and contents are current.
+* Called by resources before the application locks, reads or queries them.
+* The base device holds nothing back, so this does nothing.
+* @see D3DProxyDevice::FlushPendingCommands()
+***/
+void BaseDirect3DDevice9::FlushPendingCommands()
+{
+}
+
+/**
+* Forgets the shadowed actual device state, so the next calls are passed to the actual device.
+* Call after the actual device state was changed without using the BaseDirect3DDevice9 methods
+* (direct calls to the actual device, actual state blocks applied).
+* @see ShadowDeviceState
+***/
+void BaseDirect3DDevice9::InvalidateShadowState()
+{
+	m_shadowState.Invalidate();
+}
+
+/**
+* Returns the shadowed actual device state (to read the filtered call statistics).
+***/
+ShadowDeviceState* BaseDirect3DDevice9::getShadowState()
+{
+	return &m_shadowState;
 }
\ No newline at end of file
@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <d3d9.h>
 #include "Direct3D9.h"
+#include "ShadowDeviceState.h"
 
 /**
 *  Direct 3D device class. 
@@ -167,7 +168,10 @@ public:
 	virtual HRESULT WINAPI CreateQuery(D3DQUERYTYPE Type,IDirect3DQuery9** ppQuery);
 
 	/*** BaseDirect3DDevice9 methods ***/
-	IDirect3DDevice9* getActual();
+	IDirect3DDevice9*  getActual();
+	virtual void       FlushPendingCommands();
+	void               InvalidateShadowState();
+	ShadowDeviceState* getShadowState();
 
 private:
 	/**
@@ -184,6 +188,11 @@ private:
 	* Internal reference counter. 
 	***/
 	ULONG m_nRefCount;
+	/**
+	* Shadow copy of the actual device state.
+	* Used to drop calls that would set the states already set.
+	***/
+	ShadowDeviceState m_shadowState;
 #ifdef _EXPORT_LOGFILE
 	/**
 	* The log file (.txt format).
@@ -163,9 +163,15 @@ D3DRESOURCETYPE WINAPI BaseDirect3DIndexBuffer9::GetType()
 
 /**
 * Base Lock functionality.
+* Pending device commands may still read the buffer, so they are executed first unless the lock
+* promises not to overwrite data in use (D3DLOCK_NOOVERWRITE).
+* @see BaseDirect3DDevice9::FlushPendingCommands()
 ***/
 HRESULT WINAPI BaseDirect3DIndexBuffer9::Lock(UINT OffsetToLock, UINT SizeToLock, VOID **ppbData, DWORD Flags)
 {
+	if (((Flags & D3DLOCK_NOOVERWRITE) == 0) && m_pOwningDevice)
+		static_cast<BaseDirect3DDevice9*>(m_pOwningDevice)->FlushPendingCommands();
+
 	return m_pActualIndexBuffer->Lock(OffsetToLock, SizeToLock, ppbData, Flags);
 }
 
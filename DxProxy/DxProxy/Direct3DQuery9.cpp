@@ -122,16 +122,26 @@ DWORD WINAPI BaseDirect3DQuery9::GetDataSize()
 
 /**
 * Base Issue functionality.
+* Pending device commands are executed first, the query has to cover them.
+* @see BaseDirect3DDevice9::FlushPendingCommands()
 ***/
 HRESULT WINAPI BaseDirect3DQuery9::Issue(DWORD dwIssueFlags)
 {
+	if (m_pOwningDevice)
+		static_cast<BaseDirect3DDevice9*>(m_pOwningDevice)->FlushPendingCommands();
+
 	return m_pActualQuery->Issue(dwIssueFlags);
 }
 
 /**
 * Base GetData functionality.
+* Pending device commands are executed first, otherwise a game polling the query would wait forever.
+* @see BaseDirect3DDevice9::FlushPendingCommands()
 ***/
 HRESULT WINAPI BaseDirect3DQuery9::GetData(void* pData, DWORD dwSize, DWORD dwGetDataFlags)
 {
+	if (m_pOwningDevice)
+		static_cast<BaseDirect3DDevice9*>(m_pOwningDevice)->FlushPendingCommands();
+
 	return m_pActualQuery->GetData(pData, dwSize, dwGetDataFlags);
 }
\ No newline at end of file
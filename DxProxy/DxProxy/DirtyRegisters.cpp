@@ -0,0 +1,268 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <DirtyRegisters.cpp> and
+Class <DirtyRegisters> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "DirtyRegisters.h"
+#include <intrin.h>
+
+#pragma intrinsic(_BitScanForward)
+
+/**
+* Registers per word.
+***/
+#define REGISTERS_PER_WORD 32
+
+/**
+* Constructor.
+* @param registerCount Number of registers in the register file, no register is dirty.
+***/
+DirtyRegisters::DirtyRegisters(UINT registerCount) :
+	m_words((registerCount + REGISTERS_PER_WORD - 1) / REGISTERS_PER_WORD, 0),
+	m_registerCount(registerCount),
+	m_firstWord(0),
+	m_endWord(0)
+{
+}
+
+/**
+* Destructor.
+***/
+DirtyRegisters::~DirtyRegisters()
+{
+}
+
+/**
+* Marks registers dirty. Registers out of range are ignored.
+* @param start First register.
+* @param count Register count.
+***/
+void DirtyRegisters::Mark(UINT start, UINT count)
+{
+	if ((start >= m_registerCount) || (count == 0))
+		return;
+	if (count > m_registerCount - start)
+		count = m_registerCount - start;
+
+	UINT end = start + count;
+	UINT firstWord = start / REGISTERS_PER_WORD;
+	UINT endWord = (end + REGISTERS_PER_WORD - 1) / REGISTERS_PER_WORD;
+
+	while (start < end) {
+		UINT bit = start % REGISTERS_PER_WORD;
+		UINT bits = min(REGISTERS_PER_WORD - bit, end - start);
+		m_words[start / REGISTERS_PER_WORD] |= WordMask(bit, bits);
+		start += bits;
+	}
+
+	if (m_firstWord >= m_endWord) {
+		m_firstWord = firstWord;
+		m_endWord = endWord;
+	}
+	else {
+		m_firstWord = min(m_firstWord, firstWord);
+		m_endWord = max(m_endWord, endWord);
+	}
+}
+
+/**
+* Marks registers clean. Registers out of range are ignored.
+* @param start First register.
+* @param count Register count.
+***/
+void DirtyRegisters::Unmark(UINT start, UINT count)
+{
+	if ((start >= m_registerCount) || (count == 0))
+		return;
+	if (count > m_registerCount - start)
+		count = m_registerCount - start;
+
+	UINT end = start + count;
+	while (start < end) {
+		UINT bit = start % REGISTERS_PER_WORD;
+		UINT bits = min(REGISTERS_PER_WORD - bit, end - start);
+		m_words[start / REGISTERS_PER_WORD] &= ~WordMask(bit, bits);
+		start += bits;
+	}
+}
+
+/**
+* Returns true if any register is dirty.
+***/
+bool DirtyRegisters::Any()
+{
+	for (UINT word = m_firstWord; word < m_endWord; word++) {
+		if (m_words[word])
+			return true;
+	}
+
+	return false;
+}
+
+/**
+* Returns true if any register in the specified range is dirty.
+* @param start First register.
+* @param count Register count.
+***/
+bool DirtyRegisters::AnyInRange(UINT start, UINT count)
+{
+	if ((start >= m_registerCount) || (count == 0))
+		return false;
+	if (count > m_registerCount - start)
+		count = m_registerCount - start;
+
+	UINT end = start + count;
+	while (start < end) {
+		UINT bit = start % REGISTERS_PER_WORD;
+		UINT bits = min(REGISTERS_PER_WORD - bit, end - start);
+		if (m_words[start / REGISTERS_PER_WORD] & WordMask(bit, bits))
+			return true;
+		start += bits;
+	}
+
+	return false;
+}
+
+/**
+* Finds the next run of contiguous dirty registers.
+* @param pStart [in, out] In : register to start searching at. Out : first register of the run.
+* @param pCount [out] Number of registers in the run.
+* @return False if there are no dirty registers at or after the start register.
+***/
+bool DirtyRegisters::NextRun(UINT* pStart, UINT* pCount)
+{
+	return NextRun(pStart, pCount, NULL);
+}
+
+/**
+* Finds the next run of contiguous registers that are both dirty and set in a register mask.
+* @param pStart [in, out] In : register to start searching at. Out : first register of the run.
+* @param pCount [out] Number of registers in the run.
+* @param pMask Register mask, same bit layout as the dirty bits. Registers past the end of the mask
+* are not set, NULL sets all registers.
+* @return False if there are no such registers at or after the start register.
+***/
+bool DirtyRegisters::NextRun(UINT* pStart, UINT* pCount, const std::vector<DWORD>* pMask)
+{
+	UINT word = *pStart / REGISTERS_PER_WORD;
+	if (word < m_firstWord)
+		word = m_firstWord;
+	else if (word >= m_endWord)
+		return false;
+
+	// first dirty bit at or after the start register
+	DWORD bits = MaskedWord(word, pMask);
+	if (word == *pStart / REGISTERS_PER_WORD)
+		bits &= ~0UL << (*pStart % REGISTERS_PER_WORD);
+	while (!bits) {
+		if (++word >= m_endWord)
+			return false;
+		bits = MaskedWord(word, pMask);
+	}
+
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	UINT runStart = word * REGISTERS_PER_WORD + index;
+
+	// first clean bit after the run start
+	DWORD cleanBits = ~MaskedWord(word, pMask) & (~0UL << index);
+	while (!cleanBits) {
+		if (++word >= m_words.size()) {
+			*pStart = runStart;
+			*pCount = m_registerCount - runStart;
+			return true;
+		}
+		cleanBits = ~MaskedWord(word, pMask);
+	}
+
+	_BitScanForward(&index, cleanBits);
+	UINT runEnd = min(word * REGISTERS_PER_WORD + index, m_registerCount);
+
+	*pStart = runStart;
+	*pCount = runEnd - runStart;
+	return true;
+}
+
+/**
+* Marks all registers clean.
+***/
+void DirtyRegisters::Clear()
+{
+	if (m_firstWord < m_endWord)
+		ZeroMemory(&m_words[m_firstWord], (m_endWord - m_firstWord) * sizeof(DWORD));
+
+	m_firstWord = 0;
+	m_endWord = 0;
+}
+
+/**
+* Sets registers in a register mask as used by NextRun(), the mask grows as needed.
+* @param pMask The register mask.
+* @param start First register.
+* @param count Register count.
+***/
+void DirtyRegisters::MarkMask(std::vector<DWORD>* pMask, UINT start, UINT count)
+{
+	if (count == 0)
+		return;
+
+	UINT end = start + count;
+	UINT endWord = (end + REGISTERS_PER_WORD - 1) / REGISTERS_PER_WORD;
+	if (pMask->size() < endWord)
+		pMask->resize(endWord, 0);
+
+	while (start < end) {
+		UINT bit = start % REGISTERS_PER_WORD;
+		UINT bits = min(REGISTERS_PER_WORD - bit, end - start);
+		(*pMask)[start / REGISTERS_PER_WORD] |= WordMask(bit, bits);
+		start += bits;
+	}
+}
+
+/**
+* Returns the dirty bits of one word that are set in a register mask.
+* @param word Word index.
+* @param pMask Register mask, NULL sets all registers.
+***/
+DWORD DirtyRegisters::MaskedWord(UINT word, const std::vector<DWORD>* pMask)
+{
+	if (!pMask)
+		return m_words[word];
+
+	return (word < pMask->size()) ? (m_words[word] & (*pMask)[word]) : 0;
+}
+
+/**
+* Mask of bits [bit, bit + bits) of one word.
+* @param bit First bit, 0-31.
+* @param bits Number of bits, 1-32.
+***/
+DWORD DirtyRegisters::WordMask(UINT bit, UINT bits)
+{
+	DWORD mask = (bits >= REGISTERS_PER_WORD) ? ~0UL : ((1UL << bits) - 1);
+	return mask << bit;
+}
@@ -0,0 +1,83 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <DirtyRegisters.h> and
+Class <DirtyRegisters> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef DIRTYREGISTERS_H_INCLUDED
+#define DIRTYREGISTERS_H_INCLUDED
+
+#include <d3d9.h>
+#include <vector>
+
+/**
+* Dirty shader register tracking.
+* One bit per register, sized once for the register file. Marking, unmarking and range tests work a
+* word (32 registers) at a time, runs of dirty registers are extracted by bit scans, optionally
+* restricted to the registers of a mask in the same layout.
+* The range of words touched since the last Clear() is kept, so Any(), NextRun() and Clear() only
+* look at that range.
+* @see ShaderRegisters
+*/
+class DirtyRegisters
+{
+public:
+	DirtyRegisters(UINT registerCount);
+	virtual ~DirtyRegisters();
+
+	/*** DirtyRegisters public methods ***/
+	void        Mark(UINT start, UINT count);
+	void        Unmark(UINT start, UINT count);
+	bool        Any();
+	bool        AnyInRange(UINT start, UINT count);
+	bool        NextRun(UINT* pStart, UINT* pCount);
+	bool        NextRun(UINT* pStart, UINT* pCount, const std::vector<DWORD>* pMask);
+	void        Clear();
+	static void MarkMask(std::vector<DWORD>* pMask, UINT start, UINT count);
+
+private:
+	/*** DirtyRegisters private methods ***/
+	DWORD        MaskedWord(UINT word, const std::vector<DWORD>* pMask);
+	static DWORD WordMask(UINT bit, UINT bits);
+
+	/**
+	* The bits, register n is bit (n % 32) of word (n / 32).
+	***/
+	std::vector<DWORD> m_words;
+	/**
+	* Number of registers tracked.
+	***/
+	UINT m_registerCount;
+	/**
+	* First word marked since the last Clear().
+	***/
+	UINT m_firstWord;
+	/**
+	* One past the last word marked since the last Clear() (0 if none).
+	***/
+	UINT m_endWord;
+};
+#endif
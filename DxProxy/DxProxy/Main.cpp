@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define _CRT_SECURE_NO_WARNINGS
 #include "Main.h"
 #include "Direct3D9.h"
+#include "ProxyProfiler.h"
 #include <windows.h>
 #include <d3d9.h>
 #include <stdio.h>
@@ -56,6 +57,16 @@ LPD3DPERF_QueryRepeatFrame g_pfnD3DPERF_QueryRepeatFrame = NULL;
 LPD3DPERF_SetOptions g_pfnD3DPERF_SetOptions = NULL;
 LPD3DPERF_GetStatus g_pfnD3DPERF_GetStatus = NULL;
 
+/**
+* Hands the profiler ring buffer of an exiting thread back for reuse.
+***/
+BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved)
+{
+	if (fdwReason == DLL_THREAD_DETACH)
+		ProxyProfiler::ReleaseThread();
+	return TRUE;
+}
+
 static bool LoadDll()
 {
 	if(g_hDll)
@@ -63,8 +63,8 @@ public:
 	* Matrix modification does multiply: translation * squash.
 	* *  Does the matrix squash and outputs the results.  Does not only affect HUD at this point in time (August 22nd, 2013).
 	* @param in The matrix to be multiply by the adjustmentMatricies.
-	* @param[out] outLeft The resulting left side matrix
-	* @param[out] outRight The resulting right side matrix
+	* @param[out] outLeft The resulting left side adjustment matrix
+	* @param[out] outRight The resulting right side adjustment matrix
 	* TODO probably don't want to be translating the HUD around.
 	* Need an adjustment that does unproject, reproject left/right? (then squash)
 	* Refactor modifications into view adjustments? Or just make unproject->reproject a standard adjustment in adjustments?
@@ -72,10 +72,11 @@ public:
 	* TODO Refactor so adjustments aren't recalculated every time constant is applied that don't need to be
 	* Shift adustments to some kind of indexed lookup in view adjustments with adjustments only being updated if dirty?
 	***/
-	virtual void DoMatrixModification(D3DXMATRIX in, D3DXMATRIX& outLeft, D3DXMATRIX& outright)
+	virtual bool AdjustmentMatrices(const D3DXMATRIX& in, D3DXMATRIX& outLeft, D3DXMATRIX& outRight)
 	{
-		outLeft = in * m_spAdjustmentMatrices->LeftShiftProjection() * squash;
-		outright = in * m_spAdjustmentMatrices->RightShiftProjection() * squash;
+		outLeft = m_spAdjustmentMatrices->LeftShiftProjection() * squash;
+		outRight = m_spAdjustmentMatrices->RightShiftProjection() * squash;
+		return true;
 	};
 
 private:
@@ -61,24 +61,21 @@ public:
 	* Matrix modification does multiply: shiftprojection * squash (for GUI), scale * transform * distance (for HUD).
 	* Does the matrix squash and outputs the results.  Does only affect HUD (or GUI).
 	* @param in The matrix to be multiply by the adjustmentMatricies.
-	* @param[out] outLeft The resulting left side matrix
-	* @param[out] outRight The resulting right side matrix
+	* @param[out] outLeft The resulting left side adjustment matrix
+	* @param[out] outRight The resulting right side adjustment matrix
 	***/
-	virtual void DoMatrixModification(D3DXMATRIX in, D3DXMATRIX& outLeft, D3DXMATRIX& outright)
+	virtual bool AdjustmentMatrices(const D3DXMATRIX& in, D3DXMATRIX& outLeft, D3DXMATRIX& outRight)
 	{
 		if (vireio::AlmostSame(in[15], 1.0f, 0.00001f)) {
 
 			// HUD
 			// separation -> distance translation
-			D3DXMATRIX orthoToPersViewProjTransformLeft  = m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->LeftHUD3DDepth() * m_spAdjustmentMatrices->LeftViewTransform() * m_spAdjustmentMatrices->HUDDistance() *  m_spAdjustmentMatrices->Projection() * m_spAdjustmentMatrices->LeftShiftProjection();
-			D3DXMATRIX orthoToPersViewProjTransformRight = m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->RightHUD3DDepth() * m_spAdjustmentMatrices->RightViewTransform() * m_spAdjustmentMatrices->HUDDistance() * m_spAdjustmentMatrices->Projection() * m_spAdjustmentMatrices->RightShiftProjection();
-
-			outLeft = in * orthoToPersViewProjTransformLeft;
-			outright = in * orthoToPersViewProjTransformRight;
-
+			outLeft  = m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->LeftHUD3DDepth() * m_spAdjustmentMatrices->LeftViewTransform() * m_spAdjustmentMatrices->HUDDistance() *  m_spAdjustmentMatrices->Projection() * m_spAdjustmentMatrices->LeftShiftProjection();
+			outRight = m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->RightHUD3DDepth() * m_spAdjustmentMatrices->RightViewTransform() * m_spAdjustmentMatrices->HUDDistance() * m_spAdjustmentMatrices->Projection() * m_spAdjustmentMatrices->RightShiftProjection();
+			return true;
 		}
 		else {
-			ShaderMatrixModification::DoMatrixModification(in, outLeft, outright);
+			return ShaderMatrixModification::AdjustmentMatrices(in, outLeft, outRight);
 		}
 	};
 };
@@ -60,61 +60,84 @@ public:
 	/**
 	* Matrix modification does multiply: shiftprojection * squash (for GUI), scale * transform * distance (for HUD).
 	* Does the matrix squash and outputs the results.  Does only affect HUD (or GUI).
+	* Only the bullet labyrinth GUI is no plain product, all other cases are in AdjustmentMatrices.
 	* @param in The matrix to be multiply by the adjustmentMatricies.
 	* @param[out] outLeft The resulting left side matrix
 	* @param[out] outRight The resulting right side matrix
 	***/
 	virtual void DoMatrixModification(D3DXMATRIX in, D3DXMATRIX& outLeft, D3DXMATRIX& outright)
 	{
-		if (vireio::AlmostSame(in[15], 1.0f, 0.00001f)) {
+		if (vireio::AlmostSame(in[15], 1.0f, 0.00001f) && !IsHud(in) && m_spAdjustmentMatrices->BulletLabyrinthMode()) {
 
-			// add all translation and scale matrix entries 
-			// (for the GUI this should be 3.0f, for the HUD above)
-			float allAbs = abs(in(3, 0)); // transX
-			allAbs += abs(in(3, 1)); // transY
-			allAbs += abs(in(3, 2)); // transZ
+			D3DXMATRIX tempMatrix;
+			D3DXMatrixTranspose(&tempMatrix, &in);
+			tempMatrix = m_spAdjustmentMatrices->BulletLabyrinth() * tempMatrix;
+			D3DXMatrixTranspose(&tempMatrix, &tempMatrix);
 
-			allAbs += abs(in(0, 0)); // scaleX
-			allAbs += abs(in(1, 1)); // scaleY
-			allAbs += abs(in(2, 2)); // scaleZ
+			outLeft = tempMatrix * m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->LeftGUI3DDepth() * m_spAdjustmentMatrices->LeftShiftProjection() * m_spAdjustmentMatrices->Squash() * m_spAdjustmentMatrices->Projection();
+			outright = tempMatrix * m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->RightGUI3DDepth() * m_spAdjustmentMatrices->RightShiftProjection() * m_spAdjustmentMatrices->Squash() * m_spAdjustmentMatrices->Projection();
+				
+			// SetRenderState(D3DRS_SCISSORTESTENABLE, FALSE);
+		}
+		else {
+			ShaderMatrixModification::DoMatrixModification(in, outLeft, outright);
+		}
+	};
+
+	/**
+	* Provides the matrices of the plain product cases : HUD, simple squash GUI and perspective.
+	* @param in The matrix to be multiply by the adjustmentMatricies.
+	* @param[out] outLeft The resulting left side adjustment matrix
+	* @param[out] outRight The resulting right side adjustment matrix
+	* @return False for the bullet labyrinth GUI.
+	***/
+	virtual bool AdjustmentMatrices(const D3DXMATRIX& in, D3DXMATRIX& outLeft, D3DXMATRIX& outRight)
+	{
+		if (vireio::AlmostSame(in[15], 1.0f, 0.00001f)) {
 
 			// TODO !! compute these two following matrices in the ViewAdjustment class :
 
 			// HUD
-			if (allAbs > 3.0f)
+			if (IsHud(in))
 			{
 				// separation -> distance translation
-				D3DXMATRIX orthoToPersViewProjTransformLeft  = m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->LeftHUD3DDepthShifted() * m_spAdjustmentMatrices->LeftViewTransform() * m_spAdjustmentMatrices->HUDDistance() *  m_spAdjustmentMatrices->Projection() * m_spAdjustmentMatrices->LeftShiftProjection();
-				D3DXMATRIX orthoToPersViewProjTransformRight = m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->RightHUD3DDepthShifted() * m_spAdjustmentMatrices->RightViewTransform() * m_spAdjustmentMatrices->HUDDistance() * m_spAdjustmentMatrices->Projection() * m_spAdjustmentMatrices->RightShiftProjection();
-				
-				outLeft = in * orthoToPersViewProjTransformLeft;
-				outright = in * orthoToPersViewProjTransformRight;
+				outLeft  = m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->LeftHUD3DDepthShifted() * m_spAdjustmentMatrices->LeftViewTransform() * m_spAdjustmentMatrices->HUDDistance() *  m_spAdjustmentMatrices->Projection() * m_spAdjustmentMatrices->LeftShiftProjection();
+				outRight = m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->RightHUD3DDepthShifted() * m_spAdjustmentMatrices->RightViewTransform() * m_spAdjustmentMatrices->HUDDistance() * m_spAdjustmentMatrices->Projection() * m_spAdjustmentMatrices->RightShiftProjection();
+				return true;
 			}
 			else // GUI
 			{
 				if (m_spAdjustmentMatrices->BulletLabyrinthMode())
-				{
-					D3DXMATRIX tempMatrix;
-					D3DXMatrixTranspose(&tempMatrix, &in);
-					tempMatrix = m_spAdjustmentMatrices->BulletLabyrinth() * tempMatrix;
-					D3DXMatrixTranspose(&tempMatrix, &tempMatrix);
-
-					outLeft = tempMatrix * m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->LeftGUI3DDepth() * m_spAdjustmentMatrices->LeftShiftProjection() * m_spAdjustmentMatrices->Squash() * m_spAdjustmentMatrices->Projection();
-					outright = tempMatrix * m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->RightGUI3DDepth() * m_spAdjustmentMatrices->RightShiftProjection() * m_spAdjustmentMatrices->Squash() * m_spAdjustmentMatrices->Projection();
-				
-					// SetRenderState(D3DRS_SCISSORTESTENABLE, FALSE);
-				}
-				else
-				{
-					// simple squash
-					outLeft = in * m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->LeftGUI3DDepth() * m_spAdjustmentMatrices->LeftShiftProjection() * m_spAdjustmentMatrices->Squash() * m_spAdjustmentMatrices->Projection();
-					outright = in * m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->RightGUI3DDepth() * m_spAdjustmentMatrices->RightShiftProjection() * m_spAdjustmentMatrices->Squash() * m_spAdjustmentMatrices->Projection();
-				}
+					return false;
+
+				// simple squash
+				outLeft = m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->LeftGUI3DDepth() * m_spAdjustmentMatrices->LeftShiftProjection() * m_spAdjustmentMatrices->Squash() * m_spAdjustmentMatrices->Projection();
+				outRight = m_spAdjustmentMatrices->ProjectionInverse() * m_spAdjustmentMatrices->RightGUI3DDepth() * m_spAdjustmentMatrices->RightShiftProjection() * m_spAdjustmentMatrices->Squash() * m_spAdjustmentMatrices->Projection();
+				return true;
 			}
 		}
 		else {
-			ShaderMatrixModification::DoMatrixModification(in, outLeft, outright);
+			return ShaderMatrixModification::AdjustmentMatrices(in, outLeft, outRight);
 		}
 	};
+
+private:
+	/**
+	* True if the orthographic matrix is a HUD matrix.
+	* Adds all translation and scale matrix entries (for the GUI this should be 3.0f, for the HUD above).
+	* @param in The orthographic matrix.
+	***/
+	bool IsHud(const D3DXMATRIX& in)
+	{
+		float allAbs = abs(in(3, 0)); // transX
+		allAbs += abs(in(3, 1)); // transY
+		allAbs += abs(in(3, 2)); // transZ
+
+		allAbs += abs(in(0, 0)); // scaleX
+		allAbs += abs(in(1, 1)); // scaleY
+		allAbs += abs(in(2, 2)); // scaleZ
+
+		return (allAbs > 3.0f);
+	}
 };
 #endif
\ No newline at end of file
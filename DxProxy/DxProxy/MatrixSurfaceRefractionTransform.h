@@ -67,15 +67,15 @@ public:
 	* @param [in, out] outLeft Register vector left.
 	* @param [in, out] outRight Register vector right.
 	***/
-	virtual void ApplyModification(const float* inData, std::vector<float>* outLeft, std::vector<float>* outRight)
+	virtual void ApplyModification(const float* inData, float* outLeft, float* outRight, UINT count)
 	{
 		D3DXMATRIX tempMatrix (inData);
 
 		// conditions to apply the matrix ?
 		if (DoNotApply(tempMatrix)) {
 
-			outLeft->assign(&tempMatrix[0], &tempMatrix[0] + outLeft->size());
-			outRight->assign(&tempMatrix[0], &tempMatrix[0] + outRight->size());
+			AssignMatrix(tempMatrix, inData, outLeft, count);
+			AssignMatrix(tempMatrix, inData, outRight, count);
 		}
 		else {
 			// get gathered matrices
@@ -99,8 +99,8 @@ public:
 			}
 
 			// assign to output
-			outLeft->assign(&tempLeft[0], &tempLeft[0] + outLeft->size());
-			outRight->assign(&tempRight[0], &tempRight[0] + outRight->size());
+			AssignMatrix(tempLeft, inData, outLeft, count);
+			AssignMatrix(tempRight, inData, outRight, count);
 		}
 	}
 
@@ -104,7 +104,7 @@ public:
 	/**
 	* Currently supported tracker types enumeration.
 	***/
-	static enum TrackerTypes
+	enum TrackerTypes
 	{
 		DISABLED = 0,         /**< Tracking disabled. */
 		HILLCREST = 10,       /**< Hillcrest Labs. Freespace. */
@@ -0,0 +1,169 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ProxyCounters.cpp> and
+Class <ProxyCounters> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ProxyCounters.h"
+
+/**
+* Name of mapping object.
+***/
+static const TCHAR szCountersName[] = TEXT("VireioProxyCounters");
+
+/**
+* Constructor.
+* Zeroes all counters, opens the shared memory block.
+***/
+ProxyCounters::ProxyCounters() :
+	m_hMapFile(NULL),
+	m_pSharedBlock(NULL)
+{
+	ZeroMemory(&m_frame, sizeof(ProxyCounterValues));
+	ZeroMemory(&m_published, sizeof(ProxyCountersBlock));
+	m_published.size = sizeof(ProxyCounterValues);
+
+	if (!OpenSharedMemory())
+		OutputDebugString("ProxyCounters: Shared memory not available, counters are published in process only.\n");
+}
+
+/**
+* Destructor.
+* Unmaps shared memory pointer. Closes file mapping object handle.
+***/
+ProxyCounters::~ProxyCounters()
+{
+	if (m_pSharedBlock)
+		UnmapViewOfFile(m_pSharedBlock);
+	if (m_hMapFile)
+		CloseHandle(m_hMapFile);
+}
+
+/**
+* Counters of the current frame, to be incremented by the components.
+***/
+ProxyCounterValues& ProxyCounters::Frame()
+{
+	return m_frame;
+}
+
+/**
+* Publishes the counters of the current frame and starts a new frame.
+* Call once per frame (on Present), on the render thread.
+***/
+void ProxyCounters::Publish()
+{
+	m_frame.frame = m_published.values.frame + 1;
+
+	Write(&m_published, m_frame);
+	if (m_pSharedBlock)
+		Write(m_pSharedBlock, m_frame);
+
+	ZeroMemory(&m_frame, sizeof(ProxyCounterValues));
+}
+
+/**
+* Copies the last published counters, can be called from any thread.
+* @param pValues [out] The counters of the last full frame.
+* @return False if no consistent copy could be taken (render thread kept publishing).
+***/
+bool ProxyCounters::Snapshot(ProxyCounterValues* pValues)
+{
+	return Read(&m_published, pValues);
+}
+
+/**
+* Reads a published counters block, without locking.
+* External tools can use the same method on the mapped "VireioProxyCounters" block.
+* @param pBlock The published block.
+* @param pValues [out] The counters.
+* @return False if no consistent copy could be taken.
+***/
+bool ProxyCounters::Read(const ProxyCountersBlock* pBlock, ProxyCounterValues* pValues)
+{
+	for (int attempt = 0; attempt < 16; attempt++) {
+		LONG sequence = pBlock->sequence;
+		if (sequence & 1) {
+			YieldProcessor();
+			continue;
+		}
+
+		MemoryBarrier();
+		ProxyCounterValues values = pBlock->values;
+		MemoryBarrier();
+
+		if (pBlock->sequence == sequence) {
+			*pValues = values;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+* Writes values to a published counters block (sequence odd while writing).
+* @param pBlock The published block.
+* @param values The counters to publish.
+***/
+void ProxyCounters::Write(ProxyCountersBlock* pBlock, const ProxyCounterValues& values)
+{
+	InterlockedIncrement(&pBlock->sequence);
+	pBlock->size = sizeof(ProxyCounterValues);
+	pBlock->values = values;
+	InterlockedIncrement(&pBlock->sequence);
+}
+
+/**
+* Opens the shared memory file mapping object ("VireioProxyCounters").
+***/
+bool ProxyCounters::OpenSharedMemory()
+{
+	m_hMapFile = CreateFileMapping(
+		INVALID_HANDLE_VALUE,       // use paging file
+		NULL,                       // default security
+		PAGE_READWRITE,             // read/write access
+		0,                          // maximum object size (high-order DWORD)
+		sizeof(ProxyCountersBlock), // maximum object size (low-order DWORD)
+		szCountersName);            // name of mapping object
+
+	if (m_hMapFile == NULL)
+		return false;
+
+	m_pSharedBlock = (ProxyCountersBlock*) MapViewOfFile(m_hMapFile, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(ProxyCountersBlock));
+
+	if (m_pSharedBlock == NULL) {
+		CloseHandle(m_hMapFile);
+		m_hMapFile = NULL;
+		return false;
+	}
+
+	// a block left by an earlier device may be odd if that device was destroyed while writing
+	if (m_pSharedBlock->sequence & 1)
+		InterlockedIncrement(&m_pSharedBlock->sequence);
+
+	return true;
+}
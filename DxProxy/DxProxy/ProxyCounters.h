@@ -0,0 +1,123 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ProxyCounters.h> and
+Class <ProxyCounters> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef PROXYCOUNTERS_H_INCLUDED
+#define PROXYCOUNTERS_H_INCLUDED
+
+#include <d3d9.h>
+
+/**
+* Proxy overhead counters of one frame.
+* Plain integers, incremented on the render thread only.
+***/
+struct ProxyCounterValues
+{
+	UINT frame;                     /**< Frame number, increased on every publish. */
+	UINT drawsIssued;               /**< Draw calls (including Clear) issued by the game. */
+	UINT drawsDoubled;              /**< Draw calls issued a second time for the other eye (immediately or replayed). */
+	UINT drawsDeferred;             /**< Draw calls deferred to a replay for the other eye. */
+	UINT drawsInstanced;            /**< Draw calls drawn for both eyes at once (instanced stereo). */
+	UINT drawsPerSide;              /**< Draw calls of a side-by-side pass drawn per side (user pointer draws, draws instanced stereo can not handle). */
+	UINT drawsMono;                 /**< Draws classified as mono (same image for both eyes). */
+	UINT drawsElided;               /**< Mono draws drawn for one side only. */
+	UINT sidesCopied;               /**< Copies of a mono drawn side to the other side. */
+	UINT eyeSwitches;               /**< Drawing side switches. */
+	UINT textureRebinds;            /**< Stereo textures set again on the actual device for a side switch. */
+	UINT vsConstantUploads;         /**< SetVertexShaderConstantF calls on the actual device. */
+	UINT vsConstantFloats;          /**< Floats transferred by these calls. */
+	UINT psConstantUploads;         /**< SetPixelShaderConstantF calls on the actual device. */
+	UINT psConstantFloats;          /**< Floats transferred by these calls. */
+	UINT vsConstantsUnchanged;      /**< VS constant registers set by the game to the value they already had (not marked dirty). */
+	UINT psConstantsUnchanged;      /**< PS constant registers set by the game to the value they already had (not marked dirty). */
+	UINT intBoolConstantUploads;    /**< Set(Vertex/Pixel)ShaderConstant(I/B) calls on the actual device. */
+	UINT intBoolConstantsUnchanged; /**< Integer and boolean constant registers set by the game to the value they already had. */
+	UINT stereoConstantUpdates;     /**< Stereo constant recomputations (left and right data). */
+	UINT stereoUploadsSkipped;      /**< Stereo constant uploads skipped on side changes (left and right data equal). */
+	UINT stretchRectCopies;         /**< StretchRect calls on the actual device. */
+	UINT stateBlockCreations;       /**< State blocks created (CreateStateBlock, EndStateBlock). */
+	UINT filteredCalls;             /**< Redundant actual device calls filtered by the shadow device state. */
+	UINT shaderAnalysisQueueDepth;  /**< Shader analyses queued or running at the end of the frame. */
+	UINT shaderAnalysisStalls;      /**< Shaders bound before their analysis was done. */
+	UINT shaderAnalysisStallTime;   /**< Time spent finishing these analyses, in microseconds. */
+};
+
+/**
+* Published counters, in process and in the shared memory block.
+* Sequence lock : the sequence is odd while the render thread writes the values, a reader
+* copies the values and accepts them if the sequence was even and did not change meanwhile.
+***/
+struct ProxyCountersBlock
+{
+	volatile LONG      sequence; /**< Increased before and after every write. */
+	UINT               size;     /**< sizeof(ProxyCounterValues), lets external tools check the layout. */
+	ProxyCounterValues values;   /**< The counters of the last full frame. */
+};
+
+/**
+* Always-on proxy overhead counters.
+* Components increment the counters of the current frame, the proxy device publishes them once
+* per Present. Published counters can be read from any thread without locking and are exported
+* to the shared memory block "VireioProxyCounters" for external tools.
+* @see D3DProxyDevice::Present()
+*/
+class ProxyCounters
+{
+public:
+	ProxyCounters();
+	virtual ~ProxyCounters();
+
+	/*** ProxyCounters public methods ***/
+	ProxyCounterValues& Frame();
+	void                Publish();
+	bool                Snapshot(ProxyCounterValues* pValues);
+	static bool         Read(const ProxyCountersBlock* pBlock, ProxyCounterValues* pValues);
+
+private:
+	/*** ProxyCounters private methods ***/
+	bool        OpenSharedMemory();
+	static void Write(ProxyCountersBlock* pBlock, const ProxyCounterValues& values);
+
+	/**
+	* Counters of the current frame.
+	***/
+	ProxyCounterValues m_frame;
+	/**
+	* In process published counters.
+	***/
+	ProxyCountersBlock m_published;
+	/**
+	* Handle to the file mapping object, NULL if not available.
+	***/
+	HANDLE m_hMapFile;
+	/**
+	* Shared memory block, NULL if not available.
+	***/
+	ProxyCountersBlock* m_pSharedBlock;
+};
+#endif
@@ -270,6 +270,10 @@ bool ProxyHelper::LoadConfig(ProxyConfig& config, OculusProfile& oculusProfile)
 	config.convergence = 0.0f;
 	config.swap_eyes = false;
 	config.aspect_multiplier = 1.0f;
+	config.deferredRightEye = false;
+	config.monoDrawElision = false;
+	config.instancedStereo = false;
+	config.constantUploadGap = 4;
 
 	// load the base dir for the app
 	GetBaseDir();
@@ -369,6 +373,10 @@ bool ProxyHelper::LoadConfig(ProxyConfig& config, OculusProfile& oculusProfile)
 
 		config.rollEnabled = gameProfile.attribute("rollEnabled").as_bool(false);
 		config.worldScaleFactor = gameProfile.attribute("worldScaleFactor").as_float(1.0f);
+		config.deferredRightEye = gameProfile.attribute("deferredRightEye").as_bool(false);
+		config.monoDrawElision = gameProfile.attribute("monoDrawElision").as_bool(false);
+		config.instancedStereo = gameProfile.attribute("instancedStereo").as_bool(false);
+		config.constantUploadGap = gameProfile.attribute("constantUploadGap").as_int(4);
 
 		// copy game dlls
 		bool copyDlls = gameProfile.attribute("copyDlls").as_bool();
@@ -63,6 +63,10 @@ public:
 		float       roll_multiplier;       /**< Game-specific tracking multiplier (roll). */
 		float       worldScaleFactor;      /**< Value the eye seperation is to be multiplied with. (mm * worldScaleFactor = mm in game units). */
 		bool        rollEnabled;           /**< True if headtracking-roll is to be enabled. */
+		bool        deferredRightEye;      /**< True if draws are recorded and replayed for the second eye once per render target change (instead of switching eyes on every draw). */
+		bool        monoDrawElision;       /**< True if draws that would render identical images for both eyes are only drawn once (and copied to the other eye when needed). */
+		bool        instancedStereo;       /**< True if draws are drawn for both eyes at once, as two instances into a side by side render target (patched shaders). */
+		int         constantUploadGap;     /**< Maximum number of clean shader constant registers uploaded to merge two dirty register runs into one upload. */
 		std::string shaderRulePath;        /**< Full path of shader rules for this game. */
 		float       ipd;                   /**< IPD, which stands for interpupillary distance (distance between your pupils - in meters...default = 0.064). Also called the interocular distance (or just Interocular). */
 		float       convergence;           /**< Convergence or Neutral Point distance, in meters. */
@@ -0,0 +1,293 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ProxyProfiler.cpp> and
+Class <ProxyProfiler> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ProxyProfiler.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+/**
+* True if scopes are recorded (default).
+***/
+volatile bool ProxyProfiler::s_enabled = true;
+
+/**
+* Thread local storage slot holding the ring buffer of the calling thread.
+***/
+static DWORD dwProfilerTlsIndex = TlsAlloc();
+/**
+* Frame start timestamps, ring of ProxyProfiler::FRAME_COUNT.
+***/
+static LONGLONG frameStarts[ProxyProfiler::FRAME_COUNT];
+/**
+* Total number of marked frames.
+***/
+static UINT frameCount = 0;
+/**
+* The thread marking frames (render thread), owner of the large ring buffer.
+***/
+static DWORD frameThreadId = 0;
+
+/**
+* All thread ring buffers created so far, guarded by a critical section.
+* Buffers of exited threads are flagged released and handed to the next thread asking for a
+* buffer of the same capacity, so the number of buffers is bound by the number of threads alive at once.
+***/
+static class ProfilerThreadBuffers
+{
+public:
+	ProfilerThreadBuffers() { InitializeCriticalSection(&lock); }
+	~ProfilerThreadBuffers() { DeleteCriticalSection(&lock); }
+
+	CRITICAL_SECTION   lock;
+	std::vector<void*> buffers;
+} profilerThreadBuffers;
+
+/**
+* Enables or disables recording.
+* Disabling keeps the recorded events, a disabled scope costs one branch.
+***/
+void ProxyProfiler::SetEnabled(bool enabled)
+{
+	s_enabled = enabled;
+}
+
+/**
+* Records a closed scope into the ring buffer of the calling thread.
+* @param name The scope name, a string literal.
+* @param start Performance counter at scope entry.
+* @param end Performance counter at scope exit.
+***/
+void ProxyProfiler::Record(const char* name, LONGLONG start, LONGLONG end)
+{
+	if (end < start)
+		return;
+
+	ThreadBuffer* pBuffer = (ThreadBuffer*)TlsGetValue(dwProfilerTlsIndex);
+	if (!pBuffer) {
+		pBuffer = AcquireThreadBuffer(THREAD_EVENT_COUNT);
+		if (!pBuffer)
+			return;
+	}
+
+	ProfilerEvent& event = pBuffer->events[pBuffer->next & (pBuffer->capacity - 1)];
+	event.name = name;
+	event.start = start;
+	event.end = end;
+	pBuffer->next++;
+}
+
+/**
+* Marks the start of a new frame.
+* Call once per frame (on Present), on the render thread. The first call swaps the small ring
+* of the calling thread for one holding FRAME_COUNT frames.
+***/
+void ProxyProfiler::MarkFrame()
+{
+	LONGLONG now = Now();
+	if (!now)
+		return;
+
+	ThreadBuffer* pBuffer = (ThreadBuffer*)TlsGetValue(dwProfilerTlsIndex);
+	if (!pBuffer || (pBuffer->capacity < FRAME_THREAD_EVENT_COUNT)) {
+		ReleaseThread();
+		if (!AcquireThreadBuffer(FRAME_THREAD_EVENT_COUNT))
+			return;
+		frameThreadId = GetCurrentThreadId();
+	}
+
+	frameStarts[frameCount & (FRAME_COUNT - 1)] = now;
+	frameCount++;
+}
+
+/**
+* Writes the scopes of the last frames as Chrome trace event JSON.
+* Call on the render thread. Events other threads write during the dump may be skipped.
+* @param fileName The file to write.
+* @param frames Number of frames to dump (including the current one), limited to FRAME_COUNT
+* and to the frames the ring of the frame marking thread still holds completely. Rings of other
+* threads that wrapped within the dumped frames get a "Scopes dropped" marker at their oldest scope.
+* @return False if the file could not be written.
+***/
+bool ProxyProfiler::Dump(const char* fileName, UINT frames)
+{
+	if (frames > FRAME_COUNT)
+		frames = FRAME_COUNT;
+	if (frames == 0)
+		frames = 1;
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	double toMicroseconds = 1000000.0 / (double)frequency.QuadPart;
+
+	FILE* pFile = NULL;
+	if (fopen_s(&pFile, fileName, "w") != 0 || !pFile) {
+		OutputDebugString("ProxyProfiler: Failed to open trace file ");
+		OutputDebugString(fileName);
+		OutputDebugString("\n");
+		return false;
+	}
+
+	EnterCriticalSection(&profilerThreadBuffers.lock);
+
+	// dump from the start of the oldest requested frame...
+	UINT firstFrame = (frameCount > frames) ? frameCount - frames : 0;
+
+	// ...but not from frames the ring of the frame marking thread already overwrote partly
+	// (events are written at scope exit, a frame is complete if it starts after the oldest held exit)
+	for (std::vector<void*>::size_type i = 0; i < profilerThreadBuffers.buffers.size(); i++) {
+		ThreadBuffer* pBuffer = (ThreadBuffer*)profilerThreadBuffers.buffers[i];
+		if (pBuffer->released || (pBuffer->threadId != frameThreadId) || (pBuffer->next <= pBuffer->capacity))
+			continue;
+
+		LONGLONG oldestEnd = pBuffer->events[pBuffer->next & (pBuffer->capacity - 1)].end;
+		while ((firstFrame + 1 < frameCount) && (frameStarts[firstFrame & (FRAME_COUNT - 1)] <= oldestEnd))
+			firstFrame++;
+	}
+	if (frameCount - firstFrame < frames) {
+		char buf[128];
+		sprintf_s(buf, "ProxyProfiler: Dumping %u of %u frames, older scopes were overwritten.\n",
+			frameCount - firstFrame, frames);
+		OutputDebugString(buf);
+	}
+
+	LONGLONG from = (frameCount > 0) ? frameStarts[firstFrame & (FRAME_COUNT - 1)] : 0;
+	DWORD processId = GetCurrentProcessId();
+	bool first = true;
+	fprintf(pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	// frame markers
+	for (UINT frame = firstFrame; frame < frameCount; frame++) {
+		LONGLONG start = frameStarts[frame & (FRAME_COUNT - 1)];
+		fprintf(pFile, "%s{\"name\":\"Frame %u\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":%u,\"tid\":0}",
+			first ? "" : ",\n", frame, (double)(start - from) * toMicroseconds, processId);
+		first = false;
+	}
+
+	// scopes, oldest first per thread
+	for (std::vector<void*>::size_type i = 0; i < profilerThreadBuffers.buffers.size(); i++) {
+		ThreadBuffer* pBuffer = (ThreadBuffer*)profilerThreadBuffers.buffers[i];
+		UINT next = pBuffer->next;
+		UINT mask = pBuffer->capacity - 1;
+		UINT count = (next < pBuffer->capacity) ? next : pBuffer->capacity;
+
+		if (next > pBuffer->capacity) {
+			LONGLONG oldestEnd = pBuffer->events[next & mask].end;
+			if (oldestEnd > from) {
+				fprintf(pFile, "%s{\"name\":\"Scopes dropped\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u}",
+					first ? "" : ",\n", (double)(oldestEnd - from) * toMicroseconds, processId, pBuffer->threadId);
+				first = false;
+			}
+		}
+
+		for (UINT j = next - count; j != next; j++) {
+			ProfilerEvent event = pBuffer->events[j & mask];
+			if (!event.name || event.start < from || event.end < event.start)
+				continue;
+
+			fprintf(pFile, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u}",
+				first ? "" : ",\n", event.name, (double)(event.start - from) * toMicroseconds,
+				(double)(event.end - event.start) * toMicroseconds, processId, pBuffer->threadId);
+			first = false;
+		}
+	}
+	LeaveCriticalSection(&profilerThreadBuffers.lock);
+
+	fprintf(pFile, "\n]}\n");
+	fclose(pFile);
+	return true;
+}
+
+/**
+* Hands the ring buffer of the calling thread back for reuse.
+* Called on DLL_THREAD_DETACH. The recorded scopes stay dumpable until another thread takes the buffer.
+***/
+void ProxyProfiler::ReleaseThread()
+{
+	if (dwProfilerTlsIndex == TLS_OUT_OF_INDEXES)
+		return;
+
+	ThreadBuffer* pBuffer = (ThreadBuffer*)TlsGetValue(dwProfilerTlsIndex);
+	if (!pBuffer)
+		return;
+	TlsSetValue(dwProfilerTlsIndex, NULL);
+
+	EnterCriticalSection(&profilerThreadBuffers.lock);
+	pBuffer->released = true;
+	LeaveCriticalSection(&profilerThreadBuffers.lock);
+}
+
+/**
+* Assigns a ring buffer to the calling thread, a released one of the same capacity if available.
+* New buffers are registered for Dump().
+* @param capacity Number of events (power of two).
+***/
+ProxyProfiler::ThreadBuffer* ProxyProfiler::AcquireThreadBuffer(UINT capacity)
+{
+	if (dwProfilerTlsIndex == TLS_OUT_OF_INDEXES)
+		return NULL;
+
+	ThreadBuffer* pBuffer = NULL;
+	EnterCriticalSection(&profilerThreadBuffers.lock);
+	for (std::vector<void*>::size_type i = 0; i < profilerThreadBuffers.buffers.size(); i++) {
+		ThreadBuffer* pReleased = (ThreadBuffer*)profilerThreadBuffers.buffers[i];
+		if (pReleased->released && (pReleased->capacity == capacity)) {
+			pBuffer = pReleased;
+			pBuffer->threadId = GetCurrentThreadId();
+			pBuffer->next = 0;
+			pBuffer->released = false;
+			ZeroMemory(pBuffer->events, capacity * sizeof(ProfilerEvent));
+			break;
+		}
+	}
+	LeaveCriticalSection(&profilerThreadBuffers.lock);
+
+	if (!pBuffer) {
+		SIZE_T size = offsetof(ThreadBuffer, events) + capacity * sizeof(ProfilerEvent);
+		pBuffer = (ThreadBuffer*)VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+		if (!pBuffer) {
+			OutputDebugString("ProxyProfiler: Failed to allocate thread buffer, profiler disabled.\n");
+			s_enabled = false;
+			return NULL;
+		}
+
+		// VirtualAlloc returns zeroed memory
+		pBuffer->threadId = GetCurrentThreadId();
+		pBuffer->capacity = capacity;
+		pBuffer->next = 0;
+		pBuffer->released = false;
+
+		EnterCriticalSection(&profilerThreadBuffers.lock);
+		profilerThreadBuffers.buffers.push_back(pBuffer);
+		LeaveCriticalSection(&profilerThreadBuffers.lock);
+	}
+
+	TlsSetValue(dwProfilerTlsIndex, pBuffer);
+	return pBuffer;
+}
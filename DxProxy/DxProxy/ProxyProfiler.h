@@ -0,0 +1,155 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ProxyProfiler.h> and
+Class <ProxyProfiler> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef PROXYPROFILER_H_INCLUDED
+#define PROXYPROFILER_H_INCLUDED
+
+#include <windows.h>
+
+/**
+* Opens a profiler scope named by a string literal, closed at the end of the enclosing block.
+* Define VIREIO_NO_PROFILER to compile all scopes out.
+***/
+#ifndef VIREIO_NO_PROFILER
+#define PROXY_PROFILE_SCOPE(name) ProfilerScope profilerScope(name)
+#else
+#define PROXY_PROFILE_SCOPE(name)
+#endif
+
+/**
+* One timed scope.
+* Timestamps are raw performance counter ticks, converted on dump.
+***/
+struct ProfilerEvent
+{
+	const char* name;  /**< Scope name, must be a string literal (only the pointer is stored). */
+	LONGLONG    start; /**< Performance counter at scope entry. */
+	LONGLONG    end;   /**< Performance counter at scope exit. */
+};
+
+/**
+* Scoped CPU timing profiler.
+* Every thread records its scopes into an own fixed size ring buffer, so recording takes no lock
+* and never allocates (apart from the first scope of a thread). The render thread marks every frame
+* on Present, Dump() writes the scopes of the last frames as Chrome trace event JSON
+* (to be opened in chrome://tracing).
+* Only the thread marking frames gets a ring large enough for FRAME_COUNT frames, other threads (game
+* loader threads creating shaders) get a small one. The ring of an exited thread is recycled for the
+* next new thread, its scopes can be dumped until then.
+* @see ProfilerScope
+*/
+class ProxyProfiler
+{
+public:
+	/*** ProxyProfiler public methods ***/
+	static void     SetEnabled(bool enabled);
+	static void     Record(const char* name, LONGLONG start, LONGLONG end);
+	static void     MarkFrame();
+	static bool     Dump(const char* fileName, UINT frames);
+	static void     ReleaseThread();
+
+	/**
+	* Current performance counter ticks, 0 if the profiler is disabled.
+	***/
+	static LONGLONG Now()
+	{
+		if (!s_enabled)
+			return 0;
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return counter.QuadPart;
+	}
+
+	/**
+	* Frame start timestamps kept (power of two), maximum frames to dump.
+	***/
+	static const UINT FRAME_COUNT = 256;
+	/**
+	* Scopes per frame the ring of the frame marking thread is sized for.
+	* A stereo frame records about two scopes per draw call on the render thread, heavier frames
+	* shorten the dump (see Dump()).
+	***/
+	static const UINT FRAME_EVENTS = 1024;
+	/**
+	* Events of the ring of the frame marking thread (power of two, at least FRAME_COUNT * FRAME_EVENTS).
+	***/
+	static const UINT FRAME_THREAD_EVENT_COUNT = 1 << 18;
+	/**
+	* Events of the ring of any other thread (power of two).
+	***/
+	static const UINT THREAD_EVENT_COUNT = 1 << 12;
+
+private:
+	/**
+	* Ring buffer of one thread.
+	* Written by the owning thread only, read by Dump().
+	***/
+	struct ThreadBuffer
+	{
+		DWORD         threadId;  /**< Owning thread (last owner if released). */
+		UINT          capacity;  /**< Number of events (power of two). */
+		volatile UINT next;      /**< Total number of events recorded, next write position masked. */
+		bool          released;  /**< True if the owning thread exited, the buffer is free for the next thread. */
+		ProfilerEvent events[1]; /**< The event ring (capacity events). */
+	};
+
+	/*** ProxyProfiler private methods ***/
+	static ThreadBuffer* AcquireThreadBuffer(UINT capacity);
+
+	/**
+	* True if scopes are recorded.
+	***/
+	static volatile bool s_enabled;
+};
+
+/**
+* Times the enclosing block.
+* Do not use directly, use PROXY_PROFILE_SCOPE.
+*/
+class ProfilerScope
+{
+public:
+	ProfilerScope(const char* name) : m_name(name), m_start(ProxyProfiler::Now()) {}
+	~ProfilerScope()
+	{
+		if (m_start)
+			ProxyProfiler::Record(m_name, m_start, ProxyProfiler::Now());
+	}
+
+private:
+	/**
+	* Scope name.
+	***/
+	const char* m_name;
+	/**
+	* Performance counter at scope entry, 0 if the profiler was disabled.
+	***/
+	LONGLONG m_start;
+};
+#endif
@@ -0,0 +1,127 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <RegisterPages.cpp> and
+Class <RegisterPages> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "RegisterPages.h"
+
+/**
+* Constructor.
+* @param registerCount Number of registers in the register file.
+***/
+RegisterPages::RegisterPages(UINT registerCount) :
+	m_registerCount(registerCount),
+	m_pages((registerCount + REGISTERS_PER_PAGE - 1) / REGISTERS_PER_PAGE),
+	m_current()
+{
+}
+
+/**
+* Destructor.
+***/
+RegisterPages::~RegisterPages()
+{
+}
+
+/**
+* To be called for every write to the register file, drops the page copies of the written registers.
+* @param start First register written.
+* @param count Number of registers written.
+***/
+void RegisterPages::Written(UINT start, UINT count)
+{
+	if ((start >= m_registerCount) || (count == 0))
+		return;
+	if (count > m_registerCount - start)
+		count = m_registerCount - start;
+
+	UINT endPage = (start + count - 1) / REGISTERS_PER_PAGE;
+	for (UINT page = start / REGISTERS_PER_PAGE; page <= endPage; page++)
+		m_pages[page].reset();
+
+	m_current.reset();
+}
+
+/**
+* Captures the register file.
+* Only pages written since their last capture are copied.
+* @param pRegisters The register file.
+***/
+std::shared_ptr<const RegisterPages::Snapshot> RegisterPages::Capture(const float* pRegisters)
+{
+	if (m_current)
+		return m_current;
+
+	std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+	for (UINT page = 0; page < m_pages.size(); page++) {
+		if (!m_pages[page]) {
+			std::shared_ptr<Page> copy = std::make_shared<Page>();
+			memcpy(copy->registers, pRegisters + page * REGISTERS_PER_PAGE * REGISTER_FLOATS, PageFloats(page) * sizeof(float));
+			m_pages[page] = copy;
+		}
+	}
+	snapshot->pages = m_pages;
+
+	m_current = snapshot;
+	return m_current;
+}
+
+/**
+* Restores a snapshot to the register file.
+* Only pages that differ from the current register file are copied.
+* @param snapshot The snapshot, captured from this register file.
+* @param pRegisters The register file.
+* @return False if the register file already matched the snapshot.
+***/
+bool RegisterPages::Restore(const std::shared_ptr<const Snapshot>& snapshot, float* pRegisters)
+{
+	if (snapshot == m_current)
+		return false;
+
+	for (UINT page = 0; page < m_pages.size(); page++) {
+		if (snapshot->pages[page] != m_pages[page]) {
+			memcpy(pRegisters + page * REGISTERS_PER_PAGE * REGISTER_FLOATS, snapshot->pages[page]->registers, PageFloats(page) * sizeof(float));
+			m_pages[page] = snapshot->pages[page];
+		}
+	}
+
+	m_current = snapshot;
+	return true;
+}
+
+/**
+* Number of floats of a page in use, the last page might not be full.
+* @param page The page.
+***/
+UINT RegisterPages::PageFloats(UINT page)
+{
+	UINT registers = m_registerCount - page * REGISTERS_PER_PAGE;
+	if (registers > REGISTERS_PER_PAGE)
+		registers = REGISTERS_PER_PAGE;
+
+	return registers * REGISTER_FLOATS;
+}
@@ -0,0 +1,111 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <RegisterPages.h> and
+Class <RegisterPages> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef REGISTERPAGES_H_INCLUDED
+#define REGISTERPAGES_H_INCLUDED
+
+#include <d3d9.h>
+#include <vector>
+#include <memory>
+
+/**
+* Incremental snapshots of a float constant register file.
+* The register file itself stays a plain float array owned by ShaderRegisters, this class keeps
+* immutable, reference counted copies of its pages. A page copy is made the first time the page is
+* captured after it was written, pages not written since the last capture are shared by all
+* snapshots. A capture without any writes since the last one returns the very same snapshot.
+* Restoring a snapshot only copies the pages that differ from the current register file, which is
+* known by comparing page pointers.
+* The pages are not the live storage (that would make capture a reference count increment only) :
+* register runs are uploaded and modified across page boundaries, which needs one contiguous array.
+* A page written between two captures is copied once either way, at the capture here instead of at
+* the first write. Every page copy is an allocation, after writes to many pages a capture costs more
+* than one copy of the whole register file, the gain is in captures without writes and in the memory
+* shared by state blocks.
+* @see ShaderRegisters
+*/
+class RegisterPages
+{
+public:
+	/**
+	* Registers per page.
+	***/
+	static const UINT REGISTERS_PER_PAGE = 16;
+	/**
+	* Floats per register.
+	***/
+	static const UINT REGISTER_FLOATS = 4;
+
+	/**
+	* One page of registers, never changed once created.
+	***/
+	struct Page
+	{
+		float registers[REGISTERS_PER_PAGE * REGISTER_FLOATS];
+	};
+
+	/**
+	* Captured register file, one page pointer per page.
+	***/
+	struct Snapshot
+	{
+		std::vector<std::shared_ptr<const Page>> pages;
+	};
+
+	RegisterPages(UINT registerCount);
+	virtual ~RegisterPages();
+
+	/*** RegisterPages public methods ***/
+	void                            Written(UINT start, UINT count);
+	std::shared_ptr<const Snapshot> Capture(const float* pRegisters);
+	bool                            Restore(const std::shared_ptr<const Snapshot>& snapshot, float* pRegisters);
+
+private:
+	/*** RegisterPages private methods ***/
+	UINT PageFloats(UINT page);
+
+	/**
+	* Number of registers in the register file.
+	***/
+	UINT m_registerCount;
+	/**
+	* Page copies matching the current register file, NULL for pages written since their last capture.
+	***/
+	std::vector<std::shared_ptr<const Page>> m_pages;
+	/**
+	* Snapshot matching the current register file, NULL if anything was written since.
+	***/
+	std::shared_ptr<const Snapshot> m_current;
+};
+
+/**
+* Register file snapshot as stored in state blocks.
+***/
+typedef std::shared_ptr<const RegisterPages::Snapshot> RegisterSnapshot;
+#endif
@@ -0,0 +1,307 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ShaderAnalysisCache.cpp> and
+Class <ShaderAnalysisCache> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ShaderAnalysisCache.h"
+
+/**
+* Cache file magic, "VSAC".
+***/
+#define CACHE_MAGIC 0x43415356
+/**
+* Cache file version.
+***/
+#define CACHE_VERSION 2
+/**
+* Cache files larger than this are started over (old rule sets pile up while rules are edited).
+***/
+#define CACHE_MAX_FILE_SIZE (64 * 1024 * 1024)
+
+/**
+* Constructor.
+* Creates a closed cache, records added are kept in memory only.
+***/
+ShaderAnalysisCache::ShaderAnalysisCache() :
+	m_hFile(NULL),
+	m_hMapFile(NULL),
+	m_pView(NULL),
+	m_index(),
+	m_added()
+{
+}
+
+/**
+* Destructor.
+* Closes the cache file.
+***/
+ShaderAnalysisCache::~ShaderAnalysisCache()
+{
+	Close();
+}
+
+/**
+* Opens (or creates) the cache file and indexes its records.
+* Files with an unknown header are started over.
+* @param path Cache file path.
+* @return False if the file can't be opened, records are then kept in memory only.
+***/
+bool ShaderAnalysisCache::Open(std::string path)
+{
+	Close();
+
+	m_hFile = CreateFile(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE) {
+		m_hFile = NULL;
+		OutputDebugString("ShaderAnalysisCache::Open - Can't open shader analysis cache file: ");
+		OutputDebugString(path.c_str());
+		OutputDebugString("\n");
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(m_hFile, &fileSize))
+		fileSize.QuadPart = 0;
+
+	FileHeader header = { 0, 0 };
+	DWORD bytesRead = 0;
+	if ((fileSize.QuadPart >= sizeof(FileHeader)) && (fileSize.QuadPart <= CACHE_MAX_FILE_SIZE))
+		ReadFile(m_hFile, &header, sizeof(FileHeader), &bytesRead, NULL);
+
+	UINT size = (UINT)fileSize.QuadPart;
+	if ((bytesRead != sizeof(FileHeader)) || (header.magic != CACHE_MAGIC) || (header.version != CACHE_VERSION)) {
+
+		// start over
+		header.magic = CACHE_MAGIC;
+		header.version = CACHE_VERSION;
+		DWORD bytesWritten = 0;
+		if (!Truncate(0) || !WriteFile(m_hFile, &header, sizeof(FileHeader), &bytesWritten, NULL) || (bytesWritten != sizeof(FileHeader))) {
+			OutputDebugString("ShaderAnalysisCache::Open - Can't write shader analysis cache file\n");
+			Close();
+			return false;
+		}
+		size = sizeof(FileHeader);
+	}
+
+	if ((size > sizeof(FileHeader)) && Map()) {
+		UINT validSize = sizeof(FileHeader) + Index(m_pView + sizeof(FileHeader), size - sizeof(FileHeader));
+
+		// cut off a damaged record at the end, the file can't be truncated while it is mapped
+		if (validSize < size) {
+			OutputDebugString("ShaderAnalysisCache::Open - Damaged record at the end of the shader analysis cache file removed\n");
+			Unmap();
+			if (!Truncate(validSize)) {
+				Close();
+				return false;
+			}
+			if (validSize > sizeof(FileHeader) && Map())
+				Index(m_pView + sizeof(FileHeader), validSize - sizeof(FileHeader));
+		}
+	}
+
+	// records are appended
+	LARGE_INTEGER zero;
+	zero.QuadPart = 0;
+	SetFilePointerEx(m_hFile, zero, NULL, FILE_END);
+
+	return true;
+}
+
+/**
+* Closes the cache file and drops all records.
+***/
+void ShaderAnalysisCache::Close()
+{
+	Unmap();
+
+	if (m_hFile) {
+		CloseHandle(m_hFile);
+		m_hFile = NULL;
+	}
+
+	m_added.clear();
+}
+
+/**
+* Returns the cached analysis of a shader, NULL if the shader was not analysed with that rule set.
+* The record stays valid until the cache is closed.
+* @param ruleSetHash Hash of the current rule set.
+* @param shaderHash Hash of the shader bytecode.
+* @param shaderSize Size of the shader bytecode in bytes.
+***/
+const ShaderAnalysisCache::CachedShader* ShaderAnalysisCache::Find(UINT ruleSetHash, UINT shaderHash, UINT shaderSize)
+{
+	auto it = m_index.find(Key(ruleSetHash, shaderHash));
+	if ((it == m_index.end()) || (it->second->shaderSize != shaderSize))
+		return NULL;
+
+	return it->second;
+}
+
+/**
+* Adds the analysis of a shader and appends it to the cache file (if open).
+* @param ruleSetHash Hash of the current rule set.
+* @param shaderHash Hash of the shader bytecode.
+* @param shaderSize Size of the shader bytecode in bytes.
+* @param constants The modified constants of the shader.
+* @param pUsedRegisters The float registers read by the shader, NULL if unknown.
+***/
+void ShaderAnalysisCache::Add(UINT ruleSetHash, UINT shaderHash, UINT shaderSize, const std::vector<CachedConstant>& constants, const std::vector<DWORD>* pUsedRegisters)
+{
+	CachedShader shader;
+	shader.ruleSetHash = ruleSetHash;
+	shader.shaderHash = shaderHash;
+	shader.shaderSize = shaderSize;
+	shader.constantCount = (WORD)min(constants.size(), (size_t)0xFFFF);
+	shader.usedRegisterWords = pUsedRegisters ? (WORD)min(pUsedRegisters->size(), (size_t)(USAGE_UNKNOWN - 1)) : USAGE_UNKNOWN;
+
+	m_added.push_back(std::vector<BYTE>(RecordSize(&shader)));
+	BYTE* pRecord = &m_added.back()[0];
+	memcpy(pRecord, &shader, sizeof(CachedShader));
+	if (shader.constantCount)
+		memcpy(pRecord + sizeof(CachedShader), &constants[0], shader.constantCount * sizeof(CachedConstant));
+	if (pUsedRegisters && shader.usedRegisterWords)
+		memcpy(pRecord + sizeof(CachedShader) + shader.constantCount * sizeof(CachedConstant), &(*pUsedRegisters)[0], shader.usedRegisterWords * sizeof(DWORD));
+
+	m_index[Key(ruleSetHash, shaderHash)] = reinterpret_cast<const CachedShader*>(pRecord);
+
+	if (m_hFile) {
+		DWORD bytesWritten = 0;
+		if (!WriteFile(m_hFile, pRecord, (DWORD)m_added.back().size(), &bytesWritten, NULL) || (bytesWritten != m_added.back().size())) {
+			OutputDebugString("ShaderAnalysisCache::Add - Can't write shader analysis cache file, no more records are saved\n");
+			CloseHandle(m_hFile);
+			m_hFile = NULL;
+		}
+	}
+}
+
+/**
+* Returns the modified constants of a cached shader (constantCount constants).
+* @param pShader The cached shader.
+***/
+const ShaderAnalysisCache::CachedConstant* ShaderAnalysisCache::Constants(const CachedShader* pShader)
+{
+	return reinterpret_cast<const CachedConstant*>(pShader + 1);
+}
+
+/**
+* Returns the used register mask of a cached shader (usedRegisterWords words).
+* @param pShader The cached shader.
+***/
+const DWORD* ShaderAnalysisCache::UsedRegisters(const CachedShader* pShader)
+{
+	return reinterpret_cast<const DWORD*>(Constants(pShader) + pShader->constantCount);
+}
+
+/**
+* Maps the whole cache file read only.
+***/
+bool ShaderAnalysisCache::Map()
+{
+	m_hMapFile = CreateFileMapping(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_hMapFile == NULL)
+		return false;
+
+	m_pView = (const BYTE*)MapViewOfFile(m_hMapFile, FILE_MAP_READ, 0, 0, 0);
+	if (m_pView == NULL) {
+		CloseHandle(m_hMapFile);
+		m_hMapFile = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+* Unmaps the cache file, records of the mapped view are removed from the index.
+***/
+void ShaderAnalysisCache::Unmap()
+{
+	m_index.clear();
+
+	if (m_pView) {
+		UnmapViewOfFile(m_pView);
+		m_pView = NULL;
+	}
+
+	if (m_hMapFile) {
+		CloseHandle(m_hMapFile);
+		m_hMapFile = NULL;
+	}
+}
+
+/**
+* Truncates the (unmapped) cache file.
+* @param size New file size in bytes.
+***/
+bool ShaderAnalysisCache::Truncate(UINT size)
+{
+	LARGE_INTEGER position;
+	position.QuadPart = size;
+
+	return SetFilePointerEx(m_hFile, position, NULL, FILE_BEGIN) && SetEndOfFile(m_hFile);
+}
+
+/**
+* Indexes the records of the mapped view, later records replace earlier ones with the same key.
+* @param pRecords First record.
+* @param size Size of the records in bytes.
+* @return Size of the complete records in bytes.
+***/
+UINT ShaderAnalysisCache::Index(const BYTE* pRecords, UINT size)
+{
+	UINT offset = 0;
+	while (size - offset >= sizeof(CachedShader)) {
+		const CachedShader* pShader = reinterpret_cast<const CachedShader*>(pRecords + offset);
+		UINT recordSize = RecordSize(pShader);
+		if (recordSize > size - offset)
+			break;
+
+		m_index[Key(pShader->ruleSetHash, pShader->shaderHash)] = pShader;
+		offset += recordSize;
+	}
+
+	return offset;
+}
+
+/**
+* Returns the size of a record in bytes.
+* @param pShader The record header.
+***/
+UINT ShaderAnalysisCache::RecordSize(const CachedShader* pShader)
+{
+	UINT words = (pShader->usedRegisterWords == USAGE_UNKNOWN) ? 0 : pShader->usedRegisterWords;
+	return sizeof(CachedShader) + pShader->constantCount * sizeof(CachedConstant) + words * sizeof(DWORD);
+}
+
+/**
+* Returns the index key of a shader analysed with a rule set.
+***/
+UINT64 ShaderAnalysisCache::Key(UINT ruleSetHash, UINT shaderHash)
+{
+	return ((UINT64)ruleSetHash << 32) | shaderHash;
+}
@@ -0,0 +1,131 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ShaderAnalysisCache.h> and
+Class <ShaderAnalysisCache> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef SHADERANALYSISCACHE_H_INCLUDED
+#define SHADERANALYSISCACHE_H_INCLUDED
+
+#include <d3d9.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+
+/**
+* Persistent shader analysis cache.
+* Maps a shader (bytecode hash and size) analysed with a given rule set (rule set hash) to the
+* resolved modified constants and the float registers the shader reads, so shaders analysed in an
+* earlier session do not need their constant table parsed again.
+* The cache file is memory mapped when opened, lookups return records in the mapped view. Records
+* added later are kept in memory and appended to the file. A damaged record at the end of the file
+* (left by a process killed while writing) is cut off when the file is opened.
+* @see ShaderModificationRepository
+*/
+class ShaderAnalysisCache
+{
+public:
+	ShaderAnalysisCache();
+	virtual ~ShaderAnalysisCache();
+
+	/**
+	* One cached modified constant.
+	***/
+	struct CachedConstant
+	{
+		WORD startRegister;      /**< Shader constant start register. */
+		WORD count;              /**< Register count. */
+		UINT modificationRuleID; /**< The rule applied to the constant. */
+	};
+
+	/**
+	* One cached shader analysis (record header).
+	* Followed by constantCount CachedConstant and usedRegisterWords register mask words.
+	***/
+	struct CachedShader
+	{
+		UINT ruleSetHash;       /**< Hash of the rule set the shader was analysed with. */
+		UINT shaderHash;        /**< Hash of the shader bytecode. */
+		UINT shaderSize;        /**< Size of the shader bytecode in bytes. */
+		WORD constantCount;     /**< Number of modified constants. */
+		WORD usedRegisterWords; /**< Size of the used register mask in words, USAGE_UNKNOWN if the shader may read any register. */
+	};
+
+	/**
+	* usedRegisterWords of shaders without constant table.
+	***/
+	static const WORD USAGE_UNKNOWN = 0xFFFF;
+
+	/*** ShaderAnalysisCache public methods ***/
+	bool                         Open(std::string path);
+	void                         Close();
+	const CachedShader*          Find(UINT ruleSetHash, UINT shaderHash, UINT shaderSize);
+	void                         Add(UINT ruleSetHash, UINT shaderHash, UINT shaderSize, const std::vector<CachedConstant>& constants, const std::vector<DWORD>* pUsedRegisters);
+	static const CachedConstant* Constants(const CachedShader* pShader);
+	static const DWORD*          UsedRegisters(const CachedShader* pShader);
+
+private:
+	/**
+	* Cache file header.
+	***/
+	struct FileHeader
+	{
+		DWORD magic;   /**< CACHE_MAGIC. */
+		DWORD version; /**< CACHE_VERSION, changed whenever the record layout or the analysis changes. */
+	};
+
+	/*** ShaderAnalysisCache private methods ***/
+	bool          Map();
+	void          Unmap();
+	bool          Truncate(UINT size);
+	UINT          Index(const BYTE* pRecords, UINT size);
+	static UINT   RecordSize(const CachedShader* pShader);
+	static UINT64 Key(UINT ruleSetHash, UINT shaderHash);
+
+	/**
+	* The cache file, NULL if not open.
+	***/
+	HANDLE m_hFile;
+	/**
+	* Handle to the file mapping object, NULL if not mapped.
+	***/
+	HANDLE m_hMapFile;
+	/**
+	* Mapped view of the cache file, NULL if not mapped.
+	***/
+	const BYTE* m_pView;
+	/**
+	* Records by key, pointing into the mapped view or into m_added.
+	* <Key(rule set hash, shader hash), record>
+	***/
+	std::unordered_map<UINT64, const CachedShader*> m_index;
+	/**
+	* Records added since the cache was opened (a deque never moves its elements).
+	***/
+	std::deque<std::vector<BYTE>> m_added;
+};
+#endif
@@ -0,0 +1,220 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ShaderAnalysisQueue.cpp> and
+Class <ShaderAnalysisQueue> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ShaderAnalysisQueue.h"
+#include "ShaderModificationRepository.h"
+
+/**
+* Constructor.
+* Starts the worker threads. Without workers (none could be started) shaders are analysed when queued.
+* @param pModLoader The repository analysing the shaders, has to outlive the queue.
+* @param threadCount Number of worker threads.
+***/
+ShaderAnalysisQueue::ShaderAnalysisQueue(ShaderModificationRepository* pModLoader, UINT threadCount) :
+	m_pModLoader(pModLoader),
+	m_threads(),
+	m_jobs(),
+	m_stop(false),
+	m_depth(0),
+	m_stalls(0),
+	m_stallMicroseconds(0)
+{
+	InitializeCriticalSection(&m_lock);
+	InitializeConditionVariable(&m_jobQueued);
+	InitializeConditionVariable(&m_jobDone);
+
+	for (UINT i = 0; i < threadCount; i++) {
+		HANDLE hThread = CreateThread(NULL, 0, WorkerThread, this, 0, NULL);
+		if (hThread == NULL) {
+			OutputDebugString("ShaderAnalysisQueue - Can't create worker thread\n");
+			break;
+		}
+		m_threads.push_back(hThread);
+	}
+}
+
+/**
+* Destructor.
+* Finishes all queued analyses, then stops the worker threads. Jobs taken over by Finish() on other
+* threads are waited for, no job is left undone.
+***/
+ShaderAnalysisQueue::~ShaderAnalysisQueue()
+{
+	{
+		CriticalSectionLock lock(&m_lock);
+		m_stop = true;
+		WakeAllConditionVariable(&m_jobQueued);
+	}
+
+	for (auto itThread = m_threads.begin(); itThread != m_threads.end(); ++itThread) {
+		WaitForSingleObject(*itThread, INFINITE);
+		CloseHandle(*itThread);
+	}
+
+	{
+		CriticalSectionLock lock(&m_lock);
+		while (m_depth > 0)
+			SleepConditionVariableCS(&m_jobDone, &m_lock, INFINITE);
+	}
+
+	DeleteCriticalSection(&m_lock);
+}
+
+/**
+* Queues the analysis of a shader function.
+* @param function [in, out] The shader function, taken over by the job (left empty).
+* @return The job, Finish() it before using the result.
+***/
+std::shared_ptr<ShaderAnalysisQueue::Job> ShaderAnalysisQueue::Enqueue(std::vector<BYTE>& function)
+{
+	std::shared_ptr<Job> spJob = std::make_shared<Job>();
+	spJob->function.swap(function);
+	spJob->state = Job_Queued;
+	spJob->pQueue = this;
+	InterlockedIncrement(&m_depth);
+
+	if (m_threads.empty()) {
+		InterlockedExchange(&spJob->state, Job_Running);
+		Run(spJob.get());
+		return spJob;
+	}
+
+	CriticalSectionLock lock(&m_lock);
+	m_jobs.push_back(spJob);
+	WakeConditionVariable(&m_jobQueued);
+
+	return spJob;
+}
+
+/**
+* Makes sure a job is done.
+* A job no worker has started yet is run on the calling thread, a running job is waited for. The time
+* spent is counted as a stall.
+* A done job does not touch its queue. The queue of a job that is not done yet is alive, the queue
+* destructor waits for all of its jobs. The stall is counted before the job is done for the same reason.
+* @param pJob The job.
+***/
+void ShaderAnalysisQueue::Finish(Job* pJob)
+{
+	if (pJob->state == Job_Done)
+		return;
+
+	ShaderAnalysisQueue* pQueue = pJob->pQueue;
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+
+	if (InterlockedCompareExchange(&pJob->state, Job_Running, Job_Queued) == Job_Queued) {
+		pQueue->Run(pJob, &start);
+	}
+	else {
+		CriticalSectionLock lock(&pQueue->m_lock);
+		while (pJob->state != Job_Done)
+			SleepConditionVariableCS(&pQueue->m_jobDone, &pQueue->m_lock, INFINITE);
+		pQueue->CountStall(start);
+	}
+}
+
+/**
+* Returns the number of queued or running jobs.
+***/
+UINT ShaderAnalysisQueue::Depth()
+{
+	return (UINT)m_depth;
+}
+
+/**
+* Returns the stalls since the last call and resets them.
+* @param pStalls [out] Number of Finish() calls that had to run or wait for an analysis.
+* @param pStallMicroseconds [out] Time spent in these calls, in microseconds.
+***/
+void ShaderAnalysisQueue::TakeStalls(UINT* pStalls, UINT* pStallMicroseconds)
+{
+	*pStalls = (UINT)InterlockedExchange(&m_stalls, 0);
+	*pStallMicroseconds = (UINT)InterlockedExchange(&m_stallMicroseconds, 0);
+}
+
+/**
+* Analyses the shader of a job (job state is running) and marks the job done.
+* @param pJob The job.
+* @param pStallStart Start of the stall if run by Finish(), NULL if run by a worker.
+***/
+void ShaderAnalysisQueue::Run(Job* pJob, const LARGE_INTEGER* pStallStart)
+{
+	if (!pJob->function.empty())
+		pJob->result = m_pModLoader->ModifiedConstantsFromFunction(&pJob->function[0], (UINT)pJob->function.size());
+	std::vector<BYTE>().swap(pJob->function);
+
+	CriticalSectionLock lock(&m_lock);
+	if (pStallStart)
+		CountStall(*pStallStart);
+	InterlockedExchange(&pJob->state, Job_Done);
+	InterlockedDecrement(&m_depth);
+	WakeAllConditionVariable(&m_jobDone);
+}
+
+/**
+* Counts a stall of Finish().
+* @param start Start of the stall.
+***/
+void ShaderAnalysisQueue::CountStall(const LARGE_INTEGER& start)
+{
+	LARGE_INTEGER end, frequency;
+	QueryPerformanceCounter(&end);
+	QueryPerformanceFrequency(&frequency);
+	InterlockedIncrement(&m_stalls);
+	InterlockedExchangeAdd(&m_stallMicroseconds, (LONG)((end.QuadPart - start.QuadPart) * 1000000 / frequency.QuadPart));
+}
+
+/**
+* Worker thread, runs queued jobs until the queue is stopped and empty.
+* Jobs already taken over by Finish() are dropped.
+* @param lpParameter The queue.
+***/
+DWORD WINAPI ShaderAnalysisQueue::WorkerThread(LPVOID lpParameter)
+{
+	ShaderAnalysisQueue* pQueue = static_cast<ShaderAnalysisQueue*>(lpParameter);
+
+	for (;;) {
+		std::shared_ptr<Job> spJob;
+		{
+			CriticalSectionLock lock(&pQueue->m_lock);
+			while (pQueue->m_jobs.empty() && !pQueue->m_stop)
+				SleepConditionVariableCS(&pQueue->m_jobQueued, &pQueue->m_lock, INFINITE);
+
+			if (pQueue->m_jobs.empty())
+				return 0;
+
+			spJob = pQueue->m_jobs.front();
+			pQueue->m_jobs.pop_front();
+		}
+
+		if (InterlockedCompareExchange(&spJob->state, Job_Running, Job_Queued) == Job_Queued)
+			pQueue->Run(spJob.get());
+	}
+}
@@ -0,0 +1,150 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ShaderAnalysisQueue.h> and
+Class <ShaderAnalysisQueue> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef SHADERANALYSISQUEUE_H_INCLUDED
+#define SHADERANALYSISQUEUE_H_INCLUDED
+
+#include <d3d9.h>
+#include <vector>
+#include <deque>
+#include <memory>
+#include "StereoConstantTable.h"
+
+class ShaderModificationRepository;
+
+/**
+* Holds a critical section for the lifetime of the object.
+***/
+class CriticalSectionLock
+{
+public:
+	CriticalSectionLock(CRITICAL_SECTION* pCriticalSection) : m_pCriticalSection(pCriticalSection) { EnterCriticalSection(m_pCriticalSection); }
+	~CriticalSectionLock() { LeaveCriticalSection(m_pCriticalSection); }
+
+private:
+	CriticalSectionLock(const CriticalSectionLock&);
+	CriticalSectionLock& operator=(const CriticalSectionLock&);
+
+	/**
+	* The held critical section.
+	***/
+	CRITICAL_SECTION* m_pCriticalSection;
+};
+
+/**
+* Shader analysis worker pool.
+* Proxy shaders queue the analysis of their function (hash, constant table, rule matching) on
+* creation and pick up the result when they are first used, so shader creation does not wait for the
+* analysis. A shader used before a worker got to it is analysed on the using thread, a shader used
+* while a worker analyses it waits for that worker (a stall).
+* Destroying the queue finishes all queued analyses and waits for analyses run by Finish() on other
+* threads, so every job is done once the queue is gone and Finish() never touches a destroyed queue.
+* @see ShaderModificationRepository::ModifiedConstantsFromFunction()
+*/
+class ShaderAnalysisQueue
+{
+public:
+	ShaderAnalysisQueue(ShaderModificationRepository* pModLoader, UINT threadCount);
+	virtual ~ShaderAnalysisQueue();
+
+	/**
+	* Analysis states.
+	***/
+	enum JobStates
+	{
+		Job_Queued,
+		Job_Running,
+		Job_Done
+	};
+
+	/**
+	* One shader analysis, shared by the queue and the proxy shaders of the analysed function.
+	***/
+	struct Job
+	{
+		std::vector<BYTE>    function; /**< Copy of the shader function, released when analysed. */
+		StereoConstantTable  result;   /**< The modified constants, valid when done. */
+		volatile LONG        state;    /**< JobStates. */
+		ShaderAnalysisQueue* pQueue;   /**< The queue running the job, only used while the job is not done. */
+	};
+
+	/*** ShaderAnalysisQueue public methods ***/
+	std::shared_ptr<Job> Enqueue(std::vector<BYTE>& function);
+	static void          Finish(Job* pJob);
+	UINT                 Depth();
+	void                 TakeStalls(UINT* pStalls, UINT* pStallMicroseconds);
+
+private:
+	/*** ShaderAnalysisQueue private methods ***/
+	void                 Run(Job* pJob, const LARGE_INTEGER* pStallStart = NULL);
+	void                 CountStall(const LARGE_INTEGER& start);
+	static DWORD WINAPI  WorkerThread(LPVOID lpParameter);
+
+	/**
+	* The repository analysing the shaders.
+	***/
+	ShaderModificationRepository* m_pModLoader;
+	/**
+	* Worker threads.
+	***/
+	std::vector<HANDLE> m_threads;
+	/**
+	* Guards m_jobs, m_stop and the condition variables.
+	***/
+	CRITICAL_SECTION m_lock;
+	/**
+	* Signalled when jobs are queued or the workers are to stop.
+	***/
+	CONDITION_VARIABLE m_jobQueued;
+	/**
+	* Signalled when a job is done.
+	***/
+	CONDITION_VARIABLE m_jobDone;
+	/**
+	* Queued jobs, oldest first (jobs taken over by Finish() stay until a worker drops them).
+	***/
+	std::deque<std::shared_ptr<Job>> m_jobs;
+	/**
+	* True if the workers are to stop.
+	***/
+	bool m_stop;
+	/**
+	* Number of jobs queued or running (changed under m_lock when a job is done).
+	***/
+	volatile LONG m_depth;
+	/**
+	* Number of Finish() calls that waited for a worker since the last TakeStalls().
+	***/
+	volatile LONG m_stalls;
+	/**
+	* Time spent waiting in these calls, in microseconds.
+	***/
+	volatile LONG m_stallMicroseconds;
+};
+#endif
@@ -0,0 +1,412 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ShaderBytecode.cpp> and
+Class <ShaderBytecode> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ShaderBytecode.h"
+#include <string.h>
+
+/**
+* Token values (as in d3d9types.h).
+***/
+#define SHADERTYPE_VERTEX       0xFFFE
+#define SHADERTYPE_PIXEL        0xFFFF
+#define OPCODE_M4x4             0x0014
+#define OPCODE_M3x2             0x0018
+#define OPCODE_DCL              0x001F
+#define OPCODE_DEF              0x0051
+#define OPCODE_DEFI             0x0052
+#define OPCODE_DEFB             0x0053
+#define OPCODE_COMMENT          0xFFFE
+#define OPCODE_END              0xFFFF
+#define INSTRUCTION_LENGTH(x)   (((x) >> 24) & 0xF)
+#define COMMENT_LENGTH(x)       (((x) >> 16) & 0x7FFF)
+#define PARAMETER_TOKEN         0x80000000
+#define PARAMETER_NUMBER(x)     ((x) & 0x7FF)
+#define PARAMETER_TYPE(x)       ((((x) >> 28) & 0x7) | (((x) >> 8) & 0x18))
+#define ADDRMODE_RELATIVE       0x00002000
+#define REGTYPE_CONST           2
+#define REGTYPE_CONST2          11
+#define REGTYPE_CONST3          12
+#define REGTYPE_CONST4          13
+#define FOURCC_CTAB             0x42415443
+#define CONSTANTTABLE_SIZE      28
+#define CONSTANTINFO_SIZE       20
+#define TYPEINFO_SIZE           16
+
+/**
+* Reads a little endian WORD, the constant table is not necessarily aligned.
+***/
+static uint16_t Read16(const uint8_t* pData)
+{
+	return (uint16_t)(pData[0] | (pData[1] << 8));
+}
+
+/**
+* Reads a little endian DWORD, the constant table is not necessarily aligned.
+***/
+static uint32_t Read32(const uint8_t* pData)
+{
+	return (uint32_t)pData[0] | ((uint32_t)pData[1] << 8) | ((uint32_t)pData[2] << 16) | ((uint32_t)pData[3] << 24);
+}
+
+/**
+* Registers read by the matrix source (second source) of the matrix macros m4x4, m4x3, m3x4, m3x3, m3x2.
+* @return 0 if the opcode is no matrix macro.
+***/
+static uint32_t MatrixRows(uint32_t opcode)
+{
+	static const uint32_t rows[] = {4, 3, 4, 3, 2};
+
+	if ((opcode < OPCODE_M4x4) || (opcode > OPCODE_M3x2))
+		return 0;
+
+	return rows[opcode - OPCODE_M4x4];
+}
+
+/**
+* Constructor.
+* Nothing parsed.
+***/
+ShaderBytecode::ShaderBytecode() :
+	m_pTokens(NULL),
+	m_tokenCount(0),
+	m_version(0),
+	m_hasConstantTable(false),
+	m_creator(""),
+	m_target(""),
+	m_constants(),
+	m_instructionCount(0),
+	m_floatRegistersRead(),
+	m_relativeFloatAddressing(false)
+{
+}
+
+/**
+* Destructor.
+***/
+ShaderBytecode::~ShaderBytecode()
+{
+}
+
+/**
+* Parses a shader function.
+* The function has to stay valid as long as the parsed data is used.
+* @param pFunction The shader function (bytecode), as returned by GetFunction().
+* @param sizeOfData Size of the function in bytes.
+* @return False if the function is no shader model 1 to 3 shader or is damaged (truncated instruction or constant table).
+***/
+bool ShaderBytecode::Parse(const void* pFunction, size_t sizeOfData)
+{
+	m_pTokens = static_cast<const uint32_t*>(pFunction);
+	m_tokenCount = pFunction ? sizeOfData / sizeof(uint32_t) : 0;
+	m_version = 0;
+	m_hasConstantTable = false;
+	m_creator = "";
+	m_target = "";
+	m_constants.clear();
+	m_instructionCount = 0;
+	m_floatRegistersRead.clear();
+	m_relativeFloatAddressing = false;
+
+	if (m_tokenCount == 0)
+		return false;
+
+	m_version = m_pTokens[0];
+	if ((((m_version >> 16) != SHADERTYPE_VERTEX) && ((m_version >> 16) != SHADERTYPE_PIXEL)) ||
+		(MajorVersion() < 1) || (MajorVersion() > 3))
+		return false;
+
+	return ParseInstructions(1);
+}
+
+/**
+* True if the parsed function is a pixel shader, false for vertex shaders.
+***/
+bool ShaderBytecode::IsPixelShader() const
+{
+	return (m_version >> 16) == SHADERTYPE_PIXEL;
+}
+
+/**
+* Returns the version token.
+***/
+uint32_t ShaderBytecode::Version() const
+{
+	return m_version;
+}
+
+/**
+* Returns the major shader model version.
+***/
+uint32_t ShaderBytecode::MajorVersion() const
+{
+	return (m_version >> 8) & 0xFF;
+}
+
+/**
+* Returns the minor shader model version.
+***/
+uint32_t ShaderBytecode::MinorVersion() const
+{
+	return m_version & 0xFF;
+}
+
+/**
+* True if the function has a constant table (shaders may be compiled without).
+***/
+bool ShaderBytecode::HasConstantTable() const
+{
+	return m_hasConstantTable;
+}
+
+/**
+* Returns the creator string of the constant table, empty if none.
+***/
+const char* ShaderBytecode::Creator() const
+{
+	return m_creator;
+}
+
+/**
+* Returns the target (profile) string of the constant table, empty if none.
+***/
+const char* ShaderBytecode::Target() const
+{
+	return m_target;
+}
+
+/**
+* Returns the top level constants of the constant table, in table order.
+***/
+const std::vector<ShaderBytecode::Constant>& ShaderBytecode::Constants() const
+{
+	return m_constants;
+}
+
+/**
+* Returns the number of instructions.
+***/
+uint32_t ShaderBytecode::InstructionCount() const
+{
+	return m_instructionCount;
+}
+
+/**
+* Returns the float constant registers read by the instructions.
+* Registers defined by the shader itself (def) are not included unless read as well.
+* Only complete if RelativeFloatAddressing() is false.
+***/
+const std::vector<uint32_t>& ShaderBytecode::FloatRegistersRead() const
+{
+	return m_floatRegistersRead;
+}
+
+/**
+* True if float constants are read relative to an address register, the shader may read any float register then.
+***/
+bool ShaderBytecode::RelativeFloatAddressing() const
+{
+	return m_relativeFloatAddressing;
+}
+
+/**
+* Parses the constant table.
+* @param pData The constant table data (following the CTAB four character code).
+* @param size Size of the data in bytes, all offsets of the table are relative to pData.
+***/
+bool ShaderBytecode::ParseConstantTable(const uint8_t* pData, size_t size)
+{
+	if (size < CONSTANTTABLE_SIZE)
+		return false;
+
+	uint32_t constantCount = Read32(pData + 12);
+	uint32_t constantInfo = Read32(pData + 16);
+	if ((constantInfo > size) || (constantCount > (size - constantInfo) / CONSTANTINFO_SIZE))
+		return false;
+
+	const char* creator = String(pData, size, Read32(pData + 4));
+	const char* target = String(pData, size, Read32(pData + 24));
+
+	m_constants.reserve(constantCount);
+	for (uint32_t i = 0; i < constantCount; i++) {
+		const uint8_t* pInfo = pData + constantInfo + i * CONSTANTINFO_SIZE;
+		Constant constant;
+
+		constant.name = String(pData, size, Read32(pInfo));
+		if (!constant.name)
+			return false;
+
+		constant.registerSet = Read16(pInfo + 4);
+		constant.registerIndex = Read16(pInfo + 6);
+		constant.registerCount = Read16(pInfo + 8);
+
+		uint32_t typeInfo = Read32(pInfo + 12);
+		if ((typeInfo > size) || (size - typeInfo < TYPEINFO_SIZE))
+			return false;
+
+		const uint8_t* pType = pData + typeInfo;
+		constant.parameterClass = Read16(pType);
+		constant.type = Read16(pType + 2);
+		constant.rows = Read16(pType + 4);
+		constant.columns = Read16(pType + 6);
+		constant.elements = Read16(pType + 8);
+		constant.structMembers = Read16(pType + 10);
+
+		uint32_t defaultValue = Read32(pInfo + 16);
+		constant.pDefaultValue = ((defaultValue != 0) && (defaultValue < size)) ? pData + defaultValue : NULL;
+
+		m_constants.push_back(constant);
+	}
+
+	m_hasConstantTable = true;
+	m_creator = creator ? creator : "";
+	m_target = target ? target : "";
+	return true;
+}
+
+/**
+* Parses the instruction stream, the constant table is parsed when its comment is found.
+* Shader model 1 instructions carry no length, their parameters are the following tokens with the
+* parameter bit set (def literals excepted). The matrix source of a matrix macro reads one register per row.
+* @param token The first token after the version token.
+***/
+bool ShaderBytecode::ParseInstructions(size_t token)
+{
+	bool lengthInToken = (MajorVersion() >= 2);
+
+	while (token < m_tokenCount) {
+		uint32_t instruction = m_pTokens[token];
+		uint32_t opcode = instruction & 0xFFFF;
+
+		if (opcode == OPCODE_END)
+			return true;
+
+		// comments, the first CTAB comment is the constant table
+		if (opcode == OPCODE_COMMENT) {
+			size_t length = COMMENT_LENGTH(instruction);
+			if (length > m_tokenCount - token - 1)
+				return false;
+
+			if (!m_hasConstantTable && (length > 0) && (m_pTokens[token + 1] == FOURCC_CTAB)) {
+				if (!ParseConstantTable(reinterpret_cast<const uint8_t*>(m_pTokens + token + 2), (length - 1) * sizeof(uint32_t)))
+					return false;
+			}
+
+			token += 1 + length;
+			continue;
+		}
+
+		size_t length;
+		if (lengthInToken)
+			length = INSTRUCTION_LENGTH(instruction);
+		else if (opcode == OPCODE_DEF)
+			length = 5;
+		else {
+			length = 0;
+			while ((token + 1 + length < m_tokenCount) && (m_pTokens[token + 1 + length] & PARAMETER_TOKEN))
+				length++;
+		}
+
+		if (length > m_tokenCount - token - 1)
+			return false;
+
+		m_instructionCount++;
+
+		// def* define constants (destination and literals), dcl starts with the usage token
+		if ((opcode != OPCODE_DEF) && (opcode != OPCODE_DEFI) && (opcode != OPCODE_DEFB)) {
+			size_t end = token + 1 + length;
+			size_t parameter = token + 1;
+			if (opcode == OPCODE_DCL)
+				parameter++;
+
+			uint32_t matrixRows = MatrixRows(opcode);
+			for (uint32_t index = 0; parameter < end; parameter++, index++) {
+				// destination, vector source, matrix source
+				ReadParameter(m_pTokens[parameter], ((index == 2) && matrixRows) ? matrixRows : 1);
+
+				// relative address token follows (shader model 2 and above)
+				if (lengthInToken && (m_pTokens[parameter] & ADDRMODE_RELATIVE))
+					parameter++;
+			}
+		}
+
+		token += 1 + length;
+	}
+
+	// no end token
+	return true;
+}
+
+/**
+* Marks the float register(s) of a parameter read.
+* @param parameter The source or destination parameter token.
+* @param count Number of consecutive registers read (matrix rows).
+***/
+void ShaderBytecode::ReadParameter(uint32_t parameter, uint32_t count)
+{
+	uint32_t number = PARAMETER_NUMBER(parameter);
+	switch (PARAMETER_TYPE(parameter))
+	{
+	case REGTYPE_CONST:
+		break;
+	case REGTYPE_CONST2:
+		number += 2048;
+		break;
+	case REGTYPE_CONST3:
+		number += 4096;
+		break;
+	case REGTYPE_CONST4:
+		number += 6144;
+		break;
+	default:
+		return;
+	}
+
+	if (parameter & ADDRMODE_RELATIVE)
+		m_relativeFloatAddressing = true;
+
+	for (uint32_t last = number + count - 1; number <= last; number++) {
+		if (number / 32 >= m_floatRegistersRead.size())
+			m_floatRegistersRead.resize(number / 32 + 1, 0);
+		m_floatRegistersRead[number / 32] |= 1UL << (number % 32);
+	}
+}
+
+/**
+* Returns a zero terminated string of the constant table, NULL if the string is not inside the table.
+* @param pData The constant table data.
+* @param size Size of the data in bytes.
+* @param offset Offset of the string.
+***/
+const char* ShaderBytecode::String(const uint8_t* pData, size_t size, uint32_t offset)
+{
+	if ((offset >= size) || !memchr(pData + offset, 0, size - offset))
+		return NULL;
+
+	return reinterpret_cast<const char*>(pData + offset);
+}
@@ -0,0 +1,158 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ShaderBytecode.h> and
+Class <ShaderBytecode> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef SHADERBYTECODE_H_INCLUDED
+#define SHADERBYTECODE_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+* Direct3D 9 shader bytecode parser (shader model 1 to 3).
+* Reads the version token, the constant table (CTAB comment block) and the instruction stream of a
+* shader function, including the float constant registers the instructions read.
+* Nothing is copied, constant names and the other strings point into the parsed function, which has
+* to outlive the parsed data. Only the constant and register vectors are allocated, and they keep
+* their capacity when the parser is reused.
+* Depends on the C++ standard library only (no Direct3D or D3DX headers), so it can be built and
+* run anywhere on captured shader blobs. Enumeration values equal their d3dx9shader.h counterparts.
+* @see ShaderModificationRepository
+*/
+class ShaderBytecode
+{
+public:
+	ShaderBytecode();
+	virtual ~ShaderBytecode();
+
+	/**
+	* Register sets, as D3DXREGISTER_SET.
+	***/
+	enum RegisterSets
+	{
+		RegisterSet_Bool = 0,
+		RegisterSet_Int4 = 1,
+		RegisterSet_Float4 = 2,
+		RegisterSet_Sampler = 3
+	};
+
+	/**
+	* Parameter classes, as D3DXPARAMETER_CLASS.
+	***/
+	enum ParameterClasses
+	{
+		Class_Scalar = 0,
+		Class_Vector = 1,
+		Class_MatrixRows = 2,
+		Class_MatrixColumns = 3,
+		Class_Object = 4,
+		Class_Struct = 5
+	};
+
+	/**
+	* One top level constant of the constant table, as D3DXCONSTANT_DESC.
+	***/
+	struct Constant
+	{
+		const char* name;           /**< Constant name, points into the shader function. */
+		uint16_t    registerSet;    /**< Register set (RegisterSets). */
+		uint16_t    registerIndex;  /**< Start register. */
+		uint16_t    registerCount;  /**< Number of registers. */
+		uint16_t    parameterClass; /**< Parameter class (ParameterClasses). */
+		uint16_t    type;           /**< Parameter type, as D3DXPARAMETER_TYPE. */
+		uint16_t    rows;           /**< Number of rows. */
+		uint16_t    columns;        /**< Number of columns. */
+		uint16_t    elements;       /**< Number of array elements. */
+		uint16_t    structMembers;  /**< Number of structure members. */
+		const void* pDefaultValue;  /**< Default value, points into the shader function, NULL if none. */
+	};
+
+	/*** ShaderBytecode public methods ***/
+	bool                         Parse(const void* pFunction, size_t sizeOfData);
+	bool                         IsPixelShader() const;
+	uint32_t                     Version() const;
+	uint32_t                     MajorVersion() const;
+	uint32_t                     MinorVersion() const;
+	bool                         HasConstantTable() const;
+	const char*                  Creator() const;
+	const char*                  Target() const;
+	const std::vector<Constant>& Constants() const;
+	uint32_t                     InstructionCount() const;
+	const std::vector<uint32_t>& FloatRegistersRead() const;
+	bool                         RelativeFloatAddressing() const;
+
+private:
+	/*** ShaderBytecode private methods ***/
+	bool        ParseConstantTable(const uint8_t* pData, size_t size);
+	bool        ParseInstructions(size_t token);
+	void        ReadParameter(uint32_t parameter, uint32_t count);
+	const char* String(const uint8_t* pData, size_t size, uint32_t offset);
+
+	/**
+	* The parsed function.
+	***/
+	const uint32_t* m_pTokens;
+	/**
+	* Number of tokens of the parsed function.
+	***/
+	size_t m_tokenCount;
+	/**
+	* Version token (0xFFFE0000 vertex shaders, 0xFFFF0000 pixel shaders, major version << 8, minor version).
+	***/
+	uint32_t m_version;
+	/**
+	* True if a constant table was found.
+	***/
+	bool m_hasConstantTable;
+	/**
+	* Creator string of the constant table.
+	***/
+	const char* m_creator;
+	/**
+	* Target (profile) string of the constant table.
+	***/
+	const char* m_target;
+	/**
+	* Top level constants of the constant table.
+	***/
+	std::vector<Constant> m_constants;
+	/**
+	* Number of instructions (comments not counted).
+	***/
+	uint32_t m_instructionCount;
+	/**
+	* Float constant registers read by instructions, 32 registers per word (register n = bit n%32 of word n/32).
+	***/
+	std::vector<uint32_t> m_floatRegistersRead;
+	/**
+	* True if an instruction reads float constants relative to an address register (any register may be read).
+	***/
+	bool m_relativeFloatAddressing;
+};
+#endif
@@ -75,8 +75,22 @@ public:
 
 	/**
 	*  Pure virtual method, should apply the modification to produce left and right versions.   
+	* @param inData [in] Input data.
+	* @param outLeft [out] Left data, count elements.
+	* @param outRight [out] Right data, count elements.
+	* @param count Number of T to output (at most 16).
 	*/
-	virtual void ApplyModification(const T* inData, std::vector<T>* outLeft, std::vector<T>* outRight) = 0;
+	virtual void ApplyModification(const T* inData, T* outLeft, T* outRight, UINT count) = 0;
+
+	/**
+	* Generation of the view adjustment data the modification is based on.
+	* The modification result only changes if the input data or this generation changes.
+	* @see ViewAdjustment::Generation()
+	***/
+	UINT AdjustmentGeneration()
+	{
+		return m_spAdjustmentMatrices->Generation();
+	}
 
 	/**
 	* Simply a way to identify this modification.  Useful for comparing shadermodification equality.
@@ -54,21 +54,24 @@ public:
 	* Applies modification to registers.
 	* This method should not generally be overridden by subclasses (if it is the overriding method
 	* should respect the result of DoNotApply). 
-	* Do modification in DoMatrixModification. Transposed matrices will be provided to 
-	* DoMatrixModification if transpose is true.
+	* Modifications that are a plain product (in * left, in * right) provide their matrices in
+	* AdjustmentMatrices and are computed by the SSE kernel straight from and into the registers,
+	* the transpose is handled by the kernel. Others are done in DoMatrixModification. Transposed
+	* matrices will be provided to AdjustmentMatrices and DoMatrixModification if transpose is true.
 	* @param [in] inData Input matrix to be modified and assigned to registers.
-	* @param [in, out] outLeft Register vector left.
-	* @param [in, out] outRight Register vector right.
+	* @param [out] outLeft Register data left.
+	* @param [out] outRight Register data right.
+	* @param [in] count Number of floats to output.
 	***/
-	virtual void ApplyModification(const float* inData, std::vector<float>* outLeft, std::vector<float>* outRight)
+	virtual void ApplyModification(const float* inData, float* outLeft, float* outRight, UINT count)
 	{
 		D3DXMATRIX tempMatrix (inData);
 
 		// conditions to apply the matrix ?
 		if (DoNotApply(tempMatrix)) {
 
-			outLeft->assign(&tempMatrix[0], &tempMatrix[0] + outLeft->size());
-			outRight->assign(&tempMatrix[0], &tempMatrix[0] + outRight->size());
+			AssignMatrix(tempMatrix, inData, outLeft, count);
+			AssignMatrix(tempMatrix, inData, outRight, count);
 		}
 		else {
 
@@ -76,6 +79,26 @@ public:
 			if (m_bTranspose) {
 				D3DXMatrixTranspose(&tempMatrix, &tempMatrix);
 			}
+
+			// plain product ?
+			D3DXMATRIX adjustmentLeft;
+			D3DXMATRIX adjustmentRight;
+			if (AdjustmentMatrices(tempMatrix, adjustmentLeft, adjustmentRight)) {
+
+				// full matrix constants are written in place
+				if (count == 16) {
+					vireio::StereoMatrixMultiply(inData, adjustmentLeft, adjustmentRight, m_bTranspose, outLeft, outRight);
+				}
+				else {
+					D3DXMATRIX tempLeft;
+					D3DXMATRIX tempRight;
+					vireio::StereoMatrixMultiply(inData, adjustmentLeft, adjustmentRight, m_bTranspose, tempLeft, tempRight);
+
+					AssignMatrix(tempLeft, inData, outLeft, count);
+					AssignMatrix(tempRight, inData, outRight, count);
+				}
+				return;
+			}
 			
 			D3DXMATRIX tempLeft;
 			D3DXMATRIX tempRight;
@@ -90,23 +113,43 @@ public:
 			}
 
 			// assign to output
-			outLeft->assign(&tempLeft[0], &tempLeft[0] + outLeft->size());
-			outRight->assign(&tempRight[0], &tempRight[0] + outRight->size());
+			AssignMatrix(tempLeft, inData, outLeft, count);
+			AssignMatrix(tempRight, inData, outRight, count);
 		}
 	}
 
 
 protected:
 	/**
-	* Default modification is simple translate. Override to do actual modification. 
+	* Default modification is simple translate, the product with the adjustment matrices. 
+	* Override to do a modification that is no plain product (return false in AdjustmentMatrices then).
 	* @param in [in] Modification matrix to be multiplied by adjustment matrix (left/right).
 	* @param outLeft [in, out] Left transform matrix.
 	* @param outRight [in, out] Right transform matrix.
 	***/
 	virtual void DoMatrixModification(D3DXMATRIX in, D3DXMATRIX& outLeft, D3DXMATRIX& outright)
 	{
-		outLeft = in * m_spAdjustmentMatrices->LeftAdjustmentMatrix();
-		outright = in * m_spAdjustmentMatrices->RightAdjustmentMatrix();
+		D3DXMATRIX adjustmentLeft;
+		D3DXMATRIX adjustmentRight;
+		AdjustmentMatrices(in, adjustmentLeft, adjustmentRight);
+
+		outLeft = in * adjustmentLeft;
+		outright = in * adjustmentRight;
+	}
+
+	/**
+	* Provides the left and right matrices the input matrix is multiplied by.
+	* Default is simple translate. Override for modifications that are a plain product.
+	* @param in [in] Modification matrix (transposed if transpose is true), to check conditions.
+	* @param outLeft [out] Left adjustment matrix.
+	* @param outRight [out] Right adjustment matrix.
+	* @return False if the modification is no plain product for that input, DoMatrixModification is called then.
+	***/
+	virtual bool AdjustmentMatrices(const D3DXMATRIX& in, D3DXMATRIX& outLeft, D3DXMATRIX& outRight)
+	{
+		outLeft = m_spAdjustmentMatrices->LeftAdjustmentMatrix();
+		outRight = m_spAdjustmentMatrices->RightAdjustmentMatrix();
+		return true;
 	}
 
 	/**
@@ -123,6 +166,22 @@ protected:
 		return false;
 	}
 
+	/**
+	* Assigns a (modified) matrix to output registers.
+	* Only the first matrix of larger constants (matrix arrays) is modified, the registers after it
+	* are copied from the input.
+	* @param [in] matrix The matrix.
+	* @param [in] inData Input registers of the constant.
+	* @param [out] out Output registers.
+	* @param [in] count Number of floats to output.
+	***/
+	static void AssignMatrix(const D3DXMATRIX& matrix, const float* inData, float* out, UINT count)
+	{
+		memcpy(out, &matrix[0], ((count < 16) ? count : 16) * sizeof(float));
+		if (count > 16)
+			memcpy(out + 16, inData + 16, (count - 16) * sizeof(float));
+	}
+
 	/**
 	* True if matrix is to be transposed before and after the modification is done.
 	***/
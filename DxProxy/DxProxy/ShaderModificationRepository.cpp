@@ -29,19 +29,44 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "ShaderModificationRepository.h"
 #include <assert.h>
+#include <intrin.h>
+
+#pragma intrinsic(_BitScanForward)
+
+/**
+* Minimum number of interned functions before released ones are dropped.
+***/
+#define INTERN_PURGE_SIZE 256
 
 /**
 * Constructor.
-* Creates identity matrix.
+* Creates identity matrix and the analysis queue (one worker per spare processor, at most four).
 * @param adjustmentMatrices Matrix calculation class pointer, used here to create the modifications.
 ***/
 ShaderModificationRepository::ShaderModificationRepository(std::shared_ptr<ViewAdjustment> adjustmentMatrices) :
 	m_AllModificationRules(),
 	m_defaultModificationRuleIDs(),
 	m_shaderSpecificModificationRuleIDs(),
-	m_spAdjustmentMatrices(adjustmentMatrices)
+	m_modificationsByRuleID(),
+	m_spAdjustmentMatrices(adjustmentMatrices),
+	m_ruleSetHash(0),
+	m_compiledDefaultRules(),
+	m_compiledShaderRules(),
+	m_analysisCache(),
+	m_pAnalysisQueue(NULL),
+	m_internedShaders(),
+	m_internPurgeSize(INTERN_PURGE_SIZE)
 {
+	InitializeCriticalSection(&m_lock);
+	InitializeCriticalSection(&m_internLock);
 	D3DXMatrixIdentity(&m_identity);
+	UpdateRuleSetHash();
+	CompileRules();
+
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	UINT threadCount = (systemInfo.dwNumberOfProcessors > 1) ? min(systemInfo.dwNumberOfProcessors - 1, 4) : 1;
+	m_pAnalysisQueue = new ShaderAnalysisQueue(this, threadCount);
 
 	// For testing load source settings manually
 	/*m_defaultModificationRuleIDs.push_back(1);
@@ -55,10 +80,15 @@ ShaderModificationRepository::ShaderModificationRepository(std::shared_ptr<ViewA
 
 /**
 * Destructor.
-* Resets adjustment matrices.
+* Finishes queued analyses, resets adjustment matrices.
 ***/
 ShaderModificationRepository::~ShaderModificationRepository()
 {
+	delete m_pAnalysisQueue;
+	m_internedShaders.clear();
+	DeleteCriticalSection(&m_internLock);
+	DeleteCriticalSection(&m_lock);
+
 	m_spAdjustmentMatrices.reset();
 }
 
@@ -66,14 +96,19 @@ ShaderModificationRepository::~ShaderModificationRepository()
 * Loads shader modification rules.
 * True if load succeeds, false otherwise.  
 * (pugi::xml_document)
+* The shader analysis cache of the rules is opened as well (rules path + ".cache").
 * @param rulesPath Rules path as defined in game configuration.
 ***/
 bool ShaderModificationRepository::LoadRules(std::string rulesPath)
 {
+	CriticalSectionLock lock(&m_lock);
+
 	m_AllModificationRules.clear();
 	m_defaultModificationRuleIDs.clear();
 	m_shaderSpecificModificationRuleIDs.clear();
-
+	m_modificationsByRuleID.clear();
+	UpdateRuleSetHash();
+	CompileRules();
 
 	pugi::xml_document rulesFile;
 	pugi::xml_parse_result resultProfiles = rulesFile.load_file(rulesPath.c_str());
@@ -148,6 +183,10 @@ bool ShaderModificationRepository::LoadRules(std::string rulesPath)
 		}
 	}
 
+	UpdateRuleSetHash();
+	CompileRules();
+	m_analysisCache.Open(rulesPath + ".cache");
+
 	return true;
 }
 
@@ -157,6 +196,8 @@ bool ShaderModificationRepository::LoadRules(std::string rulesPath)
 ***/
 bool ShaderModificationRepository::SaveRules(std::string rulesPath)
 {
+	CriticalSectionLock lock(&m_lock);
+
 	// create an empty document
 	pugi::xml_document rulesFile;
 	if (!rulesFile.load("<shaderConfig><rules></rules><defaultRuleIDs></defaultRuleIDs></shaderConfig>"))
@@ -229,6 +270,8 @@ bool ShaderModificationRepository::SaveRules(std::string rulesPath)
 ***/
 bool ShaderModificationRepository::AddRule(std::string constantName, bool allowPartialNameMatch, UINT startRegIndex, D3DXPARAMETER_CLASS constantType, UINT operationToApply, UINT modificationRuleID, bool transpose)
 {
+	CriticalSectionLock lock(&m_lock);
+
 	UINT rulePresent = false;
 	auto itModificationRules = m_AllModificationRules.begin();
 	while (itModificationRules != m_AllModificationRules.end())
@@ -250,6 +293,8 @@ bool ShaderModificationRepository::AddRule(std::string constantName, bool allowP
 		OutputDebugString("rule not present...add");
 		m_defaultModificationRuleIDs.push_back(modificationRuleID);
 		m_AllModificationRules.insert(std::make_pair<UINT, ConstantModificationRule>((UINT)int(modificationRuleID), (ShaderModificationRepository::ConstantModificationRule)ConstantModificationRule(std::string(constantName), allowPartialNameMatch, startRegIndex, constantType, operationToApply, modificationRuleID, transpose)));
+		UpdateRuleSetHash();
+		CompileRules();
 	}
 
 	return (!rulePresent);
@@ -258,25 +303,12 @@ bool ShaderModificationRepository::AddRule(std::string constantName, bool allowP
 /**
 * Returns a collection of modified constants for the specified shader. 
 * (may be an empty collection if no modifications apply)
-* <StrartRegister, StereoShaderConstant<float>>
-*
-* Hash the shader and load modification rules:
-* If rules for this specific shader use those else use default rules.
-*
-* For each shader constant:
-* Check if constant matches a rule (name and/or index). If it does create a stereoshaderconstant 
-* based on rule and add to map of stereoshaderconstants to return.
-*
 * @param pActualPixelShader The actual (not wrapped) pixel shader.
 * @return Collection of stereoshaderconstants for this shader (empty collection if no modifications).
+* @see ModifiedConstantsFromFunction()
 ***/
-std::map<UINT, StereoShaderConstant<float>> ShaderModificationRepository::GetModifiedConstantsF(IDirect3DPixelShader9* pActualPixelShader)
+StereoConstantTable ShaderModificationRepository::GetModifiedConstantsF(IDirect3DPixelShader9* pActualPixelShader)
 {
-	// All rules are assumed to be valid. Validation of rules should be done when rules are loaded/created
-	std::vector<ConstantModificationRule*> rulesToApply;
-	std::map<UINT, StereoShaderConstant<float>> result;
-
-	// Hash the shader and load modification rules
 	BYTE *pData = NULL;
 	UINT pSizeOfData;
 
@@ -284,301 +316,275 @@ std::map<UINT, StereoShaderConstant<float>> ShaderModificationRepository::GetMod
 	pData = new BYTE[pSizeOfData];
 	pActualPixelShader->GetFunction(pData,&pSizeOfData);
 
-	uint32_t hash;
-	MurmurHash3_x86_32(pData, pSizeOfData, VIREIO_SEED, &hash);
+	StereoConstantTable result = ModifiedConstantsFromFunction(pData, pSizeOfData);
+	delete[] pData;
 
-	if (m_shaderSpecificModificationRuleIDs.count(hash) == 1) {
+	return result;
+}
 
-		// There are specific modification rules to use with this shader
-		auto itRules = m_shaderSpecificModificationRuleIDs[hash].begin();
-		while (itRules != m_shaderSpecificModificationRuleIDs[hash].end()) {
-			rulesToApply.push_back(&(m_AllModificationRules[*itRules]));
-			++itRules;
-		}
-	}
-	else {
+/**
+* Returns a collection of modified constants for the specified shader. 
+* (may be an empty collection if no modifications apply)
+* @param pActualVertexShader The actual (not wrapped) vertex shader.
+* @return Collection of stereoshaderconstants for this shader (empty collection if no modifications).
+* @see ModifiedConstantsFromFunction()
+***/
+StereoConstantTable ShaderModificationRepository::GetModifiedConstantsF(IDirect3DVertexShader9* pActualVertexShader)
+{
+	BYTE *pData = NULL;
+	UINT pSizeOfData;
 
-		// No specific rules, use general rules
-		auto itRules = m_defaultModificationRuleIDs.begin();
-		while (itRules != m_defaultModificationRuleIDs.end()) {
-			rulesToApply.push_back(&(m_AllModificationRules[*itRules]));
-			++itRules;
-		}
-	}
+	pActualVertexShader->GetFunction(NULL, &pSizeOfData);
+	pData = new BYTE[pSizeOfData];
+	pActualVertexShader->GetFunction(pData,&pSizeOfData);
 
-	// Load the constant descriptions for this shader and create StereoShaderConstants as the applicable rules require them.
-	LPD3DXCONSTANTTABLE pConstantTable = NULL;
+	StereoConstantTable result = ModifiedConstantsFromFunction(pData, pSizeOfData);
+	delete[] pData;
 
-	D3DXGetShaderConstantTable(reinterpret_cast<DWORD*>(pData), &pConstantTable);
+	return result;
+}
 
-	if(pConstantTable) {
+/**
+* Queues the analysis of the specified shader, or returns the analysis of a shader with the same function.
+* @param pActualPixelShader The actual (not wrapped) pixel shader.
+* @return The analysis job, the modified constants are valid once ShaderAnalysisQueue::Finish() returned.
+* @see InternFunction()
+***/
+std::shared_ptr<ShaderAnalysisQueue::Job> ShaderModificationRepository::QueueModifiedConstantsF(IDirect3DPixelShader9* pActualPixelShader)
+{
+	UINT pSizeOfData;
+	pActualPixelShader->GetFunction(NULL, &pSizeOfData);
+	std::vector<BYTE> function(pSizeOfData);
+	if (pSizeOfData)
+		pActualPixelShader->GetFunction(&function[0], &pSizeOfData);
 
-		D3DXCONSTANTTABLE_DESC pDesc;
-		pConstantTable->GetDesc(&pDesc);
+	return InternFunction(function);
+}
 
-		D3DXCONSTANT_DESC pConstantDesc[64];
+/**
+* Queues the analysis of the specified shader, or returns the analysis of a shader with the same function.
+* @param pActualVertexShader The actual (not wrapped) vertex shader.
+* @return The analysis job, the modified constants are valid once ShaderAnalysisQueue::Finish() returned.
+* @see InternFunction()
+***/
+std::shared_ptr<ShaderAnalysisQueue::Job> ShaderModificationRepository::QueueModifiedConstantsF(IDirect3DVertexShader9* pActualVertexShader)
+{
+	UINT pSizeOfData;
+	pActualVertexShader->GetFunction(NULL, &pSizeOfData);
+	std::vector<BYTE> function(pSizeOfData);
+	if (pSizeOfData)
+		pActualVertexShader->GetFunction(&function[0], &pSizeOfData);
 
-		for(UINT i = 0; i < pDesc.Constants; i++)
-		{
-			D3DXHANDLE handle = pConstantTable->GetConstant(NULL,i);
-			if(handle == NULL) continue;
+	return InternFunction(function);
+}
 
-			UINT pConstantNum = 64;
-			pConstantTable->GetConstantDesc(handle, pConstantDesc, &pConstantNum);
-			if (pConstantNum >= 64) {
-				OutputDebugString("ShaderModificationRepository::GetModifiedConstantsF - Need larger constant description buffer");
+/**
+* Returns the analysis of a shader function, queued unless a shader with the same function already has one.
+* Functions are interned by hash and size, the functions themselves are compared to rule out hash
+* collisions. All shaders of a function share one analysis (and so one constant table layout), an
+* analysis lives as long as a shader holds it.
+* The analysis is queued without holding the intern lock (a queue without workers analyses the shader
+* right away, which takes the rule lock, and the rule lock is held while the intern table is cleared).
+* Two threads interning a new function at once may both analyse it, the first one is interned.
+* @param function [in, out] The shader function, taken over if a new analysis is queued.
+***/
+std::shared_ptr<ShaderAnalysisQueue::Job> ShaderModificationRepository::InternFunction(std::vector<BYTE>& function)
+{
+	uint32_t hash = 0;
+	if (!function.empty())
+		MurmurHash3_x86_32(&function[0], (int)function.size(), VIREIO_SEED, &hash);
+	UINT64 key = ((UINT64)function.size() << 32) | hash;
+
+	{
+		CriticalSectionLock lock(&m_internLock);
+
+		// drop interned functions of released shaders now and then
+		if (m_internedShaders.size() >= m_internPurgeSize) {
+			for (auto itInterned = m_internedShaders.begin(); itInterned != m_internedShaders.end(); ) {
+				if (itInterned->second.analysis.expired())
+					itInterned = m_internedShaders.erase(itInterned);
+				else
+					++itInterned;
 			}
+			m_internPurgeSize = max((UINT)INTERN_PURGE_SIZE, (UINT)m_internedShaders.size() * 2);
+		}
 
+		auto itInterned = FindInterned(key, function);
+		if (itInterned != m_internedShaders.end()) {
+			std::shared_ptr<ShaderAnalysisQueue::Job> spAnalysis = itInterned->second.analysis.lock();
+			if (spAnalysis)
+				return spAnalysis;
+		}
+	}
 
-			for(UINT j = 0; j < pConstantNum; j++)
-			{
-				// We are only modifying selected float vectors/matricies.
-				if (pConstantDesc[j].RegisterSet != D3DXRS_FLOAT4)
-					continue;
-
-				if ( ((pConstantDesc[j].Class == D3DXPC_VECTOR) && (pConstantDesc[j].RegisterCount == 1))
-					|| (((pConstantDesc[j].Class == D3DXPC_MATRIX_ROWS) || (pConstantDesc[j].Class == D3DXPC_MATRIX_COLUMNS)) && (pConstantDesc[j].RegisterCount == 4)) ) {
-						// Check if any rules match this constant
-						auto itRules = rulesToApply.begin();
-						while (itRules != rulesToApply.end()) {
-
-							// Type match
-							if ((*itRules)->m_constantType == pConstantDesc[j].Class) {
-								// name match required
-								if ((*itRules)->m_constantName.size() > 0) {
-									bool nameMatch = false;
-									if ((*itRules)->m_allowPartialNameMatch) {
-										nameMatch = std::strstr(pConstantDesc[j].Name, (*itRules)->m_constantName.c_str()) != NULL;
-
-										/*if (nameMatch) {
-											OutputDebugString("Match\n");
-										}
-										else {
-											OutputDebugString("No Match\n");
-										}*/
-									}
-									else {
-										nameMatch = (*itRules)->m_constantName.compare(pConstantDesc[j].Name) == 0;
-
-										//OutputDebugString("Full name match only\n");
-									}
-
-									if (!nameMatch) {
-										// no match
-										++itRules;
-										continue;
-									}
-								}
-
-								// register match required
-								if ((*itRules)->m_startRegIndex != UINT_MAX) {
-									if ((*itRules)->m_startRegIndex != pConstantDesc[j].RegisterIndex) {
-										// no match
-										++itRules;
-										continue;
-									}
-								}
+	// not interned, or all shaders of the function were released : analyse
+	std::vector<BYTE> copy(function);
+	std::shared_ptr<ShaderAnalysisQueue::Job> spAnalysis = m_pAnalysisQueue->Enqueue(function);
 
-#ifdef _DEBUG
-								// output shader constant + index 
-								switch(pConstantDesc[j].Class)
-								{
-								case D3DXPC_VECTOR:
-									OutputDebugString("D3DXPC_VECTOR");
-									break;
-								case D3DXPC_MATRIX_ROWS:
-									OutputDebugString("D3DXPC_MATRIX_ROWS");
-									break;
-								case D3DXPC_MATRIX_COLUMNS:
-									OutputDebugString("D3DXPC_MATRIX_COLUMNS");
-									break;
-								}
-								char buf[32];
-								sprintf_s(buf,"Register Index: %d", pConstantDesc[j].RegisterIndex);
-								OutputDebugString(buf);
-#endif
+	CriticalSectionLock lock(&m_internLock);
+	auto itInterned = FindInterned(key, copy);
+	if (itInterned == m_internedShaders.end()) {
+		itInterned = m_internedShaders.insert(std::make_pair(key, InternedFunction()));
+		itInterned->second.function.swap(copy);
+	}
 
-								// Create StereoShaderConstant<float> and add to result
-								result.insert(std::pair<UINT, StereoShaderConstant<>>(pConstantDesc[j].RegisterIndex, CreateStereoConstantFrom(*itRules, pConstantDesc[j].RegisterIndex, pConstantDesc[j].RegisterCount)));
+	if (itInterned->second.analysis.expired())
+		itInterned->second.analysis = spAnalysis;
 
-								// only the first matching rule is applied to a constant
-								break;
-							}
+	return spAnalysis;
+}
 
-							++itRules;
-						}
-				}	
-			}
-		}
+/**
+* Returns the interned function equal to a function, m_internedShaders.end() if none.
+* Call with the intern lock held.
+* @param key Function size << 32 | function hash.
+* @param function The shader function.
+***/
+ShaderModificationRepository::InternedFunctions::iterator ShaderModificationRepository::FindInterned(UINT64 key, const std::vector<BYTE>& function)
+{
+	auto range = m_internedShaders.equal_range(key);
+	for (auto itInterned = range.first; itInterned != range.second; ++itInterned) {
+		if (itInterned->second.function == function)
+			return itInterned;
 	}
 
-	_SAFE_RELEASE(pConstantTable);
-	if (pData) delete[] pData;
+	return m_internedShaders.end();
+}
 
-	return result;
+/**
+* Returns the shader analysis queue.
+***/
+ShaderAnalysisQueue* ShaderModificationRepository::AnalysisQueue()
+{
+	return m_pAnalysisQueue;
 }
 
 /**
-* Returns a collection of modified constants for the specified shader. 
-* (may be an empty collection if no modifications apply)
+* Returns a collection of modified constants for the specified shader function (bytecode). 
 * <StrartRegister, StereoShaderConstant<float>>
 *
-* Hash the shader and load modification rules:
+* Hash the shader, if it was analysed with the current rules before (this or an earlier session)
+* the constants are created from the analysis cache. Otherwise load the compiled modification rules:
 * If rules for this specific shader use those else use default rules.
 *
 * For each shader constant:
-* Check if constant matches a rule (name and/or index). If it does create a stereoshaderconstant 
+* Find the first rule matching the constant (name and/or index). If there is one create a stereoshaderconstant 
 * based on rule and add to map of stereoshaderconstants to return.
+* The float registers of all constants and the float registers the instructions read are marked used
+* in the returned table (usage stays unknown for shaders without constant table reading relative to an
+* address register).
+* The analysis is added to the cache.
+* Called by the analysis queue workers, the shader is parsed without holding the lock.
 *
-* @param pActualVertexShader The actual (not wrapped) vertex shader.
+* @param pData The shader function.
+* @param sizeOfData Size of the shader function in bytes.
 * @return Collection of stereoshaderconstants for this shader (empty collection if no modifications).
 ***/
-std::map<UINT, StereoShaderConstant<float>> ShaderModificationRepository::GetModifiedConstantsF(IDirect3DVertexShader9* pActualVertexShader)
+StereoConstantTable ShaderModificationRepository::ModifiedConstantsFromFunction(const BYTE* pData, UINT sizeOfData)
 {
 	// All rules are assumed to be valid. Validation of rules should be done when rules are loaded/created
-	std::vector<ConstantModificationRule*> rulesToApply;
-	std::map<UINT, StereoShaderConstant<float>> result;
-
-	// Hash the shader and load modification rules
-	BYTE *pData = NULL;
-	UINT pSizeOfData;
-
-	pActualVertexShader->GetFunction(NULL, &pSizeOfData);
-	pData = new BYTE[pSizeOfData];
-	pActualVertexShader->GetFunction(pData,&pSizeOfData);
+	std::vector<ShaderAnalysisCache::CachedConstant> cachedConstants;
+	std::vector<const ShaderBytecode::Constant*> candidates;
+	ShaderBytecode bytecode;
+	StereoConstantTable result;
 
+	// Hash the shader, use the cached analysis if the shader was analysed with the current rules before
 	uint32_t hash;
-	MurmurHash3_x86_32(pData, pSizeOfData, VIREIO_SEED, &hash);
+	MurmurHash3_x86_32(pData, sizeOfData, VIREIO_SEED, &hash);
 
-	if (m_shaderSpecificModificationRuleIDs.count(hash) == 1) {
-
-		// There are specific modification rules to use with this shader
-		auto itRules = m_shaderSpecificModificationRuleIDs[hash].begin();
-		while (itRules != m_shaderSpecificModificationRuleIDs[hash].end()) {
-			rulesToApply.push_back(&(m_AllModificationRules[*itRules]));
-			++itRules;
-		}
+	{
+		CriticalSectionLock lock(&m_lock);
+		const ShaderAnalysisCache::CachedShader* pCached = m_analysisCache.Find(m_ruleSetHash, hash, sizeOfData);
+		if (pCached && ConstantsFromCache(pCached, result))
+			return result;
 	}
-	else {
 
-		// No specific rules, use general rules
-		auto itRules = m_defaultModificationRuleIDs.begin();
-		while (itRules != m_defaultModificationRuleIDs.end()) {
-			rulesToApply.push_back(&(m_AllModificationRules[*itRules]));
-			++itRules;
-		}
+	// Parse the shader, collect the constants rules may apply to.
+	// (no lock needed, shaders are parsed by several threads at once)
+	if (!bytecode.Parse(pData, sizeOfData)) {
+		OutputDebugString("ShaderModificationRepository::ModifiedConstantsFromFunction - Invalid shader function.\n");
 	}
+	else if (bytecode.HasConstantTable() || !bytecode.RelativeFloatAddressing()) {
 
+		// the constant table and the instructions list every register the shader reads
+		result.ResetUsage();
 
+		const std::vector<uint32_t>& registersRead = bytecode.FloatRegistersRead();
+		for (UINT word = 0; word < (UINT)registersRead.size(); word++) {
+			for (UINT bit = 0; bit < 32; bit++) {
+				if (registersRead[word] & (1UL << bit))
+					result.MarkUsed(word * 32 + bit, 1);
+			}
+		}
 
-	// Load the constant descriptions for this shader and create StereoShaderConstants as the applicable rules require them.
-	LPD3DXCONSTANTTABLE pConstantTable = NULL;
-
-	D3DXGetShaderConstantTable(reinterpret_cast<DWORD*>(pData), &pConstantTable);
+		const std::vector<ShaderBytecode::Constant>& constants = bytecode.Constants();
+		for (auto itConstant = constants.begin(); itConstant != constants.end(); ++itConstant)
+		{
+			// We are only modifying selected float vectors/matricies.
+			if (itConstant->registerSet != ShaderBytecode::RegisterSet_Float4)
+				continue;
 
-	if(pConstantTable) {
+			result.MarkUsed(itConstant->registerIndex, itConstant->registerCount);
 
-		D3DXCONSTANTTABLE_DESC pDesc;
-		pConstantTable->GetDesc(&pDesc);
+			if ( ((itConstant->parameterClass == ShaderBytecode::Class_Vector) && (itConstant->registerCount == 1))
+				|| (((itConstant->parameterClass == ShaderBytecode::Class_MatrixRows) || (itConstant->parameterClass == ShaderBytecode::Class_MatrixColumns)) && (itConstant->registerCount == 4)) ) {
+					candidates.push_back(&(*itConstant));
+			}
+		}
+	}
 
-		D3DXCONSTANT_DESC pConstantDesc[64];
+	// Create StereoShaderConstants as the applicable rules require them (names point into the shader function).
+	{
+		CriticalSectionLock lock(&m_lock);
+
+		// load modification rules
+		CompiledRules* pRules = &m_compiledDefaultRules;
+		auto itShaderRules = m_compiledShaderRules.find(hash);
+		if (itShaderRules != m_compiledShaderRules.end()) {
+			// There are specific modification rules to use with this shader
+			pRules = &itShaderRules->second;
+		}
 
-		for(UINT i = 0; i < pDesc.Constants; i++)
+		for (auto itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
 		{
-			D3DXHANDLE handle = pConstantTable->GetConstant(NULL,i);
-			if(handle == NULL) continue;
+			const ShaderBytecode::Constant* itConstant = *itCandidates;
 
-			UINT pConstantNum = 64;
-			pConstantTable->GetConstantDesc(handle, pConstantDesc, &pConstantNum);
-			if (pConstantNum >= 64) {
-				OutputDebugString("ShaderModificationRepository::GetModifiedConstantsF - Need larger constant description buffer");
-			}
-
-
-			for(UINT j = 0; j < pConstantNum; j++)
-			{
-				// We are only modifying selected float vectors/matricies.
-				if (pConstantDesc[j].RegisterSet != D3DXRS_FLOAT4)
-					continue;
-
-				if ( ((pConstantDesc[j].Class == D3DXPC_VECTOR) && (pConstantDesc[j].RegisterCount == 1))
-					|| (((pConstantDesc[j].Class == D3DXPC_MATRIX_ROWS) || (pConstantDesc[j].Class == D3DXPC_MATRIX_COLUMNS)) && (pConstantDesc[j].RegisterCount == 4)) ) {
-						// Check if any rules match this constant
-						auto itRules = rulesToApply.begin();
-						while (itRules != rulesToApply.end()) {
-
-							// Type match
-							if ((*itRules)->m_constantType == pConstantDesc[j].Class) {
-								// name match required
-								if ((*itRules)->m_constantName.size() > 0) {
-									bool nameMatch = false;
-									if ((*itRules)->m_allowPartialNameMatch) {
-										nameMatch = std::strstr(pConstantDesc[j].Name, (*itRules)->m_constantName.c_str()) != NULL;
-
-										/*if (nameMatch) {
-										OutputDebugString("Match\n");
-										}
-										else {
-										OutputDebugString("No Match\n");
-										}*/
-									}
-									else {
-										nameMatch = (*itRules)->m_constantName.compare(pConstantDesc[j].Name) == 0;
-
-										//OutputDebugString("Full name match only\n");
-									}
-
-									if (!nameMatch) {
-										// no match
-										++itRules;
-										continue;
-									}
-								}
-
-								// register match required
-								if ((*itRules)->m_startRegIndex != UINT_MAX) {
-									if ((*itRules)->m_startRegIndex != pConstantDesc[j].RegisterIndex) {
-										// no match
-										++itRules;
-										continue;
-									}
-								}
+			// only the first matching rule is applied to a constant
+			ConstantModificationRule* rule = FirstMatchingRule(*pRules, *itConstant);
+			if (!rule)
+				continue;
 
 #ifdef _DEBUG
-								// output shader constant + index 
-								switch(pConstantDesc[j].Class)
-								{
-								case D3DXPC_VECTOR:
-									OutputDebugString("D3DXPC_VECTOR");
-									break;
-								case D3DXPC_MATRIX_ROWS:
-									OutputDebugString("D3DXPC_MATRIX_ROWS");
-									break;
-								case D3DXPC_MATRIX_COLUMNS:
-									OutputDebugString("D3DXPC_MATRIX_COLUMNS");
-									break;
-								}
-								char buf[32];
-								sprintf_s(buf,"Register Index: %d", pConstantDesc[j].RegisterIndex);
-								OutputDebugString(buf);
+			// output shader constant + index 
+			switch(itConstant->parameterClass)
+			{
+			case D3DXPC_VECTOR:
+				OutputDebugString("D3DXPC_VECTOR");
+				break;
+			case D3DXPC_MATRIX_ROWS:
+				OutputDebugString("D3DXPC_MATRIX_ROWS");
+				break;
+			case D3DXPC_MATRIX_COLUMNS:
+				OutputDebugString("D3DXPC_MATRIX_COLUMNS");
+				break;
+			}
+			char buf[32];
+			sprintf_s(buf,"Register Index: %d", itConstant->registerIndex);
+			OutputDebugString(buf);
 #endif
 
-								// Create StereoShaderConstant<float> and add to result
-								result.insert(std::pair<UINT, StereoShaderConstant<>>(pConstantDesc[j].RegisterIndex, CreateStereoConstantFrom(*itRules, pConstantDesc[j].RegisterIndex, pConstantDesc[j].RegisterCount)));
-
-								// only the first matching rule is applied to a constant
-								break;
-							}
-
-							++itRules;
-						}
-				}	
+			// Create StereoShaderConstant<float> and add to result
+			if (AddStereoConstantFrom(result, rule, itConstant->registerIndex, itConstant->registerCount)) {
+				ShaderAnalysisCache::CachedConstant cachedConstant;
+				cachedConstant.startRegister = (WORD)itConstant->registerIndex;
+				cachedConstant.count = (WORD)result.Count(result.Find(itConstant->registerIndex));
+				cachedConstant.modificationRuleID = rule->m_modificationRuleID;
+				cachedConstants.push_back(cachedConstant);
 			}
 		}
-	}
 
-	_SAFE_RELEASE(pConstantTable);
-	if (pData) delete[] pData;
+		m_analysisCache.Add(m_ruleSetHash, hash, sizeOfData, cachedConstants, result.UsedRegisters());
+	}
 
 	return result;
 }
@@ -588,6 +594,8 @@ std::map<UINT, StereoShaderConstant<float>> ShaderModificationRepository::GetMod
 ***/
 UINT ShaderModificationRepository::GetUniqueRuleID()
 {
+	CriticalSectionLock lock(&m_lock);
+
 	UINT result = 1;
 	auto itModificationRules = m_AllModificationRules.begin();
 	while (itModificationRules != m_AllModificationRules.end())
@@ -600,39 +608,255 @@ UINT ShaderModificationRepository::GetUniqueRuleID()
 }
 
 /**
-* Creates and returns StereoShaderConstant by specified rule.
+* Creates a StereoShaderConstant by specified rule and adds it to the table.
 * StartReg is needed for registers that were identified by rule using name for matching but not register.
+* The modification of the rule is created once and shared by all constants using that rule.
+* @param table [in, out] The constant table of the shader.
 * @param rule [in] Shader constant modification rule.
 * @param StartReg [in] Shader constant start register.
 * @param Count [in] Shader constant size.
-* @return The stereo shader constant containing the specified modification rule.
+* @return False if the table already contains a constant at StartReg.
 ***/
-StereoShaderConstant<> ShaderModificationRepository::CreateStereoConstantFrom(const ConstantModificationRule* rule, UINT StartReg, UINT Count)
+bool ShaderModificationRepository::AddStereoConstantFrom(StereoConstantTable& table, const ConstantModificationRule* rule, UINT StartReg, UINT Count)
 {
 	assert ((rule->m_startRegIndex == UINT_MAX) ? (StartReg != UINT_MAX) : (rule->m_startRegIndex == StartReg));
 
-	std::shared_ptr<ShaderConstantModification<>> modification = nullptr;
-	float* pData = NULL;
-
+	// initial data, zero vectors or identity matrix (followed by zero registers for larger constants)
+	static const float zeroData[StereoShaderConstant<>::MAX_REGISTERS * 4] = { 0 };
+	std::vector<float> largeData;
+	const float* pData = NULL;
 	switch (rule->m_constantType)
 	{
 	case D3DXPC_VECTOR:
-		modification = ShaderConstantModificationFactory::CreateVector4Modification(rule->m_operationToApply, m_spAdjustmentMatrices);
-		pData = D3DXVECTOR4(0,0,0,0);
-
-		return StereoShaderConstant<>(StartReg, pData, Count, modification);
+		pData = zeroData;
 		break;
 
 	case D3DXPC_MATRIX_ROWS:
 	case D3DXPC_MATRIX_COLUMNS:
-		modification = ShaderConstantModificationFactory::CreateMatrixModification(rule->m_operationToApply, m_spAdjustmentMatrices, rule->m_transpose);
 		pData = m_identity;
-
-		return StereoShaderConstant<>(StartReg, pData, Count, modification);
 		break;
 
 	default:
 		throw 69; // unhandled type
 		break;
 	}
+
+	if (Count > StereoShaderConstant<>::MAX_REGISTERS) {
+		largeData.assign(pData, pData + StereoShaderConstant<>::MAX_REGISTERS * 4);
+		largeData.resize(Count * 4, 0.0f);
+		pData = &largeData[0];
+	}
+
+	std::shared_ptr<ShaderConstantModification<>>& modification = m_modificationsByRuleID[rule->m_modificationRuleID];
+	if (!modification) {
+		if (rule->m_constantType == D3DXPC_VECTOR)
+			modification = ShaderConstantModificationFactory::CreateVector4Modification(rule->m_operationToApply, m_spAdjustmentMatrices);
+		else
+			modification = ShaderConstantModificationFactory::CreateMatrixModification(rule->m_operationToApply, m_spAdjustmentMatrices, rule->m_transpose);
+	}
+
+	return table.Add(StartReg, Count, modification, pData);
+}
+
+/**
+* Creates the modified constants of a shader from its cached analysis.
+* @param pCached [in] The cached analysis.
+* @param table [in, out] The (empty) constant table of the shader.
+* @return False if a rule of the analysis does not exist (any more), the table is left unchanged then.
+***/
+bool ShaderModificationRepository::ConstantsFromCache(const ShaderAnalysisCache::CachedShader* pCached, StereoConstantTable& table)
+{
+	const ShaderAnalysisCache::CachedConstant* pConstants = ShaderAnalysisCache::Constants(pCached);
+	for (UINT i = 0; i < pCached->constantCount; i++) {
+		if (m_AllModificationRules.count(pConstants[i].modificationRuleID) == 0)
+			return false;
+	}
+
+	for (UINT i = 0; i < pCached->constantCount; i++)
+		AddStereoConstantFrom(table, &m_AllModificationRules[pConstants[i].modificationRuleID], pConstants[i].startRegister, pConstants[i].count);
+
+	if (pCached->usedRegisterWords != ShaderAnalysisCache::USAGE_UNKNOWN)
+		table.SetUsage(ShaderAnalysisCache::UsedRegisters(pCached), pCached->usedRegisterWords);
+
+	return true;
+}
+
+/**
+* Updates the rule set hash, called whenever the rules change.
+* Hashes every property of the rules that affects the shader analysis, shader analyses are cached
+* per rule set hash.
+***/
+void ShaderModificationRepository::UpdateRuleSetHash()
+{
+	std::vector<UINT> values;
+
+	// rules, ordered by id
+	std::map<UINT, const ConstantModificationRule*> rules;
+	for (auto itRules = m_AllModificationRules.begin(); itRules != m_AllModificationRules.end(); ++itRules)
+		rules[itRules->first] = &itRules->second;
+
+	for (auto itRules = rules.begin(); itRules != rules.end(); ++itRules) {
+		const ConstantModificationRule* rule = itRules->second;
+		uint32_t nameHash;
+		MurmurHash3_x86_32(rule->m_constantName.c_str(), (int)rule->m_constantName.size(), VIREIO_SEED, &nameHash);
+
+		values.push_back(itRules->first);
+		values.push_back(nameHash);
+		values.push_back((UINT)rule->m_constantName.size());
+		values.push_back(rule->m_allowPartialNameMatch ? 1 : 0);
+		values.push_back(rule->m_startRegIndex);
+		values.push_back((UINT)rule->m_constantType);
+		values.push_back(rule->m_operationToApply);
+		values.push_back(rule->m_transpose ? 1 : 0);
+	}
+
+	// default rules, application order matters
+	values.push_back((UINT)m_defaultModificationRuleIDs.size());
+	values.insert(values.end(), m_defaultModificationRuleIDs.begin(), m_defaultModificationRuleIDs.end());
+
+	// shader specific rules, ordered by shader hash
+	std::map<uint32_t, const std::vector<UINT>*> shaderRules;
+	for (auto itShader = m_shaderSpecificModificationRuleIDs.begin(); itShader != m_shaderSpecificModificationRuleIDs.end(); ++itShader)
+		shaderRules[itShader->first] = &itShader->second;
+
+	for (auto itShader = shaderRules.begin(); itShader != shaderRules.end(); ++itShader) {
+		values.push_back(itShader->first);
+		values.push_back((UINT)itShader->second->size());
+		values.insert(values.end(), itShader->second->begin(), itShader->second->end());
+	}
+
+	uint32_t hash;
+	MurmurHash3_x86_32(&values[0], (int)(values.size() * sizeof(UINT)), VIREIO_SEED, &hash);
+	m_ruleSetHash = hash;
+}
+
+/**
+* Compiles the default and the shader specific rule lists, called whenever the rules change.
+* Interned shader functions are dropped as well.
+* Rule ids without a rule are skipped, they could never match.
+***/
+void ShaderModificationRepository::CompileRules()
+{
+	// analyses done with other rules are not shared with new shaders
+	{
+		CriticalSectionLock lock(&m_internLock);
+		m_internedShaders.clear();
+	}
+
+	CompileRuleList(m_defaultModificationRuleIDs, m_compiledDefaultRules);
+
+	m_compiledShaderRules.clear();
+	for (auto itShader = m_shaderSpecificModificationRuleIDs.begin(); itShader != m_shaderSpecificModificationRuleIDs.end(); ++itShader)
+		CompileRuleList(itShader->second, m_compiledShaderRules[itShader->first]);
+}
+
+/**
+* Compiles one rule list.
+* The constant names of the rules are compiled into one name matcher, registers and types into masks.
+* @param ruleIDs The rule ids, in application order.
+* @param compiled [out] The compiled rules.
+***/
+void ShaderModificationRepository::CompileRuleList(const std::vector<UINT>& ruleIDs, CompiledRules& compiled)
+{
+	compiled.rules.clear();
+	compiled.names.Clear();
+	compiled.byRegister.clear();
+
+	for (auto itRules = ruleIDs.begin(); itRules != ruleIDs.end(); ++itRules) {
+		auto itRule = m_AllModificationRules.find(*itRules);
+		if (itRule != m_AllModificationRules.end())
+			compiled.rules.push_back(&itRule->second);
+	}
+
+	UINT maskWords = ((UINT)compiled.rules.size() + 31) / 32;
+	compiled.unnamed.assign(maskWords, 0);
+	compiled.anyRegister.assign(maskWords, 0);
+	for (int i = 0; i < 3; i++)
+		compiled.byClass[i].assign(maskWords, 0);
+
+	for (UINT i = 0; i < (UINT)compiled.rules.size(); i++) {
+		const ConstantModificationRule* rule = compiled.rules[i];
+		DWORD bit = 1UL << (i % 32);
+
+		if (rule->m_constantName.size() > 0)
+			compiled.names.AddPattern(rule->m_constantName, rule->m_allowPartialNameMatch, i);
+		else
+			compiled.unnamed[i / 32] |= bit;
+
+		if (rule->m_startRegIndex == UINT_MAX) {
+			compiled.anyRegister[i / 32] |= bit;
+		}
+		else {
+			std::vector<DWORD>& registerMask = compiled.byRegister[rule->m_startRegIndex];
+			registerMask.resize(maskWords, 0);
+			registerMask[i / 32] |= bit;
+		}
+
+		switch (rule->m_constantType)
+		{
+		case D3DXPC_VECTOR:
+			compiled.byClass[0][i / 32] |= bit;
+			break;
+		case D3DXPC_MATRIX_ROWS:
+			compiled.byClass[1][i / 32] |= bit;
+			break;
+		case D3DXPC_MATRIX_COLUMNS:
+			compiled.byClass[2][i / 32] |= bit;
+			break;
+		}
+	}
+
+	compiled.names.Compile();
+}
+
+/**
+* Returns the first rule of a compiled rule list matching a constant, NULL if none matches.
+* Candidates are (unnamed rules | name matches) & type rules & (rules for any register | register rules).
+* @param compiled The compiled rules.
+* @param constant The constant.
+***/
+ShaderModificationRepository::ConstantModificationRule* ShaderModificationRepository::FirstMatchingRule(CompiledRules& compiled, const ShaderBytecode::Constant& constant)
+{
+	const std::vector<DWORD>* pClassMask;
+	switch (constant.parameterClass)
+	{
+	case D3DXPC_VECTOR:
+		pClassMask = &compiled.byClass[0];
+		break;
+	case D3DXPC_MATRIX_ROWS:
+		pClassMask = &compiled.byClass[1];
+		break;
+	case D3DXPC_MATRIX_COLUMNS:
+		pClassMask = &compiled.byClass[2];
+		break;
+	default:
+		return NULL;
+	}
+
+	auto itRegister = compiled.byRegister.find(constant.registerIndex);
+	const std::vector<DWORD>* pRegisterMask = (itRegister != compiled.byRegister.end()) ? &itRegister->second : NULL;
+
+	std::vector<DWORD> nameMatches;
+	compiled.names.Match(constant.name, &nameMatches);
+
+	for (UINT word = 0; word < (UINT)pClassMask->size(); word++) {
+		DWORD candidates = compiled.unnamed[word];
+		if (word < (UINT)nameMatches.size())
+			candidates |= nameMatches[word];
+
+		candidates &= (*pClassMask)[word];
+
+		DWORD registers = compiled.anyRegister[word];
+		if (pRegisterMask)
+			registers |= (*pRegisterMask)[word];
+		candidates &= registers;
+
+		if (candidates) {
+			DWORD bit;
+			_BitScanForward(&bit, candidates);
+			return compiled.rules[word * 32 + bit];
+		}
+	}
+
+	return NULL;
 }
\ No newline at end of file
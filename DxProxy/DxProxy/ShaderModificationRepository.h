@@ -33,10 +33,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <d3d9.h>
 #include <d3dx9.h>
 #include <vector>
+#include <map>
 #include <unordered_map>
 #include <string>
 #include <memory>
 #include "StereoShaderConstant.h"
+#include "StereoConstantTable.h"
+#include "ShaderAnalysisCache.h"
+#include "ShaderAnalysisQueue.h"
+#include "ConstantNameMatcher.h"
+#include "ShaderBytecode.h"
 #include "GameHandler.h"
 #include "ShaderRegisters.h"
 #include "MurmurHash3.h"
@@ -50,6 +56,9 @@ class ViewAdjustment;
 
 /**
 * Creates shader modifications defined in shader_rules game configuration files.
+* Shader analyses are cached persistently, keyed by shader and rule set hash.
+* Shaders can be analysed on the worker threads of the analysis queue, all public methods are thread safe.
+* Shader functions are interned, shaders created with the same function share one analysis.
 */
 class ShaderModificationRepository
 {
@@ -61,8 +70,12 @@ public:
 	bool                                        LoadRules(std::string rulesPath);
 	bool                                        SaveRules(std::string rulesPath);
 	bool                                        AddRule(std::string constantName, bool allowPartialNameMatch, UINT startRegIndex, D3DXPARAMETER_CLASS constantType, UINT operationToApply, UINT modificationRuleID, bool transpose);
-	std::map<UINT, StereoShaderConstant<float>> GetModifiedConstantsF(IDirect3DPixelShader9* pActualPixelShader);
-	std::map<UINT, StereoShaderConstant<float>> GetModifiedConstantsF(IDirect3DVertexShader9* pActualVertexShader);
+	StereoConstantTable                         GetModifiedConstantsF(IDirect3DPixelShader9* pActualPixelShader);
+	StereoConstantTable                         GetModifiedConstantsF(IDirect3DVertexShader9* pActualVertexShader);
+	std::shared_ptr<ShaderAnalysisQueue::Job>   QueueModifiedConstantsF(IDirect3DPixelShader9* pActualPixelShader);
+	std::shared_ptr<ShaderAnalysisQueue::Job>   QueueModifiedConstantsF(IDirect3DVertexShader9* pActualVertexShader);
+	StereoConstantTable                         ModifiedConstantsFromFunction(const BYTE* pData, UINT sizeOfData);
+	ShaderAnalysisQueue*                        AnalysisQueue();
 	UINT                                        GetUniqueRuleID();
 
 private:
@@ -187,8 +200,43 @@ private:
 		bool m_transpose;
 	};
 
+	/**
+	* A rule list compiled for matching.
+	* Bit n of every mask stands for rules[n], so the lowest candidate bit is the first matching rule.
+	***/
+	struct CompiledRules
+	{
+		std::vector<ConstantModificationRule*>              rules;       /**< The rules, in application order. */
+		ConstantNameMatcher                                 names;       /**< Name patterns of the named rules, pattern id is the rule index. */
+		std::vector<DWORD>                                  unnamed;     /**< Rules without a constant name. */
+		std::vector<DWORD>                                  anyRegister; /**< Rules without a start register. */
+		std::unordered_map<UINT, std::vector<DWORD>>        byRegister;  /**< Rules by start register. */
+		std::vector<DWORD>                                  byClass[3];  /**< Rules by constant type (vector, matrix rows, matrix columns). */
+	};
+
+	/**
+	* An interned shader function.
+	***/
+	struct InternedFunction
+	{
+		std::vector<BYTE>                       function; /**< The shader function. */
+		std::weak_ptr<ShaderAnalysisQueue::Job> analysis; /**< The shared analysis, expires with the last shader holding it. */
+	};
+	/**
+	* Interned shader functions.
+	* <Function size << 32 | function hash, InternedFunction>
+	***/
+	typedef std::unordered_multimap<UINT64, InternedFunction> InternedFunctions;
+
 	/*** ShaderModificationRepository private methods ***/
-	StereoShaderConstant<float> CreateStereoConstantFrom(const ConstantModificationRule* rule, UINT StartReg, UINT Count);
+	std::shared_ptr<ShaderAnalysisQueue::Job> InternFunction(std::vector<BYTE>& function);
+	InternedFunctions::iterator               FindInterned(UINT64 key, const std::vector<BYTE>& function);
+	bool                                      AddStereoConstantFrom(StereoConstantTable& table, const ConstantModificationRule* rule, UINT StartReg, UINT Count);
+	bool                                      ConstantsFromCache(const ShaderAnalysisCache::CachedShader* pCached, StereoConstantTable& table);
+	void                                      UpdateRuleSetHash();
+	void                                      CompileRules();
+	void                                      CompileRuleList(const std::vector<UINT>& ruleIDs, CompiledRules& compiled);
+	ConstantModificationRule*                 FirstMatchingRule(CompiledRules& compiled, const ShaderBytecode::Constant& constant);
 
 	/**
 	* Matrix calculation class pointer, used here to create the modifications.
@@ -213,5 +261,49 @@ private:
 	* <Shader hash, vector<Modification Rule ID>>
 	***/
 	std::unordered_map<uint32_t, std::vector<UINT>> m_shaderSpecificModificationRuleIDs;
+	/**
+	* Modifications created so far, one per rule (modifications are stateless, so shaders share them).
+	* <Modification Rule ID, Modification>
+	***/
+	std::unordered_map<UINT, std::shared_ptr<ShaderConstantModification<>>> m_modificationsByRuleID;
+	/**
+	* Hash of the current rules.
+	* @see UpdateRuleSetHash()
+	***/
+	uint32_t m_ruleSetHash;
+	/**
+	* Default rules, compiled.
+	* @see CompileRules()
+	***/
+	CompiledRules m_compiledDefaultRules;
+	/**
+	* Shader specific rules, compiled.
+	* <Shader hash, CompiledRules>
+	***/
+	std::unordered_map<uint32_t, CompiledRules> m_compiledShaderRules;
+	/**
+	* Persistent shader analysis cache, opened by LoadRules().
+	***/
+	ShaderAnalysisCache m_analysisCache;
+	/**
+	* Guards the rules, the modifications and the analysis cache.
+	***/
+	CRITICAL_SECTION m_lock;
+	/**
+	* Shader analysis worker pool.
+	***/
+	ShaderAnalysisQueue* m_pAnalysisQueue;
+	/**
+	* Interned shader functions.
+	***/
+	InternedFunctions m_internedShaders;
+	/**
+	* Number of interned functions at which released ones are dropped next.
+	***/
+	UINT m_internPurgeSize;
+	/**
+	* Guards the interned functions.
+	***/
+	CRITICAL_SECTION m_internLock;
 };
 #endif
@@ -28,25 +28,49 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ********************************************************************/
 
 #include "ShaderRegisters.h"
+#include "D3DProxyDevice.h"
+#include "StereoShaderPatcher.h"
 #include <assert.h>
+#include <emmintrin.h>
 
 /**
 * Constructor, creates register vector.
 * @param maxVSConstantRegistersF Maximum number of constant registers.
 * @param pActualDevice Pointer to actual (not wrapped) D3D device.
+* @param pCounters Frame counters of the proxy device, uploads and stereo constant updates are counted here.
+* @param spAdjustment View adjustment of the stereo constant modifications, stereo constants are updated when it changes.
 ***/
-ShaderRegisters::ShaderRegisters(DWORD maxPSConstantRegistersF, DWORD maxVSConstantRegistersF, IDirect3DDevice9* pActualDevice) :
+ShaderRegisters::ShaderRegisters(DWORD maxPSConstantRegistersF, DWORD maxVSConstantRegistersF, IDirect3DDevice9* pActualDevice, ProxyCounterValues* pCounters, std::shared_ptr<ViewAdjustment> spAdjustment) :
 	m_maxPSConstantRegistersF(maxPSConstantRegistersF),
 	m_maxVSConstantRegistersF(maxVSConstantRegistersF),
 	m_psRegistersF(maxPSConstantRegistersF * VECTOR_LENGTH, 0), // VECTOR_LENGTH floats per register
 	m_vsRegistersF(maxVSConstantRegistersF * VECTOR_LENGTH, 0), // VECTOR_LENGTH floats per register
-	m_dirtyPSRegistersF(),
-	m_dirtyVSRegistersF(),
+	m_dirtyPSRegistersF(maxPSConstantRegistersF),
+	m_dirtyVSRegistersF(maxVSConstantRegistersF),
+	m_psRegisterPagesF(maxPSConstantRegistersF),
+	m_vsRegisterPagesF(maxVSConstantRegistersF),
+	m_vsRegistersI(MAX_CONSTANT_REGISTERS_I * VECTOR_LENGTH, 0),
+	m_vsRegistersB(MAX_CONSTANT_REGISTERS_B, FALSE),
+	m_psRegistersI(MAX_CONSTANT_REGISTERS_I * VECTOR_LENGTH, 0),
+	m_psRegistersB(MAX_CONSTANT_REGISTERS_B, FALSE),
+	m_dirtyVSRegistersI(MAX_CONSTANT_REGISTERS_I),
+	m_dirtyVSRegistersB(MAX_CONSTANT_REGISTERS_B),
+	m_dirtyPSRegistersI(MAX_CONSTANT_REGISTERS_I),
+	m_dirtyPSRegistersB(MAX_CONSTANT_REGISTERS_B),
+	m_stagingRegistersF(max(maxPSConstantRegistersF, maxVSConstantRegistersF) * VECTOR_LENGTH, 0),
+	m_vsTransitions(),
+	m_psTransitions(),
+	m_uploadGapThreshold(0),
 	m_pActualDevice(pActualDevice),
+	m_pCounters(pCounters),
+	m_spAdjustment(spAdjustment),
+	m_adjustmentGeneration(spAdjustment->Generation()),
 	m_pActivePixelShader(NULL),
 	m_pActiveVertexShader(NULL)
 {
 	assert(pActualDevice != NULL);
+	assert(pCounters != NULL);
+	assert(spAdjustment);
 
 	//TODO assignment and copy - add ref to device (remove ref from old device on assign)? or prevent
 	m_pActualDevice->AddRef();
@@ -79,16 +103,11 @@ ShaderRegisters::~ShaderRegisters()
 ***/
 HRESULT WINAPI ShaderRegisters::SetVertexShaderConstantF(UINT StartRegister, const float* pConstantData, UINT Vector4fCount)
 {
-	if ((StartRegister >= m_maxVSConstantRegistersF) || ((StartRegister + Vector4fCount) >= m_maxVSConstantRegistersF))
+	if (!InRange(StartRegister, Vector4fCount, m_maxVSConstantRegistersF))
 		return D3DERR_INVALIDCALL;
 
-	// Set proxy registers
-	std::copy(pConstantData, pConstantData + (VECTOR_LENGTH * Vector4fCount), m_vsRegistersF.begin() + RegisterIndex(StartRegister));
-
-	// Mark registers dirty
-	for (UINT i = StartRegister; i < StartRegister + Vector4fCount; i++) {
-		m_dirtyVSRegistersF.insert(i);
-	}
+	// Set proxy registers, mark changed registers dirty
+	m_pCounters->vsConstantsUnchanged += CopyChangedRegisters(&m_vsRegistersF[0], pConstantData, StartRegister, Vector4fCount, m_dirtyVSRegistersF, m_vsRegisterPagesF);
 
 	return D3D_OK;
 }
@@ -101,10 +120,10 @@ HRESULT WINAPI ShaderRegisters::SetVertexShaderConstantF(UINT StartRegister, con
 ***/
 HRESULT WINAPI ShaderRegisters::GetVertexShaderConstantF(UINT StartRegister, float* pConstantData, UINT Vector4fCount)
 {
-	if ((StartRegister >= m_maxVSConstantRegistersF) || ((StartRegister + Vector4fCount) >= m_maxVSConstantRegistersF))
+	if (!InRange(StartRegister, Vector4fCount, m_maxVSConstantRegistersF))
 		return D3DERR_INVALIDCALL;
 
-	pConstantData = &m_vsRegistersF[RegisterIndex(StartRegister)];
+	std::copy(m_vsRegistersF.begin() + RegisterIndex(StartRegister), m_vsRegistersF.begin() + RegisterIndex(StartRegister) + (VECTOR_LENGTH * Vector4fCount), pConstantData);
 
 	return D3D_OK;
 }
@@ -121,16 +140,11 @@ HRESULT WINAPI ShaderRegisters::GetVertexShaderConstantF(UINT StartRegister, flo
 ***/
 HRESULT WINAPI ShaderRegisters::SetPixelShaderConstantF(UINT StartRegister, const float* pConstantData, UINT Vector4fCount)
 {
-	if ((StartRegister >= m_maxPSConstantRegistersF) || ((StartRegister + Vector4fCount) >= m_maxPSConstantRegistersF))
+	if (!InRange(StartRegister, Vector4fCount, m_maxPSConstantRegistersF))
 		return D3DERR_INVALIDCALL;
 
-	// Set proxy registers
-	std::copy(pConstantData, pConstantData + (VECTOR_LENGTH * Vector4fCount), m_psRegistersF.begin() + RegisterIndex(StartRegister));
-
-	// Mark registers dirty
-	for (UINT i = StartRegister; i < StartRegister + Vector4fCount; i++) {
-		m_dirtyPSRegistersF.insert(i);
-	}
+	// Set proxy registers, mark changed registers dirty
+	m_pCounters->psConstantsUnchanged += CopyChangedRegisters(&m_psRegistersF[0], pConstantData, StartRegister, Vector4fCount, m_dirtyPSRegistersF, m_psRegisterPagesF);
 
 	return D3D_OK;
 }
@@ -143,10 +157,142 @@ HRESULT WINAPI ShaderRegisters::SetPixelShaderConstantF(UINT StartRegister, cons
 ***/
 HRESULT WINAPI ShaderRegisters::GetPixelShaderConstantF(UINT StartRegister, float* pConstantData, UINT Vector4fCount)
 {
-	if ((StartRegister >= m_maxPSConstantRegistersF) || ((StartRegister + Vector4fCount) >= m_maxPSConstantRegistersF))
+	if (!InRange(StartRegister, Vector4fCount, m_maxPSConstantRegistersF))
 		return D3DERR_INVALIDCALL;
 
-	pConstantData = &m_psRegistersF[RegisterIndex(StartRegister)];
+	std::copy(m_psRegistersF.begin() + RegisterIndex(StartRegister), m_psRegistersF.begin() + RegisterIndex(StartRegister) + (VECTOR_LENGTH * Vector4fCount), pConstantData);
+
+	return D3D_OK;
+}
+
+/**
+* Sets proxy integer registers, marks changed registers dirty.
+* Return D3DERR_INVALIDCALL if any registers out of internal range.
+* @param StartRegister Look at D3DProxyDevice::SetVertexShaderConstantI(). 
+* @param pConstantData Look at D3DProxyDevice::SetVertexShaderConstantI().
+* @param Vector4iCount Look at D3DProxyDevice::SetVertexShaderConstantI().
+***/
+HRESULT WINAPI ShaderRegisters::SetVertexShaderConstantI(UINT StartRegister, const int* pConstantData, UINT Vector4iCount)
+{
+	if (!InRange(StartRegister, Vector4iCount, MAX_CONSTANT_REGISTERS_I))
+		return D3DERR_INVALIDCALL;
+
+	m_pCounters->intBoolConstantsUnchanged += CopyChangedValues(&m_vsRegistersI[0], pConstantData, StartRegister, Vector4iCount, VECTOR_LENGTH * sizeof(int), m_dirtyVSRegistersI);
+
+	return D3D_OK;
+}
+
+/**
+* Gets proxy integer registers.
+* @param StartRegister Look at D3DProxyDevice::GetVertexShaderConstantI(). 
+* @param pConstantData Look at D3DProxyDevice::GetVertexShaderConstantI().
+* @param Vector4iCount Look at D3DProxyDevice::GetVertexShaderConstantI().
+***/
+HRESULT WINAPI ShaderRegisters::GetVertexShaderConstantI(UINT StartRegister, int* pConstantData, UINT Vector4iCount)
+{
+	if (!InRange(StartRegister, Vector4iCount, MAX_CONSTANT_REGISTERS_I))
+		return D3DERR_INVALIDCALL;
+
+	memcpy(pConstantData, &m_vsRegistersI[RegisterIndex(StartRegister)], Vector4iCount * VECTOR_LENGTH * sizeof(int));
+
+	return D3D_OK;
+}
+
+/**
+* Sets proxy boolean registers, marks changed registers dirty.
+* Return D3DERR_INVALIDCALL if any registers out of internal range.
+* @param StartRegister Look at D3DProxyDevice::SetVertexShaderConstantB(). 
+* @param pConstantData Look at D3DProxyDevice::SetVertexShaderConstantB().
+* @param BoolCount Look at D3DProxyDevice::SetVertexShaderConstantB().
+***/
+HRESULT WINAPI ShaderRegisters::SetVertexShaderConstantB(UINT StartRegister, const BOOL* pConstantData, UINT BoolCount)
+{
+	if (!InRange(StartRegister, BoolCount, MAX_CONSTANT_REGISTERS_B))
+		return D3DERR_INVALIDCALL;
+
+	m_pCounters->intBoolConstantsUnchanged += CopyChangedValues(&m_vsRegistersB[0], pConstantData, StartRegister, BoolCount, sizeof(BOOL), m_dirtyVSRegistersB);
+
+	return D3D_OK;
+}
+
+/**
+* Gets proxy boolean registers.
+* @param StartRegister Look at D3DProxyDevice::GetVertexShaderConstantB(). 
+* @param pConstantData Look at D3DProxyDevice::GetVertexShaderConstantB().
+* @param BoolCount Look at D3DProxyDevice::GetVertexShaderConstantB().
+***/
+HRESULT WINAPI ShaderRegisters::GetVertexShaderConstantB(UINT StartRegister, BOOL* pConstantData, UINT BoolCount)
+{
+	if (!InRange(StartRegister, BoolCount, MAX_CONSTANT_REGISTERS_B))
+		return D3DERR_INVALIDCALL;
+
+	memcpy(pConstantData, &m_vsRegistersB[StartRegister], BoolCount * sizeof(BOOL));
+
+	return D3D_OK;
+}
+
+/**
+* Sets proxy integer registers, marks changed registers dirty.
+* Return D3DERR_INVALIDCALL if any registers out of internal range.
+* @param StartRegister Look at D3DProxyDevice::SetPixelShaderConstantI(). 
+* @param pConstantData Look at D3DProxyDevice::SetPixelShaderConstantI().
+* @param Vector4iCount Look at D3DProxyDevice::SetPixelShaderConstantI().
+***/
+HRESULT WINAPI ShaderRegisters::SetPixelShaderConstantI(UINT StartRegister, const int* pConstantData, UINT Vector4iCount)
+{
+	if (!InRange(StartRegister, Vector4iCount, MAX_CONSTANT_REGISTERS_I))
+		return D3DERR_INVALIDCALL;
+
+	m_pCounters->intBoolConstantsUnchanged += CopyChangedValues(&m_psRegistersI[0], pConstantData, StartRegister, Vector4iCount, VECTOR_LENGTH * sizeof(int), m_dirtyPSRegistersI);
+
+	return D3D_OK;
+}
+
+/**
+* Gets proxy integer registers.
+* @param StartRegister Look at D3DProxyDevice::GetPixelShaderConstantI(). 
+* @param pConstantData Look at D3DProxyDevice::GetPixelShaderConstantI().
+* @param Vector4iCount Look at D3DProxyDevice::GetPixelShaderConstantI().
+***/
+HRESULT WINAPI ShaderRegisters::GetPixelShaderConstantI(UINT StartRegister, int* pConstantData, UINT Vector4iCount)
+{
+	if (!InRange(StartRegister, Vector4iCount, MAX_CONSTANT_REGISTERS_I))
+		return D3DERR_INVALIDCALL;
+
+	memcpy(pConstantData, &m_psRegistersI[RegisterIndex(StartRegister)], Vector4iCount * VECTOR_LENGTH * sizeof(int));
+
+	return D3D_OK;
+}
+
+/**
+* Sets proxy boolean registers, marks changed registers dirty.
+* Return D3DERR_INVALIDCALL if any registers out of internal range.
+* @param StartRegister Look at D3DProxyDevice::SetPixelShaderConstantB(). 
+* @param pConstantData Look at D3DProxyDevice::SetPixelShaderConstantB().
+* @param BoolCount Look at D3DProxyDevice::SetPixelShaderConstantB().
+***/
+HRESULT WINAPI ShaderRegisters::SetPixelShaderConstantB(UINT StartRegister, const BOOL* pConstantData, UINT BoolCount)
+{
+	if (!InRange(StartRegister, BoolCount, MAX_CONSTANT_REGISTERS_B))
+		return D3DERR_INVALIDCALL;
+
+	m_pCounters->intBoolConstantsUnchanged += CopyChangedValues(&m_psRegistersB[0], pConstantData, StartRegister, BoolCount, sizeof(BOOL), m_dirtyPSRegistersB);
+
+	return D3D_OK;
+}
+
+/**
+* Gets proxy boolean registers.
+* @param StartRegister Look at D3DProxyDevice::GetPixelShaderConstantB(). 
+* @param pConstantData Look at D3DProxyDevice::GetPixelShaderConstantB().
+* @param BoolCount Look at D3DProxyDevice::GetPixelShaderConstantB().
+***/
+HRESULT WINAPI ShaderRegisters::GetPixelShaderConstantB(UINT StartRegister, BOOL* pConstantData, UINT BoolCount)
+{
+	if (!InRange(StartRegister, BoolCount, MAX_CONSTANT_REGISTERS_B))
+		return D3DERR_INVALIDCALL;
+
+	memcpy(pConstantData, &m_psRegistersB[StartRegister], BoolCount * sizeof(BOOL));
 
 	return D3D_OK;
 }
@@ -167,6 +313,24 @@ std::vector<float> ShaderRegisters::GetAllPSConstantRegistersF()
 	return m_psRegistersF;
 }
 
+/**
+* Captures all vertex shader constant registers, for state blocks.
+* Only register pages written since the last capture are copied, the others are shared with earlier snapshots.
+***/
+RegisterSnapshot ShaderRegisters::CaptureVSConstantRegistersF()
+{
+	return m_vsRegisterPagesF.Capture(&m_vsRegistersF[0]);
+}
+
+/**
+* Captures all pixel shader constant registers, for state blocks.
+* Only register pages written since the last capture are copied, the others are shared with earlier snapshots.
+***/
+RegisterSnapshot ShaderRegisters::CapturePSConstantRegistersF()
+{
+	return m_psRegisterPagesF.Capture(&m_psRegistersF[0]);
+}
+
 /**
 * For restoring states from D3DProxyStateBlock.
 * If sides during capture were mixed or the current device side doesn't match side at time of
@@ -231,7 +395,7 @@ void ShaderRegisters::SetFromStateBlockData(std::map<UINT, D3DXVECTOR4> * stored
 	auto itNewRegsVS = storedVSRegisters->begin();
 	while (itNewRegsVS != storedVSRegisters->end()) {
 
-		if ((RegisterIndex(itNewRegsVS->first) + VECTOR_LENGTH) >= m_vsRegistersF.size())
+		if (!InRange(itNewRegsVS->first, 1, m_maxVSConstantRegistersF))
 			throw std::out_of_range("Register from stateblock is out of range, implosion imminent");
 
 		//std::copy(static_cast<float*>(itNewRegsVS->second), static_cast<float*>(itNewRegsVS->second) + VECTOR_LENGTH,  &m_vsRegistersF[RegisterIndex(itNewRegsVS->first)]);
@@ -241,9 +405,10 @@ void ShaderRegisters::SetFromStateBlockData(std::map<UINT, D3DXVECTOR4> * stored
 		m_vsRegistersF[regStartIndexInVector + 1] = itNewRegsVS->second.y;
 		m_vsRegistersF[regStartIndexInVector + 2] = itNewRegsVS->second.z;
 		m_vsRegistersF[regStartIndexInVector + 3] = itNewRegsVS->second.w;
+		m_vsRegisterPagesF.Written(itNewRegsVS->first, 1);
 
 		// register is clean (now matches device state - unless it's stereo in which case it might not, that is handled at the end)
-		m_dirtyVSRegistersF.erase(itNewRegsVS->first);
+		m_dirtyVSRegistersF.Unmark(itNewRegsVS->first, 1);
 		++itNewRegsVS;
 	}
 
@@ -253,7 +418,7 @@ void ShaderRegisters::SetFromStateBlockData(std::map<UINT, D3DXVECTOR4> * stored
 	auto itNewRegsPS = storedPSRegisters->begin();
 	while (itNewRegsPS != storedPSRegisters->end()) {
 
-		if ((RegisterIndex(itNewRegsPS->first) + VECTOR_LENGTH) >= m_psRegistersF.size())
+		if (!InRange(itNewRegsPS->first, 1, m_maxPSConstantRegistersF))
 			throw std::out_of_range("Register from stateblock is out of range, implosion imminent");
 
 		// copy produces warnings, this does not.
@@ -262,9 +427,10 @@ void ShaderRegisters::SetFromStateBlockData(std::map<UINT, D3DXVECTOR4> * stored
 		m_psRegistersF[regStartIndexInVector + 1] = itNewRegsPS->second.y;
 		m_psRegistersF[regStartIndexInVector + 2] = itNewRegsPS->second.z;
 		m_psRegistersF[regStartIndexInVector + 3] = itNewRegsPS->second.w;
+		m_psRegisterPagesF.Written(itNewRegsPS->first, 1);
 
 		// register is clean (now matches device state - unless it's stereo in which case it might not, that is handled at the end)
-		m_dirtyPSRegistersF.erase(itNewRegsPS->first);
+		m_dirtyPSRegistersF.Unmark(itNewRegsPS->first, 1);
 		++itNewRegsPS;
 	}
 
@@ -282,40 +448,72 @@ void ShaderRegisters::SetFromStateBlockData(std::map<UINT, D3DXVECTOR4> * stored
 * stateblock textures for further thoughts.
 * The only time you restore all registers is when the whole vertex shader state is saved, in which
 * case there will always be a vertex shader to go with the registers (it may be null).
-* @param storedPSRegisters Pointer to stored pixel shader register vector.
-* @param storedVSRegisters Pointer to stored vertex shader register vector.
-* @param storedPShader Pointer to stored pixel shader.
-* @param storedVShader Pointer to stored vertex shader.
+* Snapshots are restored page by page, pages unchanged since the capture are not copied.
+* @param storedPSRegisters Pointer to stored pixel shader register snapshot.
+* @param storedVSRegisters Pointer to stored vertex shader register snapshot.
 ***/
-void ShaderRegisters::SetFromStateBlockData(std::vector<float> * storedVSRegisters, std::vector<float> *storedPSRegisters)
+void ShaderRegisters::SetFromStateBlockData(RegisterSnapshot * storedVSRegisters, RegisterSnapshot *storedPSRegisters)
 {
-	if (storedVSRegisters)
+	if (storedVSRegisters && *storedVSRegisters)
 	{
-		// Full register capture should always match the size of the existing register set as size is fixed and register was captured from this
-		assert(storedVSRegisters->size() == m_vsRegistersF.size());
-
-		std::copy(storedVSRegisters->begin(), storedVSRegisters->end(), m_vsRegistersF.begin());
+		m_vsRegisterPagesF.Restore(*storedVSRegisters, &m_vsRegistersF[0]);
 
 		// Data should match registers that are already on device (unless it's stereo in which case it might not, that is handled next)
-		m_dirtyVSRegistersF.clear();
+		m_dirtyVSRegistersF.Clear();
 
 		MarkAllVSStereoConstantsDirty();
 	}
 
-	if (storedPSRegisters)
+	if (storedPSRegisters && *storedPSRegisters)
 	{
-		// Full register capture should always match the size of the existing register set as size is fixed and register was captured from this
-		assert(storedPSRegisters->size() == m_psRegistersF.size());
-
-		std::copy(storedPSRegisters->begin(), storedPSRegisters->end(), m_psRegistersF.begin());
+		m_psRegisterPagesF.Restore(*storedPSRegisters, &m_psRegistersF[0]);
 
 		// Data should match registers that are already on device (unless it's stereo in which case it might not, that is handled next)
-		m_dirtyPSRegistersF.clear();
+		m_dirtyPSRegistersF.Clear();
 
 		MarkAllPSStereoConstantsDirty();
 	}
 }
 
+/**
+* For restoring integer and boolean registers from D3DProxyStateBlock.
+* The stored registers are set and marked dirty. The actual state block has already set them on the
+* actual device, but it captured the actual device and registers still pending in the proxy at that
+* time would be missing there, so they are uploaded again on the next draw.
+* @param storedRegistersI Stored integer registers, may be NULL.
+* @param storedRegistersB Stored boolean registers, may be NULL.
+* @param vertexShader True for vertex shader registers, false for pixel shader registers.
+***/
+void ShaderRegisters::SetFromStateBlockData(std::map<UINT, IntRegister>* storedRegistersI, std::map<UINT, BOOL>* storedRegistersB, bool vertexShader)
+{
+	std::vector<int>& registersI = vertexShader ? m_vsRegistersI : m_psRegistersI;
+	std::vector<BOOL>& registersB = vertexShader ? m_vsRegistersB : m_psRegistersB;
+	DirtyRegisters& dirtyRegistersI = vertexShader ? m_dirtyVSRegistersI : m_dirtyPSRegistersI;
+	DirtyRegisters& dirtyRegistersB = vertexShader ? m_dirtyVSRegistersB : m_dirtyPSRegistersB;
+
+	if (storedRegistersI) {
+		auto itRegister = storedRegistersI->begin();
+		while (itRegister != storedRegistersI->end()) {
+			if (InRange(itRegister->first, 1, MAX_CONSTANT_REGISTERS_I)) {
+				memcpy(&registersI[RegisterIndex(itRegister->first)], itRegister->second.data, sizeof(itRegister->second.data));
+				dirtyRegistersI.Mark(itRegister->first, 1);
+			}
+			++itRegister;
+		}
+	}
+
+	if (storedRegistersB) {
+		auto itRegister = storedRegistersB->begin();
+		while (itRegister != storedRegistersB->end()) {
+			if (InRange(itRegister->first, 1, MAX_CONSTANT_REGISTERS_B)) {
+				registersB[itRegister->first] = itRegister->second;
+				dirtyRegistersB.Mark(itRegister->first, 1);
+			}
+			++itRegister;
+		}
+	}
+}
+
 /**
 * Returns true if any dirty vertex shader register found in the specified range.
 * @param start Start register.
@@ -323,16 +521,7 @@ void ShaderRegisters::SetFromStateBlockData(std::vector<float> * storedVSRegiste
 ***/
 bool ShaderRegisters::AnyDirtyVS(UINT start, UINT count)
 {
-	auto it = m_dirtyVSRegistersF.lower_bound(start);
-
-	if (it == m_dirtyVSRegistersF.end())
-		return false;
-
-	if (*it >= start + count) {
-		return false;
-	}
-
-	return true;
+	return m_dirtyVSRegistersF.AnyInRange(start, count);
 }
 
 /**
@@ -342,119 +531,88 @@ bool ShaderRegisters::AnyDirtyVS(UINT start, UINT count)
 ***/
 bool ShaderRegisters::AnyDirtyPS(UINT start, UINT count)
 {
-	auto it = m_dirtyPSRegistersF.lower_bound(start);
-
-	if (it == m_dirtyPSRegistersF.end())
-		return false;
-
-	if (*it >= start + count) {
-		return false;
-	}
-
-	return true;
+	return m_dirtyPSRegistersF.AnyInRange(start, count);
 }
 
 /**
 * This will apply all dirty (vertex and pixel shader) registers to actual device. 
-* StereoShaderConstants are updated and applied followed by unmodified.
-* Note that stereo constants will only be applied if the underlying register has changed. To apply a 
-* specific side whether dirty or not use ApplyStereoConstantsVS with forceApply true.
+* Dirty StereoShaderConstants are updated, then stereo and unmodified registers are applied together,
+* one upload per continuous series of dirty registers (small clean gaps bridged).
+* Only float registers the active shaders read are applied, the others stay dirty until a shader
+* reading them is active (or ApplyAllDeferred() is called).
+* Note that stereo constants will only be applied if the underlying register or the view adjustment has
+* changed. To apply a specific side whether dirty or not use ApplyAllStereoConstants().
 * @param currentSide Left or Right side.
 ***/
 void ShaderRegisters::ApplyAllDirty(vireio::RenderPosition currentSide) 
 {	
-	// vertex shader 
-	if (m_dirtyVSRegistersF.size() > 0)
-	{
-
-		if (m_pActiveVertexShader) {
-			ApplyStereoConstantsVS(currentSide, true);
-		}
-
-		// Apply all remaining dirty registers (should just be non-stereo that remain dirty) to device
-		auto it = m_dirtyVSRegistersF.begin();
-
-		if (it != m_dirtyVSRegistersF.end()) {
-
-			int startReg = *it; // can't dererefence this if it might be end
-			int lastReg = startReg;
+	PROXY_PROFILE_SCOPE("ApplyAllDirty");
 
-			while (it != m_dirtyVSRegistersF.end()) {
+	MarkStaleStereoConstantsDirty();
 
-
-				auto itNext = std::next(it);
-				if ((itNext != m_dirtyVSRegistersF.end()) && (*itNext == lastReg + 1)) {
-					// skip through until we reach the end of a continuous series of dirty registers
-					lastReg = *itNext;
-				}
-				else {
-					// set this series of registers
-					m_pActualDevice->SetVertexShaderConstantF(startReg, &m_vsRegistersF[RegisterIndex(startReg)], lastReg - startReg + 1);
-
-					// If there are more dirty registers left the next register will be the new startReg
-					if (itNext != m_dirtyVSRegistersF.end()) {
-						startReg = *itNext;
-						lastReg = startReg;
-					}
-				}
-
-				++it;
-			}
-		}
-
-		m_dirtyVSRegistersF.clear();
-	}
+	// vertex shader 
+	if (m_dirtyVSRegistersF.Any())
+		ApplyDirtyMerged(m_pActiveVertexShader ? m_pActiveVertexShader->ModifiedConstants() : NULL, &m_vsRegistersF[0], m_dirtyVSRegistersF, currentSide, &ShaderRegisters::UploadVS, true);
 
 	// pixel shader
-	if (m_dirtyPSRegistersF.size() > 0)
-	{
-		if (m_pActivePixelShader) {
-			ApplyStereoConstantsPS(currentSide, true);
-		}
+	if (m_dirtyPSRegistersF.Any())
+		ApplyDirtyMerged(m_pActivePixelShader ? m_pActivePixelShader->ModifiedConstants() : NULL, &m_psRegistersF[0], m_dirtyPSRegistersF, currentSide, &ShaderRegisters::UploadPS, true);
 
-		// Apply all remaining dirty registers (should just be non-stereo that remain dirty) to device
-		auto it = m_dirtyPSRegistersF.begin();
-
-		if (it != m_dirtyPSRegistersF.end()) {
-
-			int startReg = *it; // can't dererefence this if it might be end
-			int lastReg = startReg;
-
-			while (it != m_dirtyPSRegistersF.end()) {
-
-
-				auto itNext = std::next(it);
-				if ((itNext != m_dirtyPSRegistersF.end()) && (*itNext == lastReg + 1)) {
-					// skip through until we reach the end of a continuous series of dirty registers
-					lastReg = *itNext;
-				}
-				else {
-					// set this series of registers
-					m_pActualDevice->SetPixelShaderConstantF(startReg, &m_psRegistersF[RegisterIndex(startReg)], lastReg - startReg + 1);
+	// integer and boolean registers (never stereo)
+	ApplyDirtyIntBool();
+}
 
-					// If there are more dirty registers left the next register will be the new startReg
-					if (itNext != m_dirtyPSRegistersF.end()) {
-						startReg = *itNext;
-						lastReg = startReg;
-					}
-				}
+/**
+* Applies all dirty float registers, including those left dirty by ApplyAllDirty() since the active
+* shaders do not read them.
+* To be called before the actual device state is captured (state blocks), the actual device has to
+* hold all registers then.
+* @param currentSide Left or Right side.
+***/
+void ShaderRegisters::ApplyAllDeferred(vireio::RenderPosition currentSide)
+{
+	MarkStaleStereoConstantsDirty();
 
-				++it;
-			}
-		}
+	if (m_dirtyVSRegistersF.Any())
+		ApplyDirtyMerged(m_pActiveVertexShader ? m_pActiveVertexShader->ModifiedConstants() : NULL, &m_vsRegistersF[0], m_dirtyVSRegistersF, currentSide, &ShaderRegisters::UploadVS, false);
 
-		m_dirtyPSRegistersF.clear();
-	}
+	if (m_dirtyPSRegistersF.Any())
+		ApplyDirtyMerged(m_pActivePixelShader ? m_pActivePixelShader->ModifiedConstants() : NULL, &m_psRegistersF[0], m_dirtyPSRegistersF, currentSide, &ShaderRegisters::UploadPS, false);
 }
 
 /**
 * This will apply all (vertex and pixel shader) StereoShaderConstants to the device (updating dirty ones before applying them).
 * @param currentSide Left or Right side.
+* @param skipEqualEyes True on side changes : clean constants with equal left and right data are already on the device.
+***/
+void ShaderRegisters::ApplyAllStereoConstants(vireio::RenderPosition currentSide, const bool skipEqualEyes)
+{
+	MarkStaleStereoConstantsDirty();
+
+	ApplyStereoConstantsVS(currentSide, false, skipEqualEyes);
+	ApplyStereoConstantsPS(currentSide, false, skipEqualEyes);
+}
+
+/**
+* Uploads the right data of the active vertex shader stereo constants to the registers the instanced
+* stereo copy of the shader reads them from. These registers are marked dirty, so other shaders get
+* the game data back. To be called after ApplyAllDirty(vireio::Left), the constants are up to date then.
+* @param rightRegisters Right start register of each stereo constant (StereoShaderPatcher::NO_REGISTER if not read).
+* @see D3D9ProxyVertexShader::InstancedStereoRightRegisters()
 ***/
-void ShaderRegisters::ApplyAllStereoConstants(vireio::RenderPosition currentSide)
+void ShaderRegisters::ApplyInstancedStereoConstants(const std::vector<uint32_t>& rightRegisters)
 {
-	ApplyStereoConstantsVS(currentSide, false);
-	ApplyStereoConstantsPS(currentSide, false);
+	if (!m_pActiveVertexShader)
+		return;
+
+	StereoConstantTable* pConstants = m_pActiveVertexShader->ModifiedConstants();
+	for (UINT i = 0; (i < pConstants->Size()) && (i < rightRegisters.size()); i++) {
+		if (rightRegisters[i] == StereoShaderPatcher::NO_REGISTER)
+			continue;
+
+		UploadVS(rightRegisters[i], pConstants->Constant(i).DataRightPointer(), pConstants->Count(i));
+		m_dirtyVSRegistersF.Mark(rightRegisters[i], pConstants->Count(i));
+	}
 }
 
 /**
@@ -467,41 +625,8 @@ void ShaderRegisters::ActiveVertexShaderChanged(D3D9ProxyVertexShader* pNewVerte
 	if (m_pActiveVertexShader == pNewVertexShader)
 		return;
 
-	if (pNewVertexShader) {
-
-		std::map<UINT, StereoShaderConstant<float>>* pNewShaderModConstants = pNewVertexShader->ModifiedConstants();
-
-		std::map<UINT, StereoShaderConstant<float>>* pOldShaderModConstants = NULL;
-		if (m_pActiveVertexShader)
-			pOldShaderModConstants = m_pActiveVertexShader->ModifiedConstants();
-
-		// Update the data in new shader constants with data from matching constants from last shader.
-		auto itNewConstants = pNewShaderModConstants->begin();
-		while (itNewConstants != pNewShaderModConstants->end()) {
-
-			bool mightBeDirty = true;
-
-			if (pOldShaderModConstants) {
-				// No idea if this is saving any time or if it would be better to just mark all the registers dirty 
-				// and re-apply the constants on first draw
-				if (m_pActiveVertexShader->ModifiedConstants()->count(itNewConstants->first) == 1) {
-					if (pOldShaderModConstants->at(itNewConstants->first).SameConstantAs(itNewConstants->second)) {
-						(*pNewShaderModConstants).at(itNewConstants->first) = (*pOldShaderModConstants).at(itNewConstants->first);
-						mightBeDirty = false;
-					}
-				}
-			}
-
-			// If there isn't a corresponding old modification then this modified constant will need updating
-			if (mightBeDirty) {
-				m_dirtyVSRegistersF.insert(itNewConstants->first);
-			}
-
-			++itNewConstants;
-		}
-
-
-	}
+	if (pNewVertexShader)
+		ShaderChanged(m_pActiveVertexShader ? m_pActiveVertexShader->ModifiedConstants() : NULL, pNewVertexShader->ModifiedConstants(), m_dirtyVSRegistersF, m_vsTransitions);
 
 	_SAFE_RELEASE(m_pActiveVertexShader);
 	m_pActiveVertexShader = pNewVertexShader;
@@ -519,46 +644,78 @@ void ShaderRegisters::ActivePixelShaderChanged(D3D9ProxyPixelShader* pNewPixelSh
 	if (m_pActivePixelShader == pNewPixelShader)
 		return;
 
-	if (pNewPixelShader) {
-
-		std::map<UINT, StereoShaderConstant<float>>* pNewShaderModConstants = pNewPixelShader->ModifiedConstants();
-
-		std::map<UINT, StereoShaderConstant<float>>* pOldShaderModConstants = NULL;
-		if (m_pActivePixelShader)
-			pOldShaderModConstants = m_pActivePixelShader->ModifiedConstants();
+	if (pNewPixelShader)
+		ShaderChanged(m_pActivePixelShader ? m_pActivePixelShader->ModifiedConstants() : NULL, pNewPixelShader->ModifiedConstants(), m_dirtyPSRegistersF, m_psTransitions);
 
-		// Update the data in new shader constants with data from matching constants from last shader.
-		auto itNewConstants = pNewShaderModConstants->begin();
-		while (itNewConstants != pNewShaderModConstants->end()) {
+	_SAFE_RELEASE(m_pActivePixelShader);
+	m_pActivePixelShader = pNewPixelShader;
+	if (m_pActivePixelShader)
+		m_pActivePixelShader->AddRef();
+}
 
-			bool mightBeDirty = true;
+/**
+* Sets the maximum number of clean registers bridged to merge two dirty runs into one upload.
+* Bridged registers are uploaded with the value the device already has, so a higher threshold
+* trades upload size for fewer driver calls.
+* @param registers Maximum gap in registers, 0 to upload dirty runs only.
+***/
+void ShaderRegisters::SetUploadGapThreshold(UINT registers)
+{
+	m_uploadGapThreshold = registers;
+}
 
-			if (pOldShaderModConstants) {
-				// No idea if this is saving any time or if it would be better to just mark all the registers dirty 
-				// and re-apply the constants on first draw
-				if (m_pActivePixelShader->ModifiedConstants()->count(itNewConstants->first) == 1) {
-					if (pOldShaderModConstants->at(itNewConstants->first).SameConstantAs(itNewConstants->second)) {
-						(*pNewShaderModConstants).at(itNewConstants->first) = (*pOldShaderModConstants).at(itNewConstants->first);
-						mightBeDirty = false;
-					}
-				}
-			}
+/**
+* Updates the data in new shader constants with data from matching constants from last shader.
+* Which constants match only depends on the two constant table layouts, so the result is computed
+* once per pair of layouts and cached. The cache is dropped when it grows too large (tables of
+* released shaders are never used again).
+* @param pOldConstants Stereo constants of the last shader, NULL if there was none.
+* @param pNewConstants Stereo constants of the new shader.
+* @param dirtyRegisters Dirty registers of the register file, constants without match are marked.
+* @param transitions Transition cache of the shader type.
+***/
+void ShaderRegisters::ShaderChanged(StereoConstantTable* pOldConstants, StereoConstantTable* pNewConstants, DirtyRegisters& dirtyRegisters, std::unordered_map<UINT64, ShaderTransition>& transitions)
+{
+	if (pNewConstants->Empty())
+		return;
 
-			// If there isn't a corresponding old modification then this modified constant will need updating
-			if (mightBeDirty) {
-				m_dirtyPSRegistersF.insert(itNewConstants->first);
-			}
+	// no last shader, every constant needs updating
+	if (!pOldConstants || pOldConstants->Empty()) {
+		for (UINT i = 0; i < pNewConstants->Size(); i++)
+			dirtyRegisters.Mark(pNewConstants->StartRegister(i), 1);
+		return;
+	}
 
-			++itNewConstants;
+	UINT64 key = ((UINT64)pOldConstants->Id() << 32) | pNewConstants->Id();
+	auto itTransition = transitions.find(key);
+	if (itTransition == transitions.end()) {
+		if (transitions.size() >= MAX_SHADER_TRANSITIONS)
+			transitions.clear();
+
+		ShaderTransition transition;
+		for (UINT i = 0; i < pNewConstants->Size(); i++) {
+			int oldIndex = pOldConstants->Find(pNewConstants->StartRegister(i));
+			if ((oldIndex >= 0) && pOldConstants->Constant((UINT)oldIndex).SameConstantAs(pNewConstants->Constant(i)))
+				transition.transfers.push_back(std::pair<UINT, UINT>(i, (UINT)oldIndex));
+			else
+				transition.dirtyRegisters.push_back(pNewConstants->StartRegister(i));
 		}
 
+		itTransition = transitions.insert(std::pair<UINT64, ShaderTransition>(key, transition)).first;
+	}
 
+	auto itTransfer = itTransition->second.transfers.begin();
+	while (itTransfer != itTransition->second.transfers.end()) {
+		pNewConstants->Constant(itTransfer->first).CopyDataFrom(pOldConstants->Constant(itTransfer->second));
+		++itTransfer;
 	}
 
-	_SAFE_RELEASE(m_pActivePixelShader);
-	m_pActivePixelShader = pNewPixelShader;
-	if (m_pActivePixelShader)
-		m_pActivePixelShader->AddRef();
+	// If there isn't a corresponding old modification then this modified constant will need updating
+	auto itDirty = itTransition->second.dirtyRegisters.begin();
+	while (itDirty != itTransition->second.dirtyRegisters.end()) {
+		dirtyRegisters.Mark(*itDirty, 1);
+		++itDirty;
+	}
 }
 
 /**
@@ -578,35 +735,20 @@ void ShaderRegisters::ReleaseResources()
 * This will apply all vertex StereoShaderConstants to the device (updating dirty ones before applying them).
 * @param currentSide Left or Right side.
 * @param dirtyOnly Set to true if only dirty registers are to be applied.
+* @param skipEqualEyes True to skip clean constants with equal left and right data.
 ***/
-void ShaderRegisters::ApplyStereoConstantsVS(vireio::RenderPosition currentSide, const bool dirtyOnly)
+void ShaderRegisters::ApplyStereoConstantsVS(vireio::RenderPosition currentSide, const bool dirtyOnly, const bool skipEqualEyes)
 {
 	if (!m_pActiveVertexShader)
 		return;
 
-	auto itStereoConstant = m_pActiveVertexShader->ModifiedConstants()->begin();
-	while (itStereoConstant != m_pActiveVertexShader->ModifiedConstants()->end()) {
-
-		// if any of the registers that make up this constant are dirty update before setting
-		if ( AnyDirtyVS(itStereoConstant->second.StartRegister(), itStereoConstant->second.Count())) { // Should we do this or make this method just switch sides without checking for updated data? 
-
-			itStereoConstant->second.Update(&m_vsRegistersF[RegisterIndex(itStereoConstant->second.StartRegister())]);
-
-			if (dirtyOnly) {
-				// Apply this dirty constant to device
-				m_pActualDevice->SetVertexShaderConstantF(itStereoConstant->second.StartRegister(), (currentSide == vireio::Left) ? itStereoConstant->second.DataLeftPointer() : itStereoConstant->second.DataRightPointer(), itStereoConstant->second.Count());
-			}
-
-			// These registers are no longer dirty
-			for (UINT i = itStereoConstant->second.StartRegister(); i < itStereoConstant->second.StartRegister() + itStereoConstant->second.Count(); i++)
-				m_dirtyVSRegistersF.erase(i);
-		}
-
-		if (!dirtyOnly) {
-			// Apply this constant to device
-			m_pActualDevice->SetVertexShaderConstantF(itStereoConstant->second.StartRegister(), (currentSide == vireio::Left) ? itStereoConstant->second.DataLeftPointer() : itStereoConstant->second.DataRightPointer(), itStereoConstant->second.Count());
-		}
+	// update all dirty constants of the shader in one batch
+	UpdateStereoConstants(m_pActiveVertexShader->ModifiedConstants(), &m_vsRegistersF[0], m_dirtyVSRegistersF, dirtyOnly, skipEqualEyes);
 
+	// Apply the updated (or all) constants to device
+	auto itStereoConstant = m_stereoConstantBatch.begin();
+	while (itStereoConstant != m_stereoConstantBatch.end()) {
+		UploadVS((*itStereoConstant)->StartRegister(), (currentSide == vireio::Left) ? (*itStereoConstant)->DataLeftPointer() : (*itStereoConstant)->DataRightPointer(), (*itStereoConstant)->Count());
 		++itStereoConstant;
 	}
 }
@@ -615,35 +757,20 @@ void ShaderRegisters::ApplyStereoConstantsVS(vireio::RenderPosition currentSide,
 * This will apply all pixel StereoShaderConstants to the device (updating dirty ones before applying them).
 * @param currentSide Left or Right side.
 * @param dirtyOnly Set to true if only dirty registers are to be applied.
+* @param skipEqualEyes True to skip clean constants with equal left and right data.
 ***/
-void ShaderRegisters::ApplyStereoConstantsPS(vireio::RenderPosition currentSide, const bool dirtyOnly)
+void ShaderRegisters::ApplyStereoConstantsPS(vireio::RenderPosition currentSide, const bool dirtyOnly, const bool skipEqualEyes)
 {
 	if (!m_pActivePixelShader)
 		return;
 
-	auto itStereoConstant = m_pActivePixelShader->ModifiedConstants()->begin();
-	while (itStereoConstant != m_pActivePixelShader->ModifiedConstants()->end()) {
-
-		// if any of the registers that make up this constant are dirty update before setting
-		if ( AnyDirtyPS(itStereoConstant->second.StartRegister(), itStereoConstant->second.Count())) { // Should we do this or make this method just switch sides without checking for updated data? 
-
-			itStereoConstant->second.Update(&m_psRegistersF[RegisterIndex(itStereoConstant->second.StartRegister())]);
-
-			if (dirtyOnly) {
-				// Apply this dirty constant to device
-				m_pActualDevice->SetPixelShaderConstantF(itStereoConstant->second.StartRegister(), (currentSide == vireio::Left) ? itStereoConstant->second.DataLeftPointer() : itStereoConstant->second.DataRightPointer(), itStereoConstant->second.Count());
-			}
-
-			// These registers are no longer dirty
-			for (UINT i = itStereoConstant->second.StartRegister(); i < itStereoConstant->second.StartRegister() + itStereoConstant->second.Count(); i++)
-				m_dirtyPSRegistersF.erase(i);
-		}
-
-		if (!dirtyOnly) {
-			// Apply this constant to device
-			m_pActualDevice->SetPixelShaderConstantF(itStereoConstant->second.StartRegister(), (currentSide == vireio::Left) ? itStereoConstant->second.DataLeftPointer() : itStereoConstant->second.DataRightPointer(), itStereoConstant->second.Count());
-		}
+	// update all dirty constants of the shader in one batch
+	UpdateStereoConstants(m_pActivePixelShader->ModifiedConstants(), &m_psRegistersF[0], m_dirtyPSRegistersF, dirtyOnly, skipEqualEyes);
 
+	// Apply the updated (or all) constants to device
+	auto itStereoConstant = m_stereoConstantBatch.begin();
+	while (itStereoConstant != m_stereoConstantBatch.end()) {
+		UploadPS((*itStereoConstant)->StartRegister(), (currentSide == vireio::Left) ? (*itStereoConstant)->DataLeftPointer() : (*itStereoConstant)->DataRightPointer(), (*itStereoConstant)->Count());
 		++itStereoConstant;
 	}
 }
@@ -656,12 +783,9 @@ void ShaderRegisters::MarkAllVSStereoConstantsDirty()
 	// vertex shader
 	if (m_pActiveVertexShader) {
 		// Mark all StereoShaderConstants dirty so they are updated before drawing
-		auto itStereoConstant = m_pActiveVertexShader->ModifiedConstants()->begin();
-		while (itStereoConstant != m_pActiveVertexShader->ModifiedConstants()->end()) {
-
-			m_dirtyVSRegistersF.insert(itStereoConstant->first);
-			++itStereoConstant;
-		}
+		StereoConstantTable* pConstants = m_pActiveVertexShader->ModifiedConstants();
+		for (UINT i = 0; i < pConstants->Size(); i++)
+			m_dirtyVSRegistersF.Mark(pConstants->StartRegister(i), 1);
 	}
 }
 
@@ -673,11 +797,337 @@ void ShaderRegisters::MarkAllPSStereoConstantsDirty()
 	// pixel shader
 	if (m_pActivePixelShader) {
 		// Mark all StereoShaderConstants dirty so they are updated before drawing
-		auto itStereoConstant = m_pActivePixelShader->ModifiedConstants()->begin();
-		while (itStereoConstant != m_pActivePixelShader->ModifiedConstants()->end()) {
+		StereoConstantTable* pConstants = m_pActivePixelShader->ModifiedConstants();
+		for (UINT i = 0; i < pConstants->Size(); i++)
+			m_dirtyPSRegistersF.Mark(pConstants->StartRegister(i), 1);
+	}
+}
+
+/**
+* Marks the stereo constants of the active shaders dirty if the view adjustment changed since the last
+* call (roll, separation, ...). Unchanged register writes are not marked dirty, without this the
+* constants would keep the data of the old adjustment until the game writes new values.
+* Constants of inactive shaders get the current data when they become active (ShaderChanged()).
+***/
+void ShaderRegisters::MarkStaleStereoConstantsDirty()
+{
+	UINT adjustmentGeneration = m_spAdjustment->Generation();
+	if (adjustmentGeneration == m_adjustmentGeneration)
+		return;
+
+	MarkAllVSStereoConstantsDirty();
+	MarkAllPSStereoConstantsDirty();
+	m_adjustmentGeneration = adjustmentGeneration;
+}
+
+/**
+* Sets vertex shader constant registers on the actual device, counts the upload.
+* @param StartRegister First register.
+* @param pConstantData Register data.
+* @param Vector4fCount Number of registers.
+***/
+void ShaderRegisters::UploadVS(UINT StartRegister, const float* pConstantData, UINT Vector4fCount)
+{
+	m_pCounters->vsConstantUploads++;
+	m_pCounters->vsConstantFloats += Vector4fCount * VECTOR_LENGTH;
 
-			m_dirtyPSRegistersF.insert(itStereoConstant->first);
+	m_pActualDevice->SetVertexShaderConstantF(StartRegister, pConstantData, Vector4fCount);
+}
+
+/**
+* Sets pixel shader constant registers on the actual device, counts the upload.
+* @param StartRegister First register.
+* @param pConstantData Register data.
+* @param Vector4fCount Number of registers.
+***/
+void ShaderRegisters::UploadPS(UINT StartRegister, const float* pConstantData, UINT Vector4fCount)
+{
+	m_pCounters->psConstantUploads++;
+	m_pCounters->psConstantFloats += Vector4fCount * VECTOR_LENGTH;
+
+	m_pActualDevice->SetPixelShaderConstantF(StartRegister, pConstantData, Vector4fCount);
+}
+
+/**
+* Copies constant data to proxy registers and marks the registers that actually changed dirty.
+* Registers are compared bitwise, one register (4 floats) per SSE2 compare. Registers set to the
+* value they already have stay clean, so neither the upload nor a stereo constant update is triggered.
+* @param pRegisters Proxy register file (VS or PS).
+* @param pConstantData New register data.
+* @param StartRegister First register.
+* @param Vector4fCount Number of registers.
+* @param dirtyRegisters Dirty registers of the register file.
+* @param registerPages Snapshot pages of the register file.
+* @return Number of registers that did not change.
+***/
+UINT ShaderRegisters::CopyChangedRegisters(float* pRegisters, const float* pConstantData, UINT StartRegister, UINT Vector4fCount, DirtyRegisters& dirtyRegisters, RegisterPages& registerPages)
+{
+	float* pTarget = pRegisters + RegisterIndex(StartRegister);
+	UINT unchanged = 0;
+	UINT runStart = 0;
+	UINT runCount = 0;
+
+	for (UINT i = 0; i < Vector4fCount; i++) {
+		__m128i oldRegister = _mm_loadu_si128((const __m128i*)(pTarget + i * VECTOR_LENGTH));
+		__m128i newRegister = _mm_loadu_si128((const __m128i*)(pConstantData + i * VECTOR_LENGTH));
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(oldRegister, newRegister)) == 0xFFFF) {
+			unchanged++;
+
+			// end of a series of changed registers
+			if (runCount) {
+				dirtyRegisters.Mark(StartRegister + runStart, runCount);
+				registerPages.Written(StartRegister + runStart, runCount);
+				runCount = 0;
+			}
+		}
+		else {
+			_mm_storeu_si128((__m128i*)(pTarget + i * VECTOR_LENGTH), newRegister);
+
+			if (!runCount)
+				runStart = i;
+			runCount++;
+		}
+	}
+
+	if (runCount) {
+		dirtyRegisters.Mark(StartRegister + runStart, runCount);
+		registerPages.Written(StartRegister + runStart, runCount);
+	}
+
+	return unchanged;
+}
+
+/**
+* Applies all dirty integer and boolean registers to the actual device, one upload per continuous
+* series of dirty registers.
+***/
+void ShaderRegisters::ApplyDirtyIntBool()
+{
+	UINT startReg;
+	UINT count;
+
+	if (m_dirtyVSRegistersI.Any()) {
+		startReg = 0;
+		while (m_dirtyVSRegistersI.NextRun(&startReg, &count)) {
+			m_pCounters->intBoolConstantUploads++;
+			m_pActualDevice->SetVertexShaderConstantI(startReg, &m_vsRegistersI[RegisterIndex(startReg)], count);
+			startReg += count;
+		}
+		m_dirtyVSRegistersI.Clear();
+	}
+
+	if (m_dirtyVSRegistersB.Any()) {
+		startReg = 0;
+		while (m_dirtyVSRegistersB.NextRun(&startReg, &count)) {
+			m_pCounters->intBoolConstantUploads++;
+			m_pActualDevice->SetVertexShaderConstantB(startReg, &m_vsRegistersB[startReg], count);
+			startReg += count;
+		}
+		m_dirtyVSRegistersB.Clear();
+	}
+
+	if (m_dirtyPSRegistersI.Any()) {
+		startReg = 0;
+		while (m_dirtyPSRegistersI.NextRun(&startReg, &count)) {
+			m_pCounters->intBoolConstantUploads++;
+			m_pActualDevice->SetPixelShaderConstantI(startReg, &m_psRegistersI[RegisterIndex(startReg)], count);
+			startReg += count;
+		}
+		m_dirtyPSRegistersI.Clear();
+	}
+
+	if (m_dirtyPSRegistersB.Any()) {
+		startReg = 0;
+		while (m_dirtyPSRegistersB.NextRun(&startReg, &count)) {
+			m_pCounters->intBoolConstantUploads++;
+			m_pActualDevice->SetPixelShaderConstantB(startReg, &m_psRegistersB[startReg], count);
+			startReg += count;
+		}
+		m_dirtyPSRegistersB.Clear();
+	}
+}
+
+/**
+* Copies integer or boolean register data to proxy registers and marks the registers that actually
+* changed dirty.
+* @param pRegisters Proxy register file.
+* @param pData New register data.
+* @param StartRegister First register.
+* @param count Number of registers.
+* @param registerSize Size of one register in bytes.
+* @param dirtyRegisters Dirty registers of the register file.
+* @return Number of registers that did not change.
+***/
+UINT ShaderRegisters::CopyChangedValues(void* pRegisters, const void* pData, UINT StartRegister, UINT count, UINT registerSize, DirtyRegisters& dirtyRegisters)
+{
+	BYTE* pTarget = (BYTE*)pRegisters + StartRegister * registerSize;
+	const BYTE* pSource = (const BYTE*)pData;
+	UINT unchanged = 0;
+
+	for (UINT i = 0; i < count; i++) {
+		if (memcmp(pTarget, pSource, registerSize) == 0) {
+			unchanged++;
+		}
+		else {
+			memcpy(pTarget, pSource, registerSize);
+			dirtyRegisters.Mark(StartRegister + i, 1);
+		}
+
+		pTarget += registerSize;
+		pSource += registerSize;
+	}
+
+	return unchanged;
+}
+
+/**
+* Returns true if a register range lies within a register file.
+* The count is compared to the registers left after the start, so a huge count can not wrap the
+* end of the range around and pass the check.
+* @param StartRegister First register.
+* @param count Number of registers.
+* @param registerCount Number of registers in the register file.
+***/
+bool ShaderRegisters::InRange(UINT StartRegister, UINT count, UINT registerCount)
+{
+	return (StartRegister < registerCount) && (count <= registerCount - StartRegister);
+}
+
+/**
+* Applies all dirty registers of one register file, stereo and mono alike.
+* Dirty stereo constants are updated and marked dirty again as a whole, so the dirty runs cover the
+* stereo registers as well. Runs separated by at most m_uploadGapThreshold clean registers are merged,
+* every merged run is staged for the current side and applied with a single upload.
+* If only used registers are applied, runs are restricted to the registers the active shader reads
+* (stereo constants always are), all other dirty registers stay dirty.
+* @param pConstants Stereo constants of the active shader, NULL if no shader is active.
+* @param pRegisters Proxy register file (VS or PS).
+* @param dirtyRegisters Dirty registers of the register file, applied registers are marked clean.
+* @param currentSide Left or Right side.
+* @param upload UploadVS() or UploadPS().
+* @param usedOnly True to apply only registers read by the active shader (if known).
+***/
+void ShaderRegisters::ApplyDirtyMerged(StereoConstantTable* pConstants, const float* pRegisters, DirtyRegisters& dirtyRegisters, vireio::RenderPosition currentSide, UploadMethod upload, const bool usedOnly)
+{
+	const std::vector<DWORD>* pUsedRegisters = (usedOnly && pConstants) ? pConstants->UsedRegisters() : NULL;
+
+	if (pConstants) {
+		UpdateStereoConstants(pConstants, pRegisters, dirtyRegisters, true, false);
+
+		auto itStereoConstant = m_stereoConstantBatch.begin();
+		while (itStereoConstant != m_stereoConstantBatch.end()) {
+			dirtyRegisters.Mark((*itStereoConstant)->StartRegister(), (*itStereoConstant)->Count());
 			++itStereoConstant;
 		}
 	}
+
+	UINT constantCursor = 0;
+	UINT start = 0;
+	UINT count;
+	bool more = dirtyRegisters.NextRun(&start, &count, pUsedRegisters);
+	while (more) {
+		UINT end = start + count;
+
+		// bridge small gaps to the following runs
+		UINT next = end;
+		UINT nextCount;
+		while ((more = dirtyRegisters.NextRun(&next, &nextCount, pUsedRegisters)) && (next - end <= m_uploadGapThreshold)) {
+			end = next + nextCount;
+			next = end;
+		}
+
+		(this->*upload)(start, StageRegisters(pConstants, pRegisters, start, end - start, currentSide, &constantCursor), end - start);
+
+		// bridged gap registers were uploaded as well, whether dirty or not
+		if (pUsedRegisters)
+			dirtyRegisters.Unmark(start, end - start);
+
+		start = next;
+		count = nextCount;
+	}
+
+	if (!pUsedRegisters)
+		dirtyRegisters.Clear();
+}
+
+/**
+* Returns the data of a register range for the current side.
+* If no stereo constant overlaps the range the register file itself is returned, otherwise the range
+* is copied to the staging image and the overlapping stereo constants are laid over it.
+* @param pConstants Stereo constants of the active shader, NULL if no shader is active.
+* @param pRegisters Proxy register file (VS or PS).
+* @param start First register.
+* @param count Register count.
+* @param currentSide Left or Right side.
+* @param pConstantCursor [in, out] First constant that may overlap, ranges must be staged in ascending order.
+***/
+const float* ShaderRegisters::StageRegisters(StereoConstantTable* pConstants, const float* pRegisters, UINT start, UINT count, vireio::RenderPosition currentSide, UINT* pConstantCursor)
+{
+	UINT end = start + count;
+
+	// skip constants ending before the range
+	UINT i = *pConstantCursor;
+	while (pConstants && (i < pConstants->Size()) && (pConstants->StartRegister(i) + pConstants->Count(i) <= start))
+		i++;
+	*pConstantCursor = i;
+
+	if (!pConstants || (i >= pConstants->Size()) || (pConstants->StartRegister(i) >= end))
+		return pRegisters + RegisterIndex(start);
+
+	float* pStaging = &m_stagingRegistersF[0];
+	memcpy(pStaging + RegisterIndex(start), pRegisters + RegisterIndex(start), RegisterIndex(count) * sizeof(float));
+
+	for (; (i < pConstants->Size()) && (pConstants->StartRegister(i) < end); i++) {
+		UINT constantStart = pConstants->StartRegister(i);
+		UINT first = max(start, constantStart);
+		UINT last = min(end, constantStart + pConstants->Count(i));
+		if (first >= last)
+			continue;
+
+		StereoShaderConstant<float>& constant = pConstants->Constant(i);
+		const float* pData = (currentSide == vireio::Left) ? constant.DataLeftPointer() : constant.DataRightPointer();
+		memcpy(pStaging + RegisterIndex(first), pData + RegisterIndex((first - constantStart)), RegisterIndex((last - first)) * sizeof(float));
+	}
+
+	return pStaging + RegisterIndex(start);
+}
+
+/**
+* Batched stereo constant update, updates all dirty stereo constants of a shader in one pass.
+* The constants to be applied to the device are collected in the constant batch.
+* @param pConstants Stereo constants of the active shader.
+* @param pRegisters Proxy register file (VS or PS).
+* @param dirtyRegisters Dirty registers of the register file, updated constants are marked clean.
+* @param dirtyOnly True if only updated (dirty) constants are to be applied, false to apply all.
+* @param skipEqualEyes True to leave out clean constants with equal left and right data (the device
+* already holds their data, whatever the side).
+***/
+void ShaderRegisters::UpdateStereoConstants(StereoConstantTable* pConstants, const float* pRegisters, DirtyRegisters& dirtyRegisters, const bool dirtyOnly, const bool skipEqualEyes)
+{
+	m_stereoConstantBatch.clear();
+
+	for (UINT i = 0; i < pConstants->Size(); i++) {
+		UINT startRegister = pConstants->StartRegister(i);
+		UINT count = pConstants->Count(i);
+
+		// if any of the registers that make up this constant are dirty update before setting
+		if (dirtyRegisters.AnyInRange(startRegister, count)) {
+			StereoShaderConstant<float>* pConstant = &pConstants->Constant(i);
+
+			if (pConstant->Update(pRegisters + RegisterIndex(startRegister)))
+				m_pCounters->stereoConstantUpdates++;
+
+			// These registers are no longer dirty
+			dirtyRegisters.Unmark(startRegister, count);
+
+			m_stereoConstantBatch.push_back(pConstant);
+		}
+		else if (!dirtyOnly) {
+			if (skipEqualEyes && pConstants->Constant(i).EyesEqual())
+				m_pCounters->stereoUploadsSkipped++;
+			else
+				m_stereoConstantBatch.push_back(&pConstants->Constant(i));
+		}
+	}
 }
\ No newline at end of file
@@ -32,20 +32,36 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define VECTOR_LENGTH 4
 #define RegisterIndex(x) (x * VECTOR_LENGTH)
+#define MAX_CONSTANT_REGISTERS_I 16
+#define MAX_CONSTANT_REGISTERS_B 16
+#define MAX_SHADER_TRANSITIONS 1024
 
 #include "d3d9.h"
 #include "d3dx9.h"
 #include <vector>
-#include <set>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 #include "D3D9ProxyPixelShader.h"
 #include "D3D9ProxyVertexShader.h"
 #include "Vireio.h"
+#include "ProxyCounters.h"
+#include "ProxyProfiler.h"
+#include "DirtyRegisters.h"
+#include "RegisterPages.h"
+#include "ViewAdjustment.h"
 
 class D3D9ProxyVertexShader;
 class D3D9ProxyPixelShader;
 
+/**
+* One integer shader constant register.
+***/
+struct IntRegister
+{
+	int data[VECTOR_LENGTH];
+};
+
 /**
 * Managed shader register class.
 * All shader registers stored, updated and applied to device here. 
@@ -54,7 +70,7 @@ class D3D9ProxyPixelShader;
 class ShaderRegisters
 {
 public:
-	ShaderRegisters(DWORD maxPSConstantRegistersF, DWORD maxVSConstantRegistersF, IDirect3DDevice9* pActualDevice);
+	ShaderRegisters(DWORD maxPSConstantRegistersF, DWORD maxVSConstantRegistersF, IDirect3DDevice9* pActualDevice, ProxyCounterValues* pCounters, std::shared_ptr<ViewAdjustment> spAdjustment);
 	virtual ~ShaderRegisters();
 
 	/*** ShaderRegisters public methods ***/
@@ -62,26 +78,65 @@ public:
 	HRESULT WINAPI     GetVertexShaderConstantF(UINT StartRegister, float* pConstantData, UINT Vector4fCount);
 	HRESULT WINAPI     SetPixelShaderConstantF(UINT StartRegister, const float* pConstantData, UINT Vector4fCount);
 	HRESULT WINAPI     GetPixelShaderConstantF(UINT StartRegister, float* pConstantData, UINT Vector4fCount);
+	HRESULT WINAPI     SetVertexShaderConstantI(UINT StartRegister, const int* pConstantData, UINT Vector4iCount);
+	HRESULT WINAPI     GetVertexShaderConstantI(UINT StartRegister, int* pConstantData, UINT Vector4iCount);
+	HRESULT WINAPI     SetVertexShaderConstantB(UINT StartRegister, const BOOL* pConstantData, UINT BoolCount);
+	HRESULT WINAPI     GetVertexShaderConstantB(UINT StartRegister, BOOL* pConstantData, UINT BoolCount);
+	HRESULT WINAPI     SetPixelShaderConstantI(UINT StartRegister, const int* pConstantData, UINT Vector4iCount);
+	HRESULT WINAPI     GetPixelShaderConstantI(UINT StartRegister, int* pConstantData, UINT Vector4iCount);
+	HRESULT WINAPI     SetPixelShaderConstantB(UINT StartRegister, const BOOL* pConstantData, UINT BoolCount);
+	HRESULT WINAPI     GetPixelShaderConstantB(UINT StartRegister, BOOL* pConstantData, UINT BoolCount);
 	std::vector<float> GetAllVSConstantRegistersF();
 	std::vector<float> GetAllPSConstantRegistersF();	
+	RegisterSnapshot   CaptureVSConstantRegistersF();
+	RegisterSnapshot   CapturePSConstantRegistersF();
 	void               SetFromStateBlockVertexShader(D3D9ProxyVertexShader* storedVShader);
 	void               SetFromStateBlockPixelShader(D3D9ProxyPixelShader* storedPShader);
 	void               SetFromStateBlockData(std::map<UINT, D3DXVECTOR4> * storedVSRegisters, std::map<UINT, D3DXVECTOR4> * storedPSRegisters);
-	void               SetFromStateBlockData(std::vector<float> * storedVSRegisters, std::vector<float> * storedPSRegisters);
+	void               SetFromStateBlockData(RegisterSnapshot * storedVSRegisters, RegisterSnapshot * storedPSRegisters);
+	void               SetFromStateBlockData(std::map<UINT, IntRegister>* storedRegistersI, std::map<UINT, BOOL>* storedRegistersB, bool vertexShader);
 	bool               AnyDirtyVS(UINT start, UINT count);
 	bool               AnyDirtyPS(UINT start, UINT count);
 	void               ApplyAllDirty(vireio::RenderPosition currentSide);
-	void               ApplyAllStereoConstants(vireio::RenderPosition currentSide);
+	void               ApplyAllDeferred(vireio::RenderPosition currentSide);
+	void               ApplyAllStereoConstants(vireio::RenderPosition currentSide, const bool skipEqualEyes = true);
+	void               ApplyInstancedStereoConstants(const std::vector<uint32_t>& rightRegisters);
 	void               ActiveVertexShaderChanged(D3D9ProxyVertexShader* pNewVertexShader);
 	void               ActivePixelShaderChanged(D3D9ProxyPixelShader* pNewPixelShader);
+	void               SetUploadGapThreshold(UINT registers);
 	void               ReleaseResources();
 
 private:
+	/**
+	* Upload method, UploadVS() or UploadPS().
+	***/
+	typedef void (ShaderRegisters::*UploadMethod)(UINT StartRegister, const float* pConstantData, UINT Vector4fCount);
+
+	/**
+	* Precomputed transition between the stereo constants of two shaders.
+	***/
+	struct ShaderTransition
+	{
+		std::vector<std::pair<UINT, UINT>> transfers;      /**< <new constant index, old constant index> of constants that keep their data. */
+		std::vector<UINT>                  dirtyRegisters; /**< Start registers of the new constants that need an update. */
+	};
+
 	/*** ShaderRegisters private methods ***/
-	void ApplyStereoConstantsVS(vireio::RenderPosition currentSide, const bool dirtyOnly);	
-	void ApplyStereoConstantsPS(vireio::RenderPosition currentSide, const bool dirtyOnly);
+	void ShaderChanged(StereoConstantTable* pOldConstants, StereoConstantTable* pNewConstants, DirtyRegisters& dirtyRegisters, std::unordered_map<UINT64, ShaderTransition>& transitions);
+	void ApplyDirtyMerged(StereoConstantTable* pConstants, const float* pRegisters, DirtyRegisters& dirtyRegisters, vireio::RenderPosition currentSide, UploadMethod upload, const bool usedOnly);
+	const float* StageRegisters(StereoConstantTable* pConstants, const float* pRegisters, UINT start, UINT count, vireio::RenderPosition currentSide, UINT* pConstantCursor);
+	void ApplyStereoConstantsVS(vireio::RenderPosition currentSide, const bool dirtyOnly, const bool skipEqualEyes);	
+	void ApplyStereoConstantsPS(vireio::RenderPosition currentSide, const bool dirtyOnly, const bool skipEqualEyes);
 	void MarkAllVSStereoConstantsDirty();
 	void MarkAllPSStereoConstantsDirty();
+	void MarkStaleStereoConstantsDirty();
+	void UploadVS(UINT StartRegister, const float* pConstantData, UINT Vector4fCount);
+	void UploadPS(UINT StartRegister, const float* pConstantData, UINT Vector4fCount);
+	void UpdateStereoConstants(StereoConstantTable* pConstants, const float* pRegisters, DirtyRegisters& dirtyRegisters, const bool dirtyOnly, const bool skipEqualEyes);
+	void ApplyDirtyIntBool();
+	static UINT CopyChangedValues(void* pRegisters, const void* pData, UINT StartRegister, UINT count, UINT registerSize, DirtyRegisters& dirtyRegisters);
+	static UINT CopyChangedRegisters(float* pRegisters, const float* pConstantData, UINT StartRegister, UINT Vector4fCount, DirtyRegisters& dirtyRegisters, RegisterPages& registerPages);
+	static bool InRange(UINT StartRegister, UINT count, UINT registerCount);
 
 	/**
 	* Currently active vertex shader.
@@ -105,7 +160,11 @@ private:
 	* Vertex Shader dirty registers. 
 	* Nothing that this is Registers and NOT indexes of all floats that make up a register.
 	***/
-	std::set<UINT> m_dirtyVSRegistersF;
+	DirtyRegisters m_dirtyVSRegistersF;
+	/**
+	* Vertex Shader register snapshot pages, for state blocks.
+	***/
+	RegisterPages m_vsRegisterPagesF;
 	/**
 	* Currently active pixel shader.
 	* <StartRegister, ModifiedConstant starting at start register>
@@ -128,10 +187,83 @@ private:
 	* Pixel Shader dirty registers. 
 	* Nothing that this is Registers and NOT indexes of all floats that make up a register.
 	***/
-	std::set<UINT> m_dirtyPSRegistersF;
+	DirtyRegisters m_dirtyPSRegistersF;
+	/**
+	* Pixel Shader register snapshot pages, for state blocks.
+	***/
+	RegisterPages m_psRegisterPagesF;
+	/**
+	* Vertex Shader integer registers, VECTOR_LENGTH ints per register.
+	***/
+	std::vector<int> m_vsRegistersI;
+	/**
+	* Vertex Shader boolean registers.
+	***/
+	std::vector<BOOL> m_vsRegistersB;
+	/**
+	* Pixel Shader integer registers, VECTOR_LENGTH ints per register.
+	***/
+	std::vector<int> m_psRegistersI;
+	/**
+	* Pixel Shader boolean registers.
+	***/
+	std::vector<BOOL> m_psRegistersB;
+	/**
+	* Vertex Shader dirty integer registers.
+	***/
+	DirtyRegisters m_dirtyVSRegistersI;
+	/**
+	* Vertex Shader dirty boolean registers.
+	***/
+	DirtyRegisters m_dirtyVSRegistersB;
+	/**
+	* Pixel Shader dirty integer registers.
+	***/
+	DirtyRegisters m_dirtyPSRegistersI;
+	/**
+	* Pixel Shader dirty boolean registers.
+	***/
+	DirtyRegisters m_dirtyPSRegistersB;
+	/**
+	* Stereo constants to be applied to the device, collected by UpdateStereoConstants().
+	***/
+	std::vector<StereoShaderConstant<float>*> m_stereoConstantBatch;
+	/**
+	* Staging register image of the current eye, mono registers with the stereo constants of the
+	* current side laid over them. Indexed like the register files, sized for the larger one.
+	***/
+	std::vector<float> m_stagingRegistersF;
+	/**
+	* Vertex shader transitions.
+	* <old constant table id in high DWORD, new constant table id in low DWORD, transition>
+	***/
+	std::unordered_map<UINT64, ShaderTransition> m_vsTransitions;
+	/**
+	* Pixel shader transitions.
+	* <old constant table id in high DWORD, new constant table id in low DWORD, transition>
+	***/
+	std::unordered_map<UINT64, ShaderTransition> m_psTransitions;
+	/**
+	* Maximum number of clean registers between two dirty runs that are uploaded along with them,
+	* to merge both runs into one upload.
+	***/
+	UINT m_uploadGapThreshold;
 	/**
 	* Actual Direct3D Device pointer embedded. 
 	***/
 	IDirect3DDevice9* m_pActualDevice;
+	/**
+	* Frame counters of the owning proxy device.
+	***/
+	ProxyCounterValues* m_pCounters;
+	/**
+	* View adjustment the stereo constant modifications compute with.
+	***/
+	std::shared_ptr<ViewAdjustment> m_spAdjustment;
+	/**
+	* View adjustment generation the stereo constants were last marked dirty for.
+	* @see MarkStaleStereoConstantsDirty()
+	***/
+	UINT m_adjustmentGeneration;
 };
 #endif
\ No newline at end of file
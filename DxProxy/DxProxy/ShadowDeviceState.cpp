@@ -0,0 +1,358 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ShadowDeviceState.cpp> and
+Class <ShadowDeviceState> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ShadowDeviceState.h"
+
+/**
+* Constructor, all states invalid.
+***/
+ShadowDeviceState::ShadowDeviceState() :
+	m_bRecordingStateBlock(false),
+	m_frameFilteredCalls(0),
+	m_lastFrameFilteredCalls(0)
+{
+	Invalidate();
+}
+
+/**
+* Empty destructor.
+***/
+ShadowDeviceState::~ShadowDeviceState()
+{
+}
+
+/**
+* True if the render target is already set for that index.
+* Render target 0 is never filtered : setting it resets viewport and scissor rect on the actual 
+* device, the application expects this to happen even if the render target doesn't change.
+***/
+bool ShadowDeviceState::FilterRenderTarget(DWORD renderTargetIndex, IDirect3DSurface9* pRenderTarget)
+{
+	if ((renderTargetIndex == 0) || (renderTargetIndex >= SHADOW_RENDER_TARGETS))
+		return false;
+
+	return Filtered(m_validRenderTargets[renderTargetIndex] && (m_pRenderTargets[renderTargetIndex] == pRenderTarget));
+}
+
+/**
+* Stores the render target successfully set.
+* Any render target set resets the viewport.
+***/
+void ShadowDeviceState::StoreRenderTarget(DWORD renderTargetIndex, IDirect3DSurface9* pRenderTarget)
+{
+	if (m_bRecordingStateBlock || (renderTargetIndex >= SHADOW_RENDER_TARGETS))
+		return;
+
+	m_pRenderTargets[renderTargetIndex] = pRenderTarget;
+	m_validRenderTargets[renderTargetIndex] = true;
+
+	if (renderTargetIndex == 0)
+		InvalidateViewport();
+}
+
+/**
+* True if the depth stencil is already set.
+***/
+bool ShadowDeviceState::FilterDepthStencilSurface(IDirect3DSurface9* pDepthStencil)
+{
+	return Filtered(m_bValidDepthStencil && (m_pDepthStencil == pDepthStencil));
+}
+
+/**
+* Stores the depth stencil successfully set.
+***/
+void ShadowDeviceState::StoreDepthStencilSurface(IDirect3DSurface9* pDepthStencil)
+{
+	if (m_bRecordingStateBlock)
+		return;
+
+	m_pDepthStencil = pDepthStencil;
+	m_bValidDepthStencil = true;
+}
+
+/**
+* True if the texture is already set for that sampler.
+***/
+bool ShadowDeviceState::FilterTexture(DWORD sampler, IDirect3DBaseTexture9* pTexture)
+{
+	int index = vireio::SamplerIndex(sampler);
+	if (index < 0)
+		return false;
+
+	return Filtered(m_validTextures[index] && (m_pTextures[index] == pTexture));
+}
+
+/**
+* Stores the texture successfully set.
+***/
+void ShadowDeviceState::StoreTexture(DWORD sampler, IDirect3DBaseTexture9* pTexture)
+{
+	int index = vireio::SamplerIndex(sampler);
+	if (m_bRecordingStateBlock || (index < 0))
+		return;
+
+	m_pTextures[index] = pTexture;
+	m_validTextures[index] = true;
+}
+
+/**
+* True if the matrix is already set for that transform state.
+***/
+bool ShadowDeviceState::FilterTransform(D3DTRANSFORMSTATETYPE state, CONST D3DMATRIX* pMatrix)
+{
+	if (!pMatrix || ((UINT)state >= SHADOW_TRANSFORMS))
+		return false;
+
+	return Filtered(m_validTransforms[state] && (memcmp(&m_transforms[state], pMatrix, sizeof(D3DMATRIX)) == 0));
+}
+
+/**
+* Stores the matrix successfully set.
+***/
+void ShadowDeviceState::StoreTransform(D3DTRANSFORMSTATETYPE state, CONST D3DMATRIX* pMatrix)
+{
+	if (m_bRecordingStateBlock || !pMatrix || ((UINT)state >= SHADOW_TRANSFORMS))
+		return;
+
+	m_transforms[state] = *pMatrix;
+	m_validTransforms[state] = true;
+}
+
+/**
+* True if the viewport is already set.
+***/
+bool ShadowDeviceState::FilterViewport(CONST D3DVIEWPORT9* pViewport)
+{
+	if (!pViewport)
+		return false;
+
+	return Filtered(m_bValidViewport && (memcmp(&m_viewport, pViewport, sizeof(D3DVIEWPORT9)) == 0));
+}
+
+/**
+* Stores the viewport successfully set.
+***/
+void ShadowDeviceState::StoreViewport(CONST D3DVIEWPORT9* pViewport)
+{
+	if (m_bRecordingStateBlock || !pViewport)
+		return;
+
+	m_viewport = *pViewport;
+	m_bValidViewport = true;
+}
+
+/**
+* True if the vertex shader is already set.
+***/
+bool ShadowDeviceState::FilterVertexShader(IDirect3DVertexShader9* pShader)
+{
+	return Filtered(m_bValidVertexShader && (m_pVertexShader == pShader));
+}
+
+/**
+* Stores the vertex shader successfully set.
+***/
+void ShadowDeviceState::StoreVertexShader(IDirect3DVertexShader9* pShader)
+{
+	if (m_bRecordingStateBlock)
+		return;
+
+	m_pVertexShader = pShader;
+	m_bValidVertexShader = true;
+}
+
+/**
+* True if the pixel shader is already set.
+***/
+bool ShadowDeviceState::FilterPixelShader(IDirect3DPixelShader9* pShader)
+{
+	return Filtered(m_bValidPixelShader && (m_pPixelShader == pShader));
+}
+
+/**
+* Stores the pixel shader successfully set.
+***/
+void ShadowDeviceState::StorePixelShader(IDirect3DPixelShader9* pShader)
+{
+	if (m_bRecordingStateBlock)
+		return;
+
+	m_pPixelShader = pShader;
+	m_bValidPixelShader = true;
+}
+
+/**
+* True if buffer, offset and stride are already set for that stream.
+***/
+bool ShadowDeviceState::FilterStreamSource(UINT streamNumber, IDirect3DVertexBuffer9* pStreamData, UINT offsetInBytes, UINT stride)
+{
+	if (streamNumber >= STREAM_COUNT)
+		return false;
+
+	const StreamSource& current = m_streamSources[streamNumber];
+	return Filtered(m_validStreamSources[streamNumber] && (current.pStreamData == pStreamData) && 
+		(current.offsetInBytes == offsetInBytes) && (current.stride == stride));
+}
+
+/**
+* Stores the stream source successfully set.
+* Also called after user pointer draws, which reset stream 0.
+***/
+void ShadowDeviceState::StoreStreamSource(UINT streamNumber, IDirect3DVertexBuffer9* pStreamData, UINT offsetInBytes, UINT stride)
+{
+	if (m_bRecordingStateBlock || (streamNumber >= STREAM_COUNT))
+		return;
+
+	m_streamSources[streamNumber].pStreamData = pStreamData;
+	m_streamSources[streamNumber].offsetInBytes = offsetInBytes;
+	m_streamSources[streamNumber].stride = stride;
+	m_validStreamSources[streamNumber] = true;
+}
+
+/**
+* True if the render state already has that value.
+***/
+bool ShadowDeviceState::FilterRenderState(D3DRENDERSTATETYPE state, DWORD value)
+{
+	if ((UINT)state >= SHADOW_RENDER_STATES)
+		return false;
+
+	return Filtered(m_validRenderStates[state] && (m_renderStates[state] == value));
+}
+
+/**
+* Stores the render state successfully set.
+***/
+void ShadowDeviceState::StoreRenderState(D3DRENDERSTATETYPE state, DWORD value)
+{
+	if (m_bRecordingStateBlock || ((UINT)state >= SHADOW_RENDER_STATES))
+		return;
+
+	m_renderStates[state] = value;
+	m_validRenderStates[state] = true;
+}
+
+/**
+* True if the sampler state already has that value.
+***/
+bool ShadowDeviceState::FilterSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type, DWORD value)
+{
+	int index = vireio::SamplerIndex(sampler);
+	if ((index < 0) || ((UINT)type >= SHADOW_SAMPLER_STATES))
+		return false;
+
+	return Filtered(m_validSamplerStates[index * SHADOW_SAMPLER_STATES + type] && (m_samplerStates[index][type] == value));
+}
+
+/**
+* Stores the sampler state successfully set.
+***/
+void ShadowDeviceState::StoreSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type, DWORD value)
+{
+	int index = vireio::SamplerIndex(sampler);
+	if (m_bRecordingStateBlock || (index < 0) || ((UINT)type >= SHADOW_SAMPLER_STATES))
+		return;
+
+	m_samplerStates[index][type] = value;
+	m_validSamplerStates[index * SHADOW_SAMPLER_STATES + type] = true;
+}
+
+/**
+* Viewport unknown, the next viewport set will be passed to the actual device.
+***/
+void ShadowDeviceState::InvalidateViewport()
+{
+	m_bValidViewport = false;
+}
+
+/**
+* All states unknown, the next call for every state will be passed to the actual device.
+***/
+void ShadowDeviceState::Invalidate()
+{
+	m_validRenderTargets.reset();
+	m_bValidDepthStencil = false;
+	m_validTextures.reset();
+	m_validTransforms.reset();
+	m_bValidViewport = false;
+	m_bValidVertexShader = false;
+	m_bValidPixelShader = false;
+	m_validStreamSources.reset();
+	m_validRenderStates.reset();
+	m_validSamplerStates.reset();
+}
+
+/**
+* Enables or disables filtering while an actual state block is recorded.
+* Recorded calls must reach the actual device (to end up in the state block) but don't change the
+* device state, so nothing is filtered or stored while recording.
+***/
+void ShadowDeviceState::SetRecordingStateBlock(bool recording)
+{
+	m_bRecordingStateBlock = recording;
+}
+
+/**
+* Starts counting filtered calls for a new frame.
+***/
+void ShadowDeviceState::NewFrame()
+{
+	m_lastFrameFilteredCalls = m_frameFilteredCalls;
+	m_frameFilteredCalls = 0;
+}
+
+/**
+* Number of calls filtered this frame (so far).
+***/
+UINT ShadowDeviceState::FrameFilteredCalls()
+{
+	return m_frameFilteredCalls;
+}
+
+/**
+* Number of calls filtered last frame.
+***/
+UINT ShadowDeviceState::LastFrameFilteredCalls()
+{
+	return m_lastFrameFilteredCalls;
+}
+
+/**
+* Counts a filtered call, nothing is filtered while a state block is recorded.
+* @param redundant True if the call would set the value already set.
+* @return True if the call is to be dropped.
+***/
+bool ShadowDeviceState::Filtered(bool redundant)
+{
+	if (m_bRecordingStateBlock || !redundant)
+		return false;
+
+	m_frameFilteredCalls++;
+	return true;
+}
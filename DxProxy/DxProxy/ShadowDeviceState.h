@@ -0,0 +1,177 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ShadowDeviceState.h> and
+Class <ShadowDeviceState> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef SHADOWDEVICESTATE_H_INCLUDED
+#define SHADOWDEVICESTATE_H_INCLUDED
+
+#include <d3d9.h>
+#include <bitset>
+#include "Vireio.h"
+
+/**
+* Maximum number of render targets shadowed.
+***/
+#define SHADOW_RENDER_TARGETS 4
+/**
+* Shadowed sampler state types (D3DSAMP_ADDRESSU..D3DSAMP_DMAPOFFSET).
+***/
+#define SHADOW_SAMPLER_STATES 14
+/**
+* Shadowed render state types (D3DRS_ZENABLE..D3DRS_BLENDOPALPHA).
+***/
+#define SHADOW_RENDER_STATES 256
+/**
+* Shadowed transform state types (D3DTS_VIEW..D3DTS_WORLDMATRIX(255)).
+***/
+#define SHADOW_TRANSFORMS 512
+
+/**
+* Shadow copy of the actual device state.
+* Keeps the last value successfully set on the actual device for render targets, depth stencil, 
+* textures, transforms, viewport, shaders, stream sources, render states and sampler states. 
+* BaseDirect3DDevice9 asks the Filter methods before calling the actual device and drops a call
+* if it would set the value already bound, after a successful call the value is stored.
+*
+* Entries are only valid if set through BaseDirect3DDevice9, call Invalidate() whenever the actual 
+* device state changes behind its back (actual state block applied, device reset, direct calls 
+* to the actual device). While an actual state block is recorded, nothing is filtered.
+* @see BaseDirect3DDevice9
+*/
+class ShadowDeviceState
+{
+public:
+	ShadowDeviceState();
+	virtual ~ShadowDeviceState();
+
+	/*** ShadowDeviceState public methods ***/
+	bool FilterRenderTarget(DWORD renderTargetIndex, IDirect3DSurface9* pRenderTarget);
+	void StoreRenderTarget(DWORD renderTargetIndex, IDirect3DSurface9* pRenderTarget);
+	bool FilterDepthStencilSurface(IDirect3DSurface9* pDepthStencil);
+	void StoreDepthStencilSurface(IDirect3DSurface9* pDepthStencil);
+	bool FilterTexture(DWORD sampler, IDirect3DBaseTexture9* pTexture);
+	void StoreTexture(DWORD sampler, IDirect3DBaseTexture9* pTexture);
+	bool FilterTransform(D3DTRANSFORMSTATETYPE state, CONST D3DMATRIX* pMatrix);
+	void StoreTransform(D3DTRANSFORMSTATETYPE state, CONST D3DMATRIX* pMatrix);
+	bool FilterViewport(CONST D3DVIEWPORT9* pViewport);
+	void StoreViewport(CONST D3DVIEWPORT9* pViewport);
+	bool FilterVertexShader(IDirect3DVertexShader9* pShader);
+	void StoreVertexShader(IDirect3DVertexShader9* pShader);
+	bool FilterPixelShader(IDirect3DPixelShader9* pShader);
+	void StorePixelShader(IDirect3DPixelShader9* pShader);
+	bool FilterStreamSource(UINT streamNumber, IDirect3DVertexBuffer9* pStreamData, UINT offsetInBytes, UINT stride);
+	void StoreStreamSource(UINT streamNumber, IDirect3DVertexBuffer9* pStreamData, UINT offsetInBytes, UINT stride);
+	bool FilterRenderState(D3DRENDERSTATETYPE state, DWORD value);
+	void StoreRenderState(D3DRENDERSTATETYPE state, DWORD value);
+	bool FilterSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type, DWORD value);
+	void StoreSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type, DWORD value);
+	void InvalidateViewport();
+	void Invalidate();
+	void SetRecordingStateBlock(bool recording);
+	void NewFrame();
+	UINT FrameFilteredCalls();
+	UINT LastFrameFilteredCalls();
+
+private:
+	/*** ShadowDeviceState private methods ***/
+	bool Filtered(bool redundant);
+
+	/**
+	* Actual vertex stream binding.
+	***/
+	struct StreamSource
+	{
+		IDirect3DVertexBuffer9* pStreamData;
+		UINT                    offsetInBytes;
+		UINT                    stride;
+	};
+
+	/**
+	* Actual render targets.
+	***/
+	IDirect3DSurface9* m_pRenderTargets[SHADOW_RENDER_TARGETS];
+	std::bitset<SHADOW_RENDER_TARGETS> m_validRenderTargets;
+	/**
+	* Actual depth stencil surface.
+	***/
+	IDirect3DSurface9* m_pDepthStencil;
+	bool m_bValidDepthStencil;
+	/**
+	* Actual textures, indexed by vireio::SamplerIndex().
+	***/
+	IDirect3DBaseTexture9* m_pTextures[SAMPLER_COUNT];
+	std::bitset<SAMPLER_COUNT> m_validTextures;
+	/**
+	* Transform matrices, indexed by D3DTRANSFORMSTATETYPE.
+	***/
+	D3DMATRIX m_transforms[SHADOW_TRANSFORMS];
+	std::bitset<SHADOW_TRANSFORMS> m_validTransforms;
+	/**
+	* Actual viewport.
+	***/
+	D3DVIEWPORT9 m_viewport;
+	bool m_bValidViewport;
+	/**
+	* Actual vertex shader.
+	***/
+	IDirect3DVertexShader9* m_pVertexShader;
+	bool m_bValidVertexShader;
+	/**
+	* Actual pixel shader.
+	***/
+	IDirect3DPixelShader9* m_pPixelShader;
+	bool m_bValidPixelShader;
+	/**
+	* Actual vertex stream bindings.
+	***/
+	StreamSource m_streamSources[STREAM_COUNT];
+	std::bitset<STREAM_COUNT> m_validStreamSources;
+	/**
+	* Render state values, indexed by D3DRENDERSTATETYPE.
+	***/
+	DWORD m_renderStates[SHADOW_RENDER_STATES];
+	std::bitset<SHADOW_RENDER_STATES> m_validRenderStates;
+	/**
+	* Sampler state values, indexed by vireio::SamplerIndex() and D3DSAMPLERSTATETYPE.
+	***/
+	DWORD m_samplerStates[SAMPLER_COUNT][SHADOW_SAMPLER_STATES];
+	std::bitset<SAMPLER_COUNT * SHADOW_SAMPLER_STATES> m_validSamplerStates;
+	/**
+	* True while an actual state block is recorded, calls are not applied to the device then.
+	***/
+	bool m_bRecordingStateBlock;
+	/**
+	* Number of calls filtered this frame.
+	***/
+	UINT m_frameFilteredCalls;
+	/**
+	* Number of calls filtered last frame.
+	***/
+	UINT m_lastFrameFilteredCalls;
+};
+#endif
@@ -0,0 +1,256 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <StereoCommandList.cpp> and
+Class <StereoCommandList> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "StereoCommandList.h"
+#include <assert.h>
+
+/**
+* Constructor, creates empty list.
+***/
+StereoCommandList::StereoCommandList() :
+	m_commands(),
+	m_restoreCommands(),
+	m_data(),
+	m_touchedStates(),
+	m_drawCount(0)
+{
+	ZeroMemory(&m_frameStatistics, sizeof(Statistics));
+	ZeroMemory(&m_lastFrameStatistics, sizeof(Statistics));
+}
+
+/**
+* Destructor, releases all referenced objects.
+***/
+StereoCommandList::~StereoCommandList()
+{
+	Clear();
+}
+
+/**
+* Records a command.
+* @param type The command type.
+* @param arg0 First integer argument (meaning depends on the command type).
+* @param arg1 Second integer argument.
+* @param arg2 Third integer argument.
+* @param arg3 Fourth integer argument.
+* @param pObject Referenced object, AddRef'd by the list. Can be NULL.
+* @param pData Payload data, copied to the data arena. Can be NULL.
+* @param dataSize Payload data size in bytes.
+***/
+StereoCommandList::Command* StereoCommandList::Record(CommandTypes type, DWORD arg0, DWORD arg1, DWORD arg2, DWORD arg3, IUnknown* pObject, const void* pData, UINT dataSize)
+{
+	m_frameStatistics.commandsRecorded++;
+	if (IsDraw(type)) {
+		m_frameStatistics.drawsDeferred++;
+		m_drawCount++;
+	}
+
+	return Push(m_commands, type, arg0, arg1, arg2, arg3, pObject, pData, dataSize);
+}
+
+/**
+* Records a restore command.
+* Call only if FirstTouch() returned true for that state, with the state as it was before
+* the state is changed by the first recorded command.
+* @see Record()
+***/
+StereoCommandList::Command* StereoCommandList::Restore(CommandTypes type, DWORD arg0, DWORD arg1, DWORD arg2, DWORD arg3, IUnknown* pObject, const void* pData, UINT dataSize)
+{
+	return Push(m_restoreCommands, type, arg0, arg1, arg2, arg3, pObject, pData, dataSize);
+}
+
+/**
+* Returns true if the state was not touched since the list was cleared, and marks it as touched.
+* @param type The command type setting the state.
+* @param index State index (render state type, sampler*256+type, stage, register...).
+***/
+bool StereoCommandList::FirstTouch(CommandTypes type, DWORD index)
+{
+	UINT64 key = ((UINT64)type << 32) | (UINT64)index;
+	return m_touchedStates.insert(key).second;
+}
+
+/**
+* True if no command is recorded.
+***/
+bool StereoCommandList::IsEmpty()
+{
+	return m_commands.empty();
+}
+
+/**
+* Number of recorded draw commands (including Clear).
+* A list without draws does not need to be replayed.
+***/
+UINT StereoCommandList::DrawCount()
+{
+	return m_drawCount;
+}
+
+/**
+* Releases all referenced objects and clears commands, restore commands and data.
+* Allocated memory is kept to be reused by the next list.
+***/
+void StereoCommandList::Clear()
+{
+	for (auto it = m_commands.begin(); it != m_commands.end(); ++it) {
+		if (it->pObject)
+			it->pObject->Release();
+	}
+	for (auto it = m_restoreCommands.begin(); it != m_restoreCommands.end(); ++it) {
+		if (it->pObject)
+			it->pObject->Release();
+	}
+
+	m_commands.clear();
+	m_restoreCommands.clear();
+	m_data.clear();
+	m_touchedStates.clear();
+	m_drawCount = 0;
+}
+
+/**
+* Appends payload data to the last recorded (or restore) command.
+* Used for commands with more than one payload (DrawIndexedPrimitiveUP vertices and indices).
+* @param pCommand The last command, as returned by Record() or Restore().
+* @param pData Payload data, copied to the data arena.
+* @param dataSize Payload data size in bytes.
+***/
+void StereoCommandList::AppendData(Command* pCommand, const void* pData, UINT dataSize)
+{
+	if (!pData || (dataSize == 0))
+		return;
+
+	if (pCommand->dataSize == 0)
+		pCommand->dataOffset = (UINT)m_data.size();
+
+	assert((pCommand->dataOffset + pCommand->dataSize) == m_data.size());
+
+	pCommand->dataSize += dataSize;
+	m_data.insert(m_data.end(), (const BYTE*)pData, (const BYTE*)pData + dataSize);
+}
+
+/**
+* Returns the payload data of a command, NULL if the command has no payload.
+* Only valid until the next Record()/Restore() call.
+***/
+const void* StereoCommandList::Data(const Command& command)
+{
+	if (command.dataSize == 0)
+		return NULL;
+
+	return &m_data[command.dataOffset];
+}
+
+/**
+* Recorded commands, in call order.
+***/
+const std::vector<StereoCommandList::Command>& StereoCommandList::Commands()
+{
+	return m_commands;
+}
+
+/**
+* Restore commands.
+***/
+const std::vector<StereoCommandList::Command>& StereoCommandList::RestoreCommands()
+{
+	return m_restoreCommands;
+}
+
+/**
+* Call once per frame (on Present), keeps the statistics of the ended frame.
+***/
+void StereoCommandList::NewFrame()
+{
+	m_lastFrameStatistics = m_frameStatistics;
+	ZeroMemory(&m_frameStatistics, sizeof(Statistics));
+}
+
+/**
+* Statistics of the current frame.
+***/
+StereoCommandList::Statistics& StereoCommandList::FrameStatistics()
+{
+	return m_frameStatistics;
+}
+
+/**
+* Statistics of the last full frame.
+***/
+const StereoCommandList::Statistics& StereoCommandList::LastFrameStatistics()
+{
+	return m_lastFrameStatistics;
+}
+
+/**
+* True if the command type draws (DrawPrimitive..., Clear), false if it only sets a state.
+***/
+bool StereoCommandList::IsDraw(CommandTypes type)
+{
+	switch (type)
+	{
+	case Cmd_Type_DrawPrimitive:
+	case Cmd_Type_DrawIndexedPrimitive:
+	case Cmd_Type_DrawPrimitiveUP:
+	case Cmd_Type_DrawIndexedPrimitiveUP:
+	case Cmd_Type_Clear:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+* Adds a command to the specified list.
+* @see Record()
+***/
+StereoCommandList::Command* StereoCommandList::Push(std::vector<Command>& list, CommandTypes type, DWORD arg0, DWORD arg1, DWORD arg2, DWORD arg3, IUnknown* pObject, const void* pData, UINT dataSize)
+{
+	Command command;
+	ZeroMemory(&command, sizeof(Command));
+	command.type = type;
+	command.args[0] = arg0;
+	command.args[1] = arg1;
+	command.args[2] = arg2;
+	command.args[3] = arg3;
+	command.pObject = pObject;
+
+	if (pObject)
+		pObject->AddRef();
+
+	if (pData && (dataSize > 0)) {
+		command.dataOffset = (UINT)m_data.size();
+		command.dataSize = dataSize;
+		m_data.insert(m_data.end(), (const BYTE*)pData, (const BYTE*)pData + dataSize);
+	}
+
+	list.push_back(command);
+	return &list.back();
+}
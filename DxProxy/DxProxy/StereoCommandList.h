@@ -0,0 +1,160 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <StereoCommandList.h> and
+Class <StereoCommandList> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef STEREOCOMMANDLIST_H_INCLUDED
+#define STEREOCOMMANDLIST_H_INCLUDED
+
+#include <d3d9.h>
+#include <vector>
+#include <unordered_set>
+
+/**
+* Deferred stereo command list.
+* Records the draws and state changes issued for one render target binding, so the proxy device can
+* draw the first eye immediately and replay the whole list for the second eye with a single eye switch.
+* Next to the commands the list keeps restore commands (the state as it was when a state was first
+* touched), these bring the device back to the state at the beginning of the list before replaying.
+* The list does not know how to execute a command, that is done by D3DProxyDevice.
+* @see D3DProxyDevice::FlushPendingCommands()
+*/
+class StereoCommandList
+{
+public:
+	StereoCommandList();
+	virtual ~StereoCommandList();
+
+	/**
+	* Recorded command types.
+	***/
+	enum CommandTypes
+	{
+		Cmd_Type_DrawPrimitive,
+		Cmd_Type_DrawIndexedPrimitive,
+		Cmd_Type_DrawPrimitiveUP,
+		Cmd_Type_DrawIndexedPrimitiveUP,
+		Cmd_Type_Clear,
+		Cmd_Type_RenderState,
+		Cmd_Type_SamplerState,
+		Cmd_Type_TextureStageState,
+		Cmd_Type_ScissorRect,
+		Cmd_Type_FVF,
+		Cmd_Type_Transform,
+		Cmd_Type_StereoView,
+		Cmd_Type_StereoProjection,
+		Cmd_Type_Viewport,
+		Cmd_Type_Texture,
+		Cmd_Type_StreamSource,
+		Cmd_Type_StreamSourceFreq,
+		Cmd_Type_Indices,
+		Cmd_Type_VertexDeclaration,
+		Cmd_Type_VertexShader,
+		Cmd_Type_PixelShader,
+		Cmd_Type_VertexShaderConstantF,
+		Cmd_Type_PixelShaderConstantF
+	};
+
+	/**
+	* One recorded command.
+	* Arguments are stored in args, larger payloads (matrices, constants, user pointer vertex data)
+	* are stored in the data arena of the list.
+	***/
+	struct Command
+	{
+		CommandTypes type;       /**< The command type. */
+		DWORD        args[6];    /**< Integer arguments, meaning depends on the command type. */
+		IUnknown*    pObject;    /**< Referenced proxy object (texture, buffer, shader, declaration), AddRef'd by the list. */
+		UINT         dataOffset; /**< Offset of the payload in the data arena. */
+		UINT         dataSize;   /**< Size of the payload in bytes. */
+	};
+
+	/**
+	* Command list statistics.
+	* Counted for the current frame, the last frame is kept for display.
+	***/
+	struct Statistics
+	{
+		UINT commandsRecorded; /**< Commands recorded (and drawn immediately for the recording eye). */
+		UINT commandsReplayed; /**< Commands replayed for the other eye. */
+		UINT commandsRestored; /**< Restore commands applied before a replay. */
+		UINT drawsDeferred;    /**< Draw calls (including Clear) deferred to the replay. */
+		UINT listsReplayed;    /**< Number of flushed (replayed) lists. */
+	};
+
+	/*** StereoCommandList public methods ***/
+	Command*                    Record(CommandTypes type, DWORD arg0 = 0, DWORD arg1 = 0, DWORD arg2 = 0, DWORD arg3 = 0, IUnknown* pObject = NULL, const void* pData = NULL, UINT dataSize = 0);
+	Command*                    Restore(CommandTypes type, DWORD arg0 = 0, DWORD arg1 = 0, DWORD arg2 = 0, DWORD arg3 = 0, IUnknown* pObject = NULL, const void* pData = NULL, UINT dataSize = 0);
+	bool                        FirstTouch(CommandTypes type, DWORD index);
+	bool                        IsEmpty();
+	UINT                        DrawCount();
+	void                        Clear();
+	void                        AppendData(Command* pCommand, const void* pData, UINT dataSize);
+	const void*                 Data(const Command& command);
+	const std::vector<Command>& Commands();
+	const std::vector<Command>& RestoreCommands();
+	void                        NewFrame();
+	Statistics&                 FrameStatistics();
+	const Statistics&           LastFrameStatistics();
+	static bool                 IsDraw(CommandTypes type);
+
+private:
+	/*** StereoCommandList private methods ***/
+	Command* Push(std::vector<Command>& list, CommandTypes type, DWORD arg0, DWORD arg1, DWORD arg2, DWORD arg3, IUnknown* pObject, const void* pData, UINT dataSize);
+
+	/**
+	* Recorded commands, in call order.
+	***/
+	std::vector<Command> m_commands;
+	/**
+	* Restore commands, one per state touched by the recorded commands.
+	* Order is not important since every state is restored once.
+	***/
+	std::vector<Command> m_restoreCommands;
+	/**
+	* Payload data arena for both command vectors.
+	***/
+	std::vector<BYTE> m_data;
+	/**
+	* States touched since the list was cleared.
+	* <command type in high DWORD, state index in low DWORD>
+	***/
+	std::unordered_set<UINT64> m_touchedStates;
+	/**
+	* Number of recorded draw commands (including Clear).
+	***/
+	UINT m_drawCount;
+	/**
+	* Statistics of the current frame.
+	***/
+	Statistics m_frameStatistics;
+	/**
+	* Statistics of the last frame.
+	***/
+	Statistics m_lastFrameStatistics;
+};
+#endif
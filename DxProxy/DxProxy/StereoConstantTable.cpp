@@ -0,0 +1,152 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <StereoConstantTable.cpp> and
+Class <StereoConstantTable> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "StereoConstantTable.h"
+#include <algorithm>
+
+/**
+* Constructor.
+* Creates an empty table.
+***/
+StereoConstantTable::StereoConstantTable() :
+	m_spLayout(std::make_shared<Layout>()),
+	m_constants()
+{
+	m_spLayout->id = NewId();
+	m_spLayout->usageKnown = false;
+}
+
+/**
+* Destructor.
+***/
+StereoConstantTable::~StereoConstantTable()
+{
+}
+
+/**
+* Adds a constant, keeping the table sorted.
+* An existing constant at the same start register is not replaced.
+* @param StartReg Shader constant start register.
+* @param Count Register count.
+* @param modification The modification of the constant, kept alive by the table.
+* @param pData Initial data, Count registers.
+* @return False if a constant already starts at StartReg.
+***/
+bool StereoConstantTable::Add(UINT StartReg, UINT Count, std::shared_ptr<ShaderConstantModification<float>> modification, const float* pData)
+{
+	if (Find(StartReg) >= 0)
+		return false;
+
+	Layout* pLayout = MutableLayout();
+	if (std::find(pLayout->modifications.begin(), pLayout->modifications.end(), modification) == pLayout->modifications.end())
+		pLayout->modifications.push_back(modification);
+
+	auto it = std::lower_bound(pLayout->startRegisters.begin(), pLayout->startRegisters.end(), StartReg);
+	size_t index = it - pLayout->startRegisters.begin();
+	StereoShaderConstant<float> constant(StartReg, pData, Count, modification.get());
+	pLayout->startRegisters.insert(it, StartReg);
+	pLayout->counts.insert(pLayout->counts.begin() + index, constant.Count());
+	m_constants.insert(m_constants.begin() + index, constant);
+
+	// layout changed
+	pLayout->id = NewId();
+
+	return true;
+}
+
+/**
+* Starts register usage tracking with no register used.
+* Called once the constant table of the shader is known, until then all registers count as used.
+***/
+void StereoConstantTable::ResetUsage()
+{
+	Layout* pLayout = MutableLayout();
+	pLayout->usedRegisters.clear();
+	pLayout->usageKnown = true;
+}
+
+/**
+* Marks float registers as read by the shader.
+* @param StartReg First register.
+* @param Count Register count.
+***/
+void StereoConstantTable::MarkUsed(UINT StartReg, UINT Count)
+{
+	DirtyRegisters::MarkMask(&MutableLayout()->usedRegisters, StartReg, Count);
+}
+
+/**
+* Sets the float registers read by the shader from a register mask.
+* @param pUsedRegisters Register mask (DirtyRegisters mask layout).
+* @param words Size of the mask in words.
+***/
+void StereoConstantTable::SetUsage(const DWORD* pUsedRegisters, UINT words)
+{
+	Layout* pLayout = MutableLayout();
+	pLayout->usedRegisters.assign(pUsedRegisters, pUsedRegisters + words);
+	pLayout->usageKnown = true;
+}
+
+/**
+* Returns the layout for a change, copies it first if other tables share it.
+* A copied layout gets a new identifier, it may differ from the shared one after the change.
+***/
+StereoConstantTable::Layout* StereoConstantTable::MutableLayout()
+{
+	if (m_spLayout.use_count() > 1) {
+		m_spLayout = std::make_shared<Layout>(*m_spLayout);
+		m_spLayout->id = NewId();
+	}
+
+	return m_spLayout.get();
+}
+
+/**
+* Returns a new table layout identifier.
+* Shaders may be created on any thread, so the counter is increased atomically.
+***/
+UINT StereoConstantTable::NewId()
+{
+	static volatile LONG lastId = 0;
+	return (UINT)InterlockedIncrement(&lastId);
+}
+
+/**
+* Returns the index of the constant starting at StartReg, -1 if there is none.
+* @param StartReg Shader constant start register.
+***/
+int StereoConstantTable::Find(UINT StartReg)
+{
+	const std::vector<UINT>& startRegisters = m_spLayout->startRegisters;
+	auto it = std::lower_bound(startRegisters.begin(), startRegisters.end(), StartReg);
+	if ((it == startRegisters.end()) || (*it != StartReg))
+		return -1;
+
+	return (int)(it - startRegisters.begin());
+}
@@ -0,0 +1,125 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <StereoConstantTable.h> and
+Class <StereoConstantTable> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef STEREOCONSTANTTABLE_H_INCLUDED
+#define STEREOCONSTANTTABLE_H_INCLUDED
+
+#include <d3d9.h>
+#include <vector>
+#include <memory>
+#include "StereoShaderConstant.h"
+#include "ShaderConstantModification.h"
+#include "DirtyRegisters.h"
+
+/**
+* Modified constants of one shader, sorted by start register.
+* Start registers and register counts are kept in separate arrays, so the per draw dirty tests walk
+* two small contiguous arrays and only touch the constant data itself when a constant needs an update.
+* The constants store their data inline and reference their modification by raw pointer, the table
+* keeps the modifications alive.
+* Every table layout gets a unique identifier (a new one whenever a constant is added), so results
+* computed from two layouts can be cached by identifier.
+* The table also knows which float registers the shader reads (from its constant table and instructions), so registers
+* the shader never reads need not be uploaded while it is active.
+* Start registers, counts, modifications and register usage form the layout, which is shared by all copies
+* of a table (all shaders with the same function share the layout of their analysis). Only the constants
+* (original, left and right data) are copied. A shared layout is copied before it is changed.
+* @see StereoShaderConstant
+*/
+class StereoConstantTable
+{
+public:
+	StereoConstantTable();
+	virtual ~StereoConstantTable();
+
+	/*** StereoConstantTable public methods ***/
+	bool Add(UINT StartReg, UINT Count, std::shared_ptr<ShaderConstantModification<float>> modification, const float* pData);
+	int  Find(UINT StartReg);
+	void ResetUsage();
+	void MarkUsed(UINT StartReg, UINT Count);
+	void SetUsage(const DWORD* pUsedRegisters, UINT words);
+
+	/**
+	* Returns the unique identifier of the table layout, never 0.
+	***/
+	UINT Id() { return m_spLayout->id; }
+	/**
+	* Returns the number of constants.
+	***/
+	UINT Size() { return (UINT)m_spLayout->startRegisters.size(); }
+	/**
+	* True if the table holds no constant.
+	***/
+	bool Empty() { return m_spLayout->startRegisters.empty(); }
+	/**
+	* Returns the start register of constant i.
+	***/
+	UINT StartRegister(UINT i) { return m_spLayout->startRegisters[i]; }
+	/**
+	* Returns the register count of constant i.
+	***/
+	UINT Count(UINT i) { return m_spLayout->counts[i]; }
+	/**
+	* Returns constant i.
+	***/
+	StereoShaderConstant<float>& Constant(UINT i) { return m_constants[i]; }
+	/**
+	* Returns the mask of float registers read by the shader (DirtyRegisters mask layout), NULL if
+	* unknown (all registers may be read).
+	***/
+	const std::vector<DWORD>* UsedRegisters() { return m_spLayout->usageKnown ? &m_spLayout->usedRegisters : NULL; }
+
+private:
+	/**
+	* Table layout, shared by copies of the table.
+	***/
+	struct Layout
+	{
+		UINT                                                            id;             /**< Unique identifier of the layout. */
+		std::vector<UINT>                                               startRegisters; /**< Start registers, ascending. */
+		std::vector<UINT>                                               counts;         /**< Register counts, same order as startRegisters. */
+		std::vector<std::shared_ptr<ShaderConstantModification<float>>> modifications;  /**< The modifications referenced by the constants (each one once). */
+		std::vector<DWORD>                                              usedRegisters;  /**< Float registers read by the shader, one bit per register. */
+		bool                                                            usageKnown;     /**< True if usedRegisters is known, false if the shader may read any register. */
+	};
+
+	/*** StereoConstantTable private methods ***/
+	Layout*     MutableLayout();
+	static UINT NewId();
+
+	/**
+	* The layout, never NULL.
+	***/
+	std::shared_ptr<Layout> m_spLayout;
+	/**
+	* The constants, same order as the start registers.
+	***/
+	std::vector<StereoShaderConstant<float>> m_constants;
+};
+#endif
@@ -30,9 +30,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef STEREOSHADERCONSTANT_H_INCLUDED
 #define STEREOSHADERCONSTANT_H_INCLUDED
 
-#include <vector>
 #include <string>
 #include <memory>
+#include <vector>
 #include "d3d9.h"
 #include "d3dx9.h"
 #include "ShaderConstantModification.h"
@@ -43,48 +43,70 @@ template <class T=float, UINT L=4>
 /**
 * Stero shader constant data class.
 * Here, the current shader constant is stored.
+* Data of constants up to MAX_REGISTERS registers (one matrix) is stored inline, larger constants
+* (arrays) keep it on the heap. The modification is not owned, the owning StereoConstantTable keeps
+* it alive.
+* @see StereoConstantTable
 */
 class StereoShaderConstant
 {
 public:
+	/**
+	* Maximum number of registers of a constant stored inline.
+	***/
+	static const UINT MAX_REGISTERS = 4;
+
 	/**
 	* Constructor.
 	* @param StartReg
-	* @param pData
-	* @param dataCount
-	* @param modification
+	* @param pData Initial data, dataCount registers.
+	* @param dataCount Register count.
+	* @param pModification Constant modification, must outlive the constant.
 	***/
-	StereoShaderConstant(UINT StartReg, const T* pData, UINT dataCount, std::shared_ptr<ShaderConstantModification<T>> modification) :
+	StereoShaderConstant(UINT StartReg, const T* pData, UINT dataCount, ShaderConstantModification<T>* pModification) :
+		m_heapData(),
+		m_pModification(pModification),
 		m_StartRegister(StartReg),
 		m_Count(dataCount),
-		m_DataOriginal(pData, pData + (dataCount * L)),
-		m_DataLeft(),
-		m_DataRight(),
-		m_modification(modification)
+		m_eyesEqual(false),
+		m_adjustmentGeneration(0)
 	{
-		m_DataLeft.resize(dataCount * L);
-		m_DataRight.resize(dataCount * L);
+		if (dataCount > MAX_REGISTERS)
+			m_heapData.resize(3 * dataCount * L);
+
 		Update(pData);
 	}
 	/**
-	* Destructor.
-	* Calls ShaderConstantModification::reset()
-	* @see ShaderConstantModification::reset()
-	***/
-	virtual ~StereoShaderConstant() 
-	{
-		m_modification.reset();
-	}
-	/**
 	* Updates this constant by specified data.
 	* Assigns data to original data, applies constant modification.
+	* The modification is skipped if neither the data nor the view adjustment generation changed
+	* since the last update, left and right data are still valid then.
 	* Verify data dimensions match this constant _before_ calling if needed.
 	* @param pData Pointer to new data. 
+	* @return True if left and right data were recomputed.
+	***/
+	bool Update(const T* pData) 
+	{
+		UINT adjustmentGeneration = m_pModification->AdjustmentGeneration();
+		if ((adjustmentGeneration == m_adjustmentGeneration) && (memcmp(pData, DataOriginalPointer(), m_Count * L * sizeof(T)) == 0))
+			return false;
+
+		memcpy(DataOriginalPointer(), pData, m_Count * L * sizeof(T));
+		m_pModification->ApplyModification(pData, DataLeftPointer(), DataRightPointer(), m_Count * L);
+		m_eyesEqual = (memcmp(DataLeftPointer(), DataRightPointer(), m_Count * L * sizeof(T)) == 0);
+		m_adjustmentGeneration = adjustmentGeneration;
+		return true;
+	}
+	/**
+	* Takes over the data of the same constant of another shader (left, right and original data).
+	* The modification of this constant is kept.
+	* @param other The other constant, SameConstantAs() must be true.
 	***/
-	void Update(const T* pData) 
+	void CopyDataFrom(const StereoShaderConstant<T> & other)
 	{
-		m_DataOriginal.assign(pData, pData + (m_Count * L));
-		m_modification->ApplyModification(pData, &m_DataLeft, &m_DataRight);
+		memcpy(Data(), other.Data(), 3 * m_Count * L * sizeof(T));
+		m_eyesEqual = other.m_eyesEqual;
+		m_adjustmentGeneration = other.m_adjustmentGeneration;
 	}
 	/**
 	* Return true if this constant represents the same constant as other.
@@ -95,23 +117,29 @@ public:
 	bool SameConstantAs(const StereoShaderConstant<T> & other)
 	{
 		return ((other.m_StartRegister == m_StartRegister) &&
-			(other.m_modification->m_ModificationID == m_modification->m_ModificationID));
+			(other.m_Count == m_Count) &&
+			(other.m_pModification->m_ModificationID == m_pModification->m_ModificationID));
 	}
 	/**
 	* Returns pointer to left data.
 	***/
 	T* DataLeftPointer() 
 	{
-		return &m_DataLeft[0];
+		return Data() + m_Count * L;
 	}
 	/**
 	* Returns pointer to right data.
 	***/
 	T* DataRightPointer() 
 	{
-		return &m_DataRight[0];
+		return Data() + 2 * m_Count * L;
 	}
 	/**
+	* True if the last modification produced the same left and right data.
+	* Such a constant does not need to be applied again when the side changes.
+	***/
+	bool EyesEqual() { return m_eyesEqual; }
+	/**
 	* Returns the shader constant start register.
 	***/
 	UINT StartRegister() { return m_StartRegister; }
@@ -122,24 +150,33 @@ public:
 	UINT Count() { return m_Count; }
 private:
 	/**
-	* Original constant data, currently not used but assigned.
-	* Number of T in a Register (L) = (4 for float/int, 1 for bool).
+	* Returns the constant data, original, left and right data of m_Count registers each.
+	***/
+	T* Data() { return m_heapData.empty() ? m_inlineData : &m_heapData[0]; }
+	/**
+	* Returns the constant data (const).
+	***/
+	const T* Data() const { return m_heapData.empty() ? m_inlineData : &m_heapData[0]; }
+	/**
+	* Returns pointer to the original data, the input of the last modification.
 	***/
-	std::vector<T> m_DataOriginal;
+	T* DataOriginalPointer() { return Data(); }
+
 	/**
-	* Left constant data.
-	* Number of T in a Register (L) = (4 for float/int, 1 for bool)
+	* Inline constant data of constants up to MAX_REGISTERS registers.
+	* Original, left and right data, m_Count registers each.
+	* Number of T in a Register (L) = (4 for float/int, 1 for bool).
 	***/
-	std::vector<T> m_DataLeft;
+	T m_inlineData[3 * MAX_REGISTERS * L];
 	/**
-	* Right constant data
-	* Number of T in a Register (L) = (4 for float/int, 1 for bool)
+	* Constant data of constants above MAX_REGISTERS registers, empty otherwise.
+	* Same layout as m_inlineData.
 	***/
-	std::vector<T> m_DataRight;
+	std::vector<T> m_heapData;
 	/**
-	* Pointer to constant modification.
+	* Constant modification, not owned.
 	***/
-	std::shared_ptr<ShaderConstantModification<T>> m_modification;
+	ShaderConstantModification<T>* m_pModification;
 	/**
 	* Shader start register.
 	***/
@@ -149,5 +186,13 @@ private:
 	* (4*float == 1 : Vector4 == 1, D3DMATRIX == 4,...)
 	***/
 	UINT m_Count;	
+	/**
+	* True if left and right data are equal.
+	***/
+	bool m_eyesEqual;
+	/**
+	* View adjustment generation of the last modification, 0 if never modified.
+	***/
+	UINT m_adjustmentGeneration;
 };
 #endif
\ No newline at end of file
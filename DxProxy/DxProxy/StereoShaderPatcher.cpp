@@ -0,0 +1,735 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <StereoShaderPatcher.cpp> and
+Class <StereoShaderPatcher> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "StereoShaderPatcher.h"
+
+/**
+* Token values (as in d3d9types.h).
+***/
+#define OPCODE_MOV              0x0001
+#define OPCODE_MAD              0x0004
+#define OPCODE_MUL              0x0005
+#define OPCODE_DP3              0x0008
+#define OPCODE_DP4              0x0009
+#define OPCODE_M4x4             0x0014
+#define OPCODE_M4x3             0x0015
+#define OPCODE_M3x4             0x0016
+#define OPCODE_M3x3             0x0017
+#define OPCODE_M3x2             0x0018
+#define OPCODE_CALL             0x0019
+#define OPCODE_CALLNZ           0x001A
+#define OPCODE_RET              0x001C
+#define OPCODE_LABEL            0x001E
+#define OPCODE_DCL              0x001F
+#define OPCODE_TEXKILL          0x0041
+#define OPCODE_DEF              0x0051
+#define OPCODE_DEFI             0x0052
+#define OPCODE_DEFB             0x0053
+#define OPCODE_COMMENT          0xFFFE
+#define OPCODE_END              0xFFFF
+#define INSTRUCTION_LENGTH(x)   (((x) >> 24) & 0xF)
+#define INSTRUCTION_PREDICATED  0x10000000
+#define COMMENT_LENGTH(x)       (((x) >> 16) & 0x7FFF)
+#define END_TOKEN               0x0000FFFF
+#define PARAMETER_TOKEN         0x80000000
+#define PARAMETER_NUMBER(x)     ((x) & 0x7FF)
+#define PARAMETER_TYPE(x)       ((((x) >> 28) & 0x7) | (((x) >> 8) & 0x18))
+#define PARAMETER_TYPE_BITS     0x70001800
+#define ADDRMODE_RELATIVE       0x00002000
+#define WRITEMASK(x)            (((x) >> 16) & 0xF)
+#define WRITEMASK_ALL           0xF
+#define SWIZZLE_XYZW            0xE4
+#define SWIZZLE_XXXX            0x00
+#define SWIZZLE_YYYY            0x55
+#define SWIZZLE_ZZZZ            0xAA
+#define SWIZZLE_WWWW            0xFF
+#define REGTYPE_TEMP            0
+#define REGTYPE_INPUT           1
+#define REGTYPE_CONST           2
+#define REGTYPE_TEXTURE         3
+#define REGTYPE_RASTOUT         4
+#define REGTYPE_OUTPUT          6
+#define REGTYPE_CONST2          11
+#define REGTYPE_CONST3          12
+#define REGTYPE_CONST4          13
+#define RASTOUT_POSITION        0
+#define DECLUSAGE_POSITION      0
+#define DECLUSAGE_TEXCOORD      5
+#define DCL_USAGE(x)            ((x) & 0x1F)
+#define DCL_USAGE_INDEX(x)      (((x) >> 16) & 0xF)
+
+/**
+* Register limits of the patched shader models.
+***/
+#define VS_INPUT_COUNT          16
+#define VS3_OUTPUT_COUNT        12
+#define VS2_TEMP_COUNT          12
+#define VS3_TEMP_COUNT          32
+#define PS3_INPUT_COUNT         10
+#define MAX_INSTRUCTION_LENGTH  16
+
+const uint32_t StereoShaderPatcher::NO_REGISTER;
+
+/**
+* Builds a parameter token.
+* @param maskOrSwizzle Write mask of destination parameters, swizzle of source parameters.
+***/
+static uint32_t Parameter(uint32_t type, uint32_t number, uint32_t maskOrSwizzle)
+{
+	return PARAMETER_TOKEN | ((type & 0x7) << 28) | ((type & 0x18) << 8) | (maskOrSwizzle << 16) | number;
+}
+
+/**
+* Moves a (not relative) parameter to another register, keeping write mask, swizzle and modifiers.
+***/
+static uint32_t Retarget(uint32_t parameter, uint32_t type, uint32_t number)
+{
+	return (parameter & ~(PARAMETER_TYPE_BITS | ADDRMODE_RELATIVE | 0x7FF)) | ((type & 0x7) << 28) | ((type & 0x18) << 8) | number;
+}
+
+/**
+* Rows and row instruction of the matrix macros (m4x4 = 4 x dp4, ...).
+* @return False if the opcode is no matrix macro.
+***/
+static bool MatrixMacro(uint32_t opcode, uint32_t* pRows, uint32_t* pRowOpcode)
+{
+	switch (opcode)
+	{
+	case OPCODE_M4x4:
+		*pRows = 4;
+		*pRowOpcode = OPCODE_DP4;
+		return true;
+	case OPCODE_M4x3:
+		*pRows = 3;
+		*pRowOpcode = OPCODE_DP4;
+		return true;
+	case OPCODE_M3x4:
+		*pRows = 4;
+		*pRowOpcode = OPCODE_DP3;
+		return true;
+	case OPCODE_M3x3:
+		*pRows = 3;
+		*pRowOpcode = OPCODE_DP3;
+		return true;
+	case OPCODE_M3x2:
+		*pRows = 2;
+		*pRowOpcode = OPCODE_DP3;
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+* Constructor.
+* Nothing patched.
+***/
+StereoShaderPatcher::StereoShaderPatcher() :
+	m_bytecode(),
+	m_function(),
+	m_rightRegisters(),
+	m_stereoIndex(),
+	m_rightOf(),
+	m_registerUsed(),
+	m_error("")
+{
+}
+
+/**
+* Destructor.
+***/
+StereoShaderPatcher::~StereoShaderPatcher()
+{
+}
+
+/**
+* Patches a vertex shader for instanced stereo.
+* The patched shader declares the instance data (InstanceData()) as TEXCOORD15 input. Each read of a stereo
+* constant is replaced by a temporary register holding left * left weight + right * right weight, matrix
+* macros reading stereo rows are expanded to dot products. The position is written to a temporary register
+* and moved to the eye's half of the target at the end ((x +- w) / 2), the distance to the middle of the
+* target is written to TEXCOORD7.
+* @param pFunction The vertex shader function, as passed to CreateVertexShader().
+* @param sizeOfData Size of the function in bytes.
+* @param stereoConstants The stereo constants of the shader (left values in the registers the game sets).
+* @param floatRegisterCount Number of float constant registers of the device, right values are placed in
+* free registers below.
+* @return False if the shader can not be patched (Error()).
+***/
+bool StereoShaderPatcher::PatchVertexShader(const void* pFunction, size_t sizeOfData, const std::vector<StereoConstant>& stereoConstants, uint32_t floatRegisterCount)
+{
+	m_function.clear();
+	m_rightRegisters.assign(stereoConstants.size(), NO_REGISTER);
+	m_error = "";
+
+	if (!m_bytecode.Parse(pFunction, sizeOfData) || m_bytecode.IsPixelShader())
+		return Fail("no vertex shader function");
+	if (m_bytecode.MajorVersion() < 2)
+		return Fail("shader model 1 not supported");
+
+	const uint32_t* pTokens = static_cast<const uint32_t*>(pFunction);
+	size_t tokenCount = sizeOfData / sizeof(uint32_t);
+	bool shaderModel3 = (m_bytecode.MajorVersion() >= 3);
+
+	// stereo registers
+	m_stereoIndex.assign(floatRegisterCount, NO_REGISTER);
+	m_rightOf.assign(floatRegisterCount, NO_REGISTER);
+	m_registerUsed.assign(floatRegisterCount, false);
+	for (uint32_t index = 0; index < (uint32_t)stereoConstants.size(); index++) {
+		const StereoConstant& constant = stereoConstants[index];
+		if ((constant.count == 0) || (constant.startRegister >= floatRegisterCount) || (constant.count > floatRegisterCount - constant.startRegister))
+			return Fail("stereo constant out of range");
+
+		for (uint32_t reg = constant.startRegister; reg < constant.startRegister + constant.count; reg++) {
+			if (m_stereoIndex[reg] != NO_REGISTER)
+				return Fail("stereo constants overlap");
+			m_stereoIndex[reg] = index;
+			m_registerUsed[reg] = true;
+		}
+	}
+
+	// the game sets every constant of the constant table, read or not
+	const std::vector<ShaderBytecode::Constant>& constants = m_bytecode.Constants();
+	for (auto itConstant = constants.begin(); itConstant != constants.end(); ++itConstant) {
+		if (itConstant->registerSet != ShaderBytecode::RegisterSet_Float4)
+			continue;
+		for (uint32_t reg = itConstant->registerIndex; (reg < (uint32_t)itConstant->registerIndex + itConstant->registerCount) && (reg < floatRegisterCount); reg++)
+			m_registerUsed[reg] = true;
+	}
+
+	// Scan the shader: declared registers, position writes, stereo constants read and the number of
+	// temporary registers the selections need.
+	std::vector<bool> stereoRead(stereoConstants.size(), false);
+	uint32_t inputs = 0;
+	uint32_t outputs = 0;
+	uint32_t positionOutput = NO_REGISTER;
+	uint32_t positionDeclarationMask = WRITEMASK_ALL;
+	uint32_t positionMask = 0;
+	uint32_t tempCount = 0;
+	uint32_t scratchCount = 1;
+	size_t firstInstruction = 0;
+	size_t end = tokenCount;
+
+	for (size_t token = 1; token < tokenCount;) {
+		uint32_t instruction = pTokens[token];
+		uint32_t opcode = instruction & 0xFFFF;
+
+		if (opcode == OPCODE_END) {
+			end = token;
+			break;
+		}
+		if (opcode == OPCODE_COMMENT) {
+			token += 1 + COMMENT_LENGTH(instruction);
+			continue;
+		}
+
+		size_t start = token;
+		size_t length = INSTRUCTION_LENGTH(instruction);
+		const uint32_t* pParameters = pTokens + start + 1;
+		token += 1 + length;
+
+		if (opcode == OPCODE_DCL) {
+			if (length < 2)
+				return Fail("damaged dcl instruction");
+
+			uint32_t usage = pParameters[0];
+			uint32_t parameter = pParameters[1];
+			uint32_t number = PARAMETER_NUMBER(parameter);
+			if (PARAMETER_TYPE(parameter) == REGTYPE_INPUT) {
+				if (number < VS_INPUT_COUNT)
+					inputs |= 1U << number;
+				if ((DCL_USAGE(usage) == DECLUSAGE_TEXCOORD) && (DCL_USAGE_INDEX(usage) == INSTANCE_USAGE_INDEX))
+					return Fail("TEXCOORD15 input in use");
+			}
+			else if (PARAMETER_TYPE(parameter) == REGTYPE_OUTPUT) {
+				bool shared = (number < VS3_OUTPUT_COUNT) && ((outputs & (1U << number)) != 0);
+				if (number < VS3_OUTPUT_COUNT)
+					outputs |= 1U << number;
+
+				if ((DCL_USAGE(usage) == DECLUSAGE_POSITION) && (DCL_USAGE_INDEX(usage) == 0)) {
+					if (shared || (positionOutput != NO_REGISTER))
+						return Fail("position output register shared");
+					positionOutput = number;
+					positionDeclarationMask = WRITEMASK(parameter);
+				}
+				else if (number == positionOutput)
+					return Fail("position output register shared");
+				else if ((DCL_USAGE(usage) == DECLUSAGE_TEXCOORD) && (DCL_USAGE_INDEX(usage) == SIDE_USAGE_INDEX))
+					return Fail("TEXCOORD7 output in use");
+			}
+			continue;
+		}
+
+		if ((opcode == OPCODE_DEF) || (opcode == OPCODE_DEFI) || (opcode == OPCODE_DEFB)) {
+			if ((opcode == OPCODE_DEF) && (length > 0) && (PARAMETER_NUMBER(pParameters[0]) < floatRegisterCount)) {
+				uint32_t number = PARAMETER_NUMBER(pParameters[0]);
+				if (m_stereoIndex[number] != NO_REGISTER)
+					return Fail("stereo register defined by the shader");
+				m_registerUsed[number] = true;
+			}
+			continue;
+		}
+
+		// a subroutine may be called before and after the position is written
+		if ((opcode == OPCODE_CALL) || (opcode == OPCODE_CALLNZ) || (opcode == OPCODE_RET) || (opcode == OPCODE_LABEL))
+			return Fail("subroutines not supported");
+
+		if (firstInstruction == 0)
+			firstInstruction = start;
+
+		uint32_t rows = 0;
+		uint32_t rowOpcode = 0;
+		bool matrix = MatrixMacro(opcode, &rows, &rowOpcode);
+		uint32_t rowsOperand = (instruction & INSTRUCTION_PREDICATED) ? 3 : 2;
+		bool matrixStereo = false;
+		uint32_t selected[MAX_INSTRUCTION_LENGTH];
+		uint32_t selectCount = 0;
+
+		for (size_t parameterIndex = 0, operand = 0; parameterIndex < length; parameterIndex++, operand++) {
+			uint32_t parameter = pParameters[parameterIndex];
+			uint32_t type = PARAMETER_TYPE(parameter);
+			uint32_t number = PARAMETER_NUMBER(parameter);
+			bool relative = ((parameter & ADDRMODE_RELATIVE) != 0);
+			if (relative)
+				parameterIndex++;
+
+			switch (type)
+			{
+			case REGTYPE_TEMP:
+				if (number + 1 > tempCount)
+					tempCount = number + 1;
+				break;
+			case REGTYPE_CONST:
+				if (relative) {
+					if (!CheckRelativeRead(number))
+						return false;
+				}
+				else {
+					uint32_t count = (matrix && (operand == rowsOperand)) ? rows : 1;
+					for (uint32_t reg = number; reg < number + count; reg++) {
+						if (reg >= floatRegisterCount)
+							return Fail("constant register out of range");
+						m_registerUsed[reg] = true;
+						if (m_stereoIndex[reg] == NO_REGISTER)
+							continue;
+
+						stereoRead[m_stereoIndex[reg]] = true;
+						if (count > 1)
+							matrixStereo = true;
+						else {
+							uint32_t select = 0;
+							while ((select < selectCount) && (selected[select] != reg))
+								select++;
+							if (select == selectCount)
+								selected[selectCount++] = reg;
+						}
+					}
+				}
+				break;
+			case REGTYPE_CONST2:
+			case REGTYPE_CONST3:
+			case REGTYPE_CONST4:
+				return Fail("constant register out of range");
+			case REGTYPE_RASTOUT:
+				if (!shaderModel3 && (operand == 0) && (number == RASTOUT_POSITION))
+					positionMask |= WRITEMASK(parameter);
+				break;
+			case REGTYPE_OUTPUT:
+				if (relative)
+					return Fail("relative output addressing not supported");
+				if (shaderModel3 && (number == positionOutput))
+					positionMask |= WRITEMASK(parameter);
+				else if (!shaderModel3 && (number == SIDE_USAGE_INDEX))
+					return Fail("oT7 in use");
+				break;
+			}
+		}
+
+		if (matrixStereo && (instruction & INSTRUCTION_PREDICATED))
+			return Fail("predicated matrix macro reads a stereo constant");
+
+		// selected constants, and the result and row of expanded matrix macros
+		if (selectCount + (matrixStereo ? 2 : 0) > scratchCount)
+			scratchCount = selectCount + (matrixStereo ? 2 : 0);
+	}
+
+	if (firstInstruction == 0)
+		return Fail("no instructions");
+	if (shaderModel3 && (positionOutput == NO_REGISTER))
+		return Fail("no position output");
+	if (positionMask == 0)
+		return Fail("position not written");
+
+	// registers of the patch
+	uint32_t instanceInput = 0;
+	while ((instanceInput < VS_INPUT_COUNT) && (inputs & (1U << instanceInput)))
+		instanceInput++;
+	if (instanceInput == VS_INPUT_COUNT)
+		return Fail("no free input register");
+
+	uint32_t sideOutput = SIDE_USAGE_INDEX;
+	if (shaderModel3) {
+		sideOutput = 0;
+		while ((sideOutput < VS3_OUTPUT_COUNT) && (outputs & (1U << sideOutput)))
+			sideOutput++;
+		if (sideOutput == VS3_OUTPUT_COUNT)
+			return Fail("no free output register");
+	}
+
+	uint32_t positionTemp = tempCount;
+	uint32_t scratchTemp = tempCount + 1;
+	if (scratchTemp + scratchCount > (shaderModel3 ? VS3_TEMP_COUNT : VS2_TEMP_COUNT))
+		return Fail("no free temporary registers");
+
+	// right values of the stereo constants read, in the highest free register ranges
+	for (uint32_t index = 0; index < (uint32_t)stereoConstants.size(); index++) {
+		if (!stereoRead[index])
+			continue;
+
+		const StereoConstant& constant = stereoConstants[index];
+		uint32_t right = floatRegisterCount - constant.count + 1;
+		uint32_t freeCount = 0;
+		while ((freeCount < constant.count) && (right > 0)) {
+			right--;
+			freeCount = 0;
+			while ((freeCount < constant.count) && !m_registerUsed[right + freeCount])
+				freeCount++;
+		}
+		if (freeCount < constant.count)
+			return Fail("no free float registers for the right constants");
+
+		m_rightRegisters[index] = right;
+		for (uint32_t reg = 0; reg < constant.count; reg++) {
+			m_registerUsed[right + reg] = true;
+			m_rightOf[constant.startRegister + reg] = right + reg;
+		}
+	}
+
+	// declarations and definitions, then the added declarations
+	m_function.reserve(tokenCount * 2);
+	m_function.assign(pTokens, pTokens + firstInstruction);
+	Emit(OPCODE_DCL, 2, PARAMETER_TOKEN | DECLUSAGE_TEXCOORD | (INSTANCE_USAGE_INDEX << 16), Parameter(REGTYPE_INPUT, instanceInput, WRITEMASK_ALL));
+	if (shaderModel3)
+		Emit(OPCODE_DCL, 2, PARAMETER_TOKEN | DECLUSAGE_TEXCOORD | (SIDE_USAGE_INDEX << 16), Parameter(REGTYPE_OUTPUT, sideOutput, WRITEMASK_ALL));
+
+	// components of the position the shader does not write (w = 0.5 like the instance data, x is moved)
+	if (positionMask != WRITEMASK_ALL)
+		Emit(OPCODE_MOV, 2, Parameter(REGTYPE_TEMP, positionTemp, WRITEMASK_ALL), Parameter(REGTYPE_INPUT, instanceInput, SWIZZLE_WWWW));
+
+	for (size_t token = firstInstruction; token < end;) {
+		uint32_t instruction = pTokens[token];
+		uint32_t opcode = instruction & 0xFFFF;
+		size_t length = (opcode == OPCODE_COMMENT) ? COMMENT_LENGTH(instruction) : INSTRUCTION_LENGTH(instruction);
+		const uint32_t* pParameters = pTokens + token + 1;
+
+		if ((opcode == OPCODE_COMMENT) || (opcode == OPCODE_DCL) || (opcode == OPCODE_DEF) || (opcode == OPCODE_DEFI) || (opcode == OPCODE_DEFB)) {
+			m_function.insert(m_function.end(), pTokens + token, pTokens + token + 1 + length);
+			token += 1 + length;
+			continue;
+		}
+		token += 1 + length;
+
+		uint32_t rows = 0;
+		uint32_t rowOpcode = 0;
+		bool matrix = MatrixMacro(opcode, &rows, &rowOpcode);
+		uint32_t rowsOperand = (instruction & INSTRUCTION_PREDICATED) ? 3 : 2;
+		size_t rowsParameter = 0;
+		size_t source0Parameter = 0;
+		bool matrixStereo = false;
+		uint32_t patched[MAX_INSTRUCTION_LENGTH];
+		uint32_t selected[MAX_INSTRUCTION_LENGTH];
+		uint32_t selectCount = 0;
+
+		for (size_t parameterIndex = 0, operand = 0; parameterIndex < length; parameterIndex++, operand++) {
+			uint32_t parameter = pParameters[parameterIndex];
+			uint32_t type = PARAMETER_TYPE(parameter);
+			uint32_t number = PARAMETER_NUMBER(parameter);
+			bool relative = ((parameter & ADDRMODE_RELATIVE) != 0);
+			patched[parameterIndex] = parameter;
+
+			if (matrix && (operand == rowsOperand - 1))
+				source0Parameter = parameterIndex;
+
+			if ((type == REGTYPE_CONST) && !relative) {
+				if (matrix && (operand == rowsOperand)) {
+					rowsParameter = parameterIndex;
+					for (uint32_t reg = number; reg < number + rows; reg++)
+						matrixStereo |= (m_rightOf[reg] != NO_REGISTER);
+				}
+				else if (m_rightOf[number] != NO_REGISTER) {
+					uint32_t select = 0;
+					while ((select < selectCount) && (selected[select] != number))
+						select++;
+					if (select == selectCount)
+						selected[selectCount++] = number;
+					patched[parameterIndex] = Retarget(parameter, REGTYPE_TEMP, scratchTemp + select);
+				}
+			}
+			else if ((operand == 0) && (shaderModel3 ? ((type == REGTYPE_OUTPUT) && (number == positionOutput)) : ((type == REGTYPE_RASTOUT) && (number == RASTOUT_POSITION))))
+				patched[parameterIndex] = Retarget(parameter, REGTYPE_TEMP, positionTemp);
+
+			if (relative) {
+				parameterIndex++;
+				patched[parameterIndex] = pParameters[parameterIndex];
+			}
+		}
+
+		for (uint32_t select = 0; select < selectCount; select++)
+			EmitSelect(scratchTemp + select, selected[select], instanceInput);
+
+		if (!matrixStereo) {
+			m_function.push_back(instruction);
+			m_function.insert(m_function.end(), patched, patched + length);
+			continue;
+		}
+
+		// expand the matrix macro, one dot product per row into the result, then move the result
+		// to the destination (write mask and modifiers of the macro)
+		uint32_t resultTemp = scratchTemp + selectCount;
+		uint32_t rowTemp = resultTemp + 1;
+		uint32_t rowsToken = pParameters[rowsParameter];
+		size_t source0Length = rowsParameter - source0Parameter;
+		for (uint32_t row = 0; row < rows; row++) {
+			uint32_t reg = PARAMETER_NUMBER(rowsToken) + row;
+			uint32_t rowSource = Retarget(rowsToken, REGTYPE_CONST, reg);
+			if (m_rightOf[reg] != NO_REGISTER) {
+				EmitSelect(rowTemp, reg, instanceInput);
+				rowSource = Retarget(rowsToken, REGTYPE_TEMP, rowTemp);
+			}
+
+			m_function.push_back(rowOpcode | (uint32_t)((2 + source0Length) << 24));
+			m_function.push_back(Parameter(REGTYPE_TEMP, resultTemp, 1U << row));
+			m_function.insert(m_function.end(), patched + source0Parameter, patched + rowsParameter);
+			m_function.push_back(rowSource);
+		}
+		Emit(OPCODE_MOV, 2, patched[0], Parameter(REGTYPE_TEMP, resultTemp, SWIZZLE_XYZW));
+	}
+
+	// x = (x + side * w) / 2, then the position and the side distance (x of the eye's half, positive inside)
+	Emit(OPCODE_MAD, 4, Parameter(REGTYPE_TEMP, scratchTemp, 0x1), Parameter(REGTYPE_TEMP, positionTemp, SWIZZLE_WWWW),
+		Parameter(REGTYPE_INPUT, instanceInput, SWIZZLE_ZZZZ), Parameter(REGTYPE_TEMP, positionTemp, SWIZZLE_XXXX));
+	Emit(OPCODE_MUL, 3, Parameter(REGTYPE_TEMP, positionTemp, 0x1), Parameter(REGTYPE_TEMP, scratchTemp, SWIZZLE_XXXX),
+		Parameter(REGTYPE_INPUT, instanceInput, SWIZZLE_WWWW));
+	if (shaderModel3)
+		Emit(OPCODE_MOV, 2, Parameter(REGTYPE_OUTPUT, positionOutput, positionDeclarationMask), Parameter(REGTYPE_TEMP, positionTemp, SWIZZLE_XYZW));
+	else
+		Emit(OPCODE_MOV, 2, Parameter(REGTYPE_RASTOUT, RASTOUT_POSITION, WRITEMASK_ALL), Parameter(REGTYPE_TEMP, positionTemp, SWIZZLE_XYZW));
+	Emit(OPCODE_MUL, 3, Parameter(REGTYPE_OUTPUT, sideOutput, WRITEMASK_ALL), Parameter(REGTYPE_TEMP, positionTemp, SWIZZLE_XXXX),
+		Parameter(REGTYPE_INPUT, instanceInput, SWIZZLE_ZZZZ));
+	m_function.push_back(END_TOKEN);
+
+	return true;
+}
+
+/**
+* Patches a pixel shader for instanced stereo.
+* The patched shader declares TEXCOORD7 (the distance to the middle of the target written by patched vertex
+* shaders) and kills pixels on the other eye's half of the target.
+* @param pFunction The pixel shader function, as passed to CreatePixelShader().
+* @param sizeOfData Size of the function in bytes.
+* @return False if the shader can not be patched (Error()).
+***/
+bool StereoShaderPatcher::PatchPixelShader(const void* pFunction, size_t sizeOfData)
+{
+	m_function.clear();
+	m_rightRegisters.clear();
+	m_error = "";
+
+	if (!m_bytecode.Parse(pFunction, sizeOfData) || !m_bytecode.IsPixelShader())
+		return Fail("no pixel shader function");
+	if (m_bytecode.MajorVersion() < 2)
+		return Fail("shader model 1 not supported");
+
+	const uint32_t* pTokens = static_cast<const uint32_t*>(pFunction);
+	size_t tokenCount = sizeOfData / sizeof(uint32_t);
+	bool shaderModel3 = (m_bytecode.MajorVersion() >= 3);
+
+	uint32_t inputs = 0;
+	size_t firstInstruction = 0;
+	size_t end = tokenCount;
+
+	for (size_t token = 1; token < tokenCount;) {
+		uint32_t instruction = pTokens[token];
+		uint32_t opcode = instruction & 0xFFFF;
+
+		if (opcode == OPCODE_END) {
+			end = token;
+			break;
+		}
+		if (opcode == OPCODE_COMMENT) {
+			token += 1 + COMMENT_LENGTH(instruction);
+			continue;
+		}
+
+		size_t start = token;
+		size_t length = INSTRUCTION_LENGTH(instruction);
+		const uint32_t* pParameters = pTokens + start + 1;
+		token += 1 + length;
+
+		if (opcode == OPCODE_DCL) {
+			if (length < 2)
+				return Fail("damaged dcl instruction");
+
+			uint32_t usage = pParameters[0];
+			uint32_t parameter = pParameters[1];
+			uint32_t number = PARAMETER_NUMBER(parameter);
+			if (shaderModel3 && (PARAMETER_TYPE(parameter) == REGTYPE_INPUT)) {
+				if (number < PS3_INPUT_COUNT)
+					inputs |= 1U << number;
+				if ((DCL_USAGE(usage) == DECLUSAGE_TEXCOORD) && (DCL_USAGE_INDEX(usage) == SIDE_USAGE_INDEX))
+					return Fail("TEXCOORD7 input in use");
+			}
+			else if (!shaderModel3 && (PARAMETER_TYPE(parameter) == REGTYPE_TEXTURE) && (number == SIDE_USAGE_INDEX))
+				return Fail("t7 in use");
+			continue;
+		}
+
+		if ((opcode != OPCODE_DEF) && (opcode != OPCODE_DEFI) && (opcode != OPCODE_DEFB) && (firstInstruction == 0))
+			firstInstruction = start;
+	}
+
+	if (firstInstruction == 0)
+		return Fail("no instructions");
+
+	uint32_t sideType = REGTYPE_TEXTURE;
+	uint32_t sideInput = SIDE_USAGE_INDEX;
+	uint32_t usage = PARAMETER_TOKEN;
+	if (shaderModel3) {
+		sideType = REGTYPE_INPUT;
+		sideInput = 0;
+		while ((sideInput < PS3_INPUT_COUNT) && (inputs & (1U << sideInput)))
+			sideInput++;
+		if (sideInput == PS3_INPUT_COUNT)
+			return Fail("no free input register");
+		usage |= DECLUSAGE_TEXCOORD | (SIDE_USAGE_INDEX << 16);
+	}
+
+	m_function.reserve(end + 5);
+	m_function.assign(pTokens, pTokens + firstInstruction);
+	Emit(OPCODE_DCL, 2, usage, Parameter(sideType, sideInput, WRITEMASK_ALL));
+	Emit(OPCODE_TEXKILL, 1, Parameter(sideType, sideInput, WRITEMASK_ALL));
+	m_function.insert(m_function.end(), pTokens + firstInstruction, pTokens + end);
+	m_function.push_back(END_TOKEN);
+
+	return true;
+}
+
+/**
+* The patched function of the last successful patch.
+***/
+const std::vector<uint32_t>& StereoShaderPatcher::Function() const
+{
+	return m_function;
+}
+
+/**
+* Right start register of each stereo constant passed to PatchVertexShader(), NO_REGISTER for constants the
+* shader does not read. The right values have to be set there before instanced draws.
+***/
+const std::vector<uint32_t>& StereoShaderPatcher::RightRegisters() const
+{
+	return m_rightRegisters;
+}
+
+/**
+* Why the last patch failed, empty if it succeeded.
+***/
+const char* StereoShaderPatcher::Error() const
+{
+	return m_error;
+}
+
+/**
+* Per instance data of the patched vertex shaders: right weight, left weight, side (-1 left, 1 right), 0.5.
+* @param instance 0 for the left eye, 1 for the right eye.
+* @param data Receives the four floats.
+***/
+void StereoShaderPatcher::InstanceData(uint32_t instance, float data[4])
+{
+	data[0] = instance ? 1.0f : 0.0f;
+	data[1] = instance ? 0.0f : 1.0f;
+	data[2] = instance ? 1.0f : -1.0f;
+	data[3] = 0.5f;
+}
+
+/**
+* Sets the error of the patch and drops the partly patched function.
+* @return False, to return from the patch methods.
+***/
+bool StereoShaderPatcher::Fail(const char* error)
+{
+	m_error = error;
+	m_function.clear();
+	return false;
+}
+
+/**
+* Checks a float constant read relative to an address register, the registers of the constant table entry
+* containing the base register may be read.
+* @return False (Error()) if the base register is not inside a constant of the constant table or the constant
+* overlaps a stereo constant.
+***/
+bool StereoShaderPatcher::CheckRelativeRead(uint32_t baseRegister)
+{
+	const std::vector<ShaderBytecode::Constant>& constants = m_bytecode.Constants();
+	for (auto itConstant = constants.begin(); itConstant != constants.end(); ++itConstant) {
+		if ((itConstant->registerSet != ShaderBytecode::RegisterSet_Float4) ||
+			(baseRegister < itConstant->registerIndex) || (baseRegister >= (uint32_t)itConstant->registerIndex + itConstant->registerCount))
+			continue;
+
+		for (uint32_t reg = itConstant->registerIndex; reg < (uint32_t)itConstant->registerIndex + itConstant->registerCount; reg++) {
+			if ((reg < m_stereoIndex.size()) && (m_stereoIndex[reg] != NO_REGISTER))
+				return Fail("stereo constant read relative to an address register");
+		}
+		return true;
+	}
+
+	return Fail("relative constant read outside the constant table");
+}
+
+/**
+* Appends an instruction.
+***/
+void StereoShaderPatcher::Emit(uint32_t opcode, uint32_t parameterCount, uint32_t parameter0, uint32_t parameter1, uint32_t parameter2, uint32_t parameter3)
+{
+	uint32_t parameters[4] = { parameter0, parameter1, parameter2, parameter3 };
+	m_function.push_back(opcode | (parameterCount << 24));
+	m_function.insert(m_function.end(), parameters, parameters + parameterCount);
+}
+
+/**
+* Appends the selection of a stereo register: temp = left * left weight + right * right weight.
+***/
+void StereoShaderPatcher::EmitSelect(uint32_t temp, uint32_t leftRegister, uint32_t instanceInput)
+{
+	Emit(OPCODE_MUL, 3, Parameter(REGTYPE_TEMP, temp, WRITEMASK_ALL), Parameter(REGTYPE_CONST, leftRegister, SWIZZLE_XYZW),
+		Parameter(REGTYPE_INPUT, instanceInput, SWIZZLE_YYYY));
+	Emit(OPCODE_MAD, 4, Parameter(REGTYPE_TEMP, temp, WRITEMASK_ALL), Parameter(REGTYPE_CONST, m_rightOf[leftRegister], SWIZZLE_XYZW),
+		Parameter(REGTYPE_INPUT, instanceInput, SWIZZLE_XXXX), Parameter(REGTYPE_TEMP, temp, SWIZZLE_XYZW));
+}
@@ -0,0 +1,125 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <StereoShaderPatcher.h> and
+Class <StereoShaderPatcher> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef STEREOSHADERPATCHER_H_INCLUDED
+#define STEREOSHADERPATCHER_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "ShaderBytecode.h"
+
+/**
+* Patches shader model 2 and 3 shaders for single-pass instanced stereo.
+* Each draw is issued once with two instances into a side-by-side render target. The patched vertex
+* shader reads the instance (eye) from an added TEXCOORD15 input, selects the left or right value of
+* every stereo constant it reads (the right values live in free float registers) and moves the clip
+* space position into the left or right half of the target. The distance to the middle of the target
+* goes out as TEXCOORD7, the patched pixel shader kills pixels on the wrong half (one viewport covers
+* both halves, so the clip space x range of an eye is not clipped by the hardware).
+* Shaders the patcher can not handle (subroutines, relative output addressing, stereo constants read
+* relative to an address register, no free registers, ...) fail, and are drawn once per eye as before.
+* Depends on the C++ standard library only (no Direct3D or D3DX headers), so it can be built and
+* run anywhere on captured shader blobs.
+* @see D3DProxyDevice::drawInstancedStereo()
+*/
+class StereoShaderPatcher
+{
+public:
+	StereoShaderPatcher();
+	virtual ~StereoShaderPatcher();
+
+	/**
+	* Usage indices of the added TEXCOORD inputs and outputs.
+	***/
+	enum UsageIndices
+	{
+		INSTANCE_USAGE_INDEX = 15, /**< Vertex shader input, the per instance data (InstanceData()). */
+		SIDE_USAGE_INDEX = 7       /**< Vertex shader output and pixel shader input, the distance to the middle of the target. */
+	};
+
+	/**
+	* Right register of a stereo constant the vertex shader does not read.
+	***/
+	static const uint32_t NO_REGISTER = 0xFFFFFFFF;
+
+	/**
+	* A stereo constant of a vertex shader (left values in the registers the game sets).
+	***/
+	struct StereoConstant
+	{
+		uint32_t startRegister; /**< Start register. */
+		uint32_t count;         /**< Number of registers. */
+	};
+
+	/*** StereoShaderPatcher public methods ***/
+	bool                         PatchVertexShader(const void* pFunction, size_t sizeOfData, const std::vector<StereoConstant>& stereoConstants, uint32_t floatRegisterCount);
+	bool                         PatchPixelShader(const void* pFunction, size_t sizeOfData);
+	const std::vector<uint32_t>& Function() const;
+	const std::vector<uint32_t>& RightRegisters() const;
+	const char*                  Error() const;
+	static void                  InstanceData(uint32_t instance, float data[4]);
+
+private:
+	/*** StereoShaderPatcher private methods ***/
+	bool Fail(const char* error);
+	bool CheckRelativeRead(uint32_t baseRegister);
+	void Emit(uint32_t opcode, uint32_t parameterCount, uint32_t parameter0, uint32_t parameter1 = 0, uint32_t parameter2 = 0, uint32_t parameter3 = 0);
+	void EmitSelect(uint32_t temp, uint32_t leftRegister, uint32_t instanceInput);
+
+	/**
+	* The bytecode parser, checks the function and reads the constant table.
+	***/
+	ShaderBytecode m_bytecode;
+	/**
+	* The patched function.
+	***/
+	std::vector<uint32_t> m_function;
+	/**
+	* Right start register of each stereo constant (NO_REGISTER if not read), in the order passed.
+	***/
+	std::vector<uint32_t> m_rightRegisters;
+	/**
+	* Stereo constant of each float register (NO_REGISTER for mono registers), used while patching.
+	***/
+	std::vector<uint32_t> m_stereoIndex;
+	/**
+	* Right register of each float register (NO_REGISTER for mono registers), used while patching.
+	***/
+	std::vector<uint32_t> m_rightOf;
+	/**
+	* Float registers the shader may read or defines, used while patching.
+	***/
+	std::vector<bool> m_registerUsed;
+	/**
+	* Why the last patch failed, empty after a successful patch.
+	***/
+	const char* m_error;
+};
+#endif
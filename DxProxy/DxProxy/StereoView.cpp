@@ -59,6 +59,7 @@ StereoView::StereoView(ProxyHelper::ProxyConfig& config)
 	
 	// set all member pointers to NULL to prevent uninitialized objects being used
 	m_pActualDevice = NULL;
+	m_pCounters = NULL;
 	backBuffer = NULL;
 	leftTexture = NULL;
 	rightTexture = NULL;
@@ -89,8 +90,10 @@ StereoView::~StereoView()
 /**
 * StereoView init.
 * Must be initialised with an actual device. Not a wrapped device.
+* @param pActualDevice The actual device.
+* @param pCounters Frame counters of the proxy device.
 ***/
-void StereoView::Init(IDirect3DDevice9* pActualDevice)
+void StereoView::Init(IDirect3DDevice9* pActualDevice, ProxyCounterValues* pCounters)
 {
 	OutputDebugString("SteroView Init\n");
 	
@@ -100,6 +103,7 @@ void StereoView::Init(IDirect3DDevice9* pActualDevice)
 	}
 	
 	m_pActualDevice = pActualDevice;
+	m_pCounters = pCounters;
 
 	InitShaderEffects();
 	InitTextureBuffers();
@@ -177,6 +181,8 @@ void StereoView::ReleaseEverything()
 ***/
 void StereoView::Draw(D3D9ProxySurface* stereoCapableSurface)
 {
+	PROXY_PROFILE_SCOPE("StereoView::Draw");
+
 	// Copy left and right surfaces to textures to use as shader input
 	// TODO match aspect ratio of source in target ? 
 	IDirect3DSurface9* leftImage = stereoCapableSurface->getActualLeft();
@@ -189,6 +195,8 @@ void StereoView::Draw(D3D9ProxySurface* stereoCapableSurface)
 	else
 		m_pActualDevice->StretchRect(leftImage, NULL, rightSurface, NULL, D3DTEXF_NONE);
 
+	m_pCounters->stretchRectCopies += 2;
+
 	// TODO figure out HL2 problem. This is a workaround for now
 	// Problem: Using StateBlock to save and restore causes the world in HL2 to scale up and down constantly
 	// This only effects HL2 (but all source games are using the l4d profile).
@@ -32,6 +32,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "ProxyHelper.h"
 #include "D3DProxyDevice.h"
+#include "ProxyCounters.h"
+#include "ProxyProfiler.h"
 #include <d3d9.h>
 #include <d3dx9.h>
 #include <map>
@@ -49,7 +51,7 @@ public:
 	virtual ~StereoView();
 
 	/*** StereoView public methods ***/
-	virtual void Init(IDirect3DDevice9* pActualDevice);
+	virtual void Init(IDirect3DDevice9* pActualDevice, ProxyCounterValues* pCounters);
 	virtual void ReleaseEverything();
 	virtual void Draw(D3D9ProxySurface* stereoCapableSurface);
 	virtual void SaveScreen();
@@ -58,7 +60,7 @@ public:
 	/**
 	* Stereo render options.
 	***/
-	static enum StereoTypes
+	enum StereoTypes
 	{
 		DISABLED = 0,                       /**< Disabled. */
 		ANAGLYPH_RED_CYAN = 1,              /**< Anaglyph render in complementary colors red, cyan. */
@@ -79,7 +81,7 @@ public:
 	/**
 	* Left and right enumeration.
 	***/
-	static enum Eyes
+	enum Eyes
 	{
 		LEFT_EYE,
 		RIGHT_EYE
@@ -133,6 +135,10 @@ protected:
 	***/
 	IDirect3DDevice9* m_pActualDevice;
 	/**
+	* Frame counters of the proxy device, surface copies are counted here.
+	***/
+	ProxyCounterValues* m_pCounters;
+	/**
 	* Saved game vertex shader to be restored after drawing stereoscopic.
 	***/
 	IDirect3DVertexShader9* lastVertexShader;
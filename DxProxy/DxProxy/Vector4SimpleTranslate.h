@@ -46,17 +46,15 @@ public:
 
 	/**
 	* Translates Vector4 to left and right by separation in world units.
+	* Only the first vector is translated, further registers are copied.
 	***/
-	virtual void ApplyModification(const float* inData, std::vector<float>* outLeft, std::vector<float>* outRight)
+	virtual void ApplyModification(const float* inData, float* outLeft, float* outRight, UINT count)
 	{
-		D3DXVECTOR4 tempLeft (inData);
-		D3DXVECTOR4 tempRight (inData);
+		memcpy(outLeft, inData, count * sizeof(float));
+		memcpy(outRight, inData, count * sizeof(float));
 
-		tempLeft[0] += m_spAdjustmentMatrices->SeparationInWorldUnits() * LEFT_CONSTANT;
-		tempRight[0] += m_spAdjustmentMatrices->SeparationInWorldUnits() * RIGHT_CONSTANT;
-
-		outLeft->assign(&tempLeft[0], &tempLeft[0] + outLeft->size());
-		outRight->assign(&tempRight[0], &tempRight[0] + outRight->size());	
+		outLeft[0] += m_spAdjustmentMatrices->SeparationInWorldUnits() * LEFT_CONSTANT;
+		outRight[0] += m_spAdjustmentMatrices->SeparationInWorldUnits() * RIGHT_CONSTANT;
 	}
 };
 #endif
\ No newline at end of file
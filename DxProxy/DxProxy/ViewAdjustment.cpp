@@ -38,7 +38,8 @@ ViewAdjustment::ViewAdjustment(HMDisplayInfo &displayInfo, float metersToWorldUn
 	hmdInfo(displayInfo),
 	metersToWorldMultiplier(metersToWorldUnits),
 	rollEnabled(enableRoll),
-	bulletLabyrinth(false)
+	bulletLabyrinth(false),
+	generation(1)
 {
 	// TODO : max, min convergence; arbitrary now
 	convergence = 0.0f;
@@ -69,6 +70,7 @@ ViewAdjustment::ViewAdjustment(HMDisplayInfo &displayInfo, float metersToWorldUn
 	D3DXMatrixIdentity(&matViewProjTransformLeft);
 	D3DXMatrixIdentity(&matGatheredLeft);
 	D3DXMatrixIdentity(&matGatheredRight);
+	D3DXMatrixIdentity(&matBulletLabyrinth);
 
 	UpdateProjectionMatrices(displayInfo.screenAspectRatio);
 	D3DXMatrixIdentity(&rollMatrix);
@@ -93,6 +95,8 @@ void ViewAdjustment::Load(ProxyHelper::ProxyConfig& cfg)
 	convergence = cfg.convergence;
 	ipd = cfg.ipd;
 	stereoType = cfg.stereo_mode;
+
+	generation++;
 }
 
 /**
@@ -165,27 +169,42 @@ void ViewAdjustment::UpdateProjectionMatrices(float aspectRatio)
 		projectLeft *= leftShiftProjection;
 		projectRight *= rightShiftProjection;
 	}	
+
+	generation++;
 }
 
 /**
 * Updates the current pitch and yaw head movement.
+* The generation is only increased if the matrix actually changed.
 ***/
 void ViewAdjustment::UpdatePitchYaw(float pitch, float yaw)
 {
 	// bullet labyrinth matrix
 	/*float yawRad = D3DXToRadian(yaw);
 	float pitchRad = D3DXToRadian(pitch);*/
-	D3DXMatrixTranslation(&matBulletLabyrinth, -yaw, pitch, 0.0f);
+	D3DXMATRIX newBulletLabyrinth;
+	D3DXMatrixTranslation(&newBulletLabyrinth, -yaw, pitch, 0.0f);
+
+	if (newBulletLabyrinth != matBulletLabyrinth) {
+		matBulletLabyrinth = newBulletLabyrinth;
+		generation++;
+	}
 }
 
 /**
 * Updates the roll matrix, seems to be senseless right now, just calls D3DXMatrixRotationZ().
+* The generation is only increased if the matrix actually changed.
 * @param roll Angle of rotation, in radians.
 ***/
 void ViewAdjustment::UpdateRoll(float roll)
 {
-	D3DXMatrixIdentity(&rollMatrix);
-	D3DXMatrixRotationZ(&rollMatrix, roll);
+	D3DXMATRIX newRollMatrix;
+	D3DXMatrixRotationZ(&newRollMatrix, roll);
+
+	if (newRollMatrix != rollMatrix) {
+		rollMatrix = newRollMatrix;
+		generation++;
+	}
 }
 
 /**
@@ -193,9 +212,17 @@ void ViewAdjustment::UpdateRoll(float roll)
 * Unprojects, shifts view position left/right (using same matricies as (Left/Right)ViewRollAndShift)
 * and reprojects using left/right projection.
 * (matrix = projectionInverse * transform * projection)
+* Always recomputed, the generation is only increased if a computed matrix changed, so a static head
+* pose does not invalidate the memoized stereo constants every frame.
 ***/
 void ViewAdjustment::ComputeViewTransforms()
 {
+	const D3DXMATRIX previous[] = {
+		transformLeft, transformRight, matViewProjTransformLeft, matViewProjTransformRight,
+		matSquash, matHudDistance, matLeftHud3DDepth, matRightHud3DDepth,
+		matLeftHud3DDepthShifted, matRightHud3DDepthShifted, matLeftGui3DDepth, matRightGui3DDepth
+	};
+
 	// if (HMD)
 	D3DXMatrixTranslation(&transformLeft, SeparationInWorldUnits() * LEFT_CONSTANT, 0, 0);
 	D3DXMatrixTranslation(&transformRight, SeparationInWorldUnits() * RIGHT_CONSTANT, 0, 0);
@@ -225,6 +252,14 @@ void ViewAdjustment::ComputeViewTransforms()
 	D3DXMatrixTranslation(&matRightHud3DDepthShifted, -hud3DDepth-additionalSeparation, 0, 0);
 	D3DXMatrixTranslation(&matLeftGui3DDepth, gui3DDepth+SeparationIPDAdjustment(), 0, 0);
 	D3DXMatrixTranslation(&matRightGui3DDepth, -(gui3DDepth+SeparationIPDAdjustment()), 0, 0);
+
+	const D3DXMATRIX computed[] = {
+		transformLeft, transformRight, matViewProjTransformLeft, matViewProjTransformRight,
+		matSquash, matHudDistance, matLeftHud3DDepth, matRightHud3DDepth,
+		matLeftHud3DDepthShifted, matRightHud3DDepthShifted, matLeftGui3DDepth, matRightGui3DDepth
+	};
+	if (memcmp(previous, computed, sizeof(computed)) != 0)
+		generation++;
 }
 
 /**
@@ -386,8 +421,11 @@ D3DXMATRIX ViewAdjustment::GatheredMatrixRight()
 ***/
 void ViewAdjustment::GatherMatrix(D3DXMATRIX& matrixLeft, D3DXMATRIX& matrixRight)
 {
-	matGatheredLeft = D3DXMATRIX(matrixLeft);
-	matGatheredRight = D3DMATRIX(matrixRight);
+	if ((matrixLeft != matGatheredLeft) || (matrixRight != matGatheredRight)) {
+		matGatheredLeft = D3DXMATRIX(matrixLeft);
+		matGatheredRight = D3DMATRIX(matrixRight);
+		generation++;
+	}
 }
 
 /**
@@ -407,6 +445,7 @@ float ViewAdjustment::ChangeWorldScale(float toAdd)
 	metersToWorldMultiplier+= toAdd;
 
 	vireio::clamp(&metersToWorldMultiplier, 0.0001f, 1000000.0f);
+	generation++;
 
 	return metersToWorldMultiplier;
 }
@@ -419,6 +458,7 @@ float ViewAdjustment::ChangeConvergence(float toAdd)
 	convergence += toAdd;
 
 	vireio::clamp(&convergence, minConvergence, maxConvergence);
+	generation++;
 
 	return convergence;
 }
@@ -431,6 +471,7 @@ void ViewAdjustment::ChangeGUISquash(float newSquash)
 	squash = newSquash;
 
 	D3DXMatrixScaling(&matSquash, squash, squash, 1);
+	generation++;
 }
 
 /**
@@ -442,6 +483,7 @@ void ViewAdjustment::ChangeGUI3DDepth(float newGui3DDepth)
 
 	D3DXMatrixTranslation(&matLeftGui3DDepth, gui3DDepth+SeparationIPDAdjustment(), 0, 0);
 	D3DXMatrixTranslation(&matRightGui3DDepth, -(gui3DDepth+SeparationIPDAdjustment()), 0, 0);
+	generation++;
 }
 
 /**
@@ -452,6 +494,7 @@ void ViewAdjustment::ChangeHUDDistance(float newHudDistance)
 	hudDistance = newHudDistance;
 
 	D3DXMatrixTranslation(&matHudDistance, 0, 0, hudDistance);
+	generation++;
 }
 
 /**
@@ -466,6 +509,7 @@ void ViewAdjustment::ChangeHUD3DDepth(float newHud3DDepth)
 	float additionalSeparation = (1.5f-hudDistance)*hmdInfo.lensXCenterOffset;
 	D3DXMatrixTranslation(&matLeftHud3DDepthShifted, hud3DDepth+additionalSeparation, 0, 0);
 	D3DXMatrixTranslation(&matRightHud3DDepthShifted, -hud3DDepth-additionalSeparation, 0, 0);
+	generation++;
 }
 
 /**
@@ -474,6 +518,7 @@ void ViewAdjustment::ChangeHUD3DDepth(float newHud3DDepth)
 void ViewAdjustment::SetBulletLabyrinthMode(bool newMode)
 {
 	bulletLabyrinth = newMode;
+	generation++;
 }
 
 /**
@@ -490,6 +535,7 @@ bool ViewAdjustment::BulletLabyrinthMode()
 void ViewAdjustment::ResetWorldScale()
 {
 	metersToWorldMultiplier = 3.0f;
+	generation++;
 }
 
 /**
@@ -498,6 +544,7 @@ void ViewAdjustment::ResetWorldScale()
 void ViewAdjustment::ResetConvergence()
 {
 	convergence = 3.0f;
+	generation++;
 }
 
 /**
@@ -547,4 +594,13 @@ bool ViewAdjustment::RollEnabled()
 HMDisplayInfo ViewAdjustment::HMDInfo()
 {
 	return hmdInfo;
+}
+
+/**
+* Returns the generation of the adjustment data.
+* Changes whenever anything a constant modification might use changes.
+***/
+UINT ViewAdjustment::Generation()
+{
+	return generation;
 }
\ No newline at end of file
@@ -98,6 +98,7 @@ public:
 	float         SeparationIPDAdjustment();
 	bool          RollEnabled();
 	HMDisplayInfo HMDInfo();	
+	UINT          Generation();
 
 private:
 	/*** Projection Matrix variables ***/
@@ -251,6 +252,11 @@ private:
 	* True if "bullet-labyrinth-style" GUI/HUD rotation is active.
 	***/
 	bool bulletLabyrinth;
+	/**
+	* Generation of the adjustment data, increased on every change.
+	* Never 0, lets constant modifications skip the recomputation if it did not change.
+	***/
+	UINT generation;
 
 };
 #endif
\ No newline at end of file
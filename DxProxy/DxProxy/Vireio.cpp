@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "D3D9ProxyVolumeTexture.h"
 #include "D3D9ProxyCubeTexture.h"
 #include "Vireio.h"
+#include <xmmintrin.h>
 
 namespace vireio {
 
@@ -107,4 +108,119 @@ namespace vireio {
 	{
 		*pfToClamp > max ? *pfToClamp = max : (*pfToClamp < min ? *pfToClamp = min : *pfToClamp = *pfToClamp);
 	}
+
+	/**
+	* Returns the number of vertices (or indices) drawn for the specified primitive count.
+	* @param primitiveType [in] The primitive type.
+	* @param primitiveCount [in] The number of primitives.
+	***/
+	UINT VertexCount(D3DPRIMITIVETYPE primitiveType, UINT primitiveCount)
+	{
+		switch (primitiveType)
+		{
+		case D3DPT_POINTLIST:
+			return primitiveCount;
+		case D3DPT_LINELIST:
+			return primitiveCount * 2;
+		case D3DPT_LINESTRIP:
+			return primitiveCount + 1;
+		case D3DPT_TRIANGLELIST:
+			return primitiveCount * 3;
+		case D3DPT_TRIANGLESTRIP:
+		case D3DPT_TRIANGLEFAN:
+			return primitiveCount + 2;
+		default:
+			return 0;
+		}
+	}
+
+	/**
+	* Returns the index of a sampler in sampler tables of size SAMPLER_COUNT.
+	* Pixel shader samplers 0..15, D3DDMAPSAMPLER 16, D3DVERTEXTEXTURESAMPLER0..3 17..20.
+	* @param sampler [in] The sampler (or texture stage) as passed to the device.
+	* @return The sampler index, -1 if the sampler is invalid.
+	***/
+	int SamplerIndex(DWORD sampler)
+	{
+		if (sampler < 16)
+			return (int)sampler;
+
+		if ((sampler >= D3DDMAPSAMPLER) && (sampler <= D3DVERTEXTEXTURESAMPLER3))
+			return (int)(sampler - D3DDMAPSAMPLER) + 16;
+
+		return -1;
+	}
+
+	/**
+	* Returns the sampler (or texture stage) as passed to the device for a sampler index.
+	* @param samplerIndex [in] The sampler index, see SamplerIndex().
+	***/
+	DWORD SamplerFromIndex(int samplerIndex)
+	{
+		if (samplerIndex < 16)
+			return (DWORD)samplerIndex;
+
+		return (DWORD)(samplerIndex - 16) + D3DDMAPSAMPLER;
+	}
+
+	/**
+	* Multiplies a 4x4 matrix by a left and a right matrix in one pass (SSE).
+	* Not transposed : outLeft = in * left, outRight = in * right.
+	* Transposed (in holds a transposed matrix, the results are stored transposed) :
+	* outLeft = (in^T * left)^T = left^T * in, same for right. No data is transposed, the kernel
+	* reads the left and right matrices column wise instead.
+	* All matrices are row-major, 16 floats, no alignment needed. Outputs must not overlap the input.
+	* @param pIn [in] Input matrix.
+	* @param pLeft [in] Left matrix.
+	* @param pRight [in] Right matrix.
+	* @param transposed [in] True if the input is stored transposed.
+	* @param pOutLeft [out] Left result.
+	* @param pOutRight [out] Right result.
+	***/
+	void StereoMatrixMultiply(const float* pIn, const float* pLeft, const float* pRight, bool transposed, float* pOutLeft, float* pOutRight)
+	{
+		if (!transposed) {
+			// row i of the result = sum over k of in(i, k) * row k of the matrix
+			__m128 left0 = _mm_loadu_ps(pLeft);
+			__m128 left1 = _mm_loadu_ps(pLeft + 4);
+			__m128 left2 = _mm_loadu_ps(pLeft + 8);
+			__m128 left3 = _mm_loadu_ps(pLeft + 12);
+			__m128 right0 = _mm_loadu_ps(pRight);
+			__m128 right1 = _mm_loadu_ps(pRight + 4);
+			__m128 right2 = _mm_loadu_ps(pRight + 8);
+			__m128 right3 = _mm_loadu_ps(pRight + 12);
+
+			for (int row = 0; row < 4; row++) {
+				__m128 in0 = _mm_set1_ps(pIn[row * 4]);
+				__m128 in1 = _mm_set1_ps(pIn[row * 4 + 1]);
+				__m128 in2 = _mm_set1_ps(pIn[row * 4 + 2]);
+				__m128 in3 = _mm_set1_ps(pIn[row * 4 + 3]);
+
+				__m128 outLeft = _mm_add_ps(_mm_add_ps(_mm_mul_ps(in0, left0), _mm_mul_ps(in1, left1)),
+					_mm_add_ps(_mm_mul_ps(in2, left2), _mm_mul_ps(in3, left3)));
+				__m128 outRight = _mm_add_ps(_mm_add_ps(_mm_mul_ps(in0, right0), _mm_mul_ps(in1, right1)),
+					_mm_add_ps(_mm_mul_ps(in2, right2), _mm_mul_ps(in3, right3)));
+
+				_mm_storeu_ps(pOutLeft + row * 4, outLeft);
+				_mm_storeu_ps(pOutRight + row * 4, outRight);
+			}
+		}
+		else {
+			// row i of the result = sum over k of matrix(k, i) * row k of in
+			__m128 in0 = _mm_loadu_ps(pIn);
+			__m128 in1 = _mm_loadu_ps(pIn + 4);
+			__m128 in2 = _mm_loadu_ps(pIn + 8);
+			__m128 in3 = _mm_loadu_ps(pIn + 12);
+
+			for (int row = 0; row < 4; row++) {
+				__m128 outLeft = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pLeft[row]), in0), _mm_mul_ps(_mm_set1_ps(pLeft[4 + row]), in1)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pLeft[8 + row]), in2), _mm_mul_ps(_mm_set1_ps(pLeft[12 + row]), in3)));
+				__m128 outRight = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pRight[row]), in0), _mm_mul_ps(_mm_set1_ps(pRight[4 + row]), in1)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pRight[8 + row]), in2), _mm_mul_ps(_mm_set1_ps(pRight[12 + row]), in3)));
+
+				_mm_storeu_ps(pOutLeft + row * 4, outLeft);
+				_mm_storeu_ps(pOutRight + row * 4, outRight);
+			}
+		}
+	}
 };
\ No newline at end of file
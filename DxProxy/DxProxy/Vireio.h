@@ -36,6 +36,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 // 64mm in meters
 #define IPD_DEFAULT 0.064f
+// 16 pixel shader samplers, displacement map sampler, 4 vertex texture samplers
+#define SAMPLER_COUNT 21
+// vertex streams
+#define STREAM_COUNT 16
 
 /**
 * Vireio helper namespace.
@@ -57,5 +61,9 @@ namespace vireio {
 	void UnWrapTexture(IDirect3DBaseTexture9* pWrappedTexture, IDirect3DBaseTexture9** ppActualLeftTexture, IDirect3DBaseTexture9** ppActualRightTexture);
 	bool AlmostSame(float a, float b, float epsilon);
 	void clamp(float* toClamp, float min, float max);
+	UINT VertexCount(D3DPRIMITIVETYPE primitiveType, UINT primitiveCount);
+	int  SamplerIndex(DWORD sampler);
+	DWORD SamplerFromIndex(int samplerIndex);
+	void StereoMatrixMultiply(const float* pIn, const float* pLeft, const float* pRight, bool transposed, float* pOutLeft, float* pOutRight);
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,396 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <CallTraceTest.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "CallTraceReplayer.h"
+#include "ShaderBlob.h"
+#include "TestCheck.h"
+#include "TraceWriter.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+* Tests of the call trace reader and replayer on traces written as CallTrace writes them.
+***/
+
+typedef CallTraceFormat F;
+
+/**
+* Records the replayed calls, objects are indices into the created definitions.
+***/
+class MockTraceDevice : public TraceDevice
+{
+public:
+	struct Call
+	{
+		uint32_t              call;
+		std::vector<uint32_t> args;
+		void*                 objects[F::MAX_ARGS];
+		std::vector<uint8_t>  data;
+	};
+
+	virtual void* Create(const CallTraceReader::Record& definition)
+	{
+		m_created.push_back(definition.call);
+		m_createdIds.push_back(definition.args[0]);
+		return reinterpret_cast<void*>((uintptr_t)m_created.size());
+	}
+
+	virtual void Execute(const CallTraceReader::Record& record, void* const* pObjects)
+	{
+		Call call;
+		call.call = record.call;
+		call.args.assign(record.args, record.args + F::MAX_ARGS);
+		memcpy(call.objects, pObjects, sizeof(call.objects));
+		if (record.pData)
+			call.data.assign(record.pData, record.pData + record.dataSize);
+		m_calls.push_back(call);
+	}
+
+	/**
+	* Handle the device returned for an object ID, NULL if not created.
+	***/
+	void* Handle(uint32_t id) const
+	{
+		for (size_t i = 0; i < m_createdIds.size(); i++)
+			if (m_createdIds[i] == id)
+				return reinterpret_cast<void*>((uintptr_t)(i + 1));
+		return NULL;
+	}
+
+	size_t Count(uint32_t call) const
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < m_calls.size(); i++)
+			if (m_calls[i].call == call)
+				count++;
+		return count;
+	}
+
+	std::vector<uint32_t> m_created;
+	std::vector<uint32_t> m_createdIds;
+	std::vector<Call>     m_calls;
+};
+
+static ShaderBlob VertexShader()
+{
+	ShaderBlob blob(ShaderBlob::VS(2, 0));
+	blob.Instruction(ShaderBlob::Op_Dcl, {0x80000000, ShaderBlob::Dst(ShaderBlob::Reg_Input, 0)});
+	blob.Instruction(ShaderBlob::Op_Dp4, {ShaderBlob::Dst(ShaderBlob::Reg_RastOut, 0), ShaderBlob::Src(ShaderBlob::Reg_Input, 0), ShaderBlob::Src(ShaderBlob::Reg_Const, 0)});
+	blob.End();
+	return blob;
+}
+
+static ShaderBlob PixelShader()
+{
+	ShaderBlob blob(ShaderBlob::PS(2, 0));
+	blob.Instruction(ShaderBlob::Op_Mov, {ShaderBlob::Dst(ShaderBlob::Reg_ColorOut, 0), ShaderBlob::Src(ShaderBlob::Reg_Const, 0)});
+	blob.End();
+	return blob;
+}
+
+/**
+* Position float3 at stream 0, D3DDECL_END.
+***/
+static const uint8_t declaration[16] = {0, 0, 0, 0, 2, 0, 0, 0, 0xFF, 0, 0, 0, 17, 0, 0, 0};
+
+/**
+* Two frames of a game : definitions on first use, state, constants and draws.
+***/
+static TraceWriter ValidTrace()
+{
+	ShaderBlob vs = VertexShader();
+	ShaderBlob ps = PixelShader();
+	float constants[16] = {1.0f, 2.0f, 3.0f, 4.0f};
+	float matrix[16] = {1.0f, 0, 0, 0, 0, 1.0f, 0, 0, 0, 0, 1.0f, 0, 0, 0, 0, 1.0f};
+	uint32_t rects[8] = {0, 0, 64, 64, 0, 0, 32, 32};
+	uint8_t vertices[3 * 12] = {0};
+
+	TraceWriter trace;
+	trace.Record(F::Call_BeginScene, {});
+	trace.Record(F::Call_Clear, {0, 7, 0xFF000000, 0x3F800000, 0});
+	trace.Record(F::Call_DefineVertexDeclaration, {1}, declaration, sizeof(declaration));
+	trace.Record(F::Call_SetVertexDeclaration, {1});
+	trace.Record(F::Call_DefineVertexShader, {2}, vs.Data(), vs.Size());
+	trace.Record(F::Call_SetVertexShader, {2});
+	trace.Record(F::Call_DefinePixelShader, {3}, ps.Data(), ps.Size());
+	trace.Record(F::Call_SetPixelShader, {3});
+	trace.Record(F::Call_DefineVertexBuffer, {4, 4096, 8, 0, 0});
+	trace.Record(F::Call_SetStreamSource, {0, 4, 0, 12});
+	trace.Record(F::Call_DefineIndexBuffer, {5, 1024, 8, 101, 0});
+	trace.Record(F::Call_SetIndices, {5});
+	trace.Record(F::Call_DefineTexture, {6, 256, 256, 9, 0, 21, 1});
+	trace.Record(F::Call_SetTexture, {0, 6});
+	trace.Record(F::Call_SetTexture, {1, 0});
+	trace.Record(F::Call_SetVertexShaderConstantF, {0, 4}, constants, sizeof(constants));
+	trace.Record(F::Call_SetTransform, {256}, matrix, sizeof(matrix));
+	trace.Record(F::Call_DrawIndexedPrimitive, {4, 0, 0, 100, 0, 50});
+	trace.Record(F::Call_DrawPrimitiveUP, {4, 1, 12}, vertices, sizeof(vertices));
+	trace.Record(F::Call_DefineSurface, {7, 64, 64, 21, 1, 0, 0, 0});
+	trace.Record(F::Call_DefineSurface, {8, 32, 32, 21, 1, 0, 0, 0});
+	trace.Record(F::Call_StretchRect, {7, 8, 2, 3}, rects, sizeof(rects));
+	trace.Record(F::Call_EndScene, {});
+	trace.Record(F::Call_Present, {});
+	trace.Record(F::Call_SetVertexShader, {2});
+	trace.Record(F::Call_DrawIndexedPrimitive, {4, 0, 0, 100, 0, 50});
+	trace.Record(F::Call_Present, {});
+	return trace;
+}
+
+static void TestReader()
+{
+	TraceWriter trace = ValidTrace();
+	CallTraceReader reader;
+	CHECK(reader.Open(&trace.m_data[0], trace.m_data.size()));
+
+	CallTraceReader::Record record;
+	CHECK(reader.Next(&record));
+	CHECK(record.call == F::Call_BeginScene && record.argCount == 0 && record.pData == NULL);
+	CHECK(record.index == 0 && record.offset == sizeof(F::Header));
+
+	// trailing zero (stencil) not stored, read as zero
+	CHECK(reader.Next(&record));
+	CHECK(record.call == F::Call_Clear && record.argCount == 4);
+	CHECK(record.args[1] == 7 && record.args[3] == 0x3F800000 && record.args[4] == 0 && record.args[7] == 0);
+	CHECK(record.index == 1 && record.offset == sizeof(F::Header) + sizeof(F::RecordHeader));
+
+	CHECK(reader.Next(&record));
+	CHECK(record.call == F::Call_DefineVertexDeclaration && record.dataSize == sizeof(declaration));
+	CHECK(record.pData && memcmp(record.pData, declaration, sizeof(declaration)) == 0);
+
+	size_t records = 3;
+	while (reader.Next(&record))
+		records++;
+	CHECK(records == 27);
+	CHECK(reader.AtEnd() && reader.Error() == NULL);
+	CHECK(strcmp(CallTraceReader::CallName(F::Call_DefineVertexDeclaration), "DefineVertexDeclaration") == 0);
+	CHECK(strcmp(CallTraceReader::CallName(F::Call_Count), "?") == 0);
+}
+
+static void TestReplay()
+{
+	TraceWriter trace = ValidTrace();
+	CallTraceReader reader;
+	CHECK(reader.Open(&trace.m_data[0], trace.m_data.size()));
+
+	MockTraceDevice device;
+	CallTraceReplayer replayer(&device);
+	CHECK(replayer.Replay(&reader));
+	CHECK(replayer.ErrorCount() == 0 && replayer.Errors().empty());
+	CHECK(replayer.Records() == 27);
+	CHECK(replayer.Frames() == 2);
+	CHECK(replayer.Objects() == 8);
+	CHECK(device.m_created.size() == 8);
+	CHECK(device.m_calls.size() == 19);
+	CHECK(device.Count(F::Call_DrawIndexedPrimitive) == 2);
+	CHECK(device.Count(F::Call_Present) == 2);
+
+	// objects resolved to the handles the device created
+	for (size_t i = 0; i < device.m_calls.size(); i++) {
+		const MockTraceDevice::Call& call = device.m_calls[i];
+		if (call.call == F::Call_SetVertexShader)
+			CHECK(call.objects[0] == device.Handle(2) && call.objects[0] != NULL);
+		if (call.call == F::Call_SetStreamSource)
+			CHECK(call.objects[1] == device.Handle(4) && call.args[3] == 12);
+		if ((call.call == F::Call_SetTexture) && (call.args[0] == 0))
+			CHECK(call.objects[1] == device.Handle(6));
+		if ((call.call == F::Call_SetTexture) && (call.args[0] == 1))
+			CHECK(call.objects[1] == NULL);
+		if (call.call == F::Call_StretchRect)
+			CHECK(call.objects[0] == device.Handle(7) && call.objects[1] == device.Handle(8) && call.data.size() == 32);
+		if (call.call == F::Call_SetVertexShaderConstantF) {
+			float constants[4];
+			CHECK(call.data.size() == 64);
+			if (call.data.size() == 64) {
+				memcpy(constants, &call.data[0], sizeof(constants));
+				CHECK(constants[0] == 1.0f && constants[3] == 4.0f);
+			}
+		}
+	}
+}
+
+/**
+* Returns the number of errors of a trace, the device counts the executed calls.
+***/
+static size_t ReplayErrors(const TraceWriter& trace, MockTraceDevice* pDevice, std::string* pFirstError = NULL)
+{
+	CallTraceReader reader;
+	if (!reader.Open(&trace.m_data[0], trace.m_data.size()))
+		return (size_t)-1;
+
+	CallTraceReplayer replayer(pDevice);
+	bool valid = replayer.Replay(&reader);
+	CHECK(valid == (replayer.ErrorCount() == 0));
+	if (pFirstError && !replayer.Errors().empty())
+		*pFirstError = replayer.Errors()[0];
+	return replayer.ErrorCount();
+}
+
+static void TestInvalidRecords()
+{
+	ShaderBlob vs = VertexShader();
+	ShaderBlob ps = PixelShader();
+	float constants[8] = {0};
+	std::string error;
+
+	// used before definition, not executed
+	{
+		TraceWriter trace;
+		trace.Record(F::Call_SetVertexShader, {2});
+		trace.Record(F::Call_DefineVertexShader, {2}, vs.Data(), vs.Size());
+		trace.Record(F::Call_SetVertexShader, {2});
+		MockTraceDevice device;
+		CHECK(ReplayErrors(trace, &device, &error) == 1);
+		CHECK(error.find("record 0 (SetVertexShader") == 0);
+		CHECK(error.find("used before its definition") != std::string::npos);
+		CHECK(device.m_calls.size() == 1);
+	}
+
+	// defined twice, ID 0 defined
+	{
+		TraceWriter trace;
+		trace.Record(F::Call_DefineVertexBuffer, {4, 4096});
+		trace.Record(F::Call_DefineVertexBuffer, {4, 4096});
+		trace.Record(F::Call_DefineIndexBuffer, {0, 4096});
+		MockTraceDevice device;
+		CHECK(ReplayErrors(trace, &device, &error) == 2);
+		CHECK(error.find("object 4 defined twice") != std::string::npos);
+		CHECK(device.m_created.size() == 1);
+	}
+
+	// wrong object kind
+	{
+		TraceWriter trace;
+		trace.Record(F::Call_DefineSurface, {7, 64, 64, 21});
+		trace.Record(F::Call_SetTexture, {0, 7});
+		trace.Record(F::Call_SetRenderTarget, {0, 7});
+		MockTraceDevice device;
+		CHECK(ReplayErrors(trace, &device, &error) == 1);
+		CHECK(error.find("object 7 is a surface, texture expected") != std::string::npos);
+		CHECK(device.m_calls.size() == 1 && device.m_calls[0].call == F::Call_SetRenderTarget);
+	}
+
+	// payload sizes, argument count
+	{
+		TraceWriter trace;
+		trace.Record(F::Call_SetVertexShaderConstantF, {0, 4}, constants, sizeof(constants));
+		trace.Record(F::Call_SetPixelShaderConstantF, {0, 2}, constants, sizeof(constants));
+		trace.Record(F::Call_SetTransform, {256});
+		trace.Record(F::Call_StretchRect, {0, 0, 2, 1});
+		trace.Record(F::Call_SetRenderState, {7, 1, 5});
+		MockTraceDevice device;
+		CHECK(ReplayErrors(trace, &device, &error) == 3);
+		CHECK(error.find("payload of 32 bytes, 64 expected") != std::string::npos);
+		CHECK(device.m_calls.size() == 2);
+	}
+
+	// shader bytecode and vertex declarations, references to invalid definitions are no further errors
+	{
+		uint32_t damaged[2] = {0xFFFE0200, 0x03000009};
+		uint8_t unterminated[8] = {0, 0, 0, 0, 2, 0, 0, 0};
+		TraceWriter trace;
+		trace.Record(F::Call_DefineVertexShader, {1}, damaged, sizeof(damaged));
+		trace.Record(F::Call_DefineVertexShader, {2}, ps.Data(), ps.Size());
+		trace.Record(F::Call_DefinePixelShader, {3}, ps.Data(), ps.Size());
+		trace.Record(F::Call_DefineVertexDeclaration, {4}, unterminated, sizeof(unterminated));
+		trace.Record(F::Call_DefineVertexDeclaration, {5}, declaration, 12);
+		trace.Record(F::Call_SetVertexShader, {1});
+		trace.Record(F::Call_SetPixelShader, {3});
+		trace.Record(F::Call_SetVertexDeclaration, {4});
+		MockTraceDevice device;
+		CHECK(ReplayErrors(trace, &device, &error) == 4);
+		CHECK(error.find("invalid shader bytecode") != std::string::npos);
+		CHECK(device.m_created.size() == 1 && device.m_created[0] == F::Call_DefinePixelShader);
+		CHECK(device.m_calls.size() == 1 && device.m_calls[0].call == F::Call_SetPixelShader);
+	}
+}
+
+static void TestDamagedTrace()
+{
+	MockTraceDevice device;
+	CallTraceReader reader;
+
+	TraceWriter wrongMagic(0x12345678);
+	CHECK(!reader.Open(&wrongMagic.m_data[0], wrongMagic.m_data.size()));
+	TraceWriter newerVersion(F::TRACE_MAGIC, F::TRACE_VERSION + 1);
+	CHECK(!reader.Open(&newerVersion.m_data[0], newerVersion.m_data.size()));
+	CHECK(!reader.Open(&wrongMagic.m_data[0], 4));
+
+	// empty trace
+	TraceWriter empty;
+	CHECK(ReplayErrors(empty, &device) == 0);
+
+	// truncated last record, the records before are replayed
+	TraceWriter truncated = ValidTrace();
+	truncated.m_data.resize(truncated.m_data.size() - 2);
+	std::string error;
+	CHECK(ReplayErrors(truncated, &device, &error) == 1);
+	CHECK(error.find("truncated record") != std::string::npos);
+	CHECK(device.Count(F::Call_Present) == 1);
+
+	// unknown call
+	TraceWriter unknown;
+	unknown.Record(F::Call_Count, {});
+	CHECK(ReplayErrors(unknown, &device, &error) == 1);
+	CHECK(error.find("unknown call") != std::string::npos);
+
+	// not opened
+	CallTraceReplayer replayer(&device);
+	CHECK(!replayer.Replay(&reader));
+}
+
+static void TestLoad()
+{
+	TraceWriter trace = ValidTrace();
+	const char* fileName = "CallTraceTest.vct";
+	FILE* pFile = fopen(fileName, "wb");
+	CHECK(pFile != NULL);
+	if (!pFile)
+		return;
+	fwrite(&trace.m_data[0], 1, trace.m_data.size(), pFile);
+	fclose(pFile);
+
+	CallTraceReader reader;
+	CHECK(reader.Load(fileName));
+	MockTraceDevice device;
+	CallTraceReplayer replayer(&device);
+	CHECK(replayer.Replay(&reader));
+	CHECK(replayer.Frames() == 2);
+	remove(fileName);
+
+	CHECK(!reader.Load(fileName));
+}
+
+int main()
+{
+	TestReader();
+	TestReplay();
+	TestInvalidRecords();
+	TestDamagedTrace();
+	TestLoad();
+	return TestResult("CallTraceTest");
+}
@@ -0,0 +1,231 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <DeferredRightEyeTest.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ProxyHarness.h"
+#include "TestCheck.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/**
+* Tests of the deferred right eye (StereoCommandList) on the headless proxy : the calls the actual
+* device receives for one recorded frame, and the number of actual device calls with and without it.
+***/
+
+/**
+* Formats a call as MockDevice logs it.
+***/
+static std::string Call(const char* format, ...)
+{
+	char call[256];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(call, sizeof(call), format, args);
+	va_end(args);
+	return call;
+}
+
+/**
+* Returns the logged calls without the Get calls (the proxy reads states back to capture restore commands).
+***/
+static std::vector<std::string> SetCalls(MockDevice* pDevice)
+{
+	std::vector<std::string> calls;
+	for (size_t i = 0; i < pDevice->CallLog().size(); i++)
+		if (pDevice->CallLog()[i].compare(0, 3, "Get") != 0)
+			calls.push_back(pDevice->CallLog()[i]);
+	return calls;
+}
+
+/**
+* Returns the surface bound to the actual device (not referenced).
+***/
+static IDirect3DSurface9* BoundRenderTarget(MockDevice* pDevice)
+{
+	IDirect3DSurface9* pSurface = NULL;
+	pDevice->GetRenderTarget(0, &pSurface);
+	pSurface->Release();
+	return pSurface;
+}
+
+static IDirect3DSurface9* BoundDepthStencil(MockDevice* pDevice)
+{
+	IDirect3DSurface9* pSurface = NULL;
+	pDevice->GetDepthStencilSurface(&pSurface);
+	pSurface->Release();
+	return pSurface;
+}
+
+static IDirect3DBaseTexture9* BoundTexture(MockDevice* pDevice, DWORD stage)
+{
+	IDirect3DBaseTexture9* pTexture = NULL;
+	pDevice->GetTexture(stage, &pTexture);
+	if (pTexture)
+		pTexture->Release();
+	return pTexture;
+}
+
+/**
+* One frame on the stereo back buffer : the left eye is drawn as the game calls, at EndScene the
+* restore commands bring back the states from the beginning of the list, the eye is switched once
+* (right render target and depth stencil) and the list is replayed.
+***/
+static void TestRecordedFrame()
+{
+	ProxyHelper::ProxyConfig config = ProxyHarness::DefaultConfig();
+	config.deferredRightEye = true;
+	ProxyHarness harness(config);
+	IDirect3DDevice9* pProxy = harness.m_pProxy;
+	MockDevice* pDevice = harness.m_pDevice;
+
+	IDirect3DTexture9* pTexture = NULL;
+	CHECK(SUCCEEDED(pProxy->CreateTexture(64, 64, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &pTexture, NULL)));
+
+	// a first frame sets the state the recorded frame starts with
+	pProxy->SetRenderState(D3DRS_CULLMODE, D3DCULL_CCW);
+	pProxy->Present(NULL, NULL, NULL, NULL);
+
+	pDevice->ClearCalls();
+	pDevice->SetRecording(true);
+	pProxy->BeginScene();
+	pProxy->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+	pProxy->SetTexture(0, pTexture);
+	pProxy->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 100, 0, 50);
+	pProxy->SetRenderState(D3DRS_CULLMODE, D3DCULL_CW);
+	pProxy->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 100, 0, 20);
+	IDirect3DSurface9* pLeftTarget = BoundRenderTarget(pDevice);
+	pProxy->EndScene();
+	pDevice->SetRecording(false);
+
+	IDirect3DSurface9* pRightTarget = BoundRenderTarget(pDevice);
+	IDirect3DSurface9* pRightDepthStencil = BoundDepthStencil(pDevice);
+	IDirect3DBaseTexture9* pActualTexture = BoundTexture(pDevice, 0);
+	CHECK(pActualTexture != NULL);
+	CHECK(pRightTarget != pLeftTarget);
+
+	std::vector<std::string> expected;
+	expected.push_back("BeginScene()");
+	// left eye, immediately
+	expected.push_back(Call("SetRenderState(%u,%u)", D3DRS_CULLMODE, D3DCULL_NONE));
+	expected.push_back(Call("SetTexture(0,%p)", pActualTexture));
+	expected.push_back("DrawIndexedPrimitive(4,0,0,100,0,50)");
+	expected.push_back(Call("SetRenderState(%u,%u)", D3DRS_CULLMODE, D3DCULL_CW));
+	expected.push_back("DrawIndexedPrimitive(4,0,0,100,0,20)");
+	// restore commands, the states as they were before the first recorded command touched them
+	expected.push_back(Call("SetRenderState(%u,%u)", D3DRS_CULLMODE, D3DCULL_CCW));
+	expected.push_back(Call("SetTexture(0,%p)", (void*)NULL));
+	// one eye switch
+	expected.push_back(Call("SetRenderTarget(0,%p)", pRightTarget));
+	expected.push_back(Call("SetDepthStencilSurface(%p)", pRightDepthStencil));
+	// right eye, replayed
+	expected.push_back(Call("SetRenderState(%u,%u)", D3DRS_CULLMODE, D3DCULL_NONE));
+	expected.push_back(Call("SetTexture(0,%p)", pActualTexture));
+	expected.push_back("DrawIndexedPrimitive(4,0,0,100,0,50)");
+	expected.push_back(Call("SetRenderState(%u,%u)", D3DRS_CULLMODE, D3DCULL_CW));
+	expected.push_back("DrawIndexedPrimitive(4,0,0,100,0,20)");
+	expected.push_back("EndScene()");
+
+	std::vector<std::string> calls = SetCalls(pDevice);
+	CHECK(calls == expected);
+	if (calls != expected) {
+		for (size_t i = 0; i < calls.size(); i++)
+			fprintf(stderr, "  %s\n", calls[i].c_str());
+	}
+
+	// the restore commands read the states from the actual device
+	CHECK(pDevice->Count("GetRenderState") == 1);
+
+	pTexture->Release();
+}
+
+/**
+* Draws a frame of 32 draws, changing the texture and a render state every drawsPerState draws.
+* Returns the number of actual device calls.
+***/
+static size_t FrameCalls(bool deferred, int drawsPerState, size_t* pDraws)
+{
+	ProxyHelper::ProxyConfig config = ProxyHarness::DefaultConfig();
+	config.deferredRightEye = deferred;
+	ProxyHarness harness(config);
+	IDirect3DDevice9* pProxy = harness.m_pProxy;
+
+	IDirect3DTexture9* pTextures[2] = {NULL, NULL};
+	pProxy->CreateTexture(64, 64, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &pTextures[0], NULL);
+	pProxy->CreateTexture(64, 64, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &pTextures[1], NULL);
+	pProxy->Present(NULL, NULL, NULL, NULL);
+
+	harness.m_pDevice->ClearCalls();
+	pProxy->BeginScene();
+	for (int i = 0; i < 32; i++) {
+		if ((i % drawsPerState) == 0) {
+			pProxy->SetTexture(0, pTextures[(i / drawsPerState) & 1]);
+			pProxy->SetRenderState(D3DRS_ALPHAREF, (DWORD)i);
+		}
+		pProxy->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 100, 0, 50);
+	}
+	pProxy->EndScene();
+
+	size_t calls = harness.m_pDevice->Calls();
+	*pDraws = harness.m_pDevice->Count("DrawIndexedPrimitive");
+
+	pTextures[0]->Release();
+	pTextures[1]->Release();
+	return calls;
+}
+
+/**
+* Immediate stereo switches the eye after every draw (two calls, render target and depth stencil),
+* deferred switches once per list but applies the restore commands and sends each state change twice.
+* So deferred saves calls when several draws share their states, and costs the restore commands when
+* every draw changes states.
+***/
+static void TestCallCounts()
+{
+	int drawsPerState[2] = {1, 4};
+	for (int i = 0; i < 2; i++) {
+		size_t immediateDraws = 0;
+		size_t deferredDraws = 0;
+		size_t immediateCalls = FrameCalls(false, drawsPerState[i], &immediateDraws);
+		size_t deferredCalls = FrameCalls(true, drawsPerState[i], &deferredDraws);
+
+		printf("32 draws, states changed every %d : %u actual device calls immediate, %u deferred\n", drawsPerState[i],
+			(unsigned)immediateCalls, (unsigned)deferredCalls);
+		CHECK(immediateDraws == 64);
+		CHECK(deferredDraws == 64);
+		if (drawsPerState[i] > 1)
+			CHECK(deferredCalls < immediateCalls);
+	}
+}
+
+int main()
+{
+	TestRecordedFrame();
+	TestCallCounts();
+	return TestResult("DeferredRightEyeTest");
+}
@@ -0,0 +1,234 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <InstancedStereoTest.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ProxyHarness.h"
+#include "ShaderBlob.h"
+#include "TestCheck.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/**
+* Tests of single-pass instanced stereo on the headless proxy : which draws reach the actual device as
+* one instanced draw for both eyes and which are drawn per side.
+***/
+
+typedef ShaderBlob B;
+
+/**
+* vs_3_0 transforming the position by c0-c3.
+***/
+static ShaderBlob VertexShader()
+{
+	ShaderBlob blob(B::VS(3, 0));
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Input, 0)});
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Output, 0)});
+	for (uint32_t i = 0; i < 4; i++)
+		blob.Instruction(B::Op_Dp4, {B::Dst(B::Reg_Output, 0, 1 << i), B::Src(B::Reg_Input, 0), B::Src(B::Reg_Const, i)});
+	blob.End();
+	return blob;
+}
+
+/**
+* ps_3_0 writing c0.
+***/
+static ShaderBlob PixelShader()
+{
+	ShaderBlob blob(B::PS(3, 0));
+	blob.Instruction(B::Op_Mov, {B::Dst(B::Reg_ColorOut, 0), B::Src(B::Reg_Const, 0)});
+	blob.End();
+	return blob;
+}
+
+/**
+* Binds shaders, declaration and vertices and starts the side-by-side pass (full clear).
+***/
+class InstancedScene
+{
+public:
+	InstancedScene(ProxyHarness& harness) :
+		m_pProxy(harness.m_pProxy),
+		m_pVertexShader(NULL),
+		m_pPixelShader(NULL),
+		m_pDeclaration(NULL),
+		m_pVertices(NULL)
+	{
+		ShaderBlob vertexShader = VertexShader();
+		ShaderBlob pixelShader = PixelShader();
+		D3DVERTEXELEMENT9 elements[] = {
+			{0, 0, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0},
+			D3DDECL_END()
+		};
+
+		CHECK(SUCCEEDED(m_pProxy->CreateVertexShader((const DWORD*)vertexShader.Data(), &m_pVertexShader)));
+		CHECK(SUCCEEDED(m_pProxy->CreatePixelShader((const DWORD*)pixelShader.Data(), &m_pPixelShader)));
+		CHECK(SUCCEEDED(m_pProxy->CreateVertexDeclaration(elements, &m_pDeclaration)));
+		CHECK(SUCCEEDED(m_pProxy->CreateVertexBuffer(300 * 16, D3DUSAGE_WRITEONLY, 0, D3DPOOL_DEFAULT, &m_pVertices, NULL)));
+
+		m_pProxy->BeginScene();
+		m_pProxy->SetVertexShader(m_pVertexShader);
+		m_pProxy->SetPixelShader(m_pPixelShader);
+		m_pProxy->SetVertexDeclaration(m_pDeclaration);
+		m_pProxy->SetStreamSource(0, m_pVertices, 0, 16);
+		m_pProxy->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER | D3DCLEAR_STENCIL, 0, 1.0f, 0);
+	}
+
+	virtual ~InstancedScene()
+	{
+		m_pProxy->EndScene();
+		m_pProxy->SetVertexShader(NULL);
+		m_pProxy->SetPixelShader(NULL);
+		m_pProxy->SetVertexDeclaration(NULL);
+		m_pProxy->SetStreamSource(0, NULL, 0, 0);
+		m_pVertexShader->Release();
+		m_pPixelShader->Release();
+		m_pDeclaration->Release();
+		m_pVertices->Release();
+	}
+
+	IDirect3DDevice9*            m_pProxy;
+	IDirect3DVertexShader9*      m_pVertexShader;
+	IDirect3DPixelShader9*       m_pPixelShader;
+	IDirect3DVertexDeclaration9* m_pDeclaration;
+	IDirect3DVertexBuffer9*      m_pVertices;
+};
+
+/**
+* The shaders are patched when they are created, not on the first draw.
+***/
+static void TestPatchedOnCreation()
+{
+	ProxyHelper::ProxyConfig config = ProxyHarness::DefaultConfig();
+	config.instancedStereo = true;
+	ProxyHarness harness(config);
+
+	harness.m_pDevice->ClearCalls();
+	harness.m_pDevice->SetRecording(true);
+	ShaderBlob vertexShader = VertexShader();
+	ShaderBlob pixelShader = PixelShader();
+	IDirect3DVertexShader9* pVertexShader = NULL;
+	IDirect3DPixelShader9* pPixelShader = NULL;
+	harness.m_pProxy->CreateVertexShader((const DWORD*)vertexShader.Data(), &pVertexShader);
+	harness.m_pProxy->CreatePixelShader((const DWORD*)pixelShader.Data(), &pPixelShader);
+	harness.m_pDevice->SetRecording(false);
+
+	// the game shader and its patched copy
+	CHECK(harness.m_pDevice->Count("CreateVertexShader") == 2);
+	CHECK(harness.m_pDevice->Count("CreatePixelShader") == 2);
+
+	pVertexShader->Release();
+	pPixelShader->Release();
+}
+
+/**
+* DrawIndexedPrimitive and DrawPrimitive are drawn once with two instances, DrawPrimitive through
+* the sequential indices (the game indices are bound again after the draw).
+***/
+static void TestInstancedDraws()
+{
+	ProxyHelper::ProxyConfig config = ProxyHarness::DefaultConfig();
+	config.instancedStereo = true;
+	ProxyHarness harness(config);
+	MockDevice* pDevice = harness.m_pDevice;
+
+	IDirect3DIndexBuffer9* pIndices = NULL;
+	CHECK(SUCCEEDED(harness.m_pProxy->CreateIndexBuffer(600 * sizeof(WORD), D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_DEFAULT, &pIndices, NULL)));
+	{
+		InstancedScene scene(harness);
+		harness.m_pProxy->SetIndices(pIndices);
+
+		pDevice->ClearCalls();
+		pDevice->SetRecording(true);
+		harness.m_pProxy->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 300, 0, 200);
+		harness.m_pProxy->DrawPrimitive(D3DPT_TRIANGLESTRIP, 10, 100);
+		pDevice->SetRecording(false);
+
+		std::vector<std::string> draws = pDevice->CallLog("Draw");
+		CHECK(draws.size() == 2);
+		if (draws.size() == 2) {
+			CHECK(draws[0] == "DrawIndexedPrimitive(4,0,0,300,0,200)");
+			// triangle strip of 100 triangles : 102 vertices from vertex 10
+			CHECK(draws[1] == "DrawIndexedPrimitive(5,10,0,102,0,100)");
+		}
+
+		// sequential indices for the draw, then the game indices again
+		std::vector<std::string> setIndices = pDevice->CallLog("SetIndices");
+		CHECK(setIndices.size() == 2);
+		if (setIndices.size() == 2) {
+			CHECK(setIndices[0] != setIndices[1]);
+			IDirect3DIndexBuffer9* pActualIndices = NULL;
+			pDevice->GetIndices(&pActualIndices);
+			CHECK(pActualIndices != NULL);
+			if (pActualIndices) {
+				char expected[64];
+				snprintf(expected, sizeof(expected), "SetIndices(%p)", pActualIndices);
+				CHECK(setIndices[1] == expected);
+				pActualIndices->Release();
+			}
+		}
+
+		// two instances for each draw
+		CHECK(pDevice->CallLog("SetStreamSourceFreq(0,40000002)").size() == 2);
+	}
+	pIndices->Release();
+}
+
+/**
+* User pointer draws can not be instanced, they are drawn per side.
+***/
+static void TestUserPointerDrawsPerSide()
+{
+	ProxyHelper::ProxyConfig config = ProxyHarness::DefaultConfig();
+	config.instancedStereo = true;
+	ProxyHarness harness(config);
+	MockDevice* pDevice = harness.m_pDevice;
+
+	float vertices[3 * 4] = {0.0f};
+	WORD indices[3] = {0, 1, 2};
+	{
+		InstancedScene scene(harness);
+
+		pDevice->ClearCalls();
+		pDevice->SetRecording(true);
+		harness.m_pProxy->DrawPrimitiveUP(D3DPT_TRIANGLELIST, 1, vertices, 16);
+		harness.m_pProxy->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST, 0, 3, 1, indices, D3DFMT_INDEX16, vertices, 16);
+		pDevice->SetRecording(false);
+
+		CHECK(pDevice->Count("DrawPrimitiveUP") == 2);
+		CHECK(pDevice->Count("DrawIndexedPrimitiveUP") == 2);
+		CHECK(pDevice->Count("SetStreamSourceFreq") == 0);
+	}
+}
+
+int main()
+{
+	TestPatchedOnCreation();
+	TestInstancedDraws();
+	TestUserPointerDrawsPerSide();
+	return TestResult("InstancedStereoTest");
+}
@@ -0,0 +1,1679 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <MockDevice.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "MockDevice.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+/**
+* Bytes per pixel of a format, compressed formats count one byte (more than they use).
+***/
+static UINT BytesPerPixel(D3DFORMAT format)
+{
+	switch (format)
+	{
+	case D3DFMT_A8:
+	case D3DFMT_L8:
+	case D3DFMT_P8:
+	case D3DFMT_DXT1:
+	case D3DFMT_DXT2:
+	case D3DFMT_DXT3:
+	case D3DFMT_DXT4:
+	case D3DFMT_DXT5:
+		return 1;
+	case D3DFMT_R5G6B5:
+	case D3DFMT_X1R5G5B5:
+	case D3DFMT_A1R5G5B5:
+	case D3DFMT_A4R4G4B4:
+	case D3DFMT_D16:
+	case D3DFMT_L16:
+	case D3DFMT_R16F:
+		return 2;
+	case D3DFMT_A16B16G16R16:
+	case D3DFMT_A16B16G16R16F:
+	case D3DFMT_G32R32F:
+		return 8;
+	case D3DFMT_A32B32G32R32F:
+		return 16;
+	default:
+		return 4;
+	}
+}
+
+/**
+* Size of a mip level.
+***/
+static UINT LevelSize(UINT size, UINT level)
+{
+	size >>= level;
+	return size ? size : 1;
+}
+
+/**
+* Number of mip levels of a full chain (Levels = 0).
+***/
+static UINT FullChainLevels(UINT width, UINT height, UINT depth)
+{
+	UINT size = width > height ? width : height;
+	size = size > depth ? size : depth;
+	UINT levels = 1;
+	while (size > 1) {
+		size >>= 1;
+		levels++;
+	}
+	return levels;
+}
+
+/**
+* Returns the object as container if it has the requested interface.
+***/
+static HRESULT ReturnContainer(IUnknown* pContainer, REFIID riid, void** ppContainer)
+{
+	if (pContainer && ((riid == IID_IDirect3DTexture9) || (riid == IID_IDirect3DCubeTexture9) ||
+		(riid == IID_IDirect3DVolumeTexture9) || (riid == IID_IDirect3DBaseTexture9) || (riid == IID_IDirect3DSwapChain9))) {
+		pContainer->AddRef();
+		*ppContainer = pContainer;
+		return D3D_OK;
+	}
+	*ppContainer = NULL;
+	return E_NOINTERFACE;
+}
+
+/*** MockSurface ***/
+
+MockSurface::MockSurface(MockDevice* pDevice, const D3DSURFACE_DESC& desc, IUnknown* pContainer) :
+	MockResource<IDirect3DSurface9>(pDevice, D3DRTYPE_SURFACE),
+	m_desc(desc),
+	m_pContainer(pContainer),
+	m_data()
+{
+}
+
+HRESULT WINAPI MockSurface::GetContainer(REFIID riid, void** ppContainer)
+{
+	if (!m_pContainer && (riid == IID_IDirect3DDevice9))
+		return GetDevice((IDirect3DDevice9**)ppContainer);
+	return ReturnContainer(m_pContainer, riid, ppContainer);
+}
+
+HRESULT WINAPI MockSurface::LockRect(D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags)
+{
+	UINT pitch = m_desc.Width * BytesPerPixel(m_desc.Format);
+	if (m_data.empty())
+		m_data.resize(pitch * m_desc.Height);
+
+	pLockedRect->Pitch = (INT)pitch;
+	pLockedRect->pBits = &m_data[0];
+	if (pRect)
+		pLockedRect->pBits = &m_data[pRect->top * pitch + pRect->left * BytesPerPixel(m_desc.Format)];
+	return D3D_OK;
+}
+
+/*** MockVolume ***/
+
+HRESULT WINAPI MockVolume::GetDevice(IDirect3DDevice9** ppDevice)
+{
+	*ppDevice = m_pDevice;
+	m_pDevice->AddRef();
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockVolume::GetContainer(REFIID riid, void** ppContainer)
+{
+	return ReturnContainer(m_pContainer, riid, ppContainer);
+}
+
+HRESULT WINAPI MockVolume::LockBox(D3DLOCKED_BOX* pLockedVolume, CONST D3DBOX* pBox, DWORD Flags)
+{
+	UINT rowPitch = m_desc.Width * BytesPerPixel(m_desc.Format);
+	UINT slicePitch = rowPitch * m_desc.Height;
+	if (m_data.empty())
+		m_data.resize(slicePitch * m_desc.Depth);
+
+	pLockedVolume->RowPitch = (INT)rowPitch;
+	pLockedVolume->SlicePitch = (INT)slicePitch;
+	pLockedVolume->pBits = &m_data[0];
+	if (pBox)
+		pLockedVolume->pBits = &m_data[pBox->Front * slicePitch + pBox->Top * rowPitch + pBox->Left * BytesPerPixel(m_desc.Format)];
+	return D3D_OK;
+}
+
+/*** MockTexture ***/
+
+MockTexture::MockTexture(MockDevice* pDevice, UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool) :
+	MockBaseTexture<IDirect3DTexture9>(pDevice, D3DRTYPE_TEXTURE, levels ? levels : FullChainLevels(width, height, 1)),
+	m_surfaces()
+{
+	for (UINT level = 0; level < m_levels; level++) {
+		D3DSURFACE_DESC desc;
+		desc.Format = format;
+		desc.Type = D3DRTYPE_SURFACE;
+		desc.Usage = usage;
+		desc.Pool = pool;
+		desc.MultiSampleType = D3DMULTISAMPLE_NONE;
+		desc.MultiSampleQuality = 0;
+		desc.Width = LevelSize(width, level);
+		desc.Height = LevelSize(height, level);
+		m_surfaces.push_back(new MockSurface(pDevice, desc, this));
+	}
+}
+
+MockTexture::~MockTexture()
+{
+	for (size_t i = 0; i < m_surfaces.size(); i++) {
+		m_surfaces[i]->m_pContainer = NULL;
+		m_surfaces[i]->Release();
+	}
+}
+
+HRESULT WINAPI MockTexture::GetLevelDesc(UINT Level, D3DSURFACE_DESC* pDesc)
+{
+	if (Level >= m_levels)
+		return D3DERR_INVALIDCALL;
+	return m_surfaces[Level]->GetDesc(pDesc);
+}
+
+HRESULT WINAPI MockTexture::GetSurfaceLevel(UINT Level, IDirect3DSurface9** ppSurfaceLevel)
+{
+	if (Level >= m_levels)
+		return D3DERR_INVALIDCALL;
+	m_surfaces[Level]->AddRef();
+	*ppSurfaceLevel = m_surfaces[Level];
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockTexture::LockRect(UINT Level, D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags)
+{
+	if (Level >= m_levels)
+		return D3DERR_INVALIDCALL;
+	return m_surfaces[Level]->LockRect(pLockedRect, pRect, Flags);
+}
+
+/*** MockCubeTexture ***/
+
+MockCubeTexture::MockCubeTexture(MockDevice* pDevice, UINT edgeLength, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool) :
+	MockBaseTexture<IDirect3DCubeTexture9>(pDevice, D3DRTYPE_CUBETEXTURE, levels ? levels : FullChainLevels(edgeLength, edgeLength, 1)),
+	m_surfaces()
+{
+	for (UINT face = 0; face < 6; face++) {
+		for (UINT level = 0; level < m_levels; level++) {
+			D3DSURFACE_DESC desc;
+			desc.Format = format;
+			desc.Type = D3DRTYPE_SURFACE;
+			desc.Usage = usage;
+			desc.Pool = pool;
+			desc.MultiSampleType = D3DMULTISAMPLE_NONE;
+			desc.MultiSampleQuality = 0;
+			desc.Width = LevelSize(edgeLength, level);
+			desc.Height = desc.Width;
+			m_surfaces.push_back(new MockSurface(pDevice, desc, this));
+		}
+	}
+}
+
+MockCubeTexture::~MockCubeTexture()
+{
+	for (size_t i = 0; i < m_surfaces.size(); i++) {
+		m_surfaces[i]->m_pContainer = NULL;
+		m_surfaces[i]->Release();
+	}
+}
+
+HRESULT WINAPI MockCubeTexture::GetLevelDesc(UINT Level, D3DSURFACE_DESC* pDesc)
+{
+	if (Level >= m_levels)
+		return D3DERR_INVALIDCALL;
+	return m_surfaces[Level]->GetDesc(pDesc);
+}
+
+HRESULT WINAPI MockCubeTexture::GetCubeMapSurface(D3DCUBEMAP_FACES FaceType, UINT Level, IDirect3DSurface9** ppCubeMapSurface)
+{
+	if ((Level >= m_levels) || ((UINT)FaceType >= 6))
+		return D3DERR_INVALIDCALL;
+	MockSurface* pSurface = m_surfaces[FaceType * m_levels + Level];
+	pSurface->AddRef();
+	*ppCubeMapSurface = pSurface;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockCubeTexture::LockRect(D3DCUBEMAP_FACES FaceType, UINT Level, D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags)
+{
+	if ((Level >= m_levels) || ((UINT)FaceType >= 6))
+		return D3DERR_INVALIDCALL;
+	return m_surfaces[FaceType * m_levels + Level]->LockRect(pLockedRect, pRect, Flags);
+}
+
+/*** MockVolumeTexture ***/
+
+MockVolumeTexture::MockVolumeTexture(MockDevice* pDevice, UINT width, UINT height, UINT depth, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool) :
+	MockBaseTexture<IDirect3DVolumeTexture9>(pDevice, D3DRTYPE_VOLUMETEXTURE, levels ? levels : FullChainLevels(width, height, depth)),
+	m_volumes()
+{
+	for (UINT level = 0; level < m_levels; level++) {
+		D3DVOLUME_DESC desc;
+		desc.Format = format;
+		desc.Type = D3DRTYPE_VOLUME;
+		desc.Usage = usage;
+		desc.Pool = pool;
+		desc.Width = LevelSize(width, level);
+		desc.Height = LevelSize(height, level);
+		desc.Depth = LevelSize(depth, level);
+		m_volumes.push_back(new MockVolume(pDevice, desc, this));
+	}
+}
+
+MockVolumeTexture::~MockVolumeTexture()
+{
+	for (size_t i = 0; i < m_volumes.size(); i++) {
+		m_volumes[i]->m_pContainer = NULL;
+		m_volumes[i]->Release();
+	}
+}
+
+HRESULT WINAPI MockVolumeTexture::GetLevelDesc(UINT Level, D3DVOLUME_DESC* pDesc)
+{
+	if (Level >= m_levels)
+		return D3DERR_INVALIDCALL;
+	return m_volumes[Level]->GetDesc(pDesc);
+}
+
+HRESULT WINAPI MockVolumeTexture::GetVolumeLevel(UINT Level, IDirect3DVolume9** ppVolumeLevel)
+{
+	if (Level >= m_levels)
+		return D3DERR_INVALIDCALL;
+	m_volumes[Level]->AddRef();
+	*ppVolumeLevel = m_volumes[Level];
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockVolumeTexture::LockBox(UINT Level, D3DLOCKED_BOX* pLockedVolume, CONST D3DBOX* pBox, DWORD Flags)
+{
+	if (Level >= m_levels)
+		return D3DERR_INVALIDCALL;
+	return m_volumes[Level]->LockBox(pLockedVolume, pBox, Flags);
+}
+
+/*** MockVertexBuffer, MockIndexBuffer ***/
+
+HRESULT WINAPI MockVertexBuffer::Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DWORD Flags)
+{
+	if (OffsetToLock > m_data.size())
+		return D3DERR_INVALIDCALL;
+	*ppbData = m_data.empty() ? NULL : &m_data[0] + OffsetToLock;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockIndexBuffer::Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DWORD Flags)
+{
+	if (OffsetToLock > m_data.size())
+		return D3DERR_INVALIDCALL;
+	*ppbData = m_data.empty() ? NULL : &m_data[0] + OffsetToLock;
+	return D3D_OK;
+}
+
+/*** MockVertexDeclaration ***/
+
+MockVertexDeclaration::MockVertexDeclaration(MockDevice* pDevice, const D3DVERTEXELEMENT9* pElements) :
+	m_pDevice(pDevice),
+	m_elements()
+{
+	do {
+		m_elements.push_back(*pElements);
+	} while ((pElements++)->Stream != 0xFF);
+}
+
+HRESULT WINAPI MockVertexDeclaration::GetDevice(IDirect3DDevice9** ppDevice)
+{
+	*ppDevice = m_pDevice;
+	m_pDevice->AddRef();
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockVertexDeclaration::GetDeclaration(D3DVERTEXELEMENT9* pElement, UINT* pNumElements)
+{
+	if (pElement)
+		memcpy(pElement, &m_elements[0], m_elements.size() * sizeof(D3DVERTEXELEMENT9));
+	*pNumElements = (UINT)m_elements.size();
+	return D3D_OK;
+}
+
+/*** MockDeviceState ***/
+
+MockDeviceState::MockDeviceState() :
+	textures(),
+	pIndices(NULL),
+	pVertexDeclaration(NULL),
+	pVertexShader(NULL),
+	pPixelShader(NULL),
+	fvf(0)
+{
+	memset(streams, 0, sizeof(streams));
+	for (UINT i = 0; i < STREAMS; i++)
+		streams[i].frequency = 1;
+	memset(&viewport, 0, sizeof(viewport));
+	memset(&scissorRect, 0, sizeof(scissorRect));
+	memset(&material, 0, sizeof(material));
+	memset(vsConstantsF, 0, sizeof(vsConstantsF));
+	memset(vsConstantsI, 0, sizeof(vsConstantsI));
+	memset(vsConstantsB, 0, sizeof(vsConstantsB));
+	memset(psConstantsF, 0, sizeof(psConstantsF));
+	memset(psConstantsI, 0, sizeof(psConstantsI));
+	memset(psConstantsB, 0, sizeof(psConstantsB));
+}
+
+/**
+* References the bound objects, for a copy that outlives the bindings (state blocks).
+***/
+void MockDeviceState::AddRefObjects() const
+{
+	for (std::map<DWORD, IDirect3DBaseTexture9*>::const_iterator it = textures.begin(); it != textures.end(); ++it)
+		if (it->second)
+			it->second->AddRef();
+	for (UINT i = 0; i < STREAMS; i++)
+		if (streams[i].pBuffer)
+			streams[i].pBuffer->AddRef();
+	if (pIndices)
+		pIndices->AddRef();
+	if (pVertexDeclaration)
+		pVertexDeclaration->AddRef();
+	if (pVertexShader)
+		pVertexShader->AddRef();
+	if (pPixelShader)
+		pPixelShader->AddRef();
+}
+
+/**
+* Releases the references taken by AddRefObjects().
+***/
+void MockDeviceState::ReleaseObjects() const
+{
+	for (std::map<DWORD, IDirect3DBaseTexture9*>::const_iterator it = textures.begin(); it != textures.end(); ++it)
+		if (it->second)
+			it->second->Release();
+	for (UINT i = 0; i < STREAMS; i++)
+		if (streams[i].pBuffer)
+			streams[i].pBuffer->Release();
+	if (pIndices)
+		pIndices->Release();
+	if (pVertexDeclaration)
+		pVertexDeclaration->Release();
+	if (pVertexShader)
+		pVertexShader->Release();
+	if (pPixelShader)
+		pPixelShader->Release();
+}
+
+/*** MockStateBlock ***/
+
+/**
+* Constructor.
+* @param pDevice The device.
+* @param capturing True for CreateStateBlock() (captures the current state), false for EndStateBlock().
+***/
+MockStateBlock::MockStateBlock(MockDevice* pDevice, bool capturing) :
+	m_pDevice(pDevice),
+	m_capturing(capturing),
+	m_state()
+{
+	if (m_capturing) {
+		m_state = pDevice->State();
+		m_state.AddRefObjects();
+	}
+}
+
+MockStateBlock::~MockStateBlock()
+{
+	m_state.ReleaseObjects();
+}
+
+HRESULT WINAPI MockStateBlock::GetDevice(IDirect3DDevice9** ppDevice)
+{
+	*ppDevice = m_pDevice;
+	m_pDevice->AddRef();
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockStateBlock::Capture()
+{
+	m_pDevice->Record("StateBlock::Capture", "");
+	if (m_capturing) {
+		m_pDevice->State().AddRefObjects();
+		m_state.ReleaseObjects();
+		m_state = m_pDevice->State();
+	}
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockStateBlock::Apply()
+{
+	m_pDevice->Record("StateBlock::Apply", "");
+	if (m_capturing)
+		m_pDevice->SetState(m_state);
+	return D3D_OK;
+}
+
+/*** MockQuery ***/
+
+HRESULT WINAPI MockQuery::GetDevice(IDirect3DDevice9** ppDevice)
+{
+	*ppDevice = m_pDevice;
+	m_pDevice->AddRef();
+	return D3D_OK;
+}
+
+/*** MockSwapChain ***/
+
+MockSwapChain::MockSwapChain(MockDevice* pDevice, const D3DPRESENT_PARAMETERS& parameters) :
+	m_pDevice(pDevice),
+	m_parameters(parameters),
+	m_pBackBuffer(NULL)
+{
+	D3DSURFACE_DESC desc;
+	desc.Format = parameters.BackBufferFormat;
+	desc.Type = D3DRTYPE_SURFACE;
+	desc.Usage = D3DUSAGE_RENDERTARGET;
+	desc.Pool = D3DPOOL_DEFAULT;
+	desc.MultiSampleType = parameters.MultiSampleType;
+	desc.MultiSampleQuality = parameters.MultiSampleQuality;
+	desc.Width = parameters.BackBufferWidth;
+	desc.Height = parameters.BackBufferHeight;
+	m_pBackBuffer = new MockSurface(pDevice, desc, this);
+}
+
+MockSwapChain::~MockSwapChain()
+{
+	m_pBackBuffer->m_pContainer = NULL;
+	m_pBackBuffer->Release();
+}
+
+HRESULT WINAPI MockSwapChain::Present(CONST RECT* pSourceRect, CONST RECT* pDestRect, HWND hDestWindowOverride, CONST RGNDATA* pDirtyRegion, DWORD dwFlags)
+{
+	m_pDevice->Record("SwapChain::Present", "");
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockSwapChain::GetBackBuffer(UINT iBackBuffer, D3DBACKBUFFER_TYPE Type, IDirect3DSurface9** ppBackBuffer)
+{
+	m_pBackBuffer->AddRef();
+	*ppBackBuffer = m_pBackBuffer;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockSwapChain::GetDisplayMode(D3DDISPLAYMODE* pMode)
+{
+	return m_pDevice->GetDisplayMode(0, pMode);
+}
+
+HRESULT WINAPI MockSwapChain::GetDevice(IDirect3DDevice9** ppDevice)
+{
+	*ppDevice = m_pDevice;
+	m_pDevice->AddRef();
+	return D3D_OK;
+}
+
+/*** MockDevice ***/
+
+/**
+* Constructor.
+* @param parameters Presentation parameters, the swap chain and the automatic depth stencil are created from them.
+* @param behaviorFlags Creation flags returned by GetCreationParameters() (the proxy checks for pure devices).
+***/
+MockDevice::MockDevice(const D3DPRESENT_PARAMETERS& parameters, DWORD behaviorFlags) :
+	m_parameters(parameters),
+	m_behaviorFlags(behaviorFlags),
+	m_pSwapChain(NULL),
+	m_pAutoDepthStencil(NULL),
+	m_recording(false),
+	m_calls(0),
+	m_counts(),
+	m_callLog(),
+	m_pDepthStencil(NULL),
+	m_state(),
+	m_softwareVertexProcessing(FALSE),
+	m_nPatchMode(0.0f),
+	m_texturePalette(0)
+{
+	memset(m_pRenderTargets, 0, sizeof(m_pRenderTargets));
+	memset(&m_clipStatus, 0, sizeof(m_clipStatus));
+
+	m_pSwapChain = new MockSwapChain(this, parameters);
+	Bind<IDirect3DSurface9>(&m_pRenderTargets[0], m_pSwapChain->m_pBackBuffer);
+
+	if (parameters.EnableAutoDepthStencil) {
+		D3DSURFACE_DESC desc;
+		desc.Format = parameters.AutoDepthStencilFormat;
+		desc.Type = D3DRTYPE_SURFACE;
+		desc.Usage = D3DUSAGE_DEPTHSTENCIL;
+		desc.Pool = D3DPOOL_DEFAULT;
+		desc.MultiSampleType = parameters.MultiSampleType;
+		desc.MultiSampleQuality = parameters.MultiSampleQuality;
+		desc.Width = parameters.BackBufferWidth;
+		desc.Height = parameters.BackBufferHeight;
+		m_pAutoDepthStencil = new MockSurface(this, desc, NULL);
+		Bind<IDirect3DSurface9>(&m_pDepthStencil, m_pAutoDepthStencil);
+	}
+
+	m_state.viewport.X = 0;
+	m_state.viewport.Y = 0;
+	m_state.viewport.Width = parameters.BackBufferWidth;
+	m_state.viewport.Height = parameters.BackBufferHeight;
+	m_state.viewport.MinZ = 0.0f;
+	m_state.viewport.MaxZ = 1.0f;
+	SetRect(&m_state.scissorRect, 0, 0, (int)parameters.BackBufferWidth, (int)parameters.BackBufferHeight);
+}
+
+/**
+* Destructor, releases the bound objects.
+***/
+MockDevice::~MockDevice()
+{
+	for (UINT i = 0; i < RENDER_TARGETS; i++)
+		Bind<IDirect3DSurface9>(&m_pRenderTargets[i], NULL);
+	Bind<IDirect3DSurface9>(&m_pDepthStencil, NULL);
+	m_state.ReleaseObjects();
+
+	if (m_pAutoDepthStencil)
+		m_pAutoDepthStencil->Release();
+	m_pSwapChain->Release();
+}
+
+/**
+* Binds an object, the device holds a reference while it is bound.
+***/
+template <class T>
+void MockDevice::Bind(T** ppBound, T* pObject)
+{
+	if (pObject)
+		pObject->AddRef();
+	if (*ppBound)
+		(*ppBound)->Release();
+	*ppBound = pObject;
+}
+
+/**
+* Returns a bound object with a reference for the caller, D3DERR_NOTFOUND if none is bound
+* (as Direct3D does for render targets and depth stencils, other Get methods return NULL and D3D_OK).
+***/
+template <class T>
+HRESULT MockDevice::Return(T* pBound, T** ppObject)
+{
+	if (pBound)
+		pBound->AddRef();
+	*ppObject = pBound;
+	return D3D_OK;
+}
+
+/**
+* Turns the call log on or off, calls are counted either way.
+***/
+void MockDevice::SetRecording(bool recording)
+{
+	m_recording = recording;
+}
+
+/**
+* Clears the counts and the call log.
+***/
+void MockDevice::ClearCalls()
+{
+	m_calls = 0;
+	m_counts.clear();
+	m_callLog.clear();
+}
+
+/**
+* Returns the number of calls since the last ClearCalls().
+***/
+size_t MockDevice::Calls() const
+{
+	return m_calls;
+}
+
+/**
+* Returns the number of calls of a method since the last ClearCalls().
+***/
+size_t MockDevice::Count(const char* name) const
+{
+	std::map<const char*, size_t, NameLess>::const_iterator it = m_counts.find(name);
+	return (it == m_counts.end()) ? 0 : it->second;
+}
+
+/**
+* Returns the calls recorded while recording was on, as "Name(arguments)".
+***/
+const std::vector<std::string>& MockDevice::CallLog() const
+{
+	return m_callLog;
+}
+
+/**
+* Returns the recorded calls starting with a prefix.
+***/
+std::vector<std::string> MockDevice::CallLog(const char* prefix) const
+{
+	std::vector<std::string> calls;
+	size_t length = strlen(prefix);
+	for (size_t i = 0; i < m_callLog.size(); i++)
+		if (m_callLog[i].compare(0, length, prefix) == 0)
+			calls.push_back(m_callLog[i]);
+	return calls;
+}
+
+/**
+* Counts a call, adds it to the call log while recording.
+* @param name Method name, a string literal.
+* @param format Arguments, printf format.
+***/
+void MockDevice::Record(const char* name, const char* format, ...)
+{
+	m_calls++;
+	m_counts[name]++;
+	if (!m_recording)
+		return;
+
+	char arguments[256];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(arguments, sizeof(arguments), format, args);
+	va_end(args);
+
+	m_callLog.push_back(std::string(name) + "(" + arguments + ")");
+}
+
+/**
+* Returns the vertex shader float constants as set on the device.
+***/
+const float* MockDevice::VertexShaderConstantsF() const
+{
+	return m_state.vsConstantsF;
+}
+
+/**
+* Returns the pixel shader float constants as set on the device.
+***/
+const float* MockDevice::PixelShaderConstantsF() const
+{
+	return m_state.psConstantsF;
+}
+
+/**
+* Returns the pipeline state, the objects are not referenced for the caller.
+***/
+const MockDeviceState& MockDevice::State() const
+{
+	return m_state;
+}
+
+/**
+* Sets the pipeline state (applies a state block), rebinding the objects.
+***/
+void MockDevice::SetState(const MockDeviceState& state)
+{
+	state.AddRefObjects();
+	m_state.ReleaseObjects();
+	m_state = state;
+}
+
+HRESULT WINAPI MockDevice::TestCooperativeLevel()
+{
+	Record("TestCooperativeLevel", "");
+	return D3D_OK;
+}
+
+UINT WINAPI MockDevice::GetAvailableTextureMem()
+{
+	Record("GetAvailableTextureMem", "");
+	return 512 * 1024 * 1024;
+}
+
+HRESULT WINAPI MockDevice::EvictManagedResources()
+{
+	Record("EvictManagedResources", "");
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetDirect3D(IDirect3D9** ppD3D9)
+{
+	Record("GetDirect3D", "");
+	*ppD3D9 = NULL;
+	return D3DERR_INVALIDCALL;
+}
+
+/**
+* Shader model 3 hardware.
+***/
+HRESULT WINAPI MockDevice::GetDeviceCaps(D3DCAPS9* pCaps)
+{
+	Record("GetDeviceCaps", "");
+	memset(pCaps, 0, sizeof(D3DCAPS9));
+	pCaps->DeviceType = D3DDEVTYPE_HAL;
+	pCaps->MaxTextureWidth = 8192;
+	pCaps->MaxTextureHeight = 8192;
+	pCaps->MaxVolumeExtent = 2048;
+	pCaps->MaxAnisotropy = 16;
+	pCaps->MaxTextureBlendStages = 8;
+	pCaps->MaxSimultaneousTextures = 8;
+	pCaps->MaxActiveLights = 8;
+	pCaps->MaxUserClipPlanes = 6;
+	pCaps->MaxPrimitiveCount = 0xFFFFF;
+	pCaps->MaxVertexIndex = 0xFFFFFF;
+	pCaps->MaxStreams = STREAMS;
+	pCaps->MaxStreamStride = 508;
+	pCaps->VertexShaderVersion = D3DVS_VERSION(3, 0);
+	pCaps->MaxVertexShaderConst = VS_CONSTANTS_F;
+	pCaps->PixelShaderVersion = D3DPS_VERSION(3, 0);
+	pCaps->NumSimultaneousRTs = RENDER_TARGETS;
+	pCaps->MaxVertexShader30InstructionSlots = 32768;
+	pCaps->MaxPixelShader30InstructionSlots = 32768;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetDisplayMode(UINT iSwapChain, D3DDISPLAYMODE* pMode)
+{
+	Record("GetDisplayMode", "%u", iSwapChain);
+	pMode->Width = m_parameters.BackBufferWidth;
+	pMode->Height = m_parameters.BackBufferHeight;
+	pMode->RefreshRate = 60;
+	pMode->Format = m_parameters.BackBufferFormat;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetCreationParameters(D3DDEVICE_CREATION_PARAMETERS* pParameters)
+{
+	Record("GetCreationParameters", "");
+	pParameters->AdapterOrdinal = 0;
+	pParameters->DeviceType = D3DDEVTYPE_HAL;
+	pParameters->hFocusWindow = m_parameters.hDeviceWindow;
+	pParameters->BehaviorFlags = m_behaviorFlags;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetCursorProperties(UINT XHotSpot, UINT YHotSpot, IDirect3DSurface9* pCursorBitmap)
+{
+	Record("SetCursorProperties", "%u,%u", XHotSpot, YHotSpot);
+	return D3D_OK;
+}
+
+void WINAPI MockDevice::SetCursorPosition(int X, int Y, DWORD Flags)
+{
+	Record("SetCursorPosition", "%d,%d", X, Y);
+}
+
+BOOL WINAPI MockDevice::ShowCursor(BOOL bShow)
+{
+	Record("ShowCursor", "%d", bShow);
+	return FALSE;
+}
+
+HRESULT WINAPI MockDevice::CreateAdditionalSwapChain(D3DPRESENT_PARAMETERS* pPresentationParameters, IDirect3DSwapChain9** pSwapChain)
+{
+	Record("CreateAdditionalSwapChain", "%ux%u", pPresentationParameters->BackBufferWidth, pPresentationParameters->BackBufferHeight);
+	*pSwapChain = new MockSwapChain(this, *pPresentationParameters);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetSwapChain(UINT iSwapChain, IDirect3DSwapChain9** pSwapChain)
+{
+	Record("GetSwapChain", "%u", iSwapChain);
+	if (iSwapChain != 0)
+		return D3DERR_INVALIDCALL;
+	return Return<IDirect3DSwapChain9>(m_pSwapChain, pSwapChain);
+}
+
+UINT WINAPI MockDevice::GetNumberOfSwapChains()
+{
+	Record("GetNumberOfSwapChains", "");
+	return 1;
+}
+
+HRESULT WINAPI MockDevice::Reset(D3DPRESENT_PARAMETERS* pPresentationParameters)
+{
+	Record("Reset", "%ux%u", pPresentationParameters->BackBufferWidth, pPresentationParameters->BackBufferHeight);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::Present(CONST RECT* pSourceRect, CONST RECT* pDestRect, HWND hDestWindowOverride, CONST RGNDATA* pDirtyRegion)
+{
+	Record("Present", "");
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetBackBuffer(UINT iSwapChain, UINT iBackBuffer, D3DBACKBUFFER_TYPE Type, IDirect3DSurface9** ppBackBuffer)
+{
+	Record("GetBackBuffer", "%u,%u", iSwapChain, iBackBuffer);
+	if (iSwapChain != 0)
+		return D3DERR_INVALIDCALL;
+	return m_pSwapChain->GetBackBuffer(iBackBuffer, Type, ppBackBuffer);
+}
+
+HRESULT WINAPI MockDevice::GetRasterStatus(UINT iSwapChain, D3DRASTER_STATUS* pRasterStatus)
+{
+	Record("GetRasterStatus", "%u", iSwapChain);
+	return m_pSwapChain->GetRasterStatus(pRasterStatus);
+}
+
+HRESULT WINAPI MockDevice::SetDialogBoxMode(BOOL bEnableDialogs)
+{
+	Record("SetDialogBoxMode", "%d", bEnableDialogs);
+	return D3D_OK;
+}
+
+void WINAPI MockDevice::SetGammaRamp(UINT iSwapChain, DWORD Flags, CONST D3DGAMMARAMP* pRamp)
+{
+	Record("SetGammaRamp", "%u", iSwapChain);
+}
+
+void WINAPI MockDevice::GetGammaRamp(UINT iSwapChain, D3DGAMMARAMP* pRamp)
+{
+	Record("GetGammaRamp", "%u", iSwapChain);
+	memset(pRamp, 0, sizeof(D3DGAMMARAMP));
+}
+
+HRESULT WINAPI MockDevice::CreateTexture(UINT Width, UINT Height, UINT Levels, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DTexture9** ppTexture, HANDLE* pSharedHandle)
+{
+	Record("CreateTexture", "%ux%u,%u,%u,%u,%u", Width, Height, Levels, Usage, Format, Pool);
+	*ppTexture = new MockTexture(this, Width, Height, Levels, Usage, Format, Pool);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::CreateVolumeTexture(UINT Width, UINT Height, UINT Depth, UINT Levels, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DVolumeTexture9** ppVolumeTexture, HANDLE* pSharedHandle)
+{
+	Record("CreateVolumeTexture", "%ux%ux%u,%u,%u,%u,%u", Width, Height, Depth, Levels, Usage, Format, Pool);
+	*ppVolumeTexture = new MockVolumeTexture(this, Width, Height, Depth, Levels, Usage, Format, Pool);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::CreateCubeTexture(UINT EdgeLength, UINT Levels, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DCubeTexture9** ppCubeTexture, HANDLE* pSharedHandle)
+{
+	Record("CreateCubeTexture", "%u,%u,%u,%u,%u", EdgeLength, Levels, Usage, Format, Pool);
+	*ppCubeTexture = new MockCubeTexture(this, EdgeLength, Levels, Usage, Format, Pool);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::CreateVertexBuffer(UINT Length, DWORD Usage, DWORD FVF, D3DPOOL Pool, IDirect3DVertexBuffer9** ppVertexBuffer, HANDLE* pSharedHandle)
+{
+	Record("CreateVertexBuffer", "%u,%u,%u,%u", Length, Usage, FVF, Pool);
+	D3DVERTEXBUFFER_DESC desc;
+	desc.Format = D3DFMT_VERTEXDATA;
+	desc.Type = D3DRTYPE_VERTEXBUFFER;
+	desc.Usage = Usage;
+	desc.Pool = Pool;
+	desc.Size = Length;
+	desc.FVF = FVF;
+	*ppVertexBuffer = new MockVertexBuffer(this, desc);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::CreateIndexBuffer(UINT Length, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DIndexBuffer9** ppIndexBuffer, HANDLE* pSharedHandle)
+{
+	Record("CreateIndexBuffer", "%u,%u,%u,%u", Length, Usage, Format, Pool);
+	D3DINDEXBUFFER_DESC desc;
+	desc.Format = Format;
+	desc.Type = D3DRTYPE_INDEXBUFFER;
+	desc.Usage = Usage;
+	desc.Pool = Pool;
+	desc.Size = Length;
+	*ppIndexBuffer = new MockIndexBuffer(this, desc);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::CreateRenderTarget(UINT Width, UINT Height, D3DFORMAT Format, D3DMULTISAMPLE_TYPE MultiSample, DWORD MultisampleQuality, BOOL Lockable, IDirect3DSurface9** ppSurface, HANDLE* pSharedHandle)
+{
+	Record("CreateRenderTarget", "%ux%u,%u", Width, Height, Format);
+	D3DSURFACE_DESC desc;
+	desc.Format = Format;
+	desc.Type = D3DRTYPE_SURFACE;
+	desc.Usage = D3DUSAGE_RENDERTARGET;
+	desc.Pool = D3DPOOL_DEFAULT;
+	desc.MultiSampleType = MultiSample;
+	desc.MultiSampleQuality = MultisampleQuality;
+	desc.Width = Width;
+	desc.Height = Height;
+	*ppSurface = new MockSurface(this, desc, NULL);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::CreateDepthStencilSurface(UINT Width, UINT Height, D3DFORMAT Format, D3DMULTISAMPLE_TYPE MultiSample, DWORD MultisampleQuality, BOOL Discard, IDirect3DSurface9** ppSurface, HANDLE* pSharedHandle)
+{
+	Record("CreateDepthStencilSurface", "%ux%u,%u", Width, Height, Format);
+	D3DSURFACE_DESC desc;
+	desc.Format = Format;
+	desc.Type = D3DRTYPE_SURFACE;
+	desc.Usage = D3DUSAGE_DEPTHSTENCIL;
+	desc.Pool = D3DPOOL_DEFAULT;
+	desc.MultiSampleType = MultiSample;
+	desc.MultiSampleQuality = MultisampleQuality;
+	desc.Width = Width;
+	desc.Height = Height;
+	*ppSurface = new MockSurface(this, desc, NULL);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::UpdateSurface(IDirect3DSurface9* pSourceSurface, CONST RECT* pSourceRect, IDirect3DSurface9* pDestinationSurface, CONST POINT* pDestPoint)
+{
+	Record("UpdateSurface", "%p,%p", pSourceSurface, pDestinationSurface);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::UpdateTexture(IDirect3DBaseTexture9* pSourceTexture, IDirect3DBaseTexture9* pDestinationTexture)
+{
+	Record("UpdateTexture", "%p,%p", pSourceTexture, pDestinationTexture);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetRenderTargetData(IDirect3DSurface9* pRenderTarget, IDirect3DSurface9* pDestSurface)
+{
+	Record("GetRenderTargetData", "%p,%p", pRenderTarget, pDestSurface);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetFrontBufferData(UINT iSwapChain, IDirect3DSurface9* pDestSurface)
+{
+	Record("GetFrontBufferData", "%u", iSwapChain);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::StretchRect(IDirect3DSurface9* pSourceSurface, CONST RECT* pSourceRect, IDirect3DSurface9* pDestSurface, CONST RECT* pDestRect, D3DTEXTUREFILTERTYPE Filter)
+{
+	Record("StretchRect", "%p,%p,%u", pSourceSurface, pDestSurface, Filter);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::ColorFill(IDirect3DSurface9* pSurface, CONST RECT* pRect, D3DCOLOR color)
+{
+	Record("ColorFill", "%p,%08x", pSurface, color);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::CreateOffscreenPlainSurface(UINT Width, UINT Height, D3DFORMAT Format, D3DPOOL Pool, IDirect3DSurface9** ppSurface, HANDLE* pSharedHandle)
+{
+	Record("CreateOffscreenPlainSurface", "%ux%u,%u,%u", Width, Height, Format, Pool);
+	D3DSURFACE_DESC desc;
+	desc.Format = Format;
+	desc.Type = D3DRTYPE_SURFACE;
+	desc.Usage = 0;
+	desc.Pool = Pool;
+	desc.MultiSampleType = D3DMULTISAMPLE_NONE;
+	desc.MultiSampleQuality = 0;
+	desc.Width = Width;
+	desc.Height = Height;
+	*ppSurface = new MockSurface(this, desc, NULL);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetRenderTarget(DWORD RenderTargetIndex, IDirect3DSurface9* pRenderTarget)
+{
+	Record("SetRenderTarget", "%u,%p", RenderTargetIndex, pRenderTarget);
+	if ((RenderTargetIndex >= RENDER_TARGETS) || ((RenderTargetIndex == 0) && !pRenderTarget))
+		return D3DERR_INVALIDCALL;
+	Bind(&m_pRenderTargets[RenderTargetIndex], pRenderTarget);
+
+	// as Direct3D, setting a render target resets the viewport to it
+	if (RenderTargetIndex == 0) {
+		D3DSURFACE_DESC desc;
+		pRenderTarget->GetDesc(&desc);
+		m_state.viewport.X = 0;
+		m_state.viewport.Y = 0;
+		m_state.viewport.Width = desc.Width;
+		m_state.viewport.Height = desc.Height;
+		m_state.viewport.MinZ = 0.0f;
+		m_state.viewport.MaxZ = 1.0f;
+	}
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetRenderTarget(DWORD RenderTargetIndex, IDirect3DSurface9** ppRenderTarget)
+{
+	Record("GetRenderTarget", "%u", RenderTargetIndex);
+	if (RenderTargetIndex >= RENDER_TARGETS)
+		return D3DERR_INVALIDCALL;
+	Return(m_pRenderTargets[RenderTargetIndex], ppRenderTarget);
+	return m_pRenderTargets[RenderTargetIndex] ? D3D_OK : D3DERR_NOTFOUND;
+}
+
+HRESULT WINAPI MockDevice::SetDepthStencilSurface(IDirect3DSurface9* pNewZStencil)
+{
+	Record("SetDepthStencilSurface", "%p", pNewZStencil);
+	Bind(&m_pDepthStencil, pNewZStencil);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetDepthStencilSurface(IDirect3DSurface9** ppZStencilSurface)
+{
+	Record("GetDepthStencilSurface", "");
+	Return(m_pDepthStencil, ppZStencilSurface);
+	return m_pDepthStencil ? D3D_OK : D3DERR_NOTFOUND;
+}
+
+HRESULT WINAPI MockDevice::BeginScene()
+{
+	Record("BeginScene", "");
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::EndScene()
+{
+	Record("EndScene", "");
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::Clear(DWORD Count, CONST D3DRECT* pRects, DWORD Flags, D3DCOLOR Color, float Z, DWORD Stencil)
+{
+	Record("Clear", "%u,%u,%08x", Count, Flags, Color);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetTransform(D3DTRANSFORMSTATETYPE State, CONST D3DMATRIX* pMatrix)
+{
+	Record("SetTransform", "%u", State);
+	m_state.transforms[State] = *pMatrix;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetTransform(D3DTRANSFORMSTATETYPE State, D3DMATRIX* pMatrix)
+{
+	Record("GetTransform", "%u", State);
+	std::map<DWORD, D3DMATRIX>::const_iterator it = m_state.transforms.find(State);
+	if (it != m_state.transforms.end())
+		*pMatrix = it->second;
+	else
+		D3DXMatrixIdentity((D3DXMATRIX*)pMatrix);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::MultiplyTransform(D3DTRANSFORMSTATETYPE State, CONST D3DMATRIX* pMatrix)
+{
+	Record("MultiplyTransform", "%u", State);
+	D3DXMATRIX current;
+	std::map<DWORD, D3DMATRIX>::const_iterator it = m_state.transforms.find(State);
+	if (it != m_state.transforms.end())
+		current = it->second;
+	else
+		D3DXMatrixIdentity(&current);
+	D3DXMATRIX result = current * D3DXMATRIX(*pMatrix);
+	m_state.transforms[State] = result;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetViewport(CONST D3DVIEWPORT9* pViewport)
+{
+	Record("SetViewport", "%u,%u,%u,%u", pViewport->X, pViewport->Y, pViewport->Width, pViewport->Height);
+	m_state.viewport = *pViewport;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetViewport(D3DVIEWPORT9* pViewport)
+{
+	Record("GetViewport", "");
+	*pViewport = m_state.viewport;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetMaterial(CONST D3DMATERIAL9* pMaterial)
+{
+	Record("SetMaterial", "");
+	m_state.material = *pMaterial;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetMaterial(D3DMATERIAL9* pMaterial)
+{
+	Record("GetMaterial", "");
+	*pMaterial = m_state.material;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetLight(DWORD Index, CONST D3DLIGHT9* pLight)
+{
+	Record("SetLight", "%u", Index);
+	m_state.lights[Index] = *pLight;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetLight(DWORD Index, D3DLIGHT9* pLight)
+{
+	Record("GetLight", "%u", Index);
+	std::map<DWORD, D3DLIGHT9>::const_iterator it = m_state.lights.find(Index);
+	if (it == m_state.lights.end())
+		return D3DERR_INVALIDCALL;
+	*pLight = it->second;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::LightEnable(DWORD Index, BOOL Enable)
+{
+	Record("LightEnable", "%u,%d", Index, Enable);
+	m_state.lightsEnabled[Index] = Enable;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetLightEnable(DWORD Index, BOOL* pEnable)
+{
+	Record("GetLightEnable", "%u", Index);
+	std::map<DWORD, BOOL>::const_iterator it = m_state.lightsEnabled.find(Index);
+	if (it == m_state.lightsEnabled.end())
+		return D3DERR_INVALIDCALL;
+	*pEnable = it->second;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetClipPlane(DWORD Index, CONST float* pPlane)
+{
+	Record("SetClipPlane", "%u", Index);
+	m_state.clipPlanes[Index] = std::vector<float>(pPlane, pPlane + 4);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetClipPlane(DWORD Index, float* pPlane)
+{
+	Record("GetClipPlane", "%u", Index);
+	std::map<DWORD, std::vector<float> >::const_iterator it = m_state.clipPlanes.find(Index);
+	if (it != m_state.clipPlanes.end())
+		memcpy(pPlane, &it->second[0], 4 * sizeof(float));
+	else
+		memset(pPlane, 0, 4 * sizeof(float));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetRenderState(D3DRENDERSTATETYPE State, DWORD Value)
+{
+	Record("SetRenderState", "%u,%u", State, Value);
+	m_state.renderStates[State] = Value;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetRenderState(D3DRENDERSTATETYPE State, DWORD* pValue)
+{
+	Record("GetRenderState", "%u", State);
+	std::map<DWORD, DWORD>::const_iterator it = m_state.renderStates.find(State);
+	*pValue = (it == m_state.renderStates.end()) ? 0 : it->second;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::CreateStateBlock(D3DSTATEBLOCKTYPE Type, IDirect3DStateBlock9** ppSB)
+{
+	Record("CreateStateBlock", "%u", Type);
+	*ppSB = new MockStateBlock(this, true);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::BeginStateBlock()
+{
+	Record("BeginStateBlock", "");
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::EndStateBlock(IDirect3DStateBlock9** ppSB)
+{
+	Record("EndStateBlock", "");
+	*ppSB = new MockStateBlock(this, false);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetClipStatus(CONST D3DCLIPSTATUS9* pClipStatus)
+{
+	Record("SetClipStatus", "");
+	m_clipStatus = *pClipStatus;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetClipStatus(D3DCLIPSTATUS9* pClipStatus)
+{
+	Record("GetClipStatus", "");
+	*pClipStatus = m_clipStatus;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetTexture(DWORD Stage, IDirect3DBaseTexture9** ppTexture)
+{
+	Record("GetTexture", "%u", Stage);
+	std::map<DWORD, IDirect3DBaseTexture9*>::const_iterator it = m_state.textures.find(Stage);
+	return Return<IDirect3DBaseTexture9>((it == m_state.textures.end()) ? NULL : it->second, ppTexture);
+}
+
+HRESULT WINAPI MockDevice::SetTexture(DWORD Stage, IDirect3DBaseTexture9* pTexture)
+{
+	Record("SetTexture", "%u,%p", Stage, pTexture);
+	IDirect3DBaseTexture9*& pBound = m_state.textures[Stage];
+	Bind(&pBound, pTexture);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD* pValue)
+{
+	Record("GetTextureStageState", "%u,%u", Stage, Type);
+	std::map<DWORD, DWORD>::const_iterator it = m_state.textureStageStates.find((Stage << 16) | Type);
+	*pValue = (it == m_state.textureStageStates.end()) ? 0 : it->second;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD Value)
+{
+	Record("SetTextureStageState", "%u,%u,%u", Stage, Type, Value);
+	m_state.textureStageStates[(Stage << 16) | Type] = Value;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD* pValue)
+{
+	Record("GetSamplerState", "%u,%u", Sampler, Type);
+	std::map<DWORD, DWORD>::const_iterator it = m_state.samplerStates.find((Sampler << 16) | Type);
+	*pValue = (it == m_state.samplerStates.end()) ? 0 : it->second;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD Value)
+{
+	Record("SetSamplerState", "%u,%u,%u", Sampler, Type, Value);
+	m_state.samplerStates[(Sampler << 16) | Type] = Value;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::ValidateDevice(DWORD* pNumPasses)
+{
+	Record("ValidateDevice", "");
+	*pNumPasses = 1;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetPaletteEntries(UINT PaletteNumber, CONST PALETTEENTRY* pEntries)
+{
+	Record("SetPaletteEntries", "%u", PaletteNumber);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetPaletteEntries(UINT PaletteNumber, PALETTEENTRY* pEntries)
+{
+	Record("GetPaletteEntries", "%u", PaletteNumber);
+	memset(pEntries, 0, 256 * sizeof(PALETTEENTRY));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetCurrentTexturePalette(UINT PaletteNumber)
+{
+	Record("SetCurrentTexturePalette", "%u", PaletteNumber);
+	m_texturePalette = PaletteNumber;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetCurrentTexturePalette(UINT* PaletteNumber)
+{
+	Record("GetCurrentTexturePalette", "");
+	*PaletteNumber = m_texturePalette;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetScissorRect(CONST RECT* pRect)
+{
+	Record("SetScissorRect", "%d,%d,%d,%d", pRect->left, pRect->top, pRect->right, pRect->bottom);
+	m_state.scissorRect = *pRect;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetScissorRect(RECT* pRect)
+{
+	Record("GetScissorRect", "");
+	*pRect = m_state.scissorRect;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetSoftwareVertexProcessing(BOOL bSoftware)
+{
+	Record("SetSoftwareVertexProcessing", "%d", bSoftware);
+	m_softwareVertexProcessing = bSoftware;
+	return D3D_OK;
+}
+
+BOOL WINAPI MockDevice::GetSoftwareVertexProcessing()
+{
+	Record("GetSoftwareVertexProcessing", "");
+	return m_softwareVertexProcessing;
+}
+
+HRESULT WINAPI MockDevice::SetNPatchMode(float nSegments)
+{
+	Record("SetNPatchMode", "%g", nSegments);
+	m_nPatchMode = nSegments;
+	return D3D_OK;
+}
+
+float WINAPI MockDevice::GetNPatchMode()
+{
+	Record("GetNPatchMode", "");
+	return m_nPatchMode;
+}
+
+HRESULT WINAPI MockDevice::DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType, UINT StartVertex, UINT PrimitiveCount)
+{
+	Record("DrawPrimitive", "%u,%u,%u", PrimitiveType, StartVertex, PrimitiveCount);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType, INT BaseVertexIndex, UINT MinVertexIndex, UINT NumVertices, UINT startIndex, UINT primCount)
+{
+	Record("DrawIndexedPrimitive", "%u,%d,%u,%u,%u,%u", PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, startIndex, primCount);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::DrawPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT PrimitiveCount, CONST void* pVertexStreamZeroData, UINT VertexStreamZeroStride)
+{
+	Record("DrawPrimitiveUP", "%u,%u,%u", PrimitiveType, PrimitiveCount, VertexStreamZeroStride);
+
+	// as Direct3D, UP draws unbind stream 0
+	Bind<IDirect3DVertexBuffer9>(&m_state.streams[0].pBuffer, NULL);
+	m_state.streams[0].offset = 0;
+	m_state.streams[0].stride = 0;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT MinVertexIndex, UINT NumVertices, UINT PrimitiveCount, CONST void* pIndexData, D3DFORMAT IndexDataFormat, CONST void* pVertexStreamZeroData, UINT VertexStreamZeroStride)
+{
+	Record("DrawIndexedPrimitiveUP", "%u,%u,%u,%u,%u,%u", PrimitiveType, MinVertexIndex, NumVertices, PrimitiveCount, IndexDataFormat, VertexStreamZeroStride);
+
+	// as Direct3D, UP draws unbind stream 0 and the indices
+	Bind<IDirect3DVertexBuffer9>(&m_state.streams[0].pBuffer, NULL);
+	m_state.streams[0].offset = 0;
+	m_state.streams[0].stride = 0;
+	Bind<IDirect3DIndexBuffer9>(&m_state.pIndices, NULL);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::ProcessVertices(UINT SrcStartIndex, UINT DestIndex, UINT VertexCount, IDirect3DVertexBuffer9* pDestBuffer, IDirect3DVertexDeclaration9* pVertexDecl, DWORD Flags)
+{
+	Record("ProcessVertices", "%u,%u,%u", SrcStartIndex, DestIndex, VertexCount);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::CreateVertexDeclaration(CONST D3DVERTEXELEMENT9* pVertexElements, IDirect3DVertexDeclaration9** ppDecl)
+{
+	Record("CreateVertexDeclaration", "");
+	*ppDecl = new MockVertexDeclaration(this, pVertexElements);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetVertexDeclaration(IDirect3DVertexDeclaration9* pDecl)
+{
+	Record("SetVertexDeclaration", "%p", pDecl);
+	Bind(&m_state.pVertexDeclaration, pDecl);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetVertexDeclaration(IDirect3DVertexDeclaration9** ppDecl)
+{
+	Record("GetVertexDeclaration", "");
+	return Return(m_state.pVertexDeclaration, ppDecl);
+}
+
+HRESULT WINAPI MockDevice::SetFVF(DWORD FVF)
+{
+	Record("SetFVF", "%u", FVF);
+	m_state.fvf = FVF;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetFVF(DWORD* pFVF)
+{
+	Record("GetFVF", "");
+	*pFVF = m_state.fvf;
+	return D3D_OK;
+}
+
+/**
+* Keeps the function up to the end token.
+***/
+HRESULT WINAPI MockDevice::CreateVertexShader(CONST DWORD* pFunction, IDirect3DVertexShader9** ppShader)
+{
+	Record("CreateVertexShader", "");
+	size_t tokens = 1;
+	while (pFunction[tokens - 1] != 0x0000FFFF)
+		tokens++;
+	*ppShader = new MockVertexShader(this, pFunction, tokens * sizeof(DWORD));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetVertexShader(IDirect3DVertexShader9* pShader)
+{
+	Record("SetVertexShader", "%p", pShader);
+	Bind(&m_state.pVertexShader, pShader);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetVertexShader(IDirect3DVertexShader9** ppShader)
+{
+	Record("GetVertexShader", "");
+	return Return(m_state.pVertexShader, ppShader);
+}
+
+HRESULT WINAPI MockDevice::SetVertexShaderConstantF(UINT StartRegister, CONST float* pConstantData, UINT Vector4fCount)
+{
+	Record("SetVertexShaderConstantF", "%u,%u", StartRegister, Vector4fCount);
+	if (StartRegister + Vector4fCount > VS_CONSTANTS_F)
+		return D3DERR_INVALIDCALL;
+	memcpy(&m_state.vsConstantsF[StartRegister * 4], pConstantData, Vector4fCount * 4 * sizeof(float));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetVertexShaderConstantF(UINT StartRegister, float* pConstantData, UINT Vector4fCount)
+{
+	Record("GetVertexShaderConstantF", "%u,%u", StartRegister, Vector4fCount);
+	if (StartRegister + Vector4fCount > VS_CONSTANTS_F)
+		return D3DERR_INVALIDCALL;
+	memcpy(pConstantData, &m_state.vsConstantsF[StartRegister * 4], Vector4fCount * 4 * sizeof(float));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetVertexShaderConstantI(UINT StartRegister, CONST int* pConstantData, UINT Vector4iCount)
+{
+	Record("SetVertexShaderConstantI", "%u,%u", StartRegister, Vector4iCount);
+	if (StartRegister + Vector4iCount > 16)
+		return D3DERR_INVALIDCALL;
+	memcpy(&m_state.vsConstantsI[StartRegister * 4], pConstantData, Vector4iCount * 4 * sizeof(int));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetVertexShaderConstantI(UINT StartRegister, int* pConstantData, UINT Vector4iCount)
+{
+	Record("GetVertexShaderConstantI", "%u,%u", StartRegister, Vector4iCount);
+	if (StartRegister + Vector4iCount > 16)
+		return D3DERR_INVALIDCALL;
+	memcpy(pConstantData, &m_state.vsConstantsI[StartRegister * 4], Vector4iCount * 4 * sizeof(int));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetVertexShaderConstantB(UINT StartRegister, CONST BOOL* pConstantData, UINT BoolCount)
+{
+	Record("SetVertexShaderConstantB", "%u,%u", StartRegister, BoolCount);
+	if (StartRegister + BoolCount > 16)
+		return D3DERR_INVALIDCALL;
+	memcpy(&m_state.vsConstantsB[StartRegister], pConstantData, BoolCount * sizeof(BOOL));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetVertexShaderConstantB(UINT StartRegister, BOOL* pConstantData, UINT BoolCount)
+{
+	Record("GetVertexShaderConstantB", "%u,%u", StartRegister, BoolCount);
+	if (StartRegister + BoolCount > 16)
+		return D3DERR_INVALIDCALL;
+	memcpy(pConstantData, &m_state.vsConstantsB[StartRegister], BoolCount * sizeof(BOOL));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetStreamSource(UINT StreamNumber, IDirect3DVertexBuffer9* pStreamData, UINT OffsetInBytes, UINT Stride)
+{
+	Record("SetStreamSource", "%u,%p,%u,%u", StreamNumber, pStreamData, OffsetInBytes, Stride);
+	if (StreamNumber >= STREAMS)
+		return D3DERR_INVALIDCALL;
+	Bind(&m_state.streams[StreamNumber].pBuffer, pStreamData);
+	m_state.streams[StreamNumber].offset = OffsetInBytes;
+	m_state.streams[StreamNumber].stride = Stride;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetStreamSource(UINT StreamNumber, IDirect3DVertexBuffer9** ppStreamData, UINT* pOffsetInBytes, UINT* pStride)
+{
+	Record("GetStreamSource", "%u", StreamNumber);
+	if (StreamNumber >= STREAMS)
+		return D3DERR_INVALIDCALL;
+	*pOffsetInBytes = m_state.streams[StreamNumber].offset;
+	*pStride = m_state.streams[StreamNumber].stride;
+	return Return(m_state.streams[StreamNumber].pBuffer, ppStreamData);
+}
+
+HRESULT WINAPI MockDevice::SetStreamSourceFreq(UINT StreamNumber, UINT Setting)
+{
+	Record("SetStreamSourceFreq", "%u,%08x", StreamNumber, Setting);
+	if (StreamNumber >= STREAMS)
+		return D3DERR_INVALIDCALL;
+	m_state.streams[StreamNumber].frequency = Setting;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetStreamSourceFreq(UINT StreamNumber, UINT* pSetting)
+{
+	Record("GetStreamSourceFreq", "%u", StreamNumber);
+	if (StreamNumber >= STREAMS)
+		return D3DERR_INVALIDCALL;
+	*pSetting = m_state.streams[StreamNumber].frequency;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetIndices(IDirect3DIndexBuffer9* pIndexData)
+{
+	Record("SetIndices", "%p", pIndexData);
+	Bind(&m_state.pIndices, pIndexData);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetIndices(IDirect3DIndexBuffer9** ppIndexData)
+{
+	Record("GetIndices", "");
+	return Return(m_state.pIndices, ppIndexData);
+}
+
+HRESULT WINAPI MockDevice::CreatePixelShader(CONST DWORD* pFunction, IDirect3DPixelShader9** ppShader)
+{
+	Record("CreatePixelShader", "");
+	size_t tokens = 1;
+	while (pFunction[tokens - 1] != 0x0000FFFF)
+		tokens++;
+	*ppShader = new MockPixelShader(this, pFunction, tokens * sizeof(DWORD));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetPixelShader(IDirect3DPixelShader9* pShader)
+{
+	Record("SetPixelShader", "%p", pShader);
+	Bind(&m_state.pPixelShader, pShader);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetPixelShader(IDirect3DPixelShader9** ppShader)
+{
+	Record("GetPixelShader", "");
+	return Return(m_state.pPixelShader, ppShader);
+}
+
+HRESULT WINAPI MockDevice::SetPixelShaderConstantF(UINT StartRegister, CONST float* pConstantData, UINT Vector4fCount)
+{
+	Record("SetPixelShaderConstantF", "%u,%u", StartRegister, Vector4fCount);
+	if (StartRegister + Vector4fCount > PS_CONSTANTS_F)
+		return D3DERR_INVALIDCALL;
+	memcpy(&m_state.psConstantsF[StartRegister * 4], pConstantData, Vector4fCount * 4 * sizeof(float));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetPixelShaderConstantF(UINT StartRegister, float* pConstantData, UINT Vector4fCount)
+{
+	Record("GetPixelShaderConstantF", "%u,%u", StartRegister, Vector4fCount);
+	if (StartRegister + Vector4fCount > PS_CONSTANTS_F)
+		return D3DERR_INVALIDCALL;
+	memcpy(pConstantData, &m_state.psConstantsF[StartRegister * 4], Vector4fCount * 4 * sizeof(float));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetPixelShaderConstantI(UINT StartRegister, CONST int* pConstantData, UINT Vector4iCount)
+{
+	Record("SetPixelShaderConstantI", "%u,%u", StartRegister, Vector4iCount);
+	if (StartRegister + Vector4iCount > 16)
+		return D3DERR_INVALIDCALL;
+	memcpy(&m_state.psConstantsI[StartRegister * 4], pConstantData, Vector4iCount * 4 * sizeof(int));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetPixelShaderConstantI(UINT StartRegister, int* pConstantData, UINT Vector4iCount)
+{
+	Record("GetPixelShaderConstantI", "%u,%u", StartRegister, Vector4iCount);
+	if (StartRegister + Vector4iCount > 16)
+		return D3DERR_INVALIDCALL;
+	memcpy(pConstantData, &m_state.psConstantsI[StartRegister * 4], Vector4iCount * 4 * sizeof(int));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::SetPixelShaderConstantB(UINT StartRegister, CONST BOOL* pConstantData, UINT BoolCount)
+{
+	Record("SetPixelShaderConstantB", "%u,%u", StartRegister, BoolCount);
+	if (StartRegister + BoolCount > 16)
+		return D3DERR_INVALIDCALL;
+	memcpy(&m_state.psConstantsB[StartRegister], pConstantData, BoolCount * sizeof(BOOL));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::GetPixelShaderConstantB(UINT StartRegister, BOOL* pConstantData, UINT BoolCount)
+{
+	Record("GetPixelShaderConstantB", "%u,%u", StartRegister, BoolCount);
+	if (StartRegister + BoolCount > 16)
+		return D3DERR_INVALIDCALL;
+	memcpy(pConstantData, &m_state.psConstantsB[StartRegister], BoolCount * sizeof(BOOL));
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::DrawRectPatch(UINT Handle, CONST float* pNumSegs, CONST D3DRECTPATCH_INFO* pRectPatchInfo)
+{
+	Record("DrawRectPatch", "%u", Handle);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::DrawTriPatch(UINT Handle, CONST float* pNumSegs, CONST D3DTRIPATCH_INFO* pTriPatchInfo)
+{
+	Record("DrawTriPatch", "%u", Handle);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::DeletePatch(UINT Handle)
+{
+	Record("DeletePatch", "%u", Handle);
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockDevice::CreateQuery(D3DQUERYTYPE Type, IDirect3DQuery9** ppQuery)
+{
+	Record("CreateQuery", "%u", Type);
+	if (ppQuery)
+		*ppQuery = new MockQuery(this, Type);
+	return D3D_OK;
+}
@@ -0,0 +1,645 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <MockDevice.h> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef MOCKDEVICE_H_INCLUDED
+#define MOCKDEVICE_H_INCLUDED
+
+#include <d3d9.h>
+#include <d3dx9.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class MockDevice;
+
+/**
+* IUnknown with a reference count, the mock objects are deleted on their last Release().
+***/
+template <class T>
+class MockUnknown : public T
+{
+public:
+	MockUnknown() : m_nRefCount(1) {}
+	virtual ~MockUnknown() {}
+
+	virtual HRESULT WINAPI QueryInterface(REFIID riid, LPVOID* ppv) { *ppv = NULL; return E_NOINTERFACE; }
+	virtual ULONG   WINAPI AddRef() { return ++m_nRefCount; }
+	virtual ULONG   WINAPI Release()
+	{
+		ULONG count = --m_nRefCount;
+		if (count == 0)
+			delete this;
+		return count;
+	}
+
+protected:
+	ULONG m_nRefCount;
+};
+
+/**
+* Resource base, private data and priorities are accepted and dropped.
+***/
+template <class T>
+class MockResource : public MockUnknown<T>
+{
+public:
+	MockResource(MockDevice* pDevice, D3DRESOURCETYPE type) : m_pDevice(pDevice), m_type(type) {}
+
+	virtual HRESULT         WINAPI GetDevice(IDirect3DDevice9** ppDevice);
+	virtual HRESULT         WINAPI SetPrivateData(REFGUID refguid, CONST void* pData, DWORD SizeOfData, DWORD Flags) { return D3D_OK; }
+	virtual HRESULT         WINAPI GetPrivateData(REFGUID refguid, void* pData, DWORD* pSizeOfData) { return D3DERR_NOTFOUND; }
+	virtual HRESULT         WINAPI FreePrivateData(REFGUID refguid) { return D3D_OK; }
+	virtual DWORD           WINAPI SetPriority(DWORD PriorityNew) { return 0; }
+	virtual DWORD           WINAPI GetPriority() { return 0; }
+	virtual void            WINAPI PreLoad() {}
+	virtual D3DRESOURCETYPE WINAPI GetType() { return m_type; }
+
+protected:
+	MockDevice* m_pDevice;
+	D3DRESOURCETYPE m_type;
+};
+
+/**
+* Surface with lockable memory (allocated on the first lock).
+* Surfaces of textures and swap chains keep their container as plain pointer, the container owns them.
+***/
+class MockSurface : public MockResource<IDirect3DSurface9>
+{
+public:
+	MockSurface(MockDevice* pDevice, const D3DSURFACE_DESC& desc, IUnknown* pContainer);
+
+	virtual HRESULT WINAPI GetContainer(REFIID riid, void** ppContainer);
+	virtual HRESULT WINAPI GetDesc(D3DSURFACE_DESC* pDesc) { *pDesc = m_desc; return D3D_OK; }
+	virtual HRESULT WINAPI LockRect(D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags);
+	virtual HRESULT WINAPI UnlockRect() { return D3D_OK; }
+	virtual HRESULT WINAPI GetDC(HDC* phdc) { return D3DERR_INVALIDCALL; }
+	virtual HRESULT WINAPI ReleaseDC(HDC hdc) { return D3DERR_INVALIDCALL; }
+
+	D3DSURFACE_DESC m_desc;
+	IUnknown* m_pContainer;
+	std::vector<BYTE> m_data;
+};
+
+/**
+* Volume with lockable memory.
+***/
+class MockVolume : public MockUnknown<IDirect3DVolume9>
+{
+public:
+	MockVolume(MockDevice* pDevice, const D3DVOLUME_DESC& desc, IUnknown* pContainer) : m_pDevice(pDevice), m_desc(desc), m_pContainer(pContainer) {}
+
+	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice);
+	virtual HRESULT WINAPI SetPrivateData(REFGUID refguid, CONST void* pData, DWORD SizeOfData, DWORD Flags) { return D3D_OK; }
+	virtual HRESULT WINAPI GetPrivateData(REFGUID refguid, void* pData, DWORD* pSizeOfData) { return D3DERR_NOTFOUND; }
+	virtual HRESULT WINAPI FreePrivateData(REFGUID refguid) { return D3D_OK; }
+	virtual HRESULT WINAPI GetContainer(REFIID riid, void** ppContainer);
+	virtual HRESULT WINAPI GetDesc(D3DVOLUME_DESC* pDesc) { *pDesc = m_desc; return D3D_OK; }
+	virtual HRESULT WINAPI LockBox(D3DLOCKED_BOX* pLockedVolume, CONST D3DBOX* pBox, DWORD Flags);
+	virtual HRESULT WINAPI UnlockBox() { return D3D_OK; }
+
+	MockDevice* m_pDevice;
+	D3DVOLUME_DESC m_desc;
+	IUnknown* m_pContainer;
+	std::vector<BYTE> m_data;
+};
+
+/**
+* Base texture, the level count and the mip settings.
+***/
+template <class T>
+class MockBaseTexture : public MockResource<T>
+{
+public:
+	MockBaseTexture(MockDevice* pDevice, D3DRESOURCETYPE type, DWORD levels) : MockResource<T>(pDevice, type), m_levels(levels), m_lod(0) {}
+
+	virtual DWORD                WINAPI SetLOD(DWORD LODNew) { DWORD old = m_lod; m_lod = LODNew; return old; }
+	virtual DWORD                WINAPI GetLOD() { return m_lod; }
+	virtual DWORD                WINAPI GetLevelCount() { return m_levels; }
+	virtual HRESULT              WINAPI SetAutoGenFilterType(D3DTEXTUREFILTERTYPE FilterType) { return D3D_OK; }
+	virtual D3DTEXTUREFILTERTYPE WINAPI GetAutoGenFilterType() { return D3DTEXF_LINEAR; }
+	virtual void                 WINAPI GenerateMipSubLevels() {}
+
+protected:
+	DWORD m_levels;
+	DWORD m_lod;
+};
+
+/**
+* Texture, owns one surface per level.
+***/
+class MockTexture : public MockBaseTexture<IDirect3DTexture9>
+{
+public:
+	MockTexture(MockDevice* pDevice, UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool);
+	virtual ~MockTexture();
+
+	virtual HRESULT WINAPI GetLevelDesc(UINT Level, D3DSURFACE_DESC* pDesc);
+	virtual HRESULT WINAPI GetSurfaceLevel(UINT Level, IDirect3DSurface9** ppSurfaceLevel);
+	virtual HRESULT WINAPI LockRect(UINT Level, D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags);
+	virtual HRESULT WINAPI UnlockRect(UINT Level) { return (Level < m_levels) ? D3D_OK : D3DERR_INVALIDCALL; }
+	virtual HRESULT WINAPI AddDirtyRect(CONST RECT* pDirtyRect) { return D3D_OK; }
+
+	std::vector<MockSurface*> m_surfaces;
+};
+
+/**
+* Cube texture, owns one surface per face and level.
+***/
+class MockCubeTexture : public MockBaseTexture<IDirect3DCubeTexture9>
+{
+public:
+	MockCubeTexture(MockDevice* pDevice, UINT edgeLength, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool);
+	virtual ~MockCubeTexture();
+
+	virtual HRESULT WINAPI GetLevelDesc(UINT Level, D3DSURFACE_DESC* pDesc);
+	virtual HRESULT WINAPI GetCubeMapSurface(D3DCUBEMAP_FACES FaceType, UINT Level, IDirect3DSurface9** ppCubeMapSurface);
+	virtual HRESULT WINAPI LockRect(D3DCUBEMAP_FACES FaceType, UINT Level, D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags);
+	virtual HRESULT WINAPI UnlockRect(D3DCUBEMAP_FACES FaceType, UINT Level) { return D3D_OK; }
+	virtual HRESULT WINAPI AddDirtyRect(D3DCUBEMAP_FACES FaceType, CONST RECT* pDirtyRect) { return D3D_OK; }
+
+	/**
+	* Surfaces by face, then level.
+	***/
+	std::vector<MockSurface*> m_surfaces;
+};
+
+/**
+* Volume texture, owns one volume per level.
+***/
+class MockVolumeTexture : public MockBaseTexture<IDirect3DVolumeTexture9>
+{
+public:
+	MockVolumeTexture(MockDevice* pDevice, UINT width, UINT height, UINT depth, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool);
+	virtual ~MockVolumeTexture();
+
+	virtual HRESULT WINAPI GetLevelDesc(UINT Level, D3DVOLUME_DESC* pDesc);
+	virtual HRESULT WINAPI GetVolumeLevel(UINT Level, IDirect3DVolume9** ppVolumeLevel);
+	virtual HRESULT WINAPI LockBox(UINT Level, D3DLOCKED_BOX* pLockedVolume, CONST D3DBOX* pBox, DWORD Flags);
+	virtual HRESULT WINAPI UnlockBox(UINT Level) { return D3D_OK; }
+	virtual HRESULT WINAPI AddDirtyBox(CONST D3DBOX* pDirtyBox) { return D3D_OK; }
+
+	std::vector<MockVolume*> m_volumes;
+};
+
+/**
+* Vertex buffer with its memory.
+***/
+class MockVertexBuffer : public MockResource<IDirect3DVertexBuffer9>
+{
+public:
+	MockVertexBuffer(MockDevice* pDevice, const D3DVERTEXBUFFER_DESC& desc) : MockResource<IDirect3DVertexBuffer9>(pDevice, D3DRTYPE_VERTEXBUFFER), m_desc(desc), m_data(desc.Size) {}
+
+	virtual HRESULT WINAPI Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DWORD Flags);
+	virtual HRESULT WINAPI Unlock() { return D3D_OK; }
+	virtual HRESULT WINAPI GetDesc(D3DVERTEXBUFFER_DESC* pDesc) { *pDesc = m_desc; return D3D_OK; }
+
+	D3DVERTEXBUFFER_DESC m_desc;
+	std::vector<BYTE> m_data;
+};
+
+/**
+* Index buffer with its memory.
+***/
+class MockIndexBuffer : public MockResource<IDirect3DIndexBuffer9>
+{
+public:
+	MockIndexBuffer(MockDevice* pDevice, const D3DINDEXBUFFER_DESC& desc) : MockResource<IDirect3DIndexBuffer9>(pDevice, D3DRTYPE_INDEXBUFFER), m_desc(desc), m_data(desc.Size) {}
+
+	virtual HRESULT WINAPI Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DWORD Flags);
+	virtual HRESULT WINAPI Unlock() { return D3D_OK; }
+	virtual HRESULT WINAPI GetDesc(D3DINDEXBUFFER_DESC* pDesc) { *pDesc = m_desc; return D3D_OK; }
+
+	D3DINDEXBUFFER_DESC m_desc;
+	std::vector<BYTE> m_data;
+};
+
+/**
+* Vertex or pixel shader, keeps its function.
+***/
+template <class T>
+class MockShader : public MockUnknown<T>
+{
+public:
+	MockShader(MockDevice* pDevice, const DWORD* pFunction, size_t size) : m_pDevice(pDevice), m_function((const BYTE*)pFunction, (const BYTE*)pFunction + size) {}
+
+	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice);
+	virtual HRESULT WINAPI GetFunction(void* pData, UINT* pSizeOfData)
+	{
+		if (pData) {
+			if (*pSizeOfData < m_function.size())
+				return D3DERR_INVALIDCALL;
+			memcpy(pData, &m_function[0], m_function.size());
+		}
+		*pSizeOfData = (UINT)m_function.size();
+		return D3D_OK;
+	}
+
+	MockDevice* m_pDevice;
+	std::vector<BYTE> m_function;
+};
+typedef MockShader<IDirect3DVertexShader9> MockVertexShader;
+typedef MockShader<IDirect3DPixelShader9> MockPixelShader;
+
+/**
+* Vertex declaration, keeps its elements (including D3DDECL_END).
+***/
+class MockVertexDeclaration : public MockUnknown<IDirect3DVertexDeclaration9>
+{
+public:
+	MockVertexDeclaration(MockDevice* pDevice, const D3DVERTEXELEMENT9* pElements);
+
+	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice);
+	virtual HRESULT WINAPI GetDeclaration(D3DVERTEXELEMENT9* pElement, UINT* pNumElements);
+
+	MockDevice* m_pDevice;
+	std::vector<D3DVERTEXELEMENT9> m_elements;
+};
+
+/**
+* Pipeline state of the mock device, the part of the device state a state block captures (render
+* targets and the depth stencil are not part of it, as in Direct3D).
+* The objects are not referenced by the structure itself, see AddRefObjects() and ReleaseObjects().
+***/
+struct MockDeviceState
+{
+	/**
+	* A bound vertex stream.
+	***/
+	struct Stream
+	{
+		IDirect3DVertexBuffer9* pBuffer;   /**< Bound vertex buffer. */
+		UINT                    offset;    /**< Offset in bytes. */
+		UINT                    stride;    /**< Vertex stride in bytes. */
+		UINT                    frequency; /**< Stream source frequency setting. */
+	};
+
+	MockDeviceState();
+	void AddRefObjects() const;
+	void ReleaseObjects() const;
+
+	/**
+	* Vertex shader float constants.
+	***/
+	static const UINT VS_CONSTANTS_F = 256;
+	/**
+	* Pixel shader float constants (shader model 3).
+	***/
+	static const UINT PS_CONSTANTS_F = 224;
+	/**
+	* Vertex streams.
+	***/
+	static const UINT STREAMS = 16;
+
+	std::map<DWORD, IDirect3DBaseTexture9*> textures;            /**< Bound textures by stage. */
+	Stream                                  streams[STREAMS];    /**< Bound vertex streams. */
+	IDirect3DIndexBuffer9*                  pIndices;            /**< Bound index buffer. */
+	IDirect3DVertexDeclaration9*            pVertexDeclaration;  /**< Bound vertex declaration. */
+	IDirect3DVertexShader9*                 pVertexShader;       /**< Bound vertex shader. */
+	IDirect3DPixelShader9*                  pPixelShader;        /**< Bound pixel shader. */
+	DWORD                                   fvf;                 /**< FVF. */
+	std::map<DWORD, DWORD>                  renderStates;        /**< Render states set, unset states read as 0. */
+	std::map<DWORD, DWORD>                  samplerStates;       /**< Sampler states, by sampler << 16 | type. */
+	std::map<DWORD, DWORD>                  textureStageStates;  /**< Texture stage states, by stage << 16 | type. */
+	std::map<DWORD, D3DMATRIX>              transforms;          /**< Transforms set, unset transforms read as identity. */
+	std::map<DWORD, D3DLIGHT9>              lights;              /**< Lights set. */
+	std::map<DWORD, BOOL>                   lightsEnabled;       /**< Light enable states set. */
+	std::map<DWORD, std::vector<float> >    clipPlanes;          /**< Clip planes set. */
+	D3DVIEWPORT9                            viewport;            /**< Viewport. */
+	RECT                                    scissorRect;         /**< Scissor rectangle. */
+	D3DMATERIAL9                            material;            /**< Material. */
+	float                                   vsConstantsF[VS_CONSTANTS_F * 4]; /**< Vertex shader float constants. */
+	int                                     vsConstantsI[16 * 4];             /**< Vertex shader integer constants. */
+	BOOL                                    vsConstantsB[16];                 /**< Vertex shader bool constants. */
+	float                                   psConstantsF[PS_CONSTANTS_F * 4]; /**< Pixel shader float constants. */
+	int                                     psConstantsI[16 * 4];             /**< Pixel shader integer constants. */
+	BOOL                                    psConstantsB[16];                 /**< Pixel shader bool constants. */
+};
+
+/**
+* State block created by CreateStateBlock(), captures the whole pipeline state whatever the type.
+* Recorded state blocks (EndStateBlock()) capture nothing, applying them changes nothing.
+***/
+class MockStateBlock : public MockUnknown<IDirect3DStateBlock9>
+{
+public:
+	MockStateBlock(MockDevice* pDevice, bool capturing);
+	virtual ~MockStateBlock();
+
+	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice);
+	virtual HRESULT WINAPI Capture();
+	virtual HRESULT WINAPI Apply();
+
+	MockDevice*     m_pDevice;
+	bool            m_capturing;
+	MockDeviceState m_state;
+};
+
+/**
+* Query, always signaled with zeroed data.
+***/
+class MockQuery : public MockUnknown<IDirect3DQuery9>
+{
+public:
+	MockQuery(MockDevice* pDevice, D3DQUERYTYPE type) : m_pDevice(pDevice), m_type(type) {}
+
+	virtual HRESULT      WINAPI GetDevice(IDirect3DDevice9** ppDevice);
+	virtual D3DQUERYTYPE WINAPI GetType() { return m_type; }
+	virtual DWORD        WINAPI GetDataSize() { return sizeof(UINT64); }
+	virtual HRESULT      WINAPI Issue(DWORD dwIssueFlags) { return D3D_OK; }
+	virtual HRESULT      WINAPI GetData(void* pData, DWORD dwSize, DWORD dwGetDataFlags) { if (pData) memset(pData, 0, dwSize); return S_OK; }
+
+	MockDevice* m_pDevice;
+	D3DQUERYTYPE m_type;
+};
+
+/**
+* Swap chain, owns its back buffer.
+***/
+class MockSwapChain : public MockUnknown<IDirect3DSwapChain9>
+{
+public:
+	MockSwapChain(MockDevice* pDevice, const D3DPRESENT_PARAMETERS& parameters);
+	virtual ~MockSwapChain();
+
+	virtual HRESULT WINAPI Present(CONST RECT* pSourceRect, CONST RECT* pDestRect, HWND hDestWindowOverride, CONST RGNDATA* pDirtyRegion, DWORD dwFlags);
+	virtual HRESULT WINAPI GetFrontBufferData(IDirect3DSurface9* pDestSurface) { return D3D_OK; }
+	virtual HRESULT WINAPI GetBackBuffer(UINT iBackBuffer, D3DBACKBUFFER_TYPE Type, IDirect3DSurface9** ppBackBuffer);
+	virtual HRESULT WINAPI GetRasterStatus(D3DRASTER_STATUS* pRasterStatus) { memset(pRasterStatus, 0, sizeof(D3DRASTER_STATUS)); return D3D_OK; }
+	virtual HRESULT WINAPI GetDisplayMode(D3DDISPLAYMODE* pMode);
+	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice);
+	virtual HRESULT WINAPI GetPresentParameters(D3DPRESENT_PARAMETERS* pPresentationParameters) { *pPresentationParameters = m_parameters; return D3D_OK; }
+
+	MockDevice* m_pDevice;
+	D3DPRESENT_PARAMETERS m_parameters;
+	MockSurface* m_pBackBuffer;
+};
+
+/**
+* Actual device for the headless tests : records the calls it receives, keeps the state so the Get
+* methods return what was set, and gives resources memory but draws nothing.
+* Bound objects are referenced by the device as in Direct3D.
+* Every call is counted (Calls(), Count()), CallLog() additionally holds "Name(arguments)" strings
+* while recording is on (SetRecording()).
+*/
+class MockDevice : public MockUnknown<IDirect3DDevice9>
+{
+public:
+	MockDevice(const D3DPRESENT_PARAMETERS& parameters, DWORD behaviorFlags = D3DCREATE_HARDWARE_VERTEXPROCESSING);
+	virtual ~MockDevice();
+
+	/*** MockDevice public methods ***/
+	void                            SetRecording(bool recording);
+	void                            ClearCalls();
+	size_t                          Calls() const;
+	size_t                          Count(const char* name) const;
+	const std::vector<std::string>& CallLog() const;
+	std::vector<std::string>        CallLog(const char* prefix) const;
+	void                            Record(const char* name, const char* format, ...);
+	const float*                    VertexShaderConstantsF() const;
+	const float*                    PixelShaderConstantsF() const;
+	const MockDeviceState&          State() const;
+	void                            SetState(const MockDeviceState& state);
+
+	/*** IDirect3DDevice9 methods ***/
+	virtual HRESULT WINAPI TestCooperativeLevel();
+	virtual UINT    WINAPI GetAvailableTextureMem();
+	virtual HRESULT WINAPI EvictManagedResources();
+	virtual HRESULT WINAPI GetDirect3D(IDirect3D9** ppD3D9);
+	virtual HRESULT WINAPI GetDeviceCaps(D3DCAPS9* pCaps);
+	virtual HRESULT WINAPI GetDisplayMode(UINT iSwapChain, D3DDISPLAYMODE* pMode);
+	virtual HRESULT WINAPI GetCreationParameters(D3DDEVICE_CREATION_PARAMETERS* pParameters);
+	virtual HRESULT WINAPI SetCursorProperties(UINT XHotSpot, UINT YHotSpot, IDirect3DSurface9* pCursorBitmap);
+	virtual void    WINAPI SetCursorPosition(int X, int Y, DWORD Flags);
+	virtual BOOL    WINAPI ShowCursor(BOOL bShow);
+	virtual HRESULT WINAPI CreateAdditionalSwapChain(D3DPRESENT_PARAMETERS* pPresentationParameters, IDirect3DSwapChain9** pSwapChain);
+	virtual HRESULT WINAPI GetSwapChain(UINT iSwapChain, IDirect3DSwapChain9** pSwapChain);
+	virtual UINT    WINAPI GetNumberOfSwapChains();
+	virtual HRESULT WINAPI Reset(D3DPRESENT_PARAMETERS* pPresentationParameters);
+	virtual HRESULT WINAPI Present(CONST RECT* pSourceRect, CONST RECT* pDestRect, HWND hDestWindowOverride, CONST RGNDATA* pDirtyRegion);
+	virtual HRESULT WINAPI GetBackBuffer(UINT iSwapChain, UINT iBackBuffer, D3DBACKBUFFER_TYPE Type, IDirect3DSurface9** ppBackBuffer);
+	virtual HRESULT WINAPI GetRasterStatus(UINT iSwapChain, D3DRASTER_STATUS* pRasterStatus);
+	virtual HRESULT WINAPI SetDialogBoxMode(BOOL bEnableDialogs);
+	virtual void    WINAPI SetGammaRamp(UINT iSwapChain, DWORD Flags, CONST D3DGAMMARAMP* pRamp);
+	virtual void    WINAPI GetGammaRamp(UINT iSwapChain, D3DGAMMARAMP* pRamp);
+	virtual HRESULT WINAPI CreateTexture(UINT Width, UINT Height, UINT Levels, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DTexture9** ppTexture, HANDLE* pSharedHandle);
+	virtual HRESULT WINAPI CreateVolumeTexture(UINT Width, UINT Height, UINT Depth, UINT Levels, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DVolumeTexture9** ppVolumeTexture, HANDLE* pSharedHandle);
+	virtual HRESULT WINAPI CreateCubeTexture(UINT EdgeLength, UINT Levels, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DCubeTexture9** ppCubeTexture, HANDLE* pSharedHandle);
+	virtual HRESULT WINAPI CreateVertexBuffer(UINT Length, DWORD Usage, DWORD FVF, D3DPOOL Pool, IDirect3DVertexBuffer9** ppVertexBuffer, HANDLE* pSharedHandle);
+	virtual HRESULT WINAPI CreateIndexBuffer(UINT Length, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DIndexBuffer9** ppIndexBuffer, HANDLE* pSharedHandle);
+	virtual HRESULT WINAPI CreateRenderTarget(UINT Width, UINT Height, D3DFORMAT Format, D3DMULTISAMPLE_TYPE MultiSample, DWORD MultisampleQuality, BOOL Lockable, IDirect3DSurface9** ppSurface, HANDLE* pSharedHandle);
+	virtual HRESULT WINAPI CreateDepthStencilSurface(UINT Width, UINT Height, D3DFORMAT Format, D3DMULTISAMPLE_TYPE MultiSample, DWORD MultisampleQuality, BOOL Discard, IDirect3DSurface9** ppSurface, HANDLE* pSharedHandle);
+	virtual HRESULT WINAPI UpdateSurface(IDirect3DSurface9* pSourceSurface, CONST RECT* pSourceRect, IDirect3DSurface9* pDestinationSurface, CONST POINT* pDestPoint);
+	virtual HRESULT WINAPI UpdateTexture(IDirect3DBaseTexture9* pSourceTexture, IDirect3DBaseTexture9* pDestinationTexture);
+	virtual HRESULT WINAPI GetRenderTargetData(IDirect3DSurface9* pRenderTarget, IDirect3DSurface9* pDestSurface);
+	virtual HRESULT WINAPI GetFrontBufferData(UINT iSwapChain, IDirect3DSurface9* pDestSurface);
+	virtual HRESULT WINAPI StretchRect(IDirect3DSurface9* pSourceSurface, CONST RECT* pSourceRect, IDirect3DSurface9* pDestSurface, CONST RECT* pDestRect, D3DTEXTUREFILTERTYPE Filter);
+	virtual HRESULT WINAPI ColorFill(IDirect3DSurface9* pSurface, CONST RECT* pRect, D3DCOLOR color);
+	virtual HRESULT WINAPI CreateOffscreenPlainSurface(UINT Width, UINT Height, D3DFORMAT Format, D3DPOOL Pool, IDirect3DSurface9** ppSurface, HANDLE* pSharedHandle);
+	virtual HRESULT WINAPI SetRenderTarget(DWORD RenderTargetIndex, IDirect3DSurface9* pRenderTarget);
+	virtual HRESULT WINAPI GetRenderTarget(DWORD RenderTargetIndex, IDirect3DSurface9** ppRenderTarget);
+	virtual HRESULT WINAPI SetDepthStencilSurface(IDirect3DSurface9* pNewZStencil);
+	virtual HRESULT WINAPI GetDepthStencilSurface(IDirect3DSurface9** ppZStencilSurface);
+	virtual HRESULT WINAPI BeginScene();
+	virtual HRESULT WINAPI EndScene();
+	virtual HRESULT WINAPI Clear(DWORD Count, CONST D3DRECT* pRects, DWORD Flags, D3DCOLOR Color, float Z, DWORD Stencil);
+	virtual HRESULT WINAPI SetTransform(D3DTRANSFORMSTATETYPE State, CONST D3DMATRIX* pMatrix);
+	virtual HRESULT WINAPI GetTransform(D3DTRANSFORMSTATETYPE State, D3DMATRIX* pMatrix);
+	virtual HRESULT WINAPI MultiplyTransform(D3DTRANSFORMSTATETYPE State, CONST D3DMATRIX* pMatrix);
+	virtual HRESULT WINAPI SetViewport(CONST D3DVIEWPORT9* pViewport);
+	virtual HRESULT WINAPI GetViewport(D3DVIEWPORT9* pViewport);
+	virtual HRESULT WINAPI SetMaterial(CONST D3DMATERIAL9* pMaterial);
+	virtual HRESULT WINAPI GetMaterial(D3DMATERIAL9* pMaterial);
+	virtual HRESULT WINAPI SetLight(DWORD Index, CONST D3DLIGHT9* pLight);
+	virtual HRESULT WINAPI GetLight(DWORD Index, D3DLIGHT9* pLight);
+	virtual HRESULT WINAPI LightEnable(DWORD Index, BOOL Enable);
+	virtual HRESULT WINAPI GetLightEnable(DWORD Index, BOOL* pEnable);
+	virtual HRESULT WINAPI SetClipPlane(DWORD Index, CONST float* pPlane);
+	virtual HRESULT WINAPI GetClipPlane(DWORD Index, float* pPlane);
+	virtual HRESULT WINAPI SetRenderState(D3DRENDERSTATETYPE State, DWORD Value);
+	virtual HRESULT WINAPI GetRenderState(D3DRENDERSTATETYPE State, DWORD* pValue);
+	virtual HRESULT WINAPI CreateStateBlock(D3DSTATEBLOCKTYPE Type, IDirect3DStateBlock9** ppSB);
+	virtual HRESULT WINAPI BeginStateBlock();
+	virtual HRESULT WINAPI EndStateBlock(IDirect3DStateBlock9** ppSB);
+	virtual HRESULT WINAPI SetClipStatus(CONST D3DCLIPSTATUS9* pClipStatus);
+	virtual HRESULT WINAPI GetClipStatus(D3DCLIPSTATUS9* pClipStatus);
+	virtual HRESULT WINAPI GetTexture(DWORD Stage, IDirect3DBaseTexture9** ppTexture);
+	virtual HRESULT WINAPI SetTexture(DWORD Stage, IDirect3DBaseTexture9* pTexture);
+	virtual HRESULT WINAPI GetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD* pValue);
+	virtual HRESULT WINAPI SetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD Value);
+	virtual HRESULT WINAPI GetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD* pValue);
+	virtual HRESULT WINAPI SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD Value);
+	virtual HRESULT WINAPI ValidateDevice(DWORD* pNumPasses);
+	virtual HRESULT WINAPI SetPaletteEntries(UINT PaletteNumber, CONST PALETTEENTRY* pEntries);
+	virtual HRESULT WINAPI GetPaletteEntries(UINT PaletteNumber, PALETTEENTRY* pEntries);
+	virtual HRESULT WINAPI SetCurrentTexturePalette(UINT PaletteNumber);
+	virtual HRESULT WINAPI GetCurrentTexturePalette(UINT* PaletteNumber);
+	virtual HRESULT WINAPI SetScissorRect(CONST RECT* pRect);
+	virtual HRESULT WINAPI GetScissorRect(RECT* pRect);
+	virtual HRESULT WINAPI SetSoftwareVertexProcessing(BOOL bSoftware);
+	virtual BOOL    WINAPI GetSoftwareVertexProcessing();
+	virtual HRESULT WINAPI SetNPatchMode(float nSegments);
+	virtual float   WINAPI GetNPatchMode();
+	virtual HRESULT WINAPI DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType, UINT StartVertex, UINT PrimitiveCount);
+	virtual HRESULT WINAPI DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType, INT BaseVertexIndex, UINT MinVertexIndex, UINT NumVertices, UINT startIndex, UINT primCount);
+	virtual HRESULT WINAPI DrawPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT PrimitiveCount, CONST void* pVertexStreamZeroData, UINT VertexStreamZeroStride);
+	virtual HRESULT WINAPI DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT MinVertexIndex, UINT NumVertices, UINT PrimitiveCount, CONST void* pIndexData, D3DFORMAT IndexDataFormat, CONST void* pVertexStreamZeroData, UINT VertexStreamZeroStride);
+	virtual HRESULT WINAPI ProcessVertices(UINT SrcStartIndex, UINT DestIndex, UINT VertexCount, IDirect3DVertexBuffer9* pDestBuffer, IDirect3DVertexDeclaration9* pVertexDecl, DWORD Flags);
+	virtual HRESULT WINAPI CreateVertexDeclaration(CONST D3DVERTEXELEMENT9* pVertexElements, IDirect3DVertexDeclaration9** ppDecl);
+	virtual HRESULT WINAPI SetVertexDeclaration(IDirect3DVertexDeclaration9* pDecl);
+	virtual HRESULT WINAPI GetVertexDeclaration(IDirect3DVertexDeclaration9** ppDecl);
+	virtual HRESULT WINAPI SetFVF(DWORD FVF);
+	virtual HRESULT WINAPI GetFVF(DWORD* pFVF);
+	virtual HRESULT WINAPI CreateVertexShader(CONST DWORD* pFunction, IDirect3DVertexShader9** ppShader);
+	virtual HRESULT WINAPI SetVertexShader(IDirect3DVertexShader9* pShader);
+	virtual HRESULT WINAPI GetVertexShader(IDirect3DVertexShader9** ppShader);
+	virtual HRESULT WINAPI SetVertexShaderConstantF(UINT StartRegister, CONST float* pConstantData, UINT Vector4fCount);
+	virtual HRESULT WINAPI GetVertexShaderConstantF(UINT StartRegister, float* pConstantData, UINT Vector4fCount);
+	virtual HRESULT WINAPI SetVertexShaderConstantI(UINT StartRegister, CONST int* pConstantData, UINT Vector4iCount);
+	virtual HRESULT WINAPI GetVertexShaderConstantI(UINT StartRegister, int* pConstantData, UINT Vector4iCount);
+	virtual HRESULT WINAPI SetVertexShaderConstantB(UINT StartRegister, CONST BOOL* pConstantData, UINT BoolCount);
+	virtual HRESULT WINAPI GetVertexShaderConstantB(UINT StartRegister, BOOL* pConstantData, UINT BoolCount);
+	virtual HRESULT WINAPI SetStreamSource(UINT StreamNumber, IDirect3DVertexBuffer9* pStreamData, UINT OffsetInBytes, UINT Stride);
+	virtual HRESULT WINAPI GetStreamSource(UINT StreamNumber, IDirect3DVertexBuffer9** ppStreamData, UINT* pOffsetInBytes, UINT* pStride);
+	virtual HRESULT WINAPI SetStreamSourceFreq(UINT StreamNumber, UINT Setting);
+	virtual HRESULT WINAPI GetStreamSourceFreq(UINT StreamNumber, UINT* pSetting);
+	virtual HRESULT WINAPI SetIndices(IDirect3DIndexBuffer9* pIndexData);
+	virtual HRESULT WINAPI GetIndices(IDirect3DIndexBuffer9** ppIndexData);
+	virtual HRESULT WINAPI CreatePixelShader(CONST DWORD* pFunction, IDirect3DPixelShader9** ppShader);
+	virtual HRESULT WINAPI SetPixelShader(IDirect3DPixelShader9* pShader);
+	virtual HRESULT WINAPI GetPixelShader(IDirect3DPixelShader9** ppShader);
+	virtual HRESULT WINAPI SetPixelShaderConstantF(UINT StartRegister, CONST float* pConstantData, UINT Vector4fCount);
+	virtual HRESULT WINAPI GetPixelShaderConstantF(UINT StartRegister, float* pConstantData, UINT Vector4fCount);
+	virtual HRESULT WINAPI SetPixelShaderConstantI(UINT StartRegister, CONST int* pConstantData, UINT Vector4iCount);
+	virtual HRESULT WINAPI GetPixelShaderConstantI(UINT StartRegister, int* pConstantData, UINT Vector4iCount);
+	virtual HRESULT WINAPI SetPixelShaderConstantB(UINT StartRegister, CONST BOOL* pConstantData, UINT BoolCount);
+	virtual HRESULT WINAPI GetPixelShaderConstantB(UINT StartRegister, BOOL* pConstantData, UINT BoolCount);
+	virtual HRESULT WINAPI DrawRectPatch(UINT Handle, CONST float* pNumSegs, CONST D3DRECTPATCH_INFO* pRectPatchInfo);
+	virtual HRESULT WINAPI DrawTriPatch(UINT Handle, CONST float* pNumSegs, CONST D3DTRIPATCH_INFO* pTriPatchInfo);
+	virtual HRESULT WINAPI DeletePatch(UINT Handle);
+	virtual HRESULT WINAPI CreateQuery(D3DQUERYTYPE Type, IDirect3DQuery9** ppQuery);
+
+	/**
+	* Vertex shader float constant registers of the mock (the proxy reads MaxVertexShaderConst from the caps).
+	***/
+	static const UINT VS_CONSTANTS_F = MockDeviceState::VS_CONSTANTS_F;
+	/**
+	* Pixel shader float constant registers (shader model 3).
+	***/
+	static const UINT PS_CONSTANTS_F = MockDeviceState::PS_CONSTANTS_F;
+	/**
+	* Simultaneous render targets.
+	***/
+	static const UINT RENDER_TARGETS = 4;
+	/**
+	* Vertex streams.
+	***/
+	static const UINT STREAMS = MockDeviceState::STREAMS;
+
+private:
+	/*** MockDevice private methods ***/
+	template <class T> static void Bind(T** ppBound, T* pObject);
+	template <class T> static HRESULT Return(T* pBound, T** ppObject);
+
+	/**
+	* Compares call names by their characters, the names are string literals.
+	***/
+	struct NameLess
+	{
+		bool operator()(const char* a, const char* b) const { return strcmp(a, b) < 0; }
+	};
+
+	/**
+	* Presentation parameters the device was created with.
+	***/
+	D3DPRESENT_PARAMETERS m_parameters;
+	/**
+	* Creation flags returned by GetCreationParameters().
+	***/
+	DWORD m_behaviorFlags;
+	/**
+	* The implicit swap chain.
+	***/
+	MockSwapChain* m_pSwapChain;
+	/**
+	* The automatic depth stencil, NULL if not enabled.
+	***/
+	MockSurface* m_pAutoDepthStencil;
+	/**
+	* True if calls are added to the call log.
+	***/
+	bool m_recording;
+	/**
+	* Number of calls since the last ClearCalls().
+	***/
+	size_t m_calls;
+	/**
+	* Number of calls by method name since the last ClearCalls().
+	***/
+	std::map<const char*, size_t, NameLess> m_counts;
+	/**
+	* Calls recorded while recording was on.
+	***/
+	std::vector<std::string> m_callLog;
+	/**
+	* Bound render targets.
+	***/
+	IDirect3DSurface9* m_pRenderTargets[RENDER_TARGETS];
+	/**
+	* Bound depth stencil.
+	***/
+	IDirect3DSurface9* m_pDepthStencil;
+	/**
+	* Pipeline state (the part state blocks capture).
+	***/
+	MockDeviceState m_state;
+	/**
+	* Miscellaneous states not captured by state blocks.
+	***/
+	D3DCLIPSTATUS9 m_clipStatus;
+	BOOL m_softwareVertexProcessing;
+	float m_nPatchMode;
+	UINT m_texturePalette;
+};
+
+template <class T>
+HRESULT WINAPI MockResource<T>::GetDevice(IDirect3DDevice9** ppDevice)
+{
+	*ppDevice = (IDirect3DDevice9*)m_pDevice;
+	(*ppDevice)->AddRef();
+	return D3D_OK;
+}
+
+template <class T>
+HRESULT WINAPI MockShader<T>::GetDevice(IDirect3DDevice9** ppDevice)
+{
+	*ppDevice = (IDirect3DDevice9*)m_pDevice;
+	(*ppDevice)->AddRef();
+	return D3D_OK;
+}
+#endif
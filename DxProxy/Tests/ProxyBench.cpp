@@ -0,0 +1,464 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ProxyBench.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ProxyHarness.h"
+#include "ShaderRegisters.h"
+#include "StereoShaderConstant.h"
+#include "ShaderConstantModificationFactory.h"
+#include "MurmurHash3.h"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+
+/**
+* Proxy micro-benchmarks on the mock device : register updates, uploads and captures, constant modifications,
+* view transforms, shader hashing and the proxy per draw call. The actual device records nothing, so
+* the timings are the proxy overhead without driver cost.
+* Writes "<name>\t<iterations>\t<min ns per op>\t<median ns per op>" lines.
+***/
+
+static const unsigned REPETITIONS = 7;
+
+/**
+* Keeps the computed results alive.
+***/
+static float sink = 0.0f;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+/**
+* Nanoseconds per iteration since start.
+***/
+static double Elapsed(Clock::time_point start, unsigned iterations)
+{
+	std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+	return elapsed.count() / iterations;
+}
+
+/**
+* Prints the minimum and median of the repetitions.
+***/
+static void Report(const char* name, unsigned iterations, std::vector<double>& results)
+{
+	std::sort(results.begin(), results.end());
+	printf("%s\t%u\t%.1f\t%.1f\n", name, iterations, results[0], results[results.size() / 2]);
+}
+
+/**
+* Mock device with the back buffer of the proxy harness.
+***/
+static MockDevice* CreateMockDevice()
+{
+	D3DPRESENT_PARAMETERS parameters;
+	ZeroMemory(&parameters, sizeof(parameters));
+	parameters.BackBufferWidth = 1280;
+	parameters.BackBufferHeight = 720;
+	parameters.BackBufferFormat = D3DFMT_X8R8G8B8;
+	parameters.BackBufferCount = 1;
+	parameters.SwapEffect = D3DSWAPEFFECT_DISCARD;
+	parameters.Windowed = TRUE;
+	return new MockDevice(parameters);
+}
+
+/**
+* Register updates as issued per draw call : eight 4-register constants (matrices), spread over the
+* register file and adjacent (coalescing case), followed by ApplyAllDirty().
+* The input alternates between two register images so every write changes the registers (unchanged
+* registers are neither marked dirty nor uploaded), the unchanged case is measured separately.
+***/
+static void BenchmarkShaderRegisters(std::shared_ptr<ViewAdjustment> spAdjustment)
+{
+	const UINT registerCount = 256;
+
+	MockDevice* pDevice = CreateMockDevice();
+	ProxyCounterValues counters;
+	ZeroMemory(&counters, sizeof(ProxyCounterValues));
+	ShaderRegisters registers(1, registerCount, pDevice, &counters, spAdjustment);
+
+	std::vector<float> data(registerCount * VECTOR_LENGTH);
+	std::vector<float> alternate(data.size());
+	for (size_t i = 0; i < data.size(); i++) {
+		data[i] = (float)i;
+		alternate[i] = (float)i + 1.0f;
+	}
+	registers.SetVertexShaderConstantF(0, &data[0], registerCount);
+	registers.ApplyAllDirty(vireio::Left);
+
+	std::vector<double> results;
+
+	// single calls, spread, changed and unchanged
+	const unsigned setIterations = 20000;
+	for (int unchanged = 0; unchanged < 2; unchanged++) {
+		results.clear();
+		for (unsigned repetition = 0; repetition < REPETITIONS; repetition++) {
+			Clock::time_point start = Clock::now();
+
+			for (unsigned i = 0; i < setIterations; i++) {
+				UINT startRegister = (i & 7) * 8;
+				const float* pImage = (!unchanged && (i & 8)) ? &alternate[0] : &data[0];
+				registers.SetVertexShaderConstantF(startRegister, pImage + startRegister * VECTOR_LENGTH, 4);
+			}
+
+			results.push_back(Elapsed(start, setIterations));
+			registers.ApplyAllDirty(vireio::Left);
+		}
+		Report(unchanged ? "ShaderRegisters::SetVertexShaderConstantF/unchanged" : "ShaderRegisters::SetVertexShaderConstantF", setIterations, results);
+	}
+
+	// 8 constants and apply, spread and adjacent, then spread with unchanged values
+	const unsigned applyIterations = 2000;
+	static const struct
+	{
+		UINT        stride;
+		bool        unchanged;
+		const char* name;
+	} applyCases[] =
+	{
+		{8, false, "ShaderRegisters::ApplyAllDirty/8x4_spread"},
+		{4, false, "ShaderRegisters::ApplyAllDirty/8x4_adjacent"},
+		{8, true,  "ShaderRegisters::ApplyAllDirty/8x4_unchanged"}
+	};
+
+	for (size_t applyCase = 0; applyCase < sizeof(applyCases) / sizeof(applyCases[0]); applyCase++) {
+		UINT stride = applyCases[applyCase].stride;
+		results.clear();
+		for (unsigned repetition = 0; repetition < REPETITIONS; repetition++) {
+			Clock::time_point start = Clock::now();
+
+			for (unsigned i = 0; i < applyIterations; i++) {
+				const float* pImage = (!applyCases[applyCase].unchanged && (i & 1)) ? &alternate[0] : &data[0];
+				for (UINT constant = 0; constant < 8; constant++) {
+					UINT startRegister = constant * stride;
+					registers.SetVertexShaderConstantF(startRegister, pImage + startRegister * VECTOR_LENGTH, 4);
+				}
+				registers.ApplyAllDirty(vireio::Left);
+			}
+
+			results.push_back(Elapsed(start, applyIterations));
+		}
+		Report(applyCases[applyCase].name, applyIterations, results);
+	}
+
+	pDevice->Release();
+}
+
+/**
+* State block capture of the vertex shader register file (256 registers) after eight 4-register
+* constants were written, spread (8 pages) and adjacent (2 pages), and without writes, against the
+* full copy of the register file the state blocks made before.
+***/
+static void BenchmarkRegisterCapture(std::shared_ptr<ViewAdjustment> spAdjustment)
+{
+	const UINT registerCount = 256;
+
+	MockDevice* pDevice = CreateMockDevice();
+	ProxyCounterValues counters;
+	ZeroMemory(&counters, sizeof(ProxyCounterValues));
+	ShaderRegisters registers(1, registerCount, pDevice, &counters, spAdjustment);
+
+	std::vector<float> data(registerCount * VECTOR_LENGTH);
+	std::vector<float> alternate(data.size());
+	for (size_t i = 0; i < data.size(); i++) {
+		data[i] = (float)i;
+		alternate[i] = (float)i + 1.0f;
+	}
+	registers.SetVertexShaderConstantF(0, &data[0], registerCount);
+
+	const unsigned iterations = 20000;
+	std::vector<double> results;
+	static const struct
+	{
+		UINT        stride;
+		const char* name;
+	} captureCases[] =
+	{
+		{32, "ShaderRegisters::CaptureVSConstantRegistersF/8x4_spread"},
+		{4,  "ShaderRegisters::CaptureVSConstantRegistersF/8x4_adjacent"},
+		{0,  "ShaderRegisters::CaptureVSConstantRegistersF/unchanged"}
+	};
+
+	for (size_t captureCase = 0; captureCase < sizeof(captureCases) / sizeof(captureCases[0]); captureCase++) {
+		UINT stride = captureCases[captureCase].stride;
+		RegisterSnapshot snapshot;
+		results.clear();
+		for (unsigned repetition = 0; repetition < REPETITIONS; repetition++) {
+			Clock::time_point start = Clock::now();
+
+			for (unsigned i = 0; i < iterations; i++) {
+				const float* pImage = (i & 1) ? &alternate[0] : &data[0];
+				for (UINT constant = 0; stride && (constant < 8); constant++) {
+					UINT startRegister = constant * stride;
+					registers.SetVertexShaderConstantF(startRegister, pImage + startRegister * VECTOR_LENGTH, 4);
+				}
+				snapshot = registers.CaptureVSConstantRegistersF();
+			}
+
+			results.push_back(Elapsed(start, iterations));
+		}
+		sink += snapshot->pages[0]->registers[0];
+		Report(captureCases[captureCase].name, iterations, results);
+	}
+
+	// the writes and a full copy of the register file
+	std::vector<float> copy;
+	results.clear();
+	for (unsigned repetition = 0; repetition < REPETITIONS; repetition++) {
+		Clock::time_point start = Clock::now();
+
+		for (unsigned i = 0; i < iterations; i++) {
+			const float* pImage = (i & 1) ? &alternate[0] : &data[0];
+			for (UINT constant = 0; constant < 8; constant++) {
+				UINT startRegister = constant * 32;
+				registers.SetVertexShaderConstantF(startRegister, pImage + startRegister * VECTOR_LENGTH, 4);
+			}
+			copy = registers.GetAllVSConstantRegistersF();
+		}
+
+		results.push_back(Elapsed(start, iterations));
+	}
+	sink += copy[0];
+	Report("ShaderRegisters::GetAllVSConstantRegistersF/8x4_spread_full_copy", iterations, results);
+
+	pDevice->Release();
+}
+
+/**
+* StereoShaderConstant::Update() for every constant modification, matrices once perspective
+* and once orthographic (the squash modifications branch on that).
+* The input alternates between two matrices so every update is computed, the memoized case
+* (unchanged input) is measured separately.
+***/
+static void BenchmarkModifications(std::shared_ptr<ViewAdjustment> spAdjustment)
+{
+	static const struct
+	{
+		ShaderConstantModificationFactory::MatrixModificationTypes type;
+		const char* name;
+	} matrixModifications[] =
+	{
+		{ShaderConstantModificationFactory::MatDoNothing,                  "MatDoNothing"},
+		{ShaderConstantModificationFactory::MatSimpleTranslate,            "MatSimpleTranslate"},
+		{ShaderConstantModificationFactory::MatOrthographicSquash,         "MatOrthographicSquash"},
+		{ShaderConstantModificationFactory::MatSimpleTranslateIgnoreOrtho, "MatSimpleTranslateIgnoreOrtho"},
+		{ShaderConstantModificationFactory::MatHudSquash,                  "MatHudSquash"},
+		{ShaderConstantModificationFactory::MatSurfaceRefractionTransform, "MatSurfaceRefractionTransform"},
+		{ShaderConstantModificationFactory::MatGatheredOrthographicSquash, "MatGatheredOrthographicSquash"},
+		{ShaderConstantModificationFactory::MatOrthographicSquashShifted,  "MatOrthographicSquashShifted"},
+		{ShaderConstantModificationFactory::MatOrthographicSquashHud,      "MatOrthographicSquashHud"}
+	};
+
+	D3DXMATRIX view, perspective, orthographic;
+	D3DXVECTOR3 eye(1.0f, 2.0f, -5.0f), at(0.0f, 0.0f, 0.0f), up(0.0f, 1.0f, 0.0f);
+	D3DXMatrixLookAtLH(&view, &eye, &at, &up);
+	D3DXMatrixPerspectiveFovLH(&perspective, (float)D3DX_PI / 3.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+	D3DXMatrixOrthoLH(&orthographic, 1920.0f, 1080.0f, 0.0f, 1.0f);
+	perspective = view * perspective;
+
+	const unsigned iterations = 50000;
+	std::vector<double> results;
+	char name[96];
+
+	for (size_t i = 0; i < sizeof(matrixModifications) / sizeof(matrixModifications[0]); i++) {
+		for (int ortho = 0; ortho < 2; ortho++) {
+			const float* pData = ortho ? (const float*)orthographic : (const float*)perspective;
+			D3DXMATRIX alternate(pData);
+			alternate._41 += 0.001f;
+			const float* pAlternate = (const float*)alternate;
+			std::shared_ptr<ShaderConstantModification<float>> modification =
+				ShaderConstantModificationFactory::CreateMatrixModification(matrixModifications[i].type, spAdjustment, false);
+			StereoShaderConstant<float> constant(0, pData, 4, modification.get());
+
+			results.clear();
+			for (unsigned repetition = 0; repetition < REPETITIONS; repetition++) {
+				Clock::time_point start = Clock::now();
+
+				for (unsigned j = 0; j < iterations; j++)
+					constant.Update((j & 1) ? pAlternate : pData);
+
+				results.push_back(Elapsed(start, iterations));
+			}
+			sink += constant.DataLeftPointer()[0];
+
+			snprintf(name, sizeof(name), "StereoShaderConstant::Update/%s/%s", matrixModifications[i].name, ortho ? "ortho" : "perspective");
+			Report(name, iterations, results);
+		}
+	}
+
+	// vector modification
+	D3DXVECTOR4 position(1.0f, 2.0f, 3.0f, 1.0f);
+	D3DXVECTOR4 alternatePosition(1.0f, 2.0f, 3.001f, 1.0f);
+	std::shared_ptr<ShaderConstantModification<float>> vectorModification =
+		ShaderConstantModificationFactory::CreateVector4Modification(ShaderConstantModificationFactory::Vec4SimpleTranslate, spAdjustment);
+	StereoShaderConstant<float> constant(0, (const float*)position, 1, vectorModification.get());
+
+	results.clear();
+	for (unsigned repetition = 0; repetition < REPETITIONS; repetition++) {
+		Clock::time_point start = Clock::now();
+
+		for (unsigned j = 0; j < iterations; j++)
+			constant.Update((j & 1) ? (const float*)alternatePosition : (const float*)position);
+
+		results.push_back(Elapsed(start, iterations));
+	}
+	sink += constant.DataLeftPointer()[0];
+	Report("StereoShaderConstant::Update/Vec4SimpleTranslate", iterations, results);
+
+	// unchanged input, modification skipped
+	std::shared_ptr<ShaderConstantModification<float>> unchangedModification =
+		ShaderConstantModificationFactory::CreateMatrixModification(ShaderConstantModificationFactory::MatSimpleTranslate, spAdjustment, false);
+	StereoShaderConstant<float> unchanged(0, (const float*)perspective, 4, unchangedModification.get());
+
+	results.clear();
+	for (unsigned repetition = 0; repetition < REPETITIONS; repetition++) {
+		Clock::time_point start = Clock::now();
+
+		for (unsigned j = 0; j < iterations; j++)
+			unchanged.Update((const float*)perspective);
+
+		results.push_back(Elapsed(start, iterations));
+	}
+	sink += unchanged.DataLeftPointer()[0];
+	Report("StereoShaderConstant::Update/unchanged", iterations, results);
+}
+
+/**
+* ViewAdjustment::ComputeViewTransforms(), done once per frame.
+* The roll changes before every computation, so every computation changes the transforms and the
+* generation (a moving head).
+***/
+static void BenchmarkViewTransforms(std::shared_ptr<ViewAdjustment> spAdjustment)
+{
+	const unsigned iterations = 50000;
+	std::vector<double> results;
+
+	for (unsigned repetition = 0; repetition < REPETITIONS; repetition++) {
+		Clock::time_point start = Clock::now();
+
+		for (unsigned i = 0; i < iterations; i++) {
+			spAdjustment->UpdateRoll((i & 1) ? 0.01f : 0.0f);
+			spAdjustment->ComputeViewTransforms();
+		}
+
+		results.push_back(Elapsed(start, iterations));
+	}
+	sink += spAdjustment->LeftAdjustmentMatrix()._11;
+	Report("ViewAdjustment::ComputeViewTransforms", iterations, results);
+}
+
+/**
+* MurmurHash3_x86_32 over typical shader bytecode sizes (shader hashes are computed on creation).
+***/
+static void BenchmarkMurmurHash()
+{
+	static const unsigned sizes[] = {1024, 4096, 16384, 65536};
+
+	std::vector<BYTE> data(65536);
+	UINT seed = 0x12345678;
+	for (size_t i = 0; i < data.size(); i++) {
+		seed = seed * 1664525 + 1013904223;
+		data[i] = (BYTE)(seed >> 24);
+	}
+
+	std::vector<double> results;
+	char name[64];
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		unsigned iterations = (16 << 20) / sizes[i];
+		uint32_t hash = 0;
+
+		results.clear();
+		for (unsigned repetition = 0; repetition < REPETITIONS; repetition++) {
+			Clock::time_point start = Clock::now();
+
+			for (unsigned j = 0; j < iterations; j++)
+				MurmurHash3_x86_32(&data[0], sizes[i], hash, &hash);
+
+			results.push_back(Elapsed(start, iterations));
+		}
+		sink += (float)hash;
+
+		snprintf(name, sizeof(name), "MurmurHash3_x86_32/%u", sizes[i]);
+		Report(name, iterations, results);
+	}
+}
+
+/**
+* D3DProxyDevice per draw call : a 4-register constant and an indexed draw in a stereo frame, both
+* eyes drawn by the proxy. The constant alternates so every draw uploads it for each eye.
+***/
+static void BenchmarkProxyDraw()
+{
+	ProxyHarness harness(ProxyHarness::DefaultConfig());
+	IDirect3DDevice9* pProxy = harness.m_pProxy;
+
+	float data[2][16];
+	for (int i = 0; i < 16; i++) {
+		data[0][i] = (float)i;
+		data[1][i] = (float)i + 1.0f;
+	}
+
+	const unsigned draws = 100;
+	const unsigned frames = 100;
+	std::vector<double> results;
+
+	for (unsigned repetition = 0; repetition < REPETITIONS; repetition++) {
+		Clock::time_point start = Clock::now();
+
+		for (unsigned frame = 0; frame < frames; frame++) {
+			pProxy->BeginScene();
+			for (unsigned i = 0; i < draws; i++) {
+				pProxy->SetVertexShaderConstantF(0, data[i & 1], 4);
+				pProxy->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 100, 0, 50);
+			}
+			pProxy->EndScene();
+			pProxy->Present(NULL, NULL, NULL, NULL);
+		}
+
+		results.push_back(Elapsed(start, frames * draws));
+	}
+	Report("D3DProxyDevice::DrawIndexedPrimitive/100_per_frame", frames * draws, results);
+}
+
+int main()
+{
+	printf("# name\titerations\tmin_ns\tmedian_ns\n");
+
+	HMDisplayInfo defaultInfo;
+	std::shared_ptr<ViewAdjustment> spAdjustment = std::make_shared<ViewAdjustment>(defaultInfo, 1.0f, true);
+	spAdjustment->UpdateProjectionMatrices(16.0f / 9.0f);
+	spAdjustment->ComputeViewTransforms();
+
+	BenchmarkShaderRegisters(spAdjustment);
+	BenchmarkRegisterCapture(spAdjustment);
+	BenchmarkModifications(spAdjustment);
+	BenchmarkViewTransforms(spAdjustment);
+	BenchmarkMurmurHash();
+	BenchmarkProxyDraw();
+
+	return sink != 0.0f ? 0 : 1;
+}
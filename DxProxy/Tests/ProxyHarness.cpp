@@ -0,0 +1,131 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ProxyHarness.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ProxyHarness.h"
+#include "MotionTrackerFactory.h"
+
+/**
+* Roll reported by the harness tracker, in radians.
+***/
+float ProxyHarness::s_roll = 0.0f;
+
+/**
+* Tracker of the headless proxy, reports no yaw and pitch and the roll set by the test.
+*/
+class HarnessTracker : public MotionTracker
+{
+public:
+	virtual void updateOrientation() { currentRoll = ProxyHarness::s_roll; }
+	virtual bool isAvailable() { return true; }
+};
+
+/**
+* Replaces MotionTrackerFactory.cpp (the trackers need their SDKs), returns the harness tracker.
+***/
+MotionTracker* MotionTrackerFactory::Get(ProxyHelper::ProxyConfig& config)
+{
+	return new HarnessTracker();
+}
+
+/**
+* Constructor, creates the mock device and the proxy and initializes the proxy as Direct3D9::CreateDevice() does.
+* @param config The game configuration.
+* @param width Back buffer width.
+* @param height Back buffer height.
+***/
+ProxyHarness::ProxyHarness(const ProxyHelper::ProxyConfig& config, UINT width, UINT height) :
+	m_pProxy(NULL),
+	m_pDevice(NULL)
+{
+	D3DPRESENT_PARAMETERS parameters;
+	ZeroMemory(&parameters, sizeof(parameters));
+	parameters.BackBufferWidth = width;
+	parameters.BackBufferHeight = height;
+	parameters.BackBufferFormat = D3DFMT_X8R8G8B8;
+	parameters.BackBufferCount = 1;
+	parameters.SwapEffect = D3DSWAPEFFECT_DISCARD;
+	parameters.Windowed = TRUE;
+	parameters.EnableAutoDepthStencil = TRUE;
+	parameters.AutoDepthStencilFormat = D3DFMT_D24S8;
+
+	// the proxy owns the reference it gets, the harness keeps its own
+	m_pDevice = new MockDevice(parameters);
+	m_pDevice->AddRef();
+
+	ProxyHelper::ProxyConfig proxyConfig = config;
+	m_pProxy = new D3DProxyDevice(m_pDevice, NULL);
+	m_pProxy->Init(proxyConfig);
+}
+
+/**
+* Destructor, releases the proxy and the mock device.
+***/
+ProxyHarness::~ProxyHarness()
+{
+	m_pProxy->Release();
+	m_pDevice->Release();
+}
+
+/**
+* Returns the configuration ProxyHelper::LoadConfig() sets for a game profile without attributes
+* (side by side, no shader rules), deferred right eye, mono draw elision and instanced stereo off.
+***/
+ProxyHelper::ProxyConfig ProxyHarness::DefaultConfig()
+{
+	ProxyHelper::ProxyConfig config;
+	config.game_type = 0;
+	config.stereo_mode = StereoView::SIDE_BY_SIDE;
+	config.tracker_mode = 0;
+	config.aspect_multiplier = 1.0f;
+	config.swap_eyes = false;
+	config.yaw_multiplier = 25.0f;
+	config.pitch_multiplier = 25.0f;
+	config.roll_multiplier = 1.0f;
+	config.worldScaleFactor = 1.0f;
+	config.rollEnabled = false;
+	config.deferredRightEye = false;
+	config.monoDrawElision = false;
+	config.instancedStereo = false;
+	config.constantUploadGap = 4;
+	config.shaderRulePath = "";
+	config.ipd = IPD_DEFAULT;
+	config.convergence = 0.0f;
+	config.hud3DDepthMode = 0;
+	config.gui3DDepthMode = 0;
+	for (int i = 0; i < 4; i++) {
+		config.hud3DDepthPresets[i] = 0.0f;
+		config.hudDistancePresets[i] = 0.5f;
+		config.gui3DDepthPresets[i] = 0.0f;
+		config.guiSquishPresets[i] = 0.6f;
+	}
+	for (int i = 0; i < 5; i++) {
+		config.hudHotkeys[i] = 0;
+		config.guiHotkeys[i] = 0;
+	}
+	return config;
+}
@@ -0,0 +1,61 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ProxyHarness.h> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef PROXYHARNESS_H_INCLUDED
+#define PROXYHARNESS_H_INCLUDED
+
+#include "D3DProxyDevice.h"
+#include "MockDevice.h"
+
+/**
+* Runs D3DProxyDevice headless : the proxy wraps a MockDevice instead of a Direct3D device, the Windows
+* and D3DX functions it uses come from the shim (Tests/Shim). No tracker hardware, MotionTrackerFactory
+* returns a tracker reporting the roll in s_roll (applied if the configuration enables roll).
+*/
+class ProxyHarness
+{
+public:
+	ProxyHarness(const ProxyHelper::ProxyConfig& config, UINT width = 1280, UINT height = 720);
+	virtual ~ProxyHarness();
+
+	static ProxyHelper::ProxyConfig DefaultConfig();
+
+	/**
+	* The proxy, the device the game calls.
+	***/
+	D3DProxyDevice* m_pProxy;
+	/**
+	* The actual device behind the proxy.
+	***/
+	MockDevice* m_pDevice;
+	/**
+	* Roll the tracker reports, in radians, read at the first BeginScene() of each frame.
+	***/
+	static float s_roll;
+};
+#endif
@@ -0,0 +1,131 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ProxyReplay.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "D3D9TraceDevice.h"
+#include "ProxyHarness.h"
+
+/**
+* Replays a call trace through D3DProxyDevice on a mock device and prints the time and the number of
+* actual device calls of each frame, to compare the proxy options on a recorded game.
+* Usage : ProxyReplay [-deferred] [-instanced] [-monoelision] [-gap <registers>] <trace.vct>
+* Returns 0 if the trace replayed without errors, 1 if it has errors, 2 if it could not be read.
+***/
+
+/**
+* Counts the actual device calls of each frame.
+***/
+class ProxyTraceDevice : public D3D9TraceDevice
+{
+public:
+	ProxyTraceDevice(ProxyHarness* pHarness) : D3D9TraceDevice(pHarness->m_pProxy), m_pHarness(pHarness) {}
+
+	virtual void Execute(const CallTraceReader::Record& record, void* const* pObjects)
+	{
+		D3D9TraceDevice::Execute(record, pObjects);
+		if (record.call == CallTraceFormat::Call_Present) {
+			m_frameCalls.push_back(m_pHarness->m_pDevice->Calls());
+			m_frameDraws.push_back(m_pHarness->m_pDevice->Count("DrawPrimitive") + m_pHarness->m_pDevice->Count("DrawIndexedPrimitive") +
+				m_pHarness->m_pDevice->Count("DrawPrimitiveUP") + m_pHarness->m_pDevice->Count("DrawIndexedPrimitiveUP"));
+			m_pHarness->m_pDevice->ClearCalls();
+		}
+	}
+
+	/**
+	* Actual device calls of each frame.
+	***/
+	std::vector<size_t> m_frameCalls;
+	/**
+	* Actual device draws of each frame.
+	***/
+	std::vector<size_t> m_frameDraws;
+
+private:
+	ProxyHarness* m_pHarness;
+};
+
+int main(int argc, char* argv[])
+{
+	ProxyHelper::ProxyConfig config = ProxyHarness::DefaultConfig();
+	const char* fileName = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-deferred") == 0)
+			config.deferredRightEye = true;
+		else if (strcmp(argv[i], "-instanced") == 0)
+			config.instancedStereo = true;
+		else if (strcmp(argv[i], "-monoelision") == 0)
+			config.monoDrawElision = true;
+		else if ((strcmp(argv[i], "-gap") == 0) && (i + 1 < argc))
+			config.constantUploadGap = atoi(argv[++i]);
+		else if (!fileName && (argv[i][0] != '-'))
+			fileName = argv[i];
+		else {
+			fileName = NULL;
+			break;
+		}
+	}
+	if (!fileName) {
+		fprintf(stderr, "Usage : ProxyReplay [-deferred] [-instanced] [-monoelision] [-gap <registers>] <trace.vct>\n");
+		return 2;
+	}
+
+	CallTraceReader reader;
+	if (!reader.Load(fileName)) {
+		fprintf(stderr, "%s: %s\n", fileName, reader.Error());
+		return 2;
+	}
+
+	bool valid;
+	{
+		ProxyHarness harness(config);
+		harness.m_pDevice->ClearCalls();
+
+		ProxyTraceDevice device(&harness);
+		CallTraceReplayer replayer(&device);
+		valid = replayer.Replay(&reader);
+
+		printf("frame\tms\tdevice calls\tdevice draws\n");
+		double total = 0.0;
+		for (size_t i = 0; i < device.FrameTimes().size(); i++) {
+			printf("%u\t%.3f\t%u\t%u\n", (unsigned)i, device.FrameTimes()[i], (unsigned)device.m_frameCalls[i], (unsigned)device.m_frameDraws[i]);
+			total += device.FrameTimes()[i];
+		}
+		if (!device.FrameTimes().empty())
+			fprintf(stderr, "%s: %u frames, %.3f ms per frame, %u failed calls\n", fileName, (unsigned)device.FrameTimes().size(),
+				total / (double)device.FrameTimes().size(), (unsigned)device.FailedCalls());
+
+		for (size_t i = 0; i < replayer.Errors().size(); i++)
+			fprintf(stderr, "%s\n", replayer.Errors()[i].c_str());
+		if (replayer.ErrorCount() > replayer.Errors().size())
+			fprintf(stderr, "... %u more errors\n", (unsigned)(replayer.ErrorCount() - replayer.Errors().size()));
+	}
+
+	return valid ? 0 : 1;
+}
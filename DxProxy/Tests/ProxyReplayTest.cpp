@@ -0,0 +1,167 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ProxyReplayTest.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "D3D9TraceDevice.h"
+#include "ProxyHarness.h"
+#include "ShaderBlob.h"
+#include "TestCheck.h"
+#include "TraceWriter.h"
+
+/**
+* Tests of the headless proxy : call traces replayed through D3DProxyDevice on a mock device.
+***/
+
+typedef CallTraceFormat F;
+
+static ShaderBlob VertexShader()
+{
+	ShaderBlob blob(ShaderBlob::VS(2, 0));
+	blob.Instruction(ShaderBlob::Op_Dcl, {0x80000000, ShaderBlob::Dst(ShaderBlob::Reg_Input, 0)});
+	blob.Instruction(ShaderBlob::Op_Dp4, {ShaderBlob::Dst(ShaderBlob::Reg_RastOut, 0), ShaderBlob::Src(ShaderBlob::Reg_Input, 0), ShaderBlob::Src(ShaderBlob::Reg_Const, 0)});
+	blob.End();
+	return blob;
+}
+
+static ShaderBlob PixelShader()
+{
+	ShaderBlob blob(ShaderBlob::PS(2, 0));
+	blob.Instruction(ShaderBlob::Op_Mov, {ShaderBlob::Dst(ShaderBlob::Reg_ColorOut, 0), ShaderBlob::Src(ShaderBlob::Reg_Const, 0)});
+	blob.End();
+	return blob;
+}
+
+/**
+* Position float3 at stream 0, D3DDECL_END.
+***/
+static const uint8_t declaration[16] = {0, 0, 0, 0, 2, 0, 0, 0, 0xFF, 0, 0, 0, 17, 0, 0, 0};
+
+/**
+* Frames of a game drawing with shaders : each frame clears, sets the pipeline and draws
+* with a new matrix.
+***/
+static TraceWriter GameTrace(int frames, int drawsPerFrame)
+{
+	ShaderBlob vs = VertexShader();
+	ShaderBlob ps = PixelShader();
+	float matrix[16] = {1.0f, 0, 0, 0, 0, 1.0f, 0, 0, 0, 0, 1.0f, 0, 0, 0, 0, 1.0f};
+
+	TraceWriter trace;
+	trace.Record(F::Call_DefineVertexDeclaration, {1}, declaration, sizeof(declaration));
+	trace.Record(F::Call_DefineVertexShader, {2}, vs.Data(), vs.Size());
+	trace.Record(F::Call_DefinePixelShader, {3}, ps.Data(), ps.Size());
+	trace.Record(F::Call_DefineVertexBuffer, {4, 4096, 8, 0, 0});
+	trace.Record(F::Call_DefineIndexBuffer, {5, 1024, 8, 101, 0});
+	for (int frame = 0; frame < frames; frame++) {
+		trace.Record(F::Call_BeginScene, {});
+		trace.Record(F::Call_Clear, {0, 7, 0xFF000000, 0x3F800000, 0});
+		trace.Record(F::Call_SetVertexDeclaration, {1});
+		trace.Record(F::Call_SetVertexShader, {2});
+		trace.Record(F::Call_SetPixelShader, {3});
+		trace.Record(F::Call_SetStreamSource, {0, 4, 0, 12});
+		trace.Record(F::Call_SetIndices, {5});
+		for (int draw = 0; draw < drawsPerFrame; draw++) {
+			matrix[12] = (float)draw;
+			trace.Record(F::Call_SetVertexShaderConstantF, {0, 4}, matrix, sizeof(matrix));
+			trace.Record(F::Call_DrawIndexedPrimitive, {4, 0, 0, 100, 0, 50});
+		}
+		trace.Record(F::Call_EndScene, {});
+		trace.Record(F::Call_Present, {});
+	}
+	return trace;
+}
+
+/**
+* Replays a trace through a new proxy, returns the number of actual device calls.
+***/
+static size_t Replay(const TraceWriter& trace, const ProxyHelper::ProxyConfig& config, size_t* pDraws, size_t* pFrames)
+{
+	ProxyHarness harness(config);
+	harness.m_pDevice->ClearCalls();
+
+	CallTraceReader reader;
+	CHECK(reader.Open(&trace.m_data[0], trace.m_data.size()));
+
+	size_t calls;
+	{
+		D3D9TraceDevice device(harness.m_pProxy);
+		CallTraceReplayer replayer(&device);
+		CHECK(replayer.Replay(&reader));
+		CHECK(device.FailedCalls() == 0);
+		CHECK(device.FrameTimes().size() == replayer.Frames());
+		for (size_t i = 0; i < device.FrameTimes().size(); i++)
+			CHECK(device.FrameTimes()[i] >= 0.0);
+
+		calls = harness.m_pDevice->Calls();
+		*pDraws = harness.m_pDevice->Count("DrawIndexedPrimitive");
+		*pFrames = replayer.Frames();
+	}
+	return calls;
+}
+
+/**
+* Each game draw reaches the actual device once per eye, each frame is presented once.
+***/
+static void TestReplayStereo()
+{
+	TraceWriter trace = GameTrace(3, 4);
+	ProxyHelper::ProxyConfig config = ProxyHarness::DefaultConfig();
+
+	size_t draws = 0;
+	size_t frames = 0;
+	size_t calls = Replay(trace, config, &draws, &frames);
+	CHECK(frames == 3);
+	CHECK(draws == 2 * 3 * 4);
+	CHECK(calls > draws);
+}
+
+/**
+* Deferred right eye draws the same, with fewer actual device calls (the eyes are not switched per draw).
+***/
+static void TestReplayDeferred()
+{
+	TraceWriter trace = GameTrace(3, 16);
+	ProxyHelper::ProxyConfig config = ProxyHarness::DefaultConfig();
+
+	size_t draws = 0;
+	size_t frames = 0;
+	size_t immediateCalls = Replay(trace, config, &draws, &frames);
+
+	config.deferredRightEye = true;
+	size_t deferredDraws = 0;
+	size_t deferredCalls = Replay(trace, config, &deferredDraws, &frames);
+	CHECK(frames == 3);
+	CHECK(deferredDraws == draws);
+	CHECK(deferredCalls < immediateCalls);
+}
+
+int main()
+{
+	TestReplayStereo();
+	TestReplayDeferred();
+	return TestResult("ProxyReplayTest");
+}
@@ -0,0 +1,249 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ShaderBlob.h> and
+Class <ShaderBlob> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef SHADERBLOB_H_INCLUDED
+#define SHADERBLOB_H_INCLUDED
+
+#include <stdint.h>
+#include <string.h>
+#include <initializer_list>
+#include <vector>
+
+/**
+* Assembles shader functions token by token, in the layout fxc emits (version token, constant table
+* comment, instructions, end token), for the portable tests and benchmarks.
+* Shader model 1 instructions carry no length, shader model 2 and above store the number of
+* following tokens in bits 24 to 27 of the instruction token.
+*/
+class ShaderBlob
+{
+public:
+	/**
+	* Register types (as D3DSHADER_PARAM_REGISTER_TYPE).
+	***/
+	enum RegisterTypes
+	{
+		Reg_Temp = 0,
+		Reg_Input = 1,
+		Reg_Const = 2,
+		Reg_Addr = 3,
+		Reg_Texture = 3,
+		Reg_RastOut = 4,
+		Reg_AttrOut = 5,
+		Reg_Output = 6,
+		Reg_ConstInt = 7,
+		Reg_ColorOut = 8,
+		Reg_DepthOut = 9,
+		Reg_Sampler = 10,
+		Reg_Const2 = 11,
+		Reg_Const3 = 12,
+		Reg_Const4 = 13,
+		Reg_ConstBool = 14,
+		Reg_Loop = 15
+	};
+
+	/**
+	* Opcodes used by the tests (as D3DSHADER_INSTRUCTION_OPCODE_TYPE).
+	***/
+	enum Opcodes
+	{
+		Op_Mov = 0x01,
+		Op_Add = 0x02,
+		Op_Mad = 0x04,
+		Op_Mul = 0x05,
+		Op_Dp3 = 0x08,
+		Op_Dp4 = 0x09,
+		Op_M4x4 = 0x14,
+		Op_M4x3 = 0x15,
+		Op_M3x4 = 0x16,
+		Op_M3x3 = 0x17,
+		Op_M3x2 = 0x18,
+		Op_Call = 0x19,
+		Op_Loop = 0x1B,
+		Op_Ret = 0x1C,
+		Op_EndLoop = 0x1D,
+		Op_Label = 0x1E,
+		Op_Dcl = 0x1F,
+		Op_Mova = 0x2E,
+		Op_Texkill = 0x41,
+		Op_Tex = 0x42,
+		Op_Def = 0x51,
+		Op_DefI = 0x52,
+		Op_DefB = 0x53,
+		Op_Phase = 0xFFFD
+	};
+
+	/**
+	* One constant of the constant table.
+	***/
+	struct TableConstant
+	{
+		const char*        name;
+		uint16_t           registerSet;
+		uint16_t           registerIndex;
+		uint16_t           registerCount;
+		uint16_t           parameterClass;
+		uint16_t           type;
+		uint16_t           rows;
+		uint16_t           columns;
+		uint16_t           elements;
+		std::vector<float> defaultValue; /**< Empty if none. */
+	};
+
+	ShaderBlob(uint32_t version) : m_sm1(((version >> 8) & 0xFF) < 2) { m_tokens.push_back(version); }
+
+	/**
+	* Vertex shader version token.
+	***/
+	static uint32_t VS(uint32_t major, uint32_t minor) { return 0xFFFE0000 | (major << 8) | minor; }
+	/**
+	* Pixel shader version token.
+	***/
+	static uint32_t PS(uint32_t major, uint32_t minor) { return 0xFFFF0000 | (major << 8) | minor; }
+
+	/**
+	* Destination parameter token.
+	***/
+	static uint32_t Dst(uint32_t type, uint32_t number, uint32_t writeMask = 0xF)
+	{
+		return 0x80000000 | ((type & 7) << 28) | ((type & 0x18) << 8) | (writeMask << 16) | number;
+	}
+
+	/**
+	* Source parameter token, swizzle as D3DVS_SWIZZLE bits (0xE4 = xyzw).
+	***/
+	static uint32_t Src(uint32_t type, uint32_t number, uint32_t swizzle = 0xE4)
+	{
+		return 0x80000000 | ((type & 7) << 28) | ((type & 0x18) << 8) | (swizzle << 16) | number;
+	}
+
+	/**
+	* Marks a parameter relative addressed (in shader model 2 and above the address register token follows).
+	***/
+	static uint32_t Relative(uint32_t parameter) { return parameter | 0x00002000; }
+
+	/**
+	* Float literal token (def).
+	***/
+	static uint32_t Float(float value)
+	{
+		uint32_t token;
+		memcpy(&token, &value, sizeof(token));
+		return token;
+	}
+
+	/**
+	* Appends an instruction and its parameter tokens.
+	***/
+	void Instruction(uint32_t opcode, std::initializer_list<uint32_t> parameters)
+	{
+		m_tokens.push_back(m_sm1 ? opcode : opcode | ((uint32_t)parameters.size() << 24));
+		m_tokens.insert(m_tokens.end(), parameters.begin(), parameters.end());
+	}
+
+	/**
+	* Appends a comment.
+	***/
+	void Comment(const std::vector<uint32_t>& data)
+	{
+		m_tokens.push_back(0xFFFE | ((uint32_t)data.size() << 16));
+		m_tokens.insert(m_tokens.end(), data.begin(), data.end());
+	}
+
+	/**
+	* Appends the constant table comment, laid out like fxc does : header, constant infos, then name,
+	* type info and default value per constant, creator and target last.
+	***/
+	void ConstantTable(const char* creator, const char* target, const std::vector<TableConstant>& constants)
+	{
+		std::vector<uint8_t> data(28 + constants.size() * 20, 0);
+		Write32(data, 0, 28);
+		Write32(data, 8, m_tokens[0]);
+		Write32(data, 12, (uint32_t)constants.size());
+		Write32(data, 16, 28);
+
+		for (size_t i = 0; i < constants.size(); i++) {
+			const TableConstant& constant = constants[i];
+			size_t info = 28 + i * 20;
+
+			Write32(data, info, Append(data, constant.name, strlen(constant.name) + 1));
+			Write16(data, info + 4, constant.registerSet);
+			Write16(data, info + 6, constant.registerIndex);
+			Write16(data, info + 8, constant.registerCount);
+
+			uint16_t typeInfo[8] = {constant.parameterClass, constant.type, constant.rows, constant.columns, constant.elements, 0, 0, 0};
+			Write32(data, info + 12, Append(data, typeInfo, sizeof(typeInfo)));
+
+			if (!constant.defaultValue.empty())
+				Write32(data, info + 16, Append(data, &constant.defaultValue[0], constant.defaultValue.size() * sizeof(float)));
+		}
+
+		Write32(data, 4, Append(data, creator, strlen(creator) + 1));
+		Write32(data, 24, Append(data, target, strlen(target) + 1));
+
+		std::vector<uint32_t> comment(1 + data.size() / 4);
+		comment[0] = 0x42415443; // 'CTAB'
+		memcpy(&comment[1], &data[0], data.size());
+		Comment(comment);
+	}
+
+	/**
+	* Appends the end token.
+	***/
+	void End() { m_tokens.push_back(0x0000FFFF); }
+
+	const uint32_t*              Data() const { return &m_tokens[0]; }
+	size_t                       Size() const { return m_tokens.size() * sizeof(uint32_t); }
+	const std::vector<uint32_t>& Tokens() const { return m_tokens; }
+
+private:
+	static void Write16(std::vector<uint8_t>& data, size_t offset, uint16_t value) { memcpy(&data[offset], &value, sizeof(value)); }
+	static void Write32(std::vector<uint8_t>& data, size_t offset, uint32_t value) { memcpy(&data[offset], &value, sizeof(value)); }
+
+	/**
+	* Appends data padded to DWORDs, returns its offset.
+	***/
+	static uint32_t Append(std::vector<uint8_t>& data, const void* pData, size_t size)
+	{
+		uint32_t offset = (uint32_t)data.size();
+		data.resize(offset + ((size + 3) & ~(size_t)3), 0);
+		memcpy(&data[offset], pData, size);
+		return offset;
+	}
+
+	/**
+	* True for shader model 1 (no instruction length).
+	***/
+	bool m_sm1;
+	/**
+	* The function.
+	***/
+	std::vector<uint32_t> m_tokens;
+};
+#endif
@@ -0,0 +1,97 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ShaderBytecodeBench.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ShaderBytecode.h"
+#include "ShaderBlob.h"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+
+/**
+* ShaderBytecode::Parse() on vs_3_0 functions of typical sizes (constant table of 16 constants).
+* Writes "<name>\t<iterations>\t<min ns per op>\t<median ns per op>" lines, as ProxyBench does.
+***/
+
+static const unsigned REPETITIONS = 7;
+
+static ShaderBlob BenchmarkShader(uint32_t instructions)
+{
+	static const char* names[] = {
+		"WorldViewProj", "World", "View", "Projection", "LightDirection", "LightColor", "Ambient", "FogParameters",
+		"CameraPosition", "Time", "Bones", "MaterialDiffuse", "MaterialSpecular", "ShadowMatrix", "WindParameters", "Scale"};
+
+	std::vector<ShaderBlob::TableConstant> constants;
+	for (uint16_t i = 0; i < 16; i++) {
+		ShaderBlob::TableConstant constant = {names[i], ShaderBytecode::RegisterSet_Float4, (uint16_t)(i * 4), 4,
+			ShaderBytecode::Class_MatrixColumns, 3, 4, 4, 1, {}};
+		constants.push_back(constant);
+	}
+
+	ShaderBlob blob(ShaderBlob::VS(3, 0));
+	blob.ConstantTable("Microsoft (R) HLSL Shader Compiler 9.29.952.3111", "vs_3_0", constants);
+	blob.Instruction(ShaderBlob::Op_Dcl, {0x80000000, ShaderBlob::Dst(ShaderBlob::Reg_Input, 0)});
+	blob.Instruction(ShaderBlob::Op_Dcl, {0x80000000, ShaderBlob::Dst(ShaderBlob::Reg_Output, 0)});
+	for (uint32_t i = 0; i < instructions; i++)
+		blob.Instruction(ShaderBlob::Op_Mad, {ShaderBlob::Dst(ShaderBlob::Reg_Temp, i & 7), ShaderBlob::Src(ShaderBlob::Reg_Input, 0),
+			ShaderBlob::Src(ShaderBlob::Reg_Const, i % 64), ShaderBlob::Src(ShaderBlob::Reg_Temp, (i + 1) & 7)});
+	blob.Instruction(ShaderBlob::Op_Mov, {ShaderBlob::Dst(ShaderBlob::Reg_Output, 0), ShaderBlob::Src(ShaderBlob::Reg_Temp, 0)});
+	blob.End();
+	return blob;
+}
+
+int main()
+{
+	static const uint32_t sizes[] = {64, 256, 1024};
+
+	printf("# name\titerations\tmin_ns\tmedian_ns\n");
+
+	ShaderBytecode bytecode;
+	size_t sink = 0;
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		ShaderBlob blob = BenchmarkShader(sizes[i]);
+		unsigned iterations = (unsigned)((8 << 20) / blob.Size());
+		std::vector<double> results;
+
+		for (unsigned repetition = 0; repetition < REPETITIONS; repetition++) {
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+			for (unsigned j = 0; j < iterations; j++) {
+				bytecode.Parse(blob.Data(), blob.Size());
+				sink += bytecode.InstructionCount();
+			}
+
+			std::chrono::duration<double, std::nano> elapsed = std::chrono::high_resolution_clock::now() - start;
+			results.push_back(elapsed.count() / iterations);
+		}
+
+		std::sort(results.begin(), results.end());
+		printf("ShaderBytecode::Parse/vs_3_0/%u\t%u\t%.1f\t%.1f\n", sizes[i], iterations, results[0], results[results.size() / 2]);
+	}
+
+	return sink ? 0 : 1;
+}
@@ -0,0 +1,411 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ShaderBytecodeTest.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ShaderBytecode.h"
+#include "ShaderBlob.h"
+#include "TestCheck.h"
+#include <string.h>
+
+/**
+* Tests of ShaderBytecode on shader model 1 to 3 functions, assembled in the layout fxc emits.
+***/
+
+static const char* CREATOR = "Microsoft (R) HLSL Shader Compiler 9.29.952.3111";
+
+/**
+* Parameter types of the constant table (as D3DXPARAMETER_TYPE).
+***/
+static const uint16_t TYPE_BOOL = 1;
+static const uint16_t TYPE_INT = 2;
+static const uint16_t TYPE_FLOAT = 3;
+static const uint16_t TYPE_SAMPLER2D = 12;
+
+typedef ShaderBlob B;
+
+/**
+* Float registers read, in ascending order.
+***/
+static std::vector<uint32_t> RegistersRead(const ShaderBytecode& bytecode)
+{
+	std::vector<uint32_t> registers;
+	const std::vector<uint32_t>& mask = bytecode.FloatRegistersRead();
+	for (uint32_t i = 0; i < mask.size() * 32; i++)
+		if (mask[i / 32] & (1UL << (i % 32)))
+			registers.push_back(i);
+	return registers;
+}
+
+static bool Equal(const std::vector<uint32_t>& registers, std::initializer_list<uint32_t> expected)
+{
+	return registers == std::vector<uint32_t>(expected);
+}
+
+/**
+* vs_1_1 : no instruction length, def literals with the sign bit set, relative addressing without address token.
+***/
+static ShaderBlob VS11()
+{
+	ShaderBlob blob(B::VS(1, 1));
+	blob.ConstantTable(CREATOR, "vs_1_1", {
+		{"WorldViewProj", ShaderBytecode::RegisterSet_Float4, 0, 4, ShaderBytecode::Class_MatrixColumns, TYPE_FLOAT, 4, 4, 1, {}},
+		{"Lights", ShaderBytecode::RegisterSet_Float4, 20, 8, ShaderBytecode::Class_Vector, TYPE_FLOAT, 1, 4, 8, {}}});
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Input, 0)});
+	blob.Instruction(B::Op_Dcl, {0x80000002, B::Dst(B::Reg_Input, 1)});
+	blob.Instruction(B::Op_Def, {B::Dst(B::Reg_Const, 90), B::Float(-1.0f), B::Float(0.5f), B::Float(-0.25f), B::Float(1.0f)});
+	blob.Instruction(B::Op_Def, {B::Dst(B::Reg_Const, 91), B::Float(-2.0f), B::Float(-2.0f), B::Float(-2.0f), B::Float(-2.0f)});
+	blob.Instruction(B::Op_Mov, {B::Dst(B::Reg_Addr, 0, 0x1), B::Src(B::Reg_Input, 1, 0x00)});
+	for (uint32_t i = 0; i < 4; i++)
+		blob.Instruction(B::Op_Dp4, {B::Dst(B::Reg_RastOut, 0, 1 << i), B::Src(B::Reg_Input, 0), B::Src(B::Reg_Const, i)});
+	blob.Instruction(B::Op_Mul, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Input, 0), B::Relative(B::Src(B::Reg_Const, 20))});
+	blob.Instruction(B::Op_Mov, {B::Dst(B::Reg_AttrOut, 0), B::Src(B::Reg_Const, 90)});
+	blob.End();
+	return blob;
+}
+
+/**
+* ps_1_4 without constant table : def, texld, phase.
+***/
+static ShaderBlob PS14()
+{
+	ShaderBlob blob(B::PS(1, 4));
+	blob.Instruction(B::Op_Def, {B::Dst(B::Reg_Const, 1), B::Float(-0.5f), B::Float(-0.25f), B::Float(1.0f), B::Float(1.0f)});
+	blob.Instruction(B::Op_Tex, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Texture, 0)});
+	blob.Instruction(B::Op_Phase, {});
+	blob.Instruction(B::Op_Mul, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Temp, 0), B::Src(B::Reg_Const, 2)});
+	blob.Instruction(B::Op_Add, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Temp, 0), B::Src(B::Reg_Const, 7)});
+	blob.End();
+	return blob;
+}
+
+/**
+* vs_2_0 : all register sets, default value, defi/defb, relative addressing with address token.
+* A debug comment precedes the constant table.
+***/
+static ShaderBlob VS20()
+{
+	ShaderBlob blob(B::VS(2, 0));
+	blob.Comment({0x47554244, 0, 0}); // 'DBUG'
+	blob.ConstantTable(CREATOR, "vs_2_0", {
+		{"WorldViewProj", ShaderBytecode::RegisterSet_Float4, 0, 4, ShaderBytecode::Class_MatrixColumns, TYPE_FLOAT, 4, 4, 1, {}},
+		{"Bones", ShaderBytecode::RegisterSet_Float4, 10, 60, ShaderBytecode::Class_MatrixRows, TYPE_FLOAT, 3, 4, 20, {}},
+		{"FogEnable", ShaderBytecode::RegisterSet_Bool, 0, 1, ShaderBytecode::Class_Scalar, TYPE_BOOL, 1, 1, 1, {}},
+		{"LightCount", ShaderBytecode::RegisterSet_Int4, 0, 1, ShaderBytecode::Class_Scalar, TYPE_INT, 1, 1, 1, {}},
+		{"Ambient", ShaderBytecode::RegisterSet_Float4, 100, 1, ShaderBytecode::Class_Vector, TYPE_FLOAT, 1, 4, 1, {0.1f, 0.2f, 0.3f, 1.0f}}});
+	blob.Instruction(B::Op_DefI, {B::Dst(B::Reg_ConstInt, 0), 4, 0, 1, 0});
+	blob.Instruction(B::Op_DefB, {B::Dst(B::Reg_ConstBool, 1), 1});
+	blob.Instruction(B::Op_Def, {B::Dst(B::Reg_Const, 200), B::Float(1.0f), B::Float(0.0f), B::Float(0.0f), B::Float(0.0f)});
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Input, 0)});
+	blob.Instruction(B::Op_Dcl, {0x80000002, B::Dst(B::Reg_Input, 1)});
+	blob.Instruction(B::Op_Mova, {B::Dst(B::Reg_Addr, 0, 0x1), B::Src(B::Reg_Input, 1, 0x00)});
+	for (uint32_t i = 0; i < 4; i++)
+		blob.Instruction(B::Op_Dp4, {B::Dst(B::Reg_RastOut, 0, 1 << i), B::Src(B::Reg_Input, 0), B::Src(B::Reg_Const, i)});
+	blob.Instruction(B::Op_Mov, {B::Dst(B::Reg_Output, 0), B::Relative(B::Src(B::Reg_Const, 10)), B::Src(B::Reg_Addr, 0, 0x00)});
+	blob.Instruction(B::Op_Add, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Const, 100), B::Src(B::Reg_Const, 200)});
+	blob.Instruction(B::Op_Mov, {B::Dst(B::Reg_AttrOut, 0), B::Src(B::Reg_Temp, 0)});
+	blob.End();
+	return blob;
+}
+
+/**
+* vs_2_0 : matrix macros, the matrix source reads one register per row (also relative).
+***/
+static ShaderBlob VS20Matrices()
+{
+	ShaderBlob blob(B::VS(2, 0));
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Input, 0)});
+	blob.Instruction(B::Op_Dcl, {0x80000002, B::Dst(B::Reg_Input, 1)});
+	blob.Instruction(B::Op_Mova, {B::Dst(B::Reg_Addr, 0, 0x1), B::Src(B::Reg_Input, 1, 0x00)});
+	blob.Instruction(B::Op_M4x4, {B::Dst(B::Reg_RastOut, 0), B::Src(B::Reg_Input, 0), B::Src(B::Reg_Const, 8)});
+	blob.Instruction(B::Op_M3x2, {B::Dst(B::Reg_Temp, 0, 0x3), B::Src(B::Reg_Input, 1), B::Relative(B::Src(B::Reg_Const, 20)), B::Src(B::Reg_Addr, 0, 0x00)});
+	blob.Instruction(B::Op_M4x3, {B::Dst(B::Reg_Temp, 1, 0x7), B::Src(B::Reg_Input, 0), B::Src(B::Reg_Const, 30)});
+	blob.Instruction(B::Op_M3x4, {B::Dst(B::Reg_Temp, 2), B::Src(B::Reg_Input, 1), B::Src(B::Reg_Const, 40)});
+	blob.Instruction(B::Op_M3x3, {B::Dst(B::Reg_Temp, 3, 0x7), B::Src(B::Reg_Input, 1), B::Src(B::Reg_Const, 50)});
+	blob.Instruction(B::Op_Add, {B::Dst(B::Reg_AttrOut, 0), B::Src(B::Reg_Temp, 0), B::Src(B::Reg_Const, 60)});
+	blob.End();
+	return blob;
+}
+
+/**
+* ps_2_0 : sampler constant, dcl of texture coordinates and samplers.
+***/
+static ShaderBlob PS20()
+{
+	ShaderBlob blob(B::PS(2, 0));
+	blob.ConstantTable(CREATOR, "ps_2_0", {
+		{"Tint", ShaderBytecode::RegisterSet_Float4, 1, 1, ShaderBytecode::Class_Vector, TYPE_FLOAT, 1, 4, 1, {}},
+		{"DiffuseSampler", ShaderBytecode::RegisterSet_Sampler, 0, 1, ShaderBytecode::Class_Object, TYPE_SAMPLER2D, 1, 1, 1, {}}});
+	blob.Instruction(B::Op_Def, {B::Dst(B::Reg_Const, 0), B::Float(0.5f), B::Float(0.5f), B::Float(0.5f), B::Float(1.0f)});
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Texture, 0, 0x3)});
+	blob.Instruction(B::Op_Dcl, {0x90000000, B::Dst(B::Reg_Sampler, 0)});
+	blob.Instruction(B::Op_Tex, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Texture, 0), B::Src(B::Reg_Sampler, 0)});
+	blob.Instruction(B::Op_Mul, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Temp, 0), B::Src(B::Reg_Const, 1)});
+	blob.Instruction(B::Op_Mov, {B::Dst(B::Reg_ColorOut, 0), B::Src(B::Reg_Temp, 0)});
+	blob.End();
+	return blob;
+}
+
+/**
+* vs_3_0 : loop relative source (aL) and relative output register.
+***/
+static ShaderBlob VS30()
+{
+	ShaderBlob blob(B::VS(3, 0));
+	blob.ConstantTable(CREATOR, "vs_3_0", {
+		{"ViewProj", ShaderBytecode::RegisterSet_Float4, 0, 4, ShaderBytecode::Class_MatrixColumns, TYPE_FLOAT, 4, 4, 1, {}},
+		{"Offsets", ShaderBytecode::RegisterSet_Float4, 40, 16, ShaderBytecode::Class_Vector, TYPE_FLOAT, 1, 4, 16, {}}});
+	blob.Instruction(B::Op_DefI, {B::Dst(B::Reg_ConstInt, 0), 16, 0, 1, 0});
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Input, 0)});
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Output, 0)});
+	blob.Instruction(B::Op_Dcl, {0x80000005, B::Dst(B::Reg_Output, 1)});
+	blob.Instruction(B::Op_Mov, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Input, 0)});
+	blob.Instruction(B::Op_Loop, {B::Src(B::Reg_Loop, 0), B::Src(B::Reg_ConstInt, 0)});
+	blob.Instruction(B::Op_Add, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Temp, 0), B::Relative(B::Src(B::Reg_Const, 40)), B::Src(B::Reg_Loop, 0, 0x00)});
+	blob.Instruction(B::Op_EndLoop, {});
+	for (uint32_t i = 0; i < 4; i++)
+		blob.Instruction(B::Op_Dp4, {B::Dst(B::Reg_Output, 0, 1 << i), B::Src(B::Reg_Temp, 0), B::Src(B::Reg_Const, i)});
+	blob.Instruction(B::Op_Mov, {B::Relative(B::Dst(B::Reg_Output, 1)), B::Src(B::Reg_Loop, 0, 0x00), B::Src(B::Reg_Temp, 0)});
+	blob.End();
+	return blob;
+}
+
+/**
+* ps_3_0 : high constant register file (CONST2).
+***/
+static ShaderBlob PS30()
+{
+	ShaderBlob blob(B::PS(3, 0));
+	blob.ConstantTable(CREATOR, "ps_3_0", {
+		{"Scale", ShaderBytecode::RegisterSet_Float4, 4, 1, ShaderBytecode::Class_Vector, TYPE_FLOAT, 1, 4, 1, {}}});
+	blob.Instruction(B::Op_Dcl, {0x80000005, B::Dst(B::Reg_Input, 0)});
+	blob.Instruction(B::Op_Dcl, {0x90000000, B::Dst(B::Reg_Sampler, 0)});
+	blob.Instruction(B::Op_Tex, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Input, 0), B::Src(B::Reg_Sampler, 0)});
+	blob.Instruction(B::Op_Mad, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Temp, 0), B::Src(B::Reg_Const, 4), B::Src(B::Reg_Const2, 3)});
+	blob.Instruction(B::Op_Mov, {B::Dst(B::Reg_ColorOut, 0), B::Src(B::Reg_Temp, 0)});
+	blob.End();
+	return blob;
+}
+
+static void TestVS11()
+{
+	ShaderBlob blob = VS11();
+	ShaderBytecode bytecode;
+	CHECK(bytecode.Parse(blob.Data(), blob.Size()));
+	CHECK(!bytecode.IsPixelShader());
+	CHECK(bytecode.MajorVersion() == 1 && bytecode.MinorVersion() == 1);
+	CHECK(bytecode.HasConstantTable());
+	CHECK(strcmp(bytecode.Creator(), CREATOR) == 0);
+	CHECK(strcmp(bytecode.Target(), "vs_1_1") == 0);
+	CHECK(bytecode.Constants().size() == 2);
+	CHECK(strcmp(bytecode.Constants()[1].name, "Lights") == 0);
+	CHECK(bytecode.Constants()[1].registerIndex == 20 && bytecode.Constants()[1].registerCount == 8);
+	CHECK(bytecode.Constants()[1].elements == 8);
+	// def c90/c91 are not reads, c90 is read by the last mov
+	CHECK(bytecode.InstructionCount() == 11);
+	CHECK(Equal(RegistersRead(bytecode), {0, 1, 2, 3, 20, 90}));
+	CHECK(bytecode.RelativeFloatAddressing());
+}
+
+static void TestPS14()
+{
+	ShaderBlob blob = PS14();
+	ShaderBytecode bytecode;
+	CHECK(bytecode.Parse(blob.Data(), blob.Size()));
+	CHECK(bytecode.IsPixelShader());
+	CHECK(bytecode.MajorVersion() == 1 && bytecode.MinorVersion() == 4);
+	CHECK(!bytecode.HasConstantTable());
+	CHECK(strcmp(bytecode.Creator(), "") == 0 && strcmp(bytecode.Target(), "") == 0);
+	CHECK(bytecode.Constants().empty());
+	CHECK(bytecode.InstructionCount() == 5);
+	CHECK(Equal(RegistersRead(bytecode), {2, 7}));
+	CHECK(!bytecode.RelativeFloatAddressing());
+}
+
+static void TestVS20()
+{
+	ShaderBlob blob = VS20();
+	ShaderBytecode bytecode;
+	CHECK(bytecode.Parse(blob.Data(), blob.Size()));
+	CHECK(!bytecode.IsPixelShader());
+	CHECK(bytecode.Version() == 0xFFFE0200);
+	CHECK(strcmp(bytecode.Target(), "vs_2_0") == 0);
+
+	const std::vector<ShaderBytecode::Constant>& constants = bytecode.Constants();
+	CHECK(constants.size() == 5);
+	if (constants.size() == 5) {
+		CHECK(strcmp(constants[0].name, "WorldViewProj") == 0);
+		CHECK(constants[0].registerSet == ShaderBytecode::RegisterSet_Float4);
+		CHECK(constants[0].registerIndex == 0 && constants[0].registerCount == 4);
+		CHECK(constants[0].parameterClass == ShaderBytecode::Class_MatrixColumns);
+		CHECK(constants[0].type == TYPE_FLOAT && constants[0].rows == 4 && constants[0].columns == 4);
+		CHECK(constants[0].pDefaultValue == NULL);
+
+		CHECK(strcmp(constants[1].name, "Bones") == 0);
+		CHECK(constants[1].registerIndex == 10 && constants[1].registerCount == 60);
+		CHECK(constants[1].parameterClass == ShaderBytecode::Class_MatrixRows && constants[1].elements == 20);
+
+		CHECK(strcmp(constants[2].name, "FogEnable") == 0);
+		CHECK(constants[2].registerSet == ShaderBytecode::RegisterSet_Bool && constants[2].type == TYPE_BOOL);
+
+		CHECK(strcmp(constants[3].name, "LightCount") == 0);
+		CHECK(constants[3].registerSet == ShaderBytecode::RegisterSet_Int4 && constants[3].type == TYPE_INT);
+
+		CHECK(strcmp(constants[4].name, "Ambient") == 0);
+		CHECK(constants[4].registerIndex == 100 && constants[4].parameterClass == ShaderBytecode::Class_Vector);
+		CHECK(constants[4].pDefaultValue != NULL);
+		if (constants[4].pDefaultValue) {
+			float ambient[4];
+			memcpy(ambient, constants[4].pDefaultValue, sizeof(ambient));
+			CHECK(ambient[0] == 0.1f && ambient[1] == 0.2f && ambient[2] == 0.3f && ambient[3] == 1.0f);
+		}
+	}
+
+	CHECK(bytecode.InstructionCount() == 13);
+	CHECK(Equal(RegistersRead(bytecode), {0, 1, 2, 3, 10, 100, 200}));
+	CHECK(bytecode.RelativeFloatAddressing());
+}
+
+static void TestVS20Matrices()
+{
+	ShaderBlob blob = VS20Matrices();
+	ShaderBytecode bytecode;
+	CHECK(bytecode.Parse(blob.Data(), blob.Size()));
+	CHECK(bytecode.InstructionCount() == 9);
+	CHECK(Equal(RegistersRead(bytecode), {8, 9, 10, 11, 20, 21, 30, 31, 32, 40, 41, 42, 43, 50, 51, 52, 60}));
+	CHECK(bytecode.RelativeFloatAddressing());
+}
+
+static void TestPS20()
+{
+	ShaderBlob blob = PS20();
+	ShaderBytecode bytecode;
+	CHECK(bytecode.Parse(blob.Data(), blob.Size()));
+	CHECK(bytecode.IsPixelShader());
+	CHECK(bytecode.Constants().size() == 2);
+	if (bytecode.Constants().size() == 2) {
+		CHECK(bytecode.Constants()[1].registerSet == ShaderBytecode::RegisterSet_Sampler);
+		CHECK(bytecode.Constants()[1].parameterClass == ShaderBytecode::Class_Object);
+		CHECK(bytecode.Constants()[1].type == TYPE_SAMPLER2D);
+	}
+	CHECK(bytecode.InstructionCount() == 6);
+	CHECK(Equal(RegistersRead(bytecode), {1}));
+	CHECK(!bytecode.RelativeFloatAddressing());
+}
+
+static void TestVS30()
+{
+	ShaderBlob blob = VS30();
+	ShaderBytecode bytecode;
+	CHECK(bytecode.Parse(blob.Data(), blob.Size()));
+	CHECK(bytecode.MajorVersion() == 3 && bytecode.MinorVersion() == 0);
+	CHECK(strcmp(bytecode.Target(), "vs_3_0") == 0);
+	CHECK(bytecode.Constants().size() == 2);
+	CHECK(bytecode.InstructionCount() == 13);
+	CHECK(Equal(RegistersRead(bytecode), {0, 1, 2, 3, 40}));
+	CHECK(bytecode.RelativeFloatAddressing());
+}
+
+static void TestPS30()
+{
+	ShaderBlob blob = PS30();
+	ShaderBytecode bytecode;
+	CHECK(bytecode.Parse(blob.Data(), blob.Size()));
+	CHECK(bytecode.IsPixelShader() && bytecode.MajorVersion() == 3);
+	CHECK(bytecode.InstructionCount() == 5);
+	CHECK(Equal(RegistersRead(bytecode), {4, 2048 + 3}));
+	CHECK(!bytecode.RelativeFloatAddressing());
+}
+
+/**
+* Damaged and unsupported functions.
+***/
+static void TestInvalid()
+{
+	ShaderBytecode bytecode;
+	CHECK(!bytecode.Parse(NULL, 0));
+
+	uint32_t version = B::VS(2, 0);
+	CHECK(!bytecode.Parse(&version, 3));
+	version = B::VS(4, 0);
+	CHECK(!bytecode.Parse(&version, sizeof(version)));
+	version = 0x12340200;
+	CHECK(!bytecode.Parse(&version, sizeof(version)));
+	version = B::PS(2, 0);
+	CHECK(bytecode.Parse(&version, sizeof(version)));
+
+	// missing end token is accepted, a truncated instruction is not
+	ShaderBlob blob = VS20();
+	std::vector<uint32_t> tokens(blob.Tokens());
+	CHECK(bytecode.Parse(&tokens[0], (tokens.size() - 1) * sizeof(uint32_t)));
+	CHECK(!bytecode.Parse(&tokens[0], (tokens.size() - 3) * sizeof(uint32_t)));
+
+	// comment longer than the function
+	ShaderBlob comment(B::VS(2, 0));
+	comment.Comment({0x47554244, 0});
+	tokens = comment.Tokens();
+	tokens[1] = 0xFFFE | (100 << 16);
+	CHECK(!bytecode.Parse(&tokens[0], tokens.size() * sizeof(uint32_t)));
+
+	// constant table : constant count beyond the table, name outside the table
+	ShaderBlob table = PS20();
+	tokens = table.Tokens();
+	tokens[3 + 3] = 1000;
+	CHECK(!bytecode.Parse(&tokens[0], tokens.size() * sizeof(uint32_t)));
+	tokens = table.Tokens();
+	tokens[3 + 7] = 0x10000;
+	CHECK(!bytecode.Parse(&tokens[0], tokens.size() * sizeof(uint32_t)));
+}
+
+/**
+* A reused parser keeps nothing of the previous function.
+***/
+static void TestReuse()
+{
+	ShaderBlob vs = VS20();
+	ShaderBlob ps = PS14();
+	ShaderBytecode bytecode;
+	CHECK(bytecode.Parse(vs.Data(), vs.Size()));
+	CHECK(bytecode.Parse(ps.Data(), ps.Size()));
+	CHECK(!bytecode.HasConstantTable() && bytecode.Constants().empty());
+	CHECK(Equal(RegistersRead(bytecode), {2, 7}));
+	CHECK(!bytecode.RelativeFloatAddressing());
+	CHECK(bytecode.InstructionCount() == 5);
+}
+
+int main()
+{
+	TestVS11();
+	TestPS14();
+	TestVS20();
+	TestVS20Matrices();
+	TestPS20();
+	TestVS30();
+	TestPS30();
+	TestInvalid();
+	TestReuse();
+	return TestResult("ShaderBytecodeTest");
+}
@@ -0,0 +1,159 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <D3DX9Shim.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "d3dx9.h"
+#include <string>
+#include <set>
+
+/**
+* IUnknown with a reference count, base of the shim objects.
+***/
+template <class T>
+class ShimUnknown : public T
+{
+public:
+	ShimUnknown() : m_nRefCount(1) {}
+	virtual ~ShimUnknown() {}
+
+	virtual HRESULT WINAPI QueryInterface(REFIID riid, LPVOID* ppv) { return E_NOINTERFACE; }
+	virtual ULONG   WINAPI AddRef() { return ++m_nRefCount; }
+	virtual ULONG   WINAPI Release()
+	{
+		if (--m_nRefCount == 0) {
+			delete this;
+			return 0;
+		}
+		return m_nRefCount;
+	}
+
+protected:
+	ULONG m_nRefCount;
+};
+
+/**
+* Sprite, keeps the transform and draws nothing.
+***/
+class ShimSprite : public ShimUnknown<ID3DXSprite>
+{
+public:
+	ShimSprite(LPDIRECT3DDEVICE9 pDevice) : m_pDevice(pDevice) { D3DXMatrixIdentity(&m_transform); }
+
+	virtual HRESULT WINAPI GetDevice(LPDIRECT3DDEVICE9* ppDevice) { *ppDevice = m_pDevice; m_pDevice->AddRef(); return D3D_OK; }
+	virtual HRESULT WINAPI GetTransform(D3DXMATRIX* pTransform) { *pTransform = m_transform; return D3D_OK; }
+	virtual HRESULT WINAPI SetTransform(CONST D3DXMATRIX* pTransform) { m_transform = *pTransform; return D3D_OK; }
+	virtual HRESULT WINAPI Begin(DWORD Flags) { return D3D_OK; }
+	virtual HRESULT WINAPI Draw(LPDIRECT3DTEXTURE9 pTexture, CONST RECT* pSrcRect, CONST D3DXVECTOR3* pCenter, CONST D3DXVECTOR3* pPosition, D3DCOLOR Color) { return D3D_OK; }
+	virtual HRESULT WINAPI Flush() { return D3D_OK; }
+	virtual HRESULT WINAPI End() { return D3D_OK; }
+	virtual HRESULT WINAPI OnLostDevice() { return D3D_OK; }
+	virtual HRESULT WINAPI OnResetDevice() { return D3D_OK; }
+
+private:
+	LPDIRECT3DDEVICE9 m_pDevice;
+	D3DXMATRIX m_transform;
+};
+
+/**
+* Font, draws nothing (reports one line of text drawn).
+***/
+class ShimFont : public ShimUnknown<ID3DXFont>
+{
+public:
+	ShimFont(LPDIRECT3DDEVICE9 pDevice, INT height) : m_pDevice(pDevice), m_height(height) {}
+
+	virtual HRESULT WINAPI GetDevice(LPDIRECT3DDEVICE9* ppDevice) { *ppDevice = m_pDevice; m_pDevice->AddRef(); return D3D_OK; }
+	virtual INT     WINAPI DrawTextA(LPD3DXSPRITE pSprite, LPCSTR pString, INT Count, LPRECT pRect, DWORD Format, D3DCOLOR Color) { return m_height; }
+	virtual HRESULT WINAPI OnLostDevice() { return D3D_OK; }
+	virtual HRESULT WINAPI OnResetDevice() { return D3D_OK; }
+
+private:
+	LPDIRECT3DDEVICE9 m_pDevice;
+	INT m_height;
+};
+
+/**
+* Effect with one pass, every parameter exists, values are accepted and dropped.
+***/
+class ShimEffect : public ShimUnknown<ID3DXEffect>
+{
+public:
+	virtual D3DXHANDLE WINAPI GetParameterByName(D3DXHANDLE hParameter, LPCSTR pName)
+	{
+		// handles are names in D3DX too (when not compiled with D3DXFX_LARGEADDRESSAWARE)
+		return m_parameterNames.insert(pName).first->c_str();
+	}
+	virtual HRESULT    WINAPI SetInt(D3DXHANDLE hParameter, INT n) { return D3D_OK; }
+	virtual HRESULT    WINAPI SetFloat(D3DXHANDLE hParameter, FLOAT f) { return D3D_OK; }
+	virtual HRESULT    WINAPI SetFloatArray(D3DXHANDLE hParameter, CONST FLOAT* pf, UINT Count) { return D3D_OK; }
+	virtual HRESULT    WINAPI SetMatrix(D3DXHANDLE hParameter, CONST D3DXMATRIX* pMatrix) { return D3D_OK; }
+	virtual HRESULT    WINAPI SetTexture(D3DXHANDLE hParameter, LPDIRECT3DBASETEXTURE9 pTexture) { return D3D_OK; }
+	virtual HRESULT    WINAPI SetTechnique(D3DXHANDLE hTechnique) { return D3D_OK; }
+	virtual HRESULT    WINAPI Begin(UINT* pPasses, DWORD Flags) { if (pPasses) *pPasses = 1; return D3D_OK; }
+	virtual HRESULT    WINAPI BeginPass(UINT Pass) { return D3D_OK; }
+	virtual HRESULT    WINAPI CommitChanges() { return D3D_OK; }
+	virtual HRESULT    WINAPI EndPass() { return D3D_OK; }
+	virtual HRESULT    WINAPI End() { return D3D_OK; }
+	virtual HRESULT    WINAPI OnLostDevice() { return D3D_OK; }
+	virtual HRESULT    WINAPI OnResetDevice() { return D3D_OK; }
+
+private:
+	std::set<std::string> m_parameterNames;
+};
+
+HRESULT WINAPI D3DXCreateSprite(LPDIRECT3DDEVICE9 pDevice, LPD3DXSPRITE* ppSprite)
+{
+	*ppSprite = new ShimSprite(pDevice);
+	return D3D_OK;
+}
+
+HRESULT WINAPI D3DXCreateFont(LPDIRECT3DDEVICE9 pDevice, INT Height, UINT Width, UINT Weight, UINT MipLevels, BOOL Italic,
+                              DWORD CharSet, DWORD OutputPrecision, DWORD Quality, DWORD PitchAndFamily, LPCSTR pFaceName,
+                              LPD3DXFONT* ppFont)
+{
+	*ppFont = new ShimFont(pDevice, Height);
+	return D3D_OK;
+}
+
+/**
+* The effect file is not read, the proxy only needs it to exist.
+***/
+HRESULT WINAPI D3DXCreateEffectFromFile(LPDIRECT3DDEVICE9 pDevice, LPCSTR pSrcFile, CONST D3DXMACRO* pDefines,
+                                        LPD3DXINCLUDE pInclude, DWORD Flags, LPD3DXEFFECTPOOL pPool,
+                                        LPD3DXEFFECT* ppEffect, LPD3DXBUFFER* ppCompilationErrors)
+{
+	if (ppCompilationErrors)
+		*ppCompilationErrors = NULL;
+	*ppEffect = new ShimEffect();
+	return D3D_OK;
+}
+
+HRESULT WINAPI D3DXSaveSurfaceToFile(LPCSTR pDestFile, D3DXIMAGE_FILEFORMAT DestFormat, LPDIRECT3DSURFACE9 pSrcSurface,
+                                     CONST PALETTEENTRY* pSrcPalette, CONST RECT* pSrcRect)
+{
+	return D3D_OK;
+}
@@ -0,0 +1,42 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <DxErr.h> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef SHIM_DXERR_H_INCLUDED
+#define SHIM_DXERR_H_INCLUDED
+
+/**
+* DirectX error strings of the headless test build, the result code in hexadecimal.
+***/
+#include <windows.h>
+
+const char* WINAPI DXGetErrorStringA(HRESULT hr);
+const char* WINAPI DXGetErrorDescriptionA(HRESULT hr);
+#define DXGetErrorString DXGetErrorStringA
+#define DXGetErrorDescription DXGetErrorDescriptionA
+
+#endif
@@ -0,0 +1,535 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <Win32Shim.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "windows.h"
+#include <DxErr.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <map>
+#include <string>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+* Kernel object behind a HANDLE, CloseHandle() deletes it.
+***/
+struct ShimHandle
+{
+	virtual ~ShimHandle() {}
+};
+
+/**
+* Thread handle, WaitForSingleObject() joins the thread.
+***/
+struct ShimThread : public ShimHandle
+{
+	virtual ~ShimThread() { if (thread.joinable()) thread.detach(); }
+	std::thread thread;
+};
+
+/**
+* File handle, a POSIX file descriptor.
+***/
+struct ShimFile : public ShimHandle
+{
+	virtual ~ShimFile() { close(fd); }
+	int fd;
+};
+
+/**
+* File mapping handle. Mappings of INVALID_HANDLE_VALUE are anonymous memory, names are ignored.
+***/
+struct ShimFileMapping : public ShimHandle
+{
+	virtual ~ShimFileMapping() { if (fd >= 0) close(fd); }
+	int fd;
+	size_t size;
+	bool writable;
+};
+
+namespace
+{
+	/**
+	* Mapped views by address, UnmapViewOfFile() needs the size.
+	***/
+	std::mutex viewMutex;
+	std::map<const void*, size_t> views;
+
+	/**
+	* In-memory registry, values by name.
+	***/
+	std::map<std::string, std::string> registry;
+}
+
+/*** Debugging ***/
+
+/**
+* Debug output is dropped unless VIREIO_SHIM_DEBUG is set, the proxy is talkative.
+***/
+void OutputDebugStringA(LPCSTR lpOutputString)
+{
+	static const bool enabled = getenv("VIREIO_SHIM_DEBUG") != NULL;
+	if (enabled && lpOutputString)
+		fputs(lpOutputString, stderr);
+}
+
+const char* WINAPI DXGetErrorStringA(HRESULT hr)
+{
+	return SUCCEEDED(hr) ? "S_OK" : "E_FAIL";
+}
+
+const char* WINAPI DXGetErrorDescriptionA(HRESULT hr)
+{
+	return SUCCEEDED(hr) ? "The operation succeeded." : "The operation failed.";
+}
+
+/*** Synchronization ***/
+
+void InitializeCriticalSection(LPCRITICAL_SECTION lpCriticalSection)
+{
+	lpCriticalSection->pMutex = new std::recursive_mutex();
+}
+
+BOOL InitializeCriticalSectionAndSpinCount(LPCRITICAL_SECTION lpCriticalSection, DWORD dwSpinCount)
+{
+	InitializeCriticalSection(lpCriticalSection);
+	return TRUE;
+}
+
+void DeleteCriticalSection(LPCRITICAL_SECTION lpCriticalSection)
+{
+	delete (std::recursive_mutex*)lpCriticalSection->pMutex;
+	lpCriticalSection->pMutex = NULL;
+}
+
+void EnterCriticalSection(LPCRITICAL_SECTION lpCriticalSection)
+{
+	((std::recursive_mutex*)lpCriticalSection->pMutex)->lock();
+}
+
+void LeaveCriticalSection(LPCRITICAL_SECTION lpCriticalSection)
+{
+	((std::recursive_mutex*)lpCriticalSection->pMutex)->unlock();
+}
+
+/**
+* Condition variables are never deleted in Win32, so the shim leaks one object per variable.
+***/
+void InitializeConditionVariable(PCONDITION_VARIABLE ConditionVariable)
+{
+	ConditionVariable->pCondition = new std::condition_variable_any();
+}
+
+BOOL SleepConditionVariableCS(PCONDITION_VARIABLE ConditionVariable, LPCRITICAL_SECTION CriticalSection, DWORD dwMilliseconds)
+{
+	std::condition_variable_any* pCondition = (std::condition_variable_any*)ConditionVariable->pCondition;
+	std::recursive_mutex& mutex = *(std::recursive_mutex*)CriticalSection->pMutex;
+
+	// the caller holds the lock, the guard adopts it and must not release it on return
+	std::unique_lock<std::recursive_mutex> lock(mutex, std::adopt_lock);
+	bool signaled = true;
+	if (dwMilliseconds == INFINITE)
+		pCondition->wait(lock);
+	else
+		signaled = pCondition->wait_for(lock, std::chrono::milliseconds(dwMilliseconds)) == std::cv_status::no_timeout;
+	lock.release();
+
+	return signaled ? TRUE : FALSE;
+}
+
+void WakeConditionVariable(PCONDITION_VARIABLE ConditionVariable)
+{
+	((std::condition_variable_any*)ConditionVariable->pCondition)->notify_one();
+}
+
+void WakeAllConditionVariable(PCONDITION_VARIABLE ConditionVariable)
+{
+	((std::condition_variable_any*)ConditionVariable->pCondition)->notify_all();
+}
+
+void Sleep(DWORD dwMilliseconds)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(dwMilliseconds));
+}
+
+/*** Threads and processes ***/
+
+HANDLE CreateThread(LPSECURITY_ATTRIBUTES lpThreadAttributes, SIZE_T dwStackSize, LPTHREAD_START_ROUTINE lpStartAddress,
+                    LPVOID lpParameter, DWORD dwCreationFlags, LPDWORD lpThreadId)
+{
+	ShimThread* pThread = new ShimThread();
+	pThread->thread = std::thread(lpStartAddress, lpParameter);
+	if (lpThreadId)
+		*lpThreadId = 0;
+	return pThread;
+}
+
+/**
+* Only threads are waited for, the proxy waits for nothing else.
+***/
+DWORD WaitForSingleObject(HANDLE hHandle, DWORD dwMilliseconds)
+{
+	ShimThread* pThread = dynamic_cast<ShimThread*>((ShimHandle*)hHandle);
+	if (!pThread)
+		return WAIT_FAILED;
+	if (pThread->thread.joinable())
+		pThread->thread.join();
+	return WAIT_OBJECT_0;
+}
+
+BOOL CloseHandle(HANDLE hObject)
+{
+	if (!hObject || hObject == INVALID_HANDLE_VALUE)
+		return FALSE;
+	delete (ShimHandle*)hObject;
+	return TRUE;
+}
+
+DWORD GetCurrentThreadId()
+{
+	return (DWORD)std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+
+DWORD GetCurrentProcessId()
+{
+	return (DWORD)getpid();
+}
+
+DWORD TlsAlloc()
+{
+	pthread_key_t key;
+	if (pthread_key_create(&key, NULL) != 0)
+		return TLS_OUT_OF_INDEXES;
+	return (DWORD)key;
+}
+
+BOOL TlsFree(DWORD dwTlsIndex)
+{
+	return pthread_key_delete((pthread_key_t)dwTlsIndex) == 0;
+}
+
+LPVOID TlsGetValue(DWORD dwTlsIndex)
+{
+	return pthread_getspecific((pthread_key_t)dwTlsIndex);
+}
+
+BOOL TlsSetValue(DWORD dwTlsIndex, LPVOID lpTlsValue)
+{
+	return pthread_setspecific((pthread_key_t)dwTlsIndex, lpTlsValue) == 0;
+}
+
+void GetSystemInfo(LPSYSTEM_INFO lpSystemInfo)
+{
+	memset(lpSystemInfo, 0, sizeof(SYSTEM_INFO));
+	lpSystemInfo->dwPageSize = (DWORD)sysconf(_SC_PAGESIZE);
+	lpSystemInfo->dwNumberOfProcessors = std::max(1u, std::thread::hardware_concurrency());
+	lpSystemInfo->dwAllocationGranularity = 65536;
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* lpPerformanceCount)
+{
+	lpPerformanceCount->QuadPart = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+	return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* lpFrequency)
+{
+	lpFrequency->QuadPart = 1000000000LL;
+	return TRUE;
+}
+
+DWORD GetTickCount()
+{
+	return (DWORD)std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*** Memory ***/
+
+/**
+* Always commits the whole range (zeroed, as VirtualAlloc), MEM_DECOMMIT is ignored.
+***/
+LPVOID VirtualAlloc(LPVOID lpAddress, SIZE_T dwSize, DWORD flAllocationType, DWORD flProtect)
+{
+	if (lpAddress)
+		return lpAddress;
+	void* pMemory = mmap(NULL, dwSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (pMemory == MAP_FAILED)
+		return NULL;
+
+	std::lock_guard<std::mutex> lock(viewMutex);
+	views[pMemory] = dwSize;
+	return pMemory;
+}
+
+BOOL VirtualFree(LPVOID lpAddress, SIZE_T dwSize, DWORD dwFreeType)
+{
+	if (!(dwFreeType & MEM_RELEASE))
+		return TRUE;
+	return UnmapViewOfFile(lpAddress);
+}
+
+/*** Files and file mappings ***/
+
+HANDLE CreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode, LPSECURITY_ATTRIBUTES lpSecurityAttributes,
+                   DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes, HANDLE hTemplateFile)
+{
+	int flags = 0;
+	if ((dwDesiredAccess & GENERIC_READ) && (dwDesiredAccess & GENERIC_WRITE))
+		flags = O_RDWR;
+	else if (dwDesiredAccess & GENERIC_WRITE)
+		flags = O_WRONLY;
+	else
+		flags = O_RDONLY;
+
+	switch (dwCreationDisposition)
+	{
+	case CREATE_NEW:        flags |= O_CREAT | O_EXCL; break;
+	case CREATE_ALWAYS:     flags |= O_CREAT | O_TRUNC; break;
+	case OPEN_ALWAYS:       flags |= O_CREAT; break;
+	case TRUNCATE_EXISTING: flags |= O_TRUNC; break;
+	default:                break;
+	}
+
+	int fd = open(lpFileName, flags, 0644);
+	if (fd < 0)
+		return INVALID_HANDLE_VALUE;
+
+	ShimFile* pFile = new ShimFile();
+	pFile->fd = fd;
+	return pFile;
+}
+
+BOOL ReadFile(HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead, LPDWORD lpNumberOfBytesRead, void* lpOverlapped)
+{
+	ssize_t bytes = read(((ShimFile*)hFile)->fd, lpBuffer, nNumberOfBytesToRead);
+	if (lpNumberOfBytesRead)
+		*lpNumberOfBytesRead = bytes < 0 ? 0 : (DWORD)bytes;
+	return bytes >= 0;
+}
+
+BOOL WriteFile(HANDLE hFile, LPCVOID lpBuffer, DWORD nNumberOfBytesToWrite, LPDWORD lpNumberOfBytesWritten, void* lpOverlapped)
+{
+	ssize_t bytes = write(((ShimFile*)hFile)->fd, lpBuffer, nNumberOfBytesToWrite);
+	if (lpNumberOfBytesWritten)
+		*lpNumberOfBytesWritten = bytes < 0 ? 0 : (DWORD)bytes;
+	return bytes >= 0;
+}
+
+BOOL GetFileSizeEx(HANDLE hFile, PLARGE_INTEGER lpFileSize)
+{
+	struct stat status;
+	if (fstat(((ShimFile*)hFile)->fd, &status) != 0)
+		return FALSE;
+	lpFileSize->QuadPart = status.st_size;
+	return TRUE;
+}
+
+BOOL SetFilePointerEx(HANDLE hFile, LARGE_INTEGER liDistanceToMove, PLARGE_INTEGER lpNewFilePointer, DWORD dwMoveMethod)
+{
+	int whence = dwMoveMethod == FILE_END ? SEEK_END : (dwMoveMethod == FILE_CURRENT ? SEEK_CUR : SEEK_SET);
+	off_t position = lseek(((ShimFile*)hFile)->fd, (off_t)liDistanceToMove.QuadPart, whence);
+	if (position < 0)
+		return FALSE;
+	if (lpNewFilePointer)
+		lpNewFilePointer->QuadPart = position;
+	return TRUE;
+}
+
+BOOL SetEndOfFile(HANDLE hFile)
+{
+	int fd = ((ShimFile*)hFile)->fd;
+	return ftruncate(fd, lseek(fd, 0, SEEK_CUR)) == 0;
+}
+
+BOOL FlushFileBuffers(HANDLE hFile)
+{
+	return fsync(((ShimFile*)hFile)->fd) == 0;
+}
+
+HANDLE CreateFileMappingA(HANDLE hFile, LPSECURITY_ATTRIBUTES lpAttributes, DWORD flProtect, DWORD dwMaximumSizeHigh,
+                          DWORD dwMaximumSizeLow, LPCSTR lpName)
+{
+	ShimFileMapping* pMapping = new ShimFileMapping();
+	pMapping->size = ((size_t)dwMaximumSizeHigh << 32) | dwMaximumSizeLow;
+	pMapping->writable = flProtect == PAGE_READWRITE;
+	pMapping->fd = -1;
+
+	if (hFile != INVALID_HANDLE_VALUE) {
+		pMapping->fd = dup(((ShimFile*)hFile)->fd);
+		if (pMapping->size == 0) {
+			struct stat status;
+			if (fstat(pMapping->fd, &status) == 0)
+				pMapping->size = (size_t)status.st_size;
+		}
+		if (pMapping->size == 0) {
+			// as Win32, an empty file can not be mapped
+			delete pMapping;
+			return NULL;
+		}
+	}
+	return pMapping;
+}
+
+LPVOID MapViewOfFile(HANDLE hFileMappingObject, DWORD dwDesiredAccess, DWORD dwFileOffsetHigh, DWORD dwFileOffsetLow,
+                     SIZE_T dwNumberOfBytesToMap)
+{
+	ShimFileMapping* pMapping = (ShimFileMapping*)hFileMappingObject;
+	off_t offset = (off_t)(((uint64_t)dwFileOffsetHigh << 32) | dwFileOffsetLow);
+	size_t size = dwNumberOfBytesToMap ? dwNumberOfBytesToMap : pMapping->size - (size_t)offset;
+	int protection = pMapping->writable && (dwDesiredAccess & FILE_MAP_WRITE) ? PROT_READ | PROT_WRITE : PROT_READ;
+
+	void* pView;
+	if (pMapping->fd < 0)
+		pView = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	else
+		pView = mmap(NULL, size, protection, MAP_SHARED, pMapping->fd, offset);
+	if (pView == MAP_FAILED)
+		return NULL;
+
+	std::lock_guard<std::mutex> lock(viewMutex);
+	views[pView] = size;
+	return pView;
+}
+
+BOOL UnmapViewOfFile(LPCVOID lpBaseAddress)
+{
+	size_t size;
+	{
+		std::lock_guard<std::mutex> lock(viewMutex);
+		std::map<const void*, size_t>::iterator it = views.find(lpBaseAddress);
+		if (it == views.end())
+			return FALSE;
+		size = it->second;
+		views.erase(it);
+	}
+	return munmap((void*)lpBaseAddress, size) == 0;
+}
+
+/*** Registry ***/
+
+LONG RegOpenKeyExA(HKEY hKey, LPCSTR lpSubKey, DWORD ulOptions, REGSAM samDesired, PHKEY phkResult)
+{
+	*phkResult = hKey;
+	return ERROR_SUCCESS;
+}
+
+LONG RegQueryValueExA(HKEY hKey, LPCSTR lpValueName, LPDWORD lpReserved, LPDWORD lpType, LPBYTE lpData, LPDWORD lpcbData)
+{
+	std::map<std::string, std::string>::const_iterator it = registry.find(lpValueName ? lpValueName : "");
+	if (it == registry.end())
+		return ERROR_FILE_NOT_FOUND;
+
+	DWORD size = (DWORD)it->second.size() + 1;
+	if (lpType)
+		*lpType = REG_SZ;
+	if (lpData) {
+		if (!lpcbData || *lpcbData < size)
+			return ERROR_MORE_DATA;
+		memcpy(lpData, it->second.c_str(), size);
+	}
+	if (lpcbData)
+		*lpcbData = size;
+	return ERROR_SUCCESS;
+}
+
+LONG RegCloseKey(HKEY hKey)
+{
+	return ERROR_SUCCESS;
+}
+
+void ShimSetRegistryString(LPCSTR lpValueName, LPCSTR lpValue)
+{
+	registry[lpValueName] = lpValue;
+}
+
+/*** Input ***/
+
+SHORT GetAsyncKeyState(int vKey)
+{
+	return 0;
+}
+
+UINT SendInput(UINT cInputs, LPINPUT pInputs, int cbSize)
+{
+	return cInputs;
+}
+
+/*** Rectangles ***/
+
+BOOL SetRect(LPRECT lprc, int xLeft, int yTop, int xRight, int yBottom)
+{
+	lprc->left = xLeft;
+	lprc->top = yTop;
+	lprc->right = xRight;
+	lprc->bottom = yBottom;
+	return TRUE;
+}
+
+BOOL SetRectEmpty(LPRECT lprc)
+{
+	return SetRect(lprc, 0, 0, 0, 0);
+}
+
+BOOL CopyRect(LPRECT lprcDst, const RECT* lprcSrc)
+{
+	*lprcDst = *lprcSrc;
+	return TRUE;
+}
+
+BOOL OffsetRect(LPRECT lprc, int dx, int dy)
+{
+	return SetRect(lprc, lprc->left + dx, lprc->top + dy, lprc->right + dx, lprc->bottom + dy);
+}
+
+BOOL InflateRect(LPRECT lprc, int dx, int dy)
+{
+	return SetRect(lprc, lprc->left - dx, lprc->top - dy, lprc->right + dx, lprc->bottom + dy);
+}
+
+BOOL IsRectEmpty(const RECT* lprc)
+{
+	return lprc->right <= lprc->left || lprc->bottom <= lprc->top;
+}
+
+BOOL IntersectRect(LPRECT lprcDst, const RECT* lprcSrc1, const RECT* lprcSrc2)
+{
+	SetRect(lprcDst, std::max(lprcSrc1->left, lprcSrc2->left), std::max(lprcSrc1->top, lprcSrc2->top),
+		std::min(lprcSrc1->right, lprcSrc2->right), std::min(lprcSrc1->bottom, lprcSrc2->bottom));
+	if (IsRectEmpty(lprcDst)) {
+		SetRectEmpty(lprcDst);
+		return FALSE;
+	}
+	return TRUE;
+}
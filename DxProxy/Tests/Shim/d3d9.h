@@ -0,0 +1,1367 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <d3d9.h> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef SHIM_D3D9_H_INCLUDED
+#define SHIM_D3D9_H_INCLUDED
+
+/**
+* Direct3D 9 declarations for the headless test build : the types, values and interfaces of the SDK d3d9.h the
+* proxy uses, so that the proxy compiles unchanged against a mock actual device (MockDirect3DDevice9).
+* Enumeration values match the SDK, interfaces declare the SDK methods (the vtable order only matters within
+* this build).
+***/
+
+#include <windows.h>
+
+#define DIRECT3D_VERSION 0x0900
+#define D3D_SDK_VERSION  32
+
+/*** Results ***/
+#define _FACD3D 0x876
+#define MAKE_D3DHRESULT(code)        MAKE_HRESULT(1, _FACD3D, code)
+#define MAKE_D3DSTATUS(code)         MAKE_HRESULT(0, _FACD3D, code)
+#define D3D_OK                       S_OK
+#define D3DERR_WRONGTEXTUREFORMAT    MAKE_D3DHRESULT(2072)
+#define D3DERR_UNSUPPORTEDCOLOROPERATION MAKE_D3DHRESULT(2073)
+#define D3DERR_UNSUPPORTEDCOLORARG   MAKE_D3DHRESULT(2074)
+#define D3DERR_UNSUPPORTEDALPHAOPERATION MAKE_D3DHRESULT(2075)
+#define D3DERR_UNSUPPORTEDALPHAARG   MAKE_D3DHRESULT(2076)
+#define D3DERR_TOOMANYOPERATIONS     MAKE_D3DHRESULT(2077)
+#define D3DERR_CONFLICTINGTEXTUREFILTER MAKE_D3DHRESULT(2078)
+#define D3DERR_UNSUPPORTEDFACTORVALUE MAKE_D3DHRESULT(2079)
+#define D3DERR_CONFLICTINGRENDERSTATE MAKE_D3DHRESULT(2081)
+#define D3DERR_UNSUPPORTEDTEXTUREFILTER MAKE_D3DHRESULT(2082)
+#define D3DERR_CONFLICTINGTEXTUREPALETTE MAKE_D3DHRESULT(2086)
+#define D3DERR_DRIVERINTERNALERROR   MAKE_D3DHRESULT(2087)
+#define D3DERR_NOTFOUND              MAKE_D3DHRESULT(2150)
+#define D3DERR_MOREDATA              MAKE_D3DHRESULT(2151)
+#define D3DERR_DEVICELOST            MAKE_D3DHRESULT(2152)
+#define D3DERR_DEVICENOTRESET        MAKE_D3DHRESULT(2153)
+#define D3DERR_NOTAVAILABLE          MAKE_D3DHRESULT(2154)
+#define D3DERR_OUTOFVIDEOMEMORY      MAKE_D3DHRESULT(380)
+#define D3DERR_INVALIDDEVICE         MAKE_D3DHRESULT(2155)
+#define D3DERR_INVALIDCALL           MAKE_D3DHRESULT(2156)
+#define D3DERR_DRIVERINVALIDCALL     MAKE_D3DHRESULT(2157)
+#define D3DERR_WASSTILLDRAWING       MAKE_D3DHRESULT(540)
+#define D3DOK_NOAUTOGEN              MAKE_D3DSTATUS(2159)
+
+/*** Basic types ***/
+typedef DWORD D3DCOLOR;
+
+#define D3DCOLOR_ARGB(a,r,g,b) ((D3DCOLOR)((((a)&0xff)<<24)|(((r)&0xff)<<16)|(((g)&0xff)<<8)|((b)&0xff)))
+#define D3DCOLOR_RGBA(r,g,b,a) D3DCOLOR_ARGB(a,r,g,b)
+#define D3DCOLOR_XRGB(r,g,b)   D3DCOLOR_ARGB(0xff,r,g,b)
+#define D3DCOLOR_XYUV(y,u,v)   D3DCOLOR_ARGB(0xff,y,u,v)
+#define D3DCOLOR_AYUV(a,y,u,v) D3DCOLOR_ARGB(a,y,u,v)
+#define D3DCOLOR_COLORVALUE(r,g,b,a) \
+	D3DCOLOR_RGBA((DWORD)((r)*255.f),(DWORD)((g)*255.f),(DWORD)((b)*255.f),(DWORD)((a)*255.f))
+
+#define MAKEFOURCC(ch0, ch1, ch2, ch3) \
+	((DWORD)(BYTE)(ch0) | ((DWORD)(BYTE)(ch1) << 8) | ((DWORD)(BYTE)(ch2) << 16) | ((DWORD)(BYTE)(ch3) << 24))
+
+typedef struct _D3DVECTOR {
+	float x;
+	float y;
+	float z;
+} D3DVECTOR;
+
+typedef struct _D3DCOLORVALUE {
+	float r;
+	float g;
+	float b;
+	float a;
+} D3DCOLORVALUE;
+
+typedef struct _D3DRECT {
+	LONG x1;
+	LONG y1;
+	LONG x2;
+	LONG y2;
+} D3DRECT;
+
+typedef struct _D3DMATRIX {
+	union {
+		struct {
+			float _11, _12, _13, _14;
+			float _21, _22, _23, _24;
+			float _31, _32, _33, _34;
+			float _41, _42, _43, _44;
+		};
+		float m[4][4];
+	};
+} D3DMATRIX;
+
+typedef struct _D3DVIEWPORT9 {
+	DWORD X;
+	DWORD Y;
+	DWORD Width;
+	DWORD Height;
+	float MinZ;
+	float MaxZ;
+} D3DVIEWPORT9;
+
+#define D3DMAXUSERCLIPPLANES 32
+
+typedef struct _D3DCLIPSTATUS9 {
+	DWORD ClipUnion;
+	DWORD ClipIntersection;
+} D3DCLIPSTATUS9;
+
+typedef struct _D3DMATERIAL9 {
+	D3DCOLORVALUE Diffuse;
+	D3DCOLORVALUE Ambient;
+	D3DCOLORVALUE Specular;
+	D3DCOLORVALUE Emissive;
+	float         Power;
+} D3DMATERIAL9;
+
+typedef enum _D3DLIGHTTYPE {
+	D3DLIGHT_POINT       = 1,
+	D3DLIGHT_SPOT        = 2,
+	D3DLIGHT_DIRECTIONAL = 3,
+	D3DLIGHT_FORCE_DWORD = 0x7fffffff
+} D3DLIGHTTYPE;
+
+typedef struct _D3DLIGHT9 {
+	D3DLIGHTTYPE  Type;
+	D3DCOLORVALUE Diffuse;
+	D3DCOLORVALUE Specular;
+	D3DCOLORVALUE Ambient;
+	D3DVECTOR     Position;
+	D3DVECTOR     Direction;
+	float         Range;
+	float         Falloff;
+	float         Attenuation0;
+	float         Attenuation1;
+	float         Attenuation2;
+	float         Theta;
+	float         Phi;
+} D3DLIGHT9;
+
+/*** Clear, usage, lock and creation flags ***/
+#define D3DCLEAR_TARGET  0x00000001l
+#define D3DCLEAR_ZBUFFER 0x00000002l
+#define D3DCLEAR_STENCIL 0x00000004l
+
+#define D3DUSAGE_RENDERTARGET       (0x00000001L)
+#define D3DUSAGE_DEPTHSTENCIL       (0x00000002L)
+#define D3DUSAGE_DYNAMIC            (0x00000200L)
+#define D3DUSAGE_AUTOGENMIPMAP      (0x00000400L)
+#define D3DUSAGE_DMAP               (0x00004000L)
+#define D3DUSAGE_WRITEONLY          (0x00000008L)
+#define D3DUSAGE_SOFTWAREPROCESSING (0x00000010L)
+#define D3DUSAGE_DONOTCLIP          (0x00000020L)
+#define D3DUSAGE_POINTS             (0x00000040L)
+#define D3DUSAGE_RTPATCHES          (0x00000080L)
+#define D3DUSAGE_NPATCHES           (0x00000100L)
+
+#define D3DLOCK_READONLY        0x00000010L
+#define D3DLOCK_DISCARD         0x00002000L
+#define D3DLOCK_NOOVERWRITE     0x00001000L
+#define D3DLOCK_NOSYSLOCK       0x00000800L
+#define D3DLOCK_DONOTWAIT       0x00004000L
+#define D3DLOCK_NO_DIRTY_UPDATE 0x00008000L
+
+#define D3DCREATE_FPU_PRESERVE              0x00000002L
+#define D3DCREATE_MULTITHREADED             0x00000004L
+#define D3DCREATE_PUREDEVICE                0x00000010L
+#define D3DCREATE_SOFTWARE_VERTEXPROCESSING 0x00000020L
+#define D3DCREATE_HARDWARE_VERTEXPROCESSING 0x00000040L
+#define D3DCREATE_MIXED_VERTEXPROCESSING    0x00000080L
+
+#define D3DPRESENT_INTERVAL_DEFAULT   0x00000000L
+#define D3DPRESENT_INTERVAL_ONE       0x00000001L
+#define D3DPRESENT_INTERVAL_IMMEDIATE 0x80000000L
+
+#define D3DSTREAMSOURCE_INDEXEDDATA  (1<<30)
+#define D3DSTREAMSOURCE_INSTANCEDATA (2u<<30)
+
+#define D3DSGR_NO_CALIBRATION 0x00000000L
+#define D3DSGR_CALIBRATE      0x00000001L
+
+#define D3DISSUE_END   (1 << 0)
+#define D3DISSUE_BEGIN (1 << 1)
+#define D3DGETDATA_FLUSH (1 << 0)
+
+#define D3DENUM_WHQL_LEVEL 0x00000002L
+
+#define D3DDMAPSAMPLER           256
+#define D3DVERTEXTEXTURESAMPLER0 (D3DDMAPSAMPLER+1)
+#define D3DVERTEXTEXTURESAMPLER1 (D3DDMAPSAMPLER+2)
+#define D3DVERTEXTEXTURESAMPLER2 (D3DDMAPSAMPLER+3)
+#define D3DVERTEXTEXTURESAMPLER3 (D3DDMAPSAMPLER+4)
+
+#define D3DTA_SELECTMASK     0x0000000f
+#define D3DTA_DIFFUSE        0x00000000
+#define D3DTA_CURRENT        0x00000001
+#define D3DTA_TEXTURE        0x00000002
+#define D3DTA_TFACTOR        0x00000003
+#define D3DTA_SPECULAR       0x00000004
+#define D3DTA_TEMP           0x00000005
+#define D3DTA_CONSTANT       0x00000006
+#define D3DTA_COMPLEMENT     0x00000010
+#define D3DTA_ALPHAREPLICATE 0x00000020
+
+#define D3DFVF_RESERVED0 0x001
+#define D3DFVF_XYZ       0x002
+#define D3DFVF_XYZRHW    0x004
+#define D3DFVF_XYZB1     0x006
+#define D3DFVF_XYZW      0x4002
+#define D3DFVF_NORMAL    0x010
+#define D3DFVF_PSIZE     0x020
+#define D3DFVF_DIFFUSE   0x040
+#define D3DFVF_SPECULAR  0x080
+#define D3DFVF_TEXCOUNT_MASK  0xf00
+#define D3DFVF_TEXCOUNT_SHIFT 8
+#define D3DFVF_TEX0      0x000
+#define D3DFVF_TEX1      0x100
+#define D3DFVF_TEX2      0x200
+#define D3DFVF_TEX3      0x300
+#define D3DFVF_TEX4      0x400
+
+#define D3DSHADER_VERSION_MAJOR(_Version) (((_Version)>>8)&0xFF)
+#define D3DSHADER_VERSION_MINOR(_Version) (((_Version)>>0)&0xFF)
+#define D3DVS_VERSION(_Major,_Minor) (0xFFFE0000|((_Major)<<8)|(_Minor))
+#define D3DPS_VERSION(_Major,_Minor) (0xFFFF0000|((_Major)<<8)|(_Minor))
+
+/*** Enumerations ***/
+typedef enum _D3DDEVTYPE {
+	D3DDEVTYPE_HAL         = 1,
+	D3DDEVTYPE_REF         = 2,
+	D3DDEVTYPE_SW          = 3,
+	D3DDEVTYPE_NULLREF     = 4,
+	D3DDEVTYPE_FORCE_DWORD = 0x7fffffff
+} D3DDEVTYPE;
+
+typedef enum _D3DFORMAT {
+	D3DFMT_UNKNOWN             = 0,
+	D3DFMT_R8G8B8              = 20,
+	D3DFMT_A8R8G8B8            = 21,
+	D3DFMT_X8R8G8B8            = 22,
+	D3DFMT_R5G6B5              = 23,
+	D3DFMT_X1R5G5B5            = 24,
+	D3DFMT_A1R5G5B5            = 25,
+	D3DFMT_A4R4G4B4            = 26,
+	D3DFMT_R3G3B2              = 27,
+	D3DFMT_A8                  = 28,
+	D3DFMT_A8R3G3B2            = 29,
+	D3DFMT_X4R4G4B4            = 30,
+	D3DFMT_A2B10G10R10         = 31,
+	D3DFMT_A8B8G8R8            = 32,
+	D3DFMT_X8B8G8R8            = 33,
+	D3DFMT_G16R16              = 34,
+	D3DFMT_A2R10G10B10         = 35,
+	D3DFMT_A16B16G16R16        = 36,
+	D3DFMT_A8P8                = 40,
+	D3DFMT_P8                  = 41,
+	D3DFMT_L8                  = 50,
+	D3DFMT_A8L8                = 51,
+	D3DFMT_A4L4                = 52,
+	D3DFMT_V8U8                = 60,
+	D3DFMT_L6V5U5              = 61,
+	D3DFMT_X8L8V8U8            = 62,
+	D3DFMT_Q8W8V8U8            = 63,
+	D3DFMT_V16U16              = 64,
+	D3DFMT_A2W10V10U10         = 67,
+	D3DFMT_UYVY                = MAKEFOURCC('U', 'Y', 'V', 'Y'),
+	D3DFMT_R8G8_B8G8           = MAKEFOURCC('R', 'G', 'B', 'G'),
+	D3DFMT_YUY2                = MAKEFOURCC('Y', 'U', 'Y', '2'),
+	D3DFMT_G8R8_G8B8           = MAKEFOURCC('G', 'R', 'G', 'B'),
+	D3DFMT_DXT1                = MAKEFOURCC('D', 'X', 'T', '1'),
+	D3DFMT_DXT2                = MAKEFOURCC('D', 'X', 'T', '2'),
+	D3DFMT_DXT3                = MAKEFOURCC('D', 'X', 'T', '3'),
+	D3DFMT_DXT4                = MAKEFOURCC('D', 'X', 'T', '4'),
+	D3DFMT_DXT5                = MAKEFOURCC('D', 'X', 'T', '5'),
+	D3DFMT_D16_LOCKABLE        = 70,
+	D3DFMT_D32                 = 71,
+	D3DFMT_D15S1               = 73,
+	D3DFMT_D24S8               = 75,
+	D3DFMT_D24X8               = 77,
+	D3DFMT_D24X4S4             = 79,
+	D3DFMT_D16                 = 80,
+	D3DFMT_D32F_LOCKABLE       = 82,
+	D3DFMT_D24FS8              = 83,
+	D3DFMT_L16                 = 81,
+	D3DFMT_VERTEXDATA          = 100,
+	D3DFMT_INDEX16             = 101,
+	D3DFMT_INDEX32             = 102,
+	D3DFMT_Q16W16V16U16        = 110,
+	D3DFMT_MULTI2_ARGB8        = MAKEFOURCC('M','E','T','1'),
+	D3DFMT_R16F                = 111,
+	D3DFMT_G16R16F             = 112,
+	D3DFMT_A16B16G16R16F       = 113,
+	D3DFMT_R32F                = 114,
+	D3DFMT_G32R32F             = 115,
+	D3DFMT_A32B32G32R32F       = 116,
+	D3DFMT_CxV8U8              = 117,
+	D3DFMT_FORCE_DWORD         = 0x7fffffff
+} D3DFORMAT;
+
+typedef enum _D3DPOOL {
+	D3DPOOL_DEFAULT     = 0,
+	D3DPOOL_MANAGED     = 1,
+	D3DPOOL_SYSTEMMEM   = 2,
+	D3DPOOL_SCRATCH     = 3,
+	D3DPOOL_FORCE_DWORD = 0x7fffffff
+} D3DPOOL;
+
+typedef enum _D3DPRIMITIVETYPE {
+	D3DPT_POINTLIST     = 1,
+	D3DPT_LINELIST      = 2,
+	D3DPT_LINESTRIP     = 3,
+	D3DPT_TRIANGLELIST  = 4,
+	D3DPT_TRIANGLESTRIP = 5,
+	D3DPT_TRIANGLEFAN   = 6,
+	D3DPT_FORCE_DWORD   = 0x7fffffff
+} D3DPRIMITIVETYPE;
+
+typedef enum _D3DMULTISAMPLE_TYPE {
+	D3DMULTISAMPLE_NONE         = 0,
+	D3DMULTISAMPLE_NONMASKABLE  = 1,
+	D3DMULTISAMPLE_2_SAMPLES    = 2,
+	D3DMULTISAMPLE_4_SAMPLES    = 4,
+	D3DMULTISAMPLE_8_SAMPLES    = 8,
+	D3DMULTISAMPLE_16_SAMPLES   = 16,
+	D3DMULTISAMPLE_FORCE_DWORD  = 0x7fffffff
+} D3DMULTISAMPLE_TYPE;
+
+typedef enum _D3DSWAPEFFECT {
+	D3DSWAPEFFECT_DISCARD     = 1,
+	D3DSWAPEFFECT_FLIP        = 2,
+	D3DSWAPEFFECT_COPY        = 3,
+	D3DSWAPEFFECT_FORCE_DWORD = 0x7fffffff
+} D3DSWAPEFFECT;
+
+typedef enum _D3DBACKBUFFER_TYPE {
+	D3DBACKBUFFER_TYPE_MONO        = 0,
+	D3DBACKBUFFER_TYPE_LEFT        = 1,
+	D3DBACKBUFFER_TYPE_RIGHT       = 2,
+	D3DBACKBUFFER_TYPE_FORCE_DWORD = 0x7fffffff
+} D3DBACKBUFFER_TYPE;
+
+typedef enum _D3DRESOURCETYPE {
+	D3DRTYPE_SURFACE       = 1,
+	D3DRTYPE_VOLUME        = 2,
+	D3DRTYPE_TEXTURE       = 3,
+	D3DRTYPE_VOLUMETEXTURE = 4,
+	D3DRTYPE_CUBETEXTURE   = 5,
+	D3DRTYPE_VERTEXBUFFER  = 6,
+	D3DRTYPE_INDEXBUFFER   = 7,
+	D3DRTYPE_FORCE_DWORD   = 0x7fffffff
+} D3DRESOURCETYPE;
+
+typedef enum _D3DCUBEMAP_FACES {
+	D3DCUBEMAP_FACE_POSITIVE_X  = 0,
+	D3DCUBEMAP_FACE_NEGATIVE_X  = 1,
+	D3DCUBEMAP_FACE_POSITIVE_Y  = 2,
+	D3DCUBEMAP_FACE_NEGATIVE_Y  = 3,
+	D3DCUBEMAP_FACE_POSITIVE_Z  = 4,
+	D3DCUBEMAP_FACE_NEGATIVE_Z  = 5,
+	D3DCUBEMAP_FACE_FORCE_DWORD = 0x7fffffff
+} D3DCUBEMAP_FACES;
+
+typedef enum _D3DTEXTUREFILTERTYPE {
+	D3DTEXF_NONE          = 0,
+	D3DTEXF_POINT         = 1,
+	D3DTEXF_LINEAR        = 2,
+	D3DTEXF_ANISOTROPIC   = 3,
+	D3DTEXF_PYRAMIDALQUAD = 6,
+	D3DTEXF_GAUSSIANQUAD  = 7,
+	D3DTEXF_FORCE_DWORD   = 0x7fffffff
+} D3DTEXTUREFILTERTYPE;
+
+typedef enum _D3DSTATEBLOCKTYPE {
+	D3DSBT_ALL         = 1,
+	D3DSBT_PIXELSTATE  = 2,
+	D3DSBT_VERTEXSTATE = 3,
+	D3DSBT_FORCE_DWORD = 0x7fffffff
+} D3DSTATEBLOCKTYPE;
+
+typedef enum _D3DQUERYTYPE {
+	D3DQUERYTYPE_VCACHE            = 4,
+	D3DQUERYTYPE_RESOURCEMANAGER   = 5,
+	D3DQUERYTYPE_VERTEXSTATS       = 6,
+	D3DQUERYTYPE_EVENT             = 8,
+	D3DQUERYTYPE_OCCLUSION         = 9,
+	D3DQUERYTYPE_TIMESTAMP         = 10,
+	D3DQUERYTYPE_TIMESTAMPDISJOINT = 11,
+	D3DQUERYTYPE_TIMESTAMPFREQ     = 12,
+	D3DQUERYTYPE_PIPELINETIMINGS   = 13,
+	D3DQUERYTYPE_INTERFACETIMINGS  = 14,
+	D3DQUERYTYPE_VERTEXTIMINGS     = 15,
+	D3DQUERYTYPE_PIXELTIMINGS      = 16,
+	D3DQUERYTYPE_BANDWIDTHTIMINGS  = 17,
+	D3DQUERYTYPE_CACHEUTILIZATION  = 18
+} D3DQUERYTYPE;
+
+typedef enum _D3DTRANSFORMSTATETYPE {
+	D3DTS_VIEW        = 2,
+	D3DTS_PROJECTION  = 3,
+	D3DTS_TEXTURE0    = 16,
+	D3DTS_TEXTURE1    = 17,
+	D3DTS_TEXTURE2    = 18,
+	D3DTS_TEXTURE3    = 19,
+	D3DTS_TEXTURE4    = 20,
+	D3DTS_TEXTURE5    = 21,
+	D3DTS_TEXTURE6    = 22,
+	D3DTS_TEXTURE7    = 23,
+	D3DTS_FORCE_DWORD = 0x7fffffff
+} D3DTRANSFORMSTATETYPE;
+
+#define D3DTS_WORLDMATRIX(index) (D3DTRANSFORMSTATETYPE)(index + 256)
+#define D3DTS_WORLD  D3DTS_WORLDMATRIX(0)
+#define D3DTS_WORLD1 D3DTS_WORLDMATRIX(1)
+#define D3DTS_WORLD2 D3DTS_WORLDMATRIX(2)
+#define D3DTS_WORLD3 D3DTS_WORLDMATRIX(3)
+
+typedef enum _D3DRENDERSTATETYPE {
+	D3DRS_ZENABLE                    = 7,
+	D3DRS_FILLMODE                   = 8,
+	D3DRS_SHADEMODE                  = 9,
+	D3DRS_ZWRITEENABLE               = 14,
+	D3DRS_ALPHATESTENABLE            = 15,
+	D3DRS_LASTPIXEL                  = 16,
+	D3DRS_SRCBLEND                   = 19,
+	D3DRS_DESTBLEND                  = 20,
+	D3DRS_CULLMODE                   = 22,
+	D3DRS_ZFUNC                      = 23,
+	D3DRS_ALPHAREF                   = 24,
+	D3DRS_ALPHAFUNC                  = 25,
+	D3DRS_DITHERENABLE               = 26,
+	D3DRS_ALPHABLENDENABLE           = 27,
+	D3DRS_FOGENABLE                  = 28,
+	D3DRS_SPECULARENABLE             = 29,
+	D3DRS_FOGCOLOR                   = 34,
+	D3DRS_FOGTABLEMODE               = 35,
+	D3DRS_FOGSTART                   = 36,
+	D3DRS_FOGEND                     = 37,
+	D3DRS_FOGDENSITY                 = 38,
+	D3DRS_RANGEFOGENABLE             = 48,
+	D3DRS_STENCILENABLE              = 52,
+	D3DRS_STENCILFAIL                = 53,
+	D3DRS_STENCILZFAIL               = 54,
+	D3DRS_STENCILPASS                = 55,
+	D3DRS_STENCILFUNC                = 56,
+	D3DRS_STENCILREF                 = 57,
+	D3DRS_STENCILMASK                = 58,
+	D3DRS_STENCILWRITEMASK           = 59,
+	D3DRS_TEXTUREFACTOR              = 60,
+	D3DRS_WRAP0                      = 128,
+	D3DRS_WRAP1                      = 129,
+	D3DRS_WRAP2                      = 130,
+	D3DRS_WRAP3                      = 131,
+	D3DRS_WRAP4                      = 132,
+	D3DRS_WRAP5                      = 133,
+	D3DRS_WRAP6                      = 134,
+	D3DRS_WRAP7                      = 135,
+	D3DRS_CLIPPING                   = 136,
+	D3DRS_LIGHTING                   = 137,
+	D3DRS_AMBIENT                    = 139,
+	D3DRS_FOGVERTEXMODE              = 140,
+	D3DRS_COLORVERTEX                = 141,
+	D3DRS_LOCALVIEWER                = 142,
+	D3DRS_NORMALIZENORMALS           = 143,
+	D3DRS_DIFFUSEMATERIALSOURCE      = 145,
+	D3DRS_SPECULARMATERIALSOURCE     = 146,
+	D3DRS_AMBIENTMATERIALSOURCE      = 147,
+	D3DRS_EMISSIVEMATERIALSOURCE     = 148,
+	D3DRS_VERTEXBLEND                = 151,
+	D3DRS_CLIPPLANEENABLE            = 152,
+	D3DRS_POINTSIZE                  = 154,
+	D3DRS_POINTSIZE_MIN              = 155,
+	D3DRS_POINTSPRITEENABLE          = 156,
+	D3DRS_POINTSCALEENABLE           = 157,
+	D3DRS_POINTSCALE_A               = 158,
+	D3DRS_POINTSCALE_B               = 159,
+	D3DRS_POINTSCALE_C               = 160,
+	D3DRS_MULTISAMPLEANTIALIAS       = 161,
+	D3DRS_MULTISAMPLEMASK            = 162,
+	D3DRS_PATCHEDGESTYLE             = 163,
+	D3DRS_DEBUGMONITORTOKEN          = 165,
+	D3DRS_POINTSIZE_MAX              = 166,
+	D3DRS_INDEXEDVERTEXBLENDENABLE   = 167,
+	D3DRS_COLORWRITEENABLE           = 168,
+	D3DRS_TWEENFACTOR                = 170,
+	D3DRS_BLENDOP                    = 171,
+	D3DRS_POSITIONDEGREE             = 172,
+	D3DRS_NORMALDEGREE               = 173,
+	D3DRS_SCISSORTESTENABLE          = 174,
+	D3DRS_SLOPESCALEDEPTHBIAS        = 175,
+	D3DRS_ANTIALIASEDLINEENABLE      = 176,
+	D3DRS_MINTESSELLATIONLEVEL       = 178,
+	D3DRS_MAXTESSELLATIONLEVEL       = 179,
+	D3DRS_ADAPTIVETESS_X             = 180,
+	D3DRS_ADAPTIVETESS_Y             = 181,
+	D3DRS_ADAPTIVETESS_Z             = 182,
+	D3DRS_ADAPTIVETESS_W             = 183,
+	D3DRS_ENABLEADAPTIVETESSELLATION = 184,
+	D3DRS_TWOSIDEDSTENCILMODE        = 185,
+	D3DRS_CCW_STENCILFAIL            = 186,
+	D3DRS_CCW_STENCILZFAIL           = 187,
+	D3DRS_CCW_STENCILPASS            = 188,
+	D3DRS_CCW_STENCILFUNC            = 189,
+	D3DRS_COLORWRITEENABLE1          = 190,
+	D3DRS_COLORWRITEENABLE2          = 191,
+	D3DRS_COLORWRITEENABLE3          = 192,
+	D3DRS_BLENDFACTOR                = 193,
+	D3DRS_SRGBWRITEENABLE            = 194,
+	D3DRS_DEPTHBIAS                  = 195,
+	D3DRS_WRAP8                      = 198,
+	D3DRS_WRAP9                      = 199,
+	D3DRS_WRAP10                     = 200,
+	D3DRS_WRAP11                     = 201,
+	D3DRS_WRAP12                     = 202,
+	D3DRS_WRAP13                     = 203,
+	D3DRS_WRAP14                     = 204,
+	D3DRS_WRAP15                     = 205,
+	D3DRS_SEPARATEALPHABLENDENABLE   = 206,
+	D3DRS_SRCBLENDALPHA              = 207,
+	D3DRS_DESTBLENDALPHA             = 208,
+	D3DRS_BLENDOPALPHA               = 209,
+	D3DRS_FORCE_DWORD                = 0x7fffffff
+} D3DRENDERSTATETYPE;
+
+typedef enum _D3DTEXTURESTAGESTATETYPE {
+	D3DTSS_COLOROP               = 1,
+	D3DTSS_COLORARG1             = 2,
+	D3DTSS_COLORARG2             = 3,
+	D3DTSS_ALPHAOP               = 4,
+	D3DTSS_ALPHAARG1             = 5,
+	D3DTSS_ALPHAARG2             = 6,
+	D3DTSS_BUMPENVMAT00          = 7,
+	D3DTSS_BUMPENVMAT01          = 8,
+	D3DTSS_BUMPENVMAT10          = 9,
+	D3DTSS_BUMPENVMAT11          = 10,
+	D3DTSS_TEXCOORDINDEX         = 11,
+	D3DTSS_BUMPENVLSCALE         = 22,
+	D3DTSS_BUMPENVLOFFSET        = 23,
+	D3DTSS_TEXTURETRANSFORMFLAGS = 24,
+	D3DTSS_COLORARG0             = 26,
+	D3DTSS_ALPHAARG0             = 27,
+	D3DTSS_RESULTARG             = 28,
+	D3DTSS_CONSTANT              = 32,
+	D3DTSS_FORCE_DWORD           = 0x7fffffff
+} D3DTEXTURESTAGESTATETYPE;
+
+typedef enum _D3DSAMPLERSTATETYPE {
+	D3DSAMP_ADDRESSU      = 1,
+	D3DSAMP_ADDRESSV      = 2,
+	D3DSAMP_ADDRESSW      = 3,
+	D3DSAMP_BORDERCOLOR   = 4,
+	D3DSAMP_MAGFILTER     = 5,
+	D3DSAMP_MINFILTER     = 6,
+	D3DSAMP_MIPFILTER     = 7,
+	D3DSAMP_MIPMAPLODBIAS = 8,
+	D3DSAMP_MAXMIPLEVEL   = 9,
+	D3DSAMP_MAXANISOTROPY = 10,
+	D3DSAMP_SRGBTEXTURE   = 11,
+	D3DSAMP_ELEMENTINDEX  = 12,
+	D3DSAMP_DMAPOFFSET    = 13,
+	D3DSAMP_FORCE_DWORD   = 0x7fffffff
+} D3DSAMPLERSTATETYPE;
+
+typedef enum _D3DZBUFFERTYPE {
+	D3DZB_FALSE       = 0,
+	D3DZB_TRUE        = 1,
+	D3DZB_USEW        = 2,
+	D3DZB_FORCE_DWORD = 0x7fffffff
+} D3DZBUFFERTYPE;
+
+typedef enum _D3DFILLMODE {
+	D3DFILL_POINT       = 1,
+	D3DFILL_WIREFRAME   = 2,
+	D3DFILL_SOLID       = 3,
+	D3DFILL_FORCE_DWORD = 0x7fffffff
+} D3DFILLMODE;
+
+typedef enum _D3DSHADEMODE {
+	D3DSHADE_FLAT        = 1,
+	D3DSHADE_GOURAUD     = 2,
+	D3DSHADE_PHONG       = 3,
+	D3DSHADE_FORCE_DWORD = 0x7fffffff
+} D3DSHADEMODE;
+
+typedef enum _D3DBLEND {
+	D3DBLEND_ZERO            = 1,
+	D3DBLEND_ONE             = 2,
+	D3DBLEND_SRCCOLOR        = 3,
+	D3DBLEND_INVSRCCOLOR     = 4,
+	D3DBLEND_SRCALPHA        = 5,
+	D3DBLEND_INVSRCALPHA     = 6,
+	D3DBLEND_DESTALPHA       = 7,
+	D3DBLEND_INVDESTALPHA    = 8,
+	D3DBLEND_DESTCOLOR       = 9,
+	D3DBLEND_INVDESTCOLOR    = 10,
+	D3DBLEND_SRCALPHASAT     = 11,
+	D3DBLEND_BOTHSRCALPHA    = 12,
+	D3DBLEND_BOTHINVSRCALPHA = 13,
+	D3DBLEND_BLENDFACTOR     = 14,
+	D3DBLEND_INVBLENDFACTOR  = 15,
+	D3DBLEND_FORCE_DWORD     = 0x7fffffff
+} D3DBLEND;
+
+typedef enum _D3DBLENDOP {
+	D3DBLENDOP_ADD         = 1,
+	D3DBLENDOP_SUBTRACT    = 2,
+	D3DBLENDOP_REVSUBTRACT = 3,
+	D3DBLENDOP_MIN         = 4,
+	D3DBLENDOP_MAX         = 5,
+	D3DBLENDOP_FORCE_DWORD = 0x7fffffff
+} D3DBLENDOP;
+
+typedef enum _D3DTEXTUREADDRESS {
+	D3DTADDRESS_WRAP        = 1,
+	D3DTADDRESS_MIRROR      = 2,
+	D3DTADDRESS_CLAMP       = 3,
+	D3DTADDRESS_BORDER      = 4,
+	D3DTADDRESS_MIRRORONCE  = 5,
+	D3DTADDRESS_FORCE_DWORD = 0x7fffffff
+} D3DTEXTUREADDRESS;
+
+typedef enum _D3DCULL {
+	D3DCULL_NONE        = 1,
+	D3DCULL_CW          = 2,
+	D3DCULL_CCW         = 3,
+	D3DCULL_FORCE_DWORD = 0x7fffffff
+} D3DCULL;
+
+typedef enum _D3DCMPFUNC {
+	D3DCMP_NEVER        = 1,
+	D3DCMP_LESS         = 2,
+	D3DCMP_EQUAL        = 3,
+	D3DCMP_LESSEQUAL    = 4,
+	D3DCMP_GREATER      = 5,
+	D3DCMP_NOTEQUAL     = 6,
+	D3DCMP_GREATEREQUAL = 7,
+	D3DCMP_ALWAYS       = 8,
+	D3DCMP_FORCE_DWORD  = 0x7fffffff
+} D3DCMPFUNC;
+
+typedef enum _D3DSTENCILOP {
+	D3DSTENCILOP_KEEP        = 1,
+	D3DSTENCILOP_ZERO        = 2,
+	D3DSTENCILOP_REPLACE     = 3,
+	D3DSTENCILOP_INCRSAT     = 4,
+	D3DSTENCILOP_DECRSAT     = 5,
+	D3DSTENCILOP_INVERT      = 6,
+	D3DSTENCILOP_INCR        = 7,
+	D3DSTENCILOP_DECR        = 8,
+	D3DSTENCILOP_FORCE_DWORD = 0x7fffffff
+} D3DSTENCILOP;
+
+typedef enum _D3DFOGMODE {
+	D3DFOG_NONE        = 0,
+	D3DFOG_EXP         = 1,
+	D3DFOG_EXP2        = 2,
+	D3DFOG_LINEAR      = 3,
+	D3DFOG_FORCE_DWORD = 0x7fffffff
+} D3DFOGMODE;
+
+typedef enum _D3DMATERIALCOLORSOURCE {
+	D3DMCS_MATERIAL    = 0,
+	D3DMCS_COLOR1      = 1,
+	D3DMCS_COLOR2      = 2,
+	D3DMCS_FORCE_DWORD = 0x7fffffff
+} D3DMATERIALCOLORSOURCE;
+
+typedef enum _D3DVERTEXBLENDFLAGS {
+	D3DVBF_DISABLE  = 0,
+	D3DVBF_1WEIGHTS = 1,
+	D3DVBF_2WEIGHTS = 2,
+	D3DVBF_3WEIGHTS = 3,
+	D3DVBF_TWEENING = 255,
+	D3DVBF_0WEIGHTS = 256,
+	D3DVBF_FORCE_DWORD = 0x7fffffff
+} D3DVERTEXBLENDFLAGS;
+
+typedef enum _D3DPATCHEDGESTYLE {
+	D3DPATCHEDGE_DISCRETE    = 0,
+	D3DPATCHEDGE_CONTINUOUS  = 1,
+	D3DPATCHEDGE_FORCE_DWORD = 0x7fffffff
+} D3DPATCHEDGESTYLE;
+
+typedef enum _D3DDEBUGMONITORTOKENS {
+	D3DDMT_ENABLE      = 0,
+	D3DDMT_DISABLE     = 1,
+	D3DDMT_FORCE_DWORD = 0x7fffffff
+} D3DDEBUGMONITORTOKENS;
+
+typedef enum _D3DDEGREETYPE {
+	D3DDEGREE_LINEAR      = 1,
+	D3DDEGREE_QUADRATIC   = 2,
+	D3DDEGREE_CUBIC       = 3,
+	D3DDEGREE_QUINTIC     = 5,
+	D3DDEGREE_FORCE_DWORD = 0x7fffffff
+} D3DDEGREETYPE;
+
+typedef enum _D3DBASISTYPE {
+	D3DBASIS_BEZIER      = 0,
+	D3DBASIS_BSPLINE     = 1,
+	D3DBASIS_CATMULL_ROM = 2,
+	D3DBASIS_FORCE_DWORD = 0x7fffffff
+} D3DBASISTYPE;
+
+typedef enum _D3DTEXTUREOP {
+	D3DTOP_DISABLE                   = 1,
+	D3DTOP_SELECTARG1                = 2,
+	D3DTOP_SELECTARG2                = 3,
+	D3DTOP_MODULATE                  = 4,
+	D3DTOP_MODULATE2X                = 5,
+	D3DTOP_MODULATE4X                = 6,
+	D3DTOP_ADD                       = 7,
+	D3DTOP_ADDSIGNED                 = 8,
+	D3DTOP_ADDSIGNED2X               = 9,
+	D3DTOP_SUBTRACT                  = 10,
+	D3DTOP_ADDSMOOTH                 = 11,
+	D3DTOP_BLENDDIFFUSEALPHA         = 12,
+	D3DTOP_BLENDTEXTUREALPHA         = 13,
+	D3DTOP_BLENDFACTORALPHA          = 14,
+	D3DTOP_BLENDTEXTUREALPHAPM       = 15,
+	D3DTOP_BLENDCURRENTALPHA         = 16,
+	D3DTOP_PREMODULATE               = 17,
+	D3DTOP_MODULATEALPHA_ADDCOLOR    = 18,
+	D3DTOP_MODULATECOLOR_ADDALPHA    = 19,
+	D3DTOP_MODULATEINVALPHA_ADDCOLOR = 20,
+	D3DTOP_MODULATEINVCOLOR_ADDALPHA = 21,
+	D3DTOP_BUMPENVMAP                = 22,
+	D3DTOP_BUMPENVMAPLUMINANCE       = 23,
+	D3DTOP_DOTPRODUCT3               = 24,
+	D3DTOP_MULTIPLYADD               = 25,
+	D3DTOP_LERP                      = 26,
+	D3DTOP_FORCE_DWORD               = 0x7fffffff
+} D3DTEXTUREOP;
+
+typedef enum _D3DDECLTYPE {
+	D3DDECLTYPE_FLOAT1    = 0,
+	D3DDECLTYPE_FLOAT2    = 1,
+	D3DDECLTYPE_FLOAT3    = 2,
+	D3DDECLTYPE_FLOAT4    = 3,
+	D3DDECLTYPE_D3DCOLOR  = 4,
+	D3DDECLTYPE_UBYTE4    = 5,
+	D3DDECLTYPE_SHORT2    = 6,
+	D3DDECLTYPE_SHORT4    = 7,
+	D3DDECLTYPE_UBYTE4N   = 8,
+	D3DDECLTYPE_SHORT2N   = 9,
+	D3DDECLTYPE_SHORT4N   = 10,
+	D3DDECLTYPE_USHORT2N  = 11,
+	D3DDECLTYPE_USHORT4N  = 12,
+	D3DDECLTYPE_UDEC3     = 13,
+	D3DDECLTYPE_DEC3N     = 14,
+	D3DDECLTYPE_FLOAT16_2 = 15,
+	D3DDECLTYPE_FLOAT16_4 = 16,
+	D3DDECLTYPE_UNUSED    = 17
+} D3DDECLTYPE;
+
+typedef enum _D3DDECLMETHOD {
+	D3DDECLMETHOD_DEFAULT          = 0,
+	D3DDECLMETHOD_PARTIALU         = 1,
+	D3DDECLMETHOD_PARTIALV         = 2,
+	D3DDECLMETHOD_CROSSUV          = 3,
+	D3DDECLMETHOD_UV               = 4,
+	D3DDECLMETHOD_LOOKUP           = 5,
+	D3DDECLMETHOD_LOOKUPPRESAMPLED = 6
+} D3DDECLMETHOD;
+
+typedef enum _D3DDECLUSAGE {
+	D3DDECLUSAGE_POSITION     = 0,
+	D3DDECLUSAGE_BLENDWEIGHT  = 1,
+	D3DDECLUSAGE_BLENDINDICES = 2,
+	D3DDECLUSAGE_NORMAL       = 3,
+	D3DDECLUSAGE_PSIZE        = 4,
+	D3DDECLUSAGE_TEXCOORD     = 5,
+	D3DDECLUSAGE_TANGENT      = 6,
+	D3DDECLUSAGE_BINORMAL     = 7,
+	D3DDECLUSAGE_TESSFACTOR   = 8,
+	D3DDECLUSAGE_POSITIONT    = 9,
+	D3DDECLUSAGE_COLOR        = 10,
+	D3DDECLUSAGE_FOG          = 11,
+	D3DDECLUSAGE_DEPTH        = 12,
+	D3DDECLUSAGE_SAMPLE       = 13
+} D3DDECLUSAGE;
+
+#define MAXD3DDECLUSAGE      D3DDECLUSAGE_SAMPLE
+#define MAXD3DDECLUSAGEINDEX 15
+#define MAXD3DDECLLENGTH     64
+
+/*** Structures ***/
+typedef struct _D3DVERTEXELEMENT9 {
+	WORD Stream;
+	WORD Offset;
+	BYTE Type;
+	BYTE Method;
+	BYTE Usage;
+	BYTE UsageIndex;
+} D3DVERTEXELEMENT9, *LPD3DVERTEXELEMENT9;
+
+#define D3DDECL_END() {0xFF,0,D3DDECLTYPE_UNUSED,0,0,0}
+
+typedef struct _D3DDISPLAYMODE {
+	UINT      Width;
+	UINT      Height;
+	UINT      RefreshRate;
+	D3DFORMAT Format;
+} D3DDISPLAYMODE;
+
+typedef struct _D3DDEVICE_CREATION_PARAMETERS {
+	UINT       AdapterOrdinal;
+	D3DDEVTYPE DeviceType;
+	HWND       hFocusWindow;
+	DWORD      BehaviorFlags;
+} D3DDEVICE_CREATION_PARAMETERS;
+
+typedef struct _D3DPRESENT_PARAMETERS_ {
+	UINT                BackBufferWidth;
+	UINT                BackBufferHeight;
+	D3DFORMAT           BackBufferFormat;
+	UINT                BackBufferCount;
+	D3DMULTISAMPLE_TYPE MultiSampleType;
+	DWORD               MultiSampleQuality;
+	D3DSWAPEFFECT       SwapEffect;
+	HWND                hDeviceWindow;
+	BOOL                Windowed;
+	BOOL                EnableAutoDepthStencil;
+	D3DFORMAT           AutoDepthStencilFormat;
+	DWORD               Flags;
+	UINT                FullScreen_RefreshRateInHz;
+	UINT                PresentationInterval;
+} D3DPRESENT_PARAMETERS;
+
+typedef struct _D3DGAMMARAMP {
+	WORD red[256];
+	WORD green[256];
+	WORD blue[256];
+} D3DGAMMARAMP;
+
+typedef struct _D3DRASTER_STATUS {
+	BOOL InVBlank;
+	UINT ScanLine;
+} D3DRASTER_STATUS;
+
+typedef struct _D3DSURFACE_DESC {
+	D3DFORMAT           Format;
+	D3DRESOURCETYPE     Type;
+	DWORD               Usage;
+	D3DPOOL             Pool;
+	D3DMULTISAMPLE_TYPE MultiSampleType;
+	DWORD               MultiSampleQuality;
+	UINT                Width;
+	UINT                Height;
+} D3DSURFACE_DESC;
+
+typedef struct _D3DVOLUME_DESC {
+	D3DFORMAT       Format;
+	D3DRESOURCETYPE Type;
+	DWORD           Usage;
+	D3DPOOL         Pool;
+	UINT            Width;
+	UINT            Height;
+	UINT            Depth;
+} D3DVOLUME_DESC;
+
+typedef struct _D3DVERTEXBUFFER_DESC {
+	D3DFORMAT       Format;
+	D3DRESOURCETYPE Type;
+	DWORD           Usage;
+	D3DPOOL         Pool;
+	UINT            Size;
+	DWORD           FVF;
+} D3DVERTEXBUFFER_DESC;
+
+typedef struct _D3DINDEXBUFFER_DESC {
+	D3DFORMAT       Format;
+	D3DRESOURCETYPE Type;
+	DWORD           Usage;
+	D3DPOOL         Pool;
+	UINT            Size;
+} D3DINDEXBUFFER_DESC;
+
+typedef struct _D3DLOCKED_RECT {
+	INT   Pitch;
+	void* pBits;
+} D3DLOCKED_RECT;
+
+typedef struct _D3DBOX {
+	UINT Left;
+	UINT Top;
+	UINT Right;
+	UINT Bottom;
+	UINT Front;
+	UINT Back;
+} D3DBOX;
+
+typedef struct _D3DLOCKED_BOX {
+	INT   RowPitch;
+	INT   SlicePitch;
+	void* pBits;
+} D3DLOCKED_BOX;
+
+typedef struct _D3DRECTPATCH_INFO {
+	UINT          StartVertexOffsetWidth;
+	UINT          StartVertexOffsetHeight;
+	UINT          Width;
+	UINT          Height;
+	UINT          Stride;
+	D3DBASISTYPE  Basis;
+	D3DDEGREETYPE Degree;
+} D3DRECTPATCH_INFO;
+
+typedef struct _D3DTRIPATCH_INFO {
+	UINT          StartVertexOffset;
+	UINT          NumVertices;
+	D3DBASISTYPE  Basis;
+	D3DDEGREETYPE Degree;
+} D3DTRIPATCH_INFO;
+
+#define MAX_DEVICE_IDENTIFIER_STRING 512
+
+typedef struct _D3DADAPTER_IDENTIFIER9 {
+	char          Driver[MAX_DEVICE_IDENTIFIER_STRING];
+	char          Description[MAX_DEVICE_IDENTIFIER_STRING];
+	char          DeviceName[32];
+	LARGE_INTEGER DriverVersion;
+	DWORD         VendorId;
+	DWORD         DeviceId;
+	DWORD         SubSysId;
+	DWORD         Revision;
+	GUID          DeviceIdentifier;
+	DWORD         WHQLLevel;
+} D3DADAPTER_IDENTIFIER9;
+
+typedef struct _D3DVSHADERCAPS2_0 {
+	DWORD Caps;
+	INT   DynamicFlowControlDepth;
+	INT   NumTemps;
+	INT   StaticFlowControlDepth;
+} D3DVSHADERCAPS2_0;
+
+typedef struct _D3DPSHADERCAPS2_0 {
+	DWORD Caps;
+	INT   DynamicFlowControlDepth;
+	INT   NumTemps;
+	INT   StaticFlowControlDepth;
+	INT   NumInstructionSlots;
+} D3DPSHADERCAPS2_0;
+
+typedef struct _D3DCAPS9 {
+	D3DDEVTYPE        DeviceType;
+	UINT              AdapterOrdinal;
+	DWORD             Caps;
+	DWORD             Caps2;
+	DWORD             Caps3;
+	DWORD             PresentationIntervals;
+	DWORD             CursorCaps;
+	DWORD             DevCaps;
+	DWORD             PrimitiveMiscCaps;
+	DWORD             RasterCaps;
+	DWORD             ZCmpCaps;
+	DWORD             SrcBlendCaps;
+	DWORD             DestBlendCaps;
+	DWORD             AlphaCmpCaps;
+	DWORD             ShadeCaps;
+	DWORD             TextureCaps;
+	DWORD             TextureFilterCaps;
+	DWORD             CubeTextureFilterCaps;
+	DWORD             VolumeTextureFilterCaps;
+	DWORD             TextureAddressCaps;
+	DWORD             VolumeTextureAddressCaps;
+	DWORD             LineCaps;
+	DWORD             MaxTextureWidth;
+	DWORD             MaxTextureHeight;
+	DWORD             MaxVolumeExtent;
+	DWORD             MaxTextureRepeat;
+	DWORD             MaxTextureAspectRatio;
+	DWORD             MaxAnisotropy;
+	float             MaxVertexW;
+	float             GuardBandLeft;
+	float             GuardBandTop;
+	float             GuardBandRight;
+	float             GuardBandBottom;
+	float             ExtentsAdjust;
+	DWORD             StencilCaps;
+	DWORD             FVFCaps;
+	DWORD             TextureOpCaps;
+	DWORD             MaxTextureBlendStages;
+	DWORD             MaxSimultaneousTextures;
+	DWORD             VertexProcessingCaps;
+	DWORD             MaxActiveLights;
+	DWORD             MaxUserClipPlanes;
+	DWORD             MaxVertexBlendMatrices;
+	DWORD             MaxVertexBlendMatrixIndex;
+	float             MaxPointSize;
+	DWORD             MaxPrimitiveCount;
+	DWORD             MaxVertexIndex;
+	DWORD             MaxStreams;
+	DWORD             MaxStreamStride;
+	DWORD             VertexShaderVersion;
+	DWORD             MaxVertexShaderConst;
+	DWORD             PixelShaderVersion;
+	float             PixelShader1xMaxValue;
+	DWORD             DevCaps2;
+	float             MaxNpatchTessellationLevel;
+	DWORD             Reserved5;
+	UINT              MasterAdapterOrdinal;
+	UINT              AdapterOrdinalInGroup;
+	UINT              NumberOfAdaptersInGroup;
+	DWORD             DeclTypes;
+	DWORD             NumSimultaneousRTs;
+	DWORD             StretchRectFilterCaps;
+	D3DVSHADERCAPS2_0 VS20Caps;
+	D3DPSHADERCAPS2_0 PS20Caps;
+	DWORD             VertexTextureFilterCaps;
+	DWORD             MaxVShaderInstructionsExecuted;
+	DWORD             MaxPShaderInstructionsExecuted;
+	DWORD             MaxVertexShader30InstructionSlots;
+	DWORD             MaxPixelShader30InstructionSlots;
+} D3DCAPS9;
+
+/*** Interfaces ***/
+struct IDirect3D9;
+struct IDirect3DDevice9;
+struct IDirect3DStateBlock9;
+struct IDirect3DSwapChain9;
+struct IDirect3DResource9;
+struct IDirect3DBaseTexture9;
+struct IDirect3DTexture9;
+struct IDirect3DVolumeTexture9;
+struct IDirect3DCubeTexture9;
+struct IDirect3DVertexBuffer9;
+struct IDirect3DIndexBuffer9;
+struct IDirect3DSurface9;
+struct IDirect3DVolume9;
+struct IDirect3DVertexDeclaration9;
+struct IDirect3DVertexShader9;
+struct IDirect3DPixelShader9;
+struct IDirect3DQuery9;
+
+struct IUnknown
+{
+	virtual HRESULT WINAPI QueryInterface(REFIID riid, LPVOID* ppvObj) = 0;
+	virtual ULONG   WINAPI AddRef() = 0;
+	virtual ULONG   WINAPI Release() = 0;
+};
+typedef IUnknown* LPUNKNOWN;
+
+struct IDirect3D9 : public IUnknown
+{
+	virtual HRESULT  WINAPI RegisterSoftwareDevice(void* pInitializeFunction) = 0;
+	virtual UINT     WINAPI GetAdapterCount() = 0;
+	virtual HRESULT  WINAPI GetAdapterIdentifier(UINT Adapter, DWORD Flags, D3DADAPTER_IDENTIFIER9* pIdentifier) = 0;
+	virtual UINT     WINAPI GetAdapterModeCount(UINT Adapter, D3DFORMAT Format) = 0;
+	virtual HRESULT  WINAPI EnumAdapterModes(UINT Adapter, D3DFORMAT Format, UINT Mode, D3DDISPLAYMODE* pMode) = 0;
+	virtual HRESULT  WINAPI GetAdapterDisplayMode(UINT Adapter, D3DDISPLAYMODE* pMode) = 0;
+	virtual HRESULT  WINAPI CheckDeviceType(UINT Adapter, D3DDEVTYPE DevType, D3DFORMAT AdapterFormat, D3DFORMAT BackBufferFormat, BOOL bWindowed) = 0;
+	virtual HRESULT  WINAPI CheckDeviceFormat(UINT Adapter, D3DDEVTYPE DeviceType, D3DFORMAT AdapterFormat, DWORD Usage, D3DRESOURCETYPE RType, D3DFORMAT CheckFormat) = 0;
+	virtual HRESULT  WINAPI CheckDeviceMultiSampleType(UINT Adapter, D3DDEVTYPE DeviceType, D3DFORMAT SurfaceFormat, BOOL Windowed, D3DMULTISAMPLE_TYPE MultiSampleType, DWORD* pQualityLevels) = 0;
+	virtual HRESULT  WINAPI CheckDepthStencilMatch(UINT Adapter, D3DDEVTYPE DeviceType, D3DFORMAT AdapterFormat, D3DFORMAT RenderTargetFormat, D3DFORMAT DepthStencilFormat) = 0;
+	virtual HRESULT  WINAPI CheckDeviceFormatConversion(UINT Adapter, D3DDEVTYPE DeviceType, D3DFORMAT SourceFormat, D3DFORMAT TargetFormat) = 0;
+	virtual HRESULT  WINAPI GetDeviceCaps(UINT Adapter, D3DDEVTYPE DeviceType, D3DCAPS9* pCaps) = 0;
+	virtual HMONITOR WINAPI GetAdapterMonitor(UINT Adapter) = 0;
+	virtual HRESULT  WINAPI CreateDevice(UINT Adapter, D3DDEVTYPE DeviceType, HWND hFocusWindow, DWORD BehaviorFlags, D3DPRESENT_PARAMETERS* pPresentationParameters, IDirect3DDevice9** ppReturnedDeviceInterface) = 0;
+};
+
+struct IDirect3DDevice9 : public IUnknown
+{
+	virtual HRESULT WINAPI TestCooperativeLevel() = 0;
+	virtual UINT    WINAPI GetAvailableTextureMem() = 0;
+	virtual HRESULT WINAPI EvictManagedResources() = 0;
+	virtual HRESULT WINAPI GetDirect3D(IDirect3D9** ppD3D9) = 0;
+	virtual HRESULT WINAPI GetDeviceCaps(D3DCAPS9* pCaps) = 0;
+	virtual HRESULT WINAPI GetDisplayMode(UINT iSwapChain, D3DDISPLAYMODE* pMode) = 0;
+	virtual HRESULT WINAPI GetCreationParameters(D3DDEVICE_CREATION_PARAMETERS* pParameters) = 0;
+	virtual HRESULT WINAPI SetCursorProperties(UINT XHotSpot, UINT YHotSpot, IDirect3DSurface9* pCursorBitmap) = 0;
+	virtual void    WINAPI SetCursorPosition(int X, int Y, DWORD Flags) = 0;
+	virtual BOOL    WINAPI ShowCursor(BOOL bShow) = 0;
+	virtual HRESULT WINAPI CreateAdditionalSwapChain(D3DPRESENT_PARAMETERS* pPresentationParameters, IDirect3DSwapChain9** pSwapChain) = 0;
+	virtual HRESULT WINAPI GetSwapChain(UINT iSwapChain, IDirect3DSwapChain9** pSwapChain) = 0;
+	virtual UINT    WINAPI GetNumberOfSwapChains() = 0;
+	virtual HRESULT WINAPI Reset(D3DPRESENT_PARAMETERS* pPresentationParameters) = 0;
+	virtual HRESULT WINAPI Present(CONST RECT* pSourceRect, CONST RECT* pDestRect, HWND hDestWindowOverride, CONST RGNDATA* pDirtyRegion) = 0;
+	virtual HRESULT WINAPI GetBackBuffer(UINT iSwapChain, UINT iBackBuffer, D3DBACKBUFFER_TYPE Type, IDirect3DSurface9** ppBackBuffer) = 0;
+	virtual HRESULT WINAPI GetRasterStatus(UINT iSwapChain, D3DRASTER_STATUS* pRasterStatus) = 0;
+	virtual HRESULT WINAPI SetDialogBoxMode(BOOL bEnableDialogs) = 0;
+	virtual void    WINAPI SetGammaRamp(UINT iSwapChain, DWORD Flags, CONST D3DGAMMARAMP* pRamp) = 0;
+	virtual void    WINAPI GetGammaRamp(UINT iSwapChain, D3DGAMMARAMP* pRamp) = 0;
+	virtual HRESULT WINAPI CreateTexture(UINT Width, UINT Height, UINT Levels, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DTexture9** ppTexture, HANDLE* pSharedHandle) = 0;
+	virtual HRESULT WINAPI CreateVolumeTexture(UINT Width, UINT Height, UINT Depth, UINT Levels, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DVolumeTexture9** ppVolumeTexture, HANDLE* pSharedHandle) = 0;
+	virtual HRESULT WINAPI CreateCubeTexture(UINT EdgeLength, UINT Levels, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DCubeTexture9** ppCubeTexture, HANDLE* pSharedHandle) = 0;
+	virtual HRESULT WINAPI CreateVertexBuffer(UINT Length, DWORD Usage, DWORD FVF, D3DPOOL Pool, IDirect3DVertexBuffer9** ppVertexBuffer, HANDLE* pSharedHandle) = 0;
+	virtual HRESULT WINAPI CreateIndexBuffer(UINT Length, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DIndexBuffer9** ppIndexBuffer, HANDLE* pSharedHandle) = 0;
+	virtual HRESULT WINAPI CreateRenderTarget(UINT Width, UINT Height, D3DFORMAT Format, D3DMULTISAMPLE_TYPE MultiSample, DWORD MultisampleQuality, BOOL Lockable, IDirect3DSurface9** ppSurface, HANDLE* pSharedHandle) = 0;
+	virtual HRESULT WINAPI CreateDepthStencilSurface(UINT Width, UINT Height, D3DFORMAT Format, D3DMULTISAMPLE_TYPE MultiSample, DWORD MultisampleQuality, BOOL Discard, IDirect3DSurface9** ppSurface, HANDLE* pSharedHandle) = 0;
+	virtual HRESULT WINAPI UpdateSurface(IDirect3DSurface9* pSourceSurface, CONST RECT* pSourceRect, IDirect3DSurface9* pDestinationSurface, CONST POINT* pDestPoint) = 0;
+	virtual HRESULT WINAPI UpdateTexture(IDirect3DBaseTexture9* pSourceTexture, IDirect3DBaseTexture9* pDestinationTexture) = 0;
+	virtual HRESULT WINAPI GetRenderTargetData(IDirect3DSurface9* pRenderTarget, IDirect3DSurface9* pDestSurface) = 0;
+	virtual HRESULT WINAPI GetFrontBufferData(UINT iSwapChain, IDirect3DSurface9* pDestSurface) = 0;
+	virtual HRESULT WINAPI StretchRect(IDirect3DSurface9* pSourceSurface, CONST RECT* pSourceRect, IDirect3DSurface9* pDestSurface, CONST RECT* pDestRect, D3DTEXTUREFILTERTYPE Filter) = 0;
+	virtual HRESULT WINAPI ColorFill(IDirect3DSurface9* pSurface, CONST RECT* pRect, D3DCOLOR color) = 0;
+	virtual HRESULT WINAPI CreateOffscreenPlainSurface(UINT Width, UINT Height, D3DFORMAT Format, D3DPOOL Pool, IDirect3DSurface9** ppSurface, HANDLE* pSharedHandle) = 0;
+	virtual HRESULT WINAPI SetRenderTarget(DWORD RenderTargetIndex, IDirect3DSurface9* pRenderTarget) = 0;
+	virtual HRESULT WINAPI GetRenderTarget(DWORD RenderTargetIndex, IDirect3DSurface9** ppRenderTarget) = 0;
+	virtual HRESULT WINAPI SetDepthStencilSurface(IDirect3DSurface9* pNewZStencil) = 0;
+	virtual HRESULT WINAPI GetDepthStencilSurface(IDirect3DSurface9** ppZStencilSurface) = 0;
+	virtual HRESULT WINAPI BeginScene() = 0;
+	virtual HRESULT WINAPI EndScene() = 0;
+	virtual HRESULT WINAPI Clear(DWORD Count, CONST D3DRECT* pRects, DWORD Flags, D3DCOLOR Color, float Z, DWORD Stencil) = 0;
+	virtual HRESULT WINAPI SetTransform(D3DTRANSFORMSTATETYPE State, CONST D3DMATRIX* pMatrix) = 0;
+	virtual HRESULT WINAPI GetTransform(D3DTRANSFORMSTATETYPE State, D3DMATRIX* pMatrix) = 0;
+	virtual HRESULT WINAPI MultiplyTransform(D3DTRANSFORMSTATETYPE State, CONST D3DMATRIX* pMatrix) = 0;
+	virtual HRESULT WINAPI SetViewport(CONST D3DVIEWPORT9* pViewport) = 0;
+	virtual HRESULT WINAPI GetViewport(D3DVIEWPORT9* pViewport) = 0;
+	virtual HRESULT WINAPI SetMaterial(CONST D3DMATERIAL9* pMaterial) = 0;
+	virtual HRESULT WINAPI GetMaterial(D3DMATERIAL9* pMaterial) = 0;
+	virtual HRESULT WINAPI SetLight(DWORD Index, CONST D3DLIGHT9* pLight) = 0;
+	virtual HRESULT WINAPI GetLight(DWORD Index, D3DLIGHT9* pLight) = 0;
+	virtual HRESULT WINAPI LightEnable(DWORD Index, BOOL Enable) = 0;
+	virtual HRESULT WINAPI GetLightEnable(DWORD Index, BOOL* pEnable) = 0;
+	virtual HRESULT WINAPI SetClipPlane(DWORD Index, CONST float* pPlane) = 0;
+	virtual HRESULT WINAPI GetClipPlane(DWORD Index, float* pPlane) = 0;
+	virtual HRESULT WINAPI SetRenderState(D3DRENDERSTATETYPE State, DWORD Value) = 0;
+	virtual HRESULT WINAPI GetRenderState(D3DRENDERSTATETYPE State, DWORD* pValue) = 0;
+	virtual HRESULT WINAPI CreateStateBlock(D3DSTATEBLOCKTYPE Type, IDirect3DStateBlock9** ppSB) = 0;
+	virtual HRESULT WINAPI BeginStateBlock() = 0;
+	virtual HRESULT WINAPI EndStateBlock(IDirect3DStateBlock9** ppSB) = 0;
+	virtual HRESULT WINAPI SetClipStatus(CONST D3DCLIPSTATUS9* pClipStatus) = 0;
+	virtual HRESULT WINAPI GetClipStatus(D3DCLIPSTATUS9* pClipStatus) = 0;
+	virtual HRESULT WINAPI GetTexture(DWORD Stage, IDirect3DBaseTexture9** ppTexture) = 0;
+	virtual HRESULT WINAPI SetTexture(DWORD Stage, IDirect3DBaseTexture9* pTexture) = 0;
+	virtual HRESULT WINAPI GetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD* pValue) = 0;
+	virtual HRESULT WINAPI SetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD Value) = 0;
+	virtual HRESULT WINAPI GetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD* pValue) = 0;
+	virtual HRESULT WINAPI SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD Value) = 0;
+	virtual HRESULT WINAPI ValidateDevice(DWORD* pNumPasses) = 0;
+	virtual HRESULT WINAPI SetPaletteEntries(UINT PaletteNumber, CONST PALETTEENTRY* pEntries) = 0;
+	virtual HRESULT WINAPI GetPaletteEntries(UINT PaletteNumber, PALETTEENTRY* pEntries) = 0;
+	virtual HRESULT WINAPI SetCurrentTexturePalette(UINT PaletteNumber) = 0;
+	virtual HRESULT WINAPI GetCurrentTexturePalette(UINT* PaletteNumber) = 0;
+	virtual HRESULT WINAPI SetScissorRect(CONST RECT* pRect) = 0;
+	virtual HRESULT WINAPI GetScissorRect(RECT* pRect) = 0;
+	virtual HRESULT WINAPI SetSoftwareVertexProcessing(BOOL bSoftware) = 0;
+	virtual BOOL    WINAPI GetSoftwareVertexProcessing() = 0;
+	virtual HRESULT WINAPI SetNPatchMode(float nSegments) = 0;
+	virtual float   WINAPI GetNPatchMode() = 0;
+	virtual HRESULT WINAPI DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType, UINT StartVertex, UINT PrimitiveCount) = 0;
+	virtual HRESULT WINAPI DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType, INT BaseVertexIndex, UINT MinVertexIndex, UINT NumVertices, UINT startIndex, UINT primCount) = 0;
+	virtual HRESULT WINAPI DrawPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT PrimitiveCount, CONST void* pVertexStreamZeroData, UINT VertexStreamZeroStride) = 0;
+	virtual HRESULT WINAPI DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT MinVertexIndex, UINT NumVertices, UINT PrimitiveCount, CONST void* pIndexData, D3DFORMAT IndexDataFormat, CONST void* pVertexStreamZeroData, UINT VertexStreamZeroStride) = 0;
+	virtual HRESULT WINAPI ProcessVertices(UINT SrcStartIndex, UINT DestIndex, UINT VertexCount, IDirect3DVertexBuffer9* pDestBuffer, IDirect3DVertexDeclaration9* pVertexDecl, DWORD Flags) = 0;
+	virtual HRESULT WINAPI CreateVertexDeclaration(CONST D3DVERTEXELEMENT9* pVertexElements, IDirect3DVertexDeclaration9** ppDecl) = 0;
+	virtual HRESULT WINAPI SetVertexDeclaration(IDirect3DVertexDeclaration9* pDecl) = 0;
+	virtual HRESULT WINAPI GetVertexDeclaration(IDirect3DVertexDeclaration9** ppDecl) = 0;
+	virtual HRESULT WINAPI SetFVF(DWORD FVF) = 0;
+	virtual HRESULT WINAPI GetFVF(DWORD* pFVF) = 0;
+	virtual HRESULT WINAPI CreateVertexShader(CONST DWORD* pFunction, IDirect3DVertexShader9** ppShader) = 0;
+	virtual HRESULT WINAPI SetVertexShader(IDirect3DVertexShader9* pShader) = 0;
+	virtual HRESULT WINAPI GetVertexShader(IDirect3DVertexShader9** ppShader) = 0;
+	virtual HRESULT WINAPI SetVertexShaderConstantF(UINT StartRegister, CONST float* pConstantData, UINT Vector4fCount) = 0;
+	virtual HRESULT WINAPI GetVertexShaderConstantF(UINT StartRegister, float* pConstantData, UINT Vector4fCount) = 0;
+	virtual HRESULT WINAPI SetVertexShaderConstantI(UINT StartRegister, CONST int* pConstantData, UINT Vector4iCount) = 0;
+	virtual HRESULT WINAPI GetVertexShaderConstantI(UINT StartRegister, int* pConstantData, UINT Vector4iCount) = 0;
+	virtual HRESULT WINAPI SetVertexShaderConstantB(UINT StartRegister, CONST BOOL* pConstantData, UINT BoolCount) = 0;
+	virtual HRESULT WINAPI GetVertexShaderConstantB(UINT StartRegister, BOOL* pConstantData, UINT BoolCount) = 0;
+	virtual HRESULT WINAPI SetStreamSource(UINT StreamNumber, IDirect3DVertexBuffer9* pStreamData, UINT OffsetInBytes, UINT Stride) = 0;
+	virtual HRESULT WINAPI GetStreamSource(UINT StreamNumber, IDirect3DVertexBuffer9** ppStreamData, UINT* pOffsetInBytes, UINT* pStride) = 0;
+	virtual HRESULT WINAPI SetStreamSourceFreq(UINT StreamNumber, UINT Setting) = 0;
+	virtual HRESULT WINAPI GetStreamSourceFreq(UINT StreamNumber, UINT* pSetting) = 0;
+	virtual HRESULT WINAPI SetIndices(IDirect3DIndexBuffer9* pIndexData) = 0;
+	virtual HRESULT WINAPI GetIndices(IDirect3DIndexBuffer9** ppIndexData) = 0;
+	virtual HRESULT WINAPI CreatePixelShader(CONST DWORD* pFunction, IDirect3DPixelShader9** ppShader) = 0;
+	virtual HRESULT WINAPI SetPixelShader(IDirect3DPixelShader9* pShader) = 0;
+	virtual HRESULT WINAPI GetPixelShader(IDirect3DPixelShader9** ppShader) = 0;
+	virtual HRESULT WINAPI SetPixelShaderConstantF(UINT StartRegister, CONST float* pConstantData, UINT Vector4fCount) = 0;
+	virtual HRESULT WINAPI GetPixelShaderConstantF(UINT StartRegister, float* pConstantData, UINT Vector4fCount) = 0;
+	virtual HRESULT WINAPI SetPixelShaderConstantI(UINT StartRegister, CONST int* pConstantData, UINT Vector4iCount) = 0;
+	virtual HRESULT WINAPI GetPixelShaderConstantI(UINT StartRegister, int* pConstantData, UINT Vector4iCount) = 0;
+	virtual HRESULT WINAPI SetPixelShaderConstantB(UINT StartRegister, CONST BOOL* pConstantData, UINT BoolCount) = 0;
+	virtual HRESULT WINAPI GetPixelShaderConstantB(UINT StartRegister, BOOL* pConstantData, UINT BoolCount) = 0;
+	virtual HRESULT WINAPI DrawRectPatch(UINT Handle, CONST float* pNumSegs, CONST D3DRECTPATCH_INFO* pRectPatchInfo) = 0;
+	virtual HRESULT WINAPI DrawTriPatch(UINT Handle, CONST float* pNumSegs, CONST D3DTRIPATCH_INFO* pTriPatchInfo) = 0;
+	virtual HRESULT WINAPI DeletePatch(UINT Handle) = 0;
+	virtual HRESULT WINAPI CreateQuery(D3DQUERYTYPE Type, IDirect3DQuery9** ppQuery) = 0;
+};
+
+struct IDirect3DStateBlock9 : public IUnknown
+{
+	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice) = 0;
+	virtual HRESULT WINAPI Capture() = 0;
+	virtual HRESULT WINAPI Apply() = 0;
+};
+
+struct IDirect3DSwapChain9 : public IUnknown
+{
+	virtual HRESULT WINAPI Present(CONST RECT* pSourceRect, CONST RECT* pDestRect, HWND hDestWindowOverride, CONST RGNDATA* pDirtyRegion, DWORD dwFlags) = 0;
+	virtual HRESULT WINAPI GetFrontBufferData(IDirect3DSurface9* pDestSurface) = 0;
+	virtual HRESULT WINAPI GetBackBuffer(UINT iBackBuffer, D3DBACKBUFFER_TYPE Type, IDirect3DSurface9** ppBackBuffer) = 0;
+	virtual HRESULT WINAPI GetRasterStatus(D3DRASTER_STATUS* pRasterStatus) = 0;
+	virtual HRESULT WINAPI GetDisplayMode(D3DDISPLAYMODE* pMode) = 0;
+	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice) = 0;
+	virtual HRESULT WINAPI GetPresentParameters(D3DPRESENT_PARAMETERS* pPresentationParameters) = 0;
+};
+
+struct IDirect3DResource9 : public IUnknown
+{
+	virtual HRESULT         WINAPI GetDevice(IDirect3DDevice9** ppDevice) = 0;
+	virtual HRESULT         WINAPI SetPrivateData(REFGUID refguid, CONST void* pData, DWORD SizeOfData, DWORD Flags) = 0;
+	virtual HRESULT         WINAPI GetPrivateData(REFGUID refguid, void* pData, DWORD* pSizeOfData) = 0;
+	virtual HRESULT         WINAPI FreePrivateData(REFGUID refguid) = 0;
+	virtual DWORD           WINAPI SetPriority(DWORD PriorityNew) = 0;
+	virtual DWORD           WINAPI GetPriority() = 0;
+	virtual void            WINAPI PreLoad() = 0;
+	virtual D3DRESOURCETYPE WINAPI GetType() = 0;
+};
+
+struct IDirect3DBaseTexture9 : public IDirect3DResource9
+{
+	virtual DWORD                WINAPI SetLOD(DWORD LODNew) = 0;
+	virtual DWORD                WINAPI GetLOD() = 0;
+	virtual DWORD                WINAPI GetLevelCount() = 0;
+	virtual HRESULT              WINAPI SetAutoGenFilterType(D3DTEXTUREFILTERTYPE FilterType) = 0;
+	virtual D3DTEXTUREFILTERTYPE WINAPI GetAutoGenFilterType() = 0;
+	virtual void                 WINAPI GenerateMipSubLevels() = 0;
+};
+
+struct IDirect3DTexture9 : public IDirect3DBaseTexture9
+{
+	virtual HRESULT WINAPI GetLevelDesc(UINT Level, D3DSURFACE_DESC* pDesc) = 0;
+	virtual HRESULT WINAPI GetSurfaceLevel(UINT Level, IDirect3DSurface9** ppSurfaceLevel) = 0;
+	virtual HRESULT WINAPI LockRect(UINT Level, D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags) = 0;
+	virtual HRESULT WINAPI UnlockRect(UINT Level) = 0;
+	virtual HRESULT WINAPI AddDirtyRect(CONST RECT* pDirtyRect) = 0;
+};
+
+struct IDirect3DVolumeTexture9 : public IDirect3DBaseTexture9
+{
+	virtual HRESULT WINAPI GetLevelDesc(UINT Level, D3DVOLUME_DESC* pDesc) = 0;
+	virtual HRESULT WINAPI GetVolumeLevel(UINT Level, IDirect3DVolume9** ppVolumeLevel) = 0;
+	virtual HRESULT WINAPI LockBox(UINT Level, D3DLOCKED_BOX* pLockedVolume, CONST D3DBOX* pBox, DWORD Flags) = 0;
+	virtual HRESULT WINAPI UnlockBox(UINT Level) = 0;
+	virtual HRESULT WINAPI AddDirtyBox(CONST D3DBOX* pDirtyBox) = 0;
+};
+
+struct IDirect3DCubeTexture9 : public IDirect3DBaseTexture9
+{
+	virtual HRESULT WINAPI GetLevelDesc(UINT Level, D3DSURFACE_DESC* pDesc) = 0;
+	virtual HRESULT WINAPI GetCubeMapSurface(D3DCUBEMAP_FACES FaceType, UINT Level, IDirect3DSurface9** ppCubeMapSurface) = 0;
+	virtual HRESULT WINAPI LockRect(D3DCUBEMAP_FACES FaceType, UINT Level, D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags) = 0;
+	virtual HRESULT WINAPI UnlockRect(D3DCUBEMAP_FACES FaceType, UINT Level) = 0;
+	virtual HRESULT WINAPI AddDirtyRect(D3DCUBEMAP_FACES FaceType, CONST RECT* pDirtyRect) = 0;
+};
+
+struct IDirect3DVertexBuffer9 : public IDirect3DResource9
+{
+	virtual HRESULT WINAPI Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DWORD Flags) = 0;
+	virtual HRESULT WINAPI Unlock() = 0;
+	virtual HRESULT WINAPI GetDesc(D3DVERTEXBUFFER_DESC* pDesc) = 0;
+};
+
+struct IDirect3DIndexBuffer9 : public IDirect3DResource9
+{
+	virtual HRESULT WINAPI Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DWORD Flags) = 0;
+	virtual HRESULT WINAPI Unlock() = 0;
+	virtual HRESULT WINAPI GetDesc(D3DINDEXBUFFER_DESC* pDesc) = 0;
+};
+
+struct IDirect3DSurface9 : public IDirect3DResource9
+{
+	virtual HRESULT WINAPI GetContainer(REFIID riid, void** ppContainer) = 0;
+	virtual HRESULT WINAPI GetDesc(D3DSURFACE_DESC* pDesc) = 0;
+	virtual HRESULT WINAPI LockRect(D3DLOCKED_RECT* pLockedRect, CONST RECT* pRect, DWORD Flags) = 0;
+	virtual HRESULT WINAPI UnlockRect() = 0;
+	virtual HRESULT WINAPI GetDC(HDC* phdc) = 0;
+	virtual HRESULT WINAPI ReleaseDC(HDC hdc) = 0;
+};
+
+struct IDirect3DVolume9 : public IUnknown
+{
+	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice) = 0;
+	virtual HRESULT WINAPI SetPrivateData(REFGUID refguid, CONST void* pData, DWORD SizeOfData, DWORD Flags) = 0;
+	virtual HRESULT WINAPI GetPrivateData(REFGUID refguid, void* pData, DWORD* pSizeOfData) = 0;
+	virtual HRESULT WINAPI FreePrivateData(REFGUID refguid) = 0;
+	virtual HRESULT WINAPI GetContainer(REFIID riid, void** ppContainer) = 0;
+	virtual HRESULT WINAPI GetDesc(D3DVOLUME_DESC* pDesc) = 0;
+	virtual HRESULT WINAPI LockBox(D3DLOCKED_BOX* pLockedVolume, CONST D3DBOX* pBox, DWORD Flags) = 0;
+	virtual HRESULT WINAPI UnlockBox() = 0;
+};
+
+struct IDirect3DVertexDeclaration9 : public IUnknown
+{
+	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice) = 0;
+	virtual HRESULT WINAPI GetDeclaration(D3DVERTEXELEMENT9* pElement, UINT* pNumElements) = 0;
+};
+
+struct IDirect3DVertexShader9 : public IUnknown
+{
+	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice) = 0;
+	virtual HRESULT WINAPI GetFunction(void* pData, UINT* pSizeOfData) = 0;
+};
+
+struct IDirect3DPixelShader9 : public IUnknown
+{
+	virtual HRESULT WINAPI GetDevice(IDirect3DDevice9** ppDevice) = 0;
+	virtual HRESULT WINAPI GetFunction(void* pData, UINT* pSizeOfData) = 0;
+};
+
+struct IDirect3DQuery9 : public IUnknown
+{
+	virtual HRESULT      WINAPI GetDevice(IDirect3DDevice9** ppDevice) = 0;
+	virtual D3DQUERYTYPE WINAPI GetType() = 0;
+	virtual DWORD        WINAPI GetDataSize() = 0;
+	virtual HRESULT      WINAPI Issue(DWORD dwIssueFlags) = 0;
+	virtual HRESULT      WINAPI GetData(void* pData, DWORD dwSize, DWORD dwGetDataFlags) = 0;
+};
+
+typedef IDirect3D9*                  LPDIRECT3D9;
+typedef IDirect3DDevice9*            LPDIRECT3DDEVICE9;
+typedef IDirect3DStateBlock9*        LPDIRECT3DSTATEBLOCK9;
+typedef IDirect3DSwapChain9*         LPDIRECT3DSWAPCHAIN9;
+typedef IDirect3DResource9*          LPDIRECT3DRESOURCE9;
+typedef IDirect3DBaseTexture9*       LPDIRECT3DBASETEXTURE9;
+typedef IDirect3DTexture9*           LPDIRECT3DTEXTURE9;
+typedef IDirect3DVolumeTexture9*     LPDIRECT3DVOLUMETEXTURE9;
+typedef IDirect3DCubeTexture9*       LPDIRECT3DCUBETEXTURE9;
+typedef IDirect3DVertexBuffer9*      LPDIRECT3DVERTEXBUFFER9;
+typedef IDirect3DIndexBuffer9*       LPDIRECT3DINDEXBUFFER9;
+typedef IDirect3DSurface9*           LPDIRECT3DSURFACE9;
+typedef IDirect3DVolume9*            LPDIRECT3DVOLUME9;
+typedef IDirect3DVertexDeclaration9* LPDIRECT3DVERTEXDECLARATION9;
+typedef IDirect3DVertexShader9*      LPDIRECT3DVERTEXSHADER9;
+typedef IDirect3DPixelShader9*       LPDIRECT3DPIXELSHADER9;
+typedef IDirect3DQuery9*             LPDIRECT3DQUERY9;
+
+DEFINE_GUID(IID_IUnknown,                    0x00000000, 0x0000, 0x0000, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46);
+DEFINE_GUID(IID_IDirect3D9,                  0x81bdcbca, 0x64d4, 0x426d, 0xae, 0x8d, 0xad, 0x01, 0x47, 0xf4, 0x27, 0x5c);
+DEFINE_GUID(IID_IDirect3DDevice9,            0xd0223b96, 0xbf7a, 0x43fd, 0x92, 0xbd, 0xa4, 0x3b, 0x0d, 0x82, 0xb9, 0xeb);
+DEFINE_GUID(IID_IDirect3DResource9,          0x05eec05d, 0x8f7d, 0x4362, 0xb9, 0x99, 0xd1, 0xba, 0xf3, 0x57, 0xc7, 0x04);
+DEFINE_GUID(IID_IDirect3DBaseTexture9,       0x580ca87e, 0x1d3c, 0x4d54, 0x99, 0x1d, 0xb7, 0xd3, 0xe3, 0xc2, 0x98, 0xce);
+DEFINE_GUID(IID_IDirect3DTexture9,           0x85c31227, 0x3de5, 0x4f00, 0x9b, 0x3a, 0xf1, 0x1a, 0xc3, 0x8c, 0x18, 0xb5);
+DEFINE_GUID(IID_IDirect3DCubeTexture9,       0xfff32f81, 0xd953, 0x473a, 0x92, 0x23, 0x93, 0xd6, 0x52, 0xab, 0xa9, 0x3f);
+DEFINE_GUID(IID_IDirect3DVolumeTexture9,     0x2518526c, 0xe789, 0x4111, 0xa7, 0xb9, 0x47, 0xef, 0x32, 0x8d, 0x13, 0xe6);
+DEFINE_GUID(IID_IDirect3DSurface9,           0x0cfbaf3a, 0x9ff6, 0x429a, 0x99, 0xb3, 0xa2, 0x79, 0x6a, 0xf8, 0xb8, 0x9b);
+DEFINE_GUID(IID_IDirect3DVolume9,            0x24f416e6, 0x1f67, 0x4aa7, 0xb8, 0x8e, 0xd3, 0x3f, 0x6f, 0x31, 0x28, 0xa1);
+DEFINE_GUID(IID_IDirect3DSwapChain9,         0x794950f2, 0xadfc, 0x458a, 0x90, 0x5e, 0x10, 0xa1, 0x0b, 0x0b, 0x50, 0x3b);
+
+#endif
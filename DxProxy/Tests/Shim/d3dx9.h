@@ -0,0 +1,554 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <d3dx9.h> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef SHIM_D3DX9_H_INCLUDED
+#define SHIM_D3DX9_H_INCLUDED
+
+/**
+* D3DX subset for the headless test build.
+* The math types and functions compute what D3DX computes (the stereo matrices are checked against them), fonts,
+* sprites and effects are objects that accept every call and draw nothing, D3DXSaveSurfaceToFile() writes nothing.
+***/
+
+#include <math.h>
+#include <d3d9.h>
+
+#define D3DX_PI    ((FLOAT)3.141592654f)
+#define D3DX_1BYPI ((FLOAT)0.318309886f)
+#define D3DXToRadian(degree) ((degree) * (D3DX_PI / 180.0f))
+#define D3DXToDegree(radian) ((radian) * (180.0f / D3DX_PI))
+
+/*** Math types ***/
+struct D3DXVECTOR2
+{
+	D3DXVECTOR2() {}
+	D3DXVECTOR2(const FLOAT* pf) : x(pf[0]), y(pf[1]) {}
+	D3DXVECTOR2(FLOAT fx, FLOAT fy) : x(fx), y(fy) {}
+
+	operator FLOAT* () { return &x; }
+	operator const FLOAT* () const { return &x; }
+
+	D3DXVECTOR2& operator += (const D3DXVECTOR2& v) { x += v.x; y += v.y; return *this; }
+	D3DXVECTOR2& operator -= (const D3DXVECTOR2& v) { x -= v.x; y -= v.y; return *this; }
+	D3DXVECTOR2& operator *= (FLOAT f) { x *= f; y *= f; return *this; }
+	D3DXVECTOR2& operator /= (FLOAT f) { x /= f; y /= f; return *this; }
+
+	D3DXVECTOR2 operator + () const { return *this; }
+	D3DXVECTOR2 operator - () const { return D3DXVECTOR2(-x, -y); }
+	D3DXVECTOR2 operator + (const D3DXVECTOR2& v) const { return D3DXVECTOR2(x + v.x, y + v.y); }
+	D3DXVECTOR2 operator - (const D3DXVECTOR2& v) const { return D3DXVECTOR2(x - v.x, y - v.y); }
+	D3DXVECTOR2 operator * (FLOAT f) const { return D3DXVECTOR2(x * f, y * f); }
+	D3DXVECTOR2 operator / (FLOAT f) const { return D3DXVECTOR2(x / f, y / f); }
+
+	bool operator == (const D3DXVECTOR2& v) const { return x == v.x && y == v.y; }
+	bool operator != (const D3DXVECTOR2& v) const { return x != v.x || y != v.y; }
+
+	FLOAT x, y;
+};
+
+struct D3DXVECTOR3 : public D3DVECTOR
+{
+	D3DXVECTOR3() {}
+	D3DXVECTOR3(const FLOAT* pf) { x = pf[0]; y = pf[1]; z = pf[2]; }
+	D3DXVECTOR3(const D3DVECTOR& v) { x = v.x; y = v.y; z = v.z; }
+	D3DXVECTOR3(FLOAT fx, FLOAT fy, FLOAT fz) { x = fx; y = fy; z = fz; }
+
+	operator FLOAT* () { return &x; }
+	operator const FLOAT* () const { return &x; }
+
+	D3DXVECTOR3& operator += (const D3DXVECTOR3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+	D3DXVECTOR3& operator -= (const D3DXVECTOR3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+	D3DXVECTOR3& operator *= (FLOAT f) { x *= f; y *= f; z *= f; return *this; }
+	D3DXVECTOR3& operator /= (FLOAT f) { x /= f; y /= f; z /= f; return *this; }
+
+	D3DXVECTOR3 operator + () const { return *this; }
+	D3DXVECTOR3 operator - () const { return D3DXVECTOR3(-x, -y, -z); }
+	D3DXVECTOR3 operator + (const D3DXVECTOR3& v) const { return D3DXVECTOR3(x + v.x, y + v.y, z + v.z); }
+	D3DXVECTOR3 operator - (const D3DXVECTOR3& v) const { return D3DXVECTOR3(x - v.x, y - v.y, z - v.z); }
+	D3DXVECTOR3 operator * (FLOAT f) const { return D3DXVECTOR3(x * f, y * f, z * f); }
+	D3DXVECTOR3 operator / (FLOAT f) const { return D3DXVECTOR3(x / f, y / f, z / f); }
+
+	bool operator == (const D3DXVECTOR3& v) const { return x == v.x && y == v.y && z == v.z; }
+	bool operator != (const D3DXVECTOR3& v) const { return !(*this == v); }
+};
+
+struct D3DXVECTOR4
+{
+	D3DXVECTOR4() {}
+	D3DXVECTOR4(const FLOAT* pf) : x(pf[0]), y(pf[1]), z(pf[2]), w(pf[3]) {}
+	D3DXVECTOR4(const D3DVECTOR& v, FLOAT f) : x(v.x), y(v.y), z(v.z), w(f) {}
+	D3DXVECTOR4(FLOAT fx, FLOAT fy, FLOAT fz, FLOAT fw) : x(fx), y(fy), z(fz), w(fw) {}
+
+	operator FLOAT* () { return &x; }
+	operator const FLOAT* () const { return &x; }
+
+	D3DXVECTOR4& operator += (const D3DXVECTOR4& v) { x += v.x; y += v.y; z += v.z; w += v.w; return *this; }
+	D3DXVECTOR4& operator -= (const D3DXVECTOR4& v) { x -= v.x; y -= v.y; z -= v.z; w -= v.w; return *this; }
+	D3DXVECTOR4& operator *= (FLOAT f) { x *= f; y *= f; z *= f; w *= f; return *this; }
+
+	D3DXVECTOR4 operator - () const { return D3DXVECTOR4(-x, -y, -z, -w); }
+	D3DXVECTOR4 operator + (const D3DXVECTOR4& v) const { return D3DXVECTOR4(x + v.x, y + v.y, z + v.z, w + v.w); }
+	D3DXVECTOR4 operator - (const D3DXVECTOR4& v) const { return D3DXVECTOR4(x - v.x, y - v.y, z - v.z, w - v.w); }
+	D3DXVECTOR4 operator * (FLOAT f) const { return D3DXVECTOR4(x * f, y * f, z * f, w * f); }
+
+	bool operator == (const D3DXVECTOR4& v) const { return x == v.x && y == v.y && z == v.z && w == v.w; }
+	bool operator != (const D3DXVECTOR4& v) const { return !(*this == v); }
+
+	FLOAT x, y, z, w;
+};
+
+struct D3DXMATRIX;
+D3DXMATRIX* D3DXMatrixMultiply(D3DXMATRIX* pOut, const D3DXMATRIX* pM1, const D3DXMATRIX* pM2);
+
+struct D3DXMATRIX : public D3DMATRIX
+{
+	D3DXMATRIX() {}
+	D3DXMATRIX(const FLOAT* pf) { memcpy(&_11, pf, sizeof(D3DMATRIX)); }
+	D3DXMATRIX(const D3DMATRIX& mat) { memcpy(&_11, &mat, sizeof(D3DMATRIX)); }
+	D3DXMATRIX(FLOAT f11, FLOAT f12, FLOAT f13, FLOAT f14,
+	           FLOAT f21, FLOAT f22, FLOAT f23, FLOAT f24,
+	           FLOAT f31, FLOAT f32, FLOAT f33, FLOAT f34,
+	           FLOAT f41, FLOAT f42, FLOAT f43, FLOAT f44)
+	{
+		_11 = f11; _12 = f12; _13 = f13; _14 = f14;
+		_21 = f21; _22 = f22; _23 = f23; _24 = f24;
+		_31 = f31; _32 = f32; _33 = f33; _34 = f34;
+		_41 = f41; _42 = f42; _43 = f43; _44 = f44;
+	}
+
+	FLOAT& operator () (UINT row, UINT col) { return m[row][col]; }
+	FLOAT  operator () (UINT row, UINT col) const { return m[row][col]; }
+
+	operator FLOAT* () { return &_11; }
+	operator const FLOAT* () const { return &_11; }
+
+	D3DXMATRIX& operator *= (const D3DXMATRIX& mat) { D3DXMatrixMultiply(this, this, &mat); return *this; }
+	D3DXMATRIX& operator += (const D3DXMATRIX& mat) { for (int i = 0; i < 16; i++) (&_11)[i] += (&mat._11)[i]; return *this; }
+	D3DXMATRIX& operator -= (const D3DXMATRIX& mat) { for (int i = 0; i < 16; i++) (&_11)[i] -= (&mat._11)[i]; return *this; }
+	D3DXMATRIX& operator *= (FLOAT f) { for (int i = 0; i < 16; i++) (&_11)[i] *= f; return *this; }
+	D3DXMATRIX& operator /= (FLOAT f) { for (int i = 0; i < 16; i++) (&_11)[i] /= f; return *this; }
+
+	D3DXMATRIX operator + () const { return *this; }
+	D3DXMATRIX operator - () const { D3DXMATRIX r(*this); r *= -1.0f; return r; }
+	D3DXMATRIX operator * (const D3DXMATRIX& mat) const { D3DXMATRIX r; D3DXMatrixMultiply(&r, this, &mat); return r; }
+	D3DXMATRIX operator + (const D3DXMATRIX& mat) const { D3DXMATRIX r(*this); r += mat; return r; }
+	D3DXMATRIX operator - (const D3DXMATRIX& mat) const { D3DXMATRIX r(*this); r -= mat; return r; }
+	D3DXMATRIX operator * (FLOAT f) const { D3DXMATRIX r(*this); r *= f; return r; }
+	D3DXMATRIX operator / (FLOAT f) const { D3DXMATRIX r(*this); r /= f; return r; }
+
+	bool operator == (const D3DXMATRIX& mat) const { return memcmp(this, &mat, sizeof(D3DMATRIX)) == 0; }
+	bool operator != (const D3DXMATRIX& mat) const { return !(*this == mat); }
+};
+
+typedef D3DXMATRIX* LPD3DXMATRIX;
+
+struct D3DXCOLOR
+{
+	D3DXCOLOR() {}
+	D3DXCOLOR(DWORD argb)
+		: r(((argb >> 16) & 0xff) / 255.0f), g(((argb >> 8) & 0xff) / 255.0f), b((argb & 0xff) / 255.0f), a(((argb >> 24) & 0xff) / 255.0f) {}
+	D3DXCOLOR(const FLOAT* pf) : r(pf[0]), g(pf[1]), b(pf[2]), a(pf[3]) {}
+	D3DXCOLOR(const D3DCOLORVALUE& c) : r(c.r), g(c.g), b(c.b), a(c.a) {}
+	D3DXCOLOR(FLOAT fr, FLOAT fg, FLOAT fb, FLOAT fa) : r(fr), g(fg), b(fb), a(fa) {}
+
+	operator DWORD () const
+	{
+		DWORD dwR = r >= 1.0f ? 0xff : r <= 0.0f ? 0x00 : (DWORD)(r * 255.0f + 0.5f);
+		DWORD dwG = g >= 1.0f ? 0xff : g <= 0.0f ? 0x00 : (DWORD)(g * 255.0f + 0.5f);
+		DWORD dwB = b >= 1.0f ? 0xff : b <= 0.0f ? 0x00 : (DWORD)(b * 255.0f + 0.5f);
+		DWORD dwA = a >= 1.0f ? 0xff : a <= 0.0f ? 0x00 : (DWORD)(a * 255.0f + 0.5f);
+		return (dwA << 24) | (dwR << 16) | (dwG << 8) | dwB;
+	}
+	operator FLOAT* () { return &r; }
+	operator const FLOAT* () const { return &r; }
+
+	bool operator == (const D3DXCOLOR& c) const { return r == c.r && g == c.g && b == c.b && a == c.a; }
+	bool operator != (const D3DXCOLOR& c) const { return !(*this == c); }
+
+	FLOAT r, g, b, a;
+};
+
+/*** Math functions ***/
+inline D3DXMATRIX* D3DXMatrixIdentity(D3DXMATRIX* pOut)
+{
+	memset(pOut, 0, sizeof(D3DMATRIX));
+	pOut->_11 = pOut->_22 = pOut->_33 = pOut->_44 = 1.0f;
+	return pOut;
+}
+
+inline BOOL D3DXMatrixIsIdentity(const D3DXMATRIX* pM)
+{
+	D3DXMATRIX identity;
+	D3DXMatrixIdentity(&identity);
+	return *pM == identity;
+}
+
+inline D3DXMATRIX* D3DXMatrixMultiply(D3DXMATRIX* pOut, const D3DXMATRIX* pM1, const D3DXMATRIX* pM2)
+{
+	D3DXMATRIX result;
+	for (int row = 0; row < 4; row++)
+		for (int col = 0; col < 4; col++)
+			result.m[row][col] = pM1->m[row][0] * pM2->m[0][col] + pM1->m[row][1] * pM2->m[1][col] +
+				pM1->m[row][2] * pM2->m[2][col] + pM1->m[row][3] * pM2->m[3][col];
+	*pOut = result;
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixTranspose(D3DXMATRIX* pOut, const D3DXMATRIX* pM)
+{
+	D3DXMATRIX result;
+	for (int row = 0; row < 4; row++)
+		for (int col = 0; col < 4; col++)
+			result.m[row][col] = pM->m[col][row];
+	*pOut = result;
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixInverse(D3DXMATRIX* pOut, FLOAT* pDeterminant, const D3DXMATRIX* pM)
+{
+	const FLOAT* m = &pM->_11;
+	FLOAT inv[16];
+	inv[0]  =  m[5]*m[10]*m[15] - m[5]*m[11]*m[14] - m[9]*m[6]*m[15] + m[9]*m[7]*m[14] + m[13]*m[6]*m[11] - m[13]*m[7]*m[10];
+	inv[4]  = -m[4]*m[10]*m[15] + m[4]*m[11]*m[14] + m[8]*m[6]*m[15] - m[8]*m[7]*m[14] - m[12]*m[6]*m[11] + m[12]*m[7]*m[10];
+	inv[8]  =  m[4]*m[9]*m[15]  - m[4]*m[11]*m[13] - m[8]*m[5]*m[15] + m[8]*m[7]*m[13] + m[12]*m[5]*m[11] - m[12]*m[7]*m[9];
+	inv[12] = -m[4]*m[9]*m[14]  + m[4]*m[10]*m[13] + m[8]*m[5]*m[14] - m[8]*m[6]*m[13] - m[12]*m[5]*m[10] + m[12]*m[6]*m[9];
+	inv[1]  = -m[1]*m[10]*m[15] + m[1]*m[11]*m[14] + m[9]*m[2]*m[15] - m[9]*m[3]*m[14] - m[13]*m[2]*m[11] + m[13]*m[3]*m[10];
+	inv[5]  =  m[0]*m[10]*m[15] - m[0]*m[11]*m[14] - m[8]*m[2]*m[15] + m[8]*m[3]*m[14] + m[12]*m[2]*m[11] - m[12]*m[3]*m[10];
+	inv[9]  = -m[0]*m[9]*m[15]  + m[0]*m[11]*m[13] + m[8]*m[1]*m[15] - m[8]*m[3]*m[13] - m[12]*m[1]*m[11] + m[12]*m[3]*m[9];
+	inv[13] =  m[0]*m[9]*m[14]  - m[0]*m[10]*m[13] - m[8]*m[1]*m[14] + m[8]*m[2]*m[13] + m[12]*m[1]*m[10] - m[12]*m[2]*m[9];
+	inv[2]  =  m[1]*m[6]*m[15]  - m[1]*m[7]*m[14]  - m[5]*m[2]*m[15] + m[5]*m[3]*m[14] + m[13]*m[2]*m[7]  - m[13]*m[3]*m[6];
+	inv[6]  = -m[0]*m[6]*m[15]  + m[0]*m[7]*m[14]  + m[4]*m[2]*m[15] - m[4]*m[3]*m[14] - m[12]*m[2]*m[7]  + m[12]*m[3]*m[6];
+	inv[10] =  m[0]*m[5]*m[15]  - m[0]*m[7]*m[13]  - m[4]*m[1]*m[15] + m[4]*m[3]*m[13] + m[12]*m[1]*m[7]  - m[12]*m[3]*m[5];
+	inv[14] = -m[0]*m[5]*m[14]  + m[0]*m[6]*m[13]  + m[4]*m[1]*m[14] - m[4]*m[2]*m[13] - m[12]*m[1]*m[6]  + m[12]*m[2]*m[5];
+	inv[3]  = -m[1]*m[6]*m[11]  + m[1]*m[7]*m[10]  + m[5]*m[2]*m[11] - m[5]*m[3]*m[10] - m[9]*m[2]*m[7]   + m[9]*m[3]*m[6];
+	inv[7]  =  m[0]*m[6]*m[11]  - m[0]*m[7]*m[10]  - m[4]*m[2]*m[11] + m[4]*m[3]*m[10] + m[8]*m[2]*m[7]   - m[8]*m[3]*m[6];
+	inv[11] = -m[0]*m[5]*m[11]  + m[0]*m[7]*m[9]   + m[4]*m[1]*m[11] - m[4]*m[3]*m[9]  - m[8]*m[1]*m[7]   + m[8]*m[3]*m[5];
+	inv[15] =  m[0]*m[5]*m[10]  - m[0]*m[6]*m[9]   - m[4]*m[1]*m[10] + m[4]*m[2]*m[9]  + m[8]*m[1]*m[6]   - m[8]*m[2]*m[5];
+
+	FLOAT determinant = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+	if (pDeterminant)
+		*pDeterminant = determinant;
+	if (determinant == 0.0f)
+		return NULL;
+	for (int i = 0; i < 16; i++)
+		(&pOut->_11)[i] = inv[i] / determinant;
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixScaling(D3DXMATRIX* pOut, FLOAT sx, FLOAT sy, FLOAT sz)
+{
+	D3DXMatrixIdentity(pOut);
+	pOut->_11 = sx; pOut->_22 = sy; pOut->_33 = sz;
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixTranslation(D3DXMATRIX* pOut, FLOAT x, FLOAT y, FLOAT z)
+{
+	D3DXMatrixIdentity(pOut);
+	pOut->_41 = x; pOut->_42 = y; pOut->_43 = z;
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixRotationX(D3DXMATRIX* pOut, FLOAT angle)
+{
+	D3DXMatrixIdentity(pOut);
+	pOut->_22 = cosf(angle); pOut->_23 = sinf(angle);
+	pOut->_32 = -sinf(angle); pOut->_33 = cosf(angle);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixRotationY(D3DXMATRIX* pOut, FLOAT angle)
+{
+	D3DXMatrixIdentity(pOut);
+	pOut->_11 = cosf(angle); pOut->_13 = -sinf(angle);
+	pOut->_31 = sinf(angle); pOut->_33 = cosf(angle);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixRotationZ(D3DXMATRIX* pOut, FLOAT angle)
+{
+	D3DXMatrixIdentity(pOut);
+	pOut->_11 = cosf(angle); pOut->_12 = sinf(angle);
+	pOut->_21 = -sinf(angle); pOut->_22 = cosf(angle);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixPerspectiveFovLH(D3DXMATRIX* pOut, FLOAT fovy, FLOAT aspect, FLOAT zn, FLOAT zf)
+{
+	FLOAT yScale = 1.0f / tanf(fovy / 2.0f);
+	memset(pOut, 0, sizeof(D3DMATRIX));
+	pOut->_11 = yScale / aspect;
+	pOut->_22 = yScale;
+	pOut->_33 = zf / (zf - zn);
+	pOut->_34 = 1.0f;
+	pOut->_43 = -zn * zf / (zf - zn);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixPerspectiveOffCenterLH(D3DXMATRIX* pOut, FLOAT l, FLOAT r, FLOAT b, FLOAT t, FLOAT zn, FLOAT zf)
+{
+	memset(pOut, 0, sizeof(D3DMATRIX));
+	pOut->_11 = 2.0f * zn / (r - l);
+	pOut->_22 = 2.0f * zn / (t - b);
+	pOut->_31 = (l + r) / (l - r);
+	pOut->_32 = (t + b) / (b - t);
+	pOut->_33 = zf / (zf - zn);
+	pOut->_34 = 1.0f;
+	pOut->_43 = zn * zf / (zn - zf);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixOrthoLH(D3DXMATRIX* pOut, FLOAT w, FLOAT h, FLOAT zn, FLOAT zf)
+{
+	D3DXMatrixIdentity(pOut);
+	pOut->_11 = 2.0f / w;
+	pOut->_22 = 2.0f / h;
+	pOut->_33 = 1.0f / (zf - zn);
+	pOut->_43 = zn / (zn - zf);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixOrthoOffCenterLH(D3DXMATRIX* pOut, FLOAT l, FLOAT r, FLOAT b, FLOAT t, FLOAT zn, FLOAT zf)
+{
+	D3DXMatrixIdentity(pOut);
+	pOut->_11 = 2.0f / (r - l);
+	pOut->_22 = 2.0f / (t - b);
+	pOut->_33 = 1.0f / (zf - zn);
+	pOut->_41 = (l + r) / (l - r);
+	pOut->_42 = (t + b) / (b - t);
+	pOut->_43 = zn / (zn - zf);
+	return pOut;
+}
+
+inline FLOAT D3DXVec3Dot(const D3DXVECTOR3* pV1, const D3DXVECTOR3* pV2)
+{
+	return pV1->x * pV2->x + pV1->y * pV2->y + pV1->z * pV2->z;
+}
+
+inline FLOAT D3DXVec3Length(const D3DXVECTOR3* pV)
+{
+	return sqrtf(D3DXVec3Dot(pV, pV));
+}
+
+inline D3DXVECTOR3* D3DXVec3Cross(D3DXVECTOR3* pOut, const D3DXVECTOR3* pV1, const D3DXVECTOR3* pV2)
+{
+	D3DXVECTOR3 result(pV1->y * pV2->z - pV1->z * pV2->y, pV1->z * pV2->x - pV1->x * pV2->z, pV1->x * pV2->y - pV1->y * pV2->x);
+	*pOut = result;
+	return pOut;
+}
+
+inline D3DXVECTOR3* D3DXVec3Normalize(D3DXVECTOR3* pOut, const D3DXVECTOR3* pV)
+{
+	FLOAT length = D3DXVec3Length(pV);
+	*pOut = (length > 0.0f) ? (*pV / length) : D3DXVECTOR3(0.0f, 0.0f, 0.0f);
+	return pOut;
+}
+
+inline D3DXVECTOR4* D3DXVec4Transform(D3DXVECTOR4* pOut, const D3DXVECTOR4* pV, const D3DXMATRIX* pM)
+{
+	D3DXVECTOR4 result(
+		pV->x * pM->_11 + pV->y * pM->_21 + pV->z * pM->_31 + pV->w * pM->_41,
+		pV->x * pM->_12 + pV->y * pM->_22 + pV->z * pM->_32 + pV->w * pM->_42,
+		pV->x * pM->_13 + pV->y * pM->_23 + pV->z * pM->_33 + pV->w * pM->_43,
+		pV->x * pM->_14 + pV->y * pM->_24 + pV->z * pM->_34 + pV->w * pM->_44);
+	*pOut = result;
+	return pOut;
+}
+
+inline D3DXVECTOR3* D3DXVec3TransformCoord(D3DXVECTOR3* pOut, const D3DXVECTOR3* pV, const D3DXMATRIX* pM)
+{
+	D3DXVECTOR4 v(*pV, 1.0f);
+	D3DXVec4Transform(&v, &v, pM);
+	*pOut = D3DXVECTOR3(v.x / v.w, v.y / v.w, v.z / v.w);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixLookAtLH(D3DXMATRIX* pOut, const D3DXVECTOR3* pEye, const D3DXVECTOR3* pAt, const D3DXVECTOR3* pUp)
+{
+	D3DXVECTOR3 zaxis = *pAt - *pEye;
+	D3DXVec3Normalize(&zaxis, &zaxis);
+	D3DXVECTOR3 xaxis;
+	D3DXVec3Cross(&xaxis, pUp, &zaxis);
+	D3DXVec3Normalize(&xaxis, &xaxis);
+	D3DXVECTOR3 yaxis;
+	D3DXVec3Cross(&yaxis, &zaxis, &xaxis);
+	*pOut = D3DXMATRIX(
+		xaxis.x, yaxis.x, zaxis.x, 0.0f,
+		xaxis.y, yaxis.y, zaxis.y, 0.0f,
+		xaxis.z, yaxis.z, zaxis.z, 0.0f,
+		-D3DXVec3Dot(&xaxis, pEye), -D3DXVec3Dot(&yaxis, pEye), -D3DXVec3Dot(&zaxis, pEye), 1.0f);
+	return pOut;
+}
+
+/*** Shader constant descriptions ***/
+typedef LPCSTR D3DXHANDLE;
+
+typedef enum _D3DXREGISTER_SET {
+	D3DXRS_BOOL,
+	D3DXRS_INT4,
+	D3DXRS_FLOAT4,
+	D3DXRS_SAMPLER,
+	D3DXRS_FORCE_DWORD = 0x7fffffff
+} D3DXREGISTER_SET;
+
+typedef enum _D3DXPARAMETER_CLASS {
+	D3DXPC_SCALAR,
+	D3DXPC_VECTOR,
+	D3DXPC_MATRIX_ROWS,
+	D3DXPC_MATRIX_COLUMNS,
+	D3DXPC_OBJECT,
+	D3DXPC_STRUCT,
+	D3DXPC_FORCE_DWORD = 0x7fffffff
+} D3DXPARAMETER_CLASS;
+
+typedef enum _D3DXPARAMETER_TYPE {
+	D3DXPT_VOID,
+	D3DXPT_BOOL,
+	D3DXPT_INT,
+	D3DXPT_FLOAT,
+	D3DXPT_STRING,
+	D3DXPT_TEXTURE,
+	D3DXPT_TEXTURE1D,
+	D3DXPT_TEXTURE2D,
+	D3DXPT_TEXTURE3D,
+	D3DXPT_TEXTURECUBE,
+	D3DXPT_SAMPLER,
+	D3DXPT_SAMPLER1D,
+	D3DXPT_SAMPLER2D,
+	D3DXPT_SAMPLER3D,
+	D3DXPT_SAMPLERCUBE,
+	D3DXPT_PIXELSHADER,
+	D3DXPT_VERTEXSHADER,
+	D3DXPT_PIXELFRAGMENT,
+	D3DXPT_VERTEXFRAGMENT,
+	D3DXPT_UNSUPPORTED,
+	D3DXPT_FORCE_DWORD = 0x7fffffff
+} D3DXPARAMETER_TYPE;
+
+/*** Fonts, sprites, effects ***/
+#define D3DXSPRITE_DONOTSAVESTATE   (1 << 0)
+#define D3DXSPRITE_DONOTMODIFY_RENDERSTATE (1 << 1)
+#define D3DXSPRITE_OBJECTSPACE      (1 << 2)
+#define D3DXSPRITE_BILLBOARD        (1 << 3)
+#define D3DXSPRITE_ALPHABLEND       (1 << 4)
+#define D3DXFX_DONOTSAVESTATE       (1 << 0)
+#define D3DXFX_DONOTSAVESHADERSTATE (1 << 1)
+#define D3DXFX_DONOTSAVESAMPLERSTATE (1 << 2)
+
+typedef enum _D3DXIMAGE_FILEFORMAT {
+	D3DXIFF_BMP = 0,
+	D3DXIFF_JPG = 1,
+	D3DXIFF_TGA = 2,
+	D3DXIFF_PNG = 3,
+	D3DXIFF_DDS = 4,
+	D3DXIFF_FORCE_DWORD = 0x7fffffff
+} D3DXIMAGE_FILEFORMAT;
+
+struct ID3DXSprite : public IUnknown
+{
+	virtual HRESULT WINAPI GetDevice(LPDIRECT3DDEVICE9* ppDevice) = 0;
+	virtual HRESULT WINAPI GetTransform(D3DXMATRIX* pTransform) = 0;
+	virtual HRESULT WINAPI SetTransform(CONST D3DXMATRIX* pTransform) = 0;
+	virtual HRESULT WINAPI Begin(DWORD Flags) = 0;
+	virtual HRESULT WINAPI Draw(LPDIRECT3DTEXTURE9 pTexture, CONST RECT* pSrcRect, CONST D3DXVECTOR3* pCenter, CONST D3DXVECTOR3* pPosition, D3DCOLOR Color) = 0;
+	virtual HRESULT WINAPI Flush() = 0;
+	virtual HRESULT WINAPI End() = 0;
+	virtual HRESULT WINAPI OnLostDevice() = 0;
+	virtual HRESULT WINAPI OnResetDevice() = 0;
+};
+typedef ID3DXSprite* LPD3DXSPRITE;
+
+struct ID3DXFont : public IUnknown
+{
+	virtual HRESULT WINAPI GetDevice(LPDIRECT3DDEVICE9* ppDevice) = 0;
+	virtual INT     WINAPI DrawTextA(LPD3DXSPRITE pSprite, LPCSTR pString, INT Count, LPRECT pRect, DWORD Format, D3DCOLOR Color) = 0;
+	virtual HRESULT WINAPI OnLostDevice() = 0;
+	virtual HRESULT WINAPI OnResetDevice() = 0;
+};
+typedef ID3DXFont* LPD3DXFONT;
+#define DrawText DrawTextA
+
+struct ID3DXEffect : public IUnknown
+{
+	virtual D3DXHANDLE WINAPI GetParameterByName(D3DXHANDLE hParameter, LPCSTR pName) = 0;
+	virtual HRESULT    WINAPI SetInt(D3DXHANDLE hParameter, INT n) = 0;
+	virtual HRESULT    WINAPI SetFloat(D3DXHANDLE hParameter, FLOAT f) = 0;
+	virtual HRESULT    WINAPI SetFloatArray(D3DXHANDLE hParameter, CONST FLOAT* pf, UINT Count) = 0;
+	virtual HRESULT    WINAPI SetMatrix(D3DXHANDLE hParameter, CONST D3DXMATRIX* pMatrix) = 0;
+	virtual HRESULT    WINAPI SetTexture(D3DXHANDLE hParameter, LPDIRECT3DBASETEXTURE9 pTexture) = 0;
+	virtual HRESULT    WINAPI SetTechnique(D3DXHANDLE hTechnique) = 0;
+	virtual HRESULT    WINAPI Begin(UINT* pPasses, DWORD Flags) = 0;
+	virtual HRESULT    WINAPI BeginPass(UINT Pass) = 0;
+	virtual HRESULT    WINAPI CommitChanges() = 0;
+	virtual HRESULT    WINAPI EndPass() = 0;
+	virtual HRESULT    WINAPI End() = 0;
+	virtual HRESULT    WINAPI OnLostDevice() = 0;
+	virtual HRESULT    WINAPI OnResetDevice() = 0;
+};
+typedef ID3DXEffect* LPD3DXEFFECT;
+
+struct ID3DXBuffer : public IUnknown
+{
+	virtual LPVOID WINAPI GetBufferPointer() = 0;
+	virtual DWORD  WINAPI GetBufferSize() = 0;
+};
+typedef ID3DXBuffer* LPD3DXBUFFER;
+
+struct ID3DXEffectPool;
+struct ID3DXInclude;
+typedef ID3DXEffectPool* LPD3DXEFFECTPOOL;
+typedef ID3DXInclude* LPD3DXINCLUDE;
+
+typedef struct _D3DXMACRO {
+	LPCSTR Name;
+	LPCSTR Definition;
+} D3DXMACRO;
+
+typedef struct _D3DXCONSTANTTABLE_DESC {
+	LPCSTR Creator;
+	DWORD  Version;
+	UINT   Constants;
+} D3DXCONSTANTTABLE_DESC;
+
+struct ID3DXConstantTable : public IUnknown
+{
+	virtual HRESULT WINAPI GetDesc(D3DXCONSTANTTABLE_DESC* pDesc) = 0;
+};
+typedef ID3DXConstantTable* LPD3DXCONSTANTTABLE;
+
+HRESULT WINAPI D3DXCreateSprite(LPDIRECT3DDEVICE9 pDevice, LPD3DXSPRITE* ppSprite);
+HRESULT WINAPI D3DXCreateFont(LPDIRECT3DDEVICE9 pDevice, INT Height, UINT Width, UINT Weight, UINT MipLevels, BOOL Italic,
+                              DWORD CharSet, DWORD OutputPrecision, DWORD Quality, DWORD PitchAndFamily, LPCSTR pFaceName,
+                              LPD3DXFONT* ppFont);
+HRESULT WINAPI D3DXCreateEffectFromFile(LPDIRECT3DDEVICE9 pDevice, LPCSTR pSrcFile, CONST D3DXMACRO* pDefines,
+                                        LPD3DXINCLUDE pInclude, DWORD Flags, LPD3DXEFFECTPOOL pPool,
+                                        LPD3DXEFFECT* ppEffect, LPD3DXBUFFER* ppCompilationErrors);
+HRESULT WINAPI D3DXSaveSurfaceToFile(LPCSTR pDestFile, D3DXIMAGE_FILEFORMAT DestFormat, LPDIRECT3DSURFACE9 pSrcSurface,
+                                     CONST PALETTEENTRY* pSrcPalette, CONST RECT* pSrcRect);
+
+#endif
@@ -0,0 +1,584 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <windows.h> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef SHIM_WINDOWS_H_INCLUDED
+#define SHIM_WINDOWS_H_INCLUDED
+
+/**
+* Win32 subset the proxy uses, for the headless test build on other platforms.
+* Types have their Windows sizes (DWORD and LONG are 32 bit), threads, locks and condition variables map to the C++11
+* library, files and mappings to POSIX, the registry is an in-memory table (ShimSetRegistryString()) and
+* GetAsyncKeyState() never reports a pressed key.
+***/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include <type_traits>
+
+#define WINAPI
+#define CALLBACK
+#define APIENTRY
+#define STDMETHODCALLTYPE
+#define __stdcall
+#define __cdecl
+#define __declspec(x)
+#define __forceinline inline __attribute__((always_inline))
+#define CONST const
+#define VOID void
+#define TRUE 1
+#define FALSE 0
+#define MAX_PATH 260
+#define INFINITE 0xFFFFFFFF
+#define TEXT(x) x
+#define _T(x) x
+
+typedef int                BOOL;
+typedef unsigned char      BYTE;
+typedef unsigned char      byte;
+typedef unsigned short     WORD;
+typedef unsigned int       DWORD;
+typedef int                LONG;
+typedef unsigned int       ULONG;
+typedef int                INT;
+typedef unsigned int       UINT;
+typedef float              FLOAT;
+typedef char               CHAR;
+typedef char               TCHAR;
+typedef short              SHORT;
+typedef long long          LONGLONG;
+typedef unsigned long long ULONGLONG;
+typedef unsigned long long UINT64;
+typedef long long          INT64;
+typedef unsigned int       UINT32;
+typedef int                INT32;
+typedef uintptr_t          UINT_PTR;
+typedef intptr_t           INT_PTR;
+typedef uintptr_t          ULONG_PTR;
+typedef intptr_t           LONG_PTR;
+typedef ULONG_PTR          DWORD_PTR;
+typedef size_t             SIZE_T;
+typedef int32_t            HRESULT;
+typedef LONG               LSTATUS;
+typedef BYTE*              LPBYTE;
+typedef BYTE*              PBYTE;
+typedef DWORD*             LPDWORD;
+typedef DWORD*             PDWORD;
+typedef LONG*              PLONG;
+typedef BOOL*              LPBOOL;
+typedef void*              LPVOID;
+typedef void*              PVOID;
+typedef const void*        LPCVOID;
+typedef char*              LPSTR;
+typedef const char*        LPCSTR;
+typedef char*              LPTSTR;
+typedef const char*        LPCTSTR;
+typedef wchar_t            WCHAR;
+typedef wchar_t*           LPWSTR;
+typedef const wchar_t*     LPCWSTR;
+
+typedef void*                   HANDLE;
+typedef struct HWND__*          HWND;
+typedef struct HDC__*           HDC;
+typedef struct HMONITOR__*      HMONITOR;
+typedef struct HKEY__*          HKEY;
+typedef struct HINSTANCE__*     HINSTANCE;
+typedef HINSTANCE               HMODULE;
+typedef struct HFONT__*         HFONT;
+typedef HKEY*                   PHKEY;
+typedef DWORD                   REGSAM;
+typedef DWORD                   COLORREF;
+
+#define INVALID_HANDLE_VALUE ((HANDLE)(LONG_PTR)-1)
+#define HKEY_CURRENT_USER    ((HKEY)(ULONG_PTR)0x80000001)
+#define HKEY_LOCAL_MACHINE   ((HKEY)(ULONG_PTR)0x80000002)
+
+#define LOWORD(l)        ((WORD)(((DWORD_PTR)(l)) & 0xffff))
+#define HIWORD(l)        ((WORD)((((DWORD_PTR)(l)) >> 16) & 0xffff))
+#define LOBYTE(w)        ((BYTE)(((DWORD_PTR)(w)) & 0xff))
+#define HIBYTE(w)        ((BYTE)((((DWORD_PTR)(w)) >> 8) & 0xff))
+#define MAKEWORD(a, b)   ((WORD)(((BYTE)(((DWORD_PTR)(a)) & 0xff)) | ((WORD)((BYTE)(((DWORD_PTR)(b)) & 0xff))) << 8))
+#define MAKELONG(a, b)   ((LONG)(((WORD)(((DWORD_PTR)(a)) & 0xffff)) | ((DWORD)((WORD)(((DWORD_PTR)(b)) & 0xffff))) << 16))
+#define RGB(r,g,b)       ((COLORREF)(((BYTE)(r)|((WORD)((BYTE)(g))<<8))|(((DWORD)(BYTE)(b))<<16)))
+
+#define ZeroMemory(dest, length)       memset((dest), 0, (length))
+#define CopyMemory(dest, src, length)  memcpy((dest), (src), (length))
+#define FillMemory(dest, length, fill) memset((dest), (fill), (length))
+#define _countof(a)                    (sizeof(a) / sizeof((a)[0]))
+#define UNREFERENCED_PARAMETER(p)      (void)(p)
+
+/**
+* windows.h min and max, as functions of the common type so that they neither break the C++ library headers
+* nor need equal argument types.
+***/
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type min(A a, B b) { return (a < b) ? a : b; }
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type max(A a, B b) { return (a > b) ? a : b; }
+
+/*** HRESULT ***/
+#define _HRESULT_TYPEDEF_(x)   ((HRESULT)(x))
+#define SUCCEEDED(hr)          (((HRESULT)(hr)) >= 0)
+#define FAILED(hr)             (((HRESULT)(hr)) < 0)
+#define MAKE_HRESULT(s, f, c)  ((HRESULT)(((unsigned int)(s) << 31) | ((unsigned int)(f) << 16) | ((unsigned int)(c))))
+#define HRESULT_FROM_WIN32(x)  ((HRESULT)(x) <= 0 ? ((HRESULT)(x)) : ((HRESULT)(((x) & 0x0000FFFF) | (7 << 16) | 0x80000000)))
+#define S_OK                   ((HRESULT)0)
+#define S_FALSE                ((HRESULT)1)
+#define NOERROR                0
+#define E_NOTIMPL              _HRESULT_TYPEDEF_(0x80004001)
+#define E_NOINTERFACE          _HRESULT_TYPEDEF_(0x80004002)
+#define E_POINTER              _HRESULT_TYPEDEF_(0x80004003)
+#define E_FAIL                 _HRESULT_TYPEDEF_(0x80004005)
+#define E_OUTOFMEMORY          _HRESULT_TYPEDEF_(0x8007000E)
+#define E_INVALIDARG           _HRESULT_TYPEDEF_(0x80070057)
+#define DISP_E_TYPEMISMATCH    _HRESULT_TYPEDEF_(0x80020005)
+#define ERROR_SUCCESS          0L
+#define ERROR_FILE_NOT_FOUND   2L
+#define ERROR_MORE_DATA        234L
+
+/*** Structures ***/
+typedef union _LARGE_INTEGER {
+	struct {
+		DWORD LowPart;
+		LONG  HighPart;
+	};
+	struct {
+		DWORD LowPart;
+		LONG  HighPart;
+	} u;
+	LONGLONG QuadPart;
+} LARGE_INTEGER, *PLARGE_INTEGER;
+
+typedef struct tagRECT {
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+} RECT, *PRECT, *LPRECT;
+typedef const RECT* LPCRECT;
+
+typedef struct tagPOINT {
+	LONG x;
+	LONG y;
+} POINT, *PPOINT, *LPPOINT;
+
+typedef struct tagSIZE {
+	LONG cx;
+	LONG cy;
+} SIZE, *PSIZE, *LPSIZE;
+
+typedef struct _RGNDATAHEADER {
+	DWORD dwSize;
+	DWORD iType;
+	DWORD nCount;
+	DWORD nRgnSize;
+	RECT  rcBound;
+} RGNDATAHEADER;
+
+typedef struct _RGNDATA {
+	RGNDATAHEADER rdh;
+	char          Buffer[1];
+} RGNDATA, *PRGNDATA, *LPRGNDATA;
+
+typedef struct tagPALETTEENTRY {
+	BYTE peRed;
+	BYTE peGreen;
+	BYTE peBlue;
+	BYTE peFlags;
+} PALETTEENTRY, *PPALETTEENTRY, *LPPALETTEENTRY;
+
+typedef struct _GUID {
+	DWORD Data1;
+	WORD  Data2;
+	WORD  Data3;
+	BYTE  Data4[8];
+} GUID, IID, CLSID;
+typedef const GUID& REFGUID;
+typedef const IID&  REFIID;
+typedef const CLSID& REFCLSID;
+
+inline bool operator==(REFGUID a, REFGUID b) { return memcmp(&a, &b, sizeof(GUID)) == 0; }
+inline bool operator!=(REFGUID a, REFGUID b) { return !(a == b); }
+#define IsEqualGUID(a, b) ((a) == (b))
+#define IsEqualIID(a, b)  ((a) == (b))
+
+#define DEFINE_GUID(name, l, w1, w2, b1, b2, b3, b4, b5, b6, b7, b8) \
+	static const GUID name = { l, w1, w2, { b1, b2, b3, b4, b5, b6, b7, b8 } }
+
+typedef struct _SECURITY_ATTRIBUTES {
+	DWORD  nLength;
+	LPVOID lpSecurityDescriptor;
+	BOOL   bInheritHandle;
+} SECURITY_ATTRIBUTES, *LPSECURITY_ATTRIBUTES;
+
+typedef struct _SYSTEM_INFO {
+	WORD      wProcessorArchitecture;
+	WORD      wReserved;
+	DWORD     dwPageSize;
+	LPVOID    lpMinimumApplicationAddress;
+	LPVOID    lpMaximumApplicationAddress;
+	DWORD_PTR dwActiveProcessorMask;
+	DWORD     dwNumberOfProcessors;
+	DWORD     dwProcessorType;
+	DWORD     dwAllocationGranularity;
+	WORD      wProcessorLevel;
+	WORD      wProcessorRevision;
+} SYSTEM_INFO, *LPSYSTEM_INFO;
+
+/*** Debugging ***/
+void OutputDebugStringA(LPCSTR lpOutputString);
+#define OutputDebugString OutputDebugStringA
+inline void DebugBreak() { __builtin_trap(); }
+
+/*** Synchronization ***/
+typedef struct _CRITICAL_SECTION {
+	void* pMutex;
+} CRITICAL_SECTION, *LPCRITICAL_SECTION;
+
+typedef struct _CONDITION_VARIABLE {
+	void* pCondition;
+} CONDITION_VARIABLE, *PCONDITION_VARIABLE;
+
+void  InitializeCriticalSection(LPCRITICAL_SECTION lpCriticalSection);
+BOOL  InitializeCriticalSectionAndSpinCount(LPCRITICAL_SECTION lpCriticalSection, DWORD dwSpinCount);
+void  DeleteCriticalSection(LPCRITICAL_SECTION lpCriticalSection);
+void  EnterCriticalSection(LPCRITICAL_SECTION lpCriticalSection);
+void  LeaveCriticalSection(LPCRITICAL_SECTION lpCriticalSection);
+void  InitializeConditionVariable(PCONDITION_VARIABLE ConditionVariable);
+BOOL  SleepConditionVariableCS(PCONDITION_VARIABLE ConditionVariable, LPCRITICAL_SECTION CriticalSection, DWORD dwMilliseconds);
+void  WakeConditionVariable(PCONDITION_VARIABLE ConditionVariable);
+void  WakeAllConditionVariable(PCONDITION_VARIABLE ConditionVariable);
+void  Sleep(DWORD dwMilliseconds);
+
+#define MemoryBarrier() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+template <typename T> inline T InterlockedIncrement(T volatile* p) { return __atomic_add_fetch(p, 1, __ATOMIC_SEQ_CST); }
+template <typename T> inline T InterlockedDecrement(T volatile* p) { return __atomic_sub_fetch(p, 1, __ATOMIC_SEQ_CST); }
+template <typename T, typename V> inline T InterlockedExchange(T volatile* p, V value) { return __atomic_exchange_n(p, (T)value, __ATOMIC_SEQ_CST); }
+template <typename T, typename V> inline T InterlockedExchangeAdd(T volatile* p, V value) { return __atomic_fetch_add(p, (T)value, __ATOMIC_SEQ_CST); }
+template <typename T, typename V, typename C> inline T InterlockedCompareExchange(T volatile* p, V exchange, C comparand)
+{
+	T expected = (T)comparand;
+	__atomic_compare_exchange_n(p, &expected, (T)exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return expected;
+}
+
+/*** Threads and processes ***/
+typedef DWORD (WINAPI *PTHREAD_START_ROUTINE)(LPVOID lpThreadParameter);
+typedef PTHREAD_START_ROUTINE LPTHREAD_START_ROUTINE;
+#define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#define WAIT_OBJECT_0      0x00000000L
+#define WAIT_FAILED        ((DWORD)0xFFFFFFFF)
+
+HANDLE CreateThread(LPSECURITY_ATTRIBUTES lpThreadAttributes, SIZE_T dwStackSize, LPTHREAD_START_ROUTINE lpStartAddress,
+                    LPVOID lpParameter, DWORD dwCreationFlags, LPDWORD lpThreadId);
+DWORD  WaitForSingleObject(HANDLE hHandle, DWORD dwMilliseconds);
+BOOL   CloseHandle(HANDLE hObject);
+DWORD  GetCurrentThreadId();
+DWORD  GetCurrentProcessId();
+DWORD  TlsAlloc();
+BOOL   TlsFree(DWORD dwTlsIndex);
+LPVOID TlsGetValue(DWORD dwTlsIndex);
+BOOL   TlsSetValue(DWORD dwTlsIndex, LPVOID lpTlsValue);
+void   GetSystemInfo(LPSYSTEM_INFO lpSystemInfo);
+BOOL   QueryPerformanceCounter(LARGE_INTEGER* lpPerformanceCount);
+BOOL   QueryPerformanceFrequency(LARGE_INTEGER* lpFrequency);
+DWORD  GetTickCount();
+
+/*** Memory ***/
+#define MEM_COMMIT     0x00001000
+#define MEM_RESERVE    0x00002000
+#define MEM_DECOMMIT   0x00004000
+#define MEM_RELEASE    0x00008000
+#define PAGE_READONLY  0x02
+#define PAGE_READWRITE 0x04
+
+LPVOID VirtualAlloc(LPVOID lpAddress, SIZE_T dwSize, DWORD flAllocationType, DWORD flProtect);
+BOOL   VirtualFree(LPVOID lpAddress, SIZE_T dwSize, DWORD dwFreeType);
+
+/*** Files and file mappings ***/
+#define GENERIC_READ           0x80000000
+#define GENERIC_WRITE          0x40000000
+#define FILE_SHARE_READ        0x00000001
+#define FILE_SHARE_WRITE       0x00000002
+#define CREATE_NEW             1
+#define CREATE_ALWAYS          2
+#define OPEN_EXISTING          3
+#define OPEN_ALWAYS            4
+#define TRUNCATE_EXISTING      5
+#define FILE_ATTRIBUTE_NORMAL  0x00000080
+#define FILE_BEGIN             0
+#define FILE_CURRENT           1
+#define FILE_END               2
+#define FILE_MAP_READ          0x0004
+#define FILE_MAP_WRITE         0x0002
+#define FILE_MAP_ALL_ACCESS    0x000F001F
+
+HANDLE CreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode, LPSECURITY_ATTRIBUTES lpSecurityAttributes,
+                   DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes, HANDLE hTemplateFile);
+#define CreateFile CreateFileA
+BOOL   ReadFile(HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead, LPDWORD lpNumberOfBytesRead, void* lpOverlapped);
+BOOL   WriteFile(HANDLE hFile, LPCVOID lpBuffer, DWORD nNumberOfBytesToWrite, LPDWORD lpNumberOfBytesWritten, void* lpOverlapped);
+BOOL   GetFileSizeEx(HANDLE hFile, PLARGE_INTEGER lpFileSize);
+BOOL   SetFilePointerEx(HANDLE hFile, LARGE_INTEGER liDistanceToMove, PLARGE_INTEGER lpNewFilePointer, DWORD dwMoveMethod);
+BOOL   SetEndOfFile(HANDLE hFile);
+BOOL   FlushFileBuffers(HANDLE hFile);
+HANDLE CreateFileMappingA(HANDLE hFile, LPSECURITY_ATTRIBUTES lpAttributes, DWORD flProtect, DWORD dwMaximumSizeHigh,
+                          DWORD dwMaximumSizeLow, LPCSTR lpName);
+#define CreateFileMapping CreateFileMappingA
+LPVOID MapViewOfFile(HANDLE hFileMappingObject, DWORD dwDesiredAccess, DWORD dwFileOffsetHigh, DWORD dwFileOffsetLow,
+                     SIZE_T dwNumberOfBytesToMap);
+BOOL   UnmapViewOfFile(LPCVOID lpBaseAddress);
+
+/*** Registry ***/
+#define KEY_QUERY_VALUE 0x0001
+#define KEY_SET_VALUE   0x0002
+#define KEY_READ        0x20019
+#define REG_NONE        0
+#define REG_SZ          1
+#define REG_DWORD       4
+
+LONG RegOpenKeyExA(HKEY hKey, LPCSTR lpSubKey, DWORD ulOptions, REGSAM samDesired, PHKEY phkResult);
+#define RegOpenKeyEx RegOpenKeyExA
+LONG RegQueryValueExA(HKEY hKey, LPCSTR lpValueName, LPDWORD lpReserved, LPDWORD lpType, LPBYTE lpData, LPDWORD lpcbData);
+#define RegQueryValueEx RegQueryValueExA
+LONG RegCloseKey(HKEY hKey);
+
+/**
+* Sets a string value of the in-memory registry, the shim has no other way to add values.
+* Key names are not distinguished, the proxy only reads its own key.
+***/
+void ShimSetRegistryString(LPCSTR lpValueName, LPCSTR lpValue);
+
+/*** Input ***/
+#define VK_BACK      0x08
+#define VK_TAB       0x09
+#define VK_RETURN    0x0D
+#define VK_SHIFT     0x10
+#define VK_CONTROL   0x11
+#define VK_MENU      0x12
+#define VK_PAUSE     0x13
+#define VK_ESCAPE    0x1B
+#define VK_SPACE     0x20
+#define VK_PRIOR     0x21
+#define VK_NEXT      0x22
+#define VK_END       0x23
+#define VK_HOME      0x24
+#define VK_LEFT      0x25
+#define VK_UP        0x26
+#define VK_RIGHT     0x27
+#define VK_DOWN      0x28
+#define VK_INSERT    0x2D
+#define VK_DELETE    0x2E
+#define VK_NUMPAD0   0x60
+#define VK_MULTIPLY  0x6A
+#define VK_ADD       0x6B
+#define VK_SUBTRACT  0x6D
+#define VK_DIVIDE    0x6F
+#define VK_F1        0x70
+#define VK_F2        0x71
+#define VK_F3        0x72
+#define VK_F4        0x73
+#define VK_F5        0x74
+#define VK_F6        0x75
+#define VK_F7        0x76
+#define VK_F8        0x77
+#define VK_F9        0x78
+#define VK_F10       0x79
+#define VK_F11       0x7A
+#define VK_F12       0x7B
+#define VK_LSHIFT    0xA0
+#define VK_RSHIFT    0xA1
+#define VK_LCONTROL  0xA2
+#define VK_RCONTROL  0xA3
+
+#define INPUT_MOUSE         0
+#define INPUT_KEYBOARD      1
+#define MOUSEEVENTF_MOVE    0x0001
+#define MOUSEEVENTF_ABSOLUTE 0x8000
+
+typedef struct tagMOUSEINPUT {
+	LONG      dx;
+	LONG      dy;
+	DWORD     mouseData;
+	DWORD     dwFlags;
+	DWORD     time;
+	ULONG_PTR dwExtraInfo;
+} MOUSEINPUT;
+
+typedef struct tagKEYBDINPUT {
+	WORD      wVk;
+	WORD      wScan;
+	DWORD     dwFlags;
+	DWORD     time;
+	ULONG_PTR dwExtraInfo;
+} KEYBDINPUT;
+
+typedef struct tagINPUT {
+	DWORD type;
+	union {
+		MOUSEINPUT mi;
+		KEYBDINPUT ki;
+	};
+} INPUT, *LPINPUT;
+
+SHORT GetAsyncKeyState(int vKey);
+UINT  SendInput(UINT cInputs, LPINPUT pInputs, int cbSize);
+
+/*** GDI ***/
+#define FW_NORMAL           400
+#define FW_BOLD             700
+#define DEFAULT_CHARSET     1
+#define OUT_DEFAULT_PRECIS  0
+#define OUT_TT_ONLY_PRECIS  7
+#define CLIP_DEFAULT_PRECIS 0
+#define DEFAULT_QUALITY     0
+#define ANTIALIASED_QUALITY 4
+#define DEFAULT_PITCH       0
+#define FF_DONTCARE         (0<<4)
+#define DT_TOP              0x00000000
+#define DT_LEFT             0x00000000
+#define DT_CENTER           0x00000001
+#define DT_RIGHT            0x00000002
+#define DT_VCENTER          0x00000004
+#define DT_BOTTOM           0x00000008
+#define DT_WORDBREAK        0x00000010
+#define DT_SINGLELINE       0x00000020
+#define DT_NOCLIP           0x00000100
+#define DT_CALCRECT         0x00000400
+
+BOOL SetRect(LPRECT lprc, int xLeft, int yTop, int xRight, int yBottom);
+BOOL SetRectEmpty(LPRECT lprc);
+BOOL CopyRect(LPRECT lprcDst, const RECT* lprcSrc);
+BOOL OffsetRect(LPRECT lprc, int dx, int dy);
+BOOL InflateRect(LPRECT lprc, int dx, int dy);
+BOOL IntersectRect(LPRECT lprcDst, const RECT* lprcSrc1, const RECT* lprcSrc2);
+BOOL IsRectEmpty(const RECT* lprc);
+
+/*** Secure CRT ***/
+typedef int errno_t;
+
+inline int vsprintf_s(char* buffer, size_t sizeOfBuffer, const char* format, va_list args)
+{
+	return vsnprintf(buffer, sizeOfBuffer, format, args);
+}
+inline int sprintf_s(char* buffer, size_t sizeOfBuffer, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int result = vsnprintf(buffer, sizeOfBuffer, format, args);
+	va_end(args);
+	return result;
+}
+template <size_t N>
+inline int sprintf_s(char (&buffer)[N], const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int result = vsnprintf(buffer, N, format, args);
+	va_end(args);
+	return result;
+}
+#define _snprintf snprintf
+#define wsprintf sprintf
+#define wsprintfA sprintf
+#define _vsnprintf vsnprintf
+#define _stricmp strcasecmp
+#define _strnicmp strncasecmp
+
+inline errno_t strcpy_s(char* dest, size_t size, const char* src)
+{
+	if (!dest || !src || size == 0) return 22;
+	size_t length = strlen(src);
+	if (length >= size) { dest[0] = 0; return 34; }
+	memcpy(dest, src, length + 1);
+	return 0;
+}
+template <size_t N>
+inline errno_t strcpy_s(char (&dest)[N], const char* src) { return strcpy_s(dest, N, src); }
+inline errno_t strcat_s(char* dest, size_t size, const char* src)
+{
+	if (!dest || !src) return 22;
+	size_t length = strnlen(dest, size);
+	if (length == size) return 22;
+	return strcpy_s(dest + length, size - length, src);
+}
+template <size_t N>
+inline errno_t strcat_s(char (&dest)[N], const char* src) { return strcat_s(dest, N, src); }
+/**
+* Unlike the CRT an unset variable gives an empty string, the proxy streams the result unchecked.
+***/
+inline errno_t _dupenv_s(char** pBuffer, size_t* pLength, const char* name)
+{
+	const char* value = getenv(name);
+	*pBuffer = strdup(value ? value : "");
+	if (pLength) *pLength = strlen(*pBuffer) + 1;
+	return 0;
+}
+inline errno_t fopen_s(FILE** ppFile, const char* filename, const char* mode)
+{
+	*ppFile = fopen(filename, mode);
+	return *ppFile ? 0 : 2;
+}
+
+/*** Intrinsics ***/
+inline unsigned int _rotl(unsigned int value, int shift) { return (value << (shift & 31)) | (value >> ((32 - shift) & 31)); }
+inline unsigned long long _rotl64(unsigned long long value, int shift) { return (value << (shift & 63)) | (value >> ((64 - shift) & 63)); }
+inline unsigned char _BitScanForward(DWORD* index, DWORD mask)
+{
+	if (!mask) return 0;
+	*index = (DWORD)__builtin_ctz(mask);
+	return 1;
+}
+inline unsigned char _BitScanReverse(DWORD* index, DWORD mask)
+{
+	if (!mask) return 0;
+	*index = 31 - (DWORD)__builtin_clz(mask);
+	return 1;
+}
+inline unsigned char _BitScanForward(unsigned long* index, unsigned long mask)
+{
+	if (!mask) return 0;
+	*index = (unsigned long)__builtin_ctzl(mask);
+	return 1;
+}
+inline unsigned char _BitScanReverse(unsigned long* index, unsigned long mask)
+{
+	if (!mask) return 0;
+	*index = (unsigned long)(sizeof(unsigned long) * 8 - 1 - __builtin_clzl(mask));
+	return 1;
+}
+#define YieldProcessor() __builtin_ia32_pause()
+inline unsigned int __popcnt(unsigned int value) { return (unsigned int)__builtin_popcount(value); }
+
+#endif
@@ -0,0 +1,166 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <StereoConstantTest.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "ProxyHarness.h"
+#include "ShaderBlob.h"
+#include "ShaderBytecode.h"
+#include "TestCheck.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+/**
+* Tests of the stereo constants on the headless proxy : the data the actual device receives when the
+* game writes a stereo constant and when the view adjustment changes without the game writing new values.
+***/
+
+typedef ShaderBlob B;
+
+static const uint16_t TYPE_FLOAT = 3;
+static const char* RULES_PATH = "StereoConstantTest.xml";
+
+/**
+* Shader rules translating the world view projection matrix in c0-c3 (simple translate).
+***/
+static const char* RULES =
+	"<?xml version=\"1.0\"?>\n"
+	"<shaderConfig>\n"
+	"  <rules>\n"
+	"    <rule id=\"1\" constantType=\"MatrixC\" modToApply=\"1\" startReg=\"0\"/>\n"
+	"  </rules>\n"
+	"  <defaultRuleIDs>\n"
+	"    <ruleID id=\"1\" />\n"
+	"  </defaultRuleIDs>\n"
+	"</shaderConfig>\n";
+
+/**
+* vs_2_0 transforming the position by the world view projection matrix in c0-c3.
+***/
+static ShaderBlob VertexShader()
+{
+	ShaderBlob blob(B::VS(2, 0));
+	blob.ConstantTable("StereoConstantTest", "vs_2_0", {
+		{"WorldViewProj", ShaderBytecode::RegisterSet_Float4, 0, 4, ShaderBytecode::Class_MatrixColumns, TYPE_FLOAT, 4, 4, 1, {}}});
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Input, 0)});
+	for (uint32_t i = 0; i < 4; i++)
+		blob.Instruction(B::Op_Dp4, {B::Dst(B::Reg_RastOut, 0, 1 << i), B::Src(B::Reg_Input, 0), B::Src(B::Reg_Const, i)});
+	blob.End();
+	return blob;
+}
+
+/**
+* c0-c3 of the actual device after the two draws of a frame. A stereo draw ends on the other eye,
+* so these are the matrices of both eyes, in an order that depends on the eye the frame starts with.
+***/
+struct EyeMatrices
+{
+	D3DXMATRIX first;
+	D3DXMATRIX second;
+
+	bool operator==(const EyeMatrices& other) const
+	{
+		return ((first == other.first) && (second == other.second)) || ((first == other.second) && (second == other.first));
+	}
+	bool operator!=(const EyeMatrices& other) const { return !(*this == other); }
+};
+
+/**
+* Draws one frame with the given roll, the game writes the same matrix before both draws.
+***/
+static EyeMatrices DrawFrame(ProxyHarness& harness, IDirect3DVertexShader9* pShader, const D3DXMATRIX& worldViewProj, float roll)
+{
+	IDirect3DDevice9* pProxy = harness.m_pProxy;
+	EyeMatrices eyes;
+
+	ProxyHarness::s_roll = roll;
+	pProxy->BeginScene();
+	pProxy->SetVertexShader(pShader);
+	pProxy->SetVertexShaderConstantF(0, (const float*)worldViewProj, 4);
+	pProxy->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 100, 0, 50);
+	eyes.first = D3DXMATRIX(harness.m_pDevice->VertexShaderConstantsF());
+	pProxy->SetVertexShaderConstantF(0, (const float*)worldViewProj, 4);
+	pProxy->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 100, 0, 50);
+	eyes.second = D3DXMATRIX(harness.m_pDevice->VertexShaderConstantsF());
+	pProxy->EndScene();
+	pProxy->Present(NULL, NULL, NULL, NULL);
+	return eyes;
+}
+
+/**
+* The game writes the same matrix every frame while the head rolls. The write changes no register,
+* the stereo constant has to be recomputed for the new roll anyway.
+***/
+static void TestRollWithUnchangedMatrix()
+{
+	FILE* pFile = fopen(RULES_PATH, "w");
+	CHECK(pFile != NULL);
+	if (!pFile)
+		return;
+	fputs(RULES, pFile);
+	fclose(pFile);
+
+	ProxyHelper::ProxyConfig config = ProxyHarness::DefaultConfig();
+	config.shaderRulePath = RULES_PATH;
+	config.rollEnabled = true;
+
+	{
+		ProxyHarness harness(config);
+		IDirect3DDevice9* pProxy = harness.m_pProxy;
+
+		ShaderBlob blob = VertexShader();
+		IDirect3DVertexShader9* pShader = NULL;
+		CHECK(SUCCEEDED(pProxy->CreateVertexShader((const DWORD*)blob.Data(), &pShader)));
+
+		D3DXMATRIX worldViewProj;
+		D3DXMatrixPerspectiveFovLH(&worldViewProj, (float)D3DX_PI / 3.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+
+		EyeMatrices level = DrawFrame(harness, pShader, worldViewProj, 0.0f);
+		EyeMatrices levelAgain = DrawFrame(harness, pShader, worldViewProj, 0.0f);
+		EyeMatrices rolled = DrawFrame(harness, pShader, worldViewProj, 0.3f);
+		EyeMatrices levelBack = DrawFrame(harness, pShader, worldViewProj, 0.0f);
+
+		// the stereo constant is modified, the roll changes it, and it follows the roll back
+		CHECK(level.first != level.second);
+		CHECK(level.first != worldViewProj);
+		CHECK(levelAgain == level);
+		CHECK(rolled != level);
+		CHECK(levelBack == level);
+
+		pShader->Release();
+	}
+
+	ProxyHarness::s_roll = 0.0f;
+	remove(RULES_PATH);
+	remove((std::string(RULES_PATH) + ".cache").c_str());
+}
+
+int main()
+{
+	TestRollWithUnchangedMatrix();
+	return TestResult("StereoConstantTest");
+}
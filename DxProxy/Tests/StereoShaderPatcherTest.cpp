@@ -0,0 +1,603 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <StereoShaderPatcherTest.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "StereoShaderPatcher.h"
+#include "ShaderBytecode.h"
+#include "ShaderBlob.h"
+#include "TestCheck.h"
+#include <math.h>
+#include <string.h>
+
+/**
+* Tests of StereoShaderPatcher on vs_2_0, vs_3_0, ps_2_0 and ps_3_0 functions. The patched vertex shaders
+* are run by a small interpreter for both instances and compared to the original shader run with the left
+* and with the right constants.
+***/
+
+static const char* CREATOR = "Microsoft (R) HLSL Shader Compiler 9.29.952.3111";
+static const uint16_t TYPE_FLOAT = 3;
+static const uint32_t FLOAT_REGISTERS = 256;
+
+typedef ShaderBlob B;
+typedef StereoShaderPatcher::StereoConstant StereoConstant;
+
+/**
+* Registers of the interpreter.
+***/
+struct Machine
+{
+	float temp[32][4];
+	float input[16][4];
+	float constant[256][4];
+	float rastOut[3][4];
+	float attrOut[2][4];
+	float output[12][4];
+	float texture[10][4];
+	float colorOut[4][4];
+	int address[4];
+	bool killed;
+};
+
+static float* Register(Machine& machine, uint32_t parameter, uint32_t offset = 0)
+{
+	uint32_t number = (parameter & 0x7FF) + offset;
+	switch (((parameter >> 28) & 0x7) | ((parameter >> 8) & 0x18))
+	{
+	case B::Reg_Temp: return machine.temp[number];
+	case B::Reg_Input: return machine.input[number];
+	case B::Reg_Const: return machine.constant[number];
+	case B::Reg_Texture: return machine.texture[number];
+	case B::Reg_RastOut: return machine.rastOut[number];
+	case B::Reg_AttrOut: return machine.attrOut[number];
+	case B::Reg_Output: return machine.output[number];
+	case B::Reg_ColorOut: return machine.colorOut[number];
+	default: return NULL;
+	}
+}
+
+/**
+* Reads a source parameter, relative to the address register if the address token follows.
+***/
+static void Read(Machine& machine, const uint32_t* pParameter, float value[4])
+{
+	uint32_t parameter = pParameter[0];
+	uint32_t offset = (parameter & 0x00002000) ? machine.address[(pParameter[1] >> 16) & 0x3] : 0;
+	const float* pRegister = Register(machine, parameter, offset);
+	float sign = (((parameter >> 24) & 0xF) == 1) ? -1.0f : 1.0f;
+	for (uint32_t i = 0; i < 4; i++)
+		value[i] = sign * pRegister[(parameter >> (16 + 2 * i)) & 0x3];
+}
+
+static void Write(Machine& machine, uint32_t parameter, const float value[4])
+{
+	float* pRegister = Register(machine, parameter);
+	for (uint32_t i = 0; i < 4; i++)
+		if (parameter & (1 << (16 + i)))
+			pRegister[i] = value[i];
+}
+
+static float Dot(const float a[4], const float b[4], uint32_t count)
+{
+	float sum = 0.0f;
+	for (uint32_t i = 0; i < count; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+/**
+* Runs a shader model 2/3 function (the arithmetic instructions the tests use).
+***/
+static bool Run(const std::vector<uint32_t>& function, Machine& machine)
+{
+	machine.killed = false;
+	for (size_t token = 1; token < function.size();) {
+		uint32_t instruction = function[token];
+		uint32_t opcode = instruction & 0xFFFF;
+		if (opcode == 0xFFFF)
+			return true;
+		if (opcode == 0xFFFE) {
+			token += 1 + ((instruction >> 16) & 0x7FFF);
+			continue;
+		}
+
+		// parameters, address tokens skipped
+		const uint32_t* pParameters[8];
+		size_t count = 0;
+		for (size_t parameter = token + 1; parameter < token + 1 + ((instruction >> 24) & 0xF); parameter++) {
+			pParameters[count++] = &function[parameter];
+			if ((opcode != B::Op_Dcl) && (opcode != B::Op_Def) && (function[parameter] & 0x00002000))
+				parameter++;
+		}
+		token += 1 + ((instruction >> 24) & 0xF);
+
+		float a[4], b[4], c[4], result[4];
+		switch (opcode)
+		{
+		case B::Op_Dcl:
+			break;
+		case B::Op_Def:
+			memcpy(Register(machine, *pParameters[0]), pParameters[0] + 1, 4 * sizeof(float));
+			break;
+		case B::Op_Mov:
+			Read(machine, pParameters[1], result);
+			Write(machine, *pParameters[0], result);
+			break;
+		case B::Op_Mova:
+			Read(machine, pParameters[1], a);
+			for (uint32_t i = 0; i < 4; i++)
+				if (*pParameters[0] & (1 << (16 + i)))
+					machine.address[i] = (int)floorf(a[i] + 0.5f);
+			break;
+		case B::Op_Add:
+		case B::Op_Mul:
+		case B::Op_Mad:
+			Read(machine, pParameters[1], a);
+			Read(machine, pParameters[2], b);
+			if (opcode == B::Op_Mad)
+				Read(machine, pParameters[3], c);
+			for (uint32_t i = 0; i < 4; i++)
+				result[i] = (opcode == B::Op_Add) ? a[i] + b[i] : (opcode == B::Op_Mul) ? a[i] * b[i] : a[i] * b[i] + c[i];
+			Write(machine, *pParameters[0], result);
+			break;
+		case B::Op_Dp3:
+		case B::Op_Dp4:
+			Read(machine, pParameters[1], a);
+			Read(machine, pParameters[2], b);
+			result[0] = result[1] = result[2] = result[3] = Dot(a, b, (opcode == B::Op_Dp3) ? 3 : 4);
+			Write(machine, *pParameters[0], result);
+			break;
+		case B::Op_M4x4:
+		case B::Op_M4x3:
+		case B::Op_M3x3:
+			Read(machine, pParameters[1], a);
+			for (uint32_t row = 0; row < ((opcode == B::Op_M4x4) ? 4U : 3U); row++) {
+				uint32_t rowParameter = *pParameters[2] + row;
+				Read(machine, &rowParameter, b);
+				result[row] = Dot(a, b, (opcode == B::Op_M3x3) ? 3 : 4);
+			}
+			Write(machine, *pParameters[0], result);
+			break;
+		case B::Op_Texkill:
+			Read(machine, pParameters[0], a);
+			machine.killed |= (a[0] < 0.0f) || (a[1] < 0.0f) || (a[2] < 0.0f);
+			break;
+		default:
+			return false;
+		}
+	}
+	return false;
+}
+
+static bool Near(const float a[4], const float b[4])
+{
+	for (uint32_t i = 0; i < 4; i++)
+		if (fabsf(a[i] - b[i]) > 1e-4f * (1.0f + fabsf(b[i])))
+			return false;
+	return true;
+}
+
+/**
+* Test value of a constant register, stereo registers have a left and a right value.
+***/
+static float Constant(uint32_t reg, uint32_t component, bool right)
+{
+	return (right ? 0.3f : -0.2f) * (component + 1) + 0.01f * reg;
+}
+
+/**
+* Machine with the test inputs and constants, the right values in the stereo registers if right.
+***/
+static void Setup(Machine& machine, const std::vector<StereoConstant>& stereoConstants, bool right)
+{
+	memset(&machine, 0, sizeof(machine));
+	for (uint32_t reg = 0; reg < 16; reg++)
+		for (uint32_t i = 0; i < 4; i++)
+			machine.input[reg][i] = 0.25f * reg + 0.5f * i + 1.0f;
+	for (uint32_t reg = 0; reg < 64; reg++)
+		for (uint32_t i = 0; i < 4; i++)
+			machine.constant[reg][i] = Constant(reg, i, false);
+	for (auto itConstant = stereoConstants.begin(); right && (itConstant != stereoConstants.end()); ++itConstant)
+		for (uint32_t reg = itConstant->startRegister; reg < itConstant->startRegister + itConstant->count; reg++)
+			for (uint32_t i = 0; i < 4; i++)
+				machine.constant[reg][i] = Constant(reg, i, true);
+}
+
+/**
+* Runs the original shader with the left and the right constants and the patched shader for both instances,
+* compares the outputs (position moved to the eye's half, side distance) of each instance.
+* @param positionParameter Position register of the original and patched shader.
+* @param sideParameter Side distance register of the patched shader.
+* @param outputs Other output registers to compare.
+***/
+static void CheckInstances(const ShaderBlob& blob, const StereoShaderPatcher& patcher, const std::vector<StereoConstant>& stereoConstants,
+	uint32_t positionParameter, uint32_t sideParameter, std::initializer_list<uint32_t> outputs)
+{
+	for (uint32_t instance = 0; instance < 2; instance++) {
+		Machine original;
+		Setup(original, stereoConstants, instance == 1);
+		CHECK(Run(blob.Tokens(), original));
+
+		// the game sets the left values, the right values go to the right registers
+		Machine patched;
+		Setup(patched, stereoConstants, false);
+		for (size_t index = 0; index < stereoConstants.size(); index++) {
+			uint32_t rightRegister = patcher.RightRegisters()[index];
+			for (uint32_t reg = 0; (rightRegister != StereoShaderPatcher::NO_REGISTER) && (reg < stereoConstants[index].count); reg++)
+				for (uint32_t i = 0; i < 4; i++)
+					patched.constant[rightRegister + reg][i] = Constant(stereoConstants[index].startRegister + reg, i, true);
+		}
+
+		// instance input : the first free input register (the tests declare v0 and v1)
+		StereoShaderPatcher::InstanceData(instance, patched.input[2]);
+		CHECK(Run(patcher.Function(), patched));
+
+		const float* pOriginal = Register(original, positionParameter);
+		const float* pPatched = Register(patched, positionParameter);
+		float expected[4] = {(pOriginal[0] + (instance ? 1.0f : -1.0f) * pOriginal[3]) * 0.5f, pOriginal[1], pOriginal[2], pOriginal[3]};
+		CHECK(Near(pPatched, expected));
+
+		float side = instance ? expected[0] : -expected[0];
+		float expectedSide[4] = {side, side, side, side};
+		CHECK(Near(Register(patched, sideParameter), expectedSide));
+
+		for (auto itOutput = outputs.begin(); itOutput != outputs.end(); ++itOutput)
+			CHECK(Near(Register(patched, *itOutput), Register(original, *itOutput)));
+	}
+}
+
+/**
+* Instruction tokens of a function, from the first instruction with the opcode on.
+***/
+static std::vector<uint32_t> Find(const std::vector<uint32_t>& function, uint32_t opcode, size_t count)
+{
+	for (size_t token = 1; token < function.size();) {
+		uint32_t instruction = function[token];
+		if ((instruction & 0xFFFF) == 0xFFFF)
+			break;
+		if ((instruction & 0xFFFF) == opcode)
+			return std::vector<uint32_t>(function.begin() + token, function.begin() + std::min(token + count, function.size()));
+		token += 1 + (((instruction & 0xFFFF) == 0xFFFE) ? ((instruction >> 16) & 0x7FFF) : ((instruction >> 24) & 0xF));
+	}
+	return std::vector<uint32_t>();
+}
+
+static bool Equal(const std::vector<uint32_t>& tokens, std::initializer_list<uint32_t> expected)
+{
+	return tokens == std::vector<uint32_t>(expected);
+}
+
+/**
+* vs_2_0 as fxc emits it : world view projection matrix (stereo) by dot products and by a matrix macro,
+* a stereo vector, a mono color and a literal.
+***/
+static ShaderBlob VS20()
+{
+	ShaderBlob blob(B::VS(2, 0));
+	blob.ConstantTable(CREATOR, "vs_2_0", {
+		{"WorldViewProj", ShaderBytecode::RegisterSet_Float4, 0, 4, ShaderBytecode::Class_MatrixColumns, TYPE_FLOAT, 4, 4, 1, {}},
+		{"Tint", ShaderBytecode::RegisterSet_Float4, 4, 1, ShaderBytecode::Class_Vector, TYPE_FLOAT, 1, 4, 1, {}},
+		{"EyeOffset", ShaderBytecode::RegisterSet_Float4, 5, 1, ShaderBytecode::Class_Vector, TYPE_FLOAT, 1, 4, 1, {}}});
+	blob.Instruction(B::Op_Def, {B::Dst(B::Reg_Const, 10), B::Float(0.5f), B::Float(2.0f), B::Float(-1.0f), B::Float(1.0f)});
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Input, 0)});
+	blob.Instruction(B::Op_Dcl, {0x80000005, B::Dst(B::Reg_Input, 1)});
+	for (uint32_t i = 0; i < 4; i++)
+		blob.Instruction(B::Op_Dp4, {B::Dst(B::Reg_RastOut, 0, 1 << i), B::Src(B::Reg_Input, 0), B::Src(B::Reg_Const, i)});
+	blob.Instruction(B::Op_M4x4, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Input, 1), B::Src(B::Reg_Const, 0)});
+	blob.Instruction(B::Op_Mad, {B::Dst(B::Reg_Output, 0), B::Src(B::Reg_Const, 5), B::Src(B::Reg_Const, 10), B::Src(B::Reg_Temp, 0)});
+	blob.Instruction(B::Op_Mul, {B::Dst(B::Reg_AttrOut, 0), B::Src(B::Reg_Input, 1), B::Src(B::Reg_Const, 4)});
+	blob.Instruction(B::Op_Add, {B::Dst(B::Reg_Output, 1), B::Src(B::Reg_Const, 5) | 0x01000000, B::Src(B::Reg_Const, 5, 0x1B)});
+	blob.End();
+	return blob;
+}
+
+static std::vector<StereoConstant> VS20StereoConstants()
+{
+	std::vector<StereoConstant> stereoConstants(2);
+	stereoConstants[0].startRegister = 0;
+	stereoConstants[0].count = 4;
+	stereoConstants[1].startRegister = 5;
+	stereoConstants[1].count = 1;
+	return stereoConstants;
+}
+
+static void TestVS20()
+{
+	ShaderBlob blob = VS20();
+	std::vector<StereoConstant> stereoConstants = VS20StereoConstants();
+	StereoShaderPatcher patcher;
+	CHECK(patcher.PatchVertexShader(blob.Data(), blob.Size(), stereoConstants, FLOAT_REGISTERS));
+	CHECK(strcmp(patcher.Error(), "") == 0);
+
+	// right copies in the highest free registers
+	CHECK(patcher.RightRegisters().size() == 2);
+	CHECK(patcher.RightRegisters()[0] == 252);
+	CHECK(patcher.RightRegisters()[1] == 251);
+
+	// the patched function is a valid vs_2_0 function with the instance input declared after the
+	// original declarations (v2, the first free input) and the position written once at the end
+	const std::vector<uint32_t>& function = patcher.Function();
+	ShaderBytecode bytecode;
+	CHECK(bytecode.Parse(&function[0], function.size() * sizeof(uint32_t)));
+	CHECK(bytecode.Version() == B::VS(2, 0));
+	CHECK(bytecode.Constants().size() == 3);
+	CHECK(function.back() == 0x0000FFFF);
+
+	std::vector<uint32_t> dcl;
+	for (size_t token = 1; token + 2 < function.size(); token++)
+		if ((function[token] == (B::Op_Dcl | 0x02000000)) && (function[token + 2] == B::Dst(B::Reg_Input, 2)))
+			dcl.assign(function.begin() + token, function.begin() + token + 3);
+	CHECK(Equal(dcl, {B::Op_Dcl | 0x02000000, 0x800F0005, B::Dst(B::Reg_Input, 2)}));
+
+	// first stereo read : r2 (r0 is the shader's, r1 the position) = c0 * v2.y + c252 * v2.x
+	CHECK(Equal(Find(function, B::Op_Mul, 4), {B::Op_Mul | 0x03000000, B::Dst(B::Reg_Temp, 2), B::Src(B::Reg_Const, 0), B::Src(B::Reg_Input, 2, 0x55)}));
+	CHECK(Equal(Find(function, B::Op_Mad, 5), {B::Op_Mad | 0x04000000, B::Dst(B::Reg_Temp, 2), B::Src(B::Reg_Const, 252), B::Src(B::Reg_Input, 2, 0x00), B::Src(B::Reg_Temp, 2)}));
+	CHECK(Find(function, B::Op_M4x4, 1).empty());
+
+	CheckInstances(blob, patcher, stereoConstants, B::Dst(B::Reg_RastOut, 0), B::Dst(B::Reg_Output, 7),
+		{B::Dst(B::Reg_Output, 0), B::Dst(B::Reg_Output, 1), B::Dst(B::Reg_AttrOut, 0)});
+
+	// a stereo constant the shader does not read gets no right registers
+	stereoConstants.push_back(StereoConstant());
+	stereoConstants.back().startRegister = 20;
+	stereoConstants.back().count = 4;
+	CHECK(patcher.PatchVertexShader(blob.Data(), blob.Size(), stereoConstants, FLOAT_REGISTERS));
+	CHECK(patcher.RightRegisters().size() == 3);
+	CHECK(patcher.RightRegisters()[2] == StereoShaderPatcher::NO_REGISTER);
+
+	// no stereo constants : only the position is moved
+	CHECK(patcher.PatchVertexShader(blob.Data(), blob.Size(), std::vector<StereoConstant>(), FLOAT_REGISTERS));
+	CHECK(patcher.RightRegisters().empty());
+	CheckInstances(blob, patcher, std::vector<StereoConstant>(), B::Dst(B::Reg_RastOut, 0), B::Dst(B::Reg_Output, 7), {B::Dst(B::Reg_Output, 0)});
+}
+
+/**
+* vs_3_0 : declared outputs, position written in two parts, a matrix macro reading a stereo matrix into the
+* position, relative reads of a mono array.
+***/
+static ShaderBlob VS30()
+{
+	ShaderBlob blob(B::VS(3, 0));
+	blob.ConstantTable(CREATOR, "vs_3_0", {
+		{"Bones", ShaderBytecode::RegisterSet_Float4, 8, 12, ShaderBytecode::Class_MatrixRows, TYPE_FLOAT, 3, 4, 4, {}},
+		{"ViewProj", ShaderBytecode::RegisterSet_Float4, 0, 4, ShaderBytecode::Class_MatrixColumns, TYPE_FLOAT, 4, 4, 1, {}}});
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Input, 0)});
+	blob.Instruction(B::Op_Dcl, {0x80000005, B::Dst(B::Reg_Input, 1)});
+	blob.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Output, 0)});
+	blob.Instruction(B::Op_Dcl, {0x80000005, B::Dst(B::Reg_Output, 1, 0x3)});
+	blob.Instruction(B::Op_Dcl, {0x80010005, B::Dst(B::Reg_Output, 1, 0xC)});
+	blob.Instruction(B::Op_Mova, {B::Dst(B::Reg_Addr, 0, 0x1), B::Src(B::Reg_Input, 1, 0x00)});
+	blob.Instruction(B::Op_Dp4, {B::Dst(B::Reg_Temp, 3, 0x1), B::Src(B::Reg_Input, 0), B::Relative(B::Src(B::Reg_Const, 8)), B::Src(B::Reg_Addr, 0, 0x00)});
+	blob.Instruction(B::Op_M4x3, {B::Dst(B::Reg_Output, 0, 0x7), B::Src(B::Reg_Input, 0), B::Src(B::Reg_Const, 0)});
+	blob.Instruction(B::Op_Dp4, {B::Dst(B::Reg_Output, 0, 0x8), B::Src(B::Reg_Input, 0), B::Src(B::Reg_Const, 3)});
+	blob.Instruction(B::Op_Mov, {B::Dst(B::Reg_Output, 1), B::Src(B::Reg_Input, 1)});
+	blob.End();
+	return blob;
+}
+
+static void TestVS30()
+{
+	ShaderBlob blob = VS30();
+	std::vector<StereoConstant> stereoConstants(1);
+	stereoConstants[0].startRegister = 0;
+	stereoConstants[0].count = 4;
+	StereoShaderPatcher patcher;
+	CHECK(patcher.PatchVertexShader(blob.Data(), blob.Size(), stereoConstants, FLOAT_REGISTERS));
+	CHECK(patcher.RightRegisters()[0] == 252);
+
+	// the side distance goes to the first free output, declared as TEXCOORD7
+	const std::vector<uint32_t>& function = patcher.Function();
+	ShaderBytecode bytecode;
+	CHECK(bytecode.Parse(&function[0], function.size() * sizeof(uint32_t)));
+	CHECK(bytecode.Version() == B::VS(3, 0));
+	bool sideDeclared = false;
+	for (size_t token = 1; token + 2 < function.size(); token++)
+		sideDeclared |= (function[token] == (B::Op_Dcl | 0x02000000)) && (function[token + 1] == 0x80070005) && (function[token + 2] == B::Dst(B::Reg_Output, 2));
+	CHECK(sideDeclared);
+
+	// relative reads of the mono array are kept (with their address token)
+	std::vector<uint32_t> relative = Find(function, B::Op_Dp4, 5);
+	CHECK(Equal(relative, {B::Op_Dp4 | 0x04000000, B::Dst(B::Reg_Temp, 3, 0x1), B::Src(B::Reg_Input, 0), B::Relative(B::Src(B::Reg_Const, 8)), B::Src(B::Reg_Addr, 0, 0x00)}));
+
+	// the macro is expanded, the position is written through a temporary register
+	CHECK(Find(function, B::Op_M4x3, 1).empty());
+	CheckInstances(blob, patcher, stereoConstants, B::Dst(B::Reg_Output, 0), B::Dst(B::Reg_Output, 2), {B::Dst(B::Reg_Output, 1)});
+}
+
+/**
+* Shaders the patcher refuses, the device draws them once per eye.
+***/
+static void TestUnsupported()
+{
+	std::vector<StereoConstant> stereoConstants = VS20StereoConstants();
+	StereoShaderPatcher patcher;
+
+	// shader model 1, pixel shader
+	ShaderBlob vs11(B::VS(1, 1));
+	vs11.Instruction(B::Op_Mov, {B::Dst(B::Reg_RastOut, 0), B::Src(B::Reg_Const, 0)});
+	vs11.End();
+	CHECK(!patcher.PatchVertexShader(vs11.Data(), vs11.Size(), stereoConstants, FLOAT_REGISTERS));
+	CHECK(patcher.Function().empty() && (strlen(patcher.Error()) > 0));
+	ShaderBlob ps20(B::PS(2, 0));
+	ps20.Instruction(B::Op_Mov, {B::Dst(B::Reg_ColorOut, 0), B::Src(B::Reg_Const, 0)});
+	ps20.End();
+	CHECK(!patcher.PatchVertexShader(ps20.Data(), ps20.Size(), stereoConstants, FLOAT_REGISTERS));
+
+	// subroutines
+	ShaderBlob call(B::VS(2, 0));
+	call.Instruction(B::Op_Call, {B::Src(18, 0)});
+	call.Instruction(B::Op_Ret, {});
+	call.Instruction(B::Op_Label, {B::Src(18, 0)});
+	call.Instruction(B::Op_Mov, {B::Dst(B::Reg_RastOut, 0), B::Src(B::Reg_Const, 0)});
+	call.Instruction(B::Op_Ret, {});
+	call.End();
+	CHECK(!patcher.PatchVertexShader(call.Data(), call.Size(), stereoConstants, FLOAT_REGISTERS));
+
+	// stereo constant read relative to the address register, relative read outside the constant table
+	ShaderBlob relative(B::VS(2, 0));
+	relative.ConstantTable(CREATOR, "vs_2_0", {
+		{"WorldViewProj", ShaderBytecode::RegisterSet_Float4, 0, 4, ShaderBytecode::Class_MatrixColumns, TYPE_FLOAT, 4, 4, 1, {}}});
+	relative.Instruction(B::Op_Mova, {B::Dst(B::Reg_Addr, 0, 0x1), B::Src(B::Reg_Input, 0, 0x00)});
+	relative.Instruction(B::Op_Mov, {B::Dst(B::Reg_RastOut, 0), B::Relative(B::Src(B::Reg_Const, 1)), B::Src(B::Reg_Addr, 0, 0x00)});
+	relative.End();
+	CHECK(!patcher.PatchVertexShader(relative.Data(), relative.Size(), stereoConstants, FLOAT_REGISTERS));
+	std::vector<StereoConstant> eyeOffset(1, stereoConstants[1]);
+	CHECK(patcher.PatchVertexShader(relative.Data(), relative.Size(), eyeOffset, FLOAT_REGISTERS));
+	std::vector<uint32_t> outside = relative.Tokens();
+	for (size_t token = 0; token < outside.size(); token++)
+		if (outside[token] == B::Relative(B::Src(B::Reg_Const, 1)))
+			outside[token] = B::Relative(B::Src(B::Reg_Const, 30));
+	CHECK(!patcher.PatchVertexShader(&outside[0], outside.size() * sizeof(uint32_t), eyeOffset, FLOAT_REGISTERS));
+
+	// instance input semantic or side output in use, stereo register defined by the shader
+	ShaderBlob texcoord15(B::VS(2, 0));
+	texcoord15.Instruction(B::Op_Dcl, {0x800F0005, B::Dst(B::Reg_Input, 0)});
+	texcoord15.Instruction(B::Op_Mov, {B::Dst(B::Reg_RastOut, 0), B::Src(B::Reg_Input, 0)});
+	texcoord15.End();
+	CHECK(!patcher.PatchVertexShader(texcoord15.Data(), texcoord15.Size(), stereoConstants, FLOAT_REGISTERS));
+	ShaderBlob oT7(B::VS(2, 0));
+	oT7.Instruction(B::Op_Mov, {B::Dst(B::Reg_RastOut, 0), B::Src(B::Reg_Const, 0)});
+	oT7.Instruction(B::Op_Mov, {B::Dst(B::Reg_Output, 7), B::Src(B::Reg_Const, 0)});
+	oT7.End();
+	CHECK(!patcher.PatchVertexShader(oT7.Data(), oT7.Size(), stereoConstants, FLOAT_REGISTERS));
+	ShaderBlob texcoord7(B::VS(3, 0));
+	texcoord7.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Output, 0)});
+	texcoord7.Instruction(B::Op_Dcl, {0x80070005, B::Dst(B::Reg_Output, 1)});
+	texcoord7.Instruction(B::Op_Mov, {B::Dst(B::Reg_Output, 0), B::Src(B::Reg_Const, 0)});
+	texcoord7.End();
+	CHECK(!patcher.PatchVertexShader(texcoord7.Data(), texcoord7.Size(), stereoConstants, FLOAT_REGISTERS));
+	ShaderBlob def(B::VS(2, 0));
+	def.Instruction(B::Op_Def, {B::Dst(B::Reg_Const, 5), B::Float(0.0f), B::Float(0.0f), B::Float(0.0f), B::Float(0.0f)});
+	def.Instruction(B::Op_Mov, {B::Dst(B::Reg_RastOut, 0), B::Src(B::Reg_Const, 5)});
+	def.End();
+	CHECK(!patcher.PatchVertexShader(def.Data(), def.Size(), stereoConstants, FLOAT_REGISTERS));
+
+	// no position, position output shared with another output (vs_3_0)
+	ShaderBlob noPosition(B::VS(2, 0));
+	noPosition.Instruction(B::Op_Mov, {B::Dst(B::Reg_Output, 0), B::Src(B::Reg_Const, 0)});
+	noPosition.End();
+	CHECK(!patcher.PatchVertexShader(noPosition.Data(), noPosition.Size(), stereoConstants, FLOAT_REGISTERS));
+	ShaderBlob shared(B::VS(3, 0));
+	shared.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Output, 0, 0x7)});
+	shared.Instruction(B::Op_Dcl, {0x80000004, B::Dst(B::Reg_Output, 0, 0x8)});
+	shared.Instruction(B::Op_Mov, {B::Dst(B::Reg_Output, 0), B::Src(B::Reg_Const, 0)});
+	shared.End();
+	CHECK(!patcher.PatchVertexShader(shared.Data(), shared.Size(), stereoConstants, FLOAT_REGISTERS));
+
+	// all vs_2_0 temporary registers in use
+	ShaderBlob temps(B::VS(2, 0));
+	temps.Instruction(B::Op_Mov, {B::Dst(B::Reg_Temp, 11), B::Src(B::Reg_Const, 0)});
+	temps.Instruction(B::Op_Mov, {B::Dst(B::Reg_RastOut, 0), B::Src(B::Reg_Temp, 11)});
+	temps.End();
+	CHECK(!patcher.PatchVertexShader(temps.Data(), temps.Size(), stereoConstants, FLOAT_REGISTERS));
+
+	// no free float registers for the right values (all 8 registers in the constant table)
+	ShaderBlob full(B::VS(2, 0));
+	full.ConstantTable(CREATOR, "vs_2_0", {
+		{"WorldViewProj", ShaderBytecode::RegisterSet_Float4, 0, 4, ShaderBytecode::Class_MatrixColumns, TYPE_FLOAT, 4, 4, 1, {}},
+		{"Lights", ShaderBytecode::RegisterSet_Float4, 4, 4, ShaderBytecode::Class_Vector, TYPE_FLOAT, 1, 4, 4, {}}});
+	full.Instruction(B::Op_M4x4, {B::Dst(B::Reg_RastOut, 0), B::Src(B::Reg_Input, 0), B::Src(B::Reg_Const, 0)});
+	full.End();
+	std::vector<StereoConstant> matrix(1, stereoConstants[0]);
+	CHECK(!patcher.PatchVertexShader(full.Data(), full.Size(), matrix, 8));
+	CHECK(patcher.PatchVertexShader(full.Data(), full.Size(), matrix, 12));
+	CHECK(patcher.RightRegisters()[0] == 8);
+
+	// a failed patch keeps nothing of the previous one
+	CHECK(!patcher.PatchVertexShader(call.Data(), call.Size(), stereoConstants, FLOAT_REGISTERS));
+	CHECK(patcher.Function().empty());
+}
+
+/**
+* Pixel shaders : the side distance is declared and killed on below zero.
+***/
+static void TestPixelShaders()
+{
+	StereoShaderPatcher patcher;
+
+	// ps_2_0 : t7, after the declarations
+	ShaderBlob ps20(B::PS(2, 0));
+	ps20.Instruction(B::Op_Def, {B::Dst(B::Reg_Const, 0), B::Float(1.0f), B::Float(0.5f), B::Float(0.25f), B::Float(1.0f)});
+	ps20.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Texture, 0)});
+	ps20.Instruction(B::Op_Mul, {B::Dst(B::Reg_ColorOut, 0), B::Src(B::Reg_Texture, 0), B::Src(B::Reg_Const, 0)});
+	ps20.End();
+	CHECK(patcher.PatchPixelShader(ps20.Data(), ps20.Size()));
+	std::vector<uint32_t> expected(ps20.Tokens().begin(), ps20.Tokens().begin() + 10);
+	uint32_t added[] = {B::Op_Dcl | 0x02000000, 0x80000000, B::Dst(B::Reg_Texture, 7), B::Op_Texkill | 0x01000000, B::Dst(B::Reg_Texture, 7)};
+	expected.insert(expected.end(), added, added + 5);
+	expected.insert(expected.end(), ps20.Tokens().begin() + 10, ps20.Tokens().end());
+	CHECK(patcher.Function() == expected);
+
+	for (uint32_t instance = 0; instance < 2; instance++) {
+		Machine machine;
+		Setup(machine, std::vector<StereoConstant>(), false);
+		machine.texture[0][1] = 3.0f;
+		machine.texture[7][0] = machine.texture[7][1] = machine.texture[7][2] = machine.texture[7][3] = instance ? 0.5f : -0.5f;
+		CHECK(Run(patcher.Function(), machine));
+		CHECK(machine.killed == (instance == 0));
+		CHECK(machine.colorOut[0][1] == 0.5f * machine.texture[0][1]);
+	}
+
+	// ps_3_0 : TEXCOORD7 in the first free input register
+	ShaderBlob ps30(B::PS(3, 0));
+	ps30.Instruction(B::Op_Dcl, {0x80000005, B::Dst(B::Reg_Input, 0)});
+	ps30.Instruction(B::Op_Dcl, {0x8000000A, B::Dst(B::Reg_Input, 1)});
+	ps30.Instruction(B::Op_Mov, {B::Dst(B::Reg_ColorOut, 0), B::Src(B::Reg_Input, 1)});
+	ps30.End();
+	CHECK(patcher.PatchPixelShader(ps30.Data(), ps30.Size()));
+	CHECK(Equal(Find(patcher.Function(), B::Op_Texkill, 2), {B::Op_Texkill | 0x01000000, B::Dst(B::Reg_Input, 2)}));
+	ShaderBytecode bytecode;
+	CHECK(bytecode.Parse(&patcher.Function()[0], patcher.Function().size() * sizeof(uint32_t)));
+	CHECK(bytecode.InstructionCount() == 5);
+
+	// side distance register in use, shader model 1, vertex shader
+	ShaderBlob t7(B::PS(2, 0));
+	t7.Instruction(B::Op_Dcl, {0x80000000, B::Dst(B::Reg_Texture, 7)});
+	t7.Instruction(B::Op_Mov, {B::Dst(B::Reg_ColorOut, 0), B::Src(B::Reg_Texture, 7)});
+	t7.End();
+	CHECK(!patcher.PatchPixelShader(t7.Data(), t7.Size()));
+	ShaderBlob texcoord7(B::PS(3, 0));
+	texcoord7.Instruction(B::Op_Dcl, {0x80070005, B::Dst(B::Reg_Input, 0)});
+	texcoord7.Instruction(B::Op_Mov, {B::Dst(B::Reg_ColorOut, 0), B::Src(B::Reg_Input, 0)});
+	texcoord7.End();
+	CHECK(!patcher.PatchPixelShader(texcoord7.Data(), texcoord7.Size()));
+	ShaderBlob ps14(B::PS(1, 4));
+	ps14.Instruction(B::Op_Mov, {B::Dst(B::Reg_Temp, 0), B::Src(B::Reg_Const, 0)});
+	ps14.End();
+	CHECK(!patcher.PatchPixelShader(ps14.Data(), ps14.Size()));
+	ShaderBlob vs20 = VS20();
+	CHECK(!patcher.PatchPixelShader(vs20.Data(), vs20.Size()));
+}
+
+int main()
+{
+	TestVS20();
+	TestVS30();
+	TestUnsupported();
+	TestPixelShaders();
+	return TestResult("StereoShaderPatcherTest");
+}
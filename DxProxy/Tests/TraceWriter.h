@@ -0,0 +1,75 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <TraceWriter.h> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef TRACEWRITER_H_INCLUDED
+#define TRACEWRITER_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <initializer_list>
+#include <vector>
+#include "CallTraceFormat.h"
+
+/**
+* Writes a trace in memory like CallTrace::RecordArgs() (trailing zero arguments are not stored).
+***/
+class TraceWriter
+{
+public:
+	TraceWriter(uint32_t magic = CallTraceFormat::TRACE_MAGIC, uint32_t version = CallTraceFormat::TRACE_VERSION)
+	{
+		Put(&magic, sizeof(magic));
+		Put(&version, sizeof(version));
+	}
+
+	void Record(uint32_t call, std::initializer_list<uint32_t> args, const void* pData = NULL, size_t dataSize = 0)
+	{
+		std::vector<uint32_t> stored(args);
+		while (!stored.empty() && (stored.back() == 0))
+			stored.pop_back();
+
+		CallTraceFormat::RecordHeader header;
+		header.call = (uint16_t)call;
+		header.argCount = (uint16_t)stored.size();
+		header.dataSize = (uint32_t)dataSize;
+		Put(&header, sizeof(header));
+		if (!stored.empty())
+			Put(&stored[0], stored.size() * sizeof(uint32_t));
+		Put(pData, dataSize);
+	}
+
+	void Put(const void* pData, size_t size)
+	{
+		const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+		if (size)
+			m_data.insert(m_data.end(), pBytes, pBytes + size);
+	}
+
+	std::vector<uint8_t> m_data;
+};
+#endif
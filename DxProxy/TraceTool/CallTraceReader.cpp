@@ -0,0 +1,230 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <CallTraceReader.cpp> and
+Class <CallTraceReader> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "CallTraceReader.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+* Call names, by CallTraceFormat::CallIds.
+***/
+static const char* callNames[CallTraceFormat::Call_Count] =
+{
+	"Present",
+	"Reset",
+	"BeginScene",
+	"EndScene",
+	"Clear",
+	"DrawPrimitive",
+	"DrawIndexedPrimitive",
+	"DrawPrimitiveUP",
+	"DrawIndexedPrimitiveUP",
+	"SetRenderState",
+	"SetSamplerState",
+	"SetTextureStageState",
+	"SetTexture",
+	"SetStreamSource",
+	"SetStreamSourceFreq",
+	"SetIndices",
+	"SetVertexDeclaration",
+	"SetFVF",
+	"SetVertexShader",
+	"SetPixelShader",
+	"SetVertexShaderConstantF",
+	"SetVertexShaderConstantI",
+	"SetVertexShaderConstantB",
+	"SetPixelShaderConstantF",
+	"SetPixelShaderConstantI",
+	"SetPixelShaderConstantB",
+	"SetTransform",
+	"MultiplyTransform",
+	"SetViewport",
+	"SetScissorRect",
+	"SetRenderTarget",
+	"SetDepthStencilSurface",
+	"StretchRect",
+	"ColorFill",
+	"BeginStateBlock",
+	"EndStateBlock",
+	"CreateStateBlock",
+	"DefineTexture",
+	"DefineCubeTexture",
+	"DefineVolumeTexture",
+	"DefineSurface",
+	"DefineVertexBuffer",
+	"DefineIndexBuffer",
+	"DefineVertexShader",
+	"DefinePixelShader",
+	"DefineVertexDeclaration"
+};
+
+/**
+* Constructor.
+* No trace opened.
+***/
+CallTraceReader::CallTraceReader() :
+	m_file(),
+	m_pTrace(NULL),
+	m_size(0),
+	m_offset(0),
+	m_index(0),
+	m_error("no trace opened")
+{
+}
+
+/**
+* Destructor.
+***/
+CallTraceReader::~CallTraceReader()
+{
+}
+
+/**
+* Reads a trace file and opens it.
+* @param fileName The trace file.
+* @return False if the file could not be read or is no call trace.
+***/
+bool CallTraceReader::Load(const char* fileName)
+{
+	m_file.clear();
+
+	FILE* pFile = fopen(fileName, "rb");
+	if (!pFile)
+		return Fail("failed to open trace file");
+
+	uint8_t buffer[65536];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+		m_file.insert(m_file.end(), buffer, buffer + read);
+
+	bool failed = (ferror(pFile) != 0);
+	fclose(pFile);
+	if (failed)
+		return Fail("failed to read trace file");
+
+	return Open(m_file.empty() ? NULL : &m_file[0], m_file.size());
+}
+
+/**
+* Opens a trace in memory, the memory has to stay valid while records are read.
+* @param pTrace The trace (file contents).
+* @param size Size of the trace in bytes.
+* @return False if the data is no call trace of a supported version.
+***/
+bool CallTraceReader::Open(const void* pTrace, size_t size)
+{
+	m_pTrace = static_cast<const uint8_t*>(pTrace);
+	m_size = pTrace ? size : 0;
+	m_offset = 0;
+	m_index = 0;
+	m_error = NULL;
+
+	CallTraceFormat::Header header;
+	if (m_size < sizeof(header))
+		return Fail("no call trace (file too small)");
+
+	memcpy(&header, m_pTrace, sizeof(header));
+	if (header.magic != CallTraceFormat::TRACE_MAGIC)
+		return Fail("no call trace (wrong magic)");
+	if ((header.version == 0) || (header.version > CallTraceFormat::TRACE_VERSION))
+		return Fail("unsupported trace version");
+
+	m_offset = sizeof(header);
+	return true;
+}
+
+/**
+* Reads the next record.
+* @param pRecord [out] The record.
+* @return False at the end of the trace or if the record is damaged (see AtEnd() and Error()).
+***/
+bool CallTraceReader::Next(Record* pRecord)
+{
+	if (m_error || (m_offset == m_size))
+		return false;
+
+	CallTraceFormat::RecordHeader header;
+	if (m_size - m_offset < sizeof(header))
+		return Fail("truncated record header");
+	memcpy(&header, m_pTrace + m_offset, sizeof(header));
+
+	if (header.call >= CallTraceFormat::Call_Count)
+		return Fail("unknown call");
+	if (header.argCount > CallTraceFormat::MAX_ARGS)
+		return Fail("too many arguments");
+
+	size_t argSize = header.argCount * sizeof(uint32_t);
+	if ((m_size - m_offset - sizeof(header) < argSize) || (m_size - m_offset - sizeof(header) - argSize < header.dataSize))
+		return Fail("truncated record");
+
+	pRecord->call = header.call;
+	memset(pRecord->args, 0, sizeof(pRecord->args));
+	memcpy(pRecord->args, m_pTrace + m_offset + sizeof(header), argSize);
+	pRecord->argCount = header.argCount;
+	pRecord->pData = header.dataSize ? m_pTrace + m_offset + sizeof(header) + argSize : NULL;
+	pRecord->dataSize = header.dataSize;
+	pRecord->index = m_index++;
+	pRecord->offset = m_offset;
+
+	m_offset += sizeof(header) + argSize + header.dataSize;
+	return true;
+}
+
+/**
+* True if all records were read.
+***/
+bool CallTraceReader::AtEnd() const
+{
+	return !m_error && (m_offset == m_size);
+}
+
+/**
+* Returns why reading stopped, NULL if the trace was read completely or reading goes on.
+***/
+const char* CallTraceReader::Error() const
+{
+	return m_error;
+}
+
+/**
+* Returns the name of a call, "?" if unknown.
+***/
+const char* CallTraceReader::CallName(uint32_t call)
+{
+	return (call < CallTraceFormat::Call_Count) ? callNames[call] : "?";
+}
+
+/**
+* Stops reading, returns false.
+***/
+bool CallTraceReader::Fail(const char* error)
+{
+	m_error = error;
+	return false;
+}
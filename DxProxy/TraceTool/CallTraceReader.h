@@ -0,0 +1,101 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <CallTraceReader.h> and
+Class <CallTraceReader> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef CALLTRACEREADER_H_INCLUDED
+#define CALLTRACEREADER_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "CallTraceFormat.h"
+
+/**
+* Reads the records of a call trace (see CallTraceFormat) one by one.
+* The trace is read into memory (or given in memory), record payloads point into it.
+* Reading stops at the first damaged record, Error() tells why.
+* @see CallTraceReplayer
+*/
+class CallTraceReader
+{
+public:
+	CallTraceReader();
+	virtual ~CallTraceReader();
+
+	/**
+	* One record, arguments not stored in the trace are zero.
+	***/
+	struct Record
+	{
+		uint32_t       call;                            /**< CallTraceFormat::CallIds */
+		uint32_t       args[CallTraceFormat::MAX_ARGS]; /**< Arguments. */
+		uint32_t       argCount;                        /**< Number of stored arguments. */
+		const uint8_t* pData;                           /**< Payload, NULL if none. */
+		uint32_t       dataSize;                        /**< Payload size in bytes. */
+		size_t         index;                           /**< Record number, starting at 0. */
+		size_t         offset;                          /**< File offset of the record. */
+	};
+
+	/*** CallTraceReader public methods ***/
+	bool               Load(const char* fileName);
+	bool               Open(const void* pTrace, size_t size);
+	bool               Next(Record* pRecord);
+	bool               AtEnd() const;
+	const char*        Error() const;
+	static const char* CallName(uint32_t call);
+
+private:
+	/*** CallTraceReader private methods ***/
+	bool Fail(const char* error);
+
+	/**
+	* Trace file contents if loaded by Load().
+	***/
+	std::vector<uint8_t> m_file;
+	/**
+	* The trace.
+	***/
+	const uint8_t* m_pTrace;
+	/**
+	* Size of the trace in bytes.
+	***/
+	size_t m_size;
+	/**
+	* Offset of the next record.
+	***/
+	size_t m_offset;
+	/**
+	* Number of records read.
+	***/
+	size_t m_index;
+	/**
+	* Reason reading stopped, NULL if not failed.
+	***/
+	const char* m_error;
+};
+#endif
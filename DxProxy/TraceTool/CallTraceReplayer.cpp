@@ -0,0 +1,439 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <CallTraceReplayer.cpp> and
+Class <CallTraceReplayer> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "CallTraceReplayer.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+* Object kinds, as bit mask of the kinds a call accepts.
+***/
+#define KIND_TEXTURE            1
+#define KIND_SURFACE            2
+#define KIND_VERTEXBUFFER       4
+#define KIND_INDEXBUFFER        8
+#define KIND_VERTEXSHADER       16
+#define KIND_PIXELSHADER        32
+#define KIND_VERTEXDECLARATION  64
+
+/**
+* Payload sizes of the recorded structures (as in d3d9types.h).
+***/
+#define SIZE_RECT               16
+#define SIZE_MATRIX             64
+#define SIZE_VIEWPORT           24
+#define SIZE_VERTEXELEMENT      8
+#define FORMAT_INDEX16          101
+#define DECLTYPE_UNUSED         17
+
+/**
+* Arguments and object references of a call.
+***/
+static const struct CallInfo
+{
+	uint32_t argCount;      /**< Documented number of arguments. */
+	int      objectArg[2];  /**< Arguments holding object IDs, -1 if none. */
+	uint32_t objectKind[2]; /**< Object kinds accepted for these arguments. */
+	uint32_t defines;       /**< Object kind defined by the call, 0 if none. */
+} callInfos[CallTraceFormat::Call_Count] =
+{
+	{0, {-1, -1}, {0, 0}, 0},                                     // Present
+	{0, {-1, -1}, {0, 0}, 0},                                     // Reset
+	{0, {-1, -1}, {0, 0}, 0},                                     // BeginScene
+	{0, {-1, -1}, {0, 0}, 0},                                     // EndScene
+	{5, {-1, -1}, {0, 0}, 0},                                     // Clear
+	{3, {-1, -1}, {0, 0}, 0},                                     // DrawPrimitive
+	{6, {-1, -1}, {0, 0}, 0},                                     // DrawIndexedPrimitive
+	{3, {-1, -1}, {0, 0}, 0},                                     // DrawPrimitiveUP
+	{6, {-1, -1}, {0, 0}, 0},                                     // DrawIndexedPrimitiveUP
+	{2, {-1, -1}, {0, 0}, 0},                                     // SetRenderState
+	{3, {-1, -1}, {0, 0}, 0},                                     // SetSamplerState
+	{3, {-1, -1}, {0, 0}, 0},                                     // SetTextureStageState
+	{2, {1, -1}, {KIND_TEXTURE, 0}, 0},                           // SetTexture
+	{4, {1, -1}, {KIND_VERTEXBUFFER, 0}, 0},                      // SetStreamSource
+	{2, {-1, -1}, {0, 0}, 0},                                     // SetStreamSourceFreq
+	{1, {0, -1}, {KIND_INDEXBUFFER, 0}, 0},                       // SetIndices
+	{1, {0, -1}, {KIND_VERTEXDECLARATION, 0}, 0},                 // SetVertexDeclaration
+	{1, {-1, -1}, {0, 0}, 0},                                     // SetFVF
+	{1, {0, -1}, {KIND_VERTEXSHADER, 0}, 0},                      // SetVertexShader
+	{1, {0, -1}, {KIND_PIXELSHADER, 0}, 0},                       // SetPixelShader
+	{2, {-1, -1}, {0, 0}, 0},                                     // SetVertexShaderConstantF
+	{2, {-1, -1}, {0, 0}, 0},                                     // SetVertexShaderConstantI
+	{2, {-1, -1}, {0, 0}, 0},                                     // SetVertexShaderConstantB
+	{2, {-1, -1}, {0, 0}, 0},                                     // SetPixelShaderConstantF
+	{2, {-1, -1}, {0, 0}, 0},                                     // SetPixelShaderConstantI
+	{2, {-1, -1}, {0, 0}, 0},                                     // SetPixelShaderConstantB
+	{1, {-1, -1}, {0, 0}, 0},                                     // SetTransform
+	{1, {-1, -1}, {0, 0}, 0},                                     // MultiplyTransform
+	{0, {-1, -1}, {0, 0}, 0},                                     // SetViewport
+	{0, {-1, -1}, {0, 0}, 0},                                     // SetScissorRect
+	{2, {1, -1}, {KIND_SURFACE, 0}, 0},                           // SetRenderTarget
+	{1, {0, -1}, {KIND_SURFACE, 0}, 0},                           // SetDepthStencilSurface
+	{4, {0, 1}, {KIND_SURFACE, KIND_SURFACE}, 0},                 // StretchRect
+	{3, {0, -1}, {KIND_SURFACE, 0}, 0},                           // ColorFill
+	{0, {-1, -1}, {0, 0}, 0},                                     // BeginStateBlock
+	{0, {-1, -1}, {0, 0}, 0},                                     // EndStateBlock
+	{1, {-1, -1}, {0, 0}, 0},                                     // CreateStateBlock
+	{7, {-1, -1}, {0, 0}, KIND_TEXTURE},                          // DefineTexture
+	{6, {-1, -1}, {0, 0}, KIND_TEXTURE},                          // DefineCubeTexture
+	{8, {-1, -1}, {0, 0}, KIND_TEXTURE},                          // DefineVolumeTexture
+	{8, {-1, -1}, {0, 0}, KIND_SURFACE},                          // DefineSurface
+	{5, {-1, -1}, {0, 0}, KIND_VERTEXBUFFER},                     // DefineVertexBuffer
+	{5, {-1, -1}, {0, 0}, KIND_INDEXBUFFER},                      // DefineIndexBuffer
+	{1, {-1, -1}, {0, 0}, KIND_VERTEXSHADER},                     // DefineVertexShader
+	{1, {-1, -1}, {0, 0}, KIND_PIXELSHADER},                      // DefinePixelShader
+	{1, {-1, -1}, {0, 0}, KIND_VERTEXDECLARATION}                 // DefineVertexDeclaration
+};
+
+/**
+* Object kind names, for error messages.
+***/
+static const char* KindName(uint32_t kind)
+{
+	switch (kind)
+	{
+	case KIND_TEXTURE:
+		return "texture";
+	case KIND_SURFACE:
+		return "surface";
+	case KIND_VERTEXBUFFER:
+		return "vertex buffer";
+	case KIND_INDEXBUFFER:
+		return "index buffer";
+	case KIND_VERTEXSHADER:
+		return "vertex shader";
+	case KIND_PIXELSHADER:
+		return "pixel shader";
+	case KIND_VERTEXDECLARATION:
+		return "vertex declaration";
+	default:
+		return "object";
+	}
+}
+
+/**
+* Vertices drawn by a number of primitives (as vireio::VertexCount()).
+***/
+static uint32_t VertexCount(uint32_t primitiveType, uint32_t primitiveCount)
+{
+	switch (primitiveType)
+	{
+	case 1: // D3DPT_POINTLIST
+		return primitiveCount;
+	case 2: // D3DPT_LINELIST
+		return primitiveCount * 2;
+	case 3: // D3DPT_LINESTRIP
+		return primitiveCount + 1;
+	case 4: // D3DPT_TRIANGLELIST
+		return primitiveCount * 3;
+	case 5: // D3DPT_TRIANGLESTRIP
+	case 6: // D3DPT_TRIANGLEFAN
+		return primitiveCount + 2;
+	default:
+		return 0;
+	}
+}
+
+/**
+* Constructor.
+* @param pDevice The device receiving the calls.
+***/
+CallTraceReplayer::CallTraceReplayer(TraceDevice* pDevice) :
+	m_pDevice(pDevice),
+	m_objects(),
+	m_bytecode(),
+	m_errors(),
+	m_errorCount(0),
+	m_records(0),
+	m_frames(0)
+{
+}
+
+/**
+* Destructor.
+***/
+CallTraceReplayer::~CallTraceReplayer()
+{
+}
+
+/**
+* Replays all records of a trace.
+* @param pReader The opened trace.
+* @return False if the trace is damaged or any record is invalid (see Errors()).
+***/
+bool CallTraceReplayer::Replay(CallTraceReader* pReader)
+{
+	CallTraceReader::Record record;
+	void* objects[CallTraceFormat::MAX_ARGS];
+
+	while (pReader->Next(&record)) {
+		m_records++;
+
+		const CallInfo& info = callInfos[record.call];
+		bool valid = true;
+		if (record.argCount > info.argCount) {
+			AddError(&record, "%u arguments, %u expected", record.argCount, info.argCount);
+			valid = false;
+		}
+		if (!CheckPayload(record))
+			valid = false;
+
+		if (info.defines) {
+			Define(record, valid);
+			continue;
+		}
+
+		if (!ResolveObjects(record, objects) || !valid)
+			continue;
+
+		m_pDevice->Execute(record, objects);
+		if (record.call == CallTraceFormat::Call_Present)
+			m_frames++;
+	}
+
+	if (!pReader->AtEnd())
+		AddError(NULL, "trace damaged after %u records : %s", (unsigned)m_records, pReader->Error() ? pReader->Error() : "not opened");
+
+	return m_errorCount == 0;
+}
+
+/**
+* Returns the first MAX_ERRORS error messages.
+***/
+const std::vector<std::string>& CallTraceReplayer::Errors() const
+{
+	return m_errors;
+}
+
+/**
+* Returns the number of errors.
+***/
+size_t CallTraceReplayer::ErrorCount() const
+{
+	return m_errorCount;
+}
+
+/**
+* Returns the number of records replayed.
+***/
+size_t CallTraceReplayer::Records() const
+{
+	return m_records;
+}
+
+/**
+* Returns the number of frames (Present calls) replayed.
+***/
+size_t CallTraceReplayer::Frames() const
+{
+	return m_frames;
+}
+
+/**
+* Returns the number of objects defined.
+***/
+size_t CallTraceReplayer::Objects() const
+{
+	return m_objects.size();
+}
+
+/**
+* Checks the payload size of a record (and the payload itself for shaders and vertex declarations).
+* Payloads of optional pointers (rectangles, matrices) may be missing.
+***/
+bool CallTraceReplayer::CheckPayload(const CallTraceReader::Record& record)
+{
+	const uint32_t* args = record.args;
+	uint32_t expected = 0;
+	bool optional = false;
+
+	switch (record.call)
+	{
+	case CallTraceFormat::Call_Reset:
+		return true;
+	case CallTraceFormat::Call_Clear:
+		expected = args[0] * SIZE_RECT;
+		optional = true;
+		break;
+	case CallTraceFormat::Call_DrawPrimitiveUP:
+		expected = VertexCount(args[0], args[1]) * args[2];
+		break;
+	case CallTraceFormat::Call_DrawIndexedPrimitiveUP:
+		expected = (args[1] + args[2]) * args[5] + VertexCount(args[0], args[3]) * ((args[4] == FORMAT_INDEX16) ? 2 : 4);
+		break;
+	case CallTraceFormat::Call_SetVertexShaderConstantF:
+	case CallTraceFormat::Call_SetVertexShaderConstantI:
+	case CallTraceFormat::Call_SetPixelShaderConstantF:
+	case CallTraceFormat::Call_SetPixelShaderConstantI:
+		expected = args[1] * 4 * sizeof(uint32_t);
+		break;
+	case CallTraceFormat::Call_SetVertexShaderConstantB:
+	case CallTraceFormat::Call_SetPixelShaderConstantB:
+		expected = args[1] * sizeof(uint32_t);
+		break;
+	case CallTraceFormat::Call_SetTransform:
+	case CallTraceFormat::Call_MultiplyTransform:
+		expected = SIZE_MATRIX;
+		optional = true;
+		break;
+	case CallTraceFormat::Call_SetViewport:
+		expected = SIZE_VIEWPORT;
+		optional = true;
+		break;
+	case CallTraceFormat::Call_SetScissorRect:
+		expected = SIZE_RECT;
+		optional = true;
+		break;
+	case CallTraceFormat::Call_StretchRect:
+		expected = ((args[3] & 1) + ((args[3] >> 1) & 1)) * SIZE_RECT;
+		break;
+	case CallTraceFormat::Call_ColorFill:
+		expected = args[2] ? SIZE_RECT : 0;
+		break;
+	case CallTraceFormat::Call_DefineVertexShader:
+	case CallTraceFormat::Call_DefinePixelShader:
+		if (!m_bytecode.Parse(record.pData, record.dataSize)) {
+			AddError(&record, "invalid shader bytecode (%u bytes)", record.dataSize);
+			return false;
+		}
+		if (m_bytecode.IsPixelShader() != (record.call == CallTraceFormat::Call_DefinePixelShader)) {
+			AddError(&record, "%s bytecode", m_bytecode.IsPixelShader() ? "pixel shader" : "vertex shader");
+			return false;
+		}
+		return true;
+	case CallTraceFormat::Call_DefineVertexDeclaration:
+		if ((record.dataSize < SIZE_VERTEXELEMENT) || (record.dataSize % SIZE_VERTEXELEMENT)) {
+			AddError(&record, "vertex declaration of %u bytes", record.dataSize);
+			return false;
+		}
+		else {
+			const uint8_t* pEnd = record.pData + record.dataSize - SIZE_VERTEXELEMENT;
+			if ((pEnd[0] != 0xFF) || (pEnd[1] != 0) || (pEnd[4] != DECLTYPE_UNUSED)) {
+				AddError(&record, "vertex declaration without D3DDECL_END");
+				return false;
+			}
+		}
+		return true;
+	default:
+		break;
+	}
+
+	if ((record.dataSize != expected) && !(optional && (record.dataSize == 0))) {
+		AddError(&record, "payload of %u bytes, %u expected", record.dataSize, expected);
+		return false;
+	}
+	return true;
+}
+
+/**
+* Defines the object of a Call_Define... record.
+* Invalid definitions are kept without handle, so the references to the object are no errors.
+* @param record The definition.
+* @param valid False if the record is invalid, the device does not create the object then.
+***/
+bool CallTraceReplayer::Define(const CallTraceReader::Record& record, bool valid)
+{
+	uint32_t id = record.args[0];
+	if (id == 0) {
+		AddError(&record, "definition of object 0");
+		return false;
+	}
+	if (m_objects.find(id) != m_objects.end()) {
+		AddError(&record, "object %u defined twice", id);
+		return false;
+	}
+
+	Object object;
+	object.kind = callInfos[record.call].defines;
+	object.pHandle = valid ? m_pDevice->Create(record) : NULL;
+	m_objects.insert(std::pair<uint32_t, Object>(id, object));
+	return valid;
+}
+
+/**
+* Looks up the object ID arguments of a record.
+* @param record The call.
+* @param pObjects [out] Handles by argument index, MAX_ARGS entries.
+* @return False if an object is not defined, has the wrong kind or was defined invalid.
+***/
+bool CallTraceReplayer::ResolveObjects(const CallTraceReader::Record& record, void** pObjects)
+{
+	const CallInfo& info = callInfos[record.call];
+	memset(pObjects, 0, CallTraceFormat::MAX_ARGS * sizeof(void*));
+
+	bool resolved = true;
+	for (int i = 0; i < 2; i++) {
+		if (info.objectArg[i] < 0)
+			continue;
+
+		uint32_t id = record.args[info.objectArg[i]];
+		if (id == 0)
+			continue;
+
+		std::unordered_map<uint32_t, Object>::const_iterator it = m_objects.find(id);
+		if (it == m_objects.end()) {
+			AddError(&record, "object %u used before its definition", id);
+			resolved = false;
+		}
+		else if (!(it->second.kind & info.objectKind[i])) {
+			AddError(&record, "object %u is a %s, %s expected", id, KindName(it->second.kind), KindName(info.objectKind[i]));
+			resolved = false;
+		}
+		else if (!it->second.pHandle)
+			resolved = false;
+		else
+			pObjects[info.objectArg[i]] = it->second.pHandle;
+	}
+	return resolved;
+}
+
+/**
+* Adds an error message, prefixed with the record.
+* @param pRecord The record, NULL for errors of the whole trace.
+***/
+void CallTraceReplayer::AddError(const CallTraceReader::Record* pRecord, const char* format, ...)
+{
+	m_errorCount++;
+	if (m_errors.size() >= MAX_ERRORS)
+		return;
+
+	char message[512];
+	int length = 0;
+	if (pRecord)
+		length = snprintf(message, sizeof(message), "record %u (%s, offset %u): ", (unsigned)pRecord->index,
+			CallTraceReader::CallName(pRecord->call), (unsigned)pRecord->offset);
+
+	va_list args;
+	va_start(args, format);
+	vsnprintf(message + length, sizeof(message) - length, format, args);
+	va_end(args);
+
+	m_errors.push_back(message);
+}
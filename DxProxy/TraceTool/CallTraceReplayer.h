@@ -0,0 +1,133 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <CallTraceReplayer.h> and
+Class <CallTraceReplayer> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef CALLTRACEREPLAYER_H_INCLUDED
+#define CALLTRACEREPLAYER_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "CallTraceReader.h"
+#include "ShaderBytecode.h"
+
+/**
+* Receives the calls of a replayed trace.
+* Implemented by mock devices (tests, statistics) and by D3D9TraceDevice, which creates the resources
+* in Create() and issues the calls in Execute() on a Direct3D 9 device.
+*/
+class TraceDevice
+{
+public:
+	virtual ~TraceDevice() {}
+
+	/**
+	* Creates the object of a Call_Define... record, returns its handle for Execute().
+	***/
+	virtual void* Create(const CallTraceReader::Record& definition) = 0;
+	/**
+	* Executes a call.
+	* @param record The call.
+	* @param pObjects Handle of each object ID argument (by argument index), NULL for other arguments and ID 0.
+	***/
+	virtual void  Execute(const CallTraceReader::Record& record, void* const* pObjects) = 0;
+};
+
+/**
+* Replays a call trace into a TraceDevice, checking the record stream on the way :
+* known calls with at most their documented arguments, payload sizes, object IDs defined once and
+* before use with the object type the call expects, parseable shader bytecode and terminated vertex
+* declarations. Invalid records are reported and not executed.
+* @see CallTraceFormat
+*/
+class CallTraceReplayer
+{
+public:
+	CallTraceReplayer(TraceDevice* pDevice);
+	virtual ~CallTraceReplayer();
+
+	/*** CallTraceReplayer public methods ***/
+	bool                            Replay(CallTraceReader* pReader);
+	const std::vector<std::string>& Errors() const;
+	size_t                          ErrorCount() const;
+	size_t                          Records() const;
+	size_t                          Frames() const;
+	size_t                          Objects() const;
+
+	/**
+	* Maximum number of error messages kept, further errors are counted only.
+	***/
+	static const size_t MAX_ERRORS = 100;
+
+private:
+	/**
+	* A defined object.
+	***/
+	struct Object
+	{
+		uint32_t kind;    /**< Object kind (defining call). */
+		void*    pHandle; /**< Handle returned by the device, NULL if the definition was invalid. */
+	};
+
+	/*** CallTraceReplayer private methods ***/
+	bool CheckPayload(const CallTraceReader::Record& record);
+	bool Define(const CallTraceReader::Record& record, bool valid);
+	bool ResolveObjects(const CallTraceReader::Record& record, void** pObjects);
+	void AddError(const CallTraceReader::Record* pRecord, const char* format, ...);
+
+	/**
+	* The device receiving the calls.
+	***/
+	TraceDevice* m_pDevice;
+	/**
+	* Defined objects.
+	* <ID, object>
+	***/
+	std::unordered_map<uint32_t, Object> m_objects;
+	/**
+	* Parser checking the defined shaders.
+	***/
+	ShaderBytecode m_bytecode;
+	/**
+	* The first MAX_ERRORS error messages.
+	***/
+	std::vector<std::string> m_errors;
+	/**
+	* Number of errors.
+	***/
+	size_t m_errorCount;
+	/**
+	* Number of records replayed.
+	***/
+	size_t m_records;
+	/**
+	* Number of Present calls.
+	***/
+	size_t m_frames;
+};
+#endif
@@ -0,0 +1,341 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <D3D9TraceDevice.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "D3D9TraceDevice.h"
+#include <string.h>
+
+typedef CallTraceFormat F;
+
+/**
+* Constructor.
+* @param pDevice The device receiving the calls, not referenced (must outlive this object).
+***/
+D3D9TraceDevice::D3D9TraceDevice(IDirect3DDevice9* pDevice) :
+	m_pDevice(pDevice),
+	m_objects(),
+	m_frameTimes(),
+	m_failedCalls(0)
+{
+	m_frameStart.QuadPart = 0;
+	QueryPerformanceFrequency(&m_frequency);
+}
+
+/**
+* Destructor, releases the created objects.
+***/
+D3D9TraceDevice::~D3D9TraceDevice()
+{
+	for (size_t i = 0; i < m_objects.size(); i++)
+		m_objects[i]->Release();
+}
+
+/**
+* Creates the resource, shader or vertex declaration of a definition.
+* Textures are returned as IDirect3DBaseTexture9, all other objects as their own interface.
+***/
+void* D3D9TraceDevice::Create(const CallTraceReader::Record& definition)
+{
+	const uint32_t* args = definition.args;
+	HRESULT hr = D3DERR_INVALIDCALL;
+	IUnknown* pObject = NULL;
+	void* pHandle = NULL;
+
+	switch (definition.call)
+	{
+	case F::Call_DefineTexture:
+		{
+			IDirect3DTexture9* pTexture = NULL;
+			hr = m_pDevice->CreateTexture(args[1], args[2], args[3], args[4], (D3DFORMAT)args[5], (D3DPOOL)args[6], &pTexture, NULL);
+			pObject = pTexture;
+			pHandle = static_cast<IDirect3DBaseTexture9*>(pTexture);
+		}
+		break;
+	case F::Call_DefineCubeTexture:
+		{
+			IDirect3DCubeTexture9* pTexture = NULL;
+			hr = m_pDevice->CreateCubeTexture(args[1], args[2], args[3], (D3DFORMAT)args[4], (D3DPOOL)args[5], &pTexture, NULL);
+			pObject = pTexture;
+			pHandle = static_cast<IDirect3DBaseTexture9*>(pTexture);
+		}
+		break;
+	case F::Call_DefineVolumeTexture:
+		{
+			IDirect3DVolumeTexture9* pTexture = NULL;
+			hr = m_pDevice->CreateVolumeTexture(args[1], args[2], args[3], args[4], args[5], (D3DFORMAT)args[6], (D3DPOOL)args[7], &pTexture, NULL);
+			pObject = pTexture;
+			pHandle = static_cast<IDirect3DBaseTexture9*>(pTexture);
+		}
+		break;
+	case F::Call_DefineSurface:
+		{
+			IDirect3DSurface9* pSurface = NULL;
+			if (args[4] & D3DUSAGE_DEPTHSTENCIL)
+				hr = m_pDevice->CreateDepthStencilSurface(args[1], args[2], (D3DFORMAT)args[3], (D3DMULTISAMPLE_TYPE)args[6], args[7], FALSE, &pSurface, NULL);
+			else if (args[4] & D3DUSAGE_RENDERTARGET)
+				hr = m_pDevice->CreateRenderTarget(args[1], args[2], (D3DFORMAT)args[3], (D3DMULTISAMPLE_TYPE)args[6], args[7], FALSE, &pSurface, NULL);
+			else
+				hr = m_pDevice->CreateOffscreenPlainSurface(args[1], args[2], (D3DFORMAT)args[3], (D3DPOOL)args[5], &pSurface, NULL);
+			pObject = pSurface;
+			pHandle = pSurface;
+		}
+		break;
+	case F::Call_DefineVertexBuffer:
+		{
+			IDirect3DVertexBuffer9* pBuffer = NULL;
+			hr = m_pDevice->CreateVertexBuffer(args[1], args[2], args[3], (D3DPOOL)args[4], &pBuffer, NULL);
+			pObject = pBuffer;
+			pHandle = pBuffer;
+		}
+		break;
+	case F::Call_DefineIndexBuffer:
+		{
+			IDirect3DIndexBuffer9* pBuffer = NULL;
+			hr = m_pDevice->CreateIndexBuffer(args[1], args[2], (D3DFORMAT)args[3], (D3DPOOL)args[4], &pBuffer, NULL);
+			pObject = pBuffer;
+			pHandle = pBuffer;
+		}
+		break;
+	case F::Call_DefineVertexShader:
+		{
+			IDirect3DVertexShader9* pShader = NULL;
+			hr = m_pDevice->CreateVertexShader(reinterpret_cast<const DWORD*>(definition.pData), &pShader);
+			pObject = pShader;
+			pHandle = pShader;
+		}
+		break;
+	case F::Call_DefinePixelShader:
+		{
+			IDirect3DPixelShader9* pShader = NULL;
+			hr = m_pDevice->CreatePixelShader(reinterpret_cast<const DWORD*>(definition.pData), &pShader);
+			pObject = pShader;
+			pHandle = pShader;
+		}
+		break;
+	case F::Call_DefineVertexDeclaration:
+		{
+			IDirect3DVertexDeclaration9* pDeclaration = NULL;
+			hr = m_pDevice->CreateVertexDeclaration(reinterpret_cast<const D3DVERTEXELEMENT9*>(definition.pData), &pDeclaration);
+			pObject = pDeclaration;
+			pHandle = pDeclaration;
+		}
+		break;
+	default:
+		break;
+	}
+
+	if (FAILED(hr) || !pObject) {
+		m_failedCalls++;
+		return NULL;
+	}
+	m_objects.push_back(pObject);
+	return pHandle;
+}
+
+/**
+* Issues a call on the device.
+***/
+void D3D9TraceDevice::Execute(const CallTraceReader::Record& record, void* const* pObjects)
+{
+	const uint32_t* args = record.args;
+	const void* pData = record.pData;
+	HRESULT hr = D3D_OK;
+
+	if (m_frameStart.QuadPart == 0)
+		QueryPerformanceCounter(&m_frameStart);
+
+	switch (record.call)
+	{
+	case F::Call_Present:
+		{
+			hr = m_pDevice->Present(NULL, NULL, NULL, NULL);
+			LARGE_INTEGER now;
+			QueryPerformanceCounter(&now);
+			m_frameTimes.push_back((double)(now.QuadPart - m_frameStart.QuadPart) * 1000.0 / (double)m_frequency.QuadPart);
+			m_frameStart = now;
+		}
+		break;
+	case F::Call_Reset:
+		break;
+	case F::Call_BeginScene:
+		hr = m_pDevice->BeginScene();
+		break;
+	case F::Call_EndScene:
+		hr = m_pDevice->EndScene();
+		break;
+	case F::Call_Clear:
+		{
+			float z;
+			memcpy(&z, &args[3], sizeof(float));
+			hr = m_pDevice->Clear(pData ? args[0] : 0, static_cast<const D3DRECT*>(pData), args[1], args[2], z, args[4]);
+		}
+		break;
+	case F::Call_DrawPrimitive:
+		hr = m_pDevice->DrawPrimitive((D3DPRIMITIVETYPE)args[0], args[1], args[2]);
+		break;
+	case F::Call_DrawIndexedPrimitive:
+		hr = m_pDevice->DrawIndexedPrimitive((D3DPRIMITIVETYPE)args[0], (INT)args[1], args[2], args[3], args[4], args[5]);
+		break;
+	case F::Call_DrawPrimitiveUP:
+		hr = m_pDevice->DrawPrimitiveUP((D3DPRIMITIVETYPE)args[0], args[1], pData, args[2]);
+		break;
+	case F::Call_DrawIndexedPrimitiveUP:
+		{
+			// vertices from 0 to MinVertexIndex + NumVertices, then the indices
+			const uint8_t* pVertices = record.pData;
+			const uint8_t* pIndices = pVertices + (args[1] + args[2]) * args[5];
+			hr = m_pDevice->DrawIndexedPrimitiveUP((D3DPRIMITIVETYPE)args[0], args[1], args[2], args[3], pIndices, (D3DFORMAT)args[4], pVertices, args[5]);
+		}
+		break;
+	case F::Call_SetRenderState:
+		hr = m_pDevice->SetRenderState((D3DRENDERSTATETYPE)args[0], args[1]);
+		break;
+	case F::Call_SetSamplerState:
+		hr = m_pDevice->SetSamplerState(args[0], (D3DSAMPLERSTATETYPE)args[1], args[2]);
+		break;
+	case F::Call_SetTextureStageState:
+		hr = m_pDevice->SetTextureStageState(args[0], (D3DTEXTURESTAGESTATETYPE)args[1], args[2]);
+		break;
+	case F::Call_SetTexture:
+		hr = m_pDevice->SetTexture(args[0], static_cast<IDirect3DBaseTexture9*>(pObjects[1]));
+		break;
+	case F::Call_SetStreamSource:
+		hr = m_pDevice->SetStreamSource(args[0], static_cast<IDirect3DVertexBuffer9*>(pObjects[1]), args[2], args[3]);
+		break;
+	case F::Call_SetStreamSourceFreq:
+		hr = m_pDevice->SetStreamSourceFreq(args[0], args[1]);
+		break;
+	case F::Call_SetIndices:
+		hr = m_pDevice->SetIndices(static_cast<IDirect3DIndexBuffer9*>(pObjects[0]));
+		break;
+	case F::Call_SetVertexDeclaration:
+		hr = m_pDevice->SetVertexDeclaration(static_cast<IDirect3DVertexDeclaration9*>(pObjects[0]));
+		break;
+	case F::Call_SetFVF:
+		hr = m_pDevice->SetFVF(args[0]);
+		break;
+	case F::Call_SetVertexShader:
+		hr = m_pDevice->SetVertexShader(static_cast<IDirect3DVertexShader9*>(pObjects[0]));
+		break;
+	case F::Call_SetPixelShader:
+		hr = m_pDevice->SetPixelShader(static_cast<IDirect3DPixelShader9*>(pObjects[0]));
+		break;
+	case F::Call_SetVertexShaderConstantF:
+		hr = m_pDevice->SetVertexShaderConstantF(args[0], static_cast<const float*>(pData), args[1]);
+		break;
+	case F::Call_SetVertexShaderConstantI:
+		hr = m_pDevice->SetVertexShaderConstantI(args[0], static_cast<const int*>(pData), args[1]);
+		break;
+	case F::Call_SetVertexShaderConstantB:
+		hr = m_pDevice->SetVertexShaderConstantB(args[0], static_cast<const BOOL*>(pData), args[1]);
+		break;
+	case F::Call_SetPixelShaderConstantF:
+		hr = m_pDevice->SetPixelShaderConstantF(args[0], static_cast<const float*>(pData), args[1]);
+		break;
+	case F::Call_SetPixelShaderConstantI:
+		hr = m_pDevice->SetPixelShaderConstantI(args[0], static_cast<const int*>(pData), args[1]);
+		break;
+	case F::Call_SetPixelShaderConstantB:
+		hr = m_pDevice->SetPixelShaderConstantB(args[0], static_cast<const BOOL*>(pData), args[1]);
+		break;
+	case F::Call_SetTransform:
+		if (pData)
+			hr = m_pDevice->SetTransform((D3DTRANSFORMSTATETYPE)args[0], static_cast<const D3DMATRIX*>(pData));
+		break;
+	case F::Call_MultiplyTransform:
+		if (pData)
+			hr = m_pDevice->MultiplyTransform((D3DTRANSFORMSTATETYPE)args[0], static_cast<const D3DMATRIX*>(pData));
+		break;
+	case F::Call_SetViewport:
+		if (pData)
+			hr = m_pDevice->SetViewport(static_cast<const D3DVIEWPORT9*>(pData));
+		break;
+	case F::Call_SetScissorRect:
+		if (pData)
+			hr = m_pDevice->SetScissorRect(static_cast<const RECT*>(pData));
+		break;
+	case F::Call_SetRenderTarget:
+		hr = m_pDevice->SetRenderTarget(args[0], static_cast<IDirect3DSurface9*>(pObjects[1]));
+		break;
+	case F::Call_SetDepthStencilSurface:
+		hr = m_pDevice->SetDepthStencilSurface(static_cast<IDirect3DSurface9*>(pObjects[0]));
+		break;
+	case F::Call_StretchRect:
+		{
+			// the given rectangles follow each other, source first
+			const RECT* pRects = static_cast<const RECT*>(pData);
+			const RECT* pSourceRect = (args[3] & 1) ? pRects++ : NULL;
+			const RECT* pDestRect = (args[3] & 2) ? pRects : NULL;
+			hr = m_pDevice->StretchRect(static_cast<IDirect3DSurface9*>(pObjects[0]), pSourceRect,
+				static_cast<IDirect3DSurface9*>(pObjects[1]), pDestRect, (D3DTEXTUREFILTERTYPE)args[2]);
+		}
+		break;
+	case F::Call_ColorFill:
+		hr = m_pDevice->ColorFill(static_cast<IDirect3DSurface9*>(pObjects[0]), args[2] ? static_cast<const RECT*>(pData) : NULL, args[1]);
+		break;
+	case F::Call_BeginStateBlock:
+		hr = m_pDevice->BeginStateBlock();
+		break;
+	case F::Call_EndStateBlock:
+		{
+			IDirect3DStateBlock9* pStateBlock = NULL;
+			hr = m_pDevice->EndStateBlock(&pStateBlock);
+			if (pStateBlock)
+				pStateBlock->Release();
+		}
+		break;
+	case F::Call_CreateStateBlock:
+		{
+			IDirect3DStateBlock9* pStateBlock = NULL;
+			hr = m_pDevice->CreateStateBlock((D3DSTATEBLOCKTYPE)args[0], &pStateBlock);
+			if (pStateBlock)
+				pStateBlock->Release();
+		}
+		break;
+	default:
+		break;
+	}
+
+	if (FAILED(hr))
+		m_failedCalls++;
+}
+
+/**
+* Returns the time of each replayed frame, in milliseconds.
+***/
+const std::vector<double>& D3D9TraceDevice::FrameTimes() const
+{
+	return m_frameTimes;
+}
+
+/**
+* Returns the number of calls and creations the device failed.
+***/
+size_t D3D9TraceDevice::FailedCalls() const
+{
+	return m_failedCalls;
+}
@@ -0,0 +1,83 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <D3D9TraceDevice.h> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef D3D9TRACEDEVICE_H_INCLUDED
+#define D3D9TRACEDEVICE_H_INCLUDED
+
+#include <d3d9.h>
+#include <vector>
+#include "CallTraceReplayer.h"
+
+/**
+* Replays a trace on a Direct3D 9 device (the real device, the proxy or a mock device), timing each frame.
+* Resources are created from the Call_Define... descriptors, their contents are not captured so they
+* keep whatever the device initializes them with. Reset is not replayed (the presentation parameters
+* hold the window of the recording process), state blocks are created and released right away.
+* A frame ends with each Present, its time is measured from the previous Present (or the first call).
+*/
+class D3D9TraceDevice : public TraceDevice
+{
+public:
+	D3D9TraceDevice(IDirect3DDevice9* pDevice);
+	virtual ~D3D9TraceDevice();
+
+	/*** TraceDevice methods ***/
+	virtual void* Create(const CallTraceReader::Record& definition);
+	virtual void  Execute(const CallTraceReader::Record& record, void* const* pObjects);
+
+	/*** D3D9TraceDevice public methods ***/
+	const std::vector<double>& FrameTimes() const;
+	size_t                     FailedCalls() const;
+
+private:
+	/**
+	* The device receiving the calls.
+	***/
+	IDirect3DDevice9* m_pDevice;
+	/**
+	* Created objects, released in the destructor.
+	***/
+	std::vector<IUnknown*> m_objects;
+	/**
+	* Time of each replayed frame, in milliseconds.
+	***/
+	std::vector<double> m_frameTimes;
+	/**
+	* Performance counter at the start of the current frame, 0 before the first call.
+	***/
+	LARGE_INTEGER m_frameStart;
+	/**
+	* Performance counter frequency.
+	***/
+	LARGE_INTEGER m_frequency;
+	/**
+	* Number of calls and creations the device failed.
+	***/
+	size_t m_failedCalls;
+};
+#endif
@@ -0,0 +1,108 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <TraceTool.cpp> :
+Copyright (C) 2013 Vireio Perception Team
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include <stdio.h>
+#include "CallTraceReplayer.h"
+
+/**
+* Checks a call trace written by the proxy (CallTrace) and prints its call statistics.
+* Usage : TraceTool <trace.vct>
+* Returns 0 if the trace is valid, 1 if it has errors, 2 if it could not be read.
+***/
+
+/**
+* Counts the calls and created objects, creates no resources.
+***/
+class StatisticsDevice : public TraceDevice
+{
+public:
+	StatisticsDevice() : m_nextHandle(1)
+	{
+		for (int i = 0; i < CallTraceFormat::Call_Count; i++)
+			m_calls[i] = 0;
+	}
+
+	virtual void* Create(const CallTraceReader::Record& definition)
+	{
+		m_calls[definition.call]++;
+		return reinterpret_cast<void*>(m_nextHandle++);
+	}
+
+	virtual void Execute(const CallTraceReader::Record& record, void* const*)
+	{
+		m_calls[record.call]++;
+	}
+
+	/**
+	* Calls executed (and objects defined) by call type.
+	***/
+	size_t m_calls[CallTraceFormat::Call_Count];
+
+private:
+	/**
+	* Next object handle (handles are only compared, never dereferenced).
+	***/
+	uintptr_t m_nextHandle;
+};
+
+int main(int argc, char* argv[])
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage : TraceTool <trace.vct>\n");
+		return 2;
+	}
+
+	CallTraceReader reader;
+	if (!reader.Load(argv[1])) {
+		fprintf(stderr, "%s: %s\n", argv[1], reader.Error());
+		return 2;
+	}
+
+	StatisticsDevice device;
+	CallTraceReplayer replayer(&device);
+	bool valid = replayer.Replay(&reader);
+
+	printf("%s: %u records, %u frames, %u objects\n", argv[1], (unsigned)replayer.Records(),
+		(unsigned)replayer.Frames(), (unsigned)replayer.Objects());
+
+	size_t draws = device.m_calls[CallTraceFormat::Call_DrawPrimitive] + device.m_calls[CallTraceFormat::Call_DrawIndexedPrimitive] +
+		device.m_calls[CallTraceFormat::Call_DrawPrimitiveUP] + device.m_calls[CallTraceFormat::Call_DrawIndexedPrimitiveUP];
+	if (replayer.Frames() > 0)
+		printf("%.1f draws per frame\n", (double)draws / (double)replayer.Frames());
+
+	for (int i = 0; i < CallTraceFormat::Call_Count; i++)
+		if (device.m_calls[i])
+			printf("%-26s %u\n", CallTraceReader::CallName(i), (unsigned)device.m_calls[i]);
+
+	for (size_t i = 0; i < replayer.Errors().size(); i++)
+		fprintf(stderr, "%s\n", replayer.Errors()[i].c_str());
+	if (replayer.ErrorCount() > replayer.Errors().size())
+		fprintf(stderr, "... %u more errors\n", (unsigned)(replayer.ErrorCount() - replayer.Errors().size()));
+
+	return valid ? 0 : 1;
+}